@@ -1,10 +1,14 @@
 #include "mainwindow.h"
 #include "src/core/applicationmanager.h"
 #include "src/core/logger.h"
+#include "src/core/tracer.h"
 #include "src/models/song.h"
+#include "src/audio/offlinedecoder.h"
+#include "src/database/playstatsdao.h"
 #include "version.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 #include <QMessageBox>
 #include <QDebug>
 #include <QCommandLineParser>
@@ -25,6 +29,12 @@
 
 int main(int argc, char *argv[])
 {
+    // 离线解码模式（musicPlayHandle decode ...）：不创建界面，也不打开声卡
+    if (argc > 1 && qstrcmp(argv[1], "decode") == 0) {
+        QCoreApplication app(argc, argv);
+        return OfflineDecoder::runCommandLine(app.arguments());
+    }
+    
     // Qt6中高DPI支持已默认启用，无需手动设置
     QApplication app(argc, argv);
     
@@ -62,8 +72,25 @@ int main(int argc, char *argv[])
     QCommandLineOption noGuiOption("no-gui", "无GUI模式");
     parser.addOption(noGuiOption);
     
+    QCommandLineOption traceOption("trace", "记录性能追踪，退出时导出为Chrome追踪JSON", "path");
+    parser.addOption(traceOption);
+    
+    QCommandLineOption metricsOption("metrics", "定期把运行时指标快照写入JSON文件", "path");
+    parser.addOption(metricsOption);
+    
+    QCommandLineOption metricsPortOption("metrics-port", "在127.0.0.1的指定端口提供指标抓取接口", "port");
+    parser.addOption(metricsPortOption);
+    
+    QCommandLineOption rebuildStatsOption("rebuild-stats", "按现有播放历史重建播放统计后退出");
+    parser.addOption(rebuildStatsOption);
+    
     parser.process(app);
     
+    // 在初始化之前开始追踪，以便包含启动过程
+    if (parser.isSet(traceOption)) {
+        Tracer::instance()->start(parser.value(traceOption));
+    }
+    
     qDebug() << "main() - 程序开始执行";
     
     // 初始化应用程序管理器
@@ -77,6 +104,11 @@ int main(int argc, char *argv[])
         appManager->enableDeveloperMode(true);
     }
     
+    // 运行时指标导出
+    if (parser.isSet(metricsOption) || parser.isSet(metricsPortOption)) {
+        appManager->setMetricsExport(parser.value(metricsOption), parser.value(metricsPortOption).toInt());
+    }
+    
     // 初始化应用程序
     qDebug() << "main() - 开始初始化应用程序";
     if (!appManager->initialize(&app, argc, argv)) {
@@ -86,6 +118,16 @@ int main(int argc, char *argv[])
     }
     qDebug() << "main() - 应用程序初始化成功";
     
+    // 重建播放统计汇总表后退出
+    if (parser.isSet(rebuildStatsOption)) {
+        PlayStatsDao playStatsDao;
+        const bool rebuilt = playStatsDao.rebuild();
+        qDebug() << "main() - 重建播放统计" << (rebuilt ? "成功" : "失败");
+        appManager->shutdown();
+        ApplicationManager::cleanup();
+        return rebuilt ? 0 : 1;
+    }
+    
     // 如果是测试模式，运行测试
     if (parser.isSet(testOption)) {
         qDebug() << "测试模式已被禁用";
@@ -1,6 +1,6 @@
 QT += core gui widgets sql multimedia network concurrent testlib
 
-CONFIG += c++11
+CONFIG += c++17
 
 VERSION = 0.1.0
 QMAKE_TARGET_COMPANY = Qt6AudioPlayerTeam
@@ -13,6 +13,8 @@ DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000
 TARGET = musicPlayHandle
 TEMPLATE = app
 
+# 性能基准测试是独立的程序，见 tests/benchmarks/benchmarks.pro
+
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
@@ -33,10 +35,25 @@ SOURCES += \
     src/database/tagdao.cpp \
     src/database/playlistdao.cpp \
     src/database/playhistorydao.cpp \
+    src/database/playstatsdao.cpp \
+    src/database/smartplaylistdao.cpp \
+    src/database/playqueuedao.cpp \
+    src/database/tagindex.cpp \
     src/managers/tagmanager.cpp \
     src/managers/playlistmanager.cpp \
+    src/managers/playlistio.cpp \
+    src/managers/playqueue.cpp \
+    src/managers/playhistoryrecorder.cpp \
+    src/managers/smartplaylist.cpp \
+    src/managers/coverartcache.cpp \
+    src/managers/librarysnapshot.cpp \
     src/core/appconfig.cpp \
     src/core/logger.cpp \
+    src/core/tracer.cpp \
+    src/core/metricsregistry.cpp \
+    src/core/startupgraph.cpp \
+    src/core/shuffleorder.cpp \
+    src/core/roaringbitmap.cpp \
     src/database/databasemanager.cpp \
     src/database/logdao.cpp \
     src/models/song.cpp \
@@ -47,25 +64,52 @@ SOURCES += \
     src/models/systemlog.cpp \
     src/audio/audioengine.cpp \
     src/audio/ffmpegdecoder.cpp \
+    src/audio/audiooutput.cpp \
+    src/audio/loudnessmeter.cpp \
+    src/audio/offlinedecoder.cpp \
+    src/audio/mappedfilecache.cpp \
+    src/audio/audioiocontext.cpp \
+    src/audio/waveformcache.cpp \
     src/threading/audioworkerthread.cpp \
+    src/threading/mainthreadmanager.cpp \
     src/core/applicationmanager.cpp
 
 HEADERS += \
     mainwindow.h \
     src/managers/tagmanager.h \
     src/managers/playlistmanager.h \
+    src/managers/playlistio.h \
+    src/managers/playqueue.h \
+    src/managers/playhistoryrecorder.h \
+    src/managers/smartplaylist.h \
+    src/managers/coverartcache.h \
+    src/managers/librarysnapshot.h \
     version.h \
     src/ui/widgets/musicprogressbar.h \
     src/ui/widgets/recentplaylistitem.h \
     src/threading/audioworkerthread.h \
+    src/threading/mainthreadmanager.h \
     src/core/appconfig.h \
     src/core/logger.h \
+    src/core/shardedcache.h \
+    src/core/mpscringbuffer.h \
+    src/core/logcategorymask.h \
+    src/core/logmacros.h \
+    src/core/tracer.h \
+    src/core/metricsregistry.h \
+    src/core/startupgraph.h \
+    src/core/shuffleorder.h \
+    src/core/roaringbitmap.h \
     src/database/databasemanager.h \
     src/database/basedao.h \
     src/database/songdao.h \
     src/database/tagdao.h \
     src/database/playlistdao.h \
     src/database/playhistorydao.h \
+    src/database/playstatsdao.h \
+    src/database/smartplaylistdao.h \
+    src/database/playqueuedao.h \
+    src/database/tagindex.h \
     src/database/logdao.h \
     src/models/song.h \
     src/models/tag.h \
@@ -74,8 +118,15 @@ HEADERS += \
     src/models/errorlog.h \
     src/models/systemlog.h \
     src/audio/audiotypes.h \
+    src/audio/audiokernels.h \
     src/audio/audioengine.h \
     src/audio/ffmpegdecoder.h \
+    src/audio/audiooutput.h \
+    src/audio/loudnessmeter.h \
+    src/audio/offlinedecoder.h \
+    src/audio/mappedfilecache.h \
+    src/audio/audioiocontext.h \
+    src/audio/waveformcache.h \
     src/core/applicationmanager.h \
     src/ui/controllers/MainWindowController.h \
     src/ui/controllers/AddSongDialogController.h \
@@ -126,6 +177,8 @@ win32 {
             -lavutil \
             -lswscale \
             -lswresample
+    # 指标登记表读取进程内存
+    LIBS += -lpsapi
 } else {
     LIBS += -lavformat -lavcodec -lavutil -lswscale -lswresample
 }
@@ -1,7 +1,8 @@
 #include "audioengine.h"
 #include "../core/logger.h"
 #include "../core/appconfig.h"
-#include "../database/playhistorydao.h"
+#include "../managers/playhistoryrecorder.h"
+#include "../core/tracer.h"
 #include <QFileInfo>
 #include <QUrl>
 #include <QStandardPaths>
@@ -36,13 +37,12 @@ AudioEngine::AudioEngine(QObject* parent)
     m_volume(50), // 修改默认音量为50，与主界面保持一致
     m_muted(false),
     m_userPaused(false), // 初始化用户暂停标志
-    m_currentIndex(-1),
+    m_queue(new PlayQueue(this)),
     m_playMode(AudioTypes::PlayMode::Loop),
     m_equalizerEnabled(false),
     m_balance(0.0),
     m_speed(1.0),
     m_maxHistorySize(100),
-    m_playHistoryDao(new PlayHistoryDao(this)), // 初始化播放历史DAO
     m_positionTimer(nullptr),
     m_bufferTimer(nullptr),
     m_vuEnabled(true),
@@ -271,7 +271,9 @@ void AudioEngine::disconnectSignals()
 
 void AudioEngine::play()
 {
-    if (m_currentIndex < 0 || m_currentIndex >= m_playlist.size()) {
+    TRACE_FUNCTION("audio");
+    const Song song = m_queue->currentSong();
+    if (!song.isValid()) {
         logError("播放列表为空或索引无效");
         return;
     }
@@ -282,7 +284,6 @@ void AudioEngine::play()
         // 优先使用 FFmpeg 解码器播放
         if (m_ffmpegDecoder) {
             qDebug() << "AudioEngine: 优先使用FFmpeg解码器播放...";
-            const Song& song = m_playlist.at(m_currentIndex);
             qDebug() << "AudioEngine: 歌曲路径:" << song.filePath();
             
             try {
@@ -310,6 +311,7 @@ void AudioEngine::play()
                         logPlaybackEvent("FFmpeg开始播放", song.title());
                         updateCurrentSong();
                         addToHistory(song);
+                        preloadUpcoming();
                         
                         qDebug() << "AudioEngine: FFmpeg解码器播放成功，跳过QMediaPlayer";
                         return; // 成功使用FFmpeg播放，直接返回
@@ -359,8 +361,6 @@ void AudioEngine::play()
             locker.unlock();
             
             // 播放新歌曲
-            const Song& song = m_playlist.at(m_currentIndex);
-            
             // 设置音频输出
             if (m_player->audioOutput() != m_audioOutput) {
                 m_player->setAudioOutput(m_audioOutput);
@@ -552,6 +552,7 @@ void AudioEngine::stop()
 
 void AudioEngine::seek(qint64 position)
 {
+    TRACE_FUNCTION("audio");
     QMutexLocker locker(&m_mutex);
     
     try {
@@ -695,6 +696,7 @@ bool AudioEngine::isMuted() const
 
 void AudioEngine::setPlaylist(const QList<Song>& songs)
 {
+    TRACE_FUNCTION("audio");
     // 验证歌曲文件
     QList<Song> validSongs;
     for (const Song& song : songs) {
@@ -709,27 +711,50 @@ void AudioEngine::setPlaylist(const QList<Song>& songs)
     // 在临界区内更新数据
     {
         QMutexLocker locker(&m_mutex);
-        m_playlist = validSongs;
-        // 不自动设置当前索引，避免触发不必要的currentSongChanged信号
-        m_currentIndex = -1;  // 重置为-1，等待后续手动设置
+        // 不自动设置当前歌曲，避免触发不必要的currentSongChanged信号，等待后续手动设置
+        m_queue->setSongs(validSongs);
     }
     
     logPlaybackEvent("设置播放列表", QString("歌曲数量: %1").arg(validSongs.size()));
-    emit playlistChanged(m_playlist);
+    emit playlistChanged(validSongs);
 }
 
-void AudioEngine::setCurrentSong(const Song& song)
+void AudioEngine::setSource(const PlayQueueSource& source, int startSongId, int positionHint)
 {
+    TRACE_FUNCTION("audio");
     QMutexLocker locker(&m_mutex);
     
-    int index = -1;
-    for (int i = 0; i < m_playlist.size(); ++i) {
-        if (m_playlist[i].id() == song.id()) {
-            index = i;
-            break;
-        }
+    const int oldIndex = m_queue->currentPosition();
+    m_queue->setSource(source, startSongId, positionHint);
+    logPlaybackEvent("设置播放来源", QString("歌曲数量: %1").arg(m_queue->count()));
+    
+    if (m_queue->currentSongId() > 0) {
+        announceCurrentSong(oldIndex);
+    } else if (startSongId > 0) {
+        logError(QString("歌曲不在播放来源中: %1").arg(startSongId));
     }
+}
+
+PlayQueue* AudioEngine::queue() const
+{
+    return m_queue;
+}
+
+int AudioEngine::queueSize() const
+{
+    return m_queue->count() + m_queue->upNext().size();
+}
+
+bool AudioEngine::hasCurrentSong() const
+{
+    return m_queue->currentSongId() > 0;
+}
+
+void AudioEngine::setCurrentSong(const Song& song)
+{
+    QMutexLocker locker(&m_mutex);
     
+    const int index = m_queue->positionOf(song.id());
     if (index >= 0) {
         setCurrentIndex(index);
     } else {
@@ -739,52 +764,28 @@ void AudioEngine::setCurrentSong(const Song& song)
 
 void AudioEngine::setCurrentIndex(int index)
 {
+    TRACE_FUNCTION("audio");
     QMutexLocker locker(&m_mutex);
     
     // 检查索引是否有效
-    if (index < 0 || index >= m_playlist.size()) {
-        QString errorMsg = QString("无效的播放索引: %1, 播放列表大小: %2").arg(index).arg(m_playlist.size());
+    if (index < 0 || index >= m_queue->count()) {
+        QString errorMsg = QString("无效的播放索引: %1, 播放列表大小: %2").arg(index).arg(m_queue->count());
         logError(errorMsg);
         return;
     }
     
     // 如果索引没有变化，不执行任何操作
-    if (m_currentIndex == index) {
+    if (m_queue->currentPosition() == index) {
         return;
     }
     
     try {
-        // 记录当前播放状态
-        bool wasPlaying = (m_state == AudioTypes::AudioState::Playing);
-        qDebug() << "[AudioEngine::setCurrentIndex] 当前播放状态:" << (wasPlaying ? "播放中" : "已停止");
-        
-        // 如果正在播放，先停止当前播放
-        if (wasPlaying) {
-            qDebug() << "[AudioEngine::setCurrentIndex] 停止当前播放以切换歌曲";
-            if (m_player) {
-                m_player->stop();
-            }
-            m_state = AudioTypes::AudioState::Paused;
-            emit stateChanged(m_state);
+        const int oldIndex = m_queue->currentPosition();
+        if (m_queue->jumpTo(index)) {
+            announceCurrentSong(oldIndex);
+        } else {
+            logError(QString("播放索引对应的歌曲已不存在: %1").arg(index));
         }
-        
-        // 保存旧索引用于日志
-        int oldIndex = m_currentIndex;
-        
-        // 更新当前索引
-        m_currentIndex = index;
-        
-        // 获取当前歌曲信息
-        const Song& currentSong = m_playlist[index];
-        QString songInfo = QString("%1 - %2").arg(currentSong.title()).arg(currentSong.artist());
-        
-        // 记录切换事件
-        QString eventDetails = QString("从索引 %1 切换到索引 %2, 歌曲: %3").arg(oldIndex).arg(index).arg(songInfo);
-        logPlaybackEvent("切换歌曲", eventDetails);
-        
-        // 发送信号通知UI更新
-        emit currentIndexChanged(index);
-        emit currentSongChanged(currentSong);
     } catch (const std::exception& e) {
         QString errorMsg = QString("设置当前索引时发生异常: %1").arg(e.what());
         logError(errorMsg);
@@ -794,23 +795,55 @@ void AudioEngine::setCurrentIndex(int index)
     }
 }
 
+void AudioEngine::announceCurrentSong(int oldIndex)
+{
+    // 记录当前播放状态
+    bool wasPlaying = (m_state == AudioTypes::AudioState::Playing);
+    qDebug() << "[AudioEngine::announceCurrentSong] 当前播放状态:" << (wasPlaying ? "播放中" : "已停止");
+    
+    // 如果正在播放，先停止当前播放
+    if (wasPlaying) {
+        qDebug() << "[AudioEngine::announceCurrentSong] 停止当前播放以切换歌曲";
+        if (m_player) {
+            m_player->stop();
+        }
+        m_state = AudioTypes::AudioState::Paused;
+        emit stateChanged(m_state);
+    }
+    
+    // 获取当前歌曲信息
+    const int index = m_queue->currentPosition();
+    const Song currentSong = m_queue->currentSong();
+    QString songInfo = QString("%1 - %2").arg(currentSong.title()).arg(currentSong.artist());
+    
+    // 记录切换事件（插播歌曲的索引为-1）
+    QString eventDetails = QString("从索引 %1 切换到索引 %2, 歌曲: %3").arg(oldIndex).arg(index).arg(songInfo);
+    logPlaybackEvent("切换歌曲", eventDetails);
+    
+    // 发送信号通知UI更新
+    emit currentIndexChanged(index);
+    emit currentSongChanged(currentSong);
+}
+
 void AudioEngine::playNext()
 {
     QMutexLocker locker(&m_mutex);
     
     // 检查播放列表是否为空
-    if (m_playlist.isEmpty()) {
+    if (m_queue->isEmpty()) {
         logError("播放列表为空，无法播放下一首");
         return;
     }
     
     try {
-        // 获取下一首歌曲的索引
-        int nextIndex = getNextIndex();
+        // 单曲循环重播当前歌曲，其余模式沿队列前进（插播队列优先，随机模式由队列洗牌）
+        const int oldIndex = m_queue->currentPosition();
+        const bool repeatCurrent = m_playMode == AudioTypes::PlayMode::RepeatOne && hasCurrentSong();
         
-        // 设置当前索引并播放
-        if (nextIndex >= 0 && nextIndex < m_playlist.size()) {
-            setCurrentIndex(nextIndex);
+        if (repeatCurrent || moveInQueue(true)) {
+            if (!repeatCurrent) {
+                announceCurrentSong(oldIndex);
+            }
             
             // 确保状态为Loading，然后调用play()
             m_state = AudioTypes::AudioState::Loading;
@@ -821,7 +854,7 @@ void AudioEngine::playNext()
                 play();
             });
         } else {
-            logError(QString("无效的下一首索引: %1").arg(nextIndex));
+            logError("没有可播放的下一首");
         }
     } catch (const std::exception& e) {
         logError(QString("播放下一首时发生异常: %1").arg(e.what()));
@@ -835,20 +868,21 @@ void AudioEngine::playPrevious()
     QMutexLocker locker(&m_mutex);
     
     // 检查播放列表是否为空
-    if (m_playlist.isEmpty()) {
+    if (m_queue->isEmpty()) {
         logError("播放列表为空，无法播放上一首");
         return;
     }
     
     try {
-        // 获取上一首歌曲的索引
-        int previousIndex = getPreviousIndex();
+        // 沿播放历史后退到真正播放过的上一首，没有历史时按来源顺序后退
+        const int oldIndex = m_queue->currentPosition();
+        const bool repeatCurrent = m_playMode == AudioTypes::PlayMode::RepeatOne && hasCurrentSong();
         
-        // 设置当前索引并播放
-        if (previousIndex >= 0 && previousIndex < m_playlist.size()) {
-            setCurrentIndex(previousIndex);
-            qDebug() << "[AudioEngine::playPrevious] 成功切换到上一首歌曲:" 
-                     << (m_currentIndex < m_playlist.size() ? m_playlist[m_currentIndex].title() : "未知");
+        if (repeatCurrent || moveInQueue(false)) {
+            if (!repeatCurrent) {
+                announceCurrentSong(oldIndex);
+            }
+            qDebug() << "[AudioEngine::playPrevious] 成功切换到上一首歌曲:" << m_queue->currentSong().title();
             
             // 自动播放新选择的歌曲 - 强制播放
             qDebug() << "[AudioEngine::playPrevious] 自动播放新选择的歌曲";
@@ -862,7 +896,7 @@ void AudioEngine::playPrevious()
                 play();
             });
         } else {
-            qDebug() << "[AudioEngine::playPrevious] 无效的上一首索引:" << previousIndex;
+            qDebug() << "[AudioEngine::playPrevious] 没有可播放的上一首";
         }
     } catch (const std::exception& e) {
         qDebug() << "[AudioEngine::playPrevious] 播放上一首时发生异常:" << e.what();
@@ -879,7 +913,8 @@ void AudioEngine::setPlayMode(AudioTypes::PlayMode mode)
     if (m_playMode == mode) return;
     
     m_playMode = mode;
-
+    // 随机模式由队列洗牌，从当前歌曲开始新的一轮
+    m_queue->setShuffle(mode == AudioTypes::PlayMode::Random);
     
     QString modeStr;
     switch (mode) {
@@ -1012,26 +1047,21 @@ Song AudioEngine::currentSong() const
     // 避免使用互斥锁，因为可能导致死锁
     // QMutexLocker locker(&m_mutex);
     
-    if (m_currentIndex >= 0 && m_currentIndex < m_playlist.size()) {
-        const Song& song = m_playlist[m_currentIndex];
-        return song;
-    }
-    
-    return Song();
+    return m_queue->currentSong();
 }
 
 // playMode、state、position、duration、currentIndex、playlist、playHistory等getter不再加QMutexLocker，直接返回成员变量。
 // 在注释中说明：这些getter假定只在主线程读，音频线程写时通过信号同步。
 int AudioEngine::currentIndex() const
 {
-    return m_currentIndex;
+    return m_queue->currentPosition();
 }
 
 // playMode、state、position、duration、currentIndex、playlist、playHistory等getter不再加QMutexLocker，直接返回成员变量。
 // 在注释中说明：这些getter假定只在主线程读，音频线程写时通过信号同步。
 QList<Song> AudioEngine::playlist() const
 {
-    return m_playlist;
+    return m_queue->songs();
 }
 
 bool AudioEngine::isFormatSupported(const QString& filePath) const
@@ -1059,9 +1089,9 @@ void AudioEngine::addToHistory(const Song& song)
         m_playHistory.removeLast();
     }
     
-    // 记录到数据库
-    if (m_playHistoryDao && song.isValid()) {
-        m_playHistoryDao->addPlayRecord(song.id());
+    // 记录到数据库（由写线程批量写入，不在切歌时同步访问数据库）
+    if (song.isValid()) {
+        PlayHistoryRecorder::instance()->record(song.id());
         logPlaybackEvent("添加到数据库历史", song.title());
     }
     
@@ -1180,8 +1210,8 @@ void AudioEngine::onErrorOccurred(QMediaPlayer::Error error)
     
     // 获取当前播放的歌曲信息（如果有）
     QString songInfo = "未知歌曲";
-    if (m_currentIndex >= 0 && m_currentIndex < m_playlist.size()) {
-        const Song& song = m_playlist[m_currentIndex];
+    const Song song = m_queue->currentSong();
+    if (song.isValid()) {
         songInfo = QString("%1 - %2 (%3)").arg(song.title()).arg(song.artist()).arg(song.filePath());
     }
     
@@ -1270,6 +1300,7 @@ void AudioEngine::updatePlaybackPosition()
 // 私有方法实现
 void AudioEngine::loadMedia(const QString& filePath)
 {
+    TRACE_FUNCTION("audio");
     // 检查文件是否存在
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
@@ -1311,10 +1342,10 @@ void AudioEngine::loadMedia(const QString& filePath)
 
 void AudioEngine::updateCurrentSong()
 {
-    if (m_currentIndex >= 0 && m_currentIndex < m_playlist.size()) {
-        const Song& currentSong = m_playlist[m_currentIndex];
+    const Song currentSong = m_queue->currentSong();
+    if (currentSong.isValid()) {
         emit currentSongChanged(currentSong);
-        emit currentIndexChanged(m_currentIndex);
+        emit currentIndexChanged(m_queue->currentPosition());
     } else {
         logError("索引无效，无法更新当前歌曲");
     }
@@ -1323,7 +1354,7 @@ void AudioEngine::updateCurrentSong()
 void AudioEngine::handlePlaybackFinished()
 {
     // 检查播放列表是否为空
-    if (m_playlist.isEmpty()) {
+    if (m_queue->isEmpty()) {
         return;
     }
     
@@ -1350,108 +1381,36 @@ void AudioEngine::handlePlaybackFinished()
     }
 }
 
-void AudioEngine::shufflePlaylist()
+bool AudioEngine::moveInQueue(bool forward)
 {
-    if (m_playlist.size() <= 1) return;
-    
-    // 使用Fisher-Yates洗牌算法
-    for (int i = m_playlist.size() - 1; i > 0; --i) {
-        int j = QRandomGenerator::global()->bounded(i + 1);
-        m_playlist.swapItemsAt(i, j);
-    }
-    
-    // 重置当前索引
-    m_currentIndex = 0;
-    
-    logPlaybackEvent("随机播放列表", "");
-    emit playlistChanged(m_playlist);
-    emit currentIndexChanged(m_currentIndex);
-}
-
-int AudioEngine::getNextIndex()
-{
-    // 检查播放列表是否为空
-    if (m_playlist.isEmpty()) {
-        return -1;
-    }
-    
-    // 检查当前索引是否有效
-    if (m_currentIndex < 0 || m_currentIndex >= m_playlist.size()) {
-        return 0; // 如果当前索引无效，返回第一首歌曲
-    }
-    
-    int nextIndex = -1;
-    
-    // 根据播放模式计算下一首歌曲索引
-    switch (m_playMode) {
-        case AudioTypes::PlayMode::Loop:
-            nextIndex = (m_currentIndex + 1) % m_playlist.size();
-            break;
-            
-        case AudioTypes::PlayMode::RepeatOne:
-            nextIndex = m_currentIndex;
-            break;
-            
-        case AudioTypes::PlayMode::Random:
-            // 确保随机模式不会连续播放同一首歌
-            if (m_playlist.size() > 1) {
-                do {
-                    nextIndex = QRandomGenerator::global()->bounded(m_playlist.size());
-                } while (nextIndex == m_currentIndex);
-            } else {
-                nextIndex = 0; // 只有一首歌时返回0
-            }
-            break;
-            
-        default:
-            nextIndex = (m_currentIndex + 1) % m_playlist.size();
-            break;
+    // 跳过格式不支持或已从曲库删除的歌曲，最多尝试一轮
+    const int attempts = qMax(1, queueSize());
+    for (int i = 0; i < attempts; ++i) {
+        const bool moved = forward ? m_queue->advance(true) : m_queue->retreat(true);
+        if (!moved) {
+            return false;
+        }
+        const Song song = m_queue->currentSong();
+        if (song.isValid() && isFormatSupported(song.filePath())) {
+            return true;
+        }
+        logError(QString("跳过无法播放的歌曲: %1").arg(song.filePath()));
     }
-    
-    return nextIndex;
+    return false;
 }
 
-int AudioEngine::getPreviousIndex()
+void AudioEngine::preloadUpcoming()
 {
-    // 检查播放列表是否为空
-    if (m_playlist.isEmpty()) {
-        return -1;
-    }
-    
-    // 检查当前索引是否有效
-    if (m_currentIndex < 0 || m_currentIndex >= m_playlist.size()) {
-        return 0; // 如果当前索引无效，返回第一首歌曲
+    // 单曲循环模式下接下来仍是当前歌曲，不做预加载
+    if (!m_audioWorker || m_playMode == AudioTypes::PlayMode::RepeatOne) {
+        return;
     }
     
-    int previousIndex = -1;
-    
-    // 根据播放模式计算上一首歌曲索引
-    switch (m_playMode) {
-        case AudioTypes::PlayMode::Loop:
-            previousIndex = (m_currentIndex - 1 + m_playlist.size()) % m_playlist.size();
-            break;
-            
-        case AudioTypes::PlayMode::RepeatOne:
-            previousIndex = m_currentIndex;
-            break;
-            
-        case AudioTypes::PlayMode::Random:
-            // 确保随机模式不会连续播放同一首歌
-            if (m_playlist.size() > 1) {
-                do {
-                    previousIndex = QRandomGenerator::global()->bounded(m_playlist.size());
-                } while (previousIndex == m_currentIndex);
-            } else {
-                previousIndex = 0; // 只有一首歌时返回0
-            }
-            break;
-            
-        default:
-            previousIndex = (m_currentIndex - 1 + m_playlist.size()) % m_playlist.size();
-            break;
+    // 后台映射接下来的几首歌曲（插播队列在前，随机模式按洗牌顺序），播放时文件已在页缓存中
+    const int PRELOAD_AHEAD = 2;
+    for (const Song& song : m_queue->upcoming(PRELOAD_AHEAD)) {
+        m_audioWorker->preloadMedia(song.filePath());
     }
-    
-    return previousIndex;
 }
 
 void AudioEngine::applyAudioEffects()
@@ -1558,8 +1517,8 @@ void AudioEngine::testAudioSystem()
     QAudioDevice device = m_audioOutput->device();
     
     // 测试播放列表
-    if (m_currentIndex >= 0 && m_currentIndex < m_playlist.size()) {
-        const Song& song = m_playlist[m_currentIndex];
+    const Song song = m_queue->currentSong();
+    if (song.isValid()) {
         
         // 检查文件是否存在
         QFileInfo fileInfo(song.filePath());
@@ -1574,8 +1533,8 @@ void AudioEngine::debugAudioState() const
 #ifdef QT_DEBUG
     qDebug() << "=== AudioEngine 状态调试信息 ===";
     qDebug() << "AudioEngine状态:" << getStateString();
-    qDebug() << "播放列表大小:" << m_playlist.size();
-    qDebug() << "当前索引:" << m_currentIndex;
+    qDebug() << "播放列表大小:" << queueSize();
+    qDebug() << "当前索引:" << m_queue->currentPosition();
     
     if (m_player) {
         if (m_player->error() != QMediaPlayer::NoError) {
@@ -1857,6 +1816,7 @@ void AudioEngine::setupFFmpegConnections()
 
 void AudioEngine::onFFmpegAudioDataReady(const QVector<double>& levels)
 {
+    TRACE_FUNCTION("audio");
     if (!m_vuEnabled) {
         return;
     }
@@ -16,12 +16,12 @@
 #include "ffmpegdecoder.h"
 
 #include "../models/song.h"
+#include "../managers/playqueue.h"
 #include "audiotypes.h"
 #include "../threading/audioworkerthread.h"
 
 // 前向声明
 class Logger;
-class PlayHistoryDao;
 
 // 音频引擎类 - 单例模式
 class AudioEngine : public QObject {
@@ -52,6 +52,12 @@ public:
     void playNext();
     void playPrevious();
     
+    // 播放队列：按来源（标签、播放列表、搜索）播放，不复制歌曲列表
+    void setSource(const PlayQueueSource& source, int startSongId, int positionHint = -1);
+    PlayQueue* queue() const;
+    int queueSize() const;
+    bool hasCurrentSong() const;
+    
     // 播放模式
     void setPlayMode(AudioTypes::PlayMode mode);
     AudioTypes::PlayMode playMode() const;
@@ -78,7 +84,7 @@ public:
     qint64 duration() const;
     Song currentSong() const;
     int currentIndex() const;
-    QList<Song> playlist() const;
+    QList<Song> playlist() const;  // 物化整个来源，只需要数量时用queueSize()
     
     // 音频格式支持
     bool isFormatSupported(const QString& filePath) const;
@@ -164,9 +170,8 @@ private:
     bool m_muted;
     bool m_userPaused; // 用户主动暂停标志
     
-    // 播放列表
-    QList<Song> m_playlist;
-    int m_currentIndex;
+    // 播放队列（来源顺序、插播队列和历史）
+    PlayQueue* m_queue;
     AudioTypes::PlayMode m_playMode;
     
     // 音效设置
@@ -179,9 +184,6 @@ private:
     QList<Song> m_playHistory;
     int m_maxHistorySize;
     
-    // 播放历史数据访问对象
-    PlayHistoryDao* m_playHistoryDao;
-    
     // 内部定时器
     QTimer* m_positionTimer;
     QTimer* m_bufferTimer;
@@ -212,9 +214,9 @@ private:
     void loadMedia(const QString& filePath);
     void updateCurrentSong();
     void handlePlaybackFinished();
-    void shufflePlaylist();
-    int getNextIndex();
-    int getPreviousIndex();
+    bool moveInQueue(bool forward);
+    void announceCurrentSong(int oldIndex);
+    void preloadUpcoming();
     
     // 音效处理
     void applyAudioEffects();
@@ -0,0 +1,465 @@
+#include "audioiocontext.h"
+#include "../core/appconfig.h"
+#include "../core/constants.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <cstring>
+#include <cstdio>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/error.h>
+}
+
+// ==================== AudioIOStatistics ====================
+
+AudioIOStatistics& AudioIOStatistics::operator+=(const AudioIOStatistics& other)
+{
+    bytesRead += other.bytesRead;
+    bytesServed += other.bytesServed;
+    readCalls += other.readCalls;
+    seekCalls += other.seekCalls;
+    stallCount += other.stallCount;
+    stallTimeNs += other.stallTimeNs;
+    return *this;
+}
+
+QString AudioIOStatistics::toString() const
+{
+    return QString("读取 %1 字节/%2 次系统调用, 提供 %3 字节, 定位 %4 次, 等待 %5 次/%6 ms")
+        .arg(bytesRead).arg(readCalls).arg(bytesServed).arg(seekCalls)
+        .arg(stallCount).arg(stallTimeNs / 1e6, 0, 'f', 2);
+}
+
+// ==================== AudioIOOptions ====================
+
+AudioIOOptions AudioIOOptions::playback()
+{
+    AudioIOOptions options;
+    AppConfig* config = AppConfig::instance();
+    options.blockSize = qMax(4096, config->getValue("performance/io_block_size",
+                                                    Constants::Performance::IO_BLOCK_SIZE).toInt());
+    options.readAheadBlocks = qMax(1, config->getValue("performance/io_read_ahead_blocks",
+                                                       Constants::Performance::IO_READ_AHEAD_BLOCKS).toInt());
+    options.backgroundReadAhead = true;
+    options.useMappedCache = true;
+    return options;
+}
+
+AudioIOOptions AudioIOOptions::probe()
+{
+    AudioIOOptions options;
+    options.blockSize = Constants::Performance::IO_PROBE_BLOCK_SIZE;
+    options.readAheadBlocks = 0;
+    options.backgroundReadAhead = false;
+    options.useMappedCache = true;
+    return options;
+}
+
+// ==================== MappedFileSource ====================
+
+MappedFileSource::MappedFileSource(std::shared_ptr<MappedAudioFile> file)
+    : m_file(std::move(file))
+    , m_position(0)
+{
+}
+
+int MappedFileSource::read(uint8_t* buffer, int size)
+{
+    const qint64 remaining = m_file->size() - m_position;
+    if (remaining <= 0) {
+        return 0;
+    }
+
+    const int bytesToCopy = static_cast<int>(qMin<qint64>(size, remaining));
+    std::memcpy(buffer, m_file->data() + m_position, bytesToCopy);
+    m_position += bytesToCopy;
+    m_stats.bytesServed += bytesToCopy;
+    return bytesToCopy;
+}
+
+qint64 MappedFileSource::seek(qint64 position)
+{
+    if (position < 0 || position > m_file->size()) {
+        return -1;
+    }
+    ++m_stats.seekCalls;
+    m_position = position;
+    return m_position;
+}
+
+qint64 MappedFileSource::size() const
+{
+    return m_file->size();
+}
+
+qint64 MappedFileSource::position() const
+{
+    return m_position;
+}
+
+AudioIOStatistics MappedFileSource::statistics() const
+{
+    return m_stats;
+}
+
+// ==================== BufferedFileSource ====================
+
+BufferedFileSource::BufferedFileSource(const QString& filePath, const AudioIOOptions& options)
+    : m_filePath(filePath)
+    , m_options(options)
+    , m_file(filePath)
+    , m_readAheadFile(filePath)
+    , m_size(0)
+    , m_position(0)
+    , m_currentBlock(0)
+    , m_loadingBlock(-1)
+    , m_stopping(false)
+    , m_seekCalls(0)
+    , m_stallCount(0)
+    , m_stallTimeNs(0)
+    , m_bytesServed(0)
+    , m_readAheadThread(nullptr)
+    , m_bytesRead(0)
+    , m_readCalls(0)
+{
+    m_options.blockSize = qMax(4096, m_options.blockSize);
+}
+
+BufferedFileSource::~BufferedFileSource()
+{
+    if (m_readAheadThread) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_readAheadWanted.wakeAll();
+        }
+        m_readAheadThread->wait();
+        delete m_readAheadThread;
+        m_readAheadThread = nullptr;
+    }
+}
+
+bool BufferedFileSource::open()
+{
+    // 无缓冲模式下每次read()对应一次系统调用，块大小即实际I/O大小
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qWarning() << "BufferedFileSource: 无法打开文件:" << m_filePath << m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+
+    if (m_options.backgroundReadAhead && m_options.readAheadBlocks > 0
+        && m_readAheadFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        m_readAheadThread = QThread::create([this]() { readAheadLoop(); });
+        m_readAheadThread->start(QThread::LowPriority);
+    }
+    return true;
+}
+
+qint64 BufferedFileSource::blockCount() const
+{
+    return (m_size + m_options.blockSize - 1) / m_options.blockSize;
+}
+
+QByteArray BufferedFileSource::readBlock(QFile& file, qint64 blockIndex)
+{
+    const qint64 offset = blockIndex * m_options.blockSize;
+    const qint64 length = qMin<qint64>(m_options.blockSize, m_size - offset);
+    if (length <= 0 || !file.seek(offset)) {
+        return QByteArray();
+    }
+
+    QByteArray data(length, Qt::Uninitialized);
+    qint64 total = 0;
+    while (total < length) {
+        const qint64 bytes = file.read(data.data() + total, length - total);
+        ++m_readCalls;
+        if (bytes <= 0) {
+            break;
+        }
+        total += bytes;
+    }
+    m_bytesRead += total;
+
+    if (total < length) {
+        data.truncate(total);
+    }
+    return data;
+}
+
+int BufferedFileSource::read(uint8_t* buffer, int size)
+{
+    if (m_position >= m_size) {
+        return 0;
+    }
+
+    const qint64 blockIndex = m_position / m_options.blockSize;
+    const qint64 offsetInBlock = m_position % m_options.blockSize;
+
+    QMutexLocker locker(&m_mutex);
+    setCurrentBlock(blockIndex);
+
+    QElapsedTimer stallTimer;
+    auto it = m_blocks.constFind(blockIndex);
+    while (it == m_blocks.constEnd()) {
+        if (!stallTimer.isValid()) {
+            stallTimer.start();
+        }
+        if (m_loadingBlock == blockIndex) {
+            // 预读线程正在读取该块，等待完成
+            m_blockReady.wait(&m_mutex);
+        } else {
+            // 同步读取，I/O期间不持有锁
+            locker.unlock();
+            QByteArray data = readBlock(m_file, blockIndex);
+            locker.relock();
+            if (data.isEmpty()) {
+                qWarning() << "BufferedFileSource: 读取失败:" << m_filePath << "块" << blockIndex;
+                return -1;
+            }
+            m_blocks.insert(blockIndex, data);
+        }
+        it = m_blocks.constFind(blockIndex);
+    }
+
+    if (stallTimer.isValid()) {
+        ++m_stallCount;
+        m_stallTimeNs += stallTimer.nsecsElapsed();
+    }
+
+    const QByteArray& data = it.value();
+    const int bytesToCopy = static_cast<int>(qMin<qint64>(size, data.size() - offsetInBlock));
+    if (bytesToCopy <= 0) {
+        return 0;
+    }
+    std::memcpy(buffer, data.constData() + offsetInBlock, bytesToCopy);
+    m_position += bytesToCopy;
+    m_bytesServed += bytesToCopy;
+    return bytesToCopy;
+}
+
+qint64 BufferedFileSource::seek(qint64 position)
+{
+    if (position < 0 || position > m_size) {
+        return -1;
+    }
+
+    m_position = position;
+    QMutexLocker locker(&m_mutex);
+    ++m_seekCalls;
+    setCurrentBlock(position / m_options.blockSize);
+    return m_position;
+}
+
+void BufferedFileSource::setCurrentBlock(qint64 blockIndex)
+{
+    // 调用方持有m_mutex
+    if (blockIndex == m_currentBlock) {
+        return;
+    }
+    m_currentBlock = blockIndex;
+    trimBlocks();
+    m_readAheadWanted.wakeOne();
+}
+
+void BufferedFileSource::trimBlocks()
+{
+    // 调用方持有m_mutex；保留前一块以支持小幅回退，丢弃预读窗口之外的块
+    const qint64 first = m_currentBlock - 1;
+    const qint64 last = m_currentBlock + m_options.readAheadBlocks;
+    for (auto it = m_blocks.begin(); it != m_blocks.end();) {
+        if (it.key() < first || it.key() > last) {
+            it = m_blocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void BufferedFileSource::readAheadLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 totalBlocks = blockCount();
+
+    while (!m_stopping) {
+        // 在[当前块, 当前块+N]中找第一个缺失的块
+        qint64 nextBlock = -1;
+        for (qint64 i = 0; i <= m_options.readAheadBlocks; ++i) {
+            const qint64 candidate = m_currentBlock + i;
+            if (candidate >= totalBlocks) {
+                break;
+            }
+            if (!m_blocks.contains(candidate)) {
+                nextBlock = candidate;
+                break;
+            }
+        }
+
+        if (nextBlock < 0) {
+            m_readAheadWanted.wait(&m_mutex);
+            continue;
+        }
+
+        m_loadingBlock = nextBlock;
+        locker.unlock();
+        QByteArray data = readBlock(m_readAheadFile, nextBlock);
+        locker.relock();
+        m_loadingBlock = -1;
+
+        const bool inWindow = nextBlock >= m_currentBlock - 1
+                              && nextBlock <= m_currentBlock + m_options.readAheadBlocks;
+        if (!data.isEmpty() && inWindow) {
+            m_blocks.insert(nextBlock, data);
+        }
+        m_blockReady.wakeAll();
+
+        if (data.isEmpty()) {
+            // 读取失败时交给前台同步读取处理错误，避免空转
+            m_readAheadWanted.wait(&m_mutex, 100);
+        }
+    }
+}
+
+qint64 BufferedFileSource::size() const
+{
+    return m_size;
+}
+
+qint64 BufferedFileSource::position() const
+{
+    return m_position;
+}
+
+AudioIOStatistics BufferedFileSource::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    AudioIOStatistics stats;
+    stats.bytesRead = m_bytesRead;
+    stats.bytesServed = m_bytesServed;
+    stats.readCalls = m_readCalls;
+    stats.seekCalls = m_seekCalls;
+    stats.stallCount = m_stallCount;
+    stats.stallTimeNs = m_stallTimeNs;
+    return stats;
+}
+
+// ==================== AudioIOContext ====================
+
+QMutex AudioIOContext::s_statsMutex;
+AudioIOStatistics AudioIOContext::s_globalStats;
+
+AVIOContext* AudioIOContext::open(const QString& filePath, const AudioIOOptions& options)
+{
+    // 已预加载的文件直接读内存映射
+    if (options.useMappedCache) {
+        if (std::shared_ptr<MappedAudioFile> mappedFile = MappedFileCache::instance()->acquire(filePath)) {
+            return create(std::unique_ptr<AudioIOSource>(new MappedFileSource(mappedFile)));
+        }
+    }
+
+    std::unique_ptr<BufferedFileSource> source(new BufferedFileSource(filePath, options));
+    if (!source->open()) {
+        return nullptr;
+    }
+    return create(std::move(source));
+}
+
+AVIOContext* AudioIOContext::create(std::unique_ptr<AudioIOSource> source)
+{
+    if (!source) {
+        return nullptr;
+    }
+
+    const int bufferSize = Constants::Performance::AVIO_BUFFER_SIZE;
+    unsigned char* buffer = static_cast<unsigned char*>(av_malloc(bufferSize));
+    if (!buffer) {
+        return nullptr;
+    }
+
+    AudioIOSource* rawSource = source.release();
+    AVIOContext* context = avio_alloc_context(buffer, bufferSize, 0, rawSource,
+                                              &AudioIOContext::readPacket, nullptr,
+                                              &AudioIOContext::seekPacket);
+    if (!context) {
+        av_free(buffer);
+        delete rawSource;
+        return nullptr;
+    }
+    return context;
+}
+
+void AudioIOContext::free(AVIOContext** context)
+{
+    if (!context || !*context) {
+        return;
+    }
+
+    AudioIOSource* source = static_cast<AudioIOSource*>((*context)->opaque);
+    if (source) {
+        QMutexLocker locker(&s_statsMutex);
+        s_globalStats += source->statistics();
+    }
+    delete source;
+
+    // 缓冲区可能已被FFmpeg重新分配，必须释放上下文当前持有的那个
+    av_freep(&(*context)->buffer);
+    avio_context_free(context);
+}
+
+AudioIOStatistics AudioIOContext::statistics(AVIOContext* context)
+{
+    if (!context || !context->opaque) {
+        return AudioIOStatistics();
+    }
+    return static_cast<AudioIOSource*>(context->opaque)->statistics();
+}
+
+AudioIOStatistics AudioIOContext::globalStatistics()
+{
+    QMutexLocker locker(&s_statsMutex);
+    return s_globalStats;
+}
+
+void AudioIOContext::resetGlobalStatistics()
+{
+    QMutexLocker locker(&s_statsMutex);
+    s_globalStats = AudioIOStatistics();
+}
+
+int AudioIOContext::readPacket(void* opaque, uint8_t* buffer, int bufferSize)
+{
+    const int bytes = static_cast<AudioIOSource*>(opaque)->read(buffer, bufferSize);
+    if (bytes == 0) {
+        return AVERROR_EOF;
+    }
+    return bytes < 0 ? AVERROR(EIO) : bytes;
+}
+
+int64_t AudioIOContext::seekPacket(void* opaque, int64_t offset, int whence)
+{
+    AudioIOSource* source = static_cast<AudioIOSource*>(opaque);
+
+    if (whence & AVSEEK_SIZE) {
+        return source->size();
+    }
+
+    qint64 target = 0;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = source->position() + offset;
+            break;
+        case SEEK_END:
+            target = source->size() + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+
+    const qint64 result = source->seek(target);
+    return result < 0 ? AVERROR(EINVAL) : result;
+}
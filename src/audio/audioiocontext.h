@@ -0,0 +1,203 @@
+#ifndef AUDIOIOCONTEXT_H
+#define AUDIOIOCONTEXT_H
+
+#include <QString>
+#include <QFile>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+#include "mappedfilecache.h"
+
+// FFmpeg头文件
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+/**
+ * @brief 音频I/O统计信息
+ */
+struct AudioIOStatistics {
+    qint64 bytesRead = 0;      // 从存储读取的字节数
+    qint64 bytesServed = 0;    // 交给FFmpeg的字节数
+    qint64 readCalls = 0;      // 读系统调用次数
+    qint64 seekCalls = 0;      // FFmpeg发起的定位次数
+    qint64 stallCount = 0;     // 读取时数据未就绪的次数
+    qint64 stallTimeNs = 0;    // 等待数据的总耗时（纳秒）
+
+    AudioIOStatistics& operator+=(const AudioIOStatistics& other);
+    QString toString() const;
+};
+
+/**
+ * @brief 音频I/O参数
+ */
+struct AudioIOOptions {
+    int blockSize = 0;              // 每次从存储读取的块大小
+    int readAheadBlocks = 0;        // 当前块之后预读的块数
+    bool backgroundReadAhead = false;  // 是否启用后台预读线程
+    bool useMappedCache = true;     // 已预加载的文件是否直接读映射
+
+    /**
+     * @brief 播放参数：大块读取+后台预读，可通过配置
+     *        performance/io_block_size、performance/io_read_ahead_blocks调整
+     */
+    static AudioIOOptions playback();
+
+    /**
+     * @brief 元数据扫描参数：大块同步读取，不启动预读线程
+     */
+    static AudioIOOptions probe();
+};
+
+/**
+ * @brief 音频数据源接口，AudioIOContext通过它为FFmpeg提供数据
+ */
+class AudioIOSource
+{
+public:
+    virtual ~AudioIOSource() = default;
+
+    /**
+     * @brief 从当前位置读取数据
+     * @return 读取的字节数，0表示文件结束，负数表示错误
+     */
+    virtual int read(uint8_t* buffer, int size) = 0;
+
+    /**
+     * @brief 定位到绝对位置
+     * @return 新位置，负数表示错误
+     */
+    virtual qint64 seek(qint64 position) = 0;
+
+    virtual qint64 size() const = 0;
+    virtual qint64 position() const = 0;
+    virtual AudioIOStatistics statistics() const = 0;
+};
+
+/**
+ * @brief 读取MappedFileCache中已预加载文件的数据源
+ */
+class MappedFileSource : public AudioIOSource
+{
+public:
+    explicit MappedFileSource(std::shared_ptr<MappedAudioFile> file);
+
+    int read(uint8_t* buffer, int size) override;
+    qint64 seek(qint64 position) override;
+    qint64 size() const override;
+    qint64 position() const override;
+    AudioIOStatistics statistics() const override;
+
+private:
+    std::shared_ptr<MappedAudioFile> m_file;
+    qint64 m_position;
+    AudioIOStatistics m_stats;
+};
+
+/**
+ * @brief 大块缓冲的文件数据源
+ * @details 按固定大小的对齐块读取文件，网络挂载和机械硬盘上可以把大量小读取合并为少量大读取。
+ *          启用后台预读时，预读线程使用独立的文件句柄，始终保持当前块之后的若干块已在内存中，
+ *          FFmpeg读取时只有预读跟不上才会阻塞（计入stall统计）。
+ */
+class BufferedFileSource : public AudioIOSource
+{
+public:
+    BufferedFileSource(const QString& filePath, const AudioIOOptions& options);
+    ~BufferedFileSource() override;
+
+    bool open();
+
+    int read(uint8_t* buffer, int size) override;
+    qint64 seek(qint64 position) override;
+    qint64 size() const override;
+    qint64 position() const override;
+    AudioIOStatistics statistics() const override;
+
+private:
+    QByteArray readBlock(QFile& file, qint64 blockIndex);
+    void readAheadLoop();
+    void setCurrentBlock(qint64 blockIndex);
+    void trimBlocks();
+    qint64 blockCount() const;
+
+    QString m_filePath;
+    AudioIOOptions m_options;
+
+    QFile m_file;               // 前台同步读取句柄
+    QFile m_readAheadFile;      // 预读线程专用句柄
+    qint64 m_size;
+    qint64 m_position;
+
+    // 块缓存，m_mutex保护以下成员
+    mutable QMutex m_mutex;
+    QWaitCondition m_blockReady;
+    QWaitCondition m_readAheadWanted;
+    QHash<qint64, QByteArray> m_blocks;
+    qint64 m_currentBlock;
+    qint64 m_loadingBlock;
+    bool m_stopping;
+    qint64 m_seekCalls;
+    qint64 m_stallCount;
+    qint64 m_stallTimeNs;
+    qint64 m_bytesServed;
+
+    QThread* m_readAheadThread;
+
+    // 两个句柄都会更新
+    std::atomic<qint64> m_bytesRead;
+    std::atomic<qint64> m_readCalls;
+};
+
+/**
+ * @brief FFmpeg自定义I/O上下文工厂
+ * @details 解码器和元数据解析都通过这里打开文件：已预加载的文件读内存映射，
+ *          其他文件使用BufferedFileSource。上下文释放时统计信息汇总到全局统计。
+ */
+class AudioIOContext
+{
+public:
+    /**
+     * @brief 为文件创建AVIOContext
+     * @param filePath 文件路径
+     * @param options I/O参数
+     * @return AVIOContext，失败返回nullptr；需使用free()释放
+     */
+    static AVIOContext* open(const QString& filePath, const AudioIOOptions& options);
+
+    /**
+     * @brief 用指定数据源创建AVIOContext（接管数据源所有权）
+     */
+    static AVIOContext* create(std::unique_ptr<AudioIOSource> source);
+
+    /**
+     * @brief 释放AVIOContext及其数据源
+     * @param context AVIOContext指针的地址，释放后置空
+     */
+    static void free(AVIOContext** context);
+
+    /**
+     * @brief 获取单个上下文的统计信息
+     */
+    static AudioIOStatistics statistics(AVIOContext* context);
+
+    /**
+     * @brief 获取所有已释放上下文的累计统计信息
+     */
+    static AudioIOStatistics globalStatistics();
+    static void resetGlobalStatistics();
+
+private:
+    static int readPacket(void* opaque, uint8_t* buffer, int bufferSize);
+    static int64_t seekPacket(void* opaque, int64_t offset, int whence);
+
+    static QMutex s_statsMutex;
+    static AudioIOStatistics s_globalStats;
+};
+
+#endif // AUDIOIOCONTEXT_H
@@ -0,0 +1,116 @@
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <QtGlobal>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief 逐样本处理内核
+ * @details 从FFmpegDecoder::processAudioFrame中提取，供解码循环和基准测试共用。
+ *          平衡增益在循环外计算一次，循环体内没有分支。
+ */
+namespace AudioKernels {
+
+/**
+ * @brief 由平衡值计算左右声道增益
+ * @param balance 平衡值，-1.0（左）到1.0（右）
+ */
+inline void balanceGains(double balance, double* leftGain, double* rightGain)
+{
+    if (balance < 0) {
+        // 左声道增强
+        *leftGain = 1.0 + qAbs(balance);
+        *rightGain = 1.0 - qAbs(balance) * 0.5;
+    } else if (balance > 0) {
+        // 右声道增强
+        *leftGain = 1.0 - balance * 0.5;
+        *rightGain = 1.0 + balance;
+    } else {
+        *leftGain = 1.0;
+        *rightGain = 1.0;
+    }
+}
+
+/**
+ * @brief 对交错立体声float样本应用平衡并限幅到[-1, 1]
+ * @param samples 交错样本，原地修改
+ * @param frameCount 帧数（每帧两个样本）
+ */
+inline void applyBalance(float* samples, int frameCount, double balance)
+{
+    double leftGain = 1.0;
+    double rightGain = 1.0;
+    balanceGains(balance, &leftGain, &rightGain);
+
+    for (int i = 0; i < frameCount; ++i) {
+        const float left = static_cast<float>(samples[i * 2] * leftGain);
+        const float right = static_cast<float>(samples[i * 2 + 1] * rightGain);
+        samples[i * 2] = qBound(-1.0f, left, 1.0f);
+        samples[i * 2 + 1] = qBound(-1.0f, right, 1.0f);
+    }
+}
+
+/**
+ * @brief 对交错立体声int16样本应用平衡并限幅
+ */
+inline void applyBalance(int16_t* samples, int frameCount, double balance)
+{
+    double leftGain = 1.0;
+    double rightGain = 1.0;
+    balanceGains(balance, &leftGain, &rightGain);
+
+    for (int i = 0; i < frameCount; ++i) {
+        float left = static_cast<float>((samples[i * 2] / 32768.0f) * leftGain);
+        float right = static_cast<float>((samples[i * 2 + 1] / 32768.0f) * rightGain);
+        left = qBound(-1.0f, left, 1.0f);
+        right = qBound(-1.0f, right, 1.0f);
+        samples[i * 2] = static_cast<int16_t>(left * 32767.0f);
+        samples[i * 2 + 1] = static_cast<int16_t>(right * 32767.0f);
+    }
+}
+
+/**
+ * @brief int16样本转换为[-1, 1)的float样本
+ */
+inline void int16ToFloat(const int16_t* input, float* output, int sampleCount)
+{
+    for (int i = 0; i < sampleCount; ++i) {
+        output[i] = input[i] / 32768.0f;
+    }
+}
+
+/**
+ * @brief 计算左右声道RMS电平，结果限制在[0, 1]
+ * @param samples 交错样本
+ * @param frameCount 帧数
+ * @param channels 声道数；单声道时左右电平相同，多于两个声道时只取前两个
+ */
+inline void rmsLevels(const float* samples, int frameCount, int channels, double* left, double* right)
+{
+    double leftSum = 0.0;
+    double rightSum = 0.0;
+
+    if (channels == 1) {
+        for (int i = 0; i < frameCount; ++i) {
+            const double sample = samples[i];
+            leftSum += sample * sample;
+        }
+        rightSum = leftSum;
+    } else {
+        // 与原实现一致：按两个样本的步长读取
+        for (int i = 0; i < frameCount; ++i) {
+            const double leftSample = samples[i * 2];
+            const double rightSample = samples[i * 2 + 1];
+            leftSum += leftSample * leftSample;
+            rightSum += rightSample * rightSample;
+        }
+    }
+
+    *left = qBound(0.0, std::sqrt(leftSum / frameCount), 1.0);
+    *right = qBound(0.0, std::sqrt(rightSum / frameCount), 1.0);
+}
+
+} // namespace AudioKernels
+
+#endif // AUDIOKERNELS_H
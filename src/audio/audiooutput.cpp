@@ -0,0 +1,269 @@
+#include "audiooutput.h"
+#include <QAudioSink>
+#include <QAudioDevice>
+#include <QMediaDevices>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+QAudioFormat resolveOutputFormat(const QAudioFormat& sourceFormat, const QAudioFormat& targetFormat)
+{
+    QAudioFormat format;
+    format.setSampleRate(targetFormat.sampleRate() > 0 ? targetFormat.sampleRate() : sourceFormat.sampleRate());
+    const int channels = targetFormat.channelCount() > 0 ? targetFormat.channelCount() : sourceFormat.channelCount();
+    format.setChannelCount(qBound(1, channels, 2));
+    format.setSampleFormat(targetFormat.sampleFormat() != QAudioFormat::Unknown
+                           ? targetFormat.sampleFormat() : QAudioFormat::Float);
+    return format;
+}
+
+// ==================== DeviceAudioOutput ====================
+
+DeviceAudioOutput::DeviceAudioOutput()
+    : m_sink(nullptr)
+    , m_device(nullptr)
+{
+}
+
+DeviceAudioOutput::~DeviceAudioOutput()
+{
+    close();
+}
+
+bool DeviceAudioOutput::open(const QAudioFormat& sourceFormat)
+{
+    Q_UNUSED(sourceFormat)
+    qDebug() << "DeviceAudioOutput: 设置音频输出";
+
+    // 获取默认音频设备
+    QMediaDevices mediaDevices;
+    QList<QAudioDevice> audioOutputs = mediaDevices.audioOutputs();
+
+    if (audioOutputs.isEmpty()) {
+        qWarning() << "DeviceAudioOutput: 没有找到音频输出设备";
+        return false;
+    }
+
+    QAudioDevice defaultDevice = audioOutputs.first();
+    m_deviceName = defaultDevice.description();
+    qDebug() << "DeviceAudioOutput: 使用音频设备:" << m_deviceName;
+
+    // 使用设备首选格式，而不是强制设置
+    m_format = defaultDevice.preferredFormat();
+
+    qDebug() << "DeviceAudioOutput: 设备首选格式 - 采样率:" << m_format.sampleRate()
+             << "，声道数:" << m_format.channelCount()
+             << "，采样格式:" << m_format.sampleFormat();
+
+    // 确保格式兼容性，如果设备不支持首选格式，回退到基本格式
+    if (!defaultDevice.isFormatSupported(m_format)) {
+        qWarning() << "DeviceAudioOutput: 设备不支持首选格式，使用基本格式";
+        m_format.setSampleRate(44100);
+        m_format.setChannelCount(2);
+        m_format.setSampleFormat(QAudioFormat::Int16);
+
+        // 再次检查基本格式是否支持
+        if (!defaultDevice.isFormatSupported(m_format)) {
+            qCritical() << "DeviceAudioOutput: 设备不支持基本音频格式";
+            return false;
+        }
+    }
+
+    qDebug() << "DeviceAudioOutput: 最终使用音频格式 - 采样率:" << m_format.sampleRate()
+             << "，声道数:" << m_format.channelCount()
+             << "，采样格式:" << m_format.sampleFormat();
+
+    // 创建音频输出
+    m_sink = new QAudioSink(defaultDevice, m_format);
+
+    // 设置缓冲区大小（32KB）
+    m_sink->setBufferSize(32768);
+    qDebug() << "DeviceAudioOutput: 设置音频缓冲区大小:" << m_sink->bufferSize() << "字节";
+
+    // 设置音量
+    m_sink->setVolume(1.0);
+
+    // 获取音频设备
+    m_device = m_sink->start();
+
+    if (!m_device) {
+        qWarning() << "DeviceAudioOutput: 无法启动音频设备";
+        close();
+        return false;
+    }
+
+    m_bytesWritten = 0;
+    qDebug() << "DeviceAudioOutput: 音频输出设置成功";
+    return true;
+}
+
+void DeviceAudioOutput::close()
+{
+    if (m_sink) {
+        m_sink->stop();
+        delete m_sink;
+        m_sink = nullptr;
+    }
+    m_device = nullptr;
+}
+
+qint64 DeviceAudioOutput::write(const char* data, qint64 size)
+{
+    if (!m_device) {
+        return 0;
+    }
+    const qint64 written = m_device->write(data, size);
+    if (written > 0) {
+        m_bytesWritten += written;
+    }
+    return written;
+}
+
+qint64 DeviceAudioOutput::bufferSize() const
+{
+    return m_sink ? m_sink->bufferSize() : 0;
+}
+
+qint64 DeviceAudioOutput::bytesFree() const
+{
+    return m_sink ? m_sink->bytesFree() : 0;
+}
+
+qint64 DeviceAudioOutput::processedUSecs() const
+{
+    return m_sink ? m_sink->processedUSecs() : 0;
+}
+
+QString DeviceAudioOutput::description() const
+{
+    return QString("device(%1)").arg(m_deviceName);
+}
+
+// ==================== NullAudioOutput ====================
+
+NullAudioOutput::NullAudioOutput(const QAudioFormat& targetFormat)
+    : m_targetFormat(targetFormat)
+{
+}
+
+bool NullAudioOutput::open(const QAudioFormat& sourceFormat)
+{
+    m_format = resolveOutputFormat(sourceFormat, m_targetFormat);
+    m_bytesWritten = 0;
+    return m_format.isValid();
+}
+
+qint64 NullAudioOutput::write(const char* data, qint64 size)
+{
+    Q_UNUSED(data)
+    m_bytesWritten += size;
+    return size;
+}
+
+// ==================== FileAudioOutput ====================
+
+namespace {
+
+const int WAV_HEADER_SIZE = 44;
+const quint16 WAVE_FORMAT_PCM = 1;
+const quint16 WAVE_FORMAT_IEEE_FLOAT = 3;
+
+} // namespace
+
+FileAudioOutput::FileAudioOutput(const QString& filePath, Container container, const QAudioFormat& targetFormat)
+    : m_file(filePath)
+    , m_container(container)
+    , m_targetFormat(targetFormat)
+{
+}
+
+FileAudioOutput::~FileAudioOutput()
+{
+    close();
+}
+
+bool FileAudioOutput::open(const QAudioFormat& sourceFormat)
+{
+    m_format = resolveOutputFormat(sourceFormat, m_targetFormat);
+    if (m_container == Container::RawFloat) {
+        // 原始数据没有文件头记录格式，固定为float
+        m_format.setSampleFormat(QAudioFormat::Float);
+    } else if (m_format.sampleFormat() == QAudioFormat::UInt8) {
+        m_format.setSampleFormat(QAudioFormat::Int16);
+    }
+    if (!m_format.isValid()) {
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "FileAudioOutput: 无法创建输出文件:" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    m_bytesWritten = 0;
+    // 数据长度在关闭时回填
+    if (m_container == Container::Wav && !writeWavHeader(0)) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void FileAudioOutput::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    if (m_container == Container::Wav) {
+        if (!m_file.seek(0) || !writeWavHeader(m_bytesWritten)) {
+            qWarning() << "FileAudioOutput: 回填WAV文件头失败:" << m_file.fileName();
+        }
+    }
+    m_file.close();
+}
+
+qint64 FileAudioOutput::write(const char* data, qint64 size)
+{
+    if (!m_file.isOpen()) {
+        return 0;
+    }
+    const qint64 written = m_file.write(data, size);
+    if (written > 0) {
+        m_bytesWritten += written;
+    }
+    return written;
+}
+
+QString FileAudioOutput::description() const
+{
+    return QString("%1(%2)").arg(m_container == Container::Wav ? "wav" : "raw-f32", m_file.fileName());
+}
+
+bool FileAudioOutput::writeWavHeader(qint64 dataBytes)
+{
+    const quint16 channels = static_cast<quint16>(m_format.channelCount());
+    const quint32 sampleRate = static_cast<quint32>(m_format.sampleRate());
+    const quint16 bytesPerSample = static_cast<quint16>(m_format.bytesPerSample());
+    const quint16 formatTag = m_format.sampleFormat() == QAudioFormat::Float ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+    // RIFF长度字段为32位，超过4GB时截断（与常见编码器的行为一致）
+    const quint32 dataSize = static_cast<quint32>(qMin<qint64>(dataBytes, 0xFFFFFFFFLL - WAV_HEADER_SIZE));
+
+    QByteArray header;
+    header.reserve(WAV_HEADER_SIZE);
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("RIFF", 4);
+    stream << quint32(dataSize + WAV_HEADER_SIZE - 8);
+    stream.writeRawData("WAVE", 4);
+    stream.writeRawData("fmt ", 4);
+    stream << quint32(16) << formatTag << channels << sampleRate
+           << quint32(sampleRate * channels * bytesPerSample)
+           << quint16(channels * bytesPerSample)
+           << quint16(bytesPerSample * 8);
+    stream.writeRawData("data", 4);
+    stream << dataSize;
+
+    return m_file.write(header) == header.size();
+}
@@ -0,0 +1,134 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <QString>
+#include <QFile>
+#include <QAudioFormat>
+
+class QAudioSink;
+class QIODevice;
+
+/**
+ * @brief 解码器的输出端
+ * @details FFmpegDecoder把重采样、平衡处理后的交错PCM写入AudioOutput。
+ *          播放时使用声卡输出；离线解码使用空输出或文件输出，不需要音频设备。
+ */
+class AudioOutput
+{
+public:
+    virtual ~AudioOutput() = default;
+
+    /**
+     * @brief 打开输出并确定输出格式
+     * @param sourceFormat 解码流的采样率和声道数（采样格式为Float）
+     * @return 是否成功；成功后format()为解码器需要产生的格式
+     */
+    virtual bool open(const QAudioFormat& sourceFormat) = 0;
+    virtual void close() = 0;
+
+    /**
+     * @brief 写入交错PCM数据
+     * @return 实际写入的字节数
+     */
+    virtual qint64 write(const char* data, qint64 size) = 0;
+
+    /**
+     * @brief 是否按播放速度消费数据（声卡输出）
+     */
+    virtual bool isRealtime() const { return false; }
+
+    // 设备缓冲区状态，非实时输出均返回0
+    virtual qint64 bufferSize() const { return 0; }
+    virtual qint64 bytesFree() const { return 0; }
+    virtual qint64 processedUSecs() const { return 0; }
+
+    virtual QString description() const = 0;
+
+    QAudioFormat format() const { return m_format; }
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+protected:
+    QAudioFormat m_format;
+    qint64 m_bytesWritten = 0;
+};
+
+/**
+ * @brief 声卡输出（QAudioSink），使用默认设备的首选格式
+ */
+class DeviceAudioOutput : public AudioOutput
+{
+public:
+    DeviceAudioOutput();
+    ~DeviceAudioOutput() override;
+
+    bool open(const QAudioFormat& sourceFormat) override;
+    void close() override;
+    qint64 write(const char* data, qint64 size) override;
+
+    bool isRealtime() const override { return true; }
+    qint64 bufferSize() const override;
+    qint64 bytesFree() const override;
+    qint64 processedUSecs() const override;
+    QString description() const override;
+
+private:
+    QAudioSink* m_sink;
+    QIODevice* m_device;
+    QString m_deviceName;
+};
+
+/**
+ * @brief 丢弃所有数据的输出，用于测量解码处理链吞吐量
+ */
+class NullAudioOutput : public AudioOutput
+{
+public:
+    /**
+     * @param targetFormat 输出格式；采样率或声道数无效时沿用解码流（最多两声道）
+     */
+    explicit NullAudioOutput(const QAudioFormat& targetFormat = QAudioFormat());
+
+    bool open(const QAudioFormat& sourceFormat) override;
+    void close() override {}
+    qint64 write(const char* data, qint64 size) override;
+    QString description() const override { return "null"; }
+
+private:
+    QAudioFormat m_targetFormat;
+};
+
+/**
+ * @brief 写入文件的输出：WAV（int16/int32/float）或无文件头的float原始数据
+ */
+class FileAudioOutput : public AudioOutput
+{
+public:
+    enum class Container {
+        Wav,
+        RawFloat
+    };
+
+    FileAudioOutput(const QString& filePath, Container container,
+                    const QAudioFormat& targetFormat = QAudioFormat());
+    ~FileAudioOutput() override;
+
+    bool open(const QAudioFormat& sourceFormat) override;
+    void close() override;
+    qint64 write(const char* data, qint64 size) override;
+    QString description() const override;
+
+private:
+    bool writeWavHeader(qint64 dataBytes);
+
+    QFile m_file;
+    Container m_container;
+    QAudioFormat m_targetFormat;
+};
+
+/**
+ * @brief 由解码流格式和目标格式得出非设备输出的格式
+ * @details 目标格式中无效的字段沿用解码流；声道数限制为1或2（解码器只输出单声道或立体声）。
+ */
+QAudioFormat resolveOutputFormat(const QAudioFormat& sourceFormat, const QAudioFormat& targetFormat);
+
+#endif // AUDIOOUTPUT_H
@@ -1,12 +1,47 @@
 #include "ffmpegdecoder.h"
+#include "audioiocontext.h"
+#include "audiokernels.h"
+#include "waveformcache.h"
+#include "../core/logger.h"
+#include "../core/tracer.h"
+#include "../core/metricsregistry.h"
 #include <QDebug>
 #include <QFileInfo>
+#include <QElapsedTimer>
 #include <QtMath>
 #include <cstdint>  // 为int16_t类型
 
+namespace {
+
+// 把作用域的耗时累加到某个阶段；未开启分阶段计时时不读时钟
+class StageTimer
+{
+public:
+    StageTimer(bool enabled, qint64* total)
+        : m_total(enabled ? total : nullptr)
+    {
+        if (m_total) {
+            m_timer.start();
+        }
+    }
+    ~StageTimer()
+    {
+        if (m_total) {
+            *m_total += m_timer.nsecsElapsed();
+        }
+    }
+
+private:
+    qint64* m_total;
+    QElapsedTimer m_timer;
+};
+
+} // namespace
+
 FFmpegDecoder::FFmpegDecoder(QObject* parent)
     : QObject(parent)
     , m_formatContext(nullptr)
+    , m_ioContext(nullptr)
     , m_codecContext(nullptr)
     , m_swrContext(nullptr)
     , m_inputFrame(nullptr)
@@ -21,8 +56,7 @@ FFmpegDecoder::FFmpegDecoder(QObject* parent)
     , m_isEndOfFile(false)
     , m_currentLevels(2, 0.0)
     , m_balance(0.0)
-    , m_audioSink(nullptr)
-    , m_audioDevice(nullptr)
+    , m_stageTimingEnabled(false)
 {
     qDebug() << "FFmpegDecoder: 构造函数";
 }
@@ -47,8 +81,6 @@ bool FFmpegDecoder::initialize()
         m_packet = nullptr;
         m_decodeThread = nullptr;
         m_decodeTimer = nullptr;
-        m_audioSink = nullptr;
-        m_audioDevice = nullptr;
         
         m_audioStreamIndex = -1;
         m_duration = 0;
@@ -146,6 +178,15 @@ bool FFmpegDecoder::openFile(const QString& filePath)
         
         qDebug() << "FFmpegDecoder: 格式上下文分配成功";
         
+        // 通过自定义I/O读取：已预加载的文件读内存映射，否则大块读取+后台预读
+        m_ioContext = AudioIOContext::open(filePath, AudioIOOptions::playback());
+        if (m_ioContext) {
+            m_formatContext->pb = m_ioContext;
+            m_formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        } else {
+            qWarning() << "FFmpegDecoder: 自定义I/O创建失败，使用FFmpeg默认文件I/O";
+        }
+        
         qDebug() << "FFmpegDecoder: 打开输入文件...";
         if (avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
             qCritical() << "FFmpegDecoder: 无法打开输入文件";
@@ -313,6 +354,9 @@ bool FFmpegDecoder::startDecoding()
             qWarning() << "FFmpegDecoder: 解码线程已运行或不存在";
         }
         
+        // 播放期间波形生成器降低占空比
+        WaveformCache::instance()->setPlaybackActive(true);
+        
         return true;
         
     } catch (const std::exception& e) {
@@ -338,6 +382,7 @@ void FFmpegDecoder::stopDecoding()
         
         qDebug() << "FFmpegDecoder: 设置解码状态为停止...";
         m_isDecoding.storeRelease(0);
+        WaveformCache::instance()->setPlaybackActive(false);
         
         qDebug() << "FFmpegDecoder: 解码停止完成";
         
@@ -472,92 +517,140 @@ bool FFmpegDecoder::isEndOfFile() const
 
 void FFmpegDecoder::decodeLoop()
 {
-    qDebug() << "FFmpegDecoder: 解码循环开始...";
+    // 每个数据包都会进入这里，日志使用可裁剪的宏，参数只在启用时进入日志缓冲区
+    LOGGER_DEBUG_FMT("FFmpegDecoder", "解码循环开始，当前位置: %1ms", m_currentPosition);
     
     // 检查解码状态（不需要锁，因为m_isDecoding是原子操作）
     if (!m_isDecoding.loadAcquire()) {
-        qDebug() << "FFmpegDecoder: 未在解码中，退出解码循环";
+        LOGGER_DEBUG("FFmpegDecoder", "未在解码中，退出解码循环");
         return;
     }
     
+    decodeNextPacket();
+}
+
+bool FFmpegDecoder::decodeToEnd()
+{
+    TRACE_FUNCTION("audio");
+    
+    if (!m_formatContext || !m_codecContext || !m_output) {
+        qWarning() << "FFmpegDecoder: 未打开文件，无法离线解码";
+        return false;
+    }
+    
+    m_isDecoding.storeRelease(1);
+    m_isEndOfFile = false;
+    
+    // 到达文件末尾时decodeNextPacket()已取出解码器延迟的尾部帧
+    int result = 0;
+    while ((result = decodeNextPacket()) > 0) {
+    }
+    
+    m_isDecoding.storeRelease(0);
+    return result == 0;
+}
+
+int FFmpegDecoder::decodeNextPacket()
+{
     // 使用局部锁保护FFmpeg操作
+    QMutexLocker locker(&m_mutex);
+    
+    if (!m_formatContext || !m_codecContext) {
+        qWarning() << "FFmpegDecoder: 格式上下文或编解码器上下文为空";
+        return -1;
+    }
+    
+    // 读取数据包
+    int ret = 0;
     {
-        QMutexLocker locker(&m_mutex);
-        
-        if (!m_formatContext || !m_codecContext) {
-            qWarning() << "FFmpegDecoder: 格式上下文或编解码器上下文为空";
-            return;
-        }
-        
-        // 读取数据包
-        int ret = av_read_frame(m_formatContext, m_packet);
-        if (ret < 0) {
-            if (ret == AVERROR_EOF) {
-                qDebug() << "FFmpegDecoder: 到达文件末尾";
-                m_isEndOfFile = true;
-                emit decodingFinished();
-            } else {
-                qWarning() << "FFmpegDecoder: 读取数据包失败，错误码:" << ret;
+        StageTimer timer(m_stageTimingEnabled, &m_stageTimings.demuxNs);
+        ret = av_read_frame(m_formatContext, m_packet);
+    }
+    if (ret < 0) {
+        if (ret == AVERROR_EOF) {
+            qDebug() << "FFmpegDecoder: 到达文件末尾";
+            m_isEndOfFile = true;
+            // 送入空包，取出解码器内部延迟的最后几帧，全部输出后才通知结束
+            // （已经送过空包时返回AVERROR_EOF，没有剩余的帧）
+            if (avcodec_send_packet(m_codecContext, nullptr) >= 0) {
+                receiveFrames(locker);
             }
-            return;
-        }
-        
-        // 检查是否是音频流
-        qDebug() << "FFmpegDecoder: 数据包流索引:" << m_packet->stream_index << "，音频流索引:" << m_audioStreamIndex;
-        if (m_packet->stream_index != m_audioStreamIndex) {
-            qDebug() << "FFmpegDecoder: 跳过非音频流数据包";
-            av_packet_unref(m_packet);
-            return;
+            locker.unlock();
+            emit decodingFinished();
+            return 0;
         }
-        
-        qDebug() << "FFmpegDecoder: 读取音频数据包，大小:" << m_packet->size << "字节";
-        
-        // 发送数据包到解码器
+        qWarning() << "FFmpegDecoder: 读取数据包失败，错误码:" << ret;
+        return -1;
+    }
+    
+    // 检查是否是音频流
+    if (m_packet->stream_index != m_audioStreamIndex) {
+        LOGGER_DEBUG_FMT("FFmpegDecoder", "跳过非音频流数据包，流索引: %1，音频流索引: %2",
+                         m_packet->stream_index, m_audioStreamIndex);
+        av_packet_unref(m_packet);
+        return 1;
+    }
+    
+    LOGGER_DEBUG_FMT("FFmpegDecoder", "读取音频数据包，大小: %1字节", m_packet->size);
+    
+    // 数据包解码的追踪范围包含其中各帧的重采样和写入
+    TRACE_SCOPE("audio", "FFmpegDecoder::decodePacket");
+    
+    // 发送数据包到解码器
+    {
+        StageTimer timer(m_stageTimingEnabled, &m_stageTimings.decodeNs);
         ret = avcodec_send_packet(m_codecContext, m_packet);
-        if (ret < 0) {
-            qWarning() << "FFmpegDecoder: 发送数据包到解码器失败，错误码:" << ret;
-            av_packet_unref(m_packet);
-            return;
-        }
-        
-        // 接收解码后的帧
-        int frameCount = 0;
-        while (true) {
+    }
+    if (ret < 0) {
+        qWarning() << "FFmpegDecoder: 发送数据包到解码器失败，错误码:" << ret;
+        av_packet_unref(m_packet);
+        return 1;
+    }
+    ++m_stageTimings.packets;
+    
+    const int frameCount = receiveFrames(locker);
+    LOGGER_DEBUG_FMT("FFmpegDecoder", "本次解码循环处理了%1个音频帧", frameCount);
+    
+    av_packet_unref(m_packet);
+    return 1;
+}
+
+int FFmpegDecoder::receiveFrames(QMutexLocker<QMutex>& locker)
+{
+    // 接收解码后的帧
+    int frameCount = 0;
+    while (true) {
+        int ret = 0;
+        {
+            StageTimer timer(m_stageTimingEnabled, &m_stageTimings.decodeNs);
             ret = avcodec_receive_frame(m_codecContext, m_inputFrame);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                qDebug() << "FFmpegDecoder: 需要更多数据或到达末尾";
-                break;
-            } else if (ret < 0) {
-                qWarning() << "FFmpegDecoder: 接收解码帧失败，错误码:" << ret;
-                break;
-            }
-            
-            frameCount++;
-            qDebug() << "FFmpegDecoder: 接收到解码帧" << frameCount;
-            
-            // 处理音频帧（在锁外处理，避免死锁）
-            AVFrame* frameCopy = av_frame_alloc();
-            av_frame_ref(frameCopy, m_inputFrame);
-            
-            // 更新位置
-            if (m_inputFrame->pts != AV_NOPTS_VALUE) {
-                m_currentPosition = m_inputFrame->pts * av_q2d(m_formatContext->streams[m_audioStreamIndex]->time_base) * 1000;
-                emit positionChanged(m_currentPosition);
-            }
-            
-            // 释放锁，处理音频帧
-            locker.unlock();
-            processAudioFrame(frameCopy);
-            av_frame_free(&frameCopy);
-            locker.relock();
         }
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        } else if (ret < 0) {
+            qWarning() << "FFmpegDecoder: 接收解码帧失败，错误码:" << ret;
+            break;
+        }
+        
+        frameCount++;
+        
+        // 处理音频帧（在锁外处理，避免死锁）
+        AVFrame* frameCopy = av_frame_alloc();
+        av_frame_ref(frameCopy, m_inputFrame);
         
-        if (frameCount > 0) {
-            qDebug() << "FFmpegDecoder: 本次解码循环处理了" << frameCount << "个音频帧";
+        // 更新位置
+        if (m_inputFrame->pts != AV_NOPTS_VALUE) {
+            m_currentPosition = m_inputFrame->pts * av_q2d(m_formatContext->streams[m_audioStreamIndex]->time_base) * 1000;
+            emit positionChanged(m_currentPosition);
         }
         
-        av_packet_unref(m_packet);
+        // 释放锁，处理音频帧
+        locker.unlock();
+        processAudioFrame(frameCopy);
+        av_frame_free(&frameCopy);
+        locker.relock();
     }
+    return frameCount;
 }
 
 bool FFmpegDecoder::setupCodec()
@@ -747,8 +840,6 @@ bool FFmpegDecoder::setupResampler()
 
 void FFmpegDecoder::processAudioFrame(AVFrame* frame)
 {
-    qDebug() << "FFmpegDecoder: 处理音频帧...";
-    
     if (!frame || !m_swrContext || !m_outputFrame) {
         qWarning() << "FFmpegDecoder: 音频帧处理参数无效";
         return;
@@ -756,7 +847,7 @@ void FFmpegDecoder::processAudioFrame(AVFrame* frame)
     
     // 检查解码状态
     if (!m_isDecoding.loadAcquire()) {
-        qDebug() << "FFmpegDecoder: 未在解码中，跳过音频帧处理";
+        LOGGER_DEBUG("FFmpegDecoder", "未在解码中，跳过音频帧处理");
         return;
     }
     
@@ -787,7 +878,6 @@ void FFmpegDecoder::processAudioFrame(AVFrame* frame)
             swr_get_delay(m_swrContext, frame->sample_rate) + frame->nb_samples,
             outputSampleRate, frame->sample_rate, AV_ROUND_UP);
         
-        qDebug() << "FFmpegDecoder: 输出帧大小:" << outSamples << "样本";
         
         // 分配输出帧缓冲区
         av_frame_unref(m_outputFrame);
@@ -809,68 +899,24 @@ void FFmpegDecoder::processAudioFrame(AVFrame* frame)
         }
         
         // 执行重采样
-        int samples = swr_convert(m_swrContext, m_outputFrame->data, outSamples,
-                                 (const uint8_t**)frame->data, frame->nb_samples);
+        int samples = 0;
+        {
+            TRACE_SCOPE("audio", "FFmpegDecoder::resample");
+            StageTimer timer(m_stageTimingEnabled, &m_stageTimings.resampleNs);
+            samples = swr_convert(m_swrContext, m_outputFrame->data, outSamples,
+                                  (const uint8_t**)frame->data, frame->nb_samples);
+        }
         
         if (samples > 0) {
-            qDebug() << "FFmpegDecoder: 重采样成功，样本数:" << samples;
             
             // 应用平衡控制到音频数据（仅对立体声有效）
             if (outputChannels == 2) {
+                StageTimer timer(m_stageTimingEnabled, &m_stageTimings.dspNs);
                 if (outputSampleFormat == AV_SAMPLE_FMT_FLT) {
-                    float* audioData = (float*)m_outputFrame->data[0];
-                    for (int i = 0; i < samples; ++i) {
-                        float leftSample = audioData[i * 2];
-                        float rightSample = audioData[i * 2 + 1];
-                        
-                        // 应用平衡设置
-                        if (m_balance < 0) {
-                            // 左声道增强
-                            leftSample *= (1.0 + qAbs(m_balance));
-                            rightSample *= (1.0 - qAbs(m_balance) * 0.5);
-                        } else if (m_balance > 0) {
-                            // 右声道增强
-                            leftSample *= (1.0 - m_balance * 0.5);
-                            rightSample *= (1.0 + m_balance);
-                        }
-                        
-                        // 限制音量防止失真
-                        leftSample = qBound(-1.0f, leftSample, 1.0f);
-                        rightSample = qBound(-1.0f, rightSample, 1.0f);
-                        
-                        audioData[i * 2] = leftSample;
-                        audioData[i * 2 + 1] = rightSample;
-                    }
+                    AudioKernels::applyBalance(reinterpret_cast<float*>(m_outputFrame->data[0]), samples, m_balance);
                 } else if (outputSampleFormat == AV_SAMPLE_FMT_S16) {
-                    int16_t* audioData = (int16_t*)m_outputFrame->data[0];
-                    for (int i = 0; i < samples; ++i) {
-                        int16_t leftSample = audioData[i * 2];
-                        int16_t rightSample = audioData[i * 2 + 1];
-                        
-                        // 转换为float进行平衡处理
-                        float leftFloat = leftSample / 32768.0f;
-                        float rightFloat = rightSample / 32768.0f;
-                        
-                        // 应用平衡设置
-                        if (m_balance < 0) {
-                            leftFloat *= (1.0 + qAbs(m_balance));
-                            rightFloat *= (1.0 - qAbs(m_balance) * 0.5);
-                        } else if (m_balance > 0) {
-                            leftFloat *= (1.0 - m_balance * 0.5);
-                            rightFloat *= (1.0 + m_balance);
-                        }
-                        
-                        // 限制音量防止失真
-                        leftFloat = qBound(-1.0f, leftFloat, 1.0f);
-                        rightFloat = qBound(-1.0f, rightFloat, 1.0f);
-                        
-                        // 转换回int16
-                        audioData[i * 2] = static_cast<int16_t>(leftFloat * 32767.0f);
-                        audioData[i * 2 + 1] = static_cast<int16_t>(rightFloat * 32767.0f);
-                    }
+                    AudioKernels::applyBalance(reinterpret_cast<int16_t*>(m_outputFrame->data[0]), samples, m_balance);
                 }
-                
-                qDebug() << "FFmpegDecoder: 平衡控制应用完成，平衡值:" << m_balance;
             }
             
             // 计算音频数据大小
@@ -891,23 +937,25 @@ void FFmpegDecoder::processAudioFrame(AVFrame* frame)
             }
             
             int dataSize = samples * outputChannels * bytesPerSample;
-            QByteArray audioBytes((const char*)m_outputFrame->data[0], dataSize);
-            qDebug() << "FFmpegDecoder: 音频数据写入大小:" << audioBytes.size() << "字节，采样数:" << samples << "，声道数:" << outputChannels;
-            writeAudioData(audioBytes);
+            LOGGER_DEBUG_FMT("FFmpegDecoder", "音频帧: 预计%1样本，重采样%2样本，%3声道，写入%4字节",
+                             outSamples, samples, outputChannels, dataSize);
+            {
+                StageTimer timer(m_stageTimingEnabled, &m_stageTimings.outputNs);
+                writeAudioData(reinterpret_cast<const char*>(m_outputFrame->data[0]), dataSize);
+            }
+            m_stageTimings.outputFrames += samples;
             
             // 计算音频电平用于VU表
+            StageTimer timer(m_stageTimingEnabled, &m_stageTimings.dspNs);
             if (outputSampleFormat == AV_SAMPLE_FMT_FLT) {
                 calculateLevels((float*)m_outputFrame->data[0], samples, outputChannels);
             } else if (outputSampleFormat == AV_SAMPLE_FMT_S16) {
                 // 对于int16格式，需要转换为float进行计算
                 QVector<float> floatSamples(samples * outputChannels);
-                int16_t* int16Data = (int16_t*)m_outputFrame->data[0];
-                for (int i = 0; i < samples * outputChannels; ++i) {
-                    floatSamples[i] = int16Data[i] / 32768.0f;
-                }
+                AudioKernels::int16ToFloat(reinterpret_cast<const int16_t*>(m_outputFrame->data[0]),
+                                           floatSamples.data(), samples * outputChannels);
                 calculateLevels(floatSamples.data(), samples, outputChannels);
             }
-            qDebug() << "FFmpegDecoder: VU表电平计算完成";
         } else {
             qWarning() << "FFmpegDecoder: 重采样失败，样本数:" << samples;
         }
@@ -925,32 +973,9 @@ void FFmpegDecoder::calculateLevels(const float* samples, int frameCount, int ch
         return;
     }
     
-    // 计算RMS值
     double leftRMS = 0.0;
     double rightRMS = 0.0;
-    
-    for (int i = 0; i < frameCount; ++i) {
-        if (channels == 1) {
-            // 单声道
-            double sample = samples[i];
-            leftRMS += sample * sample;
-            rightRMS += sample * sample;
-        } else if (channels >= 2) {
-            // 立体声
-            double leftSample = samples[i * 2];
-            double rightSample = samples[i * 2 + 1];
-            leftRMS += leftSample * leftSample;
-            rightRMS += rightSample * rightSample;
-        }
-    }
-    
-    // 计算RMS
-    leftRMS = sqrt(leftRMS / frameCount);
-    rightRMS = sqrt(rightRMS / frameCount);
-    
-    // 限制在0-1范围内
-    leftRMS = qBound(0.0, leftRMS, 1.0);
-    rightRMS = qBound(0.0, rightRMS, 1.0);
+    AudioKernels::rmsLevels(samples, frameCount, channels, &leftRMS, &rightRMS);
     
     // 更新电平
     m_currentLevels[0] = leftRMS;
@@ -984,6 +1009,12 @@ void FFmpegDecoder::cleanupFFmpeg()
             m_formatContext = nullptr;
         }
         
+        if (m_ioContext) {
+            // 自定义AVIOContext不会被avformat_close_input释放
+            qDebug() << "FFmpegDecoder: I/O统计:" << AudioIOContext::statistics(m_ioContext).toString();
+            AudioIOContext::free(&m_ioContext);
+        }
+        
         if (m_inputFrame) {
             qDebug() << "FFmpegDecoder: 释放输入帧";
             av_frame_free(&m_inputFrame);
@@ -1020,113 +1051,119 @@ void FFmpegDecoder::resetState()
     m_isEndOfFile = false;
     m_currentLevels.fill(0.0);
     m_levelBuffer.clear();
+    m_stageTimings = DecoderStageTimings();
 }
 
 // ==================== 音频输出方法 ====================
 
+void FFmpegDecoder::setOutputFactory(OutputFactory factory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_outputFactory = std::move(factory);
+}
+
+QAudioFormat FFmpegDecoder::outputFormat() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_audioFormat;
+}
+
+AudioOutput* FFmpegDecoder::output() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_output.get();
+}
+
+void FFmpegDecoder::setStageTimingEnabled(bool enabled)
+{
+    m_stageTimingEnabled = enabled;
+}
+
+DecoderStageTimings FFmpegDecoder::stageTimings() const
+{
+    return m_stageTimings;
+}
+
 bool FFmpegDecoder::setupAudioOutput()
 {
     qDebug() << "FFmpegDecoder: 设置音频输出";
     
-    // 获取默认音频设备
-    QMediaDevices mediaDevices;
-    QList<QAudioDevice> audioOutputs = mediaDevices.audioOutputs();
-    
-    if (audioOutputs.isEmpty()) {
-        qWarning() << "FFmpegDecoder: 没有找到音频输出设备";
-        return false;
-    }
-    
-    QAudioDevice defaultDevice = audioOutputs.first();
-    qDebug() << "FFmpegDecoder: 使用音频设备:" << defaultDevice.description();
-    
-    // 使用设备首选格式，而不是强制设置
-    m_audioFormat = defaultDevice.preferredFormat();
-    
-    qDebug() << "FFmpegDecoder: 设备首选格式 - 采样率:" << m_audioFormat.sampleRate() 
-             << "，声道数:" << m_audioFormat.channelCount() 
-             << "，采样格式:" << m_audioFormat.sampleFormat();
-    
-    // 确保格式兼容性，如果设备不支持首选格式，回退到基本格式
-    if (!defaultDevice.isFormatSupported(m_audioFormat)) {
-        qWarning() << "FFmpegDecoder: 设备不支持首选格式，使用基本格式";
-        m_audioFormat.setSampleRate(44100);
-        m_audioFormat.setChannelCount(2);
-        m_audioFormat.setSampleFormat(QAudioFormat::Int16);
-        
-        // 再次检查基本格式是否支持
-        if (!defaultDevice.isFormatSupported(m_audioFormat)) {
-            qCritical() << "FFmpegDecoder: 设备不支持基本音频格式";
-            return false;
-        }
-    }
-    
-    qDebug() << "FFmpegDecoder: 最终使用音频格式 - 采样率:" << m_audioFormat.sampleRate() 
-             << "，声道数:" << m_audioFormat.channelCount() 
-             << "，采样格式:" << m_audioFormat.sampleFormat();
-    
-    // 创建音频输出
-    m_audioSink = new QAudioSink(defaultDevice, m_audioFormat, this);
-    
-    if (!m_audioSink) {
+    m_output = m_outputFactory ? m_outputFactory() : std::make_unique<DeviceAudioOutput>();
+    if (!m_output) {
         qWarning() << "FFmpegDecoder: 无法创建音频输出";
         return false;
     }
     
-    // 设置缓冲区大小（32KB）
-    m_audioSink->setBufferSize(32768);
-    qDebug() << "FFmpegDecoder: 设置音频缓冲区大小:" << m_audioSink->bufferSize() << "字节";
-    
-    // 设置音量
-    m_audioSink->setVolume(1.0);
+    // 设备输出使用设备首选格式，其他输出默认沿用解码流的采样率和声道数
+    QAudioFormat sourceFormat;
+    sourceFormat.setSampleRate(m_codecContext->sample_rate);
+    sourceFormat.setChannelCount(qMin(2, m_codecContext->ch_layout.nb_channels));
+    sourceFormat.setSampleFormat(QAudioFormat::Float);
     
-    // 获取音频设备
-    m_audioDevice = m_audioSink->start();
-    
-    if (!m_audioDevice) {
-        qWarning() << "FFmpegDecoder: 无法启动音频设备";
+    if (!m_output->open(sourceFormat)) {
+        qWarning() << "FFmpegDecoder: 音频输出打开失败:" << m_output->description();
+        m_output.reset();
         return false;
     }
     
-    qDebug() << "FFmpegDecoder: 音频输出设置成功";
+    m_audioFormat = m_output->format();
+    qDebug() << "FFmpegDecoder: 音频输出:" << m_output->description()
+             << "，采样率:" << m_audioFormat.sampleRate()
+             << "，声道数:" << m_audioFormat.channelCount()
+             << "，采样格式:" << m_audioFormat.sampleFormat();
     return true;
 }
 
 void FFmpegDecoder::cleanupAudioOutput()
 {
-    if (m_audioSink) {
-        m_audioSink->stop();
-        delete m_audioSink;
-        m_audioSink = nullptr;
+    if (m_output) {
+        m_output->close();
+        m_output.reset();
     }
     
-    m_audioDevice = nullptr;
     m_audioBuffer.clear();
 }
 
-void FFmpegDecoder::writeAudioData(const QByteArray& data)
+void FFmpegDecoder::writeAudioData(const char* data, qint64 size)
 {
-    // 检查音频设备和解码状态
-    if (!m_audioDevice || !m_isDecoding.loadAcquire()) {
+    // 检查音频输出和解码状态
+    if (!m_output || !m_isDecoding.loadAcquire()) {
         return;
     }
     
+    TRACE_SCOPE("audio", "FFmpegDecoder::sinkWrite");
+    
+    static MetricGauge* const bufferFill = MetricsRegistry::gauge("decoder.sink_buffer_fill_percent");
+    static MetricCounter* const underruns = MetricsRegistry::counter("decoder.underruns");
+    static MetricCounter* const partialWrites = MetricsRegistry::counter("decoder.partial_writes");
+    
+    // 开始播放后写入前输出缓冲区已经放空，说明解码没有跟上播放（只对声卡输出有意义）
+    const qint64 bufferSize = m_output->bufferSize();
+    if (m_output->isRealtime() && bufferSize > 0) {
+        const qint64 bytesFree = m_output->bytesFree();
+        if (bytesFree >= bufferSize && m_output->processedUSecs() > 0) {
+            underruns->increment();
+        }
+        bufferFill->set(100.0 * (bufferSize - bytesFree) / bufferSize);
+    }
+    
     // 直接写入音频数据，不使用异步
-    qint64 written = m_audioDevice->write(data);
+    qint64 written = m_output->write(data, size);
     
     // 检查写入是否成功
-    if (written != data.size()) {
-        qWarning() << "FFmpegDecoder: 音频数据写入不完整:" << written << "/" << data.size() << "字节";
+    if (written != size) {
+        partialWrites->increment();
+        qWarning() << "FFmpegDecoder: 音频数据写入不完整:" << written << "/" << size << "字节";
         
         // 如果写入不完整，尝试分块写入
         if (written > 0) {
-            QByteArray remainingData = data.mid(written);
-            qint64 remainingWritten = m_audioDevice->write(remainingData);
-            if (remainingWritten != remainingData.size()) {
-                qWarning() << "FFmpegDecoder: 剩余数据写入失败:" << remainingWritten << "/" << remainingData.size() << "字节";
+            const qint64 remaining = size - written;
+            qint64 remainingWritten = m_output->write(data + written, remaining);
+            if (remainingWritten != remaining) {
+                qWarning() << "FFmpegDecoder: 剩余数据写入失败:" << remainingWritten << "/" << remaining << "字节";
             }
         }
     } else {
-        qDebug() << "FFmpegDecoder: 音频数据写入成功:" << written << "字节";
+        LOGGER_DEBUG_FMT("FFmpegDecoder", "音频数据写入成功: %1字节", written);
     }
-} 
\ No newline at end of file
+}
@@ -7,10 +7,11 @@
 #include <QQueue>
 #include <QVector>
 #include <QTimer>
-#include <QAudioSink>
-#include <QAudioDevice>
-#include <QMediaDevices>
+#include <QAudioFormat>
 #include <QAtomicInt>
+#include <functional>
+#include <memory>
+#include "audiooutput.h"
 
 // FFmpeg头文件
 extern "C" {
@@ -23,11 +24,28 @@ extern "C" {
 #include <libavutil/channel_layout.h>
 }
 
+/**
+ * @brief 各处理阶段的累计耗时（纳秒），开启setStageTimingEnabled后统计
+ */
+struct DecoderStageTimings
+{
+    qint64 demuxNs = 0;       // 读取数据包
+    qint64 decodeNs = 0;      // 解码
+    qint64 resampleNs = 0;    // 重采样
+    qint64 dspNs = 0;         // 平衡和电平计算
+    qint64 outputNs = 0;      // 写入输出
+    qint64 outputFrames = 0;  // 写入输出的样本帧数
+    qint64 packets = 0;
+};
+
 class FFmpegDecoder : public QObject
 {
     Q_OBJECT
 
 public:
+    // 为每个打开的文件创建输出，未设置时使用声卡输出
+    using OutputFactory = std::function<std::unique_ptr<AudioOutput>()>;
+
     explicit FFmpegDecoder(QObject* parent = nullptr);
     ~FFmpegDecoder();
 
@@ -55,11 +73,26 @@ public:
     qint64 getCurrentPosition() const;
     bool isEndOfFile() const;
 
+    // 输出和离线处理
+    void setOutputFactory(OutputFactory factory);
+    QAudioFormat outputFormat() const;
+    AudioOutput* output() const;
+
+    /**
+     * @brief 在调用线程上同步解码到文件末尾，不经过解码定时器
+     * @details 用于离线处理：输出不按播放速度消费，解码器尽快处理完整个文件（含解码器延迟的尾部数据）。
+     * @return 是否正常到达文件末尾
+     */
+    bool decodeToEnd();
+
+    void setStageTimingEnabled(bool enabled);
+    DecoderStageTimings stageTimings() const;
+
 signals:
     void audioDataReady(const QVector<double>& levels);
     void positionChanged(qint64 position);
     void durationChanged(qint64 duration);
-    void decodingFinished();
+    void decodingFinished();    // 解码器延迟的尾部帧也已输出
     void errorOccurred(const QString& error);
 
 private slots:
@@ -68,6 +101,7 @@ private slots:
 private:
     // FFmpeg相关
     AVFormatContext* m_formatContext;
+    AVIOContext* m_ioContext;          // 自定义I/O（AudioIOContext），为空时使用FFmpeg默认文件I/O
     AVCodecContext* m_codecContext;
     SwrContext* m_swrContext;
     AVFrame* m_inputFrame;
@@ -94,6 +128,8 @@ private:
     mutable QMutex m_mutex;
     
     // 内部方法
+    int decodeNextPacket();
+    int receiveFrames(QMutexLocker<QMutex>& locker);
     bool setupCodec();
     bool setupResampler();
     void processAudioFrame(AVFrame* frame);
@@ -104,15 +140,19 @@ private:
 
     
     // 音频输出
-    QAudioSink* m_audioSink;
-    QIODevice* m_audioDevice;
+    OutputFactory m_outputFactory;
+    std::unique_ptr<AudioOutput> m_output;
     QAudioFormat m_audioFormat;
     QByteArray m_audioBuffer;
     
+    // 分阶段计时（离线处理时开启）
+    bool m_stageTimingEnabled;
+    DecoderStageTimings m_stageTimings;
+    
     // 音频输出方法
     bool setupAudioOutput();
     void cleanupAudioOutput();
-    void writeAudioData(const QByteArray& data);
+    void writeAudioData(const char* data, qint64 size);
 };
 
 #endif // FFMPEGDECODER_H 
\ No newline at end of file
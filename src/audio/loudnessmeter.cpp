@@ -0,0 +1,150 @@
+#include "loudnessmeter.h"
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+const double ABSOLUTE_GATE_LUFS = -70.0;
+const double RELATIVE_GATE_LU = -10.0;
+
+double energyToLufs(double energy)
+{
+    return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -HUGE_VAL;
+}
+
+double amplitudeToDbfs(double amplitude)
+{
+    return amplitude > 0.0 ? 20.0 * std::log10(amplitude) : -HUGE_VAL;
+}
+
+} // namespace
+
+LoudnessMeter::LoudnessMeter(int sampleRate, int channels)
+    : m_channels(qBound(1, channels, 2))
+    , m_state(m_channels)
+    , m_subBlockFrames(qMax(1, sampleRate / 10))
+    , m_subBlockFill(0)
+    , m_subBlockEnergy(0.0)
+    , m_recentSubBlocks{0.0, 0.0, 0.0, 0.0}
+    , m_subBlockCount(0)
+    , m_peak(0.0)
+    , m_sumSquares(0.0)
+    , m_frames(0)
+{
+    // BS.1770的滤波器系数按48kHz给出，这里由模拟原型按实际采样率重新计算
+    const double rate = qMax(1, sampleRate);
+    {
+        // 第一级：约+4dB的高架滤波，模拟头部的声学效应
+        const double f0 = 1681.974450955533;
+        const double gain = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        m_stages[0] = {(vh + vb * k / q + k * k) / a0,
+                       2.0 * (k * k - vh) / a0,
+                       (vh - vb * k / q + k * k) / a0,
+                       2.0 * (k * k - 1.0) / a0,
+                       (1.0 - k / q + k * k) / a0};
+    }
+    {
+        // 第二级：约38Hz的二阶高通（RLB计权）
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double a0 = 1.0 + k / q + k * k;
+        m_stages[1] = {1.0, -2.0, 1.0,
+                       2.0 * (k * k - 1.0) / a0,
+                       (1.0 - k / q + k * k) / a0};
+    }
+}
+
+void LoudnessMeter::process(const float* samples, int frameCount)
+{
+    if (!samples || frameCount <= 0) {
+        return;
+    }
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        for (int ch = 0; ch < m_channels; ++ch) {
+            const double input = samples[frame * m_channels + ch];
+            const double magnitude = std::fabs(input);
+            if (magnitude > m_peak) {
+                m_peak = magnitude;
+            }
+            m_sumSquares += input * input;
+
+            ChannelState& state = m_state[ch];
+            double value = input;
+            for (int s = 0; s < 2; ++s) {
+                const Biquad& f = m_stages[s];
+                const double output = f.b0 * value + state.z1[s];
+                state.z1[s] = f.b1 * value - f.a1 * output + state.z2[s];
+                state.z2[s] = f.b2 * value - f.a2 * output;
+                value = output;
+            }
+            m_subBlockEnergy += value * value;
+        }
+
+        if (++m_subBlockFill == m_subBlockFrames) {
+            finishSubBlock();
+        }
+    }
+    m_frames += frameCount;
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    m_recentSubBlocks[m_subBlockCount % 4] = m_subBlockEnergy / m_subBlockFrames;
+    ++m_subBlockCount;
+    m_subBlockEnergy = 0.0;
+    m_subBlockFill = 0;
+
+    // 每100ms产生一个400ms窗口（75%重叠），各声道能量相加（权重为1）
+    if (m_subBlockCount >= 4) {
+        const double energy = (m_recentSubBlocks[0] + m_recentSubBlocks[1]
+                               + m_recentSubBlocks[2] + m_recentSubBlocks[3]) / 4.0;
+        m_blockEnergies.append(energy);
+    }
+}
+
+LoudnessMeter::Result LoudnessMeter::result() const
+{
+    Result result;
+    result.frames = m_frames;
+    result.samplePeakDbfs = amplitudeToDbfs(m_peak);
+    if (m_frames > 0) {
+        result.rmsDbfs = amplitudeToDbfs(std::sqrt(m_sumSquares / (static_cast<double>(m_frames) * m_channels)));
+    }
+
+    // 绝对门限
+    double sum = 0.0;
+    int count = 0;
+    for (double energy : m_blockEnergies) {
+        if (energyToLufs(energy) > ABSOLUTE_GATE_LUFS) {
+            sum += energy;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return result;
+    }
+
+    // 相对门限：比绝对门限后的平均响度低10 LU
+    const double relativeGate = energyToLufs(sum / count) + RELATIVE_GATE_LU;
+    sum = 0.0;
+    count = 0;
+    for (double energy : m_blockEnergies) {
+        const double lufs = energyToLufs(energy);
+        if (lufs > ABSOLUTE_GATE_LUFS && lufs > relativeGate) {
+            sum += energy;
+            ++count;
+        }
+    }
+    if (count > 0) {
+        result.integratedLufs = energyToLufs(sum / count);
+        result.gatedBlocks = count;
+    }
+    return result;
+}
@@ -0,0 +1,65 @@
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <cmath>
+
+/**
+ * @brief 按ITU-R BS.1770 / EBU R128测量整体响度
+ * @details K计权（高架+高通两级双二阶滤波），400ms窗口、75%重叠，
+ *          先按-70 LUFS绝对门限、再按-10 LU相对门限筛选。只支持单声道和立体声（声道权重均为1）。
+ *          同时统计样本峰值和整体RMS。
+ */
+class LoudnessMeter
+{
+public:
+    struct Result
+    {
+        double integratedLufs = -HUGE_VAL;   // 门限后的整体响度，静音时为-inf
+        double samplePeakDbfs = -HUGE_VAL;
+        double rmsDbfs = -HUGE_VAL;
+        qint64 frames = 0;
+        int gatedBlocks = 0;                 // 通过两级门限的400ms块数
+    };
+
+    LoudnessMeter(int sampleRate, int channels);
+
+    /**
+     * @brief 输入交错的float样本
+     */
+    void process(const float* samples, int frameCount);
+
+    Result result() const;
+
+private:
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+    struct ChannelState
+    {
+        double z1[2] = {0.0, 0.0};  // 两级滤波器的状态（直接II型转置）
+        double z2[2] = {0.0, 0.0};
+    };
+
+    void finishSubBlock();
+
+    int m_channels;
+    Biquad m_stages[2];
+    QVector<ChannelState> m_state;
+
+    // 100ms子块：四个相邻子块组成一个400ms窗口
+    int m_subBlockFrames;
+    int m_subBlockFill;
+    double m_subBlockEnergy;
+    double m_recentSubBlocks[4];
+    int m_subBlockCount;
+    QVector<double> m_blockEnergies;
+
+    double m_peak;
+    double m_sumSquares;
+    qint64 m_frames;
+};
+
+#endif // LOUDNESSMETER_H
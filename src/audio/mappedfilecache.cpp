@@ -0,0 +1,185 @@
+#include "mappedfilecache.h"
+#include "../core/metricsregistry.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+
+// ==================== MappedAudioFile ====================
+
+MappedAudioFile::MappedAudioFile(const QString& filePath)
+    : m_file(filePath)
+    , m_data(nullptr)
+    , m_size(0)
+{
+}
+
+MappedAudioFile::~MappedAudioFile()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+}
+
+std::shared_ptr<MappedAudioFile> MappedAudioFile::open(const QString& filePath)
+{
+    std::shared_ptr<MappedAudioFile> file(new MappedAudioFile(filePath));
+    if (!file->map()) {
+        return nullptr;
+    }
+    file->adviseReadAhead();
+    return file;
+}
+
+bool MappedAudioFile::map()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "MappedAudioFile: 无法打开文件:" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size <= 0) {
+        return false;
+    }
+    m_lastModified = m_file.fileTime(QFileDevice::FileModificationTime);
+
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        qWarning() << "MappedAudioFile: 内存映射失败:" << m_file.fileName() << m_file.errorString();
+        m_size = 0;
+        return false;
+    }
+    return true;
+}
+
+bool MappedAudioFile::isStale() const
+{
+    const QFileInfo info(m_file.fileName());
+    return !info.exists() || info.size() != m_size || info.lastModified() != m_lastModified;
+}
+
+void MappedAudioFile::adviseReadAhead()
+{
+#ifdef Q_OS_UNIX
+    // 顺序读取并立即预读，内核在后台把文件读入页缓存
+#ifdef Q_OS_LINUX
+    const int fd = m_file.handle();
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    }
+#endif
+    madvise(m_data, static_cast<size_t>(m_size), MADV_SEQUENTIAL);
+    madvise(m_data, static_cast<size_t>(m_size), MADV_WILLNEED);
+#endif
+}
+
+// ==================== MappedFileCache ====================
+
+MappedFileCache* MappedFileCache::s_instance = nullptr;
+
+MappedFileCache::MappedFileCache()
+    : m_cache(MAX_CACHE_FILES, MAX_CACHE_BYTES, 1)
+{
+    m_cache.setSizeFunction([](const std::shared_ptr<MappedAudioFile>& file) {
+        return file ? file->size() : 0;
+    });
+
+    MetricsRegistry::registerGaugeCallback("cache.mapped_file.hit_rate", [this]() {
+        return statistics().hitRate();
+    });
+}
+
+MappedFileCache::~MappedFileCache()
+{
+    MetricsRegistry::unregisterGaugeCallback("cache.mapped_file.hit_rate");
+}
+
+MappedFileCache* MappedFileCache::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    if (!s_instance) {
+        s_instance = new MappedFileCache();
+    }
+    return s_instance;
+}
+
+void MappedFileCache::cleanup()
+{
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+std::shared_ptr<MappedAudioFile> MappedFileCache::preload(const QString& filePath)
+{
+    if (std::shared_ptr<MappedAudioFile> cached = cachedFile(filePath)) {
+        return cached;
+    }
+
+    std::shared_ptr<MappedAudioFile> file = MappedAudioFile::open(filePath);
+    if (!file) {
+        return nullptr;
+    }
+
+    if (!m_cache.put(filePath, file)) {
+        // 单个文件超过字节预算：预读提示已发出，但不保留映射
+        qDebug() << "MappedFileCache: 文件超过预加载预算，不缓存:" << filePath << file->size();
+    }
+    return file;
+}
+
+std::shared_ptr<MappedAudioFile> MappedFileCache::acquire(const QString& filePath)
+{
+    return cachedFile(filePath);
+}
+
+std::shared_ptr<MappedAudioFile> MappedFileCache::cachedFile(const QString& filePath)
+{
+    std::optional<std::shared_ptr<MappedAudioFile>> cached = m_cache.get(filePath);
+    if (!cached || !*cached) {
+        return nullptr;
+    }
+    // 文件被重新写入标签、替换或截断：丢弃旧映射，由调用方重新映射或直接读文件
+    if ((*cached)->isStale()) {
+        qDebug() << "MappedFileCache: 文件已在磁盘上改变，丢弃旧映射:" << filePath;
+        m_cache.remove(filePath);
+        return nullptr;
+    }
+    return *cached;
+}
+
+void MappedFileCache::remove(const QString& filePath)
+{
+    m_cache.remove(filePath);
+}
+
+void MappedFileCache::clear()
+{
+    m_cache.clear();
+}
+
+qint64 MappedFileCache::totalBytes() const
+{
+    return m_cache.totalBytes();
+}
+
+int MappedFileCache::fileCount() const
+{
+    return m_cache.size();
+}
+
+ShardedCacheStats MappedFileCache::statistics() const
+{
+    return m_cache.statistics();
+}
@@ -0,0 +1,103 @@
+#ifndef MAPPEDFILECACHE_H
+#define MAPPEDFILECACHE_H
+
+#include <QString>
+#include <QFile>
+#include <QDateTime>
+#include <QMutex>
+#include <memory>
+
+#include "../core/shardedcache.h"
+
+/**
+ * @brief 内存映射的音频文件
+ * @details 打开时通过mmap映射整个文件，并向内核发出预读提示
+ *          （posix_fadvise/madvise WILLNEED），文件内容进入页缓存而不是复制到堆内存。
+ *          对象通过shared_ptr共享，缓存淘汰后仍在使用的解码器可以继续读取。
+ *          FFmpeg通过AudioIOContext中的MappedFileSource读取映射内容。
+ */
+class MappedAudioFile
+{
+public:
+    ~MappedAudioFile();
+
+    /**
+     * @brief 映射文件
+     * @param filePath 文件路径
+     * @return 映射成功返回对象，失败返回nullptr
+     */
+    static std::shared_ptr<MappedAudioFile> open(const QString& filePath);
+
+    const uchar* data() const { return m_data; }
+    qint64 size() const { return m_size; }
+    QString filePath() const { return m_file.fileName(); }
+
+    /**
+     * @brief 磁盘上的文件是否已被修改、替换或删除（大小或修改时间与映射时不同）
+     * @details 过期的映射可能与文件内容不一致，文件被截断时读取越界部分会触发SIGBUS
+     */
+    bool isStale() const;
+
+private:
+    explicit MappedAudioFile(const QString& filePath);
+    bool map();
+    void adviseReadAhead();
+
+    QFile m_file;
+    uchar* m_data;
+    qint64 m_size;
+    QDateTime m_lastModified;   // 映射时的修改时间
+};
+
+/**
+ * @brief 预加载文件缓存
+ * @details 以字节预算和文件数量为上限的LRU，条目为MappedAudioFile。
+ *          AudioWorkerThread负责预加载，FFmpegDecoder打开文件时优先从这里取映射。
+ */
+class MappedFileCache
+{
+public:
+    // 单例模式
+    static MappedFileCache* instance();
+    static void cleanup();
+
+    /**
+     * @brief 预加载文件（已缓存且未过期时只刷新LRU位置，过期时重新映射）
+     * @param filePath 文件路径
+     * @return 映射文件，失败返回nullptr
+     */
+    std::shared_ptr<MappedAudioFile> preload(const QString& filePath);
+
+    /**
+     * @brief 查找已预加载的文件
+     * @param filePath 文件路径
+     * @return 映射文件，未缓存或文件已在磁盘上改变（此时移出缓存）返回nullptr
+     */
+    std::shared_ptr<MappedAudioFile> acquire(const QString& filePath);
+
+    void remove(const QString& filePath);
+    void clear();
+
+    qint64 totalBytes() const;
+    int fileCount() const;
+    ShardedCacheStats statistics() const;
+
+    static const qint64 MAX_CACHE_BYTES = 100LL * 1024 * 1024;  // 100MB
+    static const int MAX_CACHE_FILES = 10;
+
+private:
+    MappedFileCache();
+    ~MappedFileCache();
+
+    /**
+     * @brief 取出未过期的缓存条目，过期条目移出缓存
+     */
+    std::shared_ptr<MappedAudioFile> cachedFile(const QString& filePath);
+
+    static MappedFileCache* s_instance;
+
+    // 单分片，字节预算作用于整个缓存，淘汰顺序为真正的LRU
+    ShardedCache<QString, std::shared_ptr<MappedAudioFile>> m_cache;
+};
+
+#endif // MAPPEDFILECACHE_H
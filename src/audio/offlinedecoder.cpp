@@ -0,0 +1,464 @@
+#include "offlinedecoder.h"
+#include "audiokernels.h"
+#include "audioengine.h"
+#include "../core/metricsregistry.h"
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QVector>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+/**
+ * @brief 把输出数据同时送入响度分析，再转交给实际的输出
+ */
+class AnalyzingAudioOutput : public AudioOutput
+{
+public:
+    explicit AnalyzingAudioOutput(std::unique_ptr<AudioOutput> inner)
+        : m_inner(std::move(inner))
+        , m_elapsedNs(0)
+    {
+    }
+
+    bool open(const QAudioFormat& sourceFormat) override
+    {
+        if (!m_inner->open(sourceFormat)) {
+            return false;
+        }
+        m_format = m_inner->format();
+        m_meter.reset(new LoudnessMeter(m_format.sampleRate(), m_format.channelCount()));
+        return true;
+    }
+
+    void close() override { m_inner->close(); }
+
+    qint64 write(const char* data, qint64 size) override
+    {
+        QElapsedTimer timer;
+        timer.start();
+        analyze(data, size);
+        m_elapsedNs += timer.nsecsElapsed();
+
+        const qint64 written = m_inner->write(data, size);
+        if (written > 0) {
+            m_bytesWritten += written;
+        }
+        return written;
+    }
+
+    QString description() const override { return m_inner->description() + "+loudness"; }
+
+    LoudnessMeter::Result result() const { return m_meter ? m_meter->result() : LoudnessMeter::Result(); }
+    qint64 elapsedNs() const { return m_elapsedNs; }
+
+private:
+    void analyze(const char* data, qint64 size)
+    {
+        const int channels = m_format.channelCount();
+        const int bytesPerFrame = m_format.bytesPerFrame();
+        if (!m_meter || bytesPerFrame <= 0) {
+            return;
+        }
+        const int frames = static_cast<int>(size / bytesPerFrame);
+        const int count = frames * channels;
+
+        switch (m_format.sampleFormat()) {
+        case QAudioFormat::Float:
+            m_meter->process(reinterpret_cast<const float*>(data), frames);
+            return;
+        case QAudioFormat::Int16:
+            m_scratch.resize(count);
+            AudioKernels::int16ToFloat(reinterpret_cast<const int16_t*>(data), m_scratch.data(), count);
+            break;
+        case QAudioFormat::Int32: {
+            m_scratch.resize(count);
+            const qint32* samples = reinterpret_cast<const qint32*>(data);
+            for (int i = 0; i < count; ++i) {
+                m_scratch[i] = samples[i] / 2147483648.0f;
+            }
+            break;
+        }
+        default:
+            return;
+        }
+        m_meter->process(m_scratch.constData(), frames);
+    }
+
+    std::unique_ptr<AudioOutput> m_inner;
+    std::unique_ptr<LoudnessMeter> m_meter;
+    QVector<float> m_scratch;
+    qint64 m_elapsedNs;
+};
+
+double nsToMs(qint64 ns)
+{
+    return ns / 1.0e6;
+}
+
+QString formatDb(double value, const char* unit)
+{
+    return std::isfinite(value) ? QString("%1 %2").arg(value, 0, 'f', 1).arg(unit) : QString("-inf %1").arg(unit);
+}
+
+QJsonValue dbToJson(double value)
+{
+    // JSON不能表示无穷大，静音记为null
+    return std::isfinite(value) ? QJsonValue(value) : QJsonValue();
+}
+
+QJsonObject timingsToJson(const DecoderStageTimings& timings, qint64 analysisNs)
+{
+    QJsonObject stages;
+    stages["demux_ms"] = nsToMs(timings.demuxNs);
+    stages["decode_ms"] = nsToMs(timings.decodeNs);
+    stages["resample_ms"] = nsToMs(timings.resampleNs);
+    stages["dsp_ms"] = nsToMs(timings.dspNs);
+    stages["output_ms"] = nsToMs(timings.outputNs - analysisNs);
+    stages["analysis_ms"] = nsToMs(analysisNs);
+    stages["packets"] = timings.packets;
+    return stages;
+}
+
+// 离线处理时FFmpegDecoder的逐帧调试输出会淹没结果，只保留警告和错误
+void quietMessageHandler(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+    if (type != QtDebugMsg && type != QtInfoMsg) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+} // namespace
+
+QJsonObject OfflineDecodeReport::toJson() const
+{
+    QJsonObject object;
+    object["file"] = filePath;
+    object["success"] = success;
+    if (!error.isEmpty()) {
+        object["error"] = error;
+    }
+    if (!outputPath.isEmpty()) {
+        object["output"] = outputPath;
+    }
+    if (!success) {
+        return object;
+    }
+
+    object["sample_rate"] = format.sampleRate();
+    object["channels"] = format.channelCount();
+    object["frames"] = frames;
+    object["audio_seconds"] = audioSeconds;
+    object["wall_seconds"] = wallSeconds;
+    object["realtime_factor"] = realtimeFactor;
+    object["stages"] = timingsToJson(timings, analysisNs);
+    if (loudness.frames > 0) {
+        QJsonObject analysis;
+        analysis["integrated_lufs"] = dbToJson(loudness.integratedLufs);
+        analysis["sample_peak_dbfs"] = dbToJson(loudness.samplePeakDbfs);
+        analysis["rms_dbfs"] = dbToJson(loudness.rmsDbfs);
+        analysis["gated_blocks"] = loudness.gatedBlocks;
+        object["loudness"] = analysis;
+    }
+    return object;
+}
+
+OfflineDecoder::OfflineDecoder(const OfflineDecodeOptions& options)
+    : m_options(options)
+{
+}
+
+OfflineDecodeReport OfflineDecoder::decodeFile(const QString& filePath)
+{
+    OfflineDecodeReport report;
+    report.filePath = filePath;
+    if (m_options.sink != OfflineDecodeOptions::Sink::Null) {
+        report.outputPath = outputPathFor(filePath);
+    }
+
+    FFmpegDecoder decoder;
+    QString lastError;
+    QObject::connect(&decoder, &FFmpegDecoder::errorOccurred, [&lastError](const QString& error) {
+        lastError = error;
+    });
+    decoder.setBalance(m_options.balance);
+    decoder.setStageTimingEnabled(m_options.stageTiming);
+
+    AnalyzingAudioOutput* analyzer = nullptr;
+    decoder.setOutputFactory([this, &report, &analyzer]() -> std::unique_ptr<AudioOutput> {
+        std::unique_ptr<AudioOutput> output;
+        switch (m_options.sink) {
+        case OfflineDecodeOptions::Sink::Null:
+            output = std::make_unique<NullAudioOutput>(m_options.format);
+            break;
+        case OfflineDecodeOptions::Sink::Wav:
+            output = std::make_unique<FileAudioOutput>(report.outputPath, FileAudioOutput::Container::Wav,
+                                                       m_options.format);
+            break;
+        case OfflineDecodeOptions::Sink::RawFloat:
+            output = std::make_unique<FileAudioOutput>(report.outputPath, FileAudioOutput::Container::RawFloat,
+                                                       m_options.format);
+            break;
+        }
+        if (!m_options.analyze) {
+            return output;
+        }
+        auto tee = std::make_unique<AnalyzingAudioOutput>(std::move(output));
+        analyzer = tee.get();
+        return tee;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!decoder.openFile(filePath)) {
+        report.error = lastError.isEmpty() ? QString("无法打开文件") : lastError;
+        return report;
+    }
+    report.format = decoder.outputFormat();
+
+    const bool finished = decoder.decodeToEnd();
+    report.timings = decoder.stageTimings();
+    if (analyzer) {
+        report.loudness = analyzer->result();
+        report.analysisNs = analyzer->elapsedNs();
+    }
+    // 关闭时文件输出回填WAV文件头，计入处理耗时
+    decoder.closeFile();
+    report.wallSeconds = timer.nsecsElapsed() / 1.0e9;
+
+    if (!finished) {
+        report.error = lastError.isEmpty() ? QString("解码未能到达文件末尾") : lastError;
+        return report;
+    }
+
+    report.success = true;
+    report.frames = report.timings.outputFrames;
+    if (report.format.sampleRate() > 0) {
+        report.audioSeconds = static_cast<double>(report.frames) / report.format.sampleRate();
+    }
+    if (report.wallSeconds > 0.0) {
+        report.realtimeFactor = report.audioSeconds / report.wallSeconds;
+    }
+    return report;
+}
+
+QString OfflineDecoder::outputPathFor(const QString& filePath)
+{
+    const QString directory = m_options.outputDirectory.isEmpty() ? QDir::currentPath() : m_options.outputDirectory;
+    const QString suffix = m_options.sink == OfflineDecodeOptions::Sink::Wav ? "wav" : "f32";
+    const QString baseName = QFileInfo(filePath).completeBaseName();
+
+    // 不同目录下的同名文件依次加序号，避免互相覆盖
+    QString path = QDir(directory).filePath(QString("%1.%2").arg(baseName, suffix));
+    for (int index = 2; m_usedOutputPaths.contains(path); ++index) {
+        path = QDir(directory).filePath(QString("%1_%2.%3").arg(baseName).arg(index).arg(suffix));
+    }
+    m_usedOutputPaths.insert(path);
+    return path;
+}
+
+QStringList OfflineDecoder::collectInputs(const QStringList& paths)
+{
+    QStringList nameFilters;
+    for (const QString& format : AudioEngine::supportedFormats()) {
+        nameFilters.append("*." + format);
+    }
+
+    QStringList files;
+    for (const QString& path : paths) {
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            files.append(info.absoluteFilePath());
+            continue;
+        }
+        QStringList found;
+        QDirIterator it(info.absoluteFilePath(), nameFilters, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            found.append(it.next());
+        }
+        found.sort();
+        files.append(found);
+    }
+    return files;
+}
+
+int OfflineDecoder::runCommandLine(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("离线解码：不打开声卡，尽快解码并处理音频文件，报告实时倍率、各阶段耗时和响度");
+    parser.addHelpOption();
+
+    QCommandLineOption sinkOption("sink", "输出：null（丢弃）、wav、raw（float原始数据）", "kind", "null");
+    QCommandLineOption outputDirOption("output-dir", "wav/raw输出目录（默认当前目录）", "path");
+    QCommandLineOption rateOption("rate", "输出采样率（默认沿用源文件）", "hz");
+    QCommandLineOption formatOption("format", "输出采样格式：s16、s32、f32", "format", "f32");
+    QCommandLineOption channelsOption("channels", "输出声道数：1或2（默认沿用源文件，最多2）", "count");
+    QCommandLineOption balanceOption("balance", "声道平衡，-1.0（左）到1.0（右）", "value", "0");
+    QCommandLineOption noAnalysisOption("no-analysis", "不做响度分析");
+    QCommandLineOption reportOption("report", "把结果写入JSON文件", "path");
+    QCommandLineOption verboseOption("verbose", "保留解码器的调试输出");
+    parser.addOptions({sinkOption, outputDirOption, rateOption, formatOption, channelsOption,
+                       balanceOption, noAnalysisOption, reportOption, verboseOption});
+    parser.addPositionalArgument("decode", "离线解码模式");
+    parser.addPositionalArgument("inputs", "音频文件或目录", "文件或目录...");
+
+    if (!parser.parse(arguments)) {
+        fprintf(stderr, "%s\n", qPrintable(parser.errorText()));
+        return 3;
+    }
+    if (parser.isSet("help")) {
+        fprintf(stdout, "%s", qPrintable(parser.helpText()));
+        return 0;
+    }
+
+    OfflineDecodeOptions options;
+    const QString sink = parser.value(sinkOption);
+    if (sink == "null") {
+        options.sink = OfflineDecodeOptions::Sink::Null;
+    } else if (sink == "wav") {
+        options.sink = OfflineDecodeOptions::Sink::Wav;
+    } else if (sink == "raw") {
+        options.sink = OfflineDecodeOptions::Sink::RawFloat;
+    } else {
+        fprintf(stderr, "无效的--sink: %s\n", qPrintable(sink));
+        return 3;
+    }
+    options.outputDirectory = parser.value(outputDirOption);
+
+    const QString format = parser.value(formatOption);
+    if (format == "s16") {
+        options.format.setSampleFormat(QAudioFormat::Int16);
+    } else if (format == "s32") {
+        options.format.setSampleFormat(QAudioFormat::Int32);
+    } else if (format == "f32") {
+        options.format.setSampleFormat(QAudioFormat::Float);
+    } else {
+        fprintf(stderr, "无效的--format: %s\n", qPrintable(format));
+        return 3;
+    }
+    if (parser.isSet(rateOption)) {
+        bool ok = false;
+        const int rate = parser.value(rateOption).toInt(&ok);
+        if (!ok || rate < 8000 || rate > 384000) {
+            fprintf(stderr, "无效的--rate: %s\n", qPrintable(parser.value(rateOption)));
+            return 3;
+        }
+        options.format.setSampleRate(rate);
+    }
+    if (parser.isSet(channelsOption)) {
+        const int channels = parser.value(channelsOption).toInt();
+        if (channels != 1 && channels != 2) {
+            fprintf(stderr, "无效的--channels: %s\n", qPrintable(parser.value(channelsOption)));
+            return 3;
+        }
+        options.format.setChannelCount(channels);
+    }
+    bool balanceOk = false;
+    options.balance = qBound(-1.0, parser.value(balanceOption).toDouble(&balanceOk), 1.0);
+    if (!balanceOk) {
+        fprintf(stderr, "无效的--balance: %s\n", qPrintable(parser.value(balanceOption)));
+        return 3;
+    }
+    options.analyze = !parser.isSet(noAnalysisOption);
+
+    QStringList positional = parser.positionalArguments();
+    if (!positional.isEmpty() && positional.first() == "decode") {
+        positional.removeFirst();
+    }
+    const QStringList inputs = collectInputs(positional);
+    if (inputs.isEmpty()) {
+        fprintf(stderr, "没有要处理的文件\n");
+        return 3;
+    }
+
+    if (!parser.isSet(verboseOption)) {
+        qInstallMessageHandler(quietMessageHandler);
+    }
+
+    OfflineDecoder decoder(options);
+    QJsonArray files;
+    DecoderStageTimings total;
+    qint64 totalAnalysisNs = 0;
+    double totalAudioSeconds = 0.0;
+    double totalWallSeconds = 0.0;
+    int failures = 0;
+
+    for (const QString& input : inputs) {
+        const OfflineDecodeReport report = decoder.decodeFile(input);
+        files.append(report.toJson());
+
+        if (!report.success) {
+            ++failures;
+            fprintf(stdout, "%s: 失败: %s\n", qPrintable(input), qPrintable(report.error));
+            continue;
+        }
+
+        totalAudioSeconds += report.audioSeconds;
+        totalWallSeconds += report.wallSeconds;
+        total.demuxNs += report.timings.demuxNs;
+        total.decodeNs += report.timings.decodeNs;
+        total.resampleNs += report.timings.resampleNs;
+        total.dspNs += report.timings.dspNs;
+        total.outputNs += report.timings.outputNs;
+        total.packets += report.timings.packets;
+        totalAnalysisNs += report.analysisNs;
+
+        QString line = QString("%1: %2s 音频，耗时 %3s，实时倍率 %4x")
+                           .arg(input)
+                           .arg(report.audioSeconds, 0, 'f', 1)
+                           .arg(report.wallSeconds, 0, 'f', 3)
+                           .arg(report.realtimeFactor, 0, 'f', 1);
+        if (report.loudness.frames > 0) {
+            line += QString("，响度 %1，峰值 %2")
+                        .arg(formatDb(report.loudness.integratedLufs, "LUFS"),
+                             formatDb(report.loudness.samplePeakDbfs, "dBFS"));
+        }
+        fprintf(stdout, "%s\n", qPrintable(line));
+    }
+
+    const qint64 peakRss = MetricsRegistry::peakResidentSetSize();
+    fprintf(stdout, "\n共 %d 个文件（失败 %d），音频 %.1fs，耗时 %.3fs，实时倍率 %.1fx\n",
+            static_cast<int>(inputs.size()), failures, totalAudioSeconds, totalWallSeconds,
+            totalWallSeconds > 0.0 ? totalAudioSeconds / totalWallSeconds : 0.0);
+    fprintf(stdout, "阶段耗时(ms)：读取 %.1f，解码 %.1f，重采样 %.1f，处理 %.1f，输出 %.1f，分析 %.1f\n",
+            nsToMs(total.demuxNs), nsToMs(total.decodeNs), nsToMs(total.resampleNs),
+            nsToMs(total.dspNs), nsToMs(total.outputNs - totalAnalysisNs), nsToMs(totalAnalysisNs));
+    if (peakRss >= 0) {
+        fprintf(stdout, "峰值内存: %.1f MB\n", peakRss / (1024.0 * 1024.0));
+    }
+
+    if (parser.isSet(reportOption)) {
+        QJsonObject summary;
+        summary["files"] = static_cast<int>(inputs.size());
+        summary["failures"] = failures;
+        summary["audio_seconds"] = totalAudioSeconds;
+        summary["wall_seconds"] = totalWallSeconds;
+        summary["realtime_factor"] = totalWallSeconds > 0.0 ? totalAudioSeconds / totalWallSeconds : 0.0;
+        summary["stages"] = timingsToJson(total, totalAnalysisNs);
+        summary["peak_rss_bytes"] = peakRss;
+
+        QJsonObject root;
+        root["summary"] = summary;
+        root["files"] = files;
+
+        QSaveFile file(parser.value(reportOption));
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0
+            || !file.commit()) {
+            fprintf(stderr, "无法写入结果文件: %s\n", qPrintable(parser.value(reportOption)));
+            return 1;
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+#ifndef OFFLINEDECODER_H
+#define OFFLINEDECODER_H
+
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QAudioFormat>
+#include <QJsonObject>
+#include "ffmpegdecoder.h"
+#include "loudnessmeter.h"
+
+/**
+ * @brief 离线解码的参数
+ */
+struct OfflineDecodeOptions
+{
+    enum class Sink {
+        Null,       // 丢弃输出，只测量处理链
+        Wav,
+        RawFloat
+    };
+
+    Sink sink = Sink::Null;
+    QString outputDirectory;     // 文件输出的目录，为空时使用当前目录
+    QAudioFormat format;         // 目标格式，无效的字段沿用解码流
+    double balance = 0.0;
+    bool analyze = true;         // 响度和峰值分析
+    bool stageTiming = true;     // 分阶段计时
+};
+
+/**
+ * @brief 单个文件的离线处理结果
+ */
+struct OfflineDecodeReport
+{
+    QString filePath;
+    QString outputPath;
+    bool success = false;
+    QString error;
+    QAudioFormat format;
+    qint64 frames = 0;
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    double realtimeFactor = 0.0;      // 音频时长 / 处理耗时
+    DecoderStageTimings timings;
+    qint64 analysisNs = 0;            // 响度分析耗时（包含在输出阶段内）
+    LoudnessMeter::Result loudness;
+
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief 无界面的离线解码：与播放相同的解码、重采样、平衡处理链，输出到空输出或文件
+ * @details 不打开声卡，也不经过解码定时器，每个文件在调用线程上尽快处理完，
+ *          报告实时倍率、各阶段耗时、响度和进程峰值内存。可用于批量响度分析和处理链的性能测量。
+ *
+ * 用法：musicPlayHandle decode [--sink null|wav|raw] [--output-dir 目录] [--rate 采样率]
+ *                              [--format s16|s32|f32] [--channels 1|2] [--balance 值]
+ *                              [--no-analysis] [--report 结果.json] [--verbose] 文件或目录...
+ */
+class OfflineDecoder
+{
+public:
+    explicit OfflineDecoder(const OfflineDecodeOptions& options);
+
+    OfflineDecodeReport decodeFile(const QString& filePath);
+
+    /**
+     * @brief 展开输入：目录递归查找支持的音频文件，结果按路径排序
+     */
+    static QStringList collectInputs(const QStringList& paths);
+
+    /**
+     * @brief 命令行入口（第一个位置参数为decode）
+     * @return 0 全部成功；1 有文件处理失败；3 参数错误
+     */
+    static int runCommandLine(const QStringList& arguments);
+
+private:
+    QString outputPathFor(const QString& filePath);
+
+    OfflineDecodeOptions m_options;
+    QSet<QString> m_usedOutputPaths;
+};
+
+#endif // OFFLINEDECODER_H
@@ -0,0 +1,462 @@
+#include "waveformcache.h"
+#include "audioiocontext.h"
+#include "../core/appconfig.h"
+#include "../core/metricsregistry.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// FFmpeg头文件
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/channel_layout.h>
+}
+
+namespace {
+
+const quint32 SIDECAR_MAGIC = 0x57464D31;  // "WFM1"
+const quint32 SIDECAR_VERSION = 1;
+
+inline qint8 quantizeSample(float value)
+{
+    return static_cast<qint8>(qBound(-127, qRound(value * 127.0f), 127));
+}
+
+} // namespace
+
+// 静态成员初始化
+WaveformCache* WaveformCache::s_instance = nullptr;
+
+WaveformCache::WaveformCache(QObject* parent)
+    : QObject(parent)
+    , m_memoryCache(64, 0, 4)
+    , m_generatorThread(nullptr)
+    , m_stopping(false)
+    , m_playbackActive(false)
+{
+    m_cacheDirectory = AppConfig::instance()->cacheDirectory() + "/waveforms";
+    QDir().mkpath(m_cacheDirectory);
+
+    // 生成线程以最低优先级运行
+    m_generatorThread = QThread::create([this]() { generatorLoop(); });
+    m_generatorThread->start(QThread::IdlePriority);
+
+    MetricsRegistry::registerGaugeCallback("cache.waveform.hit_rate", [this]() {
+        return m_memoryCache.statistics().hitRate();
+    });
+}
+
+WaveformCache::~WaveformCache()
+{
+    MetricsRegistry::unregisterGaugeCallback("cache.waveform.hit_rate");
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_stopping = true;
+        m_queueCondition.wakeAll();
+    }
+    if (m_generatorThread) {
+        m_generatorThread->wait();
+        delete m_generatorThread;
+        m_generatorThread = nullptr;
+    }
+}
+
+WaveformCache* WaveformCache::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    if (!s_instance) {
+        s_instance = new WaveformCache();
+    }
+    return s_instance;
+}
+
+void WaveformCache::cleanup()
+{
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+std::optional<WaveformOverview> WaveformCache::lookup(const QString& filePath)
+{
+    // 只查内存，不访问文件系统；内存中的概览由生成线程在request()时重新校验
+    return m_memoryCache.get(filePath);
+}
+
+std::optional<WaveformOverview> WaveformCache::load(const QString& filePath)
+{
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return std::nullopt;
+    }
+    const qint64 fileSize = fileInfo.size();
+    const qint64 modifiedMs = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    if (std::optional<WaveformOverview> cached = m_memoryCache.get(filePath)) {
+        if (cached->fileSize == fileSize && cached->modifiedMs == modifiedMs) {
+            return cached;
+        }
+        m_memoryCache.remove(filePath);
+    }
+
+    WaveformOverview overview;
+    if (!readSidecar(filePath, fileSize, modifiedMs, overview)) {
+        return std::nullopt;
+    }
+    m_memoryCache.put(filePath, overview, 0);
+    return overview;
+}
+
+void WaveformCache::request(const QString& filePath)
+{
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_queueMutex);
+    if (m_queued.contains(filePath)) {
+        return;
+    }
+    m_queued.insert(filePath);
+    m_queue.enqueue(filePath);
+    m_queueCondition.wakeOne();
+}
+
+void WaveformCache::setPlaybackActive(bool active)
+{
+    m_playbackActive = active;
+}
+
+QString WaveformCache::sidecarPath(const QString& filePath) const
+{
+    const QByteArray hash = QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_cacheDirectory + "/" + QString::fromLatin1(hash) + ".wfm";
+}
+
+bool WaveformCache::readSidecar(const QString& filePath, qint64 fileSize, qint64 modifiedMs,
+                                WaveformOverview& overview) const
+{
+    QFile file(sidecarPath(filePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString storedPath;
+    stream >> magic >> version;
+    if (magic != SIDECAR_MAGIC || version != SIDECAR_VERSION) {
+        return false;
+    }
+
+    QByteArray minimums;
+    QByteArray maximums;
+    stream >> storedPath >> overview.fileSize >> overview.modifiedMs
+           >> overview.sampleRate >> overview.durationMs >> overview.peak >> overview.rms
+           >> minimums >> maximums;
+
+    // 哈希冲突或文件已变化时视为失效
+    if (stream.status() != QDataStream::Ok || storedPath != filePath
+        || overview.fileSize != fileSize || overview.modifiedMs != modifiedMs
+        || minimums.size() != maximums.size()) {
+        return false;
+    }
+
+    overview.minimums.resize(minimums.size());
+    overview.maximums.resize(maximums.size());
+    std::memcpy(overview.minimums.data(), minimums.constData(), minimums.size());
+    std::memcpy(overview.maximums.data(), maximums.constData(), maximums.size());
+    return overview.isValid();
+}
+
+bool WaveformCache::writeSidecar(const QString& filePath, const WaveformOverview& overview) const
+{
+    // QSaveFile保证写入中断时不会留下不完整的旁路文件
+    QSaveFile file(sidecarPath(filePath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "WaveformCache: 无法写入旁路文件:" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    const QByteArray minimums(reinterpret_cast<const char*>(overview.minimums.constData()), overview.minimums.size());
+    const QByteArray maximums(reinterpret_cast<const char*>(overview.maximums.constData()), overview.maximums.size());
+    stream << SIDECAR_MAGIC << SIDECAR_VERSION << filePath << overview.fileSize << overview.modifiedMs
+           << overview.sampleRate << overview.durationMs << overview.peak << overview.rms
+           << minimums << maximums;
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+void WaveformCache::generatorLoop()
+{
+    while (true) {
+        QString filePath;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_queue.isEmpty() && !m_stopping) {
+                m_queueCondition.wait(&m_queueMutex);
+            }
+            if (m_stopping) {
+                return;
+            }
+            filePath = m_queue.dequeue();
+        }
+
+        // 校验在生成线程进行：内存中的概览仍有效时无需通知，否则读旁路文件或重新生成
+        const QFileInfo fileInfo(filePath);
+        const qint64 fileSize = fileInfo.size();
+        const qint64 modifiedMs = fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : 0;
+        const std::optional<WaveformOverview> cached = m_memoryCache.get(filePath);
+        const bool fresh = cached && fileInfo.exists()
+            && cached->fileSize == fileSize && cached->modifiedMs == modifiedMs;
+
+        bool ready = false;
+        if (!fresh && fileInfo.exists()) {
+            WaveformOverview overview;
+            if (readSidecar(filePath, fileSize, modifiedMs, overview)) {
+                m_memoryCache.put(filePath, overview, 0);
+                ready = true;
+            } else {
+                m_memoryCache.remove(filePath);
+
+                QElapsedTimer timer;
+                timer.start();
+                if (generateOverview(filePath, overview)) {
+                    writeSidecar(filePath, overview);
+                    m_memoryCache.put(filePath, overview, 0);
+                    ready = true;
+                    qDebug() << "WaveformCache: 波形生成完成:" << filePath << "耗时" << timer.elapsed() << "ms"
+                             << "峰值" << overview.peak << "RMS" << overview.rms;
+                }
+            }
+        } else if (!fileInfo.exists()) {
+            m_memoryCache.remove(filePath);
+        }
+
+        {
+            QMutexLocker locker(&m_queueMutex);
+            m_queued.remove(filePath);
+        }
+
+        if (ready) {
+            emit overviewReady(filePath);
+        }
+    }
+}
+
+bool WaveformCache::throttle(QElapsedTimer& sliceTimer)
+{
+    if (m_stopping) {
+        return false;
+    }
+
+    // 按占空比休眠：工作WORK_SLICE_MS后休眠 slice * (100 - duty) / duty
+    if (sliceTimer.elapsed() >= WORK_SLICE_MS) {
+        const int duty = m_playbackActive ? PLAYBACK_DUTY_PERCENT : IDLE_DUTY_PERCENT;
+        const qint64 sleepMs = sliceTimer.elapsed() * (100 - duty) / duty;
+        QThread::msleep(static_cast<unsigned long>(sleepMs));
+        sliceTimer.restart();
+    }
+    return !m_stopping;
+}
+
+bool WaveformCache::generateOverview(const QString& filePath, WaveformOverview& overview)
+{
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return false;
+    }
+    overview.fileSize = fileInfo.size();
+    overview.modifiedMs = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    AVFormatContext* formatContext = avformat_alloc_context();
+    AVIOContext* ioContext = AudioIOContext::open(filePath, AudioIOOptions::probe());
+    AVCodecContext* codecContext = nullptr;
+    SwrContext* swrContext = nullptr;
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    bool success = false;
+
+    // 细粒度块的min/max，结束后合并为固定数量的桶
+    QVector<float> fineMinimums;
+    QVector<float> fineMaximums;
+    float blockMin = 0.0f;
+    float blockMax = 0.0f;
+    int blockSamples = 0;
+    double sumSquares = 0.0;
+    float peak = 0.0f;
+    qint64 totalSamples = 0;
+    QVector<float> monoBuffer;
+
+    auto consumeSamples = [&](const float* samples, int count) {
+        for (int i = 0; i < count; ++i) {
+            const float sample = samples[i];
+            if (blockSamples == 0) {
+                blockMin = blockMax = sample;
+            } else {
+                blockMin = qMin(blockMin, sample);
+                blockMax = qMax(blockMax, sample);
+            }
+            sumSquares += static_cast<double>(sample) * sample;
+            peak = qMax(peak, std::fabs(sample));
+            if (++blockSamples == FINE_BLOCK_SAMPLES) {
+                fineMinimums.append(blockMin);
+                fineMaximums.append(blockMax);
+                blockSamples = 0;
+            }
+        }
+        totalSamples += count;
+    };
+
+    try {
+        if (!formatContext || !packet || !frame) {
+            throw std::runtime_error("FFmpeg对象分配失败");
+        }
+        if (ioContext) {
+            formatContext->pb = ioContext;
+            formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        }
+        if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+            throw std::runtime_error("无法打开输入文件");
+        }
+        if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+            throw std::runtime_error("无法查找流信息");
+        }
+
+        const AVCodec* codec = nullptr;
+        const int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+        if (streamIndex < 0 || !codec) {
+            throw std::runtime_error("没有音频流");
+        }
+        for (unsigned int i = 0; i < formatContext->nb_streams; ++i) {
+            if (static_cast<int>(i) != streamIndex) {
+                formatContext->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        codecContext = avcodec_alloc_context3(codec);
+        if (!codecContext
+            || avcodec_parameters_to_context(codecContext, formatContext->streams[streamIndex]->codecpar) < 0
+            || avcodec_open2(codecContext, codec, nullptr) < 0) {
+            throw std::runtime_error("无法打开解码器");
+        }
+
+        // 下混为单声道浮点，保持原采样率
+        AVChannelLayout monoLayout;
+        av_channel_layout_default(&monoLayout, 1);
+        const int sampleRate = codecContext->sample_rate;
+        if (swr_alloc_set_opts2(&swrContext, &monoLayout, AV_SAMPLE_FMT_FLT, sampleRate,
+                                &codecContext->ch_layout, codecContext->sample_fmt, sampleRate,
+                                0, nullptr) < 0 || swr_init(swrContext) < 0) {
+            av_channel_layout_uninit(&monoLayout);
+            throw std::runtime_error("无法初始化重采样器");
+        }
+        av_channel_layout_uninit(&monoLayout);
+
+        QElapsedTimer sliceTimer;
+        sliceTimer.start();
+
+        auto drainFrames = [&]() -> bool {
+            while (avcodec_receive_frame(codecContext, frame) == 0) {
+                const int maxSamples = swr_get_out_samples(swrContext, frame->nb_samples);
+                if (monoBuffer.size() < maxSamples) {
+                    monoBuffer.resize(maxSamples);
+                }
+                uint8_t* output = reinterpret_cast<uint8_t*>(monoBuffer.data());
+                const int converted = swr_convert(swrContext, &output, maxSamples,
+                                                  const_cast<const uint8_t**>(frame->extended_data),
+                                                  frame->nb_samples);
+                if (converted > 0) {
+                    consumeSamples(monoBuffer.constData(), converted);
+                }
+                av_frame_unref(frame);
+            }
+            return throttle(sliceTimer);
+        };
+
+        bool aborted = false;
+        while (!aborted && av_read_frame(formatContext, packet) >= 0) {
+            if (packet->stream_index == streamIndex) {
+                avcodec_send_packet(codecContext, packet);
+                aborted = !drainFrames();
+            }
+            av_packet_unref(packet);
+        }
+
+        if (aborted) {
+            throw std::runtime_error("生成已取消");
+        }
+
+        // 冲刷解码器
+        avcodec_send_packet(codecContext, nullptr);
+        drainFrames();
+
+        if (blockSamples > 0) {
+            fineMinimums.append(blockMin);
+            fineMaximums.append(blockMax);
+        }
+        if (totalSamples == 0 || sampleRate <= 0) {
+            throw std::runtime_error("没有解码到音频数据");
+        }
+
+        // 合并为固定数量的桶
+        const int fineCount = fineMaximums.size();
+        const int bucketCount = qMin(fineCount, static_cast<int>(DEFAULT_BUCKET_COUNT));
+        overview.minimums.resize(bucketCount);
+        overview.maximums.resize(bucketCount);
+        for (int bucket = 0; bucket < bucketCount; ++bucket) {
+            const int begin = static_cast<int>(static_cast<qint64>(bucket) * fineCount / bucketCount);
+            const int end = qMax(begin + 1, static_cast<int>(static_cast<qint64>(bucket + 1) * fineCount / bucketCount));
+            float minimum = fineMinimums[begin];
+            float maximum = fineMaximums[begin];
+            for (int i = begin + 1; i < end; ++i) {
+                minimum = qMin(minimum, fineMinimums[i]);
+                maximum = qMax(maximum, fineMaximums[i]);
+            }
+            overview.minimums[bucket] = quantizeSample(minimum);
+            overview.maximums[bucket] = quantizeSample(maximum);
+        }
+
+        overview.peak = qMin(peak, 1.0f);
+        overview.rms = static_cast<float>(std::sqrt(sumSquares / totalSamples));
+        overview.sampleRate = sampleRate;
+        overview.durationMs = totalSamples * 1000 / sampleRate;
+        success = true;
+
+    } catch (const std::exception& e) {
+        qDebug() << "WaveformCache: 波形生成失败:" << filePath << e.what();
+    }
+
+    // 清理资源
+    swr_free(&swrContext);
+    avcodec_free_context(&codecContext);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    if (formatContext) {
+        avformat_close_input(&formatContext);
+    }
+    AudioIOContext::free(&ioContext);
+
+    return success;
+}
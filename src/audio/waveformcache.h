@@ -0,0 +1,125 @@
+#ifndef WAVEFORMCACHE_H
+#define WAVEFORMCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QQueue>
+#include <QSet>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QElapsedTimer>
+#include <atomic>
+#include <optional>
+
+#include "../core/shardedcache.h"
+
+/**
+ * @brief 波形概览及解码得到的音频信息
+ */
+struct WaveformOverview {
+    QVector<qint8> minimums;   // 每个桶的最小采样值（-127~127）
+    QVector<qint8> maximums;   // 每个桶的最大采样值（-127~127）
+    float peak = 0.0f;         // 峰值（0.0-1.0）
+    float rms = 0.0f;          // 均方根电平（0.0-1.0）
+    qint64 durationMs = 0;     // 按解码采样数计算的时长
+    int sampleRate = 0;
+
+    // 生成时文件的大小和修改时间，用于判断缓存是否失效
+    qint64 fileSize = 0;
+    qint64 modifiedMs = 0;
+
+    bool isValid() const { return !maximums.isEmpty() && minimums.size() == maximums.size(); }
+    int bucketCount() const { return maximums.size(); }
+};
+
+/**
+ * @brief 波形概览缓存
+ * @details 每个音频文件对应缓存目录下的一个旁路文件（waveforms/<路径哈希>.wfm），
+ *          以"路径+大小+修改时间"校验，记录min/max波形概览、峰值/RMS和实测时长。
+ *          缺失时由后台线程以最低优先级解码生成，并按占空比限速，播放期间进一步降低占比，
+ *          保证不与播放解码争抢CPU和磁盘。
+ */
+class WaveformCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 单例模式
+    static WaveformCache* instance();
+    static void cleanup();
+
+    /**
+     * @brief 查询内存中的波形概览，不访问文件系统，可在GUI线程调用
+     * @details 不检查文件是否已变化；调用request()后由生成线程校验，
+     *          失效时重新读取或生成并发出overviewReady
+     * @param filePath 音频文件路径
+     * @return 内存中有概览时返回，否则返回空
+     */
+    std::optional<WaveformOverview> lookup(const QString& filePath);
+
+    /**
+     * @brief 按文件大小和修改时间校验后读取波形概览（内存或旁路文件）
+     * @details 会stat音频文件并可能读取旁路文件，供曲库扫描等已在做文件I/O的路径使用
+     * @param filePath 音频文件路径
+     * @return 缓存有效时返回概览，否则返回空
+     */
+    std::optional<WaveformOverview> load(const QString& filePath);
+
+    /**
+     * @brief 请求后台校验并在需要时读取或生成波形概览（已排队时忽略）
+     * @param filePath 音频文件路径
+     */
+    void request(const QString& filePath);
+
+    /**
+     * @brief 通知当前是否正在播放，播放期间生成器进一步降速
+     */
+    void setPlaybackActive(bool active);
+
+    static const int DEFAULT_BUCKET_COUNT = 2048;
+
+signals:
+    /**
+     * @brief 后台生成完成（在生成线程中发出）
+     * @param filePath 音频文件路径
+     */
+    void overviewReady(const QString& filePath);
+
+private:
+    explicit WaveformCache(QObject* parent = nullptr);
+    ~WaveformCache();
+
+    QString sidecarPath(const QString& filePath) const;
+    bool readSidecar(const QString& filePath, qint64 fileSize, qint64 modifiedMs, WaveformOverview& overview) const;
+    bool writeSidecar(const QString& filePath, const WaveformOverview& overview) const;
+
+    void generatorLoop();
+    bool generateOverview(const QString& filePath, WaveformOverview& overview);
+    bool throttle(QElapsedTimer& sliceTimer);
+
+    static WaveformCache* s_instance;
+
+    // 每个细粒度块的采样数，最后再合并为DEFAULT_BUCKET_COUNT个桶
+    static const int FINE_BLOCK_SAMPLES = 256;
+    // 限速：每工作WORK_SLICE_MS毫秒后按占空比休眠
+    static const int WORK_SLICE_MS = 20;
+    static const int IDLE_DUTY_PERCENT = 50;
+    static const int PLAYBACK_DUTY_PERCENT = 15;
+
+    QString m_cacheDirectory;
+    ShardedCache<QString, WaveformOverview> m_memoryCache;
+
+    // 生成队列
+    QMutex m_queueMutex;
+    QWaitCondition m_queueCondition;
+    QQueue<QString> m_queue;
+    QSet<QString> m_queued;
+    QThread* m_generatorThread;
+
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_playbackActive;
+};
+
+#endif // WAVEFORMCACHE_H
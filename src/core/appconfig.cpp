@@ -1,4 +1,5 @@
 #include "appconfig.h"
+#include "constants.h"
 #include <QStandardPaths>
 #include <QDir>
 #include <QMutexLocker>
@@ -21,6 +22,8 @@ const QString AppConfig::ConfigKeys::EQUALIZER_ENABLED = "audio/equalizer_enable
 const QString AppConfig::ConfigKeys::CROSSFADE_DURATION = "audio/crossfade_duration";
 const QString AppConfig::ConfigKeys::CACHE_SIZE = "performance/cache_size";
 const QString AppConfig::ConfigKeys::LOG_LEVEL = "debug/log_level";
+const QString AppConfig::ConfigKeys::LOG_RETENTION_DAYS = "debug/log_retention_days";
+const QString AppConfig::ConfigKeys::LOG_DATABASE_MAX_SIZE = "debug/log_database_max_size_mb";
 const QString AppConfig::ConfigKeys::WINDOW_GEOMETRY = "ui/window_geometry";
 const QString AppConfig::ConfigKeys::WINDOW_STATE = "ui/window_state";
 
@@ -132,6 +135,17 @@ QString AppConfig::logDirectory() const
     return QDir(dataDir).filePath("logs");
 }
 
+int AppConfig::logRetentionDays() const
+{
+    return getValue(ConfigKeys::LOG_RETENTION_DAYS, Constants::Logging::LOG_RETENTION_DAYS).toInt();
+}
+
+qint64 AppConfig::logDatabaseMaxSize() const
+{
+    const qint64 sizeMb = getValue(ConfigKeys::LOG_DATABASE_MAX_SIZE, Constants::Logging::LOG_DATABASE_MAX_SIZE_MB).toLongLong();
+    return sizeMb * 1024 * 1024;
+}
+
 void AppConfig::saveConfig()
 {
     QMutexLocker locker(&m_configMutex);
@@ -210,6 +224,14 @@ void AppConfig::initializeDefaults()
     if (!m_settings->contains(ConfigKeys::LOG_LEVEL)) {
         m_settings->setValue(ConfigKeys::LOG_LEVEL, "INFO");
     }
+    
+    if (!m_settings->contains(ConfigKeys::LOG_RETENTION_DAYS)) {
+        m_settings->setValue(ConfigKeys::LOG_RETENTION_DAYS, Constants::Logging::LOG_RETENTION_DAYS);
+    }
+    
+    if (!m_settings->contains(ConfigKeys::LOG_DATABASE_MAX_SIZE)) {
+        m_settings->setValue(ConfigKeys::LOG_DATABASE_MAX_SIZE, Constants::Logging::LOG_DATABASE_MAX_SIZE_MB); // MB
+    }
 }
 
 void AppConfig::ensureDirectoryExists(const QString& path)
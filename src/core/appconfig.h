@@ -81,6 +81,18 @@ public:
      */
     QString logDirectory() const;
     
+    /**
+     * @brief 获取数据库日志保留天数
+     * @return 天数，<=0表示不按时间清理
+     */
+    int logRetentionDays() const;
+    
+    /**
+     * @brief 获取日志库大小上限
+     * @return 字节数，<=0表示不按大小清理
+     */
+    qint64 logDatabaseMaxSize() const;
+    
     /**
      * @brief 保存配置到文件
      */
@@ -162,6 +174,8 @@ private:
         static const QString CROSSFADE_DURATION;
         static const QString CACHE_SIZE;
         static const QString LOG_LEVEL;
+        static const QString LOG_RETENTION_DAYS;
+        static const QString LOG_DATABASE_MAX_SIZE;
         static const QString WINDOW_GEOMETRY;
         static const QString WINDOW_STATE;
     };
@@ -1,13 +1,29 @@
 #include "applicationmanager.h"
 #include "logger.h"
+#include "tracer.h"
+#include "metricsregistry.h"
+#include "constants.h"
+#include "startupgraph.h"
 #include "appconfig.h"
 #include "../database/databasemanager.h"
+#include "../database/tagindex.h"
+#include "../audio/audioengine.h"
+#include "../managers/coverartcache.h"
+#include "../managers/playhistoryrecorder.h"
+#include "../managers/smartplaylist.h"
+#include "../audio/mappedfilecache.h"
+#include "../audio/waveformcache.h"
+#include "../threading/mainthreadmanager.h"
 #include "../../mainwindow.h"
 
 #include <QApplication>
 #include <QObject>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QShortcut>
+#include <QKeySequence>
+#include <QFileInfo>
+#include <QDir>
 
 
 ApplicationManager* ApplicationManager::m_instance = nullptr;
@@ -29,6 +45,7 @@ ApplicationManager::ApplicationManager(QObject* parent)
     , m_databaseManager(nullptr)
     , m_logger(nullptr)
     , m_appConfig(nullptr)
+    , m_startupGraph(nullptr)
     , m_splashScreen(nullptr)
     , m_systemTrayIcon(nullptr)
     , m_systemTrayMenu(nullptr)
@@ -84,42 +101,97 @@ bool ApplicationManager::initialize(QApplication* app, int argc, char* argv[])
     m_state = ApplicationState::Initializing;
     qDebug() << "ApplicationManager::initialize() - 状态设置为 Initializing";
     
-    try {
-        // 初始化核心组件
-        qDebug() << "ApplicationManager::initialize() - 开始初始化核心组件";
+    // 按依赖关系启动：数据库在工作线程建表修复的同时，主线程初始化音频
+    buildStartupGraph();
+    if (!m_startupGraph->start() || !m_startupGraph->waitFor("ui")) {
+        qCritical() << "ApplicationManager::initialize() - 启动失败:\n" << qPrintable(m_startupGraph->report());
+        m_state = ApplicationState::Error;
+        return false;
+    }
+    
+    m_initialized = true;
+    m_state = ApplicationState::Running;
+    
+    const qint64 timeToWindow = m_startupGraph->elapsedMs();
+    MetricsRegistry::gauge("startup.time_to_window_ms")->set(static_cast<double>(timeToWindow));
+    qDebug() << "ApplicationManager::initialize() - 主窗口已显示，耗时" << timeToWindow << "ms";
+    
+    // 预热等后台任务全部结束、事件循环处理完首帧后视为可交互
+    if (m_startupGraph->isFinished()) {
+        QTimer::singleShot(0, this, &ApplicationManager::reportStartupTimings);
+    } else {
+        connect(m_startupGraph, &StartupGraph::finished, this, [this]() {
+            QTimer::singleShot(0, this, &ApplicationManager::reportStartupTimings);
+        });
+    }
+    
+    return true;
+}
+
+void ApplicationManager::buildStartupGraph()
+{
+    using Affinity = StartupGraph::Affinity;
+    
+    m_startupGraph = new StartupGraph(this);
+    
+    m_startupGraph->addTask("core", Affinity::MainThread, {}, [this]() {
         initializeCore();
-        qDebug() << "ApplicationManager::initialize() - 核心组件初始化完成";
-        
-        // 初始化数据库
-        qDebug() << "ApplicationManager::initialize() - 开始初始化数据库";
+        return true;
+    });
+    
+    // 建表、初始数据和标签修复只用工作线程自己的连接，完成后交给主线程
+    m_startupGraph->addTask("database", Affinity::Worker, {"core"}, [this]() {
+        prepareDatabase();
+        return true;
+    });
+    m_startupGraph->addTask("database.attach", Affinity::MainThread, {"database"}, [this]() {
         initializeDatabase();
-        qDebug() << "ApplicationManager::initialize() - 数据库初始化完成";
-        
-        // 初始化其他组件
-        qDebug() << "ApplicationManager::initialize() - 开始初始化其他组件";
+        return true;
+    });
+    
+    // 读一遍主窗口首次加载的表，让标签和歌曲列表从文件缓存读取
+    m_startupGraph->addTask("database.warmup", Affinity::Worker, {"database"}, []() {
+        DatabaseManager::warmUpFileCache(AppConfig::instance()->databasePath());
+        return true;
+    }, false);
+    
+    // 音频设备枚举和FFmpeg初始化不访问数据库，与数据库准备并行
+    m_startupGraph->addTask("audio", Affinity::MainThread, {"core"}, [this]() {
+        initializeAudio();
+        return true;
+    }, false);
+    
+    m_startupGraph->addTask("components", Affinity::MainThread, {"database.attach"}, [this]() {
         initializeComponents();
-        qDebug() << "ApplicationManager::initialize() - 其他组件初始化完成";
-        
-        // 初始化UI
-        qDebug() << "ApplicationManager::initialize() - 开始初始化UI";
-        initializeUI();
-        qDebug() << "ApplicationManager::initialize() - UI初始化完成";
-        
-        m_initialized = true;
-        m_state = ApplicationState::Running;
-        qDebug() << "ApplicationManager::initialize() - 初始化成功完成";
-        
         return true;
-    } catch (const std::exception& e) {
-        QString error = QString("初始化失败: %1").arg(e.what());
-        qCritical() << "ApplicationManager::initialize() - 捕获到异常:" << error;
-        m_state = ApplicationState::Error;
-        return false;
-    } catch (...) {
-        QString error = "初始化失败: 未知错误";
-        qCritical() << "ApplicationManager::initialize() - 捕获到未知异常:" << error;
-        m_state = ApplicationState::Error;
-        return false;
+    });
+    
+    m_startupGraph->addTask("ui", Affinity::MainThread, {"database.attach", "audio", "components"}, [this]() {
+        initializeUI();
+        return m_mainWindow != nullptr;
+    });
+}
+
+void ApplicationManager::reportStartupTimings()
+{
+    if (!m_startupGraph) {
+        return;
+    }
+    
+    const qint64 timeToInteractive = m_startupGraph->elapsedMs();
+    MetricsRegistry::gauge("startup.time_to_interactive_ms")->set(static_cast<double>(timeToInteractive));
+    for (const StartupGraph::TaskInfo& task : m_startupGraph->tasks()) {
+        if (task.startMs >= 0 && task.finishMs >= 0) {
+            MetricsRegistry::gauge("startup.task_ms." + task.name)->set(static_cast<double>(task.finishMs - task.startMs));
+        }
+    }
+    
+    const QString summary = QString("启动完成: 主窗口%1ms，可交互%2ms")
+                                .arg(MetricsRegistry::gauge("startup.time_to_window_ms")->value())
+                                .arg(timeToInteractive);
+    qDebug() << "ApplicationManager -" << summary << "\n" << qPrintable(m_startupGraph->report());
+    if (m_logger) {
+        m_logger->info(summary, "Startup");
     }
 }
 
@@ -138,6 +210,12 @@ bool ApplicationManager::start()
     }
     
     m_running = true;
+    
+    // 指定了导出目标或处于调试模式时开始导出运行时指标
+    if (!m_config.metricsSnapshotPath.isEmpty() || m_config.metricsPort > 0 || m_config.enableDebugMode) {
+        startPerformanceMonitoring();
+    }
+    
     qDebug() << "ApplicationManager::start() - 应用程序启动成功";
     
     return true;
@@ -157,11 +235,44 @@ void ApplicationManager::shutdown()
     
     // 测试管理器已删除
     
+    // 丢弃尚未执行的UI更新，它们可能引用已销毁的控件
+    if (m_mainThreadManager) {
+        MainThreadManager::cleanup();
+        m_mainThreadManager = nullptr;
+    }
+    
+    // 写出最后一次指标快照，之后缓存注销各自的采样回调
+    stopPerformanceMonitoring();
+    
+    // 写入剩余的播放记录并停止写线程
+    PlayHistoryRecorder::cleanup();
+    
+    // 释放智能播放列表的结果缓存
+    SmartPlaylistEngine::cleanup();
+    
+    // 释放标签索引
+    TagIndex::cleanup();
+    
+    // 等待封面解码任务结束并释放图集映射
+    CoverArtCache::cleanup();
+    
+    // 停止波形生成线程
+    WaveformCache::cleanup();
+    
+    // 释放预加载的文件映射
+    MappedFileCache::cleanup();
+    
     if (m_databaseManager) {
         m_databaseManager = nullptr;
     }
     
+    // 停止追踪，若指定了--trace则导出追踪文件
+    Tracer::cleanup();
+    MetricsRegistry::cleanup();
+    
     if (m_logger) {
+        // 停止写线程并写出缓冲区中剩余的日志
+        m_logger->shutdown();
         m_logger = nullptr;
     }
     
@@ -180,6 +291,45 @@ void ApplicationManager::enableDeveloperMode(bool enabled)
     m_config.enableDeveloperMode = enabled;
 }
 
+void ApplicationManager::setMetricsExport(const QString& snapshotPath, int port)
+{
+    m_config.metricsSnapshotPath = snapshotPath;
+    m_config.metricsPort = port;
+}
+
+void ApplicationManager::startPerformanceMonitoring()
+{
+    MetricsRegistry::registerGaugeCallback("process.rss_bytes", []() {
+        return static_cast<double>(MetricsRegistry::residentSetSize());
+    });
+
+    QString snapshotPath = m_config.metricsSnapshotPath;
+    if (snapshotPath.isEmpty() && m_config.enableDebugMode) {
+        snapshotPath = AppConfig::instance()->logDirectory() + "/" + Constants::Performance::METRICS_SNAPSHOT_FILE;
+    }
+
+    MetricsRegistry* registry = MetricsRegistry::instance();
+    if (!snapshotPath.isEmpty()) {
+        registry->startPeriodicSnapshot(snapshotPath, Constants::Performance::METRICS_SNAPSHOT_INTERVAL_MS);
+    }
+    if (m_config.metricsPort > 0 && m_config.metricsPort <= 65535) {
+        registry->startHttpEndpoint(static_cast<quint16>(m_config.metricsPort));
+    }
+}
+
+void ApplicationManager::stopPerformanceMonitoring()
+{
+    MetricsRegistry* registry = MetricsRegistry::instance();
+    registry->stopPeriodicSnapshot();
+    registry->stopHttpEndpoint();
+    MetricsRegistry::unregisterGaugeCallback("process.rss_bytes");
+}
+
+QVariantMap ApplicationManager::getPerformanceMetrics() const
+{
+    return MetricsRegistry::snapshot().toVariantMap();
+}
+
 // TestManager* ApplicationManager::getTestManager() const
 // {
 //     return m_testManager;
@@ -190,31 +340,59 @@ void ApplicationManager::initializeCore()
 {
     m_logger = Logger::instance();
     m_appConfig = AppConfig::instance();
+    m_mainThreadManager = MainThreadManager::instance();
+    
+    // 在主线程创建，保证数据库管理器及其定时器归属主线程
+    m_databaseManager = DatabaseManager::instance();
 }
 
-void ApplicationManager::initializeDatabase()
+void ApplicationManager::prepareDatabase()
 {
-    qDebug() << "ApplicationManager::initializeDatabase() - 开始初始化数据库管理器";
-    
-    qDebug() << "ApplicationManager::initializeDatabase() - 获取DatabaseManager实例";
-    m_databaseManager = DatabaseManager::instance();
     if (!m_databaseManager) {
-        qCritical() << "ApplicationManager::initializeDatabase() - 获取DatabaseManager实例失败";
+        qCritical() << "ApplicationManager::prepareDatabase() - 获取DatabaseManager实例失败";
         throw std::runtime_error("Failed to get DatabaseManager instance");
     }
-    qDebug() << "ApplicationManager::initializeDatabase() - DatabaseManager实例获取成功";
     
-    qDebug() << "ApplicationManager::initializeDatabase() - 获取数据库路径";
     QString dbPath = AppConfig::instance()->databasePath();
-    qDebug() << "ApplicationManager::initializeDatabase() - 数据库路径:" << dbPath;
+    qDebug() << "ApplicationManager::prepareDatabase() - 数据库路径:" << dbPath;
     
-    qDebug() << "ApplicationManager::initializeDatabase() - 调用DatabaseManager::initialize";
     if (!m_databaseManager->initialize(dbPath)) {
         QString error = QString("数据库初始化失败: %1").arg(m_databaseManager->lastError());
-        qCritical() << "ApplicationManager::initializeDatabase() - 数据库初始化失败:" << error;
+        qCritical() << "ApplicationManager::prepareDatabase() - 数据库初始化失败:" << error;
+        throw std::runtime_error(error.toStdString());
+    }
+    
+    // 连接只能在创建它的线程中使用，交给主线程重新打开
+    m_databaseManager->releaseConnection();
+    qDebug() << "ApplicationManager::prepareDatabase() - 数据库结构准备完成";
+}
+
+void ApplicationManager::initializeDatabase()
+{
+    if (!m_databaseManager->reopenConnection()) {
+        QString error = QString("数据库打开失败: %1").arg(m_databaseManager->lastError());
+        qCritical() << "ApplicationManager::initializeDatabase() - " << error;
         throw std::runtime_error(error.toStdString());
     }
     qDebug() << "ApplicationManager::initializeDatabase() - 数据库初始化成功";
+    
+    // 日志库按天分区，由数据库管理器定时整表清理
+    AppConfig* config = AppConfig::instance();
+    m_databaseManager->setLogRetentionPolicy(config->logRetentionDays(), config->logDatabaseMaxSize());
+    
+    // 日志和播放记录都由各自的写线程用独立连接写入
+    const QString dbPath = config->databasePath();
+    Logger::instance()->setDatabasePath(dbPath);
+    
+    // 重放上次未写入的播放记录
+    const QString journalPath = QFileInfo(dbPath).absoluteDir().filePath(Constants::Database::PLAY_HISTORY_JOURNAL_FILE);
+    PlayHistoryRecorder::instance()->start(dbPath, journalPath);
+}
+
+void ApplicationManager::initializeAudio()
+{
+    // 创建音频引擎：启动音频工作线程、枚举输出设备并初始化FFmpeg解码器
+    m_audioEngine = AudioEngine::instance();
 }
 
 void ApplicationManager::initializeComponents()
@@ -231,6 +409,15 @@ void ApplicationManager::initializeUI()
         qDebug() << "ApplicationManager::initializeUI() - 主窗口创建成功，准备显示";
         m_mainWindow->show();
         qDebug() << "ApplicationManager::initializeUI() - 主窗口显示完成";
+        
+        // 追踪期间按Ctrl+Alt+T立即导出快照，便于在出现卡顿后保存现场
+        if (Tracer::isEnabled()) {
+            QShortcut* traceShortcut = new QShortcut(QKeySequence("Ctrl+Alt+T"), m_mainWindow);
+            connect(traceShortcut, &QShortcut::activated, this, []() {
+                const QString path = Tracer::instance()->exportSnapshot();
+                qDebug() << "ApplicationManager - 追踪快照已导出:" << path;
+            });
+        }
     } else {
         qDebug() << "ApplicationManager::initializeUI() - 主窗口创建失败";
         logError("Failed to create MainWindow instance");
@@ -51,6 +51,7 @@ class MainThreadManager;
 class DatabaseManager;
 class Logger;
 class AppConfig;
+class StartupGraph;
 
 // 应用程序状态枚举
 enum class ApplicationState {
@@ -101,6 +102,8 @@ struct AppConfiguration {
     int logLevel;
     int maxLogFiles;
     int maxLogSize;
+    QString metricsSnapshotPath;
+    int metricsPort;
     
     AppConfiguration() : 
         appName("Qt6音频播放器"),
@@ -120,7 +123,8 @@ struct AppConfiguration {
         enableDebugMode(false),
         logLevel(2),
         maxLogFiles(10),
-        maxLogSize(10485760) {} // 10MB
+        maxLogSize(10485760), // 10MB
+        metricsPort(0) {}
 };
 
 // 应用程序管理器
@@ -197,6 +201,7 @@ public:
     void installUpdate();
     
     // 性能监控
+    void setMetricsExport(const QString& snapshotPath, int port);
     void startPerformanceMonitoring();
     void stopPerformanceMonitoring();
     QVariantMap getPerformanceMetrics() const;
@@ -303,6 +308,7 @@ private:
     DatabaseManager* m_databaseManager;
     Logger* m_logger;
     AppConfig* m_appConfig;
+    StartupGraph* m_startupGraph;
     
     // UI组件
     QSplashScreen* m_splashScreen;
@@ -341,11 +347,15 @@ private:
     
     // 内部方法
     void initializeCore();
+    void prepareDatabase();
     void initializeDatabase();
+    void initializeAudio();
     void initializeComponents();
     void initializeUI();
     void initializeIntegration();
     void finalizeInitialization();
+    void buildStartupGraph();
+    void reportStartupTimings();
     
     // 配置管理
     void loadDefaultConfiguration();
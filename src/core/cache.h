@@ -7,6 +7,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QDebug>
+#include <optional>
 #include "constants.h"
 
 /**
@@ -84,8 +85,11 @@ public:
     {
         QMutexLocker locker(&m_mutex);
         
+        ++m_totalRequests;
         auto it = m_cache.find(key);
         if (it != m_cache.end()) {
+            ++m_hits;
+            
             // 更新访问信息
             it->lastAccessed = QDateTime::currentDateTime();
             it->accessCount++;
@@ -44,6 +44,7 @@ namespace Constants {
     namespace Database {
         const QString DEFAULT_DB_NAME = QStringLiteral("musicplayer.db");
         const QString CONNECTION_NAME = QStringLiteral("main_connection");
+        const QString PLAY_HISTORY_JOURNAL_FILE = QStringLiteral("play_history.journal"); // 未写入的播放记录，与数据库同目录
         const int CURRENT_VERSION = 1;
         
         // 表名
@@ -80,6 +81,9 @@ namespace Constants {
         const int DEFAULT_MARGIN = 8;
         const int DEFAULT_SPACING = 6;
         const int LARGE_SPACING = 12;
+        
+        // 曲库视图快照
+        const int LIBRARY_SNAPSHOT_INTERVAL_MS = 5 * 60 * 1000; // 定期保存间隔（列表有变化时）
     }
     
     /**
@@ -137,6 +141,12 @@ namespace Constants {
         const int LAZY_LOAD_THRESHOLD = 50; // 延迟加载阈值
         const int BATCH_SIZE = 20; // 批处理大小
         const int CLEANUP_INTERVAL_MS = 300000; // 清理间隔（5分钟）
+        const int IO_BLOCK_SIZE = 512 * 1024; // 播放时每次从存储读取的块大小
+        const int IO_PROBE_BLOCK_SIZE = 256 * 1024; // 元数据扫描时的块大小
+        const int IO_READ_AHEAD_BLOCKS = 4; // 后台预读的块数量
+        const int AVIO_BUFFER_SIZE = 64 * 1024; // FFmpeg AVIOContext缓冲区大小
+        const int METRICS_SNAPSHOT_INTERVAL_MS = 10000; // 指标快照写入间隔
+        const char* const METRICS_SNAPSHOT_FILE = "metrics.json"; // 调试模式下默认的快照文件名
     }
     
     /**
@@ -164,6 +174,17 @@ namespace Constants {
         
         const int MAX_LOG_FILE_SIZE = 10 * 1024 * 1024; // 10MB
         const int MAX_LOG_FILES = 5;
+        
+        // 日志库：独立文件附加到主连接，按天分表
+        const QString LOG_DATABASE_FILE = QStringLiteral("logs.db");
+        const QString LOG_DATABASE_ALIAS = QStringLiteral("logdb");
+        const QString LOG_PARTITION_PREFIX = QStringLiteral("logs_");
+        
+        // 保留策略：按天数和总大小整表删除
+        const int LOG_RETENTION_DAYS = 14;
+        const int LOG_DATABASE_MAX_SIZE_MB = 64;
+        const int LOG_RETENTION_INTERVAL_MS = 60 * 60 * 1000;  // 每小时
+        const int LOG_RETENTION_STARTUP_DELAY_MS = 60 * 1000;  // 启动后延迟首次执行
     }
 }
 
@@ -0,0 +1,102 @@
+#ifndef LOGCATEGORYMASK_H
+#define LOGCATEGORYMASK_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <atomic>
+
+/**
+ * @brief 日志类别启用位图
+ * @details 全局登记表为每个类别名分配固定的位（最多63个，之后共用溢出位），
+ *          每个日志器持有一个原子位图，检查类别是否启用只需一次原子读取。
+ *          日志宏在调用点缓存类别对应的位，禁用时不会求值消息参数。
+ */
+class LogCategoryMask
+{
+public:
+    static const int MAX_CATEGORIES = 63;
+    static const int OVERFLOW_BIT = 63;
+    static const quint64 ALL_ENABLED = ~0ULL;
+
+    /**
+     * @brief 获取类别对应的位（首次出现时分配）
+     * @param category 类别名
+     * @return 位序号，类别过多时返回OVERFLOW_BIT
+     */
+    static int bitFor(const QString& category)
+    {
+        // 线程本地缓存，命中时不加锁
+        static thread_local QHash<QString, int> localBits;
+        const auto local = localBits.constFind(category);
+        if (local != localBits.constEnd()) {
+            return local.value();
+        }
+
+        Registry& registry = globalRegistry();
+        QMutexLocker locker(&registry.mutex);
+        int bit = registry.bits.value(category, -1);
+        if (bit < 0) {
+            bit = registry.bits.size() < MAX_CATEGORIES ? static_cast<int>(registry.bits.size()) : OVERFLOW_BIT;
+            if (bit != OVERFLOW_BIT) {
+                registry.bits.insert(category, bit);
+            }
+        }
+        locker.unlock();
+
+        localBits.insert(category, bit);
+        return bit;
+    }
+
+    /**
+     * @brief 设置允许的类别列表
+     * @param categories 允许的类别（空表示全部允许）
+     * @details 溢出位上的类别无法逐个区分，允许列表非空时溢出位保持开启，由日志器再做精确过滤。
+     */
+    void setAllowList(const QStringList& categories)
+    {
+        if (categories.isEmpty()) {
+            m_mask.store(ALL_ENABLED, std::memory_order_release);
+            return;
+        }
+
+        quint64 mask = 1ULL << OVERFLOW_BIT;
+        for (const QString& category : categories) {
+            mask |= 1ULL << bitFor(category);
+        }
+        m_mask.store(mask, std::memory_order_release);
+    }
+
+    bool isEnabled(int bit) const
+    {
+        return (m_mask.load(std::memory_order_relaxed) >> bit) & 1ULL;
+    }
+
+    bool isEnabled(const QString& category) const
+    {
+        return isEnabled(bitFor(category));
+    }
+
+    bool allEnabled() const
+    {
+        return m_mask.load(std::memory_order_relaxed) == ALL_ENABLED;
+    }
+
+private:
+    struct Registry {
+        QMutex mutex;
+        QHash<QString, int> bits;
+    };
+
+    static Registry& globalRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    std::atomic<quint64> m_mask{ALL_ENABLED};
+};
+
+#endif // LOGCATEGORYMASK_H
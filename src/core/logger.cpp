@@ -1,13 +1,16 @@
 #include "logger.h"
-#include "../database/logdao.h"
+#include "../database/databasemanager.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QStandardPaths>
 #include <QCoreApplication>
 #include <QMutexLocker>
+#include <QMetaMethod>
 #include <QDebug>
 #include <QUuid>
+#include <QSqlDatabase>
 #include <iostream>
+#include <string>
 
 // 静态成员变量定义
 Logger* Logger::m_instance = nullptr;
@@ -22,17 +25,18 @@ Logger::Logger(QObject* parent)
     , m_maxLogFileSize(10 * 1024 * 1024)  // 10MB
     , m_maxLogFiles(5)
     , m_logFile(nullptr)
-    , m_logStream(nullptr)
     , m_currentLogFileSize(0)
-    , m_logDao(nullptr)
-    , m_processTimer(nullptr)
+    , m_ringBuffer(RING_BUFFER_CAPACITY)
+    , m_droppedCount(0)
+    , m_reportedDroppedCount(0)
+    , m_writerThread(nullptr)
+    , m_writerStopping(false)
     , m_sessionId(QUuid::createUuid().toString())
     , m_colorSupported(true)
 {
-    // 初始化异步处理定时器
-    m_processTimer = new QTimer(this);
-    m_processTimer->setInterval(100);  // 100ms
-    connect(m_processTimer, &QTimer::timeout, this, &Logger::processLogQueue);
+    // ID 0 保留给空字符串
+    m_internedStrings.append(QString());
+    m_internIds.insert(QString(), 0);
 }
 
 Logger::~Logger()
@@ -89,19 +93,16 @@ bool Logger::initialize(const QString& logFilePath, qint64 maxLogFileSize, int m
         return false;
     }
     
-    m_logStream = new QTextStream(m_logFile);
-    // Qt6中QTextStream默认使用UTF-8编码，无需设置
     m_currentLogFileSize = m_logFile->size();
     
-    // 初始化数据库日志
-    initializeLogDao();
-    
-    // 启动异步处理
-    if (m_asyncMode) {
-        m_processTimer->start();
-    }
+    // 启动写线程（同步模式下也保持运行，切回异步模式时无需重新启动）
+    m_writerStopping = false;
+    m_writerThread = QThread::create([this]() { writerLoop(); });
+    m_writerThread->setObjectName("LoggerWriter");
+    m_writerThread->start(QThread::LowPriority);
     
     m_initialized = true;
+    locker.unlock();
     
     // 记录启动日志
     info("Logger initialized successfully", "Logger");
@@ -111,379 +112,521 @@ bool Logger::initialize(const QString& logFilePath, qint64 maxLogFileSize, int m
 
 void Logger::shutdown()
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!m_initialized) {
+    // 先停止接收新记录，再停止写线程（写线程需要m_mutex，不能持锁等待）
+    if (!m_initialized.exchange(false)) {
         return;
     }
     
-    // 停止异步处理
-    if (m_processTimer) {
-        m_processTimer->stop();
+    if (m_writerThread) {
+        m_writerStopping = true;
+        m_writerWake.wakeAll();
+        m_writerThread->wait();
+        delete m_writerThread;
+        m_writerThread = nullptr;
     }
     
-    // 处理剩余的日志消息
-    processLogQueue();
+    QMutexLocker locker(&m_mutex);
     
-    // 关闭文件流
-    if (m_logStream) {
-        m_logStream->flush();
-        delete m_logStream;
-        m_logStream = nullptr;
-    }
+    // 处理剩余的日志消息（写线程已退出，数据库条目不再写入）
+    QStringList messages;
+    drainRecords(&messages);
+    m_pendingDatabaseEntries.clear();
     
     if (m_logFile) {
         m_logFile->close();
         delete m_logFile;
         m_logFile = nullptr;
     }
-    
-    m_initialized = false;
+    locker.unlock();
+    emitLogMessages(messages);
     
     qDebug() << "Logger shutdown completed";
 }
 
+void Logger::setDatabasePath(const QString& dbPath)
+{
+    QMutexLocker locker(&m_mutex);
+    m_databasePath = dbPath;
+}
+
 void Logger::debug(const QString& message, const QString& category,
                    const QString& filePath, int lineNumber, const QString& functionName)
 {
-    if (!shouldLog(ErrorLog::LogLevel::Debug)) {
-        return;
-    }
-    
-    ErrorLog errorLog(ErrorLog::LogLevel::Debug, category, message, filePath, lineNumber, functionName);
-    errorLog.setSessionId(m_sessionId);
-    
-    logMessage(errorLog);
+    log(ErrorLog::LogLevel::Debug, message, category, filePath, lineNumber, functionName);
 }
 
 void Logger::info(const QString& message, const QString& category,
                   const QString& filePath, int lineNumber, const QString& functionName)
 {
-    if (!shouldLog(ErrorLog::LogLevel::Info)) {
-        return;
-    }
-    
-    ErrorLog errorLog(ErrorLog::LogLevel::Info, category, message, filePath, lineNumber, functionName);
-    errorLog.setSessionId(m_sessionId);
-    
-    logMessage(errorLog);
+    log(ErrorLog::LogLevel::Info, message, category, filePath, lineNumber, functionName);
 }
 
 void Logger::warning(const QString& message, const QString& category,
                      const QString& filePath, int lineNumber, const QString& functionName)
 {
-    if (!shouldLog(ErrorLog::LogLevel::Warning)) {
-        return;
-    }
-    
-    ErrorLog errorLog(ErrorLog::LogLevel::Warning, category, message, filePath, lineNumber, functionName);
-    errorLog.setSessionId(m_sessionId);
-    
-    logMessage(errorLog);
+    log(ErrorLog::LogLevel::Warning, message, category, filePath, lineNumber, functionName);
 }
 
 void Logger::error(const QString& message, const QString& category,
                    const QString& filePath, int lineNumber, const QString& functionName)
 {
-    if (!shouldLog(ErrorLog::LogLevel::Error)) {
-        return;
-    }
-    
-    ErrorLog errorLog(ErrorLog::LogLevel::Error, category, message, filePath, lineNumber, functionName);
-    errorLog.setSessionId(m_sessionId);
-    
-    logMessage(errorLog);
+    log(ErrorLog::LogLevel::Error, message, category, filePath, lineNumber, functionName);
 }
 
 void Logger::critical(const QString& message, const QString& category,
                       const QString& filePath, int lineNumber, const QString& functionName)
 {
-    if (!shouldLog(ErrorLog::LogLevel::Critical)) {
+    log(ErrorLog::LogLevel::Critical, message, category, filePath, lineNumber, functionName);
+}
+
+void Logger::log(ErrorLog::LogLevel level, const QString& message, const QString& category,
+                 const QString& filePath, int lineNumber, const QString& functionName)
+{
+    if (!shouldLog(level) || !m_categoryMask.isEnabled(category)) {
         return;
     }
     
-    ErrorLog errorLog(ErrorLog::LogLevel::Critical, category, message, filePath, lineNumber, functionName);
-    errorLog.setSessionId(m_sessionId);
-    
-    logMessage(errorLog);
+    pushRecord(level, [&](LogRecord& record) {
+        record.kind = LogRecord::ErrorKind;
+        record.categoryId = internString(category);
+        record.fileId = internString(filePath);
+        record.functionId = internString(functionName);
+        record.lineNumber = lineNumber;
+        encodeText(message, record);
+    });
 }
 
 void Logger::logSystem(SystemLog::LogLevel level, const QString& message,
                        const QString& category, const QString& component, const QString& operation)
 {
-    if (!shouldLog(level)) {
+    if (!shouldLog(level) || !m_categoryMask.isEnabled(category)) {
         return;
     }
     
-    SystemLog systemLog(level, category, message, component, operation);
-    systemLog.setSessionId(m_sessionId);
-    
-    logMessage(systemLog);
+    pushRecord(static_cast<ErrorLog::LogLevel>(level), [&](LogRecord& record) {
+        record.kind = LogRecord::SystemKind;
+        record.categoryId = internString(category);
+        record.componentId = internString(component);
+        record.operationId = internString(operation);
+        encodeText(message, record);
+    });
 }
 
 void Logger::logPerformance(const QString& operation, qint64 duration,
                            const QString& component, qint64 memoryUsage, double cpuUsage)
 {
-    SystemLog systemLog(SystemLog::LogLevel::Info, "Performance", 
-                       QString("Operation completed: %1").arg(operation), 
-                       component, operation);
-    systemLog.setSessionId(m_sessionId);
-    systemLog.setPerformanceMetrics(duration, memoryUsage, cpuUsage);
-    
-    logMessage(systemLog);
-}
-
-void Logger::logMessage(const ErrorLog& errorLog)
-{
-    if (!m_initialized) {
-        return;
-    }
-    
-    if (isCategoryFiltered(errorLog.category())) {
-        return;
-    }
-    
-    if (m_asyncMode) {
-        QMutexLocker locker(&m_mutex);
-        m_logQueue.enqueue(LogMessage(std::make_shared<ErrorLog>(errorLog)));
-    } else {
-        processErrorLog(errorLog);
-    }
+    // 性能日志与原实现一致，不受级别过滤
+    pushRecord(ErrorLog::LogLevel::Info, [&](LogRecord& record) {
+        record.kind = LogRecord::PerformanceKind;
+        record.categoryId = internString(QStringLiteral("Performance"));
+        record.componentId = internString(component);
+        record.operationId = internString(operation);
+        record.argCount = 3;
+        record.args[0] = makeLogArg(duration);
+        record.args[1] = makeLogArg(memoryUsage);
+        record.args[2] = makeLogArg(cpuUsage);
+    });
+}
+
+void Logger::logFormatArgs(ErrorLog::LogLevel level, const char* category, const char* format,
+                           const LogArg* args, int argCount)
+{
+    pushRecord(level, [&](LogRecord& record) {
+        record.kind = LogRecord::FormatKind;
+        // 字面量只记录指针，由写线程转换，生产者不驻留、不加锁
+        record.categoryLiteral = category;
+        record.formatLiteral = format;
+        record.argCount = static_cast<quint8>(qBound(0, argCount, MAX_FORMAT_ARGS));
+        for (int i = 0; i < record.argCount; ++i) {
+            record.args[i] = args[i];
+        }
+    });
 }
 
-void Logger::logMessage(const SystemLog& systemLog)
+void Logger::flush()
 {
-    if (!m_initialized) {
-        return;
-    }
-    
-    if (isCategoryFiltered(systemLog.category())) {
-        return;
-    }
-    
-    if (m_asyncMode) {
-        QMutexLocker locker(&m_mutex);
-        m_logQueue.enqueue(LogMessage(std::make_shared<SystemLog>(systemLog)));
-    } else {
-        processSystemLog(systemLog);
+    QMutexLocker locker(&m_mutex);
+    QStringList messages;
+    drainRecords(&messages);
+    if (!m_pendingDatabaseEntries.isEmpty()) {
+        // 数据库条目只能由写线程用自己的连接插入
+        m_writerWake.wakeOne();
     }
+    locker.unlock();
+    emitLogMessages(messages);
 }
 
-void Logger::processLogQueue()
+quint64 Logger::droppedMessageCount() const
 {
-    QMutexLocker locker(&m_mutex);
-    
-    while (!m_logQueue.isEmpty()) {
-        LogMessage logMessage = m_logQueue.dequeue();
-        
-        if (logMessage.type == LogMessage::ErrorLogType) {
-            processErrorLog(*logMessage.errorLog);
-        } else if (logMessage.type == LogMessage::SystemLogType) {
-            processSystemLog(*logMessage.systemLog);
-        }
-    }
+    return m_droppedCount.load(std::memory_order_relaxed);
 }
 
-void Logger::processErrorLog(const ErrorLog& errorLog)
+quint16 Logger::internString(const QString& value)
 {
-    QString formattedMessage = formatErrorLog(errorLog);
-    
-    // 输出到控制台
-    if (m_logTargets & LogTarget::Console) {
-        outputToConsole(formattedMessage, errorLog.level());
+    if (value.isEmpty()) {
+        return 0;
     }
     
-    // 输出到文件
-    if (m_logTargets & LogTarget::File) {
-        outputToFile(formattedMessage);
+    // 线程本地缓存，命中时不加锁；ID一经分配不再变化
+    static thread_local QHash<QString, quint16> localIds;
+    const auto local = localIds.constFind(value);
+    if (local != localIds.constEnd()) {
+        return local.value();
     }
     
-    // 输出到数据库
-    if (m_logTargets & LogTarget::Database) {
-        outputToDatabase(errorLog);
+    QMutexLocker locker(&m_internMutex);
+    quint16 id = m_internIds.value(value, 0);
+    if (id == 0) {
+        if (m_internedStrings.size() > MAX_INTERNED_STRINGS) {
+            return 0;  // 表已满，记录为空字符串
+        }
+        id = static_cast<quint16>(m_internedStrings.size());
+        m_internedStrings.append(value);
+        m_internIds.insert(value, id);
     }
+    locker.unlock();
     
-    emit logMessage(formattedMessage);
+    localIds.insert(value, id);
+    return id;
 }
 
-void Logger::processSystemLog(const SystemLog& systemLog)
+QString Logger::literalString(const char* literal)
 {
-    QString formattedMessage = formatSystemLog(systemLog);
-    
-    // 输出到控制台
-    if (m_logTargets & LogTarget::Console) {
-        // 将SystemLog级别转换为ErrorLog级别用于控制台输出
-        ErrorLog::LogLevel level = static_cast<ErrorLog::LogLevel>(static_cast<int>(systemLog.level()));
-        outputToConsole(formattedMessage, level);
-    }
-    
-    // 输出到文件
-    if (m_logTargets & LogTarget::File) {
-        outputToFile(formattedMessage);
+    if (!literal || !*literal) {
+        return QString();
     }
     
-    // 输出到数据库
-    if (m_logTargets & LogTarget::Database) {
-        outputToDatabase(systemLog);
+    // 字面量按地址缓存，避免每次构造QString
+    auto it = m_writerLiterals.constFind(literal);
+    if (it == m_writerLiterals.constEnd()) {
+        it = m_writerLiterals.insert(literal, QString::fromUtf8(literal));
     }
-    
-    emit logMessage(formattedMessage);
-}
-
-bool Logger::shouldLog(ErrorLog::LogLevel level) const
-{
-    return static_cast<int>(level) >= static_cast<int>(m_logLevel);
+    return it.value();
 }
 
-bool Logger::shouldLog(SystemLog::LogLevel level) const
+QString Logger::recordCategory(const LogRecord& record)
 {
-    return static_cast<int>(level) >= static_cast<int>(m_logLevel);
+    return record.kind == LogRecord::FormatKind ? literalString(record.categoryLiteral)
+                                                : internedString(record.categoryId);
 }
 
-void Logger::initializeLogDao()
+QString Logger::internedString(quint16 id)
 {
-    if (!m_logDao) {
-        m_logDao = new LogDao(this);
-        connect(m_logDao, &LogDao::databaseError, this, &Logger::onDatabaseError);
+    // 写线程使用本地副本，只有遇到新ID时才加锁同步
+    if (id >= m_writerStrings.size()) {
+        QMutexLocker locker(&m_internMutex);
+        m_writerStrings = m_internedStrings;
     }
+    return id < m_writerStrings.size() ? m_writerStrings.at(id) : QString();
 }
 
-void Logger::onDatabaseError(const QString& error)
+void Logger::encodeText(const QString& message, LogRecord& record)
 {
-    // 避免无限递归，直接输出到控制台
-    qCritical() << "Database log error:" << error;
-    emit errorOccurred(error);
-}
-
-// 输出方法实现
-
-void Logger::outputToConsole(const QString& message, ErrorLog::LogLevel level)
-{
-    if (m_colorSupported) {
-        QString colorCode = getLogLevelColor(level);
-        QString resetCode = "\033[0m";
-        std::cout << colorCode.toStdString() << message.toStdString() << resetCode.toStdString() << std::endl;
-    } else {
-        std::cout << message.toStdString() << std::endl;
+    // 手工编码UTF-8，不产生临时QByteArray；截断时不拆分多字节字符
+    int length = 0;
+    const int size = message.size();
+    for (int i = 0; i < size; ++i) {
+        uint codePoint = message.at(i).unicode();
+        if (QChar::isHighSurrogate(codePoint) && i + 1 < size && message.at(i + 1).isLowSurrogate()) {
+            codePoint = QChar::surrogateToUcs4(static_cast<char16_t>(codePoint), message.at(i + 1).unicode());
+            ++i;
+        }
+        
+        char bytes[4];
+        int count = 0;
+        if (codePoint < 0x80) {
+            bytes[count++] = static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            bytes[count++] = static_cast<char>(0xC0 | (codePoint >> 6));
+            bytes[count++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            bytes[count++] = static_cast<char>(0xE0 | (codePoint >> 12));
+            bytes[count++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            bytes[count++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            bytes[count++] = static_cast<char>(0xF0 | (codePoint >> 18));
+            bytes[count++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            bytes[count++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            bytes[count++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        
+        if (length + count > LogRecord::TEXT_CAPACITY) {
+            record.truncated = true;
+            break;
+        }
+        for (int j = 0; j < count; ++j) {
+            record.text[length++] = bytes[j];
+        }
     }
+    record.textLength = static_cast<quint16>(length);
 }
 
-void Logger::outputToFile(const QString& message)
+void Logger::writerLoop()
 {
-    if (!m_logStream) {
-        return;
+    const QString connectionName = QString("LoggerWriter_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+    {
+        std::unique_ptr<LogDao> logDao;
+        bool connectionFailed = false;
+        bool stopping = false;
+        
+        while (!stopping) {
+            {
+                QMutexLocker locker(&m_writerWakeMutex);
+                if (m_ringBuffer.approximateSize() == 0 && !m_writerStopping.load()) {
+                    m_writerWake.wait(&m_writerWakeMutex, WRITER_INTERVAL_MS);
+                }
+            }
+            // 收到停止请求后再处理一轮，剩余的记录也写入数据库
+            stopping = m_writerStopping.load();
+            
+            QList<LogEntry> databaseEntries;
+            QString databasePath;
+            QStringList messages;
+            {
+                QMutexLocker locker(&m_mutex);
+                drainRecords(&messages);
+                databaseEntries.swap(m_pendingDatabaseEntries);
+                databasePath = m_databasePath;
+            }
+            emitLogMessages(messages);
+            
+            if (!databaseEntries.isEmpty()) {
+                writeDatabaseEntries(databaseEntries, databasePath, connectionName, logDao, connectionFailed);
+            }
+        }
+        
+        logDao.reset();
+        if (QSqlDatabase::contains(connectionName)) {
+            QSqlDatabase::database(connectionName, false).close();
+        }
     }
-    
-    *m_logStream << message << Qt::endl;
-    m_logStream->flush();
-    
-    m_currentLogFileSize += message.toUtf8().size() + 1;  // +1 for newline
-    
-    // 检查文件大小并轮换
-    if (m_currentLogFileSize > m_maxLogFileSize) {
-        checkAndRotateLogFile();
+    if (QSqlDatabase::contains(connectionName)) {
+        QSqlDatabase::removeDatabase(connectionName);
     }
 }
 
-void Logger::outputToDatabase(const ErrorLog& errorLog)
+void Logger::writeDatabaseEntries(const QList<LogEntry>& entries, const QString& databasePath,
+                                  const QString& connectionName, std::unique_ptr<LogDao>& logDao,
+                                  bool& connectionFailed)
 {
-    if (!m_logDao) {
-        return;
+    if (!logDao && !connectionFailed) {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databasePath);
+        // 与主连接的写入冲突时等待，而不是立即失败
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        
+        if (db.open() && DatabaseManager::attachLogDatabaseTo(db, databasePath)) {
+            logDao = std::make_unique<LogDao>(db);
+            connect(logDao.get(), &LogDao::databaseError, this, &Logger::onDatabaseError);
+        } else {
+            qCritical() << "Logger: 写线程无法打开日志库:" << db.lastError().text() << "，日志只写入控制台和文件";
+            connectionFailed = true;
+        }
     }
     
-    // 异步插入数据库
-    QMetaObject::invokeMethod(m_logDao, [this, errorLog]() {
-        m_logDao->insertErrorLog(errorLog);
-    }, Qt::QueuedConnection);
+    // 一个事务插入整批日志
+    if (logDao) {
+        logDao->addLogs(entries);
+    }
 }
 
-void Logger::outputToDatabase(const SystemLog& systemLog)
+void Logger::drainRecords(QStringList* messages)
 {
-    if (!m_logDao) {
-        return;
+    QString fileBuffer;
+    std::string consoleBuffer;
+    
+    // 没有接收者时不收集消息
+    static const QMetaMethod batchSignal = QMetaMethod::fromSignal(&Logger::logMessages);
+    static const QMetaMethod messageSignal = QMetaMethod::fromSignal(&Logger::logMessage);
+    if (messages && !isSignalConnected(batchSignal) && !isSignalConnected(messageSignal)) {
+        messages = nullptr;
     }
     
-    // 异步插入数据库
-    QMetaObject::invokeMethod(m_logDao, [this, systemLog]() {
-        m_logDao->insertSystemLog(systemLog);
-    }, Qt::QueuedConnection);
-}
-
-// 格式化方法实现
-
-QString Logger::formatErrorLog(const ErrorLog& errorLog) const
-{
-    QString timestamp = QDateTime::fromMSecsSinceEpoch(errorLog.timestamp()).toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString level = errorLog.levelString();
-    QString category = errorLog.category();
-    QString message = errorLog.message();
-    QString threadId = errorLog.threadId();
+    const bool toConsole = m_logTargets & LogTarget::Console;
+    const bool toFile = (m_logTargets & LogTarget::File) && m_logFile;
+    const bool toDatabase = (m_logTargets & LogTarget::Database) && !m_databasePath.isEmpty();
     
-    QString formattedMessage = QString("[%1] [%2] [%3] %4")
-        .arg(timestamp)
-        .arg(level)
-        .arg(category)
-        .arg(message);
+    auto handleRecord = [&](const LogRecord& record) {
+        const QString category = recordCategory(record);
+        if (!m_categoryFilters.isEmpty() && !m_categoryFilters.contains(category)) {
+            return;
+        }
+        
+        const QString formattedMessage = formatRecord(record);
+        const ErrorLog::LogLevel level = static_cast<ErrorLog::LogLevel>(record.level);
+        
+        if (toConsole) {
+            if (m_colorSupported) {
+                consoleBuffer += getLogLevelColor(level).toStdString();
+                consoleBuffer += formattedMessage.toStdString();
+                consoleBuffer += "\033[0m\n";
+            } else {
+                consoleBuffer += formattedMessage.toStdString();
+                consoleBuffer += '\n';
+            }
+        }
+        
+        if (toFile) {
+            fileBuffer += formattedMessage;
+            fileBuffer += QLatin1Char('\n');
+        }
+        
+        if (toDatabase) {
+            LogEntry entry(ErrorLog::levelToString(level),
+                           QString::fromUtf8(record.text, record.textLength), category);
+            entry.timestamp = QDateTime::fromMSecsSinceEpoch(record.timestamp);
+            if (record.kind == LogRecord::FormatKind || record.kind == LogRecord::PerformanceKind) {
+                entry.message = formattedMessage;
+            }
+            m_pendingDatabaseEntries.append(entry);
+        }
+        
+        if (messages) {
+            messages->append(formattedMessage);
+        }
+    };
     
-    if (!errorLog.filePath().isEmpty()) {
-        QString fileName = QFileInfo(errorLog.filePath()).fileName();
-        formattedMessage += QString(" (%1:%2)").arg(fileName).arg(errorLog.lineNumber());
+    while (m_ringBuffer.consume(handleRecord, MAX_BATCH_RECORDS) > 0) {
     }
     
-    if (!errorLog.functionName().isEmpty()) {
-        formattedMessage += QString(" in %1").arg(errorLog.functionName());
+    // 报告新增的丢弃数量
+    const quint64 dropped = m_droppedCount.load(std::memory_order_relaxed);
+    if (dropped > m_reportedDroppedCount) {
+        const QString warning = QString("[%1] [WARNING] [Logger] 日志缓冲区已满，丢弃了 %2 条日志")
+            .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"))
+            .arg(dropped - m_reportedDroppedCount);
+        m_reportedDroppedCount = dropped;
+        if (toConsole) {
+            consoleBuffer += warning.toStdString();
+            consoleBuffer += '\n';
+        }
+        if (toFile) {
+            fileBuffer += warning;
+            fileBuffer += QLatin1Char('\n');
+        }
     }
     
-    if (!threadId.isEmpty()) {
-        formattedMessage += QString(" [Thread: %1]").arg(threadId);
+    // 整批写入
+    if (!consoleBuffer.empty()) {
+        std::cout.write(consoleBuffer.data(), static_cast<std::streamsize>(consoleBuffer.size()));
+        std::cout.flush();
     }
     
-    return formattedMessage;
+    if (!fileBuffer.isEmpty() && m_logFile) {
+        const QByteArray data = fileBuffer.toUtf8();
+        m_logFile->write(data);
+        m_logFile->flush();
+        m_currentLogFileSize += data.size();
+        
+        // 检查文件大小并轮换
+        if (m_currentLogFileSize > m_maxLogFileSize) {
+            checkAndRotateLogFile();
+        }
+    }
 }
 
-QString Logger::formatSystemLog(const SystemLog& systemLog) const
+void Logger::emitLogMessages(const QStringList& messages)
 {
-    QString timestamp = QDateTime::fromMSecsSinceEpoch(systemLog.timestamp()).toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString level = systemLog.levelString();
-    QString category = systemLog.category();
-    QString message = systemLog.message();
-    QString component = systemLog.component();
-    QString operation = systemLog.operation();
-    QString threadId = systemLog.threadId();
+    if (messages.isEmpty()) {
+        return;
+    }
+    emit logMessages(messages);
+    for (const QString& message : messages) {
+        emit logMessage(message);
+    }
+}
+
+QString Logger::formatRecord(const LogRecord& record)
+{
+    QString message;
+    if (record.kind == LogRecord::FormatKind) {
+        message = literalString(record.formatLiteral);
+        for (int i = 0; i < record.argCount; ++i) {
+            const LogArg& arg = record.args[i];
+            switch (arg.type) {
+            case LogArg::Int:
+                message = message.arg(arg.i);
+                break;
+            case LogArg::UInt:
+                message = message.arg(arg.u);
+                break;
+            case LogArg::Double:
+                message = message.arg(arg.d);
+                break;
+            case LogArg::Bool:
+                message = message.arg(arg.i ? QLatin1String("true") : QLatin1String("false"));
+                break;
+            }
+        }
+    } else if (record.kind == LogRecord::PerformanceKind) {
+        message = QString("Operation completed: %1").arg(internedString(record.operationId));
+    } else {
+        message = QString::fromUtf8(record.text, record.textLength);
+        if (record.truncated) {
+            message += "...";
+        }
+    }
+    
+    const QString timestamp = QDateTime::fromMSecsSinceEpoch(record.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz");
+    const QString level = ErrorLog::levelToString(static_cast<ErrorLog::LogLevel>(record.level));
     
     QString formattedMessage = QString("[%1] [%2] [%3] %4")
         .arg(timestamp)
         .arg(level)
-        .arg(category)
+        .arg(recordCategory(record))
         .arg(message);
     
-    if (!component.isEmpty()) {
-        formattedMessage += QString(" [Component: %1]").arg(component);
+    if (record.fileId != 0) {
+        QString fileName = QFileInfo(internedString(record.fileId)).fileName();
+        formattedMessage += QString(" (%1:%2)").arg(fileName).arg(record.lineNumber);
     }
     
-    if (!operation.isEmpty()) {
-        formattedMessage += QString(" [Operation: %1]").arg(operation);
+    if (record.functionId != 0) {
+        formattedMessage += QString(" in %1").arg(internedString(record.functionId));
     }
     
-    if (systemLog.duration() > 0) {
-        formattedMessage += QString(" [Duration: %1ms]").arg(systemLog.duration());
+    if (record.componentId != 0) {
+        formattedMessage += QString(" [Component: %1]").arg(internedString(record.componentId));
     }
     
-    if (systemLog.memoryUsage() > 0) {
-        formattedMessage += QString(" [Memory: %1KB]").arg(systemLog.memoryUsage() / 1024);
+    if (record.operationId != 0) {
+        formattedMessage += QString(" [Operation: %1]").arg(internedString(record.operationId));
     }
     
-    if (systemLog.cpuUsage() > 0) {
-        formattedMessage += QString(" [CPU: %1%]").arg(systemLog.cpuUsage(), 0, 'f', 2);
+    if (record.kind == LogRecord::PerformanceKind) {
+        if (record.args[0].i > 0) {
+            formattedMessage += QString(" [Duration: %1ms]").arg(record.args[0].i);
+        }
+        if (record.args[1].i > 0) {
+            formattedMessage += QString(" [Memory: %1KB]").arg(record.args[1].i / 1024);
+        }
+        if (record.args[2].d > 0) {
+            formattedMessage += QString(" [CPU: %1%]").arg(record.args[2].d, 0, 'f', 2);
+        }
     }
     
-    if (!threadId.isEmpty()) {
-        formattedMessage += QString(" [Thread: %1]").arg(threadId);
-    }
+    formattedMessage += QString(" [Thread: %1]").arg(record.threadId, 0, 16);
     
     return formattedMessage;
 }
 
+bool Logger::shouldLog(ErrorLog::LogLevel level) const
+{
+    return static_cast<int>(level) >= static_cast<int>(m_logLevel.load(std::memory_order_relaxed));
+}
+
+bool Logger::shouldLog(SystemLog::LogLevel level) const
+{
+    return static_cast<int>(level) >= static_cast<int>(m_logLevel.load(std::memory_order_relaxed));
+}
+
+void Logger::onDatabaseError(const QString& error)
+{
+    // 避免无限递归，直接输出到控制台
+    qCritical() << "Database log error:" << error;
+    emit errorOccurred(error);
+}
+
 QString Logger::getLogLevelColor(ErrorLog::LogLevel level) const
 {
     switch (level) {
@@ -506,7 +649,6 @@ QString Logger::getLogLevelColor(ErrorLog::LogLevel level) const
 
 void Logger::setLogLevel(ErrorLog::LogLevel level)
 {
-    QMutexLocker locker(&m_mutex);
     m_logLevel = level;
 }
 
@@ -563,19 +705,18 @@ void Logger::setAsyncMode(bool enabled)
     QMutexLocker locker(&m_mutex);
     m_asyncMode = enabled;
     
-    if (enabled && m_initialized) {
-        m_processTimer->start();
-    } else if (!enabled && m_processTimer) {
-        m_processTimer->stop();
-        processLogQueue();  // 处理剩余消息
+    QStringList messages;
+    if (!enabled) {
+        drainRecords(&messages);  // 处理剩余消息
     }
+    locker.unlock();
+    emitLogMessages(messages);
 }
 
 // 查询方法实现
 
 ErrorLog::LogLevel Logger::logLevel() const
 {
-    QMutexLocker locker(&m_mutex);
     return m_logLevel;
 }
 
@@ -617,7 +758,6 @@ bool Logger::isFileOutputEnabled() const
 
 bool Logger::isAsyncMode() const
 {
-    QMutexLocker locker(&m_mutex);
     return m_asyncMode;
 }
 
@@ -653,15 +793,11 @@ qint64 Logger::currentLogFileSize() const
 
 void Logger::checkAndRotateLogFile()
 {
-    if (!m_logFile || !m_logStream) {
+    if (!m_logFile) {
         return;
     }
     
     // 关闭当前文件
-    m_logStream->flush();
-    delete m_logStream;
-    m_logStream = nullptr;
-    
     m_logFile->close();
     
     // 生成新的文件名
@@ -674,8 +810,6 @@ void Logger::checkAndRotateLogFile()
     
     // 打开新文件
     if (m_logFile->open(QIODevice::WriteOnly | QIODevice::Append)) {
-        m_logStream = new QTextStream(m_logFile);
-        // Qt6中QTextStream默认使用UTF-8编码，无需设置
         m_currentLogFileSize = 0;
     }
     
@@ -722,22 +856,34 @@ void Logger::addCategoryFilter(const QString& category)
     if (!m_categoryFilters.contains(category)) {
         m_categoryFilters.append(category);
     }
+    m_categoryMask.setAllowList(m_categoryFilters);
 }
 
 void Logger::removeCategoryFilter(const QString& category)
 {
     QMutexLocker locker(&m_mutex);
     m_categoryFilters.removeAll(category);
+    m_categoryMask.setAllowList(m_categoryFilters);
 }
 
 void Logger::clearCategoryFilters()
 {
     QMutexLocker locker(&m_mutex);
     m_categoryFilters.clear();
+    m_categoryMask.setAllowList(m_categoryFilters);
 }
 
 bool Logger::isCategoryFiltered(const QString& category) const
 {
+    // 先查原子位图，只有落在溢出位上的类别才需要加锁精确比较
+    const int bit = LogCategoryMask::bitFor(category);
+    if (!m_categoryMask.isEnabled(bit)) {
+        return true;
+    }
+    if (bit != LogCategoryMask::OVERFLOW_BIT || m_categoryMask.allEnabled()) {
+        return false;
+    }
+    
     QMutexLocker locker(&m_mutex);
     return !m_categoryFilters.isEmpty() && !m_categoryFilters.contains(category);
 }
@@ -2,17 +2,22 @@
 
 #include <QObject>
 #include <QMutex>
-#include <QTextStream>
 #include <QFile>
 #include <QDateTime>
-#include <QQueue>
-#include <QTimer>
 #include <QThread>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
 #include <memory>
+#include <type_traits>
+#include "mpscringbuffer.h"
+#include "logcategorymask.h"
+#include "logmacros.h"
 #include "../models/errorlog.h"
 #include "../models/systemlog.h"
-
-class LogDao;
+#include "../database/logdao.h"
 
 /**
  * @brief 日志管理器类
@@ -23,6 +28,11 @@ class LogDao;
  * 3. 日志文件输出
  * 4. 日志格式化
  * 5. 日志级别过滤
+ *
+ * 记录日志时只把定长二进制记录（时间戳、级别、字符串ID、参数、截断的消息文本）
+ * 写入无锁环形缓冲区；格式化、文件写入和数据库插入由专用写线程批量完成，
+ * 数据库插入使用写线程自己的连接。缓冲区满时丢弃并计数，生产者永不阻塞。
+ * 音频线程等实时路径只应使用logFormat()：类别和格式串按字面量指针记录，不加锁、不分配内存。
  */
 class Logger : public QObject
 {
@@ -62,6 +72,13 @@ public:
      */
     void shutdown();
 
+    /**
+     * @brief 设置数据库路径，之后写线程用自己的连接把日志写入日志库
+     * @param dbPath 主库文件路径（日志库已由DatabaseManager创建）
+     * @details 设置之前的日志只写入控制台和文件
+     */
+    void setDatabasePath(const QString& dbPath);
+
     // 错误日志记录方法
     void debug(const QString& message, const QString& category = "General",
                const QString& filePath = QString(), int lineNumber = 0,
@@ -83,6 +100,26 @@ public:
                   const QString& filePath = QString(), int lineNumber = 0,
                   const QString& functionName = QString());
 
+    /**
+     * @brief 按级别记录文本日志（debug/info/warning/error/critical的公共实现）
+     * @details 字符串参数首次出现时需要加锁驻留，实时路径请使用logFormat()
+     */
+    void log(ErrorLog::LogLevel level, const QString& message, const QString& category = "General",
+             const QString& filePath = QString(), int lineNumber = 0,
+             const QString& functionName = QString());
+
+    /**
+     * @brief 快速判断某级别、某类别的日志是否会被记录（只读原子变量，供日志宏在求值参数前调用）
+     * @param level 日志级别
+     * @param categoryBit LogCategoryMask::bitFor()返回的类别位
+     */
+    bool isEnabled(ErrorLog::LogLevel level, int categoryBit) const
+    {
+        return m_initialized.load(std::memory_order_relaxed)
+            && static_cast<int>(level) >= static_cast<int>(m_logLevel.load(std::memory_order_relaxed))
+            && m_categoryMask.isEnabled(categoryBit);
+    }
+
     // 系统日志记录方法
     void logSystem(SystemLog::LogLevel level, const QString& message,
                    const QString& category = "System",
@@ -94,6 +131,53 @@ public:
                        const QString& component = QString(),
                        qint64 memoryUsage = 0, double cpuUsage = 0.0);
 
+    /**
+     * @brief 日志参数（格式化推迟到写线程）
+     */
+    struct LogArg {
+        enum Type : quint8 { Int, UInt, Double, Bool };
+        Type type;
+        union {
+            qint64 i;
+            quint64 u;
+            double d;
+        };
+    };
+    static const int MAX_FORMAT_ARGS = 4;
+
+    /**
+     * @brief 以静态格式串记录日志，参数只保存原始数值，由写线程格式化
+     * @param level 日志级别
+     * @param category 日志分类（字符串字面量）
+     * @param format 格式串（字符串字面量，使用%1~%4占位）
+     * @param args 数值参数，最多MAX_FORMAT_ARGS个
+     * @details 热路径（解码循环、音频回调）应使用此方法，调用方不做任何字符串格式化；
+     *          类别和格式串只记录指针，由写线程转换，生产者不加锁、不分配内存。
+     */
+    template<typename... Args>
+    void logFormat(ErrorLog::LogLevel level, const char* category, const char* format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= MAX_FORMAT_ARGS, "logFormat最多支持4个参数");
+        if (!shouldLog(level)) {
+            return;
+        }
+        const LogArg packed[sizeof...(Args) + 1] = { makeLogArg(args)..., makeLogArg(0) };
+        logFormatArgs(level, category, format, packed, static_cast<int>(sizeof...(Args)));
+    }
+
+    void logFormatArgs(ErrorLog::LogLevel level, const char* category, const char* format,
+                       const LogArg* args, int argCount);
+
+    /**
+     * @brief 立即处理缓冲区中的全部日志（调用线程执行写入）
+     */
+    void flush();
+
+    /**
+     * @brief 因缓冲区满而丢弃的日志数量
+     */
+    quint64 droppedMessageCount() const;
+
     // 配置方法
     void setLogLevel(ErrorLog::LogLevel level);
     void setLogTargets(LogTargets targets);
@@ -127,12 +211,15 @@ public:
     bool isCategoryFiltered(const QString& category) const;
 
 signals:
-    void logMessage(const QString& message);
+    /**
+     * @brief 一批日志写出后发出（不持有Logger的锁，接收者可以再记录日志）
+     */
+    void logMessages(const QStringList& messages);
+    void logMessage(const QString& message);    // 逐条发出，在logMessages之后
     void errorOccurred(const QString& error);
     void logFileRotated(const QString& newFilePath);
 
 private slots:
-    void processLogQueue();
     void onDatabaseError(const QString& error);
 
 private:
@@ -147,54 +234,112 @@ private:
     ~Logger() override;
 
     /**
-     * @brief 日志消息结构
+     * @brief 环形缓冲区中的定长日志记录
+     * @details 字符串字段保存为驻留字符串ID，消息文本按UTF-8截断存放在记录内部；
+     *          FormatKind的类别和格式串保存为字符串字面量指针。
      */
-    struct LogMessage {
-        enum Type { ErrorLogType, SystemLogType };
-        Type type;
-        std::shared_ptr<ErrorLog> errorLog;
-        std::shared_ptr<SystemLog> systemLog;
-        
-        LogMessage(std::shared_ptr<ErrorLog> log) : type(ErrorLogType), errorLog(log) {}
-        LogMessage(std::shared_ptr<SystemLog> log) : type(SystemLogType), systemLog(log) {}
+    struct LogRecord {
+        enum Kind : quint8 { ErrorKind, SystemKind, PerformanceKind, FormatKind };
+        static const int TEXT_CAPACITY = 400;
+
+        qint64 timestamp;
+        quint64 threadId;
+        qint32 lineNumber;
+        Kind kind;
+        quint8 level;
+        quint8 argCount;
+        bool truncated;
+        quint16 categoryId;
+        quint16 fileId;
+        quint16 functionId;
+        quint16 componentId;
+        quint16 operationId;
+        quint16 textLength;
+        const char* categoryLiteral;
+        const char* formatLiteral;
+        LogArg args[MAX_FORMAT_ARGS];
+        char text[TEXT_CAPACITY];
     };
 
+    static LogArg makeLogArg(bool value) { LogArg arg; arg.type = LogArg::Bool; arg.i = value; return arg; }
+    static LogArg makeLogArg(double value) { LogArg arg; arg.type = LogArg::Double; arg.d = value; return arg; }
+    static LogArg makeLogArg(float value) { return makeLogArg(static_cast<double>(value)); }
+    template<typename T>
+    static LogArg makeLogArg(T value)
+    {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "logFormat参数必须是数值类型");
+        LogArg arg;
+        if (std::is_unsigned<T>::value) {
+            arg.type = LogArg::UInt;
+            arg.u = static_cast<quint64>(value);
+        } else {
+            arg.type = LogArg::Int;
+            arg.i = static_cast<qint64>(value);
+        }
+        return arg;
+    }
+
     /**
-     * @brief 记录日志消息
-     * @param errorLog 错误日志对象
+     * @brief 写入一条记录（无锁，缓冲区满时丢弃）
+     * @param fill 填充记录的函数
      */
-    void logMessage(const ErrorLog& errorLog);
+    template<typename Fill>
+    void pushRecord(ErrorLog::LogLevel level, Fill&& fill);
 
     /**
-     * @brief 记录系统日志消息
-     * @param systemLog 系统日志对象
+     * @brief 驻留字符串，返回稳定的ID（每个线程缓存已驻留的字符串，命中时不加锁）
      */
-    void logMessage(const SystemLog& systemLog);
+    quint16 internString(const QString& value);
+    QString internedString(quint16 id);
 
     /**
-     * @brief 输出到控制台
-     * @param message 格式化的消息
-     * @param level 日志级别
+     * @brief 写线程把字符串字面量转换为QString（按地址缓存，调用方持有m_mutex）
      */
-    void outputToConsole(const QString& message, ErrorLog::LogLevel level);
+    QString literalString(const char* literal);
 
     /**
-     * @brief 输出到文件
-     * @param message 格式化的消息
+     * @brief 记录的类别（调用方持有m_mutex）
      */
-    void outputToFile(const QString& message);
+    QString recordCategory(const LogRecord& record);
 
     /**
-     * @brief 输出到数据库
-     * @param errorLog 错误日志对象
+     * @brief 将消息按UTF-8编码写入记录，超长时截断
      */
-    void outputToDatabase(const ErrorLog& errorLog);
+    static void encodeText(const QString& message, LogRecord& record);
 
     /**
-     * @brief 输出到数据库
-     * @param systemLog 系统日志对象
+     * @brief 写线程主循环
      */
-    void outputToDatabase(const SystemLog& systemLog);
+    void writerLoop();
+
+    /**
+     * @brief 取出缓冲区中的记录，批量写入控制台和文件（调用方持有m_mutex）
+     * @details 数据库条目放入m_pendingDatabaseEntries，由写线程用自己的连接插入
+     * @param messages 有信号接收者时收集格式化后的消息，由调用方释放锁后通过emitLogMessages()发出
+     */
+    void drainRecords(QStringList* messages = nullptr);
+
+    /**
+     * @brief 发出logMessages和logMessage，调用方不能持有m_mutex
+     */
+    void emitLogMessages(const QStringList& messages);
+
+    /**
+     * @brief 在写线程中把一批条目插入日志库，首次调用时打开写线程的连接
+     * @param entries 日志条目
+     * @param databasePath 主库文件路径
+     * @param connectionName 写线程的连接名
+     * @param logDao 写线程持有的LogDao，连接打开后创建
+     * @param connectionFailed 连接打开失败后不再重试
+     */
+    void writeDatabaseEntries(const QList<LogEntry>& entries, const QString& databasePath,
+                              const QString& connectionName, std::unique_ptr<LogDao>& logDao,
+                              bool& connectionFailed);
+
+    /**
+     * @brief 格式化一条记录
+     */
+    QString formatRecord(const LogRecord& record);
 
     /**
      * @brief 检查日志级别
@@ -210,20 +355,6 @@ private:
      */
     bool shouldLog(SystemLog::LogLevel level) const;
 
-    /**
-     * @brief 格式化错误日志消息
-     * @param errorLog 错误日志对象
-     * @return 格式化的消息
-     */
-    QString formatErrorLog(const ErrorLog& errorLog) const;
-
-    /**
-     * @brief 格式化系统日志消息
-     * @param systemLog 系统日志对象
-     * @return 格式化的消息
-     */
-    QString formatSystemLog(const SystemLog& systemLog) const;
-
     /**
      * @brief 获取日志级别的颜色代码（用于控制台输出）
      * @param level 日志级别
@@ -247,33 +378,25 @@ private:
      */
     QString generateLogFileName() const;
 
-    /**
-     * @brief 初始化日志DAO
-     */
-    void initializeLogDao();
-
-    /**
-     * @brief 处理错误日志消息
-     * @param errorLog 错误日志对象
-     */
-    void processErrorLog(const ErrorLog& errorLog);
-
-    /**
-     * @brief 处理系统日志消息
-     * @param systemLog 系统日志对象
-     */
-    void processSystemLog(const SystemLog& systemLog);
-
 private:
     static Logger* m_instance;
     static QMutex m_instanceMutex;
 
+    // 环形缓冲区容量（记录数），每条记录约0.5KB
+    static const int RING_BUFFER_CAPACITY = 8192;
+    // 写线程空闲时的最长等待间隔
+    static const int WRITER_INTERVAL_MS = 100;
+    // 单批最多处理的记录数
+    static const int MAX_BATCH_RECORDS = 1024;
+    static const int MAX_INTERNED_STRINGS = 65535;
+
+    // 配置和输出状态，由写线程持有处理；生产者不使用此锁
     mutable QMutex m_mutex;
-    bool m_initialized;
-    bool m_asyncMode;
+    std::atomic<bool> m_initialized;
+    std::atomic<bool> m_asyncMode;
 
     // 日志配置
-    ErrorLog::LogLevel m_logLevel;
+    std::atomic<ErrorLog::LogLevel> m_logLevel;
     LogTargets m_logTargets;
     qint64 m_maxLogFileSize;
     int m_maxLogFiles;
@@ -281,18 +404,31 @@ private:
     // 文件输出
     QString m_logFilePath;
     QFile* m_logFile;
-    QTextStream* m_logStream;
     qint64 m_currentLogFileSize;
 
-    // 数据库输出
-    LogDao* m_logDao;
-
-    // 异步处理
-    QQueue<LogMessage> m_logQueue;
-    QTimer* m_processTimer;
-
-    // 过滤器
+    // 数据库输出：路径设置后由写线程用自己的连接插入
+    QString m_databasePath;
+    QList<LogEntry> m_pendingDatabaseEntries;
+
+    // 无锁记录缓冲区和写线程
+    MpscRingBuffer<LogRecord> m_ringBuffer;
+    std::atomic<quint64> m_droppedCount;
+    quint64 m_reportedDroppedCount;
+    QThread* m_writerThread;
+    QMutex m_writerWakeMutex;
+    QWaitCondition m_writerWake;
+    std::atomic<bool> m_writerStopping;
+
+    // 驻留字符串表，ID 0 表示空字符串
+    QMutex m_internMutex;
+    QHash<QString, quint16> m_internIds;
+    QVector<QString> m_internedStrings;
+    QVector<QString> m_writerStrings;  // 写线程持有的副本
+    QHash<const void*, QString> m_writerLiterals;  // 写线程按地址缓存的字面量
+
+    // 过滤器（允许列表），m_categoryMask为其原子位图缓存
     QStringList m_categoryFilters;
+    LogCategoryMask m_categoryMask;
 
     // 会话ID（用于跟踪日志）
     QString m_sessionId;
@@ -301,6 +437,45 @@ private:
     bool m_colorSupported;
 };
 
+template<typename Fill>
+void Logger::pushRecord(ErrorLog::LogLevel level, Fill&& fill)
+{
+    if (!m_initialized.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    const bool pushed = m_ringBuffer.tryEmplace([&](LogRecord& record) {
+        record.timestamp = QDateTime::currentMSecsSinceEpoch();
+        record.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+        record.level = static_cast<quint8>(level);
+        record.lineNumber = 0;
+        record.argCount = 0;
+        record.truncated = false;
+        record.categoryId = 0;
+        record.fileId = 0;
+        record.functionId = 0;
+        record.componentId = 0;
+        record.operationId = 0;
+        record.textLength = 0;
+        record.categoryLiteral = nullptr;
+        record.formatLiteral = nullptr;
+        fill(record);
+    });
+
+    if (!pushed) {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!m_asyncMode.load(std::memory_order_relaxed)) {
+        flush();
+    } else if (level >= ErrorLog::LogLevel::Error
+               || m_ringBuffer.approximateSize() > m_ringBuffer.capacity() / 2) {
+        // 错误日志或积压过半时提前唤醒写线程；不加锁，丢失的唤醒由超时兜底
+        m_writerWake.wakeOne();
+    }
+}
+
 Q_DECLARE_OPERATORS_FOR_FLAGS(Logger::LogTargets)
 
 // 便利宏定义
@@ -325,4 +500,30 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(Logger::LogTargets)
 #define LOG_PERFORMANCE(operation, duration, component, memoryUsage, cpuUsage) \
     Logger::instance()->logPerformance(operation, duration, component, memoryUsage, cpuUsage)
 
+// 带编译期裁剪的日志宏（见logmacros.h），消息参数只在启用时求值；类别必须是常量
+#define LOGGER_LOG(levelValue, level, category, message) \
+    LOG_GATED_CALL(levelValue, Logger::instance(), level, category, \
+                   log(level, (message), category, __FILE__, __LINE__, __FUNCTION__))
+
+#define LOGGER_DEBUG(category, message) \
+    LOGGER_LOG(LOG_LEVEL_DEBUG, ErrorLog::LogLevel::Debug, category, message)
+#define LOGGER_INFO(category, message) \
+    LOGGER_LOG(LOG_LEVEL_INFO, ErrorLog::LogLevel::Info, category, message)
+#define LOGGER_WARNING(category, message) \
+    LOGGER_LOG(LOG_LEVEL_WARNING, ErrorLog::LogLevel::Warning, category, message)
+#define LOGGER_ERROR(category, message) \
+    LOGGER_LOG(LOG_LEVEL_ERROR, ErrorLog::LogLevel::Error, category, message)
+
+// 热路径使用：类别和格式串为字符串字面量，参数为数值（最多4个），格式化由写线程完成
+#define LOGGER_LOG_FMT(levelValue, level, category, format, ...) \
+    LOG_GATED_CALL(levelValue, Logger::instance(), level, category, \
+                   logFormat(level, category, format, __VA_ARGS__))
+
+#define LOGGER_DEBUG_FMT(category, format, ...) \
+    LOGGER_LOG_FMT(LOG_LEVEL_DEBUG, ErrorLog::LogLevel::Debug, category, format, __VA_ARGS__)
+#define LOGGER_INFO_FMT(category, format, ...) \
+    LOGGER_LOG_FMT(LOG_LEVEL_INFO, ErrorLog::LogLevel::Info, category, format, __VA_ARGS__)
+#define LOGGER_WARNING_FMT(category, format, ...) \
+    LOGGER_LOG_FMT(LOG_LEVEL_WARNING, ErrorLog::LogLevel::Warning, category, format, __VA_ARGS__)
+
 // End of logger.h
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef LOGMACROS_H
+#define LOGMACROS_H
+
+#include "logcategorymask.h"
+
+/**
+ * @file logmacros.h
+ * @brief 日志宏的编译期级别裁剪和运行期快速检查
+ *
+ * - 级别低于LOG_COMPILE_MIN_LEVEL的日志宏在编译期被裁剪，参数不会生成任何代码；
+ *   默认Release构建（QT_NO_DEBUG/NDEBUG）裁剪Debug级别，可通过DEFINES覆盖。
+ * - 未裁剪的宏先检查级别和类别位图（原子读取），通过后才求值消息参数。
+ * - 类别参数必须是常量（字面量或常量字符串），其位在每个调用点只查询一次。
+ *
+ * Logger的宏（LOGGER_*）定义在logger.h，StructuredLogger的宏（SLOG_*）定义在structuredlogger.h。
+ */
+
+// 级别数值与ErrorLog::LogLevel一致；StructuredLogger的LogLevel::Critical按LOG_LEVEL_CRITICAL裁剪
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_CRITICAL 4
+
+#ifndef LOG_COMPILE_MIN_LEVEL
+#  if defined(QT_NO_DEBUG) || defined(NDEBUG)
+#    define LOG_COMPILE_MIN_LEVEL LOG_LEVEL_INFO
+#  else
+#    define LOG_COMPILE_MIN_LEVEL LOG_LEVEL_DEBUG
+#  endif
+#endif
+
+/**
+ * @brief 带裁剪和检查的日志调用
+ * @param levelValue 级别数值（LOG_LEVEL_*），用于编译期裁剪
+ * @param instanceExpr 日志器实例表达式，需提供isEnabled(level, categoryBit)
+ * @param level 日志器自己的级别枚举值
+ * @param category 类别（常量）
+ * @param call 对实例调用的成员函数表达式
+ */
+#define LOG_GATED_CALL(levelValue, instanceExpr, level, category, call) \
+    do { \
+        if constexpr ((levelValue) >= LOG_COMPILE_MIN_LEVEL) { \
+            static const int logCategoryBit = LogCategoryMask::bitFor(category); \
+            auto* logInstance = (instanceExpr); \
+            if (logInstance->isEnabled(level, logCategoryBit)) { \
+                logInstance->call; \
+            } \
+        } \
+    } while (0)
+
+#endif // LOGMACROS_H
@@ -0,0 +1,415 @@
+#include "metricsregistry.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <memory>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+MetricsRegistry* MetricsRegistry::s_instance = nullptr;
+QMutex MetricsRegistry::s_instanceMutex;
+
+namespace {
+
+/**
+ * @brief 指标存储，进程内常驻，保证调用点缓存的指针始终有效
+ */
+struct MetricStore
+{
+    QMutex mutex;
+    QHash<QString, std::shared_ptr<MetricCounter>> counters;
+    QHash<QString, std::shared_ptr<MetricGauge>> gauges;
+    QHash<QString, std::shared_ptr<MetricHistogram>> histograms;
+    QHash<QString, std::function<double()>> callbacks;
+};
+
+MetricStore& store()
+{
+    static MetricStore* instance = new MetricStore();
+    return *instance;
+}
+
+template<typename Metric>
+Metric* findOrCreate(QHash<QString, std::shared_ptr<Metric>>& metrics, const QString& name)
+{
+    MetricStore& s = store();
+    QMutexLocker locker(&s.mutex);
+    std::shared_ptr<Metric>& metric = metrics[name];
+    if (!metric) {
+        metric = std::make_shared<Metric>();
+    }
+    return metric.get();
+}
+
+} // namespace
+
+// ==================== MetricHistogram ====================
+
+int MetricHistogram::bucketIndex(quint64 value)
+{
+    if (value < static_cast<quint64>(SUB_BUCKETS)) {
+        return static_cast<int>(value);
+    }
+    // 保留最高位之后的SUB_BUCKET_BITS位作为区间内的线性桶号
+    const int highestBit = 63 - qCountLeadingZeroBits(value);
+    const int shift = highestBit - SUB_BUCKET_BITS;
+    const quint64 top = value >> shift;  // [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>(top - SUB_BUCKETS);
+}
+
+quint64 MetricHistogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS) {
+        return static_cast<quint64>(index);
+    }
+    const int shift = index / SUB_BUCKETS - 1;
+    const quint64 top = SUB_BUCKETS + index % SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void MetricHistogram::record(quint64 value)
+{
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    quint64 current = m_min.load(std::memory_order_relaxed);
+    while (value < current && !m_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = m_max.load(std::memory_order_relaxed);
+    while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+MetricHistogram::Snapshot MetricHistogram::snapshot() const
+{
+    Snapshot result;
+
+    // 先复制桶计数，百分位基于同一份数据计算
+    quint64 counts[BUCKET_COUNT];
+    quint64 total = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return result;
+    }
+
+    result.count = total;
+    result.sum = m_sum.load(std::memory_order_relaxed);
+    result.min = m_min.load(std::memory_order_relaxed);
+    result.max = m_max.load(std::memory_order_relaxed);
+
+    struct Target {
+        double quantile;
+        quint64* value;
+    };
+    const Target targets[] = {
+        {0.50, &result.p50}, {0.90, &result.p90}, {0.99, &result.p99}, {0.999, &result.p999}
+    };
+
+    quint64 seen = 0;
+    int targetIndex = 0;
+    for (int i = 0; i < BUCKET_COUNT && targetIndex < 4; ++i) {
+        seen += counts[i];
+        while (targetIndex < 4 && seen >= static_cast<quint64>(targets[targetIndex].quantile * total + 0.5)) {
+            *targets[targetIndex].value = qMin(bucketUpperBound(i), result.max);
+            ++targetIndex;
+        }
+    }
+
+    return result;
+}
+
+// ==================== MetricsRegistry ====================
+
+MetricsRegistry* MetricsRegistry::instance()
+{
+    QMutexLocker locker(&s_instanceMutex);
+    if (!s_instance) {
+        s_instance = new MetricsRegistry();
+    }
+    return s_instance;
+}
+
+void MetricsRegistry::cleanup()
+{
+    QMutexLocker locker(&s_instanceMutex);
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+MetricsRegistry::MetricsRegistry(QObject* parent)
+    : QObject(parent)
+    , m_snapshotTimer(nullptr)
+    , m_httpServer(nullptr)
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    stopPeriodicSnapshot();
+    stopHttpEndpoint();
+}
+
+MetricCounter* MetricsRegistry::counter(const QString& name)
+{
+    return findOrCreate(store().counters, name);
+}
+
+MetricGauge* MetricsRegistry::gauge(const QString& name)
+{
+    return findOrCreate(store().gauges, name);
+}
+
+MetricHistogram* MetricsRegistry::histogram(const QString& name)
+{
+    return findOrCreate(store().histograms, name);
+}
+
+void MetricsRegistry::registerGaugeCallback(const QString& name, std::function<double()> callback)
+{
+    MetricStore& s = store();
+    QMutexLocker locker(&s.mutex);
+    s.callbacks.insert(name, std::move(callback));
+}
+
+void MetricsRegistry::unregisterGaugeCallback(const QString& name)
+{
+    MetricStore& s = store();
+    QMutexLocker locker(&s.mutex);
+    s.callbacks.remove(name);
+}
+
+QJsonObject MetricsRegistry::snapshot()
+{
+    MetricStore& s = store();
+
+    // 复制一份再采样，回调中可以访问登记表
+    QHash<QString, std::shared_ptr<MetricCounter>> counters;
+    QHash<QString, std::shared_ptr<MetricGauge>> gauges;
+    QHash<QString, std::shared_ptr<MetricHistogram>> histograms;
+    QHash<QString, std::function<double()>> callbacks;
+    {
+        QMutexLocker locker(&s.mutex);
+        counters = s.counters;
+        gauges = s.gauges;
+        histograms = s.histograms;
+        callbacks = s.callbacks;
+    }
+
+    QJsonObject counterValues;
+    for (auto it = counters.constBegin(); it != counters.constEnd(); ++it) {
+        counterValues[it.key()] = static_cast<qint64>(it.value()->value());
+    }
+
+    QJsonObject gaugeValues;
+    for (auto it = gauges.constBegin(); it != gauges.constEnd(); ++it) {
+        gaugeValues[it.key()] = it.value()->value();
+    }
+    for (auto it = callbacks.constBegin(); it != callbacks.constEnd(); ++it) {
+        gaugeValues[it.key()] = it.value()();
+    }
+
+    QJsonObject histogramValues;
+    for (auto it = histograms.constBegin(); it != histograms.constEnd(); ++it) {
+        const MetricHistogram::Snapshot h = it.value()->snapshot();
+        if (h.count == 0) {
+            continue;
+        }
+        QJsonObject values;
+        values["count"] = static_cast<qint64>(h.count);
+        values["sum"] = static_cast<qint64>(h.sum);
+        values["min"] = static_cast<qint64>(h.min);
+        values["max"] = static_cast<qint64>(h.max);
+        values["mean"] = static_cast<double>(h.sum) / h.count;
+        values["p50"] = static_cast<qint64>(h.p50);
+        values["p90"] = static_cast<qint64>(h.p90);
+        values["p99"] = static_cast<qint64>(h.p99);
+        values["p999"] = static_cast<qint64>(h.p999);
+        histogramValues[it.key()] = values;
+    }
+
+    QJsonObject result;
+    result["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    result["counters"] = counterValues;
+    result["gauges"] = gaugeValues;
+    result["histograms"] = histogramValues;
+    return result;
+}
+
+qint64 MetricsRegistry::residentSetSize()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.WorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    // /proc/self/statm 第二列为常驻页数
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+qint64 MetricsRegistry::peakResidentSetSize()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    // /proc/self/status 中的 VmHWM 为常驻内存峰值（kB）
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    for (const QByteArray& line : status.readAll().split('\n')) {
+        if (line.startsWith("VmHWM:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+void MetricsRegistry::startPeriodicSnapshot(const QString& filePath, int intervalMs)
+{
+    m_snapshotPath = filePath;
+    if (!m_snapshotTimer) {
+        m_snapshotTimer = new QTimer(this);
+        connect(m_snapshotTimer, &QTimer::timeout, this, &MetricsRegistry::onSnapshotTimer);
+    }
+    m_snapshotTimer->start(intervalMs);
+    qDebug() << "MetricsRegistry: 定期写入指标快照:" << filePath << "间隔" << intervalMs << "ms";
+}
+
+void MetricsRegistry::stopPeriodicSnapshot()
+{
+    if (m_snapshotTimer && m_snapshotTimer->isActive()) {
+        m_snapshotTimer->stop();
+        // 停止前写最后一份快照
+        writeSnapshot(m_snapshotPath);
+    }
+}
+
+bool MetricsRegistry::writeSnapshot(const QString& filePath)
+{
+    if (filePath.isEmpty()) {
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "MetricsRegistry: 无法写入指标快照:" << filePath;
+        return false;
+    }
+    file.write(QJsonDocument(snapshot()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+bool MetricsRegistry::startHttpEndpoint(quint16 port)
+{
+    if (m_httpServer) {
+        return m_httpServer->isListening();
+    }
+
+    // 只监听本机回环地址，供压力测试期间抓取
+    m_httpServer = new QTcpServer(this);
+    connect(m_httpServer, &QTcpServer::newConnection, this, &MetricsRegistry::onNewConnection);
+    if (!m_httpServer->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "MetricsRegistry: 无法监听端口" << port << ":" << m_httpServer->errorString();
+        delete m_httpServer;
+        m_httpServer = nullptr;
+        return false;
+    }
+
+    qDebug() << "MetricsRegistry: 指标接口 http://127.0.0.1:" << m_httpServer->serverPort() << "/metrics";
+    return true;
+}
+
+void MetricsRegistry::stopHttpEndpoint()
+{
+    if (m_httpServer) {
+        m_httpServer->close();
+        delete m_httpServer;
+        m_httpServer = nullptr;
+    }
+}
+
+void MetricsRegistry::onSnapshotTimer()
+{
+    writeSnapshot(m_snapshotPath);
+}
+
+void MetricsRegistry::onNewConnection()
+{
+    while (QTcpSocket* socket = m_httpServer->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+            // 只需要请求行，收到完整请求头后应答并关闭连接
+            if (!socket->canReadLine() || socket->property("answered").toBool()) {
+                return;
+            }
+            socket->setProperty("answered", true);
+
+            const QList<QByteArray> requestLine = socket->readLine().trimmed().split(' ');
+            const QByteArray path = requestLine.size() >= 2 ? requestLine.at(1) : QByteArray();
+
+            QByteArray status = "200 OK";
+            QByteArray body;
+            if (requestLine.value(0) != "GET") {
+                status = "405 Method Not Allowed";
+            } else if (path == "/" || path == "/metrics") {
+                body = QJsonDocument(MetricsRegistry::snapshot()).toJson(QJsonDocument::Compact);
+            } else {
+                status = "404 Not Found";
+            }
+
+            QByteArray response = "HTTP/1.0 " + status + "\r\n";
+            response += "Content-Type: application/json\r\n";
+            response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+            response += "Connection: close\r\n\r\n";
+            response += body;
+            socket->write(response);
+            socket->disconnectFromHost();
+        });
+    }
+}
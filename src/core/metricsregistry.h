@@ -0,0 +1,188 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <QObject>
+#include <QString>
+#include <QJsonObject>
+#include <QMutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+class QTimer;
+class QTcpServer;
+
+/**
+ * @brief 计数器（单调递增）
+ */
+class MetricCounter
+{
+public:
+    void increment(quint64 amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+/**
+ * @brief 仪表（当前值）
+ */
+class MetricGauge
+{
+public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+/**
+ * @brief 对数-线性分桶的延迟直方图（HDR风格）
+ * @details 每个2的幂区间再均分为16个桶，相对误差不超过1/16，覆盖0到2^64的全部取值；
+ *          记录只做几次原子加，可在任意线程调用。数值单位由指标名约定（如_us）。
+ */
+class MetricHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot {
+        quint64 count = 0;
+        quint64 sum = 0;
+        quint64 min = 0;
+        quint64 max = 0;
+        quint64 p50 = 0;
+        quint64 p90 = 0;
+        quint64 p99 = 0;
+        quint64 p999 = 0;
+    };
+
+    void record(quint64 value);
+    Snapshot snapshot() const;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    std::atomic<quint64> m_buckets[BUCKET_COUNT] = {};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum{0};
+    std::atomic<quint64> m_min{~0ULL};
+    std::atomic<quint64> m_max{0};
+};
+
+/**
+ * @brief 作用域计时，析构时把耗时（微秒）记入直方图
+ */
+class MetricTimer
+{
+public:
+    explicit MetricTimer(MetricHistogram* histogram)
+        : m_histogram(histogram)
+        , m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~MetricTimer()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_histogram->record(static_cast<quint64>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram* m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief 运行时指标登记表
+ *
+ * 组件通过静态函数按名称取得计数器、仪表和直方图。指标对象在进程内常驻，
+ * 调用点可以用静态局部变量缓存指针；需要在采样时计算的值（如缓存命中率、RSS）
+ * 以回调形式登记，组件销毁前注销。
+ * 实例负责导出：定期把快照写入JSON文件，并可在本机回环地址上提供HTTP抓取接口。
+ */
+class MetricsRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MetricsRegistry* instance();
+    static void cleanup();
+
+    static MetricCounter* counter(const QString& name);
+    static MetricGauge* gauge(const QString& name);
+    static MetricHistogram* histogram(const QString& name);
+
+    /**
+     * @brief 登记采样回调（同名回调会被替换）
+     * @param name 指标名
+     * @param callback 在采样线程（主线程）中调用
+     */
+    static void registerGaugeCallback(const QString& name, std::function<double()> callback);
+    static void unregisterGaugeCallback(const QString& name);
+
+    /**
+     * @brief 生成所有指标的快照
+     */
+    static QJsonObject snapshot();
+
+    /**
+     * @brief 当前进程的常驻内存（字节），不支持的平台返回-1
+     */
+    static qint64 residentSetSize();
+
+    /**
+     * @brief 进程启动以来的常驻内存峰值（字节），不支持的平台返回-1
+     */
+    static qint64 peakResidentSetSize();
+
+    /**
+     * @brief 定期把快照写入JSON文件
+     * @param filePath 文件路径
+     * @param intervalMs 间隔（毫秒）
+     */
+    void startPeriodicSnapshot(const QString& filePath, int intervalMs);
+    void stopPeriodicSnapshot();
+
+    /**
+     * @brief 把快照写入文件（原子替换）
+     */
+    bool writeSnapshot(const QString& filePath);
+
+    /**
+     * @brief 在127.0.0.1上提供HTTP抓取接口（GET /metrics）
+     * @param port 端口
+     * @return 监听是否成功
+     */
+    bool startHttpEndpoint(quint16 port);
+    void stopHttpEndpoint();
+
+private slots:
+    void onSnapshotTimer();
+    void onNewConnection();
+
+private:
+    explicit MetricsRegistry(QObject* parent = nullptr);
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    static MetricsRegistry* s_instance;
+    static QMutex s_instanceMutex;
+
+    QTimer* m_snapshotTimer;
+    QString m_snapshotPath;
+    QTcpServer* m_httpServer;
+};
+
+#endif // METRICSREGISTRY_H
@@ -0,0 +1,138 @@
+#ifndef MPSCRINGBUFFER_H
+#define MPSCRINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief 有界无锁多生产者单消费者环形缓冲区
+ * @details 基于每个槽位的序号实现（Vyukov有界队列）：生产者通过CAS抢占写入位置，
+ *          写完后发布槽位序号；消费者按顺序读取已发布的槽位。
+ *          缓冲区满时tryPush立即返回false，生产者永不阻塞，可在音频线程等实时线程中调用。
+ *          元素需可平凡复制，直接在槽位内填充/读取以避免额外拷贝。
+ */
+template<typename T>
+class MpscRingBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "MpscRingBuffer元素必须可平凡复制");
+
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 容量（向上取整为2的幂）
+     */
+    explicit MpscRingBuffer(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos = 0;
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    /**
+     * @brief 抢占一个槽位并在原地填充（多生产者安全）
+     * @param fill 填充函数，参数为槽位元素的引用
+     * @return 缓冲区已满返回false
+     */
+    template<typename Fill>
+    bool tryEmplace(Fill&& fill)
+    {
+        Cell* cell = nullptr;
+        size_t position = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[position & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (m_enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;  // 已满
+            } else {
+                position = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(cell->data);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(const T& item)
+    {
+        return tryEmplace([&item](T& slot) { slot = item; });
+    }
+
+    /**
+     * @brief 按顺序消费已发布的元素（仅限单个消费者调用）
+     * @param handler 处理函数，参数为槽位元素的常量引用
+     * @param maxItems 本次最多消费的数量
+     * @return 实际消费的数量
+     */
+    template<typename Consume>
+    size_t consume(Consume&& handler, size_t maxItems)
+    {
+        size_t count = 0;
+        while (count < maxItems) {
+            Cell* cell = &m_cells[m_dequeuePos & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(m_dequeuePos + 1) < 0) {
+                break;  // 空，或生产者尚未发布
+            }
+            handler(cell->data);
+            cell->sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+            ++m_dequeuePos;
+            ++count;
+        }
+        m_dequeuePosPublished.store(m_dequeuePos, std::memory_order_relaxed);
+        return count;
+    }
+
+    bool tryPop(T& item)
+    {
+        return consume([&item](const T& slot) { item = slot; }, 1) == 1;
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+    /**
+     * @brief 近似元素数量（并发写入时仅供参考）
+     */
+    size_t approximateSize() const
+    {
+        const size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeued = m_dequeuePosPublished.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask = 0;
+
+    // 生产者和消费者位置分处不同缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) size_t m_dequeuePos;
+    std::atomic<size_t> m_dequeuePosPublished{0};  // 供其他线程读取的消费进度
+};
+
+#endif // MPSCRINGBUFFER_H
@@ -0,0 +1,431 @@
+#include "roaringbitmap.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+// 以下循环没有分支和跨迭代依赖，编译器在-O2下生成SIMD指令；
+// 按位运算和计数分开，计数循环不影响按位运算的向量化
+void andWords(const quint64* a, const quint64* b, quint64* out)
+{
+    for (int i = 0; i < RoaringBitmap::BITMAP_WORDS; ++i) {
+        out[i] = a[i] & b[i];
+    }
+}
+
+void orWords(const quint64* a, const quint64* b, quint64* out)
+{
+    for (int i = 0; i < RoaringBitmap::BITMAP_WORDS; ++i) {
+        out[i] = a[i] | b[i];
+    }
+}
+
+void andNotWords(const quint64* a, const quint64* b, quint64* out)
+{
+    for (int i = 0; i < RoaringBitmap::BITMAP_WORDS; ++i) {
+        out[i] = a[i] & ~b[i];
+    }
+}
+
+int countWords(const quint64* words)
+{
+    int count = 0;
+    for (int i = 0; i < RoaringBitmap::BITMAP_WORDS; ++i) {
+        count += qPopulationCount(words[i]);
+    }
+    return count;
+}
+
+inline bool testBit(const quint64* words, quint16 low)
+{
+    return (words[low >> 6] >> (low & 63)) & 1u;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Container
+// ---------------------------------------------------------------------------
+
+bool RoaringBitmap::Container::contains(quint16 low) const
+{
+    if (isBitmap()) {
+        return testBit(words.constData(), low);
+    }
+    return std::binary_search(array.constBegin(), array.constEnd(), low);
+}
+
+bool RoaringBitmap::Container::add(quint16 low)
+{
+    if (isBitmap()) {
+        quint64& word = words[low >> 6];
+        const quint64 mask = quint64(1) << (low & 63);
+        if (word & mask) {
+            return false;
+        }
+        word |= mask;
+        ++cardinality;
+        return true;
+    }
+
+    // 按升序添加（加载时的常见情况）直接追加
+    if (array.isEmpty() || array.constLast() < low) {
+        array.append(low);
+    } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low) {
+            return false;
+        }
+        array.insert(it, low);
+    }
+    ++cardinality;
+    if (cardinality > ARRAY_MAX_SIZE) {
+        toBitmap();
+    }
+    return true;
+}
+
+bool RoaringBitmap::Container::remove(quint16 low)
+{
+    if (isBitmap()) {
+        quint64& word = words[low >> 6];
+        const quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            return false;
+        }
+        word &= ~mask;
+        --cardinality;
+        if (cardinality <= ARRAY_MAX_SIZE) {
+            toArray();
+        }
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) {
+        return false;
+    }
+    array.erase(it);
+    --cardinality;
+    return true;
+}
+
+void RoaringBitmap::Container::toBitmap()
+{
+    words = QVector<quint64>(BITMAP_WORDS, 0);
+    quint64* data = words.data();
+    for (quint16 low : std::as_const(array)) {
+        data[low >> 6] |= quint64(1) << (low & 63);
+    }
+    array = QVector<quint16>();
+}
+
+void RoaringBitmap::Container::toArray()
+{
+    QVector<quint16> values;
+    values.reserve(cardinality);
+    const quint64* data = words.constData();
+    for (int i = 0; i < BITMAP_WORDS; ++i) {
+        quint64 word = data[i];
+        while (word) {
+            values.append(static_cast<quint16>(i * 64 + qCountTrailingZeroBits(word)));
+            word &= word - 1;
+        }
+    }
+    array = values;
+    words = QVector<quint64>();
+}
+
+// ---------------------------------------------------------------------------
+// RoaringBitmap
+// ---------------------------------------------------------------------------
+
+RoaringBitmap::RoaringBitmap()
+{
+}
+
+bool RoaringBitmap::add(quint32 value)
+{
+    const quint16 key = static_cast<quint16>(value >> 16);
+    int index = findContainer(key);
+    if (index < 0) {
+        // 插入位置：按升序添加时总在末尾
+        index = int(std::lower_bound(m_containers.constBegin(), m_containers.constEnd(), key,
+                                     [](const Container& container, quint16 k) { return container.key < k; })
+                    - m_containers.constBegin());
+        Container container;
+        container.key = key;
+        m_containers.insert(index, container);
+    }
+    return m_containers[index].add(static_cast<quint16>(value & 0xFFFF));
+}
+
+bool RoaringBitmap::remove(quint32 value)
+{
+    const int index = findContainer(static_cast<quint16>(value >> 16));
+    if (index < 0) {
+        return false;
+    }
+    Container& container = m_containers[index];
+    if (!container.remove(static_cast<quint16>(value & 0xFFFF))) {
+        return false;
+    }
+    if (container.cardinality == 0) {
+        m_containers.remove(index);
+    }
+    return true;
+}
+
+bool RoaringBitmap::contains(quint32 value) const
+{
+    const int index = findContainer(static_cast<quint16>(value >> 16));
+    return index >= 0 && m_containers[index].contains(static_cast<quint16>(value & 0xFFFF));
+}
+
+int RoaringBitmap::cardinality() const
+{
+    int count = 0;
+    for (const Container& container : m_containers) {
+        count += container.cardinality;
+    }
+    return count;
+}
+
+bool RoaringBitmap::isEmpty() const
+{
+    return m_containers.isEmpty();
+}
+
+void RoaringBitmap::clear()
+{
+    m_containers.clear();
+}
+
+QList<int> RoaringBitmap::toList() const
+{
+    QList<int> values;
+    values.reserve(cardinality());
+    for (const Container& container : m_containers) {
+        const quint32 high = quint32(container.key) << 16;
+        if (container.isBitmap()) {
+            const quint64* data = container.words.constData();
+            for (int i = 0; i < BITMAP_WORDS; ++i) {
+                quint64 word = data[i];
+                while (word) {
+                    values.append(int(high | quint32(i * 64 + qCountTrailingZeroBits(word))));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (quint16 low : container.array) {
+                values.append(int(high | low));
+            }
+        }
+    }
+    return values;
+}
+
+qint64 RoaringBitmap::memoryUsage() const
+{
+    qint64 bytes = sizeof(RoaringBitmap) + m_containers.capacity() * qint64(sizeof(Container));
+    for (const Container& container : m_containers) {
+        bytes += container.isBitmap() ? BITMAP_WORDS * qint64(sizeof(quint64))
+                                      : container.array.capacity() * qint64(sizeof(quint16));
+    }
+    return bytes;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other)
+{
+    *this = combine(*this, other, Operation::And);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other)
+{
+    *this = combine(*this, other, Operation::Or);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other)
+{
+    *this = combine(*this, other, Operation::AndNot);
+    return *this;
+}
+
+RoaringBitmap operator&(const RoaringBitmap& a, const RoaringBitmap& b)
+{
+    return RoaringBitmap::combine(a, b, RoaringBitmap::Operation::And);
+}
+
+RoaringBitmap operator|(const RoaringBitmap& a, const RoaringBitmap& b)
+{
+    return RoaringBitmap::combine(a, b, RoaringBitmap::Operation::Or);
+}
+
+RoaringBitmap operator-(const RoaringBitmap& a, const RoaringBitmap& b)
+{
+    return RoaringBitmap::combine(a, b, RoaringBitmap::Operation::AndNot);
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const
+{
+    if (m_containers.size() != other.m_containers.size()) {
+        return false;
+    }
+    // 容器类型只由基数决定，基数相同的容器内容可以直接比较
+    for (int i = 0; i < m_containers.size(); ++i) {
+        const Container& a = m_containers[i];
+        const Container& b = other.m_containers[i];
+        if (a.key != b.key || a.cardinality != b.cardinality || a.array != b.array || a.words != b.words) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int RoaringBitmap::findContainer(quint16 key) const
+{
+    auto it = std::lower_bound(m_containers.constBegin(), m_containers.constEnd(), key,
+                               [](const Container& container, quint16 k) { return container.key < k; });
+    if (it == m_containers.constEnd() || it->key != key) {
+        return -1;
+    }
+    return int(it - m_containers.constBegin());
+}
+
+RoaringBitmap RoaringBitmap::combine(const RoaringBitmap& a, const RoaringBitmap& b, Operation operation)
+{
+    RoaringBitmap result;
+    const QVector<Container>& left = a.m_containers;
+    const QVector<Container>& right = b.m_containers;
+    int i = 0;
+    int j = 0;
+
+    // 只在一侧出现的容器：或运算两侧都保留，差运算只保留左侧，与运算都丢弃；
+    // QVector隐式共享，保留的容器不复制数据
+    while (i < left.size() && j < right.size()) {
+        if (left[i].key < right[j].key) {
+            if (operation != Operation::And) {
+                result.m_containers.append(left[i]);
+            }
+            ++i;
+        } else if (right[j].key < left[i].key) {
+            if (operation == Operation::Or) {
+                result.m_containers.append(right[j]);
+            }
+            ++j;
+        } else {
+            Container combined = combineContainers(left[i], right[j], operation);
+            if (combined.cardinality > 0) {
+                result.m_containers.append(combined);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    if (operation != Operation::And) {
+        for (; i < left.size(); ++i) {
+            result.m_containers.append(left[i]);
+        }
+    }
+    if (operation == Operation::Or) {
+        for (; j < right.size(); ++j) {
+            result.m_containers.append(right[j]);
+        }
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::combineContainers(const Container& a, const Container& b, Operation operation)
+{
+    Container result;
+    result.key = a.key;
+
+    if (a.isBitmap() && b.isBitmap()) {
+        result.words = QVector<quint64>(BITMAP_WORDS);
+        switch (operation) {
+        case Operation::And:
+            andWords(a.words.constData(), b.words.constData(), result.words.data());
+            break;
+        case Operation::Or:
+            orWords(a.words.constData(), b.words.constData(), result.words.data());
+            break;
+        case Operation::AndNot:
+            andNotWords(a.words.constData(), b.words.constData(), result.words.data());
+            break;
+        }
+        result.cardinality = countWords(result.words.constData());
+        if (result.cardinality <= ARRAY_MAX_SIZE) {
+            result.toArray();
+        }
+        return result;
+    }
+
+    if (!a.isBitmap() && !b.isBitmap()) {
+        QVector<quint16> values;
+        auto out = std::back_inserter(values);
+        switch (operation) {
+        case Operation::And:
+            values.reserve(qMin(a.cardinality, b.cardinality));
+            std::set_intersection(a.array.constBegin(), a.array.constEnd(),
+                                  b.array.constBegin(), b.array.constEnd(), out);
+            break;
+        case Operation::Or:
+            values.reserve(a.cardinality + b.cardinality);
+            std::set_union(a.array.constBegin(), a.array.constEnd(),
+                           b.array.constBegin(), b.array.constEnd(), out);
+            break;
+        case Operation::AndNot:
+            values.reserve(a.cardinality);
+            std::set_difference(a.array.constBegin(), a.array.constEnd(),
+                                b.array.constBegin(), b.array.constEnd(), out);
+            break;
+        }
+        result.array = values;
+        result.cardinality = values.size();
+        if (result.cardinality > ARRAY_MAX_SIZE) {
+            result.toBitmap();
+        }
+        return result;
+    }
+
+    // 一个数组一个位图
+    const Container& arrayContainer = a.isBitmap() ? b : a;
+    const Container& bitmapContainer = a.isBitmap() ? a : b;
+    const quint64* bits = bitmapContainer.words.constData();
+
+    if (operation == Operation::And || (operation == Operation::AndNot && !a.isBitmap())) {
+        // 结果是数组的子集：保留（或去掉）位图中存在的值
+        const bool keepPresent = operation == Operation::And;
+        for (quint16 low : arrayContainer.array) {
+            if (testBit(bits, low) == keepPresent) {
+                result.array.append(low);
+            }
+        }
+        result.cardinality = result.array.size();
+        return result;
+    }
+
+    // 或运算，或位图减数组：在位图副本上置位/清位
+    result.words = bitmapContainer.words;
+    result.cardinality = bitmapContainer.cardinality;
+    quint64* data = result.words.data();
+    for (quint16 low : arrayContainer.array) {
+        const quint64 mask = quint64(1) << (low & 63);
+        quint64& word = data[low >> 6];
+        if (operation == Operation::Or) {
+            result.cardinality += (word & mask) ? 0 : 1;
+            word |= mask;
+        } else {
+            result.cardinality -= (word & mask) ? 1 : 0;
+            word &= ~mask;
+        }
+    }
+    if (result.cardinality <= ARRAY_MAX_SIZE) {
+        result.toArray();
+    }
+    return result;
+}
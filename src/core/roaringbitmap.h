@@ -0,0 +1,95 @@
+#ifndef ROARINGBITMAP_H
+#define ROARINGBITMAP_H
+
+#include <QVector>
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @brief 压缩位图（Roaring格式）
+ * @details 32位值按高16位分成容器，每个容器保存低16位：
+ *          不超过ARRAY_MAX_SIZE个值时用有序的quint16数组（最多8KB），
+ *          超过时改用1024个64位字的位图（固定8KB）。稀疏和稠密的集合都只占很少内存，
+ *          contains()是一次容器二分查找加一次数组二分查找或一次位测试。
+ *
+ *          两个位图容器之间的与、或、差是对1024个字的无分支循环，
+ *          与AudioKernels一样写成编译器能自动向量化的形式（x86-64的SSE2、ARM的NEON）；
+ *          数组容器之间按有序合并，数组与位图之间逐个测试数组中的值。
+ *
+ *          不是线程安全的，由所属对象加锁。
+ */
+class RoaringBitmap
+{
+public:
+    static const int ARRAY_MAX_SIZE = 4096;     // 数组容器的最大元素数
+    static const int BITMAP_WORDS = 1024;       // 位图容器的64位字数（65536位）
+
+    RoaringBitmap();
+
+    /**
+     * @brief 添加一个值
+     * @return 原来不存在时返回true
+     */
+    bool add(quint32 value);
+
+    /**
+     * @brief 删除一个值
+     * @return 原来存在时返回true
+     */
+    bool remove(quint32 value);
+
+    bool contains(quint32 value) const;
+    int cardinality() const;
+    bool isEmpty() const;
+    void clear();
+
+    /**
+     * @brief 按升序返回全部值
+     */
+    QList<int> toList() const;
+
+    /**
+     * @brief 估算占用的内存（字节）
+     */
+    qint64 memoryUsage() const;
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator-=(const RoaringBitmap& other);
+
+    friend RoaringBitmap operator&(const RoaringBitmap& a, const RoaringBitmap& b);
+    friend RoaringBitmap operator|(const RoaringBitmap& a, const RoaringBitmap& b);
+    friend RoaringBitmap operator-(const RoaringBitmap& a, const RoaringBitmap& b);
+
+    bool operator==(const RoaringBitmap& other) const;
+    bool operator!=(const RoaringBitmap& other) const { return !(*this == other); }
+
+private:
+    struct Container {
+        quint16 key = 0;                // 值的高16位
+        int cardinality = 0;
+        QVector<quint16> array;         // 数组容器：有序的低16位
+        QVector<quint64> words;         // 位图容器：BITMAP_WORDS个字，为空表示数组容器
+
+        bool isBitmap() const { return !words.isEmpty(); }
+        bool contains(quint16 low) const;
+        bool add(quint16 low);
+        bool remove(quint16 low);
+        void toBitmap();
+        void toArray();
+    };
+
+    enum class Operation {
+        And,
+        Or,
+        AndNot
+    };
+
+    int findContainer(quint16 key) const;
+    static RoaringBitmap combine(const RoaringBitmap& a, const RoaringBitmap& b, Operation operation);
+    static Container combineContainers(const Container& a, const Container& b, Operation operation);
+
+    QVector<Container> m_containers;    // 按key升序
+};
+
+#endif // ROARINGBITMAP_H
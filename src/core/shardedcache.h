@@ -0,0 +1,534 @@
+#ifndef SHARDEDCACHE_H
+#define SHARDEDCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <optional>
+#include <memory>
+#include <vector>
+#include "constants.h"
+
+/**
+ * @brief 分片缓存统计信息
+ */
+struct ShardedCacheStats {
+    quint64 hits = 0;          // 命中次数
+    quint64 misses = 0;        // 未命中次数
+    quint64 insertions = 0;    // 插入次数
+    quint64 evictions = 0;     // 淘汰次数
+    quint64 rejections = 0;    // 准入策略拒绝次数
+    int itemCount = 0;         // 当前缓存项数量
+    qint64 totalBytes = 0;     // 当前占用字节数
+
+    /**
+     * @brief 计算命中率
+     * @return 命中率（0.0-1.0）
+     */
+    double hitRate() const {
+        const quint64 total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+};
+
+/**
+ * @brief 频率草图（Count-Min Sketch），用于TinyLFU准入判断
+ * @details 每行使用4位饱和计数器，采样次数达到阈值后所有计数减半，
+ *          使频率估计随时间衰减。调用方负责加锁。
+ */
+class FrequencySketch
+{
+public:
+    explicit FrequencySketch(int capacity = 0) { resize(capacity); }
+
+    /**
+     * @brief 按预期容量调整草图大小
+     * @param capacity 预期缓存项数量
+     */
+    void resize(int capacity) {
+        int width = 16;
+        while (width < capacity * 2 && width < (1 << 24)) {
+            width <<= 1;
+        }
+        m_mask = width - 1;
+        m_table.fill(0, width * ROWS);
+        m_sampleSize = qMax(10 * capacity, 64);
+        m_additions = 0;
+    }
+
+    /**
+     * @brief 记录一次访问
+     * @param hash 键的哈希值
+     */
+    void increment(size_t hash) {
+        bool added = false;
+        for (int row = 0; row < ROWS; ++row) {
+            quint8& counter = m_table[row * (m_mask + 1) + indexOf(hash, row)];
+            if (counter < MAX_COUNT) {
+                ++counter;
+                added = true;
+            }
+        }
+        if (added && ++m_additions >= m_sampleSize) {
+            reset();
+        }
+    }
+
+    /**
+     * @brief 估计访问频率
+     * @param hash 键的哈希值
+     * @return 频率估计值（0-15）
+     */
+    int frequency(size_t hash) const {
+        int result = MAX_COUNT;
+        for (int row = 0; row < ROWS; ++row) {
+            result = qMin(result, int(m_table[row * (m_mask + 1) + indexOf(hash, row)]));
+        }
+        return result;
+    }
+
+private:
+    int indexOf(size_t hash, int row) const {
+        // 每行使用不同的乘法扰动，降低行间冲突相关性
+        static const quint32 SEEDS[ROWS] = {0x9E3779B1u, 0x85EBCA77u, 0xC2B2AE3Du, 0x27D4EB2Fu};
+        quint32 h = static_cast<quint32>(quint64(hash) ^ (quint64(hash) >> 32)) * SEEDS[row];
+        return static_cast<int>((h ^ (h >> 15)) & static_cast<quint32>(m_mask));
+    }
+
+    void reset() {
+        for (quint8& counter : m_table) {
+            counter >>= 1;
+        }
+        m_additions /= 2;
+    }
+
+    static const int ROWS = 4;
+    static const quint8 MAX_COUNT = 15;
+
+    QVector<quint8> m_table;
+    int m_mask = 0;
+    int m_sampleSize = 0;
+    int m_additions = 0;
+};
+
+/**
+ * @brief 分片并发LRU缓存
+ * @tparam K 键类型（需支持qHash）
+ * @tparam V 值类型
+ * @details 键按哈希分布到N个分片，每个分片独立加锁，降低多线程竞争。
+ *          分片内部使用哈希表+侵入式双向链表，get/put均为O(1)。
+ *          同时支持数量上限和字节上限，可选启用TinyLFU准入策略，
+ *          避免一次性访问的冷数据把热点数据挤出缓存。
+ */
+template<typename K, typename V>
+class ShardedCache
+{
+public:
+    using SizeFunction = std::function<qint64(const V&)>;
+
+    /**
+     * @brief 构造函数
+     * @param maxItems 最大缓存项数量
+     * @param maxBytes 最大字节数（0表示不限制）
+     * @param shardCount 分片数量（向上取整为2的幂）
+     */
+    explicit ShardedCache(int maxItems = Constants::Performance::CACHE_SIZE_LIMIT,
+                          qint64 maxBytes = 0,
+                          int shardCount = DEFAULT_SHARD_COUNT)
+        : m_sizeFunction([](const V&) { return static_cast<qint64>(sizeof(V)); })
+        , m_admissionEnabled(false)
+    {
+        int count = 1;
+        while (count < shardCount && count < MAX_SHARD_COUNT) {
+            count <<= 1;
+        }
+        m_shardMask = count - 1;
+        m_shards.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            m_shards.push_back(std::make_unique<Shard>());
+        }
+        setLimits(maxItems, maxBytes);
+    }
+
+    ~ShardedCache() {
+        clear();
+    }
+
+    // 禁用拷贝构造和赋值
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    /**
+     * @brief 设置值大小计算函数（用于字节上限）
+     * @param sizeFunction 返回值占用字节数的函数
+     * @note 应在缓存使用前设置
+     */
+    void setSizeFunction(const SizeFunction& sizeFunction) {
+        m_sizeFunction = sizeFunction;
+    }
+
+    /**
+     * @brief 启用/禁用TinyLFU准入策略
+     * @param enabled 是否启用
+     * @note 应在缓存使用前设置
+     */
+    void setAdmissionPolicyEnabled(bool enabled) {
+        m_admissionEnabled = enabled;
+    }
+
+    /**
+     * @brief 设置容量上限
+     * @param maxItems 最大缓存项数量
+     * @param maxBytes 最大字节数（0表示不限制）
+     * @note 上限按分片均分，余数分给前面的分片，各分片之和正好等于上限；
+     *       上限小于分片数时部分分片容量为0，落在其中的键不会被缓存
+     */
+    void setLimits(int maxItems, qint64 maxBytes = 0) {
+        const int shardCount = static_cast<int>(m_shards.size());
+        const int items = qMax(0, maxItems);
+
+        for (int i = 0; i < shardCount; ++i) {
+            Shard* shard = m_shards[i].get();
+            QMutexLocker locker(&shard->mutex);
+            shard->maxItems = items / shardCount + (i < items % shardCount ? 1 : 0);
+            shard->maxBytes = maxBytes > 0 ? maxBytes / shardCount + (i < maxBytes % shardCount ? 1 : 0) : -1;
+            shard->sketch.resize(shard->maxItems);
+            while (shard->overBudget(0, 0)) {
+                shard->evictTail();
+            }
+        }
+    }
+
+    /**
+     * @brief 插入或更新缓存项
+     * @param key 键
+     * @param value 值
+     * @param cost 字节开销（小于0时使用大小计算函数）
+     * @return 是否被缓存接纳
+     */
+    bool put(const K& key, const V& value, qint64 cost = -1) {
+        const size_t hash = qHash(key);
+        const qint64 itemCost = cost >= 0 ? cost : m_sizeFunction(value);
+        Shard& shard = shardFor(hash);
+
+        QMutexLocker locker(&shard.mutex);
+        if (m_admissionEnabled) {
+            shard.sketch.increment(hash);
+        }
+
+        // 放不下的值直接拒绝；更新已有的键时同样拒绝，并删除旧值，不再返回过期的内容
+        if (shard.maxItems == 0 || (shard.maxBytes >= 0 && itemCost > shard.maxBytes)) {
+            if (Node* stale = shard.index.take(key)) {
+                shard.unlink(stale);
+                shard.totalBytes -= stale->cost;
+                delete stale;
+            }
+            ++shard.stats.rejections;
+            return false;
+        }
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Node* node = it.value();
+            shard.totalBytes += itemCost - node->cost;
+            node->value = value;
+            node->cost = itemCost;
+            shard.moveToFront(node);
+            while (shard.overBudget(0, 0) && shard.tail != node) {
+                shard.evictTail();
+            }
+            return true;
+        }
+
+        // TinyLFU：候选项的访问频率必须高于将被淘汰的项
+        if (m_admissionEnabled && shard.tail && shard.overBudget(1, itemCost)) {
+            const int candidateFrequency = shard.sketch.frequency(hash);
+            const int victimFrequency = shard.sketch.frequency(shard.tail->hash);
+            if (candidateFrequency <= victimFrequency) {
+                ++shard.stats.rejections;
+                return false;
+            }
+        }
+
+        while (shard.tail && shard.overBudget(1, itemCost)) {
+            shard.evictTail();
+        }
+
+        Node* node = new Node(key, value, itemCost, hash);
+        shard.pushFront(node);
+        shard.index.insert(key, node);
+        shard.totalBytes += itemCost;
+        ++shard.stats.insertions;
+        return true;
+    }
+
+    /**
+     * @brief 获取缓存项
+     * @param key 键
+     * @return 值的可选对象
+     */
+    std::optional<V> get(const K& key) {
+        const size_t hash = qHash(key);
+        Shard& shard = shardFor(hash);
+
+        QMutexLocker locker(&shard.mutex);
+        if (m_admissionEnabled) {
+            shard.sketch.increment(hash);
+        }
+
+        auto it = shard.index.constFind(key);
+        if (it == shard.index.constEnd()) {
+            ++shard.stats.misses;
+            return std::nullopt;
+        }
+
+        Node* node = it.value();
+        shard.moveToFront(node);
+        ++shard.stats.hits;
+        return node->value;
+    }
+
+    /**
+     * @brief 检查键是否存在（不影响LRU顺序和统计）
+     * @param key 键
+     * @return 是否存在
+     */
+    bool contains(const K& key) const {
+        const Shard& shard = shardFor(qHash(key));
+        QMutexLocker locker(&shard.mutex);
+        return shard.index.contains(key);
+    }
+
+    /**
+     * @brief 移除缓存项
+     * @param key 键
+     * @return 是否移除成功
+     */
+    bool remove(const K& key) {
+        Shard& shard = shardFor(qHash(key));
+        QMutexLocker locker(&shard.mutex);
+
+        Node* node = shard.index.take(key);
+        if (!node) {
+            return false;
+        }
+        shard.unlink(node);
+        shard.totalBytes -= node->cost;
+        delete node;
+        return true;
+    }
+
+    /**
+     * @brief 清空缓存（保留统计信息）
+     */
+    void clear() {
+        for (auto& shard : m_shards) {
+            QMutexLocker locker(&shard->mutex);
+            shard->clear();
+        }
+    }
+
+    /**
+     * @brief 获取缓存项数量
+     */
+    int size() const {
+        int total = 0;
+        for (const auto& shard : m_shards) {
+            QMutexLocker locker(&shard->mutex);
+            total += shard->index.size();
+        }
+        return total;
+    }
+
+    /**
+     * @brief 获取当前占用字节数
+     */
+    qint64 totalBytes() const {
+        qint64 total = 0;
+        for (const auto& shard : m_shards) {
+            QMutexLocker locker(&shard->mutex);
+            total += shard->totalBytes;
+        }
+        return total;
+    }
+
+    /**
+     * @brief 获取分片数量
+     */
+    int shardCount() const {
+        return static_cast<int>(m_shards.size());
+    }
+
+    /**
+     * @brief 获取汇总统计信息
+     */
+    ShardedCacheStats statistics() const {
+        ShardedCacheStats result;
+        for (const auto& shard : m_shards) {
+            QMutexLocker locker(&shard->mutex);
+            result.hits += shard->stats.hits;
+            result.misses += shard->stats.misses;
+            result.insertions += shard->stats.insertions;
+            result.evictions += shard->stats.evictions;
+            result.rejections += shard->stats.rejections;
+            result.itemCount += shard->index.size();
+            result.totalBytes += shard->totalBytes;
+        }
+        return result;
+    }
+
+    /**
+     * @brief 获取缓存命中率
+     * @return 命中率（0.0-1.0）
+     */
+    double hitRate() const {
+        return statistics().hitRate();
+    }
+
+    /**
+     * @brief 重置统计计数
+     */
+    void resetStatistics() {
+        for (auto& shard : m_shards) {
+            QMutexLocker locker(&shard->mutex);
+            shard->stats = ShardedCacheStats();
+        }
+    }
+
+    /**
+     * @brief 获取统计信息字符串
+     */
+    QString getStatistics() const {
+        const ShardedCacheStats stats = statistics();
+        return QString("ShardedCache Statistics: Shards=%1, Size=%2, Bytes=%3, Hits=%4, Misses=%5, "
+                       "Evictions=%6, Rejections=%7, Hit Rate=%8%")
+               .arg(shardCount())
+               .arg(stats.itemCount)
+               .arg(stats.totalBytes)
+               .arg(stats.hits)
+               .arg(stats.misses)
+               .arg(stats.evictions)
+               .arg(stats.rejections)
+               .arg(stats.hitRate() * 100, 0, 'f', 2);
+    }
+
+private:
+    /**
+     * @brief 链表节点
+     */
+    struct Node {
+        K key;
+        V value;
+        qint64 cost;
+        size_t hash;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+
+        Node(const K& k, const V& v, qint64 c, size_t h) : key(k), value(v), cost(c), hash(h) {}
+    };
+
+    /**
+     * @brief 缓存分片
+     */
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<K, Node*> index;
+        Node* head = nullptr;   // 最近使用
+        Node* tail = nullptr;   // 最久未使用
+        int maxItems = 1;
+        qint64 maxBytes = -1;   // 小于0表示不限制
+        qint64 totalBytes = 0;
+        FrequencySketch sketch;
+        ShardedCacheStats stats;
+
+        ~Shard() { clear(); }
+
+        bool overBudget(int incomingItems, qint64 incomingBytes) const {
+            if (index.size() + incomingItems > maxItems) {
+                return true;
+            }
+            return maxBytes >= 0 && totalBytes + incomingBytes > maxBytes;
+        }
+
+        void pushFront(Node* node) {
+            node->prev = nullptr;
+            node->next = head;
+            if (head) {
+                head->prev = node;
+            }
+            head = node;
+            if (!tail) {
+                tail = node;
+            }
+        }
+
+        void unlink(Node* node) {
+            if (node->prev) {
+                node->prev->next = node->next;
+            } else {
+                head = node->next;
+            }
+            if (node->next) {
+                node->next->prev = node->prev;
+            } else {
+                tail = node->prev;
+            }
+            node->prev = nullptr;
+            node->next = nullptr;
+        }
+
+        void moveToFront(Node* node) {
+            if (head == node) {
+                return;
+            }
+            unlink(node);
+            pushFront(node);
+        }
+
+        void evictTail() {
+            Node* victim = tail;
+            if (!victim) {
+                return;
+            }
+            unlink(victim);
+            index.remove(victim->key);
+            totalBytes -= victim->cost;
+            ++stats.evictions;
+            delete victim;
+        }
+
+        void clear() {
+            Node* node = head;
+            while (node) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+            head = nullptr;
+            tail = nullptr;
+            index.clear();
+            totalBytes = 0;
+        }
+    };
+
+    Shard& shardFor(size_t hash) {
+        return *m_shards[(hash ^ (hash >> 16)) & m_shardMask];
+    }
+
+    const Shard& shardFor(size_t hash) const {
+        return *m_shards[(hash ^ (hash >> 16)) & m_shardMask];
+    }
+
+    static const int DEFAULT_SHARD_COUNT = 16;
+    static const int MAX_SHARD_COUNT = 256;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    size_t m_shardMask;
+    SizeFunction m_sizeFunction;
+    bool m_admissionEnabled;
+};
+
+#endif // SHARDEDCACHE_H
@@ -0,0 +1,159 @@
+#include "shuffleorder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ShuffleOrder::ShuffleOrder(quint32 seed)
+    : m_random(seed)
+{
+}
+
+void ShuffleOrder::setWeightFunction(const WeightFunction& weight)
+{
+    m_weight = weight;
+}
+
+void ShuffleOrder::reset(int count, int first)
+{
+    m_order.resize(qMax(0, count));
+    for (int i = 0; i < m_order.size(); ++i) {
+        m_order[i] = i;
+    }
+    shuffleRange(0);
+    rebuildPositions();
+
+    if (first >= 0 && first < m_order.size()) {
+        swapPositions(0, m_position[first]);
+    }
+}
+
+void ShuffleOrder::reshuffle(int avoidFirst)
+{
+    shuffleRange(0);
+    rebuildPositions();
+
+    if (m_order.size() > 1 && m_order.first() == avoidFirst) {
+        swapPositions(0, 1 + static_cast<int>(m_random.bounded(m_order.size() - 1)));
+    }
+}
+
+void ShuffleOrder::append(int current, int count)
+{
+    const int currentPosition = positionOf(current);
+    for (int i = 0; i < count; ++i) {
+        const int index = m_order.size();
+        m_order.append(index);
+        m_position.append(index);
+
+        // 与剩余部分（当前位置之后，含自身）中的随机位置交换，等价于均匀插入
+        const int lowest = currentPosition + 1;
+        const int target = lowest + static_cast<int>(m_random.bounded(index - lowest + 1));
+        swapPositions(target, index);
+    }
+}
+
+void ShuffleOrder::remap(const QList<int>& oldToNew)
+{
+    const int newCount = static_cast<int>(std::count_if(oldToNew.begin(), oldToNew.end(),
+                                                         [](int mapped) { return mapped >= 0; }));
+    if (oldToNew.size() != m_order.size()) {
+        // 与排列不对应时无法保持顺序，重新洗牌
+        reset(newCount);
+        return;
+    }
+
+    QVector<int> order;
+    order.reserve(m_order.size());
+    for (int index : m_order) {
+        const int mapped = oldToNew[index];
+        if (mapped >= 0) {
+            order.append(mapped);
+        }
+    }
+    m_order = order;
+    rebuildPositions();
+}
+
+void ShuffleOrder::moveTo(int index, int position)
+{
+    const int current = positionOf(index);
+    if (current < 0 || position < 0 || position >= m_order.size()) {
+        return;
+    }
+    swapPositions(current, position);
+}
+
+int ShuffleOrder::positionOf(int index) const
+{
+    return index >= 0 && index < m_position.size() ? m_position[index] : -1;
+}
+
+int ShuffleOrder::next(int current) const
+{
+    const int position = positionOf(current);
+    if (position < 0 || position + 1 >= m_order.size()) {
+        return -1;
+    }
+    return m_order[position + 1];
+}
+
+int ShuffleOrder::previous(int current) const
+{
+    const int position = positionOf(current);
+    if (position <= 0) {
+        return -1;
+    }
+    return m_order[position - 1];
+}
+
+void ShuffleOrder::shuffleRange(int begin)
+{
+    const int count = m_order.size();
+    if (count - begin < 2) {
+        return;
+    }
+
+    if (!m_weight) {
+        // Fisher-Yates
+        for (int i = count - 1; i > begin; --i) {
+            const int j = begin + static_cast<int>(m_random.bounded(i - begin + 1));
+            std::swap(m_order[i], m_order[j]);
+        }
+        return;
+    }
+
+    // 每个索引抽一个指数分布的键，权重越大键越小，按键升序就是一次不放回的加权抽样
+    QVector<QPair<double, int>> keyed;
+    keyed.reserve(count - begin);
+    for (int i = begin; i < count; ++i) {
+        const int index = m_order[i];
+        const double weight = m_weight(index);
+        const double u = 1.0 - m_random.generateDouble();  // (0, 1]
+        const double key = weight > 0.0 ? -std::log(u) / weight : std::numeric_limits<double>::infinity();
+        keyed.append(qMakePair(key, index));
+    }
+    std::sort(keyed.begin(), keyed.end(), [](const QPair<double, int>& a, const QPair<double, int>& b) {
+        return a.first < b.first;
+    });
+    for (int i = 0; i < keyed.size(); ++i) {
+        m_order[begin + i] = keyed[i].second;
+    }
+}
+
+void ShuffleOrder::rebuildPositions()
+{
+    m_position.resize(m_order.size());
+    for (int position = 0; position < m_order.size(); ++position) {
+        m_position[m_order[position]] = position;
+    }
+}
+
+void ShuffleOrder::swapPositions(int a, int b)
+{
+    if (a == b) {
+        return;
+    }
+    std::swap(m_order[a], m_order[b]);
+    m_position[m_order[a]] = a;
+    m_position[m_order[b]] = b;
+}
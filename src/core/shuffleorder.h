@@ -0,0 +1,92 @@
+#ifndef SHUFFLEORDER_H
+#define SHUFFLEORDER_H
+
+#include <QVector>
+#include <QList>
+#include <QRandomGenerator>
+#include <functional>
+
+/**
+ * @brief 随机播放顺序（洗牌袋）
+ * @details 保存一个排列和它的逆映射（索引 -> 在排列中的位置），上一首/下一首都是O(1)。
+ *          一轮播完后由调用方决定是否reshuffle()开始新一轮，同一轮内不会重复。
+ *          新增的歌曲随机插入到当前位置之后的剩余部分，不打乱已经播放过的顺序。
+ *          可设置权重函数：权重越大越可能排在前面（Efraimidis-Spirakis加权抽样，
+ *          键为-ln(u)/w，按键升序排列）。
+ *
+ *          不是线程安全的，由所属对象在同一线程中使用。
+ */
+class ShuffleOrder
+{
+public:
+    /**
+     * @brief 返回索引对应的权重，<=0表示尽量排到最后
+     */
+    using WeightFunction = std::function<double(int index)>;
+
+    explicit ShuffleOrder(quint32 seed = QRandomGenerator::global()->generate());
+
+    /**
+     * @brief 权重函数，为空时均匀洗牌；只在reset()和reshuffle()时使用
+     */
+    void setWeightFunction(const WeightFunction& weight);
+
+    /**
+     * @brief 为count个索引生成新的排列
+     * @param first 排在第一位的索引（通常是正在播放的歌曲），-1表示不指定
+     */
+    void reset(int count, int first = -1);
+
+    /**
+     * @brief 开始新一轮，保持大小不变
+     * @param avoidFirst 新一轮的第一首不能是这个索引（刚播放完的歌曲），只有一首时除外
+     */
+    void reshuffle(int avoidFirst = -1);
+
+    /**
+     * @brief 追加count个新索引（size()..size()+count-1），随机放到current之后的剩余部分
+     * @param current 当前位置的索引，-1表示整个排列都还未播放
+     */
+    void append(int current, int count = 1);
+
+    /**
+     * @brief 歌曲被删除或重排后更新索引，保持原有的随机顺序
+     * @param oldToNew oldToNew[旧索引] = 新索引，被删除的为-1
+     */
+    void remap(const QList<int>& oldToNew);
+
+    /**
+     * @brief 把index放到position（与原来在该位置的索引交换），用于跳到尚未播放的歌曲
+     */
+    void moveTo(int index, int position);
+
+    int size() const { return m_order.size(); }
+    bool isEmpty() const { return m_order.isEmpty(); }
+
+    int at(int position) const { return m_order.at(position); }
+    int positionOf(int index) const;
+    int first() const { return m_order.isEmpty() ? -1 : m_order.first(); }
+    int last() const { return m_order.isEmpty() ? -1 : m_order.last(); }
+
+    /**
+     * @brief 排列中current之后的索引，已到末尾或current无效时返回-1
+     */
+    int next(int current) const;
+
+    /**
+     * @brief 排列中current之前的索引，已在开头或current无效时返回-1
+     */
+    int previous(int current) const;
+
+private:
+    void shuffleRange(int begin);
+    void rebuildPositions();
+    void swapPositions(int a, int b);
+
+    QVector<int> m_order;      // 位置 -> 索引
+    QVector<int> m_position;   // 索引 -> 位置
+    WeightFunction m_weight;
+    QRandomGenerator m_random;
+};
+
+#endif // SHUFFLEORDER_H
@@ -0,0 +1,289 @@
+#include "startupgraph.h"
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QThread>
+#include <QtConcurrent>
+#include <QDebug>
+#include <stdexcept>
+
+StartupGraph::StartupGraph(QObject* parent)
+    : QObject(parent)
+    , m_remaining(0)
+    , m_started(false)
+    , m_failed(false)
+{
+}
+
+StartupGraph::~StartupGraph()
+{
+    // 工作线程任务可能引用图的调用方，析构前等待它们结束
+    for (QFuture<void>& future : m_workerFutures) {
+        future.waitForFinished();
+    }
+}
+
+void StartupGraph::addTask(const QString& name, Affinity affinity, const QStringList& dependencies,
+                           std::function<bool()> function, bool critical)
+{
+    if (m_started) {
+        qWarning() << "StartupGraph: 启动后不能再添加任务:" << name;
+        return;
+    }
+    if (m_tasks.contains(name)) {
+        qWarning() << "StartupGraph: 任务名重复:" << name;
+        return;
+    }
+
+    TaskInfo task;
+    task.name = name;
+    task.affinity = affinity;
+    task.dependencies = dependencies;
+    task.function = std::move(function);
+    task.critical = critical;
+    m_tasks.insert(name, task);
+    m_order.append(name);
+}
+
+bool StartupGraph::start()
+{
+    if (m_started) {
+        return true;
+    }
+
+    QString error;
+    if (!validate(&error)) {
+        qCritical() << "StartupGraph: 任务图无效:" << error;
+        m_failed = true;
+        return false;
+    }
+
+    m_started = true;
+    m_remaining = m_tasks.size();
+    m_timer.start();
+    scheduleReadyTasks();
+    return true;
+}
+
+bool StartupGraph::validate(QString* error) const
+{
+    for (const QString& name : m_order) {
+        for (const QString& dependency : m_tasks.value(name).dependencies) {
+            if (!m_tasks.contains(dependency)) {
+                *error = QString("任务%1依赖不存在的任务%2").arg(name, dependency);
+                return false;
+            }
+        }
+    }
+
+    // Kahn算法检查环
+    QHash<QString, int> inDegree;
+    for (const QString& name : m_order) {
+        inDegree[name] = m_tasks.value(name).dependencies.size();
+    }
+    QStringList ready;
+    for (const QString& name : m_order) {
+        if (inDegree.value(name) == 0) {
+            ready.append(name);
+        }
+    }
+    int visited = 0;
+    while (!ready.isEmpty()) {
+        const QString current = ready.takeFirst();
+        ++visited;
+        for (const QString& name : m_order) {
+            if (m_tasks.value(name).dependencies.contains(current) && --inDegree[name] == 0) {
+                ready.append(name);
+            }
+        }
+    }
+    if (visited != m_order.size()) {
+        *error = "任务依赖存在环";
+        return false;
+    }
+    return true;
+}
+
+void StartupGraph::scheduleReadyTasks()
+{
+    for (const QString& name : m_order) {
+        TaskInfo& task = m_tasks[name];
+        if (task.state != TaskState::Pending) {
+            continue;
+        }
+
+        bool ready = true;
+        for (const QString& dependency : task.dependencies) {
+            const TaskState state = m_tasks.value(dependency).state;
+            // 非关键依赖失败后仍继续，关键依赖失败时该任务已被跳过
+            if (state != TaskState::Succeeded && state != TaskState::Failed) {
+                ready = false;
+                break;
+            }
+        }
+        if (!ready) {
+            continue;
+        }
+
+        task.state = TaskState::Running;
+        task.startMs = m_timer.elapsed();
+        runTask(name);
+    }
+}
+
+void StartupGraph::runTask(const QString& name)
+{
+    const std::function<bool()> function = m_tasks.value(name).function;
+
+    if (m_tasks.value(name).affinity == Affinity::Worker) {
+        m_workerFutures.append(QtConcurrent::run([this, name, function]() {
+            QString error;
+            const bool success = invokeTask(function, &error);
+            QMetaObject::invokeMethod(this, [this, name, success, error]() {
+                onTaskDone(name, success, error);
+            }, Qt::QueuedConnection);
+        }));
+    } else {
+        // 经事件循环派发，让已就绪的工作线程任务先开始，界面在等待期间也能重绘
+        QMetaObject::invokeMethod(this, [this, name, function]() {
+            QString error;
+            const bool success = invokeTask(function, &error);
+            onTaskDone(name, success, error);
+        }, Qt::QueuedConnection);
+    }
+}
+
+bool StartupGraph::invokeTask(const std::function<bool()>& function, QString* error)
+{
+    TRACE_SCOPE("startup", "StartupGraph::task");
+    try {
+        if (!function || function()) {
+            return true;
+        }
+        *error = "任务返回失败";
+    } catch (const std::exception& e) {
+        *error = QString::fromUtf8(e.what());
+    } catch (...) {
+        *error = "未知错误";
+    }
+    return false;
+}
+
+void StartupGraph::onTaskDone(const QString& name, bool success, const QString& error)
+{
+    TaskInfo& task = m_tasks[name];
+    task.state = success ? TaskState::Succeeded : TaskState::Failed;
+    task.finishMs = m_timer.elapsed();
+    task.error = error;
+    --m_remaining;
+
+    if (success) {
+        qDebug() << "StartupGraph: 任务" << name << "完成，耗时" << (task.finishMs - task.startMs) << "ms";
+    } else {
+        qWarning() << "StartupGraph: 任务" << name << "失败:" << error;
+        if (task.critical) {
+            m_failed = true;
+            skipDependents(name);
+        }
+    }
+    emit taskFinished(name, success, task.finishMs - task.startMs);
+
+    if (m_remaining == 0) {
+        emit finished(!m_failed);
+        return;
+    }
+    scheduleReadyTasks();
+}
+
+void StartupGraph::skipDependents(const QString& name)
+{
+    for (const QString& other : m_order) {
+        TaskInfo& task = m_tasks[other];
+        if (task.state == TaskState::Pending && task.dependencies.contains(name)) {
+            task.state = TaskState::Skipped;
+            task.error = QString("依赖的任务%1失败").arg(name);
+            --m_remaining;
+            emit taskFinished(other, false, 0);
+            skipDependents(other);
+        }
+    }
+}
+
+bool StartupGraph::waitFor(const QString& name)
+{
+    auto isDone = [this, &name]() {
+        const TaskState state = taskState(name);
+        return state == TaskState::Succeeded || state == TaskState::Failed || state == TaskState::Skipped;
+    };
+
+    if (!m_tasks.contains(name) || !m_started) {
+        return false;
+    }
+
+    if (!isDone()) {
+        QEventLoop loop;
+        connect(this, &StartupGraph::taskFinished, &loop, [&loop, &isDone]() {
+            if (isDone()) {
+                loop.quit();
+            }
+        });
+        loop.exec();
+    }
+    return taskState(name) == TaskState::Succeeded;
+}
+
+bool StartupGraph::isFinished() const
+{
+    return m_started && m_remaining == 0;
+}
+
+bool StartupGraph::hasFailed() const
+{
+    return m_failed;
+}
+
+StartupGraph::TaskState StartupGraph::taskState(const QString& name) const
+{
+    return m_tasks.value(name).state;
+}
+
+QString StartupGraph::taskError(const QString& name) const
+{
+    return m_tasks.value(name).error;
+}
+
+qint64 StartupGraph::elapsedMs() const
+{
+    return m_timer.isValid() ? m_timer.elapsed() : 0;
+}
+
+QList<StartupGraph::TaskInfo> StartupGraph::tasks() const
+{
+    QList<TaskInfo> result;
+    for (const QString& name : m_order) {
+        result.append(m_tasks.value(name));
+    }
+    return result;
+}
+
+QString StartupGraph::report() const
+{
+    static const char* const stateNames[] = {"等待", "运行中", "成功", "失败", "跳过"};
+
+    QStringList lines;
+    for (const QString& name : m_order) {
+        const TaskInfo& task = m_tasks[name];
+        QString line = QString("  %1 [%2] %3")
+                           .arg(name, -20)
+                           .arg(task.affinity == Affinity::Worker ? "工作线程" : "主线程")
+                           .arg(stateNames[static_cast<int>(task.state)]);
+        if (task.startMs >= 0 && task.finishMs >= 0) {
+            line += QString(" %1ms -> %2ms (%3ms)").arg(task.startMs).arg(task.finishMs).arg(task.finishMs - task.startMs);
+        }
+        if (!task.error.isEmpty()) {
+            line += " " + task.error;
+        }
+        lines.append(line);
+    }
+    return lines.join('\n');
+}
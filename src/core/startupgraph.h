@@ -0,0 +1,118 @@
+#ifndef STARTUPGRAPH_H
+#define STARTUPGRAPH_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <functional>
+
+/**
+ * @brief 启动任务图
+ *
+ * 每个任务声明依赖和运行位置（主线程或工作线程），依赖全部成功后立即开始，
+ * 互不依赖的任务并行执行。主线程任务通过事件循环派发，因此等待期间界面仍可响应。
+ * 关键任务失败时所有依赖它的任务被跳过；非关键任务失败只记录日志。
+ */
+class StartupGraph : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Affinity {
+        MainThread,  // 涉及QObject线程归属或界面的任务
+        Worker       // 纯计算或I/O，在全局线程池中执行
+    };
+
+    enum class TaskState {
+        Pending,
+        Running,
+        Succeeded,
+        Failed,
+        Skipped
+    };
+
+    struct TaskInfo {
+        QString name;
+        Affinity affinity = Affinity::MainThread;
+        QStringList dependencies;
+        std::function<bool()> function;
+        bool critical = true;
+        TaskState state = TaskState::Pending;
+        qint64 startMs = -1;   // 相对图启动时间
+        qint64 finishMs = -1;
+        QString error;
+    };
+
+    explicit StartupGraph(QObject* parent = nullptr);
+    ~StartupGraph();
+
+    /**
+     * @brief 添加任务（必须在start()之前调用）
+     * @param name 任务名，唯一
+     * @param affinity 运行位置
+     * @param dependencies 依赖的任务名
+     * @param function 任务函数，返回false或抛出异常表示失败
+     * @param critical 失败时是否跳过依赖它的任务
+     */
+    void addTask(const QString& name, Affinity affinity, const QStringList& dependencies,
+                 std::function<bool()> function, bool critical = true);
+
+    /**
+     * @brief 校验依赖并开始执行（在主线程调用）
+     * @return 依赖缺失或存在环时返回false，不执行任何任务
+     */
+    bool start();
+
+    /**
+     * @brief 运行局部事件循环直到指定任务结束
+     * @return 任务是否成功
+     */
+    bool waitFor(const QString& name);
+
+    bool isFinished() const;
+    bool hasFailed() const;
+    TaskState taskState(const QString& name) const;
+    QString taskError(const QString& name) const;
+
+    /**
+     * @brief 自图启动以来的毫秒数
+     */
+    qint64 elapsedMs() const;
+
+    /**
+     * @brief 各任务的状态和耗时，按添加顺序
+     */
+    QList<TaskInfo> tasks() const;
+
+    /**
+     * @brief 格式化的耗时报告，一行一个任务
+     */
+    QString report() const;
+
+signals:
+    void taskFinished(const QString& name, bool success, qint64 elapsedMs);
+    void finished(bool success);
+
+private:
+    void scheduleReadyTasks();
+    void runTask(const QString& name);
+    void onTaskDone(const QString& name, bool success, const QString& error);
+    void skipDependents(const QString& name);
+    bool validate(QString* error) const;
+
+    static bool invokeTask(const std::function<bool()>& function, QString* error);
+
+    QHash<QString, TaskInfo> m_tasks;
+    QStringList m_order;
+    QList<QFuture<void>> m_workerFutures;
+    QElapsedTimer m_timer;
+    int m_remaining;
+    bool m_started;
+    bool m_failed;
+};
+
+#endif // STARTUPGRAPH_H
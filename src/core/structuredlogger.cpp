@@ -172,6 +172,7 @@ void StructuredLogger::setCategoryFilter(const QStringList& categories)
 {
     QMutexLocker locker(&m_mutex);
     m_categoryFilter = categories;
+    m_categoryMask.setAllowList(categories);
 }
 
 void StructuredLogger::setConsoleOutput(bool enabled)
@@ -287,14 +288,19 @@ void StructuredLogger::rotateLogFile()
 bool StructuredLogger::shouldLog(LogLevel level, const QString& category) const
 {
     // 检查级别过滤
-    if (level < m_minLevel) {
+    if (level < m_minLevel.load(std::memory_order_relaxed)) {
         return false;
     }
     
-    // 检查类别过滤
-    if (!m_categoryFilter.isEmpty() && !m_categoryFilter.contains(category)) {
+    // 检查类别过滤：先查原子位图，只有溢出位上的类别才需要加锁精确比较
+    const int bit = LogCategoryMask::bitFor(category);
+    if (!m_categoryMask.isEnabled(bit)) {
         return false;
     }
+    if (bit == LogCategoryMask::OVERFLOW_BIT && !m_categoryMask.allEnabled()) {
+        QMutexLocker locker(&m_mutex);
+        return m_categoryFilter.contains(category);
+    }
     
     return true;
 }
@@ -10,7 +10,10 @@
 #include <QFile>
 #include <QTextStream>
 #include <QTimer>
+#include <atomic>
 #include "constants.h"
+#include "logcategorymask.h"
+#include "logmacros.h"
 
 // 日志类别声明
 Q_DECLARE_LOGGING_CATEGORY(tagCategory)
@@ -137,6 +140,15 @@ public:
             const QString& function = QString(), const QString& file = QString(),
             int line = 0, const QJsonObject& metadata = QJsonObject());
     
+    /**
+     * @brief 快速判断某级别、某类别的日志是否会被记录（只读原子变量，供日志宏在求值参数前调用）
+     * @param level 日志级别
+     * @param categoryBit LogCategoryMask::bitFor()返回的类别位
+     */
+    bool isEnabled(LogLevel level, int categoryBit) const {
+        return level >= m_minLevel.load(std::memory_order_relaxed) && m_categoryMask.isEnabled(categoryBit);
+    }
+    
     /**
      * @brief 设置日志级别过滤
      * @param minLevel 最小日志级别
@@ -233,8 +245,9 @@ private:
     mutable QMutex m_mutex;
     
     // 配置
-    LogLevel m_minLevel;
+    std::atomic<LogLevel> m_minLevel;
     QStringList m_categoryFilter;
+    LogCategoryMask m_categoryMask;  // m_categoryFilter的原子位图缓存
     bool m_consoleOutput;
     bool m_fileOutput;
     bool m_jsonFormat;
@@ -292,4 +305,14 @@ private:
                                      QString("Performance: %1 took %2ms").arg(operation).arg(duration), \
                                      Q_FUNC_INFO, __FILE__, __LINE__, metadata)
 
+// 带编译期裁剪的日志宏（见logmacros.h），消息参数只在启用时求值；类别必须是常量
+#define SLOG_LOG(levelValue, level, category, message) \
+    LOG_GATED_CALL(levelValue, StructuredLogger::instance(), level, category, \
+                   log(level, category, (message), Q_FUNC_INFO, __FILE__, __LINE__))
+
+#define SLOG_DEBUG(category, message) SLOG_LOG(LOG_LEVEL_DEBUG, LogLevel::Debug, category, message)
+#define SLOG_INFO(category, message) SLOG_LOG(LOG_LEVEL_INFO, LogLevel::Info, category, message)
+#define SLOG_WARNING(category, message) SLOG_LOG(LOG_LEVEL_WARNING, LogLevel::Warning, category, message)
+#define SLOG_CRITICAL(category, message) SLOG_LOG(LOG_LEVEL_CRITICAL, LogLevel::Critical, category, message)
+
 #endif // STRUCTUREDLOGGER_H
\ No newline at end of file
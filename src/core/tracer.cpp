@@ -0,0 +1,315 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QDebug>
+#include <chrono>
+#include <vector>
+
+Tracer* Tracer::s_instance = nullptr;
+QMutex Tracer::s_instanceMutex;
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+// 每个线程最多保留的事件数（每个事件32字节，约1MB）
+const size_t EVENTS_PER_THREAD = 32768;
+// 最多追踪的线程数，超出后新线程的事件被忽略
+const int MAX_TRACED_THREADS = 256;
+
+struct TraceEvent
+{
+    const char* category;
+    const char* name;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+/**
+ * @brief 线程事件缓冲区
+ * @details 只有所属线程写入，导出和清空时由其他线程加锁读取；
+ *          锁在记录时几乎不会被争用。缓冲区在进程内常驻，线程退出后事件仍可导出。
+ */
+struct ThreadBuffer
+{
+    QMutex mutex;
+    std::vector<TraceEvent> events;  // 首次记录时分配
+    size_t next = 0;
+    bool wrapped = false;
+    int tid = 0;
+    QString threadName;
+};
+
+struct Registry
+{
+    QMutex mutex;
+    std::vector<ThreadBuffer*> buffers;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer* registerCurrentThread()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    if (static_cast<int>(reg.buffers.size()) >= MAX_TRACED_THREADS) {
+        return nullptr;
+    }
+
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->tid = static_cast<int>(reg.buffers.size()) + 1;
+
+    QThread* thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        buffer->threadName = "Main";
+    } else if (thread && !thread->objectName().isEmpty()) {
+        buffer->threadName = thread->objectName();
+    } else {
+        buffer->threadName = QString("Thread %1").arg(buffer->tid);
+    }
+
+    reg.buffers.push_back(buffer);
+    return buffer;
+}
+
+ThreadBuffer* currentThreadBuffer()
+{
+    static thread_local ThreadBuffer* buffer = nullptr;
+    static thread_local bool registered = false;
+    if (!registered) {
+        buffer = registerCurrentThread();
+        registered = true;
+    }
+    return buffer;
+}
+
+void appendJsonString(QByteArray& out, const QByteArray& text)
+{
+    out.append('"');
+    for (char c : text) {
+        switch (c) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out.append(' ');
+            } else {
+                out.append(c);
+            }
+            break;
+        }
+    }
+    out.append('"');
+}
+
+} // namespace
+
+Tracer* Tracer::instance()
+{
+    QMutexLocker locker(&s_instanceMutex);
+    if (!s_instance) {
+        s_instance = new Tracer();
+    }
+    return s_instance;
+}
+
+void Tracer::cleanup()
+{
+    QMutexLocker locker(&s_instanceMutex);
+    if (!s_instance) {
+        return;
+    }
+
+    s_instance->stop();
+    const QString path = s_instance->exportPath();
+    if (!path.isEmpty()) {
+        s_instance->exportChromeTrace(path);
+    }
+    s_instance->clear();
+
+    delete s_instance;
+    s_instance = nullptr;
+}
+
+Tracer::Tracer()
+{
+}
+
+Tracer::~Tracer()
+{
+}
+
+qint64 Tracer::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::record(const char* category, const char* name, qint64 startNs, qint64 endNs)
+{
+    ThreadBuffer* buffer = currentThreadBuffer();
+    if (!buffer) {
+        return;
+    }
+
+    QMutexLocker locker(&buffer->mutex);
+    if (buffer->events.empty()) {
+        buffer->events.resize(EVENTS_PER_THREAD);
+    }
+
+    TraceEvent& event = buffer->events[buffer->next];
+    event.category = category;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+
+    if (++buffer->next == buffer->events.size()) {
+        buffer->next = 0;
+        buffer->wrapped = true;
+    }
+}
+
+void Tracer::start(const QString& exportPath)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_exportPath = exportPath;
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+    qDebug() << "Tracer: 开始记录性能追踪，导出路径:" << exportPath;
+}
+
+void Tracer::stop()
+{
+    s_enabled.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::clear()
+{
+    Registry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (ThreadBuffer* buffer : reg.buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        std::vector<TraceEvent>().swap(buffer->events);
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+}
+
+bool Tracer::exportChromeTrace(const QString& filePath)
+{
+    // 先逐个线程复制事件，写文件时不持有任何缓冲区的锁
+    struct ThreadEvents {
+        int tid;
+        QString threadName;
+        std::vector<TraceEvent> events;
+    };
+    std::vector<ThreadEvents> snapshot;
+    qint64 originNs = -1;
+    {
+        Registry& reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        for (ThreadBuffer* buffer : reg.buffers) {
+            QMutexLocker bufferLocker(&buffer->mutex);
+            ThreadEvents thread;
+            thread.tid = buffer->tid;
+            thread.threadName = buffer->threadName;
+            if (buffer->wrapped) {
+                thread.events.assign(buffer->events.begin() + buffer->next, buffer->events.end());
+            }
+            thread.events.insert(thread.events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next);
+            for (const TraceEvent& event : thread.events) {
+                if (originNs < 0 || event.startNs < originNs) {
+                    originNs = event.startNs;
+                }
+            }
+            snapshot.push_back(std::move(thread));
+        }
+    }
+
+    QByteArray json;
+    json.reserve(1024 * 1024);
+    json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    bool first = true;
+    size_t eventCount = 0;
+    for (const ThreadEvents& thread : snapshot) {
+        // 线程名元数据，Perfetto据此标注每条轨道
+        json.append(first ? "\n" : ",\n");
+        first = false;
+        json.append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":").append(pid);
+        json.append(",\"tid\":").append(QByteArray::number(thread.tid));
+        json.append(",\"args\":{\"name\":");
+        appendJsonString(json, thread.threadName.toUtf8());
+        json.append("}}");
+
+        for (const TraceEvent& event : thread.events) {
+            json.append(",\n{\"ph\":\"X\",\"name\":");
+            appendJsonString(json, QByteArray(event.name));
+            json.append(",\"cat\":");
+            appendJsonString(json, QByteArray(event.category));
+            json.append(",\"pid\":").append(pid);
+            json.append(",\"tid\":").append(QByteArray::number(thread.tid));
+            // Chrome追踪格式的时间单位为微秒
+            json.append(",\"ts\":").append(QByteArray::number((event.startNs - originNs) / 1000.0, 'f', 3));
+            json.append(",\"dur\":").append(QByteArray::number(event.durationNs / 1000.0, 'f', 3));
+            json.append('}');
+        }
+        eventCount += thread.events.size();
+    }
+    json.append("\n]}\n");
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Tracer: 无法写入追踪文件:" << filePath;
+        return false;
+    }
+    file.write(json);
+    if (!file.commit()) {
+        qWarning() << "Tracer: 保存追踪文件失败:" << filePath;
+        return false;
+    }
+
+    qDebug() << "Tracer: 导出" << eventCount << "个事件到" << filePath;
+    return true;
+}
+
+QString Tracer::exportSnapshot()
+{
+    QString basePath = exportPath();
+    if (basePath.isEmpty()) {
+        basePath = QDir::temp().filePath("musicplayer-trace.json");
+    }
+
+    const QFileInfo info(basePath);
+    const QString snapshotPath = info.absoluteDir().filePath(
+        QString("%1-%2.json").arg(info.completeBaseName(),
+                                  QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss")));
+    return exportChromeTrace(snapshotPath) ? snapshotPath : QString();
+}
+
+QString Tracer::exportPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_exportPath;
+}
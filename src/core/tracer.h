@@ -0,0 +1,148 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QMutex>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief 作用域追踪
+ *
+ * - 每个线程写自己的环形缓冲区（满后覆盖最旧的事件），线程之间不争用；
+ * - 时间戳取单调时钟的纳秒值；
+ * - 未启用时TRACE_SCOPE只读取一次原子变量，定义MUSICPLAYER_NO_TRACING后完全不生成代码；
+ * - 按需导出为Chrome/Perfetto可加载的JSON（chrome://tracing 或 ui.perfetto.dev）。
+ *
+ * 事件名和类别只保存指针，必须是字符串字面量或Q_FUNC_INFO等静态存储的字符串。
+ */
+class Tracer
+{
+public:
+    /**
+     * @brief 获取单例实例
+     */
+    static Tracer* instance();
+
+    /**
+     * @brief 停止记录，若设置了导出路径则导出，然后释放实例
+     */
+    static void cleanup();
+
+    /**
+     * @brief 是否正在记录（热路径检查，只读取一次原子变量）
+     */
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 单调时钟当前时间（纳秒）
+     */
+    static qint64 nowNs();
+
+    /**
+     * @brief 记录一个已结束的作用域
+     * @param category 类别（静态字符串）
+     * @param name 名称（静态字符串）
+     * @param startNs 开始时间
+     * @param endNs 结束时间
+     */
+    static void record(const char* category, const char* name, qint64 startNs, qint64 endNs);
+
+    /**
+     * @brief 开始记录
+     * @param exportPath 退出时的导出路径，为空则只能按需导出
+     */
+    void start(const QString& exportPath = QString());
+
+    /**
+     * @brief 停止记录（已记录的事件保留，仍可导出）
+     */
+    void stop();
+
+    /**
+     * @brief 清空所有线程的事件并释放缓冲区
+     */
+    void clear();
+
+    /**
+     * @brief 导出为Chrome追踪JSON
+     * @param filePath 文件路径
+     * @return 导出是否成功
+     */
+    bool exportChromeTrace(const QString& filePath);
+
+    /**
+     * @brief 按需导出一份快照，文件名在导出路径后加时间戳
+     * @return 导出的文件路径，失败返回空字符串
+     */
+    QString exportSnapshot();
+
+    /**
+     * @brief 退出时的导出路径
+     */
+    QString exportPath() const;
+
+private:
+    Tracer();
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    static Tracer* s_instance;
+    static QMutex s_instanceMutex;
+    static std::atomic<bool> s_enabled;
+
+    mutable QMutex m_mutex;
+    QString m_exportPath;
+};
+
+/**
+ * @brief 作用域追踪对象，析构时记录一个完整事件
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char* category, const char* name)
+        : m_category(category)
+        , m_name(name)
+        , m_startNs(Tracer::isEnabled() ? Tracer::nowNs() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (m_startNs >= 0) {
+            Tracer::record(m_category, m_name, m_startNs, Tracer::nowNs());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    qint64 m_startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef MUSICPLAYER_NO_TRACING
+#  define TRACE_SCOPE(category, name) do {} while (0)
+#  define TRACE_FUNCTION(category) do {} while (0)
+#else
+/**
+ * @brief 追踪当前作用域
+ * @param category 类别字面量，如"audio"、"database"、"ui"
+ * @param name 名称字面量
+ */
+#  define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(category, name)
+/**
+ * @brief 以函数签名为名称追踪当前函数
+ */
+#  define TRACE_FUNCTION(category) TRACE_SCOPE(category, Q_FUNC_INFO)
+#endif
+
+#endif // TRACER_H
@@ -7,9 +7,22 @@
 #include <QString>
 #include <QVariant>
 #include <QDebug>
+#include "../core/tracer.h"
+#include "../core/metricsregistry.h"
 
 class DatabaseManager;
 
+/**
+ * @brief DAO方法入口的追踪和耗时统计
+ * @details 记录追踪范围，并把耗时（微秒）记入直方图db.query_us.<类名>.<方法名>；
+ *          直方图指针在每个调用点只查找一次。
+ */
+#define DAO_QUERY_SCOPE() \
+    TRACE_FUNCTION("database"); \
+    static MetricHistogram* const daoQueryHistogram = MetricsRegistry::histogram( \
+        QStringLiteral("db.query_us.%1.%2").arg(QLatin1String(metaObject()->className()), QLatin1String(__func__))); \
+    MetricTimer daoQueryTimer(daoQueryHistogram)
+
 /**
  * @brief DAO基类
  * 
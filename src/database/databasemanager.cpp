@@ -1,7 +1,11 @@
 #include "databasemanager.h"
+#include "logdao.h"
+#include "playstatsdao.h"
+#include "../core/constants.h"
 #include <QDir>
 #include <QStandardPaths>
 #include <QMutexLocker>
+#include <QThread>
 #include <QDebug>
 #include <QSqlRecord>
 #include <QVariant>
@@ -22,7 +26,13 @@ DatabaseManager* DatabaseManager::instance()
 
 DatabaseManager::DatabaseManager(QObject* parent)
     : QObject(parent)
+    , m_connectionThread(nullptr)
     , m_initialized(false)
+    , m_logDatabaseAttached(false)
+    , m_writingErrorLog(false)
+    , m_logRetentionDays(Constants::Logging::LOG_RETENTION_DAYS)
+    , m_logRetentionMaxBytes(qint64(Constants::Logging::LOG_DATABASE_MAX_SIZE_MB) * 1024 * 1024)
+    , m_logRetentionTimer(nullptr)
 {
     qDebug() << "DatabaseManager 构造函数";
 }
@@ -66,8 +76,13 @@ bool DatabaseManager::initialize(const QString& dbPath)
     qDebug() << "数据库连接成功";
     
     // 在数据库连接打开后立即设置初始化标志
+    m_databasePath = dbPath;
+    m_connectionThread = QThread::currentThread();
     m_initialized = true;
     
+    // 日志写在独立的库文件中，不与播放历史等写入争用主库；附加失败时仅禁用数据库日志
+    m_logDatabaseAttached = attachLogDatabase(dbPath);
+    
     // 创建表结构
     if (!createTables()) {
         logError("创建数据库表失败");
@@ -102,6 +117,12 @@ bool DatabaseManager::isValid() const
         return false;
     }
     
+    // 连接正在其他线程中初始化或交接
+    if (!isConnectionThread()) {
+        qDebug() << "DatabaseManager::isValid() - 数据库连接不属于当前线程";
+        return false;
+    }
+    
     QSqlDatabase db = QSqlDatabase::database(CONNECTION_NAME);
     if (!db.isValid()) {
         qDebug() << "DatabaseManager::isValid() - 数据库连接无效";
@@ -117,6 +138,11 @@ bool DatabaseManager::isValid() const
     return true;
 }
 
+bool DatabaseManager::isConnectionThread() const
+{
+    return m_connectionThread.load() == QThread::currentThread();
+}
+
 QSqlDatabase DatabaseManager::database() const
 {
     return QSqlDatabase::database(CONNECTION_NAME);
@@ -159,6 +185,12 @@ void DatabaseManager::closeDatabase()
 {
     // 先重置初始化标志
     m_initialized = false;
+    m_logDatabaseAttached = false;
+    m_connectionThread = nullptr;
+    
+    if (m_logRetentionTimer) {
+        m_logRetentionTimer->stop();
+    }
     
     if (m_database.isOpen()) {
         m_database.close();
@@ -167,6 +199,83 @@ void DatabaseManager::closeDatabase()
     QSqlDatabase::removeDatabase(CONNECTION_NAME);
 }
 
+void DatabaseManager::releaseConnection()
+{
+    m_connectionThread = nullptr;
+    m_logDatabaseAttached = false;
+    
+    if (m_database.isOpen()) {
+        m_database.close();
+    }
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+    qDebug() << "DatabaseManager: 已释放当前线程的数据库连接";
+}
+
+bool DatabaseManager::reopenConnection()
+{
+    if (!m_initialized || m_databasePath.isEmpty()) {
+        logError("重新打开数据库失败: 数据库未初始化");
+        return false;
+    }
+    
+    m_database = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+    m_database.setDatabaseName(m_databasePath);
+    if (!m_database.open()) {
+        m_lastError = m_database.lastError().text();
+        qCritical() << "DatabaseManager: 无法重新打开数据库:" << m_lastError;
+        return false;
+    }
+    
+    m_connectionThread = QThread::currentThread();
+    m_logDatabaseAttached = attachLogDatabase(m_databasePath);
+    qDebug() << "DatabaseManager: 数据库连接已在当前线程打开";
+    return true;
+}
+
+void DatabaseManager::warmUpFileCache(const QString& dbPath)
+{
+    const QString connectionName = QString("WarmUp_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(dbPath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (db.open()) {
+            // 与主窗口首次加载读取相同的表，只遍历不保留结果
+            const QStringList statements = {
+                "SELECT id, name, color, is_system FROM tags",
+                "SELECT song_id, tag_id FROM song_tags",
+                "SELECT id, title, artist, album, duration, file_path FROM songs",
+            };
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            for (const QString& sql : statements) {
+                if (query.exec(sql)) {
+                    while (query.next()) {
+                    }
+                }
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool DatabaseManager::attachLogDatabaseTo(QSqlDatabase& connection, const QString& dbPath)
+{
+    const QString logDbPath = QFileInfo(dbPath).absoluteDir().filePath(Constants::Logging::LOG_DATABASE_FILE);
+    
+    QSqlQuery query(connection);
+    query.prepare(QString("ATTACH DATABASE ? AS %1").arg(Constants::Logging::LOG_DATABASE_ALIAS));
+    query.addBindValue(logDbPath);
+    if (!query.exec()) {
+        qWarning() << "DatabaseManager: 无法在独立连接上附加日志库:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 bool DatabaseManager::createTables()
 {
     qDebug() << "开始创建数据库表";
@@ -187,7 +296,15 @@ bool DatabaseManager::createTables()
         return false;
     }
     
-    if (!createLogsTable()) {
+    if (!createPlaylistsTables()) {
+        return false;
+    }
+    
+    if (!createSmartPlaylistChangeLog()) {
+        return false;
+    }
+    
+    if (m_logDatabaseAttached && !createLogPartitionTables()) {
         return false;
     }
     
@@ -226,7 +343,8 @@ bool DatabaseManager::createSongsTable()
         "CREATE INDEX IF NOT EXISTS idx_songs_title ON songs(title)",
         "CREATE INDEX IF NOT EXISTS idx_songs_artist ON songs(artist)",
         "CREATE INDEX IF NOT EXISTS idx_songs_file_path ON songs(file_path)",
-        "CREATE INDEX IF NOT EXISTS idx_songs_date_added ON songs(date_added)"
+        "CREATE INDEX IF NOT EXISTS idx_songs_date_added ON songs(date_added)",
+        "CREATE INDEX IF NOT EXISTS idx_songs_rating ON songs(rating)"
     };
     
     for (const QString& indexSQL : indexes) {
@@ -336,44 +454,509 @@ bool DatabaseManager::createPlayHistoryTable()
         }
     }
 
+    if (!createPlayStatisticsTables()) {
+        return false;
+    }
+
     qDebug() << "play_history表创建成功";
     return true;
 }
 
-bool DatabaseManager::createLogsTable()
+bool DatabaseManager::createPlayStatisticsTables()
+{
+    // 按天的表以(day, song_id)为主键，"本周最多播放"只读取7天内的行
+    const QStringList tables = {
+        R"(
+        CREATE TABLE IF NOT EXISTS play_stats_song (
+            song_id INTEGER PRIMARY KEY,
+            play_count INTEGER NOT NULL DEFAULT 0,
+            first_played_at DATETIME,
+            last_played_at DATETIME
+        )
+        )",
+        R"(
+        CREATE TABLE IF NOT EXISTS play_stats_daily (
+            day TEXT NOT NULL,
+            song_id INTEGER NOT NULL,
+            play_count INTEGER NOT NULL DEFAULT 0,
+            PRIMARY KEY (day, song_id)
+        ) WITHOUT ROWID
+        )",
+        R"(
+        CREATE TABLE IF NOT EXISTS play_stats_day (
+            day TEXT PRIMARY KEY,
+            play_count INTEGER NOT NULL DEFAULT 0
+        ) WITHOUT ROWID
+        )",
+        R"(
+        CREATE TABLE IF NOT EXISTS play_stats_artist (
+            artist TEXT PRIMARY KEY,
+            play_count INTEGER NOT NULL DEFAULT 0,
+            last_played_at DATETIME
+        )
+        )",
+        "CREATE INDEX IF NOT EXISTS idx_play_stats_song_count ON play_stats_song(play_count)",
+        "CREATE INDEX IF NOT EXISTS idx_play_stats_song_last_played ON play_stats_song(last_played_at)",
+        "CREATE INDEX IF NOT EXISTS idx_play_stats_daily_song ON play_stats_daily(song_id)",
+        "CREATE INDEX IF NOT EXISTS idx_play_stats_artist_count ON play_stats_artist(play_count)"
+    };
+
+    for (const QString& tableSQL : tables) {
+        if (!executeUpdate(tableSQL)) {
+            logError("创建播放统计表失败: " + tableSQL);
+            return false;
+        }
+    }
+
+    QSqlQuery query(database());
+    query.exec("SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = 'trg_play_history_insert_stats'");
+    if (query.next()) {
+        return true;
+    }
+    query.finish();
+
+    // played_at为空时按当前本地时间计，与QDateTime写入的本地ISO格式保持一致
+    const QString playedAt = "COALESCE(NEW.played_at, strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime'))";
+    const QStringList triggers = {
+        QString(R"(
+        CREATE TRIGGER IF NOT EXISTS trg_play_history_insert_stats
+        AFTER INSERT ON play_history
+        BEGIN
+            INSERT INTO play_stats_song (song_id, play_count, first_played_at, last_played_at)
+            VALUES (NEW.song_id, 1, %1, %1)
+            ON CONFLICT(song_id) DO UPDATE SET
+                play_count = play_count + 1,
+                first_played_at = MIN(first_played_at, excluded.first_played_at),
+                last_played_at = MAX(last_played_at, excluded.last_played_at);
+            INSERT INTO play_stats_daily (day, song_id, play_count)
+            VALUES (date(%1), NEW.song_id, 1)
+            ON CONFLICT(day, song_id) DO UPDATE SET play_count = play_count + 1;
+            INSERT INTO play_stats_day (day, play_count)
+            VALUES (date(%1), 1)
+            ON CONFLICT(day) DO UPDATE SET play_count = play_count + 1;
+            INSERT INTO play_stats_artist (artist, play_count, last_played_at)
+            VALUES (COALESCE((SELECT NULLIF(TRIM(artist), '') FROM songs WHERE id = NEW.song_id), '%2'), 1, %1)
+            ON CONFLICT(artist) DO UPDATE SET
+                play_count = play_count + 1,
+                last_played_at = MAX(last_played_at, excluded.last_played_at);
+        END
+        )").arg(playedAt, PlayStatsDao::UNKNOWN_ARTIST),
+        // 删除歌曲时去掉它的按歌曲统计；按天总数和艺术家统计保留
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_songs_delete_play_stats
+        AFTER DELETE ON songs
+        BEGIN
+            DELETE FROM play_stats_song WHERE song_id = OLD.id;
+            DELETE FROM play_stats_daily WHERE song_id = OLD.id;
+        END
+        )"
+    };
+
+    QSqlDatabase db = database();
+    if (!db.transaction()) {
+        logError("创建播放统计触发器失败: 无法开始事务");
+        return false;
+    }
+
+    for (const QString& triggerSQL : triggers) {
+        if (!executeUpdate(triggerSQL)) {
+            db.rollback();
+            logError("创建播放统计触发器失败");
+            return false;
+        }
+    }
+
+    // 回填：按现有播放历史汇总一次
+    for (const QString& rebuildSQL : PlayStatsDao::rebuildStatements()) {
+        if (!executeUpdate(rebuildSQL)) {
+            db.rollback();
+            logError("回填播放统计失败");
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        db.rollback();
+        logError("提交播放统计触发器失败: " + db.lastError().text());
+        return false;
+    }
+
+    qDebug() << "播放统计表和触发器创建成功";
+    return true;
+}
+
+bool DatabaseManager::createPlaylistsTables()
 {
-    const QString createLogsSQL = R"(
-        CREATE TABLE IF NOT EXISTS logs (
+    const QString createPlaylistsSQL = R"(
+        CREATE TABLE IF NOT EXISTS playlists (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
-            level TEXT NOT NULL,
-            message TEXT NOT NULL,
-            category TEXT,
-            timestamp DATETIME DEFAULT CURRENT_TIMESTAMP
+            name TEXT NOT NULL UNIQUE,
+            description TEXT,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            modified_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            last_played_at DATETIME,
+            song_count INTEGER DEFAULT 0,
+            total_duration INTEGER DEFAULT 0,
+            play_count INTEGER DEFAULT 0,
+            color TEXT,
+            icon_path TEXT,
+            is_smart_playlist INTEGER DEFAULT 0,
+            smart_criteria TEXT,
+            is_system_playlist INTEGER DEFAULT 0,
+            is_favorite INTEGER DEFAULT 0,
+            sort_order INTEGER DEFAULT 0
         )
     )";
-    
-    if (!executeUpdate(createLogsSQL)) {
-        logError("创建logs表失败");
+
+    if (!executeUpdate(createPlaylistsSQL)) {
+        logError("创建playlists表失败");
         return false;
     }
-    
-    // 创建索引
+
+    // sort_order是带间隔的排序键（见PlaylistDao），插入、移动和删除只改动一行
+    const QString createPlaylistSongsSQL = R"(
+        CREATE TABLE IF NOT EXISTS playlist_songs (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            playlist_id INTEGER NOT NULL,
+            song_id INTEGER NOT NULL,
+            sort_order INTEGER NOT NULL DEFAULT 0,
+            added_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            FOREIGN KEY (playlist_id) REFERENCES playlists(id) ON DELETE CASCADE,
+            FOREIGN KEY (song_id) REFERENCES songs(id) ON DELETE CASCADE,
+            UNIQUE(playlist_id, song_id)
+        )
+    )";
+
+    if (!executeUpdate(createPlaylistSongsSQL)) {
+        logError("创建playlist_songs表失败");
+        return false;
+    }
+
+    // 创建索引：按(playlist_id, sort_order)顺序读取和查找相邻歌曲
     const QStringList indexes = {
-        "CREATE INDEX IF NOT EXISTS idx_logs_level ON logs(level)",
-        "CREATE INDEX IF NOT EXISTS idx_logs_timestamp ON logs(timestamp)"
+        "CREATE INDEX IF NOT EXISTS idx_playlist_songs_order ON playlist_songs(playlist_id, sort_order)",
+        "CREATE INDEX IF NOT EXISTS idx_playlist_songs_song_id ON playlist_songs(song_id)"
     };
-    
+
     for (const QString& indexSQL : indexes) {
         if (!executeUpdate(indexSQL)) {
-            logError("创建logs表索引失败: " + indexSQL);
+            logError("创建playlist_songs表索引失败: " + indexSQL);
+            return false;
+        }
+    }
+
+    if (!createPlaylistStatisticsTriggers()) {
+        return false;
+    }
+
+    qDebug() << "playlists表创建成功";
+    return true;
+}
+
+bool DatabaseManager::createPlaylistStatisticsTriggers()
+{
+    QSqlQuery query(database());
+    query.exec("SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = 'trg_playlist_songs_insert_stats'");
+    if (query.next()) {
+        return true;
+    }
+    query.finish();
+
+    // modified_at与QDateTime写入的本地ISO格式保持一致
+    const QStringList triggers = {
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_playlist_songs_insert_stats
+        AFTER INSERT ON playlist_songs
+        BEGIN
+            UPDATE playlists SET
+                song_count = song_count + 1,
+                total_duration = total_duration + COALESCE((SELECT duration FROM songs WHERE id = NEW.song_id), 0),
+                modified_at = strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime')
+            WHERE id = NEW.playlist_id;
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_playlist_songs_delete_stats
+        AFTER DELETE ON playlist_songs
+        BEGIN
+            UPDATE playlists SET
+                song_count = song_count - 1,
+                total_duration = total_duration - COALESCE((SELECT duration FROM songs WHERE id = OLD.song_id), 0),
+                modified_at = strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime')
+            WHERE id = OLD.playlist_id;
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_playlist_songs_update_stats
+        AFTER UPDATE OF playlist_id, song_id ON playlist_songs
+        BEGIN
+            UPDATE playlists SET
+                song_count = song_count - 1,
+                total_duration = total_duration - COALESCE((SELECT duration FROM songs WHERE id = OLD.song_id), 0)
+            WHERE id = OLD.playlist_id;
+            UPDATE playlists SET
+                song_count = song_count + 1,
+                total_duration = total_duration + COALESCE((SELECT duration FROM songs WHERE id = NEW.song_id), 0)
+            WHERE id = NEW.playlist_id;
+        END
+        )",
+        // 歌曲时长变化时修正包含它的播放列表（同一列表中同一首歌只有一行）
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_songs_duration_playlist_stats
+        AFTER UPDATE OF duration ON songs
+        WHEN COALESCE(NEW.duration, 0) != COALESCE(OLD.duration, 0)
+        BEGIN
+            UPDATE playlists SET
+                total_duration = total_duration + COALESCE(NEW.duration, 0) - COALESCE(OLD.duration, 0)
+            WHERE id IN (SELECT playlist_id FROM playlist_songs WHERE song_id = NEW.id);
+        END
+        )",
+        // 连接未开启外键约束，删除歌曲时在歌曲行仍存在时移除关联行，由上面的触发器扣减统计
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_songs_delete_playlist_songs
+        BEFORE DELETE ON songs
+        BEGIN
+            DELETE FROM playlist_songs WHERE song_id = OLD.id;
+        END
+        )"
+    };
+
+    QSqlDatabase db = database();
+    if (!db.transaction()) {
+        logError("创建播放列表统计触发器失败: 无法开始事务");
+        return false;
+    }
+
+    for (const QString& triggerSQL : triggers) {
+        if (!executeUpdate(triggerSQL)) {
+            db.rollback();
+            logError("创建播放列表统计触发器失败");
+            return false;
+        }
+    }
+
+    // 回填：清理指向已删除歌曲的关联行，再按现有数据重算一次
+    const QStringList backfill = {
+        "DELETE FROM playlist_songs WHERE song_id NOT IN (SELECT id FROM songs)",
+        R"(
+        UPDATE playlists SET
+            song_count = (SELECT COUNT(*) FROM playlist_songs ps WHERE ps.playlist_id = playlists.id),
+            total_duration = (SELECT COALESCE(SUM(s.duration), 0) FROM playlist_songs ps
+                              INNER JOIN songs s ON s.id = ps.song_id
+                              WHERE ps.playlist_id = playlists.id)
+        )"
+    };
+
+    for (const QString& backfillSQL : backfill) {
+        if (!executeUpdate(backfillSQL)) {
+            db.rollback();
+            logError("回填播放列表统计失败");
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        db.rollback();
+        logError("提交播放列表统计触发器失败: " + db.lastError().text());
+        return false;
+    }
+
+    qDebug() << "播放列表统计触发器创建成功";
+    return true;
+}
+
+bool DatabaseManager::createSmartPlaylistChangeLog()
+{
+    const QString createChangesSQL = R"(
+        CREATE TABLE IF NOT EXISTS smart_playlist_changes (
+            seq INTEGER PRIMARY KEY AUTOINCREMENT,
+            song_id INTEGER NOT NULL
+        )
+    )";
+
+    if (!executeUpdate(createChangesSQL)) {
+        logError("创建smart_playlist_changes表失败");
+        return false;
+    }
+
+    // 智能播放列表的缓存只在内存中，启动时之前的变更都已无用
+    if (!executeUpdate("DELETE FROM smart_playlist_changes")) {
+        logError("清理smart_playlist_changes表失败");
+        return false;
+    }
+
+    // 只记录规则会用到的列；play_stats_song由play_history的插入触发器更新，
+    // 写线程记录的播放也会经由它写入变更
+    const QStringList triggers = {
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_songs_insert_smart_changes
+        AFTER INSERT ON songs
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (NEW.id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_songs_update_smart_changes
+        AFTER UPDATE OF title, artist, album, duration, rating, date_added ON songs
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (NEW.id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_songs_delete_smart_changes
+        AFTER DELETE ON songs
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (OLD.id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_song_tags_insert_smart_changes
+        AFTER INSERT ON song_tags
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (NEW.song_id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_song_tags_delete_smart_changes
+        AFTER DELETE ON song_tags
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (OLD.song_id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_play_stats_song_insert_smart_changes
+        AFTER INSERT ON play_stats_song
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (NEW.song_id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_play_stats_song_update_smart_changes
+        AFTER UPDATE ON play_stats_song
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (NEW.song_id);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_play_stats_song_delete_smart_changes
+        AFTER DELETE ON play_stats_song
+        BEGIN
+            INSERT INTO smart_playlist_changes (song_id) VALUES (OLD.song_id);
+        END
+        )"
+    };
+
+    for (const QString& triggerSQL : triggers) {
+        if (!executeUpdate(triggerSQL)) {
+            logError("创建智能播放列表变更触发器失败");
+            return false;
+        }
+    }
+
+    qDebug() << "智能播放列表变更日志创建成功";
+    return true;
+}
+
+bool DatabaseManager::attachLogDatabase(const QString& dbPath)
+{
+    const QString logDbPath = QFileInfo(dbPath).absoluteDir().filePath(Constants::Logging::LOG_DATABASE_FILE);
+    const QString alias = Constants::Logging::LOG_DATABASE_ALIAS;
+    
+    QSqlQuery query(database());
+    query.prepare(QString("ATTACH DATABASE ? AS %1").arg(alias));
+    query.addBindValue(logDbPath);
+    if (!query.exec()) {
+        logError("无法附加日志库: " + query.lastError().text());
+        return false;
+    }
+    
+    // 必须在日志库建第一张表之前设置，已有的库文件不受影响
+    if (!query.exec(QString("PRAGMA %1.auto_vacuum = INCREMENTAL").arg(alias))) {
+        qWarning() << "设置日志库auto_vacuum失败:" << query.lastError().text();
+    }
+    
+    qDebug() << "日志库已附加:" << logDbPath;
+    return true;
+}
+
+bool DatabaseManager::createLogPartitionTables()
+{
+    // 每个分区一行：按天的日志表（logdb.logs_yyyyMMdd）或旧版的main.logs
+    // first_id/last_id 用于按ID定位分区，row_count/byte_count 供计数和按大小清理
+    const QString createPartitionsSQL = QString(R"(
+        CREATE TABLE IF NOT EXISTS %1.log_partitions (
+            table_name TEXT PRIMARY KEY,
+            day TEXT NOT NULL,
+            first_id INTEGER NOT NULL DEFAULT 0,
+            last_id INTEGER NOT NULL DEFAULT 0,
+            row_count INTEGER NOT NULL DEFAULT 0,
+            byte_count INTEGER NOT NULL DEFAULT 0,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )").arg(Constants::Logging::LOG_DATABASE_ALIAS);
+    
+    if (!executeUpdate(createPartitionsSQL)) {
+        logError("创建log_partitions表失败");
+        return false;
+    }
+    
+    // 旧版本写在主库logs表中的日志作为一个只读分区登记，
+    // day取其最后一条日志的日期，全部过期后整表删除
+    QSqlQuery query(database());
+    query.exec("SELECT 1 FROM main.sqlite_master WHERE type = 'table' AND name = 'logs'");
+    if (query.next()) {
+        const QString registerLegacySQL = QString(R"(
+            INSERT OR IGNORE INTO %1.log_partitions (table_name, day, first_id, last_id, row_count, byte_count)
+            SELECT 'main.logs', COALESCE(date(MAX(timestamp)), date('now', 'localtime')),
+                   COALESCE(MIN(id), 0), COALESCE(MAX(id), 0), COUNT(*),
+                   COALESCE(SUM(length(CAST(level AS BLOB)) + length(CAST(message AS BLOB))
+                            + IFNULL(length(CAST(category AS BLOB)), 0)), 0)
+            FROM main.logs
+        )").arg(Constants::Logging::LOG_DATABASE_ALIAS);
+        
+        if (!executeUpdate(registerLegacySQL)) {
+            logError("登记旧版logs表失败");
             return false;
         }
     }
     
-    qDebug() << "logs表创建成功";
+    qDebug() << "日志分区表创建成功";
     return true;
 }
 
+void DatabaseManager::setLogRetentionPolicy(int maxAgeDays, qint64 maxBytes)
+{
+    m_logRetentionDays = maxAgeDays;
+    m_logRetentionMaxBytes = maxBytes;
+    
+    if (!m_logDatabaseAttached) {
+        return;
+    }
+    
+    if (!m_logRetentionTimer) {
+        m_logRetentionTimer = new QTimer(this);
+        m_logRetentionTimer->setInterval(Constants::Logging::LOG_RETENTION_INTERVAL_MS);
+        connect(m_logRetentionTimer, &QTimer::timeout, this, &DatabaseManager::applyLogRetention);
+        
+        // 首次清理推迟到启动完成之后
+        QTimer::singleShot(Constants::Logging::LOG_RETENTION_STARTUP_DELAY_MS, this, &DatabaseManager::applyLogRetention);
+    }
+    m_logRetentionTimer->start();
+}
+
+void DatabaseManager::applyLogRetention()
+{
+    if (!m_initialized || !m_logDatabaseAttached) {
+        return;
+    }
+    
+    LogDao logDao;
+    const int dropped = logDao.applyRetention(m_logRetentionDays, m_logRetentionMaxBytes);
+    if (dropped > 0) {
+        qDebug() << "日志保留策略：删除了" << dropped << "个日志分区";
+    }
+}
+
 bool DatabaseManager::insertInitialData()
 {
     qDebug() << "开始插入初始数据";
@@ -534,12 +1117,11 @@ void DatabaseManager::logError(const QString& error)
     m_lastError = error;
     qCritical() << "DatabaseManager Error:" << error;
     
-    // 简单的错误记录，不使用弹窗避免阻塞
-    if (m_initialized && database().isOpen()) {
-        QString errorMessage = error;
-        QString logSQL = QString("INSERT INTO logs (level, message, category) VALUES ('ERROR', '%1', 'Database')")
-                        .arg(errorMessage.replace("'", "''"));
-        QSqlQuery query(database());
-        query.exec(logSQL);
+    // 简单的错误记录，不使用弹窗避免阻塞；写入失败不再回到这里
+    if (m_initialized && m_logDatabaseAttached && !m_writingErrorLog && database().isOpen()) {
+        m_writingErrorLog = true;
+        LogDao logDao;
+        logDao.addLog("ERROR", error, "Database");
+        m_writingErrorLog = false;
     }
 }
\ No newline at end of file
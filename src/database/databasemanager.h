@@ -8,7 +8,11 @@
 #include <QMutex>
 #include <QString>
 #include <QStringList>
+#include <QTimer>
 #include <memory>
+#include <atomic>
+
+class QThread;
 
 /**
  * @brief 数据库管理器 - 简化版本
@@ -71,6 +75,57 @@ public:
      * @brief 关闭数据库连接
      */
     void closeDatabase();
+    
+    /**
+     * @brief 日志库是否已附加到主连接
+     */
+    bool isLogDatabaseAttached() const { return m_logDatabaseAttached; }
+    
+    /**
+     * @brief 连接是否属于当前线程（启动期间连接先在工作线程中打开）
+     */
+    bool isConnectionThread() const;
+    
+    /**
+     * @brief 设置日志保留策略并启动定时清理
+     * @param maxAgeDays 最长保留天数，<=0表示不按时间清理
+     * @param maxBytes 日志总大小上限（字节），<=0表示不按大小清理
+     */
+    void setLogRetentionPolicy(int maxAgeDays, qint64 maxBytes);
+    
+    /**
+     * @brief 在当前线程关闭连接，保留初始化状态
+     * @details Qt的数据库连接只能在创建它的线程中使用。启动时在工作线程完成建表和修复后
+     *          调用本函数，再由主线程调用reopenConnection()接管。
+     */
+    void releaseConnection();
+    
+    /**
+     * @brief 在当前线程重新打开已初始化的数据库并附加日志库
+     * @return 打开是否成功
+     */
+    bool reopenConnection();
+    
+    /**
+     * @brief 用独立的只读连接顺序读取常用表，预热操作系统文件缓存
+     * @param dbPath 数据库文件路径
+     * @details 可在任意线程调用，不影响主连接
+     */
+    static void warmUpFileCache(const QString& dbPath);
+    
+    /**
+     * @brief 在独立连接上附加日志库（与主库同目录）
+     * @param connection 已打开的连接，必须在其所属线程中调用
+     * @param dbPath 主库文件路径
+     * @return 附加是否成功
+     */
+    static bool attachLogDatabaseTo(QSqlDatabase& connection, const QString& dbPath);
+
+private slots:
+    /**
+     * @brief 按保留策略整表删除过期的日志分区
+     */
+    void applyLogRetention();
 
 private:
     explicit DatabaseManager(QObject* parent = nullptr);
@@ -106,9 +161,41 @@ private:
     bool createPlayHistoryTable();
     
     /**
-     * @brief 创建日志表
+     * @brief 创建播放统计汇总表（按歌曲、按天、按艺术家）和维护它们的触发器
+     * @details 汇总表只随play_history的插入累加，清理play_history不影响统计；
+     *          触发器首次创建时按现有播放历史回填一次
+     */
+    bool createPlayStatisticsTables();
+    
+    /**
+     * @brief 创建播放列表表和播放列表-歌曲关联表
+     */
+    bool createPlaylistsTables();
+    
+    /**
+     * @brief 创建维护playlists.song_count/total_duration的触发器
+     * @details 触发器首次创建时按现有数据回填一次，之后随每行增删增量更新
      */
-    bool createLogsTable();
+    bool createPlaylistStatisticsTriggers();
+    
+    /**
+     * @brief 创建智能播放列表的变更日志表和写入它的触发器
+     * @details songs、song_tags、play_stats_song中规则用到的行变化时记录歌曲ID，
+     *          SmartPlaylistEngine据此增量刷新缓存
+     */
+    bool createSmartPlaylistChangeLog();
+    
+    /**
+     * @brief 附加独立的日志库文件（与主库同目录）
+     * @param dbPath 主库文件路径
+     * @return 附加是否成功
+     */
+    bool attachLogDatabase(const QString& dbPath);
+    
+    /**
+     * @brief 创建日志分区登记表，并登记旧版logs表
+     */
+    bool createLogPartitionTables();
     
     /**
      * @brief 插入初始数据
@@ -135,9 +222,18 @@ private:
     static QMutex m_mutex;
     
     QSqlDatabase m_database;
+    QString m_databasePath;
+    std::atomic<QThread*> m_connectionThread;  // 连接所属线程，其他线程视为无效
     bool m_initialized;
     QString m_lastError;
     
+    // 日志库和保留策略
+    bool m_logDatabaseAttached;
+    bool m_writingErrorLog;  // 防止写错误日志失败时递归
+    int m_logRetentionDays;
+    qint64 m_logRetentionMaxBytes;
+    QTimer* m_logRetentionTimer;
+    
     // 数据库连接名称
     static const QString CONNECTION_NAME;
 };
@@ -1,50 +1,392 @@
 #include "logdao.h"
 #include "databasemanager.h"
+#include "../core/constants.h"
+#include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QVariant>
+#include <QMutexLocker>
 #include <QDebug>
 
+QSet<QString> LogDao::s_knownPartitions;
+QMutex LogDao::s_partitionMutex;
+
+namespace {
+
+QString partitionsTable()
+{
+    return Constants::Logging::LOG_DATABASE_ALIAS + ".log_partitions";
+}
+
+QDate entryDay(const LogEntry& entry)
+{
+    return entry.timestamp.isValid() ? entry.timestamp.date() : QDate::currentDate();
+}
+
+} // namespace
+
 LogDao::LogDao(QObject* parent)
     : BaseDao(parent)
 {
 }
 
+LogDao::LogDao(const QSqlDatabase& connection, QObject* parent)
+    : BaseDao(parent)
+    , m_connection(connection)
+{
+}
+
 int LogDao::addLog(const LogEntry& entry)
 {
-    const QString sql = R"(
-        INSERT INTO logs (level, message, category, timestamp)
-        VALUES (?, ?, ?, ?)
-    )";
+    DAO_QUERY_SCOPE();
+    if (!isLogDatabaseReady("addLog")) {
+        return -1;
+    }
     
-    QSqlQuery query = prepareQuery(sql);
-    query.addBindValue(entry.level);
-    query.addBindValue(entry.message);
-    query.addBindValue(entry.category);
-    query.addBindValue(entry.timestamp);
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        logError("addLog", "无法开始事务: " + db.lastError().text());
+        return -1;
+    }
     
-    if (query.exec()) {
-        return query.lastInsertId().toInt();
-    } else {
-        logError("addLog", query.lastError().text());
+    int lastInsertId = -1;
+    if (insertLogs({entry}, lastInsertId) < 0) {
+        db.rollback();
         return -1;
     }
+    
+    if (!db.commit()) {
+        logError("addLog", "提交事务失败: " + db.lastError().text());
+        db.rollback();
+        return -1;
+    }
+    
+    return lastInsertId;
 }
 
 int LogDao::addLog(const QString& level, const QString& message, const QString& category)
 {
+    DAO_QUERY_SCOPE();
     LogEntry entry(level, message, category);
     return addLog(entry);
 }
 
+int LogDao::addLogs(const QList<LogEntry>& entries)
+{
+    DAO_QUERY_SCOPE();
+    if (entries.isEmpty()) {
+        return 0;
+    }
+    
+    if (!isLogDatabaseReady("addLogs")) {
+        return -1;
+    }
+    
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        logError("addLogs", "无法开始事务: " + db.lastError().text());
+        return -1;
+    }
+    
+    int lastInsertId = -1;
+    const int inserted = insertLogs(entries, lastInsertId);
+    if (inserted < 0) {
+        db.rollback();
+        return -1;
+    }
+    
+    if (!db.commit()) {
+        logError("addLogs", "提交事务失败: " + db.lastError().text());
+        db.rollback();
+        return -1;
+    }
+    
+    return inserted;
+}
+
+int LogDao::insertLogs(const QList<LogEntry>& entries, int& lastInsertId)
+{
+    QSqlQuery nextIdQuery = prepareQuery(QString("SELECT COALESCE(MAX(last_id), 0) FROM %1").arg(partitionsTable()));
+    if (!nextIdQuery.exec() || !nextIdQuery.next()) {
+        logError("insertLogs", nextIdQuery.lastError().text());
+        return -1;
+    }
+    qint64 nextId = nextIdQuery.value(0).toLongLong() + 1;
+    
+    QSqlQuery updateQuery = prepareQuery(QString(R"(
+        UPDATE %1
+        SET first_id = CASE WHEN row_count = 0 THEN ? ELSE first_id END,
+            last_id = ?,
+            row_count = row_count + ?,
+            byte_count = byte_count + ?
+        WHERE table_name = ?
+    )").arg(partitionsTable()));
+    
+    int inserted = 0;
+    int index = 0;
+    while (index < entries.size()) {
+        const QDate day = entryDay(entries.at(index));
+        const QString tableName = ensurePartition(day);
+        if (tableName.isEmpty()) {
+            return -1;
+        }
+        
+        // 同一天的连续条目共用一条预编译语句
+        QSqlQuery query = prepareQuery(QString(R"(
+            INSERT INTO %1 (id, level, message, category, timestamp)
+            VALUES (?, ?, ?, ?, ?)
+        )").arg(tableName));
+        
+        const qint64 firstId = nextId;
+        qint64 groupBytes = 0;
+        int groupRows = 0;
+        for (; index < entries.size() && entryDay(entries.at(index)) == day; ++index) {
+            const LogEntry& entry = entries.at(index);
+            query.addBindValue(nextId);
+            query.addBindValue(entry.level);
+            query.addBindValue(entry.message);
+            query.addBindValue(entry.category);
+            query.addBindValue(entry.timestamp);
+            
+            if (!query.exec()) {
+                logError("insertLogs", query.lastError().text());
+                return -1;
+            }
+            
+            lastInsertId = static_cast<int>(nextId++);
+            groupBytes += entry.level.toUtf8().size() + entry.message.toUtf8().size()
+                          + entry.category.toUtf8().size();
+            ++groupRows;
+        }
+        
+        updateQuery.addBindValue(firstId);
+        updateQuery.addBindValue(nextId - 1);
+        updateQuery.addBindValue(groupRows);
+        updateQuery.addBindValue(groupBytes);
+        updateQuery.addBindValue(tableName);
+        if (!updateQuery.exec()) {
+            logError("insertLogs", updateQuery.lastError().text());
+            return -1;
+        }
+        
+        inserted += groupRows;
+    }
+    
+    return inserted;
+}
+
+QString LogDao::ensurePartition(const QDate& day)
+{
+    const QString tableName = Constants::Logging::LOG_DATABASE_ALIAS + "."
+                              + Constants::Logging::LOG_PARTITION_PREFIX + day.toString("yyyyMMdd");
+    {
+        QMutexLocker locker(&s_partitionMutex);
+        if (s_knownPartitions.contains(tableName)) {
+            return tableName;
+        }
+    }
+    
+    // 分区表不建二级索引，写入只追加到主键末尾
+    QSqlQuery query(connection());
+    const QString createSQL = QString(R"(
+        CREATE TABLE IF NOT EXISTS %1 (
+            id INTEGER PRIMARY KEY,
+            level TEXT NOT NULL,
+            message TEXT NOT NULL,
+            category TEXT,
+            timestamp DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )").arg(tableName);
+    
+    if (!query.exec(createSQL)) {
+        logError("ensurePartition", query.lastError().text());
+        return QString();
+    }
+    
+    query.prepare(QString("INSERT OR IGNORE INTO %1 (table_name, day) VALUES (?, ?)").arg(partitionsTable()));
+    query.addBindValue(tableName);
+    query.addBindValue(day.toString(Qt::ISODate));
+    if (!query.exec()) {
+        logError("ensurePartition", query.lastError().text());
+        return QString();
+    }
+    
+    QMutexLocker locker(&s_partitionMutex);
+    s_knownPartitions.insert(tableName);
+    return tableName;
+}
+
+QList<LogDao::Partition> LogDao::partitions()
+{
+    QList<Partition> result;
+    QSqlQuery query = prepareQuery(QString(R"(
+        SELECT table_name, day, row_count, byte_count FROM %1
+        ORDER BY day, table_name
+    )").arg(partitionsTable()));
+    
+    if (!query.exec()) {
+        logError("partitions", query.lastError().text());
+        return result;
+    }
+    
+    while (query.next()) {
+        Partition partition;
+        partition.tableName = query.value(0).toString();
+        partition.day = QDate::fromString(query.value(1).toString(), Qt::ISODate);
+        partition.rowCount = query.value(2).toLongLong();
+        partition.byteCount = query.value(3).toLongLong();
+        result.append(partition);
+    }
+    
+    return result;
+}
+
+bool LogDao::dropPartition(const QString& tableName)
+{
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        logError("dropPartition", "无法开始事务: " + db.lastError().text());
+        return false;
+    }
+    
+    QSqlQuery query(db);
+    if (!query.exec("DROP TABLE IF EXISTS " + tableName)) {
+        logError("dropPartition", query.lastError().text());
+        db.rollback();
+        return false;
+    }
+    
+    query.prepare(QString("DELETE FROM %1 WHERE table_name = ?").arg(partitionsTable()));
+    query.addBindValue(tableName);
+    if (!query.exec()) {
+        logError("dropPartition", query.lastError().text());
+        db.rollback();
+        return false;
+    }
+    
+    if (!db.commit()) {
+        logError("dropPartition", "提交事务失败: " + db.lastError().text());
+        db.rollback();
+        return false;
+    }
+    
+    QMutexLocker locker(&s_partitionMutex);
+    s_knownPartitions.remove(tableName);
+    return true;
+}
+
+void LogDao::reclaimFreePages()
+{
+    // incremental_vacuum每回收一页返回一行，需要逐行推进才会执行完
+    QSqlQuery query(connection());
+    if (!query.exec(QString("PRAGMA %1.incremental_vacuum").arg(Constants::Logging::LOG_DATABASE_ALIAS))) {
+        logError("reclaimFreePages", query.lastError().text());
+        return;
+    }
+    while (query.next()) {
+    }
+}
+
+void LogDao::refreshPartitionStats(const QString& tableName)
+{
+    QSqlQuery query = prepareQuery(QString(R"(
+        UPDATE %1
+        SET row_count = (SELECT COUNT(*) FROM %2),
+            byte_count = (SELECT COALESCE(SUM(length(CAST(level AS BLOB)) + length(CAST(message AS BLOB))
+                                              + IFNULL(length(CAST(category AS BLOB)), 0)), 0) FROM %2)
+        WHERE table_name = ?
+    )").arg(partitionsTable(), tableName));
+    query.addBindValue(tableName);
+    
+    if (!query.exec()) {
+        logError("refreshPartitionStats", query.lastError().text());
+    }
+}
+
+QString LogDao::logSource(const QDate& from, const QDate& to)
+{
+    const QString partitionPrefix = Constants::Logging::LOG_DATABASE_ALIAS + ".";
+    QStringList selects;
+    for (const Partition& partition : partitions()) {
+        // 旧版main.logs的day是最后一条日志的日期，只能用于排除过早的范围
+        const bool legacy = !partition.tableName.startsWith(partitionPrefix);
+        if (from.isValid() && partition.day < from) {
+            continue;
+        }
+        if (to.isValid() && !legacy && partition.day > to) {
+            continue;
+        }
+        selects.append(QString("SELECT id, level, message, category, timestamp FROM %1").arg(partition.tableName));
+    }
+    
+    if (selects.isEmpty()) {
+        return "(SELECT 0 AS id, '' AS level, '' AS message, '' AS category, NULL AS timestamp WHERE 0) AS logs";
+    }
+    
+    return "(" + selects.join(" UNION ALL ") + ") AS logs";
+}
+
+bool LogDao::isLogDatabaseReady(const QString& operation)
+{
+    if (!dbManager() || !dbManager()->isInitialized() || !dbManager()->isLogDatabaseAttached()) {
+        logError(operation, "日志库未初始化");
+        return false;
+    }
+    // 独立连接由调用方保证在所属线程使用
+    if (m_connection.isValid()) {
+        return m_connection.isOpen();
+    }
+    // 启动时连接在工作线程中交接，期间的日志只写入文件
+    if (!dbManager()->isConnectionThread()) {
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery LogDao::prepareQuery(const QString& sql)
+{
+    if (!m_connection.isValid()) {
+        return BaseDao::prepareQuery(sql);
+    }
+    
+    QSqlQuery query(m_connection);
+    if (!query.prepare(sql)) {
+        logError("prepareQuery", "准备查询失败: " + query.lastError().text());
+    }
+    return query;
+}
+
+QSqlDatabase LogDao::connection() const
+{
+    return m_connection.isValid() ? m_connection : dbManager()->database();
+}
+
 LogEntry LogDao::getLogById(int id)
 {
-    const QString sql = "SELECT * FROM logs WHERE id = ?";
-    QSqlQuery query = prepareQuery(sql);
-    query.addBindValue(id);
+    DAO_QUERY_SCOPE();
+    if (!isLogDatabaseReady("getLogById")) {
+        return LogEntry();
+    }
     
-    if (query.exec() && query.next()) {
-        return createLogEntryFromQuery(query);
+    // 写入过早日期的日志时分区的ID范围可能交叠，依次查找
+    QSqlQuery partitionQuery = prepareQuery(QString(R"(
+        SELECT table_name FROM %1
+        WHERE ? BETWEEN first_id AND last_id
+        ORDER BY first_id DESC
+    )").arg(partitionsTable()));
+    partitionQuery.addBindValue(id);
+    
+    if (!partitionQuery.exec()) {
+        logError("getLogById", partitionQuery.lastError().text());
+        return LogEntry();
+    }
+    
+    while (partitionQuery.next()) {
+        QSqlQuery query = prepareQuery(QString("SELECT * FROM %1 WHERE id = ?").arg(partitionQuery.value(0).toString()));
+        query.addBindValue(id);
+        if (query.exec() && query.next()) {
+            return createLogEntryFromQuery(query);
+        }
     }
     
     return LogEntry(); // 返回空对象
@@ -52,8 +394,9 @@ LogEntry LogDao::getLogById(int id)
 
 QList<LogEntry> LogDao::getAllLogs(int limit)
 {
+    DAO_QUERY_SCOPE();
     QList<LogEntry> logs;
-    QString sql = "SELECT * FROM logs ORDER BY timestamp DESC";
+    QString sql = "SELECT * FROM " + logSource() + " ORDER BY timestamp DESC";
     
     if (limit > 0) {
         sql += QString(" LIMIT %1").arg(limit);
@@ -70,8 +413,9 @@ QList<LogEntry> LogDao::getAllLogs(int limit)
 
 QList<LogEntry> LogDao::getLogsByLevel(const QString& level, int limit)
 {
+    DAO_QUERY_SCOPE();
     QList<LogEntry> logs;
-    QString sql = "SELECT * FROM logs WHERE level = ? ORDER BY timestamp DESC";
+    QString sql = "SELECT * FROM " + logSource() + " WHERE level = ? ORDER BY timestamp DESC";
     
     if (limit > 0) {
         sql += QString(" LIMIT %1").arg(limit);
@@ -93,8 +437,9 @@ QList<LogEntry> LogDao::getLogsByLevel(const QString& level, int limit)
 
 QList<LogEntry> LogDao::getLogsByCategory(const QString& category, int limit)
 {
+    DAO_QUERY_SCOPE();
     QList<LogEntry> logs;
-    QString sql = "SELECT * FROM logs WHERE category = ? ORDER BY timestamp DESC";
+    QString sql = "SELECT * FROM " + logSource() + " WHERE category = ? ORDER BY timestamp DESC";
     
     if (limit > 0) {
         sql += QString(" LIMIT %1").arg(limit);
@@ -116,8 +461,10 @@ QList<LogEntry> LogDao::getLogsByCategory(const QString& category, int limit)
 
 QList<LogEntry> LogDao::getLogsByTimeRange(const QDateTime& startTime, const QDateTime& endTime, int limit)
 {
+    DAO_QUERY_SCOPE();
     QList<LogEntry> logs;
-    QString sql = "SELECT * FROM logs WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp DESC";
+    QString sql = "SELECT * FROM " + logSource(startTime.date(), endTime.date())
+                  + " WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp DESC";
     
     if (limit > 0) {
         sql += QString(" LIMIT %1").arg(limit);
@@ -140,12 +487,13 @@ QList<LogEntry> LogDao::getLogsByTimeRange(const QDateTime& startTime, const QDa
 
 QList<LogEntry> LogDao::searchLogs(const QString& keyword, int limit)
 {
+    DAO_QUERY_SCOPE();
     QList<LogEntry> logs;
-    QString sql = R"(
-        SELECT * FROM logs 
+    QString sql = QString(R"(
+        SELECT * FROM %1 
         WHERE message LIKE ? OR category LIKE ? 
         ORDER BY timestamp DESC
-    )";
+    )").arg(logSource());
     
     if (limit > 0) {
         sql += QString(" LIMIT %1").arg(limit);
@@ -169,48 +517,133 @@ QList<LogEntry> LogDao::searchLogs(const QString& keyword, int limit)
 
 int LogDao::deleteLogsBefore(const QDateTime& beforeTime)
 {
-    const QString sql = "DELETE FROM logs WHERE timestamp < ?";
-    QSqlQuery query = prepareQuery(sql);
-    query.addBindValue(beforeTime);
+    DAO_QUERY_SCOPE();
+    if (!isLogDatabaseReady("deleteLogsBefore")) {
+        return -1;
+    }
     
-    if (query.exec()) {
-        return query.numRowsAffected();
-    } else {
-        logError("deleteLogsBefore", query.lastError().text());
+    const QString partitionPrefix = Constants::Logging::LOG_DATABASE_ALIAS + ".";
+    const QDate boundary = beforeTime.date();
+    int deleted = 0;
+    bool dropped = false;
+    
+    for (const Partition& partition : partitions()) {
+        if (partition.day < boundary) {
+            // 整天都早于时间点，直接删表
+            if (!dropPartition(partition.tableName)) {
+                return -1;
+            }
+            deleted += static_cast<int>(partition.rowCount);
+            dropped = true;
+        } else if (partition.day == boundary || !partition.tableName.startsWith(partitionPrefix)) {
+            // 边界当天（以及旧版main.logs）逐行删除
+            QSqlQuery query = prepareQuery(QString("DELETE FROM %1 WHERE timestamp < ?").arg(partition.tableName));
+            query.addBindValue(beforeTime);
+            if (!query.exec()) {
+                logError("deleteLogsBefore", query.lastError().text());
+                return -1;
+            }
+            if (query.numRowsAffected() > 0) {
+                deleted += query.numRowsAffected();
+                refreshPartitionStats(partition.tableName);
+            }
+        }
+    }
+    
+    if (dropped) {
+        reclaimFreePages();
+    }
+    
+    return deleted;
+}
+
+int LogDao::applyRetention(int maxAgeDays, qint64 maxBytes)
+{
+    DAO_QUERY_SCOPE();
+    if (!isLogDatabaseReady("applyRetention")) {
         return -1;
     }
+    
+    const QList<Partition> all = partitions();
+    const QDate today = QDate::currentDate();
+    const QDate cutoff = maxAgeDays > 0 ? today.addDays(-maxAgeDays) : QDate();
+    
+    qint64 totalBytes = 0;
+    for (const Partition& partition : all) {
+        totalBytes += partition.byteCount;
+    }
+    
+    // 分区按日期升序，从最旧的开始删，直到既不过期也不超限
+    int dropped = 0;
+    for (const Partition& partition : all) {
+        const bool expired = cutoff.isValid() && partition.day < cutoff;
+        const bool oversized = maxBytes > 0 && totalBytes > maxBytes && partition.day < today;
+        if (!expired && !oversized) {
+            break;
+        }
+        
+        if (!dropPartition(partition.tableName)) {
+            break;
+        }
+        totalBytes -= partition.byteCount;
+        ++dropped;
+    }
+    
+    if (dropped > 0) {
+        reclaimFreePages();
+    }
+    
+    return dropped;
 }
 
 int LogDao::deleteLogsByLevel(const QString& level)
 {
-    const QString sql = "DELETE FROM logs WHERE level = ?";
-    QSqlQuery query = prepareQuery(sql);
-    query.addBindValue(level);
-    
-    if (query.exec()) {
-        return query.numRowsAffected();
-    } else {
-        logError("deleteLogsByLevel", query.lastError().text());
+    DAO_QUERY_SCOPE();
+    if (!isLogDatabaseReady("deleteLogsByLevel")) {
         return -1;
     }
+    
+    int deleted = 0;
+    for (const Partition& partition : partitions()) {
+        QSqlQuery query = prepareQuery(QString("DELETE FROM %1 WHERE level = ?").arg(partition.tableName));
+        query.addBindValue(level);
+        if (!query.exec()) {
+            logError("deleteLogsByLevel", query.lastError().text());
+            return -1;
+        }
+        if (query.numRowsAffected() > 0) {
+            deleted += query.numRowsAffected();
+            refreshPartitionStats(partition.tableName);
+        }
+    }
+    
+    return deleted;
 }
 
 int LogDao::clearAllLogs()
 {
-    const QString sql = "DELETE FROM logs";
-    QSqlQuery query = executeQuery(sql);
-    
-    if (query.lastError().isValid()) {
-        logError("clearAllLogs", query.lastError().text());
+    DAO_QUERY_SCOPE();
+    if (!isLogDatabaseReady("clearAllLogs")) {
         return -1;
     }
     
-    return query.numRowsAffected();
+    int deleted = 0;
+    for (const Partition& partition : partitions()) {
+        if (!dropPartition(partition.tableName)) {
+            return -1;
+        }
+        deleted += static_cast<int>(partition.rowCount);
+    }
+    
+    reclaimFreePages();
+    return deleted;
 }
 
 int LogDao::getLogCount()
 {
-    const QString sql = "SELECT COUNT(*) FROM logs";
+    DAO_QUERY_SCOPE();
+    // 行数由分区登记表维护，无需扫描日志表
+    const QString sql = QString("SELECT COALESCE(SUM(row_count), 0) FROM %1").arg(partitionsTable());
     QSqlQuery query = executeQuery(sql);
     
     if (query.next()) {
@@ -222,7 +655,8 @@ int LogDao::getLogCount()
 
 int LogDao::getLogCountByLevel(const QString& level)
 {
-    const QString sql = "SELECT COUNT(*) FROM logs WHERE level = ?";
+    DAO_QUERY_SCOPE();
+    const QString sql = "SELECT COUNT(*) FROM " + logSource() + " WHERE level = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(level);
     
@@ -235,8 +669,9 @@ int LogDao::getLogCountByLevel(const QString& level)
 
 QStringList LogDao::getAllLogLevels()
 {
+    DAO_QUERY_SCOPE();
     QStringList levels;
-    const QString sql = "SELECT DISTINCT level FROM logs ORDER BY level";
+    const QString sql = "SELECT DISTINCT level FROM " + logSource() + " ORDER BY level";
     QSqlQuery query = executeQuery(sql);
     
     while (query.next()) {
@@ -248,8 +683,10 @@ QStringList LogDao::getAllLogLevels()
 
 QStringList LogDao::getAllLogCategories()
 {
+    DAO_QUERY_SCOPE();
     QStringList categories;
-    const QString sql = "SELECT DISTINCT category FROM logs WHERE category IS NOT NULL AND category != '' ORDER BY category";
+    const QString sql = "SELECT DISTINCT category FROM " + logSource()
+                        + " WHERE category IS NOT NULL AND category != '' ORDER BY category";
     QSqlQuery query = executeQuery(sql);
     
     while (query.next()) {
@@ -273,6 +710,7 @@ LogEntry LogDao::createLogEntryFromQuery(const QSqlQuery& query)
 
 int LogDao::insertSystemLog(const SystemLog& systemLog)
 {
+    DAO_QUERY_SCOPE();
     return addLog(LogEntry(
         systemLog.levelString(),
         systemLog.message(),
@@ -282,6 +720,7 @@ int LogDao::insertSystemLog(const SystemLog& systemLog)
 
 int LogDao::insertErrorLog(const ErrorLog& errorLog)
 {
+    DAO_QUERY_SCOPE();
     return addLog(LogEntry(
         errorLog.levelString(),
         errorLog.message(),
@@ -5,8 +5,11 @@
 #include "../models/errorlog.h"
 #include "../models/systemlog.h"
 #include <QDateTime>
+#include <QSqlDatabase>
 #include <QList>
 #include <QStringList>
+#include <QSet>
+#include <QMutex>
 
 /**
  * @brief 日志条目结构
@@ -27,7 +30,11 @@ struct LogEntry
 /**
  * @brief 日志数据访问对象
  * 
- * 提供日志相关的数据库操作
+ * 提供日志相关的数据库操作。
+ * 日志写在附加的独立日志库中，每天一张表（logdb.logs_yyyyMMdd），
+ * 分区登记在logdb.log_partitions；过期日志整表删除，不逐行删除。
+ *
+ * 默认使用主连接；Logger的写线程传入自己的连接（已附加日志库），批量写入在写线程中执行。
  */
 class LogDao : public BaseDao
 {
@@ -36,6 +43,12 @@ class LogDao : public BaseDao
 public:
     explicit LogDao(QObject* parent = nullptr);
     
+    /**
+     * @brief 使用指定连接（必须已附加日志库，且在该连接所属的线程中使用）
+     * @param connection 数据库连接
+     */
+    explicit LogDao(const QSqlDatabase& connection, QObject* parent = nullptr);
+    
     /**
      * @brief 添加日志条目
      * @param entry 日志条目
@@ -52,6 +65,13 @@ public:
      */
     int addLog(const QString& level, const QString& message, const QString& category = QString());
     
+    /**
+     * @brief 批量添加日志条目（单个事务）
+     * @param entries 日志条目列表
+     * @return 成功插入的条数，失败返回-1（整批回滚）
+     */
+    int addLogs(const QList<LogEntry>& entries);
+    
     /**
      * @brief 根据ID获取日志
      * @param id 日志ID
@@ -103,9 +123,20 @@ public:
      * @brief 删除指定时间之前的日志
      * @param beforeTime 时间点
      * @return 删除的日志数量
+     * @details 整天早于beforeTime的分区直接删表，只有当天的分区逐行删除
      */
     int deleteLogsBefore(const QDateTime& beforeTime);
     
+    /**
+     * @brief 按保留策略删除日志分区
+     * @param maxAgeDays 最长保留天数，<=0表示不按时间清理
+     * @param maxBytes 日志总大小上限（字节），<=0表示不按大小清理
+     * @return 删除的分区数量，失败返回-1
+     * @details 超过大小上限时从最旧的分区开始删除，当天的分区始终保留；
+     *          删除后增量回收日志库的空闲页
+     */
+    int applyRetention(int maxAgeDays, qint64 maxBytes);
+    
     /**
      * @brief 删除指定级别的日志
      * @param level 日志级别
@@ -164,13 +195,88 @@ public:
      */
     Q_SIGNAL void databaseError(const QString& error);
 
+protected:
+    QSqlQuery prepareQuery(const QString& sql) override;
+
 private:
+    /**
+     * @brief 日志分区信息
+     */
+    struct Partition
+    {
+        QString tableName;  // 带库名的表名，如logdb.logs_20240101
+        QDate day;          // 旧版main.logs为其最后一条日志的日期
+        qint64 rowCount = 0;
+        qint64 byteCount = 0;
+    };
+    
+    /**
+     * @brief 在当前事务中插入日志，按日期分组写入各自的分区
+     * @details ID由登记表中的最大last_id接续分配，所有分区间全局递增
+     * @param entries 日志条目列表
+     * @param lastInsertId 输出最后插入的日志ID
+     * @return 插入的条数，失败返回-1
+     */
+    int insertLogs(const QList<LogEntry>& entries, int& lastInsertId);
+    
+    /**
+     * @brief 确保指定日期的分区存在
+     * @param day 日期
+     * @return 带库名的分区表名，失败返回空字符串
+     */
+    QString ensurePartition(const QDate& day);
+    
+    /**
+     * @brief 按日期升序列出分区
+     */
+    QList<Partition> partitions();
+    
+    /**
+     * @brief 删除整个分区
+     * @param tableName 带库名的分区表名
+     * @return 删除是否成功
+     */
+    bool dropPartition(const QString& tableName);
+    
+    /**
+     * @brief 增量回收日志库的空闲页，缩小日志库文件
+     */
+    void reclaimFreePages();
+    
+    /**
+     * @brief 重新统计分区的行数和大小（逐行删除之后调用）
+     */
+    void refreshPartitionStats(const QString& tableName);
+    
+    /**
+     * @brief 构造覆盖分区的查询源，以logs为别名，可替代原logs表
+     * @param from 起始日期（无效表示不限）
+     * @param to 结束日期（无效表示不限）
+     */
+    QString logSource(const QDate& from = QDate(), const QDate& to = QDate());
+    
+    /**
+     * @brief 日志库是否可用
+     */
+    bool isLogDatabaseReady(const QString& operation);
+    
     /**
      * @brief 从查询结果创建日志条目
      * @param query 查询结果
      * @return 日志条目
      */
     LogEntry createLogEntryFromQuery(const QSqlQuery& query);
+    
+    /**
+     * @brief 本对象使用的连接
+     */
+    QSqlDatabase connection() const;
+    
+    QSqlDatabase m_connection;  // 无效时使用主连接
+    
+    // 已确认存在的分区，所有LogDao实例共享（删除分区时移除）
+    static QSet<QString> s_knownPartitions;
+    static QMutex s_partitionMutex;
 };
 
 #endif // LOGDAO_H
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "playhistorydao.h"
+#include "databasemanager.h"
+#include "playstatsdao.h"
 #include "../core/logger.h"
 #include <QDebug>
 #include <QSqlError>
@@ -10,12 +12,19 @@ PlayHistoryDao::PlayHistoryDao(QObject* parent)
 {
 }
 
+PlayHistoryDao::PlayHistoryDao(const QSqlDatabase& connection, QObject* parent)
+    : BaseDao(parent)
+    , m_connection(connection)
+{
+}
+
 PlayHistoryDao::~PlayHistoryDao()
 {
 }
 
 bool PlayHistoryDao::addPlayRecord(int songId, const QDateTime& playedAt)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     if (songId <= 0) {
@@ -49,6 +58,7 @@ bool PlayHistoryDao::addPlayRecord(int songId, const QDateTime& playedAt)
 
 QList<Song> PlayHistoryDao::getRecentPlayedSongs(int limit)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     // 使用优化的SQL查询，确保每首歌只显示最新的播放记录
@@ -129,6 +139,7 @@ QList<Song> PlayHistoryDao::getRecentPlayedSongs(int limit)
 
 QList<PlayHistory> PlayHistoryDao::getSongPlayHistory(int songId, int limit)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = R"(
@@ -158,6 +169,7 @@ QList<PlayHistory> PlayHistoryDao::getSongPlayHistory(int songId, int limit)
 
 QList<PlayHistory> PlayHistoryDao::getAllPlayHistory(int limit)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = R"(
@@ -185,6 +197,7 @@ QList<PlayHistory> PlayHistoryDao::getAllPlayHistory(int limit)
 
 bool PlayHistoryDao::deleteSongPlayHistory(int songId)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "DELETE FROM play_history WHERE song_id = ?";
@@ -202,6 +215,7 @@ bool PlayHistoryDao::deleteSongPlayHistory(int songId)
 
 bool PlayHistoryDao::deletePlayHistoryBefore(const QDateTime& beforeTime)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "DELETE FROM play_history WHERE played_at < ?";
@@ -220,6 +234,7 @@ bool PlayHistoryDao::deletePlayHistoryBefore(const QDateTime& beforeTime)
 
 bool PlayHistoryDao::clearAllPlayHistory()
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "DELETE FROM play_history";
@@ -237,45 +252,23 @@ bool PlayHistoryDao::clearAllPlayHistory()
 
 PlayHistoryDao::PlayHistoryStats PlayHistoryDao::getPlayHistoryStats()
 {
-    QMutexLocker locker(&m_mutex);
+    DAO_QUERY_SCOPE();
     
     PlayHistoryStats stats = {};
     
-    // 获取总记录数
-    const QString countSql = "SELECT COUNT(*) FROM play_history";
-    QSqlQuery countQuery = prepareQuery(countSql);
-    if (countQuery.exec() && countQuery.next()) {
-        stats.totalRecords = countQuery.value(0).toInt();
-    }
-    
-    // 获取唯一歌曲数
-    const QString uniqueSql = "SELECT COUNT(DISTINCT song_id) FROM play_history";
-    QSqlQuery uniqueQuery = prepareQuery(uniqueSql);
-    if (uniqueQuery.exec() && uniqueQuery.next()) {
-        stats.uniqueSongs = uniqueQuery.value(0).toInt();
-    }
-    
-    // 获取最早和最晚播放时间
-    const QString timeSql = "SELECT MIN(played_at), MAX(played_at) FROM play_history";
-    QSqlQuery timeQuery = prepareQuery(timeSql);
-    if (timeQuery.exec() && timeQuery.next()) {
-        stats.firstPlayTime = timeQuery.value(0).toDateTime();
-        stats.lastPlayTime = timeQuery.value(1).toDateTime();
-    }
+    // 读取汇总表，不扫描play_history
+    PlayStatsDao playStatsDao;
+    const PlayStatsTotals totals = playStatsDao.getTotals();
+    stats.totalRecords = totals.totalPlays;
+    stats.uniqueSongs = totals.uniqueSongs;
+    stats.firstPlayTime = totals.firstPlayTime;
+    stats.lastPlayTime = totals.lastPlayTime;
     
     // 获取播放次数最多的歌曲
-    const QString mostPlayedSql = R"(
-        SELECT s.title, COUNT(*) as play_count
-        FROM play_history ph
-        INNER JOIN songs s ON ph.song_id = s.id
-        GROUP BY ph.song_id
-        ORDER BY play_count DESC
-        LIMIT 1
-    )";
-    QSqlQuery mostPlayedQuery = prepareQuery(mostPlayedSql);
-    if (mostPlayedQuery.exec() && mostPlayedQuery.next()) {
-        stats.mostPlayedSong = mostPlayedQuery.value(0).toString();
-        stats.mostPlayedCount = mostPlayedQuery.value(1).toInt();
+    const QList<SongPlayStat> mostPlayed = playStatsDao.getTopSongsAllTime(1);
+    if (!mostPlayed.isEmpty()) {
+        stats.mostPlayedSong = mostPlayed.first().title;
+        stats.mostPlayedCount = mostPlayed.first().playCount;
     }
     
     return stats;
@@ -283,6 +276,7 @@ PlayHistoryDao::PlayHistoryStats PlayHistoryDao::getPlayHistoryStats()
 
 bool PlayHistoryDao::hasPlayHistory(int songId)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "SELECT COUNT(*) FROM play_history WHERE song_id = ?";
@@ -298,21 +292,16 @@ bool PlayHistoryDao::hasPlayHistory(int songId)
 
 int PlayHistoryDao::getSongPlayCount(int songId)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    const QString sql = "SELECT COUNT(*) FROM play_history WHERE song_id = ?";
-    QSqlQuery query = prepareQuery(sql);
-    query.addBindValue(songId);
-    
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
-    }
+    DAO_QUERY_SCOPE();
     
-    return 0;
+    // play_history定期清理，累计次数以汇总表为准
+    PlayStatsDao playStatsDao;
+    return playStatsDao.getSongStats(songId).playCount;
 }
 
 QDateTime PlayHistoryDao::getLastPlayTime(int songId)
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "SELECT MAX(played_at) FROM play_history WHERE song_id = ?";
@@ -328,29 +317,110 @@ QDateTime PlayHistoryDao::getLastPlayTime(int songId)
 
 int PlayHistoryDao::batchAddPlayRecords(const QList<int>& songIds)
 {
-    QMutexLocker locker(&m_mutex);
+    DAO_QUERY_SCOPE();
     
     if (songIds.isEmpty()) {
         return 0;
     }
     
-    int successCount = 0;
-    QDateTime currentTime = QDateTime::currentDateTime();
-    
+    QList<PlayHistory> records;
+    records.reserve(songIds.size());
+    const QDateTime currentTime = QDateTime::currentDateTime();
     for (int songId : songIds) {
-        if (addPlayRecord(songId, currentTime)) {
-            successCount++;
-        }
+        records.append(PlayHistory(songId, currentTime));
     }
     
+    const int successCount = addPlayRecords(records);
     logInfo("batchAddPlayRecords", QString("批量添加播放记录: 成功 %1/%2")
-            .arg(successCount).arg(songIds.size()));
+            .arg(qMax(0, successCount)).arg(songIds.size()));
     
     return successCount;
 }
 
+int PlayHistoryDao::addPlayRecords(const QList<PlayHistory>& records)
+{
+    DAO_QUERY_SCOPE();
+    QMutexLocker locker(&m_mutex);
+    
+    if (records.isEmpty()) {
+        return 0;
+    }
+    
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        logError("addPlayRecords", "无法开始事务: " + db.lastError().text());
+        return -1;
+    }
+    
+    try {
+        // 同一歌曲同一时间的记录只写一次；写入前歌曲已被删除的跳过
+        QSqlQuery query = prepareQuery(R"(
+            INSERT INTO play_history (song_id, played_at)
+            SELECT ?, ?
+            WHERE EXISTS (SELECT 1 FROM songs WHERE id = ?)
+              AND NOT EXISTS (SELECT 1 FROM play_history WHERE song_id = ? AND played_at = ?)
+        )");
+        
+        int inserted = 0;
+        for (const PlayHistory& record : records) {
+            if (record.songId() <= 0) {
+                continue;
+            }
+            query.addBindValue(record.songId());
+            query.addBindValue(record.playedAt());
+            query.addBindValue(record.songId());
+            query.addBindValue(record.songId());
+            query.addBindValue(record.playedAt());
+            if (!query.exec()) {
+                logError("addPlayRecords", query.lastError().text());
+                db.rollback();
+                return -1;
+            }
+            inserted += qMax(0, query.numRowsAffected());
+        }
+        
+        if (!db.commit()) {
+            logError("addPlayRecords", "提交事务失败: " + db.lastError().text());
+            db.rollback();
+            return -1;
+        }
+        
+        return inserted;
+        
+    } catch (const std::exception& e) {
+        db.rollback();
+        logError("addPlayRecords", QString("写入播放记录时发生异常: %1").arg(e.what()));
+        return -1;
+    }
+}
+
+bool PlayHistoryDao::prunePlayHistory(int maxRecords)
+{
+    DAO_QUERY_SCOPE();
+    QMutexLocker locker(&m_mutex);
+    
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        logError("prunePlayHistory", "无法开始事务: " + db.lastError().text());
+        return false;
+    }
+    
+    if (!cleanupAllDuplicateRecords() || !limitPlayHistoryRecords(maxRecords)) {
+        db.rollback();
+        return false;
+    }
+    
+    if (!db.commit()) {
+        logError("prunePlayHistory", "提交事务失败: " + db.lastError().text());
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
 int PlayHistoryDao::getPlayHistoryCount()
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "SELECT COUNT(*) FROM play_history";
@@ -365,6 +435,7 @@ int PlayHistoryDao::getPlayHistoryCount()
 
 int PlayHistoryDao::getUniqueSongCount()
 {
+    DAO_QUERY_SCOPE();
     QMutexLocker locker(&m_mutex);
     
     const QString sql = "SELECT COUNT(DISTINCT song_id) FROM play_history";
@@ -426,6 +497,7 @@ Song PlayHistoryDao::createSongFromQuery(const QSqlQuery& query)
 
 bool PlayHistoryDao::cleanupDuplicateRecords(int songId)
 {
+    DAO_QUERY_SCOPE();
     // 删除该歌曲的重复记录，只保留最新的
     const QString sql = R"(
         DELETE FROM play_history 
@@ -446,8 +518,36 @@ bool PlayHistoryDao::cleanupDuplicateRecords(int songId)
     return query.exec();
 }
 
+bool PlayHistoryDao::cleanupAllDuplicateRecords()
+{
+    DAO_QUERY_SCOPE();
+    // 存在更新的同曲记录（时间相同时ID更大）的记录都删除
+    const QString sql = R"(
+        DELETE FROM play_history
+        WHERE EXISTS (
+            SELECT 1 FROM play_history newer
+            WHERE newer.song_id = play_history.song_id
+              AND (newer.played_at > play_history.played_at
+                   OR (newer.played_at = play_history.played_at AND newer.id > play_history.id))
+        )
+    )";
+    
+    QSqlQuery query = prepareQuery(sql);
+    if (!query.exec()) {
+        logError("cleanupAllDuplicateRecords", query.lastError().text());
+        return false;
+    }
+    
+    const int deletedCount = query.numRowsAffected();
+    if (deletedCount > 0) {
+        logInfo("cleanupAllDuplicateRecords", QString("清理了 %1 条重复记录").arg(deletedCount));
+    }
+    return true;
+}
+
 bool PlayHistoryDao::limitPlayHistoryRecords(int maxRecords)
 {
+    DAO_QUERY_SCOPE();
     // 如果记录数超过限制，删除最旧的记录
     const QString sql = R"(
         DELETE FROM play_history 
@@ -473,4 +573,22 @@ bool PlayHistoryDao::limitPlayHistoryRecords(int maxRecords)
         logError("limitPlayHistoryRecords", query.lastError().text());
         return false;
     }
-}
\ No newline at end of file
+}
+
+QSqlQuery PlayHistoryDao::prepareQuery(const QString& sql)
+{
+    if (!m_connection.isValid()) {
+        return BaseDao::prepareQuery(sql);
+    }
+    
+    QSqlQuery query(m_connection);
+    if (!query.prepare(sql)) {
+        logError("prepareQuery", "准备查询失败: " + query.lastError().text());
+    }
+    return query;
+}
+
+QSqlDatabase PlayHistoryDao::connection() const
+{
+    return m_connection.isValid() ? m_connection : dbManager()->database();
+}
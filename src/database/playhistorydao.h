@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlDatabase>
 #include <QList>
 #include <QDateTime>
 #include <QMutex>
@@ -17,6 +18,9 @@
  * 
  * 负责播放历史记录的增删改查操作
  * 支持最近播放列表的获取和管理
+ *
+ * 默认使用主连接；PlayHistoryRecorder的写线程传入自己的连接，
+ * 批量写入和清理在写线程中执行。
  */
 class PlayHistoryDao : public BaseDao
 {
@@ -24,6 +28,12 @@ class PlayHistoryDao : public BaseDao
 
 public:
     explicit PlayHistoryDao(QObject* parent = nullptr);
+
+    /**
+     * @brief 使用指定连接（必须在该连接所属的线程中使用）
+     * @param connection 数据库连接
+     */
+    explicit PlayHistoryDao(const QSqlDatabase& connection, QObject* parent = nullptr);
     ~PlayHistoryDao();
 
     /**
@@ -77,8 +87,8 @@ public:
     bool clearAllPlayHistory();
 
     /**
-     * @brief 获取播放历史统计信息
-     * @return 统计信息
+     * @brief 获取播放历史统计信息（读取PlayStatsDao的汇总表）
+     * @return 统计信息，totalRecords为累计播放次数
      */
     struct PlayHistoryStats {
         int totalRecords;
@@ -98,7 +108,7 @@ public:
     bool hasPlayHistory(int songId);
 
     /**
-     * @brief 获取歌曲的播放次数
+     * @brief 获取歌曲的累计播放次数（读取汇总表）
      * @param songId 歌曲ID
      * @return 播放次数
      */
@@ -112,12 +122,28 @@ public:
     QDateTime getLastPlayTime(int songId);
 
     /**
-     * @brief 批量添加播放记录
+     * @brief 批量添加播放记录（当前时间），在一个事务中写入
      * @param songIds 歌曲ID列表
-     * @return 成功添加的记录数
+     * @return 成功添加的记录数，失败时为-1
      */
     int batchAddPlayRecords(const QList<int>& songIds);
 
+    /**
+     * @brief 在一个事务中写入多条播放记录
+     * @details 同一歌曲同一时间的记录已存在时跳过，重放日志不会重复写入；
+     *          已不在曲库中的歌曲也跳过。不做去重和数量限制，由prunePlayHistory()定期清理。
+     * @param records 播放记录（使用songId和playedAt）
+     * @return 实际写入的记录数，失败时为-1（整批回滚）
+     */
+    int addPlayRecords(const QList<PlayHistory>& records);
+
+    /**
+     * @brief 清理播放历史：每首歌只保留最新的记录，并限制总记录数
+     * @param maxRecords 最大记录数
+     * @return 是否成功
+     */
+    bool prunePlayHistory(int maxRecords = 1000);
+
     /**
      * @brief 获取播放历史记录数量
      * @return 记录数量
@@ -130,8 +156,17 @@ public:
      */
     int getUniqueSongCount();
 
+protected:
+    QSqlQuery prepareQuery(const QString& sql) override;
+
 private:
     mutable QMutex m_mutex;
+    QSqlDatabase m_connection;   // 无效时使用主连接
+
+    /**
+     * @brief 本对象使用的连接
+     */
+    QSqlDatabase connection() const;
 
     /**
      * @brief 从查询结果创建PlayHistory对象
@@ -154,6 +189,12 @@ private:
      */
     bool cleanupDuplicateRecords(int songId);
 
+    /**
+     * @brief 清理所有歌曲的重复记录，每首歌保留最新的
+     * @return 是否成功
+     */
+    bool cleanupAllDuplicateRecords();
+
     /**
      * @brief 限制播放历史记录数量
      * @param maxRecords 最大记录数
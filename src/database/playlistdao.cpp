@@ -6,7 +6,26 @@
 #include <QSqlError>
 #include <QVariant>
 #include <QDateTime>
+#include <QStringList>
 #include <QDebug>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+namespace {
+
+// 较旧的SQLite单条语句最多绑定999个参数
+const int INSERT_ROWS_PER_STATEMENT = 200;  // 每行4个参数
+const int IN_LIST_CHUNK = 500;
+
+QString placeholders(int count)
+{
+    QString marks = QString("?, ").repeated(count);
+    marks.chop(2);
+    return marks;
+}
+
+} // namespace
 
 PlaylistDao::PlaylistDao(QObject* parent)
     : BaseDao(parent)
@@ -21,6 +40,7 @@ PlaylistDao::~PlaylistDao()
 
 int PlaylistDao::addPlaylist(const Playlist& playlist)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         logError("PlaylistDao::addPlaylist", "数据库未连接");
         return -1;
@@ -86,6 +106,7 @@ int PlaylistDao::addPlaylist(const Playlist& playlist)
 
 bool PlaylistDao::updatePlaylist(const Playlist& playlist)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         logError("PlaylistDao::updatePlaylist", "数据库未连接");
         return false;
@@ -148,6 +169,7 @@ bool PlaylistDao::updatePlaylist(const Playlist& playlist)
 
 bool PlaylistDao::deletePlaylist(int id)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         logError("PlaylistDao::deletePlaylist", "数据库未连接");
         return false;
@@ -207,6 +229,7 @@ bool PlaylistDao::deletePlaylist(int id)
 
 Playlist PlaylistDao::getPlaylistById(int id) const
 {
+    DAO_QUERY_SCOPE();
     Playlist playlist;
     
     if (!dbManager() || !dbManager()->isInitialized()) {
@@ -249,6 +272,7 @@ Playlist PlaylistDao::getPlaylistById(int id) const
 
 Playlist PlaylistDao::getPlaylistByName(const QString& name) const
 {
+    DAO_QUERY_SCOPE();
     Playlist playlist;
     
     if (!dbManager() || !dbManager()->isInitialized()) {
@@ -291,6 +315,7 @@ Playlist PlaylistDao::getPlaylistByName(const QString& name) const
 
 QList<Playlist> PlaylistDao::getAllPlaylists() const
 {
+    DAO_QUERY_SCOPE();
     QList<Playlist> playlists;
     
     if (!dbManager() || !dbManager()->isInitialized()) {
@@ -331,6 +356,7 @@ QList<Playlist> PlaylistDao::getAllPlaylists() const
 
 bool PlaylistDao::playlistExists(const QString& name) const
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         return false;
     }
@@ -365,6 +391,7 @@ bool PlaylistDao::playlistExists(const QString& name) const
 
 bool PlaylistDao::playlistExists(int id) const
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         return false;
     }
@@ -397,8 +424,9 @@ bool PlaylistDao::playlistExists(int id) const
     }
 }
 
-bool PlaylistDao::addSongToPlaylist(int playlistId, int songId, int sortOrder)
+bool PlaylistDao::addSongToPlaylist(int playlistId, int songId, qint64 sortOrder)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         logError("PlaylistDao::addSongToPlaylist", "数据库未连接");
         return false;
@@ -410,15 +438,17 @@ bool PlaylistDao::addSongToPlaylist(int playlistId, int songId, int sortOrder)
     }
     
     try {
-        // 如果没有指定排序序号，获取下一个序号
+        // 如果没有指定排序键，追加到末尾
         if (sortOrder < 0) {
             sortOrder = getNextSortOrder(playlistId);
         }
         
         QSqlQuery query(dbManager()->database());
+        // 已存在时原地更新；REPLACE会先删除旧行，而删除触发器不会因此触发，统计会重复计数
         QString sql = QString(
-            "INSERT OR REPLACE INTO %1 (playlist_id, song_id, sort_order, added_at) "
-            "VALUES (?, ?, ?, ?)"
+            "INSERT INTO %1 (playlist_id, song_id, sort_order, added_at) VALUES (?, ?, ?, ?) "
+            "ON CONFLICT(playlist_id, song_id) DO UPDATE SET "
+            "sort_order = excluded.sort_order, added_at = excluded.added_at"
         ).arg(Constants::Database::TABLE_PLAYLIST_SONGS);
         
         query.prepare(sql);
@@ -447,6 +477,7 @@ bool PlaylistDao::addSongToPlaylist(int playlistId, int songId, int sortOrder)
 
 bool PlaylistDao::removeSongFromPlaylist(int playlistId, int songId)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         logError("PlaylistDao::removeSongFromPlaylist", "数据库未连接");
         return false;
@@ -479,11 +510,7 @@ bool PlaylistDao::removeSongFromPlaylist(int playlistId, int songId)
             return false;
         }
         
-        // 重新排序播放列表中的歌曲
-        reorderPlaylistSongs(playlistId);
-        
-        // 更新播放列表统计信息
-        updatePlaylistStatistics(playlistId);
+        // 排序键带间隔，删除一行不需要改动其他歌曲；统计信息由触发器维护
         
         // Logger::instance().logInfo("PlaylistDao::removeSongFromPlaylist",
         //     QString("成功从播放列表 %1 移除歌曲 %2").arg(playlistId).arg(songId));
@@ -499,6 +526,7 @@ bool PlaylistDao::removeSongFromPlaylist(int playlistId, int songId)
 
 QList<Song> PlaylistDao::getPlaylistSongs(int playlistId) const
 {
+    DAO_QUERY_SCOPE();
     QList<Song> songs;
     
     if (!dbManager() || !dbManager()->isInitialized()) {
@@ -518,7 +546,7 @@ QList<Song> PlaylistDao::getPlaylistSongs(int playlistId) const
             "SELECT s.* FROM %1 s "
             "INNER JOIN %2 ps ON s.id = ps.song_id "
             "WHERE ps.playlist_id = ? "
-            "ORDER BY ps.sort_order ASC"
+            "ORDER BY ps.sort_order ASC, ps.id ASC"
         ).arg(Constants::Database::TABLE_SONGS)
          .arg(Constants::Database::TABLE_PLAYLIST_SONGS);
         
@@ -547,8 +575,56 @@ QList<Song> PlaylistDao::getPlaylistSongs(int playlistId) const
     }
 }
 
+bool PlaylistDao::forEachPlaylistSong(int playlistId, const std::function<bool(const Song&)>& visitor) const
+{
+    DAO_QUERY_SCOPE();
+    if (!dbManager() || !dbManager()->isInitialized()) {
+        logError("PlaylistDao::forEachPlaylistSong", "数据库未连接");
+        return false;
+    }
+    
+    if (playlistId <= 0) {
+        logError("PlaylistDao::forEachPlaylistSong", "无效的播放列表ID");
+        return false;
+    }
+    
+    try {
+        SongDao songDao;
+        QSqlQuery query(dbManager()->database());
+        query.setForwardOnly(true);
+        query.prepare(QString(
+            "SELECT s.* FROM %1 s "
+            "INNER JOIN %2 ps ON s.id = ps.song_id "
+            "WHERE ps.playlist_id = ? "
+            "ORDER BY ps.sort_order ASC, ps.id ASC"
+        ).arg(Constants::Database::TABLE_SONGS)
+         .arg(Constants::Database::TABLE_PLAYLIST_SONGS));
+        query.addBindValue(playlistId);
+        
+        if (!query.exec()) {
+            logError("PlaylistDao::forEachPlaylistSong",
+                QString("查询播放列表歌曲失败: %1").arg(query.lastError().text()));
+            return false;
+        }
+        
+        while (query.next()) {
+            const Song song = songDao.createSongFromQuery(query);
+            if (song.isValid() && !visitor(song)) {
+                break;
+            }
+        }
+        return true;
+        
+    } catch (const std::exception& e) {
+        logError("PlaylistDao::forEachPlaylistSong",
+            QString("读取播放列表歌曲时发生异常: %1").arg(e.what()));
+        return false;
+    }
+}
+
 int PlaylistDao::getPlaylistSongCount(int playlistId) const
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         return 0;
     }
@@ -583,6 +659,7 @@ int PlaylistDao::getPlaylistSongCount(int playlistId) const
 
 bool PlaylistDao::clearPlaylist(int playlistId)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         logError("PlaylistDao::clearPlaylist", "数据库未连接");
         return false;
@@ -608,9 +685,6 @@ bool PlaylistDao::clearPlaylist(int playlistId)
             return false;
         }
         
-        // 更新播放列表统计信息
-        updatePlaylistStatistics(playlistId);
-        
         // Logger::instance().logInfo("PlaylistDao::clearPlaylist",
         //     QString("成功清空播放列表 %1").arg(playlistId));
         
@@ -625,6 +699,7 @@ bool PlaylistDao::clearPlaylist(int playlistId)
 
 bool PlaylistDao::updatePlaylistStatistics(int playlistId)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         return false;
     }
@@ -674,8 +749,48 @@ bool PlaylistDao::updatePlaylistStatistics(int playlistId)
     }
 }
 
+PlaylistSummary PlaylistDao::getPlaylistSummary() const
+{
+    DAO_QUERY_SCOPE();
+    PlaylistSummary summary;
+    if (!dbManager() || !dbManager()->isInitialized()) {
+        return summary;
+    }
+    
+    try {
+        QSqlQuery query(dbManager()->database());
+        query.setForwardOnly(true);
+        const QString sql = QString(
+            "SELECT COUNT(*), COALESCE(SUM(song_count), 0), COALESCE(SUM(total_duration), 0), "
+            "COALESCE(MAX(song_count), 0), COALESCE(MIN(NULLIF(song_count, 0)), 0), "
+            "(SELECT name FROM %1 ORDER BY song_count DESC, id ASC LIMIT 1) "
+            "FROM %1"
+        ).arg(Constants::Database::TABLE_PLAYLISTS);
+        
+        if (!query.exec(sql) || !query.next()) {
+            logError("PlaylistDao::getPlaylistSummary",
+                QString("查询播放列表汇总失败: %1").arg(query.lastError().text()));
+            return summary;
+        }
+        
+        summary.playlistCount = query.value(0).toInt();
+        summary.totalSongs = query.value(1).toInt();
+        summary.totalDuration = query.value(2).toLongLong();
+        summary.longestSongCount = query.value(3).toInt();
+        summary.shortestNonEmptySongCount = query.value(4).toInt();
+        summary.longestPlaylistName = query.value(5).toString();
+        return summary;
+        
+    } catch (const std::exception& e) {
+        logError("PlaylistDao::getPlaylistSummary",
+            QString("查询播放列表汇总时发生异常: %1").arg(e.what()));
+        return summary;
+    }
+}
+
 QList<Playlist> PlaylistDao::getRecentPlaylists(int count) const
 {
+    DAO_QUERY_SCOPE();
     QList<Playlist> playlists;
     
     if (!dbManager() || !dbManager()->isInitialized()) {
@@ -714,6 +829,7 @@ QList<Playlist> PlaylistDao::getRecentPlaylists(int count) const
 
 QList<Playlist> PlaylistDao::getFavoritePlaylists() const
 {
+    DAO_QUERY_SCOPE();
     QList<Playlist> playlists;
     
     if (!dbManager() || !dbManager()->isInitialized()) {
@@ -776,8 +892,9 @@ Playlist PlaylistDao::createPlaylistFromQuery(const QSqlQuery& query) const
     return playlist;
 }
 
-int PlaylistDao::getNextSortOrder(int playlistId) const
+qint64 PlaylistDao::getNextSortOrder(int playlistId) const
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
         return 0;
     }
@@ -785,71 +902,453 @@ int PlaylistDao::getNextSortOrder(int playlistId) const
     try {
         QSqlQuery query(dbManager()->database());
         QString sql = QString(
-            "SELECT COALESCE(MAX(sort_order), -1) + 1 FROM %1 WHERE playlist_id = ?"
+            "SELECT MAX(sort_order) FROM %1 WHERE playlist_id = ?"
         ).arg(Constants::Database::TABLE_PLAYLIST_SONGS);
         
         query.prepare(sql);
         query.addBindValue(playlistId);
         
-        if (!query.exec() || !query.next()) {
-            return 0;
+        if (!query.exec() || !query.next() || query.value(0).isNull()) {
+            return SORT_KEY_GAP;
         }
         
-        return query.value(0).toInt();
+        return query.value(0).toLongLong() + SORT_KEY_GAP;
         
     } catch (const std::exception& e) {
-        return 0;
+        return SORT_KEY_GAP;
     }
 }
 
-bool PlaylistDao::reorderPlaylistSongs(int playlistId)
+bool PlaylistDao::moveSongInPlaylist(int playlistId, int songId, int beforeSongId)
 {
+    DAO_QUERY_SCOPE();
     if (!dbManager() || !dbManager()->isInitialized()) {
+        logError("PlaylistDao::moveSongInPlaylist", "数据库未连接");
         return false;
     }
     
-    if (playlistId <= 0) {
+    if (playlistId <= 0 || songId <= 0) {
+        logError("PlaylistDao::moveSongInPlaylist", "无效的播放列表ID或歌曲ID");
+        return false;
+    }
+    
+    if (beforeSongId == songId) {
+        return true;
+    }
+    
+    QSqlDatabase db = dbManager()->database();
+    if (!db.transaction()) {
+        logError("PlaylistDao::moveSongInPlaylist", "无法开始事务: " + db.lastError().text());
         return false;
     }
     
     try {
-        // 获取当前播放列表中的所有歌曲ID，按当前排序
-        QSqlQuery selectQuery(dbManager()->database());
-        QString selectSql = QString(
-            "SELECT id, song_id FROM %1 "
-            "WHERE playlist_id = ? "
-            "ORDER BY sort_order ASC"
-        ).arg(Constants::Database::TABLE_PLAYLIST_SONGS);
-        
-        selectQuery.prepare(selectSql);
-        selectQuery.addBindValue(playlistId);
+        bool needsRebalance = false;
+        if (moveRows(playlistId, {songId}, beforeSongId, &needsRebalance) != 1) {
+            db.rollback();
+            return false;
+        }
         
-        if (!selectQuery.exec()) {
+        if (!db.commit()) {
+            logError("PlaylistDao::moveSongInPlaylist", "提交事务失败: " + db.lastError().text());
+            db.rollback();
             return false;
         }
         
-        // 重新分配排序序号
-        int newSortOrder = 0;
-        while (selectQuery.next()) {
-            int id = selectQuery.value("id").toInt();
-            
-            QSqlQuery updateQuery(dbManager()->database());
-            QString updateSql = QString(
-                "UPDATE %1 SET sort_order = ? WHERE id = ?"
-            ).arg(Constants::Database::TABLE_PLAYLIST_SONGS);
+        if (needsRebalance) {
+            scheduleRebalance(playlistId);
+        }
+        return true;
+        
+    } catch (const std::exception& e) {
+        db.rollback();
+        logError("PlaylistDao::moveSongInPlaylist",
+            QString("移动播放列表歌曲时发生异常: %1").arg(e.what()));
+        return false;
+    }
+}
+
+PlaylistMutationResult PlaylistDao::applyMutation(int playlistId, const PlaylistMutation& mutation)
+{
+    DAO_QUERY_SCOPE();
+    PlaylistMutationResult result;
+    
+    if (!dbManager() || !dbManager()->isInitialized()) {
+        logError("PlaylistDao::applyMutation", "数据库未连接");
+        return result;
+    }
+    
+    if (playlistId <= 0) {
+        logError("PlaylistDao::applyMutation", "无效的播放列表ID");
+        return result;
+    }
+    
+    QSqlDatabase db = dbManager()->database();
+    if (!db.transaction()) {
+        logError("PlaylistDao::applyMutation", "无法开始事务: " + db.lastError().text());
+        return result;
+    }
+    
+    try {
+        const QString table = Constants::Database::TABLE_PLAYLIST_SONGS;
+        
+        // 删除：只删除确实在列表中的歌曲，IN列表分块
+        if (!mutation.removeSongIds.isEmpty()) {
+            const QSet<int> present = existingSongIds(playlistId, mutation.removeSongIds);
+            QSet<int> seen;
+            for (int songId : mutation.removeSongIds) {
+                if (present.contains(songId) && !seen.contains(songId)) {
+                    seen.insert(songId);
+                    result.removedSongIds.append(songId);
+                }
+            }
             
-            updateQuery.prepare(updateSql);
-            updateQuery.addBindValue(newSortOrder++);
-            updateQuery.addBindValue(id);
+            for (int offset = 0; offset < result.removedSongIds.size(); offset += IN_LIST_CHUNK) {
+                const QList<int> chunk = result.removedSongIds.mid(offset, IN_LIST_CHUNK);
+                QSqlQuery query(db);
+                query.prepare(QString("DELETE FROM %1 WHERE playlist_id = ? AND song_id IN (%2)")
+                                  .arg(table, placeholders(chunk.size())));
+                query.addBindValue(playlistId);
+                for (int songId : chunk) {
+                    query.addBindValue(songId);
+                }
+                if (!query.exec()) {
+                    logError("PlaylistDao::applyMutation",
+                        QString("批量移除歌曲失败: %1").arg(query.lastError().text()));
+                    db.rollback();
+                    return PlaylistMutationResult();
+                }
+            }
+        }
+        
+        // 追加：跳过已在列表中的歌曲和重复ID，排序键接在当前末尾之后
+        if (!mutation.appendSongIds.isEmpty()) {
+            QSet<int> seen = existingSongIds(playlistId, mutation.appendSongIds);
+            for (int songId : mutation.appendSongIds) {
+                if (songId > 0 && !seen.contains(songId)) {
+                    seen.insert(songId);
+                    result.appendedSongIds.append(songId);
+                }
+            }
             
-            if (!updateQuery.exec()) {
-                return false;
+            if (!result.appendedSongIds.isEmpty()
+                && !insertRows(playlistId, result.appendedSongIds, getNextSortOrder(playlistId))) {
+                db.rollback();
+                return PlaylistMutationResult();
+            }
+        }
+        
+        // 移动：只改写被移动的行
+        bool needsRebalance = false;
+        if (!mutation.moveSongIds.isEmpty()) {
+            result.movedCount = moveRows(playlistId, mutation.moveSongIds, mutation.moveBeforeSongId, &needsRebalance);
+            if (result.movedCount < 0) {
+                db.rollback();
+                return PlaylistMutationResult();
+            }
+        }
+        
+        // 歌曲数和总时长已由触发器随每行增删更新
+        result.playlist = getPlaylistById(playlistId);
+        
+        if (!db.commit()) {
+            logError("PlaylistDao::applyMutation", "提交事务失败: " + db.lastError().text());
+            db.rollback();
+            return PlaylistMutationResult();
+        }
+        
+        if (needsRebalance) {
+            scheduleRebalance(playlistId);
+        }
+        result.success = true;
+        return result;
+        
+    } catch (const std::exception& e) {
+        db.rollback();
+        logError("PlaylistDao::applyMutation",
+            QString("批量修改播放列表时发生异常: %1").arg(e.what()));
+        return PlaylistMutationResult();
+    }
+}
+
+int PlaylistDao::moveRows(int playlistId, const QList<int>& songIds, int beforeSongId, bool* needsRebalance)
+{
+    *needsRebalance = false;
+    
+    // 去重，并排除插入位置本身
+    QList<int> moving;
+    QSet<int> movingSet;
+    for (int songId : songIds) {
+        if (songId > 0 && songId != beforeSongId && !movingSet.contains(songId)) {
+            movingSet.insert(songId);
+            moving.append(songId);
+        }
+    }
+    if (moving.isEmpty()) {
+        return 0;
+    }
+    const qint64 count = moving.size();
+    
+    qint64 firstKey = 0;
+    qint64 step = SORT_KEY_GAP;
+    bool placed = false;
+    for (int attempt = 0; attempt < 2 && !placed; ++attempt) {
+        qint64 prevKey = 0;
+        qint64 nextKey = 0;
+        bool hasPrev = false;
+        if (!neighbourKeys(playlistId, movingSet, beforeSongId, &prevKey, &hasPrev, &nextKey)) {
+            return -1;
+        }
+        
+        if (beforeSongId <= 0) {
+            // 移到末尾：最大键之后按完整间隔排列
+            firstKey = (hasPrev ? prevKey : 0) + SORT_KEY_GAP;
+            placed = true;
+        } else if (!hasPrev) {
+            // 移到开头：第一首歌之前按完整间隔排列（键可以为负）
+            firstKey = nextKey - SORT_KEY_GAP * count;
+            placed = true;
+        } else {
+            step = (nextKey - prevKey) / (count + 1);
+            if (step >= 1) {
+                firstKey = prevKey + step;
+                *needsRebalance = step < SORT_KEY_MIN_GAP;
+                placed = true;
+            } else if (attempt > 0 || !rebalanceRows(playlistId)) {
+                // 空隙不够时先重排再算一次
+                return -1;
+            }
+        }
+    }
+    if (!placed) {
+        return -1;
+    }
+    
+    QSqlQuery query(dbManager()->database());
+    query.prepare(QString(
+        "UPDATE %1 SET sort_order = ? WHERE playlist_id = ? AND song_id = ?"
+    ).arg(Constants::Database::TABLE_PLAYLIST_SONGS));
+    
+    for (qint64 i = 0; i < count; ++i) {
+        query.bindValue(0, firstKey + i * step);
+        query.bindValue(1, playlistId);
+        query.bindValue(2, moving[i]);
+        if (!query.exec()) {
+            logError("PlaylistDao::moveRows",
+                QString("移动播放列表歌曲失败: %1").arg(query.lastError().text()));
+            return -1;
+        }
+        if (query.numRowsAffected() == 0) {
+            logError("PlaylistDao::moveRows",
+                QString("歌曲 %1 不在播放列表 %2 中").arg(moving[i]).arg(playlistId));
+            return -1;
+        }
+    }
+    return static_cast<int>(count);
+}
+
+bool PlaylistDao::neighbourKeys(int playlistId, const QSet<int>& movingSongIds, int beforeSongId,
+                                qint64* prevKey, bool* hasPrev, qint64* nextKey) const
+{
+    const QString table = Constants::Database::TABLE_PLAYLIST_SONGS;
+    *hasPrev = false;
+    
+    if (beforeSongId > 0) {
+        QSqlQuery nextQuery(dbManager()->database());
+        nextQuery.prepare(QString("SELECT sort_order FROM %1 WHERE playlist_id = ? AND song_id = ?").arg(table));
+        nextQuery.addBindValue(playlistId);
+        nextQuery.addBindValue(beforeSongId);
+        if (!nextQuery.exec() || !nextQuery.next()) {
+            logError("PlaylistDao::neighbourKeys",
+                QString("歌曲 %1 不在播放列表 %2 中").arg(beforeSongId).arg(playlistId));
+            return false;
+        }
+        *nextKey = nextQuery.value(0).toLongLong();
+    }
+    
+    // 从插入位置沿(playlist_id, sort_order)索引向前扫描，跳过正在移动的歌曲
+    QSqlQuery prevQuery(dbManager()->database());
+    prevQuery.setForwardOnly(true);
+    if (beforeSongId > 0) {
+        prevQuery.prepare(QString(
+            "SELECT song_id, sort_order FROM %1 WHERE playlist_id = ? AND sort_order < ? "
+            "ORDER BY sort_order DESC").arg(table));
+        prevQuery.addBindValue(playlistId);
+        prevQuery.addBindValue(*nextKey);
+    } else {
+        prevQuery.prepare(QString(
+            "SELECT song_id, sort_order FROM %1 WHERE playlist_id = ? ORDER BY sort_order DESC").arg(table));
+        prevQuery.addBindValue(playlistId);
+    }
+    if (!prevQuery.exec()) {
+        return false;
+    }
+    while (prevQuery.next()) {
+        if (!movingSongIds.contains(prevQuery.value(0).toInt())) {
+            *prevKey = prevQuery.value(1).toLongLong();
+            *hasPrev = true;
+            break;
+        }
+    }
+    return true;
+}
+
+QSet<int> PlaylistDao::existingSongIds(int playlistId, const QList<int>& songIds) const
+{
+    QSet<int> existing;
+    for (int offset = 0; offset < songIds.size(); offset += IN_LIST_CHUNK) {
+        const QList<int> chunk = songIds.mid(offset, IN_LIST_CHUNK);
+        QSqlQuery query(dbManager()->database());
+        query.setForwardOnly(true);
+        query.prepare(QString("SELECT song_id FROM %1 WHERE playlist_id = ? AND song_id IN (%2)")
+                          .arg(Constants::Database::TABLE_PLAYLIST_SONGS, placeholders(chunk.size())));
+        query.addBindValue(playlistId);
+        for (int songId : chunk) {
+            query.addBindValue(songId);
+        }
+        if (!query.exec()) {
+            continue;
+        }
+        while (query.next()) {
+            existing.insert(query.value(0).toInt());
+        }
+    }
+    return existing;
+}
+
+bool PlaylistDao::insertRows(int playlistId, const QList<int>& songIds, qint64 firstKey)
+{
+    const QString sqlPrefix = QString(
+        "INSERT INTO %1 (playlist_id, song_id, sort_order, added_at) VALUES "
+    ).arg(Constants::Database::TABLE_PLAYLIST_SONGS);
+    const QDateTime now = QDateTime::currentDateTime();
+    
+    // 满块共用一条预编译语句，最后不足一块的部分单独准备
+    QSqlQuery query(dbManager()->database());
+    int preparedRows = 0;
+    qint64 key = firstKey;
+    for (int offset = 0; offset < songIds.size(); offset += INSERT_ROWS_PER_STATEMENT) {
+        const int rows = qMin(INSERT_ROWS_PER_STATEMENT, static_cast<int>(songIds.size()) - offset);
+        if (rows != preparedRows) {
+            QStringList values;
+            for (int i = 0; i < rows; ++i) {
+                values.append("(?, ?, ?, ?)");
             }
+            query.prepare(sqlPrefix + values.join(", "));
+            preparedRows = rows;
+        }
+        
+        int index = 0;
+        for (int i = 0; i < rows; ++i) {
+            query.bindValue(index++, playlistId);
+            query.bindValue(index++, songIds[offset + i]);
+            query.bindValue(index++, key);
+            query.bindValue(index++, now);
+            key += SORT_KEY_GAP;
+        }
+        
+        if (!query.exec()) {
+            logError("PlaylistDao::insertRows",
+                QString("批量添加歌曲到播放列表失败: %1").arg(query.lastError().text()));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PlaylistDao::rebalancePlaylist(int playlistId)
+{
+    DAO_QUERY_SCOPE();
+    if (!dbManager() || !dbManager()->isInitialized()) {
+        return false;
+    }
+    
+    if (playlistId <= 0) {
+        return false;
+    }
+    
+    QSqlDatabase db = dbManager()->database();
+    if (!db.transaction()) {
+        logError("PlaylistDao::rebalancePlaylist", "无法开始事务: " + db.lastError().text());
+        return false;
+    }
+    
+    try {
+        if (!rebalanceRows(playlistId)) {
+            db.rollback();
+            return false;
+        }
+        
+        if (!db.commit()) {
+            logError("PlaylistDao::rebalancePlaylist", "提交事务失败: " + db.lastError().text());
+            db.rollback();
+            return false;
         }
         
         return true;
         
     } catch (const std::exception& e) {
+        db.rollback();
         return false;
     }
-}
\ No newline at end of file
+}
+
+bool PlaylistDao::rebalanceRows(int playlistId)
+{
+    QSqlDatabase db = dbManager()->database();
+    
+    // 获取当前播放列表中的所有行，按当前排序
+    QSqlQuery selectQuery(db);
+    selectQuery.setForwardOnly(true);
+    selectQuery.prepare(QString(
+        "SELECT id FROM %1 WHERE playlist_id = ? ORDER BY sort_order ASC, id ASC"
+    ).arg(Constants::Database::TABLE_PLAYLIST_SONGS));
+    selectQuery.addBindValue(playlistId);
+    
+    if (!selectQuery.exec()) {
+        return false;
+    }
+    
+    QVector<int> rowIds;
+    while (selectQuery.next()) {
+        rowIds.append(selectQuery.value(0).toInt());
+    }
+    selectQuery.finish();
+    
+    // 同一条预编译语句重复绑定执行
+    QSqlQuery updateQuery(db);
+    updateQuery.prepare(QString(
+        "UPDATE %1 SET sort_order = ? WHERE id = ?"
+    ).arg(Constants::Database::TABLE_PLAYLIST_SONGS));
+    
+    qint64 key = 0;
+    for (int rowId : rowIds) {
+        key += SORT_KEY_GAP;
+        updateQuery.bindValue(0, key);
+        updateQuery.bindValue(1, rowId);
+        if (!updateQuery.exec()) {
+            logError("PlaylistDao::rebalanceRows",
+                QString("重排播放列表失败: %1").arg(updateQuery.lastError().text()));
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void PlaylistDao::scheduleRebalance(int playlistId)
+{
+    // 只在数据库连接所在线程调用，等待中的列表不需要加锁
+    static QSet<int> pendingPlaylists;
+    if (pendingPlaylists.contains(playlistId)) {
+        return;
+    }
+    pendingPlaylists.insert(playlistId);
+    
+    // 稍后执行，连续拖动同一列表时只重排一次
+    QTimer::singleShot(500, DatabaseManager::instance(), [playlistId]() {
+        pendingPlaylists.remove(playlistId);
+        PlaylistDao dao;
+        dao.rebalancePlaylist(playlistId);
+    });
+}
@@ -7,18 +7,66 @@
 #include <QList>
 #include <QString>
 #include <QDateTime>
+#include <QSet>
+#include <functional>
+
+/**
+ * @brief 一次批量修改：在同一个事务中依次删除、追加、移动
+ */
+struct PlaylistMutation
+{
+    QList<int> removeSongIds;
+    QList<int> appendSongIds;      // 已在列表中的歌曲保持原位置，不重复追加
+    QList<int> moveSongIds;        // 按给定顺序连续放到moveBeforeSongId之前
+    int moveBeforeSongId = -1;     // <=0表示移到末尾
+
+    bool isEmpty() const { return removeSongIds.isEmpty() && appendSongIds.isEmpty() && moveSongIds.isEmpty(); }
+};
+
+/**
+ * @brief 全部播放列表的汇总统计
+ */
+struct PlaylistSummary
+{
+    int playlistCount = 0;
+    int totalSongs = 0;
+    qint64 totalDuration = 0;
+    int longestSongCount = 0;
+    QString longestPlaylistName;
+    int shortestNonEmptySongCount = 0;   // 不计空列表
+};
+
+/**
+ * @brief 批量修改的结果
+ */
+struct PlaylistMutationResult
+{
+    bool success = false;
+    QList<int> removedSongIds;     // 实际删除的歌曲
+    QList<int> appendedSongIds;    // 实际追加的歌曲，按顺序位于列表末尾
+    int movedCount = 0;
+    Playlist playlist;             // 修改后的播放列表（含最新统计信息）
+};
 
 /**
  * @brief 播放列表数据访问对象
  * 
  * 负责播放列表相关的数据库操作，包括播放列表的增删改查、
  * 播放列表与歌曲的关联管理等功能。
+ *
+ * 播放列表内的顺序使用带间隔的排序键（playlist_songs.sort_order）：追加时取末尾键加SORT_KEY_GAP，
+ * 移动时取前后两首歌键值的中点，删除不改动其他行。相邻键的空隙变小后在事件循环空闲时重排整个列表。
  */
 class PlaylistDao : public BaseDao
 {
     Q_OBJECT
     
 public:
+    // 重排后相邻歌曲排序键的间隔
+    static constexpr qint64 SORT_KEY_GAP = Q_INT64_C(1) << 20;
+    // 移动后空隙小于该值时安排后台重排
+    static constexpr qint64 SORT_KEY_MIN_GAP = 16;
+
     explicit PlaylistDao(QObject* parent = nullptr);
     ~PlaylistDao() override;
     
@@ -83,10 +131,10 @@ public:
      * @brief 添加歌曲到播放列表
      * @param playlistId 播放列表ID
      * @param songId 歌曲ID
-     * @param sortOrder 排序序号
+     * @param sortOrder 排序键，小于0时追加到末尾
      * @return 操作是否成功
      */
-    bool addSongToPlaylist(int playlistId, int songId, int sortOrder = -1);
+    bool addSongToPlaylist(int playlistId, int songId, qint64 sortOrder = -1);
     
     /**
      * @brief 从播放列表移除歌曲
@@ -96,6 +144,32 @@ public:
      */
     bool removeSongFromPlaylist(int playlistId, int songId);
     
+    /**
+     * @brief 移动播放列表中的歌曲
+     * @param playlistId 播放列表ID
+     * @param songId 要移动的歌曲ID
+     * @param beforeSongId 移到该歌曲之前，<=0表示移到末尾
+     * @return 操作是否成功
+     * @details 只更新被移动的一行；前后两首歌的排序键已经相邻时先重排整个列表
+     */
+    bool moveSongInPlaylist(int playlistId, int songId, int beforeSongId);
+    
+    /**
+     * @brief 在一个事务中执行批量修改
+     * @param playlistId 播放列表ID
+     * @param mutation 要删除、追加和移动的歌曲
+     * @return 实际生效的修改；任何一步失败时整体回滚，success为false
+     * @details 追加使用多行INSERT，删除使用IN列表，移动只改写被移动的行
+     */
+    PlaylistMutationResult applyMutation(int playlistId, const PlaylistMutation& mutation);
+    
+    /**
+     * @brief 按当前顺序重新分配排序键（间隔SORT_KEY_GAP）
+     * @param playlistId 播放列表ID
+     * @return 操作是否成功
+     */
+    bool rebalancePlaylist(int playlistId);
+    
     /**
      * @brief 获取播放列表中的所有歌曲
      * @param playlistId 播放列表ID
@@ -103,6 +177,13 @@ public:
      */
     QList<Song> getPlaylistSongs(int playlistId) const;
     
+    /**
+     * @brief 按播放顺序逐首读取播放列表中的歌曲，不生成完整列表
+     * @param visitor 每首歌调用一次，返回false时停止
+     * @return 查询是否成功
+     */
+    bool forEachPlaylistSong(int playlistId, const std::function<bool(const Song&)>& visitor) const;
+    
     /**
      * @brief 获取播放列表中的歌曲数量
      * @param playlistId 播放列表ID
@@ -118,12 +199,19 @@ public:
     bool clearPlaylist(int playlistId);
     
     /**
-     * @brief 更新播放列表统计信息
+     * @brief 按关联表重新计算播放列表统计信息
+     * @details song_count和total_duration平时由数据库触发器随每行增删维护，
+     *          只有绕过触发器修改过数据时才需要调用
      * @param playlistId 播放列表ID
      * @return 操作是否成功
      */
     bool updatePlaylistStatistics(int playlistId);
     
+    /**
+     * @brief 全部播放列表的汇总统计，一条查询读取playlists表中维护好的列
+     */
+    PlaylistSummary getPlaylistSummary() const;
+    
     /**
      * @brief 获取最近播放的播放列表
      * @param count 数量限制
@@ -146,18 +234,48 @@ private:
     Playlist createPlaylistFromQuery(const QSqlQuery& query) const;
     
     /**
-     * @brief 获取下一个排序序号
+     * @brief 获取追加到末尾的排序键
      * @param playlistId 播放列表ID
-     * @return 排序序号
+     * @return 排序键（走(playlist_id, sort_order)索引，只读一行）
+     */
+    qint64 getNextSortOrder(int playlistId) const;
+    
+    /**
+     * @brief 把一组歌曲按顺序放到beforeSongId之前，只改写这些行（不开启事务）
+     * @param needsRebalance 输出新键之间的间隔是否已经小于SORT_KEY_MIN_GAP
+     * @return 移动的歌曲数，失败返回-1；没有可用的键时先重排再分配
      */
-    int getNextSortOrder(int playlistId) const;
+    int moveRows(int playlistId, const QList<int>& songIds, int beforeSongId, bool* needsRebalance);
     
     /**
-     * @brief 重新排序播放列表中的歌曲
+     * @brief 查找插入位置前后的排序键（跳过正在移动的歌曲）
+     * @param prevKey 输出前一首歌的键，hasPrev为false时无效
+     * @param nextKey 输出beforeSongId的键，beforeSongId<=0时无效
+     * @return 查询是否成功（beforeSongId不在列表中时失败）
+     */
+    bool neighbourKeys(int playlistId, const QSet<int>& movingSongIds, int beforeSongId,
+                       qint64* prevKey, bool* hasPrev, qint64* nextKey) const;
+    
+    /**
+     * @brief 在播放列表中已有的歌曲（IN列表分块查询）
+     */
+    QSet<int> existingSongIds(int playlistId, const QList<int>& songIds) const;
+    
+    /**
+     * @brief 多行INSERT追加歌曲，排序键从firstKey开始每首递增SORT_KEY_GAP（不开启事务）
+     */
+    bool insertRows(int playlistId, const QList<int>& songIds, qint64 firstKey);
+    
+    /**
+     * @brief 按当前顺序重新分配排序键（不开启事务）
+     */
+    bool rebalanceRows(int playlistId);
+    
+    /**
+     * @brief 在事件循环空闲时重排播放列表，同一列表的多次请求合并为一次
      * @param playlistId 播放列表ID
-     * @return 操作是否成功
      */
-    bool reorderPlaylistSongs(int playlistId);
+    static void scheduleRebalance(int playlistId);
 };
 
 #endif // PLAYLISTDAO_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "playqueuedao.h"
+#include "databasemanager.h"
+#include <QSqlError>
+#include <QDebug>
+
+PlayQueueDao::PlayQueueDao(QObject* parent)
+    : BaseDao(parent)
+{
+}
+
+PlayQueueDao::~PlayQueueDao()
+{
+}
+
+int PlayQueueDao::snapshotLibrary(const QString& table)
+{
+    DAO_QUERY_SCOPE();
+    return createSnapshot(table,
+                          "SELECT ROW_NUMBER() OVER (ORDER BY title, id), id FROM songs",
+                          QVariantList());
+}
+
+int PlayQueueDao::snapshotTag(const QString& table, int tagId)
+{
+    DAO_QUERY_SCOPE();
+    return createSnapshot(table,
+                          "SELECT ROW_NUMBER() OVER (ORDER BY s.title, s.id), s.id FROM songs s "
+                          "INNER JOIN song_tags st ON s.id = st.song_id "
+                          "WHERE st.tag_id = ?",
+                          QVariantList{tagId});
+}
+
+int PlayQueueDao::snapshotSearch(const QString& table, const QString& title)
+{
+    DAO_QUERY_SCOPE();
+    return createSnapshot(table,
+                          "SELECT ROW_NUMBER() OVER (ORDER BY title, id), id FROM songs WHERE title LIKE ?",
+                          QVariantList{"%" + title + "%"});
+}
+
+int PlayQueueDao::snapshotPlaylist(const QString& table, int playlistId)
+{
+    DAO_QUERY_SCOPE();
+    return createSnapshot(table,
+                          "SELECT ROW_NUMBER() OVER (ORDER BY sort_order, id), song_id FROM playlist_songs "
+                          "WHERE playlist_id = ?",
+                          QVariantList{playlistId});
+}
+
+QList<int> PlayQueueDao::snapshotIds(const QString& table, int offset, int limit)
+{
+    DAO_QUERY_SCOPE();
+    QList<int> ids;
+    QSqlQuery query = prepareQuery(QString("SELECT song_id FROM temp.%1 WHERE position > ? "
+                                           "ORDER BY position LIMIT ?").arg(table));
+    query.setForwardOnly(true);
+    query.addBindValue(offset);
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        logError("snapshotIds", query.lastError().text());
+        return ids;
+    }
+    while (query.next()) {
+        ids.append(query.value(0).toInt());
+    }
+    return ids;
+}
+
+void PlayQueueDao::dropSnapshot(const QString& table)
+{
+    if (!dbManager() || !dbManager()->isInitialized()) {
+        return;
+    }
+    executeUpdate(QString("DROP TABLE IF EXISTS temp.%1").arg(table));
+}
+
+int PlayQueueDao::createSnapshot(const QString& table, const QString& select, const QVariantList& bindValues)
+{
+    dropSnapshot(table);
+    if (!executeUpdate(QString("CREATE TEMP TABLE %1 (position INTEGER PRIMARY KEY, song_id INTEGER NOT NULL)")
+                           .arg(table))) {
+        logError("createSnapshot", "创建临时表失败: " + table);
+        return -1;
+    }
+
+    QSqlQuery query = prepareQuery(QString("INSERT INTO temp.%1 (position, song_id) %2").arg(table, select));
+    for (const QVariant& value : bindValues) {
+        query.addBindValue(value);
+    }
+    if (!query.exec()) {
+        logError("createSnapshot", query.lastError().text());
+        dropSnapshot(table);
+        return -1;
+    }
+    return query.numRowsAffected();
+}
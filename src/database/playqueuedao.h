@@ -0,0 +1,68 @@
+#ifndef PLAYQUEUEDAO_H
+#define PLAYQUEUEDAO_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QVariantList>
+
+#include "basedao.h"
+
+/**
+ * @brief 播放队列来源的ID快照
+ *
+ * 设置来源时把排好序的歌曲ID写入主连接上的临时表（position从1开始，作为主键），
+ * 之后按position范围读取窗口：定位是一次主键查找，与窗口在来源中的位置无关，
+ * 来源只在建快照时排序一次。快照建好后曲库的变化不影响它，位置不会错开。
+ * 临时表属于主连接，必须在主连接所属线程使用，连接关闭时自动删除。
+ */
+class PlayQueueDao : public BaseDao
+{
+    Q_OBJECT
+
+public:
+    explicit PlayQueueDao(QObject* parent = nullptr);
+    ~PlayQueueDao();
+
+    /**
+     * @brief 全部歌曲，与SongDao::getAllSongs顺序相同
+     * @param table 临时表名，已存在时先删除
+     * @return 歌曲数，失败时返回-1
+     */
+    int snapshotLibrary(const QString& table);
+
+    /**
+     * @brief 标签下的歌曲，与SongDao::getSongsByTag顺序相同
+     */
+    int snapshotTag(const QString& table, int tagId);
+
+    /**
+     * @brief 标题搜索，与SongDao::searchByTitle顺序相同
+     */
+    int snapshotSearch(const QString& table, const QString& title);
+
+    /**
+     * @brief 播放列表，按排序键
+     */
+    int snapshotPlaylist(const QString& table, int playlistId);
+
+    /**
+     * @brief 读取快照中的一段歌曲ID
+     * @param offset 起始位置（从0开始）
+     * @param limit 最多返回的数量
+     */
+    QList<int> snapshotIds(const QString& table, int offset, int limit);
+
+    /**
+     * @brief 删除快照，数据库已关闭时忽略
+     */
+    void dropSnapshot(const QString& table);
+
+private:
+    /**
+     * @param select 返回(position, song_id)两列的SELECT语句
+     */
+    int createSnapshot(const QString& table, const QString& select, const QVariantList& bindValues);
+};
+
+#endif // PLAYQUEUEDAO_H
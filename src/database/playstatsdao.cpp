@@ -0,0 +1,359 @@
+#include "playstatsdao.h"
+#include "databasemanager.h"
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDebug>
+
+const QString PlayStatsDao::UNKNOWN_ARTIST = QStringLiteral("未知艺术家");
+
+namespace {
+
+// 单条IN查询的参数数量上限，低于SQLite默认的999个变量限制
+const int IN_LIST_CHUNK = 500;
+
+QString dayKey(const QDate& day)
+{
+    return day.toString(Qt::ISODate);
+}
+
+} // namespace
+
+PlayStatsDao::PlayStatsDao(QObject* parent)
+    : BaseDao(parent)
+{
+}
+
+PlayStatsDao::~PlayStatsDao()
+{
+}
+
+QList<SongPlayStat> PlayStatsDao::getTopSongs(const QDate& from, const QDate& to, int limit)
+{
+    DAO_QUERY_SCOPE();
+    QList<SongPlayStat> result;
+    if (!from.isValid() || !to.isValid() || limit <= 0) {
+        return result;
+    }
+
+    // 只读取(day, song_id)主键范围内的行
+    const QString sql = R"(
+        SELECT d.song_id, SUM(d.play_count) AS plays, s.title, s.artist, ps.last_played_at
+        FROM play_stats_daily d
+        INNER JOIN songs s ON s.id = d.song_id
+        LEFT JOIN play_stats_song ps ON ps.song_id = d.song_id
+        WHERE d.day BETWEEN ? AND ?
+        GROUP BY d.song_id
+        ORDER BY plays DESC, ps.last_played_at DESC
+        LIMIT ?
+    )";
+
+    try {
+        QSqlQuery query = prepareQuery(sql);
+        query.addBindValue(dayKey(from));
+        query.addBindValue(dayKey(to));
+        query.addBindValue(limit);
+
+        if (!query.exec()) {
+            logError("getTopSongs", query.lastError().text());
+            return result;
+        }
+        while (query.next()) {
+            result.append(createSongStatFromQuery(query));
+        }
+    } catch (const std::exception& e) {
+        logError("getTopSongs", QString("查询播放统计时发生异常: %1").arg(e.what()));
+    }
+    return result;
+}
+
+QList<SongPlayStat> PlayStatsDao::getTopSongsThisWeek(int limit)
+{
+    const QDate today = QDate::currentDate();
+    return getTopSongs(today.addDays(-6), today, limit);
+}
+
+QList<SongPlayStat> PlayStatsDao::getTopSongsAllTime(int limit)
+{
+    DAO_QUERY_SCOPE();
+    QList<SongPlayStat> result;
+    if (limit <= 0) {
+        return result;
+    }
+
+    const QString sql = R"(
+        SELECT ps.song_id, ps.play_count AS plays, s.title, s.artist, ps.last_played_at
+        FROM play_stats_song ps
+        INNER JOIN songs s ON s.id = ps.song_id
+        ORDER BY ps.play_count DESC
+        LIMIT ?
+    )";
+
+    try {
+        QSqlQuery query = prepareQuery(sql);
+        query.addBindValue(limit);
+
+        if (!query.exec()) {
+            logError("getTopSongsAllTime", query.lastError().text());
+            return result;
+        }
+        while (query.next()) {
+            result.append(createSongStatFromQuery(query));
+        }
+    } catch (const std::exception& e) {
+        logError("getTopSongsAllTime", QString("查询播放统计时发生异常: %1").arg(e.what()));
+    }
+    return result;
+}
+
+QList<DailyPlayCount> PlayStatsDao::getPlaysPerDay(const QDate& from, const QDate& to)
+{
+    DAO_QUERY_SCOPE();
+    QList<DailyPlayCount> result;
+    if (!from.isValid() || !to.isValid() || from > to) {
+        return result;
+    }
+
+    QHash<QString, int> counts;
+    try {
+        QSqlQuery query = prepareQuery("SELECT day, play_count FROM play_stats_day WHERE day BETWEEN ? AND ?");
+        query.addBindValue(dayKey(from));
+        query.addBindValue(dayKey(to));
+
+        if (!query.exec()) {
+            logError("getPlaysPerDay", query.lastError().text());
+            return result;
+        }
+        while (query.next()) {
+            counts.insert(query.value(0).toString(), query.value(1).toInt());
+        }
+    } catch (const std::exception& e) {
+        logError("getPlaysPerDay", QString("查询每日播放次数时发生异常: %1").arg(e.what()));
+        return result;
+    }
+
+    result.reserve(from.daysTo(to) + 1);
+    for (QDate day = from; day <= to; day = day.addDays(1)) {
+        DailyPlayCount entry;
+        entry.day = day;
+        entry.playCount = counts.value(dayKey(day), 0);
+        result.append(entry);
+    }
+    return result;
+}
+
+QList<ArtistPlayStat> PlayStatsDao::getTopArtists(int limit)
+{
+    DAO_QUERY_SCOPE();
+    QList<ArtistPlayStat> result;
+    if (limit <= 0) {
+        return result;
+    }
+
+    try {
+        QSqlQuery query = prepareQuery(R"(
+            SELECT artist, play_count, last_played_at
+            FROM play_stats_artist
+            ORDER BY play_count DESC
+            LIMIT ?
+        )");
+        query.addBindValue(limit);
+
+        if (!query.exec()) {
+            logError("getTopArtists", query.lastError().text());
+            return result;
+        }
+        while (query.next()) {
+            ArtistPlayStat stat;
+            stat.artist = query.value(0).toString();
+            stat.playCount = query.value(1).toInt();
+            stat.lastPlayedAt = query.value(2).toDateTime();
+            result.append(stat);
+        }
+    } catch (const std::exception& e) {
+        logError("getTopArtists", QString("查询艺术家统计时发生异常: %1").arg(e.what()));
+    }
+    return result;
+}
+
+ArtistPlayStat PlayStatsDao::getMostPlayedArtist()
+{
+    const QList<ArtistPlayStat> top = getTopArtists(1);
+    return top.isEmpty() ? ArtistPlayStat() : top.first();
+}
+
+SongPlayStat PlayStatsDao::getSongStats(int songId)
+{
+    DAO_QUERY_SCOPE();
+    SongPlayStat stat;
+    stat.songId = songId;
+    if (songId <= 0) {
+        return stat;
+    }
+
+    try {
+        QSqlQuery query = prepareQuery(R"(
+            SELECT ps.song_id, ps.play_count AS plays, s.title, s.artist, ps.last_played_at
+            FROM play_stats_song ps
+            INNER JOIN songs s ON s.id = ps.song_id
+            WHERE ps.song_id = ?
+        )");
+        query.addBindValue(songId);
+
+        if (!query.exec()) {
+            logError("getSongStats", query.lastError().text());
+        } else if (query.next()) {
+            stat = createSongStatFromQuery(query);
+        }
+    } catch (const std::exception& e) {
+        logError("getSongStats", QString("查询歌曲统计时发生异常: %1").arg(e.what()));
+    }
+    return stat;
+}
+
+QHash<int, int> PlayStatsDao::getSongPlayCounts(const QList<int>& songIds)
+{
+    DAO_QUERY_SCOPE();
+    QHash<int, int> counts;
+
+    try {
+        for (int begin = 0; begin < songIds.size(); begin += IN_LIST_CHUNK) {
+            const QList<int> chunk = songIds.mid(begin, IN_LIST_CHUNK);
+            QStringList placeholders;
+            for (int i = 0; i < chunk.size(); ++i) {
+                placeholders.append("?");
+            }
+
+            QSqlQuery query = prepareQuery(QString("SELECT song_id, play_count FROM play_stats_song WHERE song_id IN (%1)")
+                                           .arg(placeholders.join(",")));
+            for (int songId : chunk) {
+                query.addBindValue(songId);
+            }
+            if (!query.exec()) {
+                logError("getSongPlayCounts", query.lastError().text());
+                return counts;
+            }
+            while (query.next()) {
+                counts.insert(query.value(0).toInt(), query.value(1).toInt());
+            }
+        }
+    } catch (const std::exception& e) {
+        logError("getSongPlayCounts", QString("查询歌曲播放次数时发生异常: %1").arg(e.what()));
+    }
+    return counts;
+}
+
+PlayStatsTotals PlayStatsDao::getTotals()
+{
+    DAO_QUERY_SCOPE();
+    PlayStatsTotals totals;
+
+    try {
+        // 总次数按天汇总（包括已删除的歌曲），其余按歌曲汇总
+        QSqlQuery query = prepareQuery(R"(
+            SELECT (SELECT COALESCE(SUM(play_count), 0) FROM play_stats_day),
+                   COUNT(*), MIN(first_played_at), MAX(last_played_at)
+            FROM play_stats_song
+        )");
+        if (!query.exec()) {
+            logError("getTotals", query.lastError().text());
+        } else if (query.next()) {
+            totals.totalPlays = query.value(0).toInt();
+            totals.uniqueSongs = query.value(1).toInt();
+            totals.firstPlayTime = query.value(2).toDateTime();
+            totals.lastPlayTime = query.value(3).toDateTime();
+        }
+    } catch (const std::exception& e) {
+        logError("getTotals", QString("查询播放统计总览时发生异常: %1").arg(e.what()));
+    }
+    return totals;
+}
+
+bool PlayStatsDao::rebuild()
+{
+    DAO_QUERY_SCOPE();
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlDatabase db = dbManager()->database();
+    if (!db.transaction()) {
+        logError("rebuild", "无法开始事务: " + db.lastError().text());
+        return false;
+    }
+
+    try {
+        for (const QString& sql : rebuildStatements()) {
+            QSqlQuery query = prepareQuery(sql);
+            if (!query.exec()) {
+                logError("rebuild", query.lastError().text());
+                db.rollback();
+                return false;
+            }
+        }
+
+        if (!db.commit()) {
+            logError("rebuild", "提交事务失败: " + db.lastError().text());
+            db.rollback();
+            return false;
+        }
+    } catch (const std::exception& e) {
+        db.rollback();
+        logError("rebuild", QString("重建播放统计时发生异常: %1").arg(e.what()));
+        return false;
+    }
+
+    logInfo("rebuild", QString("播放统计重建完成，耗时 %1 ms").arg(timer.elapsed()));
+    return true;
+}
+
+QStringList PlayStatsDao::rebuildStatements()
+{
+    const QString artistExpr = QString("COALESCE(NULLIF(TRIM(s.artist), ''), '%1')").arg(UNKNOWN_ARTIST);
+    return {
+        "DELETE FROM play_stats_song",
+        "DELETE FROM play_stats_daily",
+        "DELETE FROM play_stats_day",
+        "DELETE FROM play_stats_artist",
+        R"(
+        INSERT INTO play_stats_song (song_id, play_count, first_played_at, last_played_at)
+        SELECT ph.song_id, COUNT(*), MIN(ph.played_at), MAX(ph.played_at)
+        FROM play_history ph
+        INNER JOIN songs s ON s.id = ph.song_id
+        WHERE ph.played_at IS NOT NULL
+        GROUP BY ph.song_id
+        )",
+        R"(
+        INSERT INTO play_stats_daily (day, song_id, play_count)
+        SELECT date(ph.played_at), ph.song_id, COUNT(*)
+        FROM play_history ph
+        INNER JOIN songs s ON s.id = ph.song_id
+        WHERE ph.played_at IS NOT NULL
+        GROUP BY date(ph.played_at), ph.song_id
+        )",
+        R"(
+        INSERT INTO play_stats_day (day, play_count)
+        SELECT date(played_at), COUNT(*)
+        FROM play_history
+        WHERE played_at IS NOT NULL
+        GROUP BY date(played_at)
+        )",
+        QString(R"(
+        INSERT INTO play_stats_artist (artist, play_count, last_played_at)
+        SELECT %1, COUNT(*), MAX(ph.played_at)
+        FROM play_history ph
+        INNER JOIN songs s ON s.id = ph.song_id
+        WHERE ph.played_at IS NOT NULL
+        GROUP BY %1
+        )").arg(artistExpr)
+    };
+}
+
+SongPlayStat PlayStatsDao::createSongStatFromQuery(const QSqlQuery& query) const
+{
+    SongPlayStat stat;
+    stat.songId = query.value("song_id").toInt();
+    stat.playCount = query.value("plays").toInt();
+    stat.title = query.value("title").toString();
+    stat.artist = query.value("artist").toString();
+    stat.lastPlayedAt = query.value("last_played_at").toDateTime();
+    return stat;
+}
@@ -0,0 +1,144 @@
+#ifndef PLAYSTATSDAO_H
+#define PLAYSTATSDAO_H
+
+#include <QObject>
+#include <QSqlQuery>
+#include <QList>
+#include <QHash>
+#include <QDate>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+#include "basedao.h"
+
+/**
+ * @brief 歌曲的播放统计
+ */
+struct SongPlayStat
+{
+    int songId = -1;
+    QString title;
+    QString artist;
+    int playCount = 0;        // 统计区间内的播放次数
+    QDateTime lastPlayedAt;   // 最近一次播放（不限区间）
+};
+
+/**
+ * @brief 一天的播放次数
+ */
+struct DailyPlayCount
+{
+    QDate day;
+    int playCount = 0;
+};
+
+/**
+ * @brief 艺术家的播放统计
+ */
+struct ArtistPlayStat
+{
+    QString artist;
+    int playCount = 0;
+    QDateTime lastPlayedAt;
+};
+
+/**
+ * @brief 播放统计总览
+ */
+struct PlayStatsTotals
+{
+    int totalPlays = 0;
+    int uniqueSongs = 0;
+    QDateTime firstPlayTime;
+    QDateTime lastPlayTime;
+};
+
+/**
+ * @brief 播放统计数据访问对象
+ *
+ * 读取由play_history插入触发器累加的汇总表（见DatabaseManager::createPlayStatisticsTables）：
+ * play_stats_song（按歌曲）、play_stats_daily（按天和歌曲）、play_stats_day（按天）、
+ * play_stats_artist（按艺术家）。查询只读取主键或索引范围内的行，不扫描play_history。
+ *
+ * play_history会定期清理（每首歌只保留最新的记录），汇总表不受清理影响；
+ * 删除或清空播放历史也不改变统计，需要时调用rebuild()按剩余的播放历史重算。
+ */
+class PlayStatsDao : public BaseDao
+{
+    Q_OBJECT
+
+public:
+    static const QString UNKNOWN_ARTIST;   // 艺术家为空的歌曲归入此名下
+
+    explicit PlayStatsDao(QObject* parent = nullptr);
+    ~PlayStatsDao();
+
+    /**
+     * @brief 日期区间内播放最多的歌曲
+     * @param from 起始日期（含）
+     * @param to 结束日期（含）
+     * @param limit 数量
+     * @return 按播放次数降序的歌曲统计
+     */
+    QList<SongPlayStat> getTopSongs(const QDate& from, const QDate& to, int limit = 10);
+
+    /**
+     * @brief 最近7天（含今天）播放最多的歌曲
+     */
+    QList<SongPlayStat> getTopSongsThisWeek(int limit = 10);
+
+    /**
+     * @brief 累计播放最多的歌曲
+     */
+    QList<SongPlayStat> getTopSongsAllTime(int limit = 10);
+
+    /**
+     * @brief 每天的播放次数
+     * @param from 起始日期（含）
+     * @param to 结束日期（含）
+     * @return 区间内每一天的播放次数，没有播放的日子为0
+     */
+    QList<DailyPlayCount> getPlaysPerDay(const QDate& from, const QDate& to);
+
+    /**
+     * @brief 播放最多的艺术家
+     */
+    QList<ArtistPlayStat> getTopArtists(int limit = 10);
+
+    /**
+     * @brief 播放次数最多的艺术家，没有播放记录时artist为空
+     */
+    ArtistPlayStat getMostPlayedArtist();
+
+    /**
+     * @brief 单首歌曲的累计统计，没有播放过时playCount为0
+     */
+    SongPlayStat getSongStats(int songId);
+
+    /**
+     * @brief 多首歌曲的累计播放次数，没有播放过的歌曲不在结果中
+     */
+    QHash<int, int> getSongPlayCounts(const QList<int>& songIds);
+
+    /**
+     * @brief 播放总次数、播放过的歌曲数和首次/最近播放时间
+     */
+    PlayStatsTotals getTotals();
+
+    /**
+     * @brief 清空汇总表并按play_history重新计算（在一个事务中）
+     * @return 是否成功
+     */
+    bool rebuild();
+
+    /**
+     * @brief 重算汇总表的SQL语句，首次创建触发器时DatabaseManager也用它回填
+     */
+    static QStringList rebuildStatements();
+
+private:
+    SongPlayStat createSongStatFromQuery(const QSqlQuery& query) const;
+};
+
+#endif // PLAYSTATSDAO_H
@@ -0,0 +1,240 @@
+#include "smartplaylistdao.h"
+#include "databasemanager.h"
+#include <QSqlError>
+#include <QDebug>
+
+namespace {
+
+// 单条IN查询的参数数量上限，加上规则本身的参数仍低于SQLite默认的999个变量限制
+const int IN_LIST_CHUNK = 500;
+
+} // namespace
+
+SmartPlaylistDao::SmartPlaylistDao(QObject* parent)
+    : BaseDao(parent)
+{
+}
+
+SmartPlaylistDao::SmartPlaylistDao(const QSqlDatabase& connection, QObject* parent)
+    : BaseDao(parent)
+    , m_connection(connection)
+{
+}
+
+SmartPlaylistDao::~SmartPlaylistDao()
+{
+}
+
+QList<SmartPlaylistMatch> SmartPlaylistDao::findMatches(const SmartPlaylistQuery& query, bool* ok)
+{
+    DAO_QUERY_SCOPE();
+    QList<SmartPlaylistMatch> result;
+    if (ok) {
+        *ok = false;
+    }
+
+    QString sql = selectSql(query) + QString(" WHERE %1").arg(query.where);
+    if (query.limit > 0) {
+        sql += QString(" ORDER BY %1 %2, s.id LIMIT ?").arg(query.orderKey, query.descending ? "DESC" : "ASC");
+    }
+
+    try {
+        QSqlQuery sqlQuery = prepareQuery(sql);
+        for (const QVariant& value : query.bindValues) {
+            sqlQuery.addBindValue(value);
+        }
+        if (query.limit > 0) {
+            sqlQuery.addBindValue(query.limit);
+        }
+
+        if (!sqlQuery.exec()) {
+            logError("findMatches", sqlQuery.lastError().text());
+            return result;
+        }
+        result = readMatches(sqlQuery, query.textKey);
+        if (ok) {
+            *ok = true;
+        }
+    } catch (const std::exception& e) {
+        logError("findMatches", QString("查询智能播放列表时发生异常: %1").arg(e.what()));
+    }
+    return result;
+}
+
+QList<SmartPlaylistMatch> SmartPlaylistDao::findMatches(const SmartPlaylistQuery& query, const QList<int>& songIds,
+                                                        bool* ok)
+{
+    DAO_QUERY_SCOPE();
+    QList<SmartPlaylistMatch> result;
+    if (ok) {
+        *ok = false;
+    }
+
+    try {
+        for (int begin = 0; begin < songIds.size(); begin += IN_LIST_CHUNK) {
+            const QList<int> chunk = songIds.mid(begin, IN_LIST_CHUNK);
+            QString marks = QString("?, ").repeated(chunk.size());
+            marks.chop(2);
+
+            // s.id IN (...)走主键，规则只在这些行上求值
+            QSqlQuery sqlQuery = prepareQuery(selectSql(query)
+                                              + QString(" WHERE s.id IN (%1) AND (%2)").arg(marks, query.where));
+            for (int songId : chunk) {
+                sqlQuery.addBindValue(songId);
+            }
+            for (const QVariant& value : query.bindValues) {
+                sqlQuery.addBindValue(value);
+            }
+
+            if (!sqlQuery.exec()) {
+                logError("findMatches", sqlQuery.lastError().text());
+                return result;
+            }
+            result.append(readMatches(sqlQuery, query.textKey));
+        }
+        if (ok) {
+            *ok = true;
+        }
+    } catch (const std::exception& e) {
+        logError("findMatches", QString("增量查询智能播放列表时发生异常: %1").arg(e.what()));
+    }
+    return result;
+}
+
+QStringList SmartPlaylistDao::explainQueryPlan(const SmartPlaylistQuery& query)
+{
+    DAO_QUERY_SCOPE();
+    QStringList plan;
+
+    QString sql = "EXPLAIN QUERY PLAN " + selectSql(query) + QString(" WHERE %1").arg(query.where);
+    if (query.limit > 0) {
+        sql += QString(" ORDER BY %1 %2, s.id LIMIT ?").arg(query.orderKey, query.descending ? "DESC" : "ASC");
+    }
+
+    try {
+        QSqlQuery sqlQuery = prepareQuery(sql);
+        for (const QVariant& value : query.bindValues) {
+            sqlQuery.addBindValue(value);
+        }
+        if (query.limit > 0) {
+            sqlQuery.addBindValue(query.limit);
+        }
+
+        if (!sqlQuery.exec()) {
+            logError("explainQueryPlan", sqlQuery.lastError().text());
+            return plan;
+        }
+        // 列依次为id, parent, notused, detail
+        while (sqlQuery.next()) {
+            plan.append(sqlQuery.value(3).toString());
+        }
+    } catch (const std::exception& e) {
+        logError("explainQueryPlan", QString("获取执行计划时发生异常: %1").arg(e.what()));
+    }
+    return plan;
+}
+
+qint64 SmartPlaylistDao::readChanges(qint64 afterSeq, int maxChanges, QSet<int>* songIds)
+{
+    DAO_QUERY_SCOPE();
+    qint64 lastSeq = afterSeq;
+
+    try {
+        QSqlQuery query = prepareQuery("SELECT seq, song_id FROM smart_playlist_changes WHERE seq > ? ORDER BY seq LIMIT ?");
+        query.addBindValue(afterSeq);
+        query.addBindValue(maxChanges + 1);
+
+        if (!query.exec()) {
+            logError("readChanges", query.lastError().text());
+            return -1;
+        }
+        int count = 0;
+        while (query.next()) {
+            if (++count > maxChanges) {
+                return -1;
+            }
+            lastSeq = query.value(0).toLongLong();
+            if (songIds) {
+                songIds->insert(query.value(1).toInt());
+            }
+        }
+    } catch (const std::exception& e) {
+        logError("readChanges", QString("读取智能播放列表变更时发生异常: %1").arg(e.what()));
+        return -1;
+    }
+    return lastSeq;
+}
+
+qint64 SmartPlaylistDao::latestChangeSeq()
+{
+    DAO_QUERY_SCOPE();
+    QSqlQuery query = prepareQuery("SELECT COALESCE(MAX(seq), 0) FROM smart_playlist_changes");
+    if (!query.exec() || !query.next()) {
+        logError("latestChangeSeq", query.lastError().text());
+        return 0;
+    }
+    return query.value(0).toLongLong();
+}
+
+bool SmartPlaylistDao::trimChanges(qint64 upToSeq)
+{
+    DAO_QUERY_SCOPE();
+    QSqlQuery query = prepareQuery("DELETE FROM smart_playlist_changes WHERE seq <= ?");
+    query.addBindValue(upToSeq);
+    if (!query.exec()) {
+        logError("trimChanges", query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+int SmartPlaylistDao::capChanges(int maxRows)
+{
+    DAO_QUERY_SCOPE();
+    // 按主键倒序找到第maxRows+1新的变更，删除它及更早的变更；行数不足时子查询为NULL，不删除
+    QSqlQuery query = prepareQuery(R"(
+        DELETE FROM smart_playlist_changes
+        WHERE seq <= (SELECT seq FROM smart_playlist_changes ORDER BY seq DESC LIMIT 1 OFFSET ?)
+    )");
+    query.addBindValue(maxRows);
+    if (!query.exec()) {
+        logError("capChanges", query.lastError().text());
+        return -1;
+    }
+    return query.numRowsAffected();
+}
+
+QSqlQuery SmartPlaylistDao::prepareQuery(const QString& sql)
+{
+    if (!m_connection.isValid()) {
+        return BaseDao::prepareQuery(sql);
+    }
+
+    QSqlQuery query(m_connection);
+    if (!query.prepare(sql)) {
+        logError("prepareQuery", "准备查询失败: " + query.lastError().text());
+    }
+    return query;
+}
+
+QString SmartPlaylistDao::selectSql(const SmartPlaylistQuery& query) const
+{
+    return QString("SELECT s.id, %1 FROM songs s LEFT JOIN play_stats_song ps ON ps.song_id = s.id")
+        .arg(query.orderKey);
+}
+
+QList<SmartPlaylistMatch> SmartPlaylistDao::readMatches(QSqlQuery& query, bool textKey) const
+{
+    QList<SmartPlaylistMatch> matches;
+    while (query.next()) {
+        SmartPlaylistMatch match;
+        match.songId = query.value(0).toInt();
+        if (textKey) {
+            match.text = query.value(1).toString();
+        } else {
+            match.number = query.value(1).toLongLong();
+        }
+        matches.append(match);
+    }
+    return matches;
+}
@@ -0,0 +1,119 @@
+#ifndef SMARTPLAYLISTDAO_H
+#define SMARTPLAYLISTDAO_H
+
+#include <QObject>
+#include <QSqlQuery>
+#include <QSqlDatabase>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantList>
+
+#include "basedao.h"
+
+/**
+ * @brief 智能播放列表规则编译出的查询
+ * @details where和orderKey只引用songs（别名s）和play_stats_song（别名ps，LEFT JOIN），
+ *          标签条件是song_tags上的EXISTS子查询；所有值都通过bindValues绑定
+ */
+struct SmartPlaylistQuery
+{
+    QString where;              // 不含WHERE关键字的条件表达式
+    QVariantList bindValues;    // 按where中?的顺序
+    QString orderKey;           // 排序键的SQL表达式
+    bool textKey = true;        // 排序键是文本还是数值
+    bool descending = false;
+    int limit = 0;              // 0表示不限制
+};
+
+/**
+ * @brief 匹配规则的一首歌曲及其排序键
+ */
+struct SmartPlaylistMatch
+{
+    int songId = -1;
+    QString text;               // 文本排序键
+    qint64 number = 0;          // 数值排序键
+};
+
+/**
+ * @brief 智能播放列表数据访问对象
+ *
+ * 执行编译好的规则查询，读取和清理smart_playlist_changes变更日志
+ * （由DatabaseManager::createSmartPlaylistChangeLog创建的触发器写入）。
+ * 默认使用主连接；PlayHistoryRecorder的写线程传入自己的连接，定期截断变更日志。
+ */
+class SmartPlaylistDao : public BaseDao
+{
+    Q_OBJECT
+
+public:
+    explicit SmartPlaylistDao(QObject* parent = nullptr);
+
+    /**
+     * @brief 使用指定连接（必须在该连接所属的线程中使用）
+     * @param connection 数据库连接
+     */
+    explicit SmartPlaylistDao(const QSqlDatabase& connection, QObject* parent = nullptr);
+    ~SmartPlaylistDao();
+
+    /**
+     * @brief 查询匹配规则的歌曲
+     * @param query 编译好的查询
+     * @param ok 是否执行成功（可选）
+     * @return 有limit时按排序键排好并截断，否则为数据库返回的顺序
+     */
+    QList<SmartPlaylistMatch> findMatches(const SmartPlaylistQuery& query, bool* ok = nullptr);
+
+    /**
+     * @brief 只在给定歌曲中查询匹配规则的歌曲（增量刷新），忽略limit
+     */
+    QList<SmartPlaylistMatch> findMatches(const SmartPlaylistQuery& query, const QList<int>& songIds,
+                                          bool* ok = nullptr);
+
+    /**
+     * @brief 完整查询的执行计划（EXPLAIN QUERY PLAN的detail列）
+     */
+    QStringList explainQueryPlan(const SmartPlaylistQuery& query);
+
+    /**
+     * @brief 读取序号大于afterSeq的变更
+     * @param afterSeq 上次读到的序号
+     * @param maxChanges 最多读取的变更数，超过时songIds不完整，返回-1
+     * @param songIds 输出：发生变化的歌曲ID
+     * @return 读到的最大序号（没有新变更时为afterSeq），出错或超过maxChanges时为-1
+     */
+    qint64 readChanges(qint64 afterSeq, int maxChanges, QSet<int>* songIds);
+
+    /**
+     * @brief 当前最大的变更序号，没有变更时为0
+     */
+    qint64 latestChangeSeq();
+
+    /**
+     * @brief 删除序号不大于upToSeq的变更
+     */
+    bool trimChanges(qint64 upToSeq);
+
+    /**
+     * @brief 只保留最近maxRows条变更，没有智能播放列表被访问时变更日志也不会无限增长
+     * @details maxRows应大于读取方的maxChanges：被截掉的变更之后至少还有maxRows条，
+     *          读取方因此超过上限并改为完整查询，不会漏掉变更
+     * @param maxRows 保留的最大行数
+     * @return 删除的行数，出错时为-1
+     */
+    int capChanges(int maxRows);
+
+protected:
+    QSqlQuery prepareQuery(const QString& sql) override;
+
+private:
+    QString selectSql(const SmartPlaylistQuery& query) const;
+    QList<SmartPlaylistMatch> readMatches(QSqlQuery& query, bool textKey) const;
+
+    QSqlDatabase m_connection;  // 无效时使用主连接
+};
+
+#endif // SMARTPLAYLISTDAO_H
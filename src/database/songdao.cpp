@@ -1,10 +1,18 @@
 #include "songdao.h"
 #include "databasemanager.h"
+#include "tagindex.h"
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QVariant>
 #include <QDebug>
 
+namespace {
+
+// 较旧的SQLite单条语句最多绑定999个参数
+const int IN_LIST_CHUNK = 500;
+
+} // namespace
+
 SongDao::SongDao(QObject* parent)
     : BaseDao(parent)
 {
@@ -12,6 +20,7 @@ SongDao::SongDao(QObject* parent)
 
 int SongDao::addSong(const Song& song)
 {
+    DAO_QUERY_SCOPE();
     // 首先检查歌曲是否已存在
     if (songExists(song.filePath())) {
         qDebug() << "[SongDao] addSong: 歌曲已存在，尝试更新:" << song.filePath();
@@ -51,6 +60,7 @@ int SongDao::addSong(const Song& song)
     
     if (query.exec()) {
         int newId = query.lastInsertId().toInt();
+        TagIndex::instance()->addSong(newId);
         qDebug() << "[SongDao] addSong: 新歌曲插入成功，ID:" << newId << "路径:" << song.filePath();
         return newId;
     } else {
@@ -61,6 +71,7 @@ int SongDao::addSong(const Song& song)
 
 Song SongDao::getSongById(int id)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT * FROM songs WHERE id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(id);
@@ -74,6 +85,7 @@ Song SongDao::getSongById(int id)
 
 Song SongDao::getSongByPath(const QString& filePath)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT * FROM songs WHERE file_path = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(filePath);
@@ -87,8 +99,9 @@ Song SongDao::getSongByPath(const QString& filePath)
 
 QList<Song> SongDao::getAllSongs()
 {
+    DAO_QUERY_SCOPE();
     QList<Song> songs;
-    const QString sql = "SELECT * FROM songs ORDER BY title";
+    const QString sql = "SELECT * FROM songs ORDER BY title, id";
     QSqlQuery query = executeQuery(sql);
     
     while (query.next()) {
@@ -100,8 +113,9 @@ QList<Song> SongDao::getAllSongs()
 
 QList<Song> SongDao::searchByTitle(const QString& title)
 {
+    DAO_QUERY_SCOPE();
     QList<Song> songs;
-    const QString sql = "SELECT * FROM songs WHERE title LIKE ? ORDER BY title";
+    const QString sql = "SELECT * FROM songs WHERE title LIKE ? ORDER BY title, id";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue("%" + title + "%");
     
@@ -118,6 +132,7 @@ QList<Song> SongDao::searchByTitle(const QString& title)
 
 QList<Song> SongDao::searchByArtist(const QString& artist)
 {
+    DAO_QUERY_SCOPE();
     QList<Song> songs;
     const QString sql = "SELECT * FROM songs WHERE artist LIKE ? ORDER BY title";
     QSqlQuery query = prepareQuery(sql);
@@ -136,6 +151,7 @@ QList<Song> SongDao::searchByArtist(const QString& artist)
 
 QList<Song> SongDao::searchByTag(const QString& tag)
 {
+    DAO_QUERY_SCOPE();
     QList<Song> songs;
     const QString sql = "SELECT * FROM songs WHERE tags LIKE ? ORDER BY title";
     QSqlQuery query = prepareQuery(sql);
@@ -154,6 +170,7 @@ QList<Song> SongDao::searchByTag(const QString& tag)
 
 bool SongDao::updateSong(const Song& song)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = R"(
         UPDATE songs SET 
             title = ?, artist = ?, album = ?, duration = ?, 
@@ -181,11 +198,13 @@ bool SongDao::updateSong(const Song& song)
 
 bool SongDao::deleteSong(int id)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "DELETE FROM songs WHERE id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(id);
     
     if (query.exec()) {
+        TagIndex::instance()->removeSong(id);
         return query.numRowsAffected() > 0;
     } else {
         logError("deleteSong", query.lastError().text());
@@ -195,6 +214,7 @@ bool SongDao::deleteSong(int id)
 
 bool SongDao::incrementPlayCount(int id)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = R"(
         UPDATE songs SET 
             play_count = play_count + 1, 
@@ -216,6 +236,7 @@ bool SongDao::incrementPlayCount(int id)
 
 bool SongDao::updateLastPlayed(int id, const QDateTime& lastPlayed)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = R"(
         UPDATE songs SET 
             last_played = ?, 
@@ -237,6 +258,7 @@ bool SongDao::updateLastPlayed(int id, const QDateTime& lastPlayed)
 
 bool SongDao::updateRating(int id, int rating)
 {
+    DAO_QUERY_SCOPE();
     if (rating < 0 || rating > 5) {
         logError("updateRating", "评分必须在0-5之间");
         return false;
@@ -263,6 +285,7 @@ bool SongDao::updateRating(int id, int rating)
 
 bool SongDao::songExists(const QString& filePath)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT COUNT(*) FROM songs WHERE file_path = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(filePath);
@@ -276,6 +299,7 @@ bool SongDao::songExists(const QString& filePath)
 
 int SongDao::getSongCount()
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT COUNT(*) FROM songs";
     QSqlQuery query = executeQuery(sql);
     
@@ -315,10 +339,12 @@ Song SongDao::createSongFromQuery(const QSqlQuery& query)
 
 QList<Song> SongDao::getSongsByTag(int tagId)
 {
+    DAO_QUERY_SCOPE();
     QList<Song> songs;
     const QString sql = "SELECT s.* FROM songs s "
                        "INNER JOIN song_tags st ON s.id = st.song_id "
-                       "WHERE st.tag_id = ?";
+                       "WHERE st.tag_id = ? "
+                       "ORDER BY s.title, s.id";
     
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(tagId);
@@ -332,28 +358,82 @@ QList<Song> SongDao::getSongsByTag(int tagId)
     return songs;
 }
 
+QList<Song> SongDao::getSongsByIds(const QList<int>& ids)
+{
+    DAO_QUERY_SCOPE();
+    QList<Song> songs;
+    songs.reserve(ids.size());
+    
+    for (int start = 0; start < ids.size(); start += IN_LIST_CHUNK) {
+        const QList<int> chunk = ids.mid(start, IN_LIST_CHUNK);
+        QString marks = QString("?, ").repeated(chunk.size());
+        marks.chop(2);
+        
+        QSqlQuery query = prepareQuery(QString("SELECT * FROM songs WHERE id IN (%1)").arg(marks));
+        for (int id : chunk) {
+            query.addBindValue(id);
+        }
+        if (!query.exec()) {
+            logError("getSongsByIds", query.lastError().text());
+            return songs;
+        }
+        while (query.next()) {
+            songs.append(createSongFromQuery(query));
+        }
+    }
+    
+    return songs;
+}
+
+bool SongDao::forEachSongId(const std::function<void(int songId)>& visitor)
+{
+    DAO_QUERY_SCOPE();
+    QSqlQuery query = prepareQuery("SELECT id FROM songs ORDER BY id");
+    query.setForwardOnly(true);
+    
+    if (!query.exec()) {
+        logError("forEachSongId", query.lastError().text());
+        return false;
+    }
+    while (query.next()) {
+        visitor(query.value(0).toInt());
+    }
+    return true;
+}
+
 bool SongDao::removeSongFromTag(int songId, int tagId)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "DELETE FROM song_tags WHERE song_id = ? AND tag_id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(songId);
     query.addBindValue(tagId);
     
-    return query.exec();
+    if (!query.exec()) {
+        return false;
+    }
+    TagIndex::instance()->removeSongTag(songId, tagId);
+    return true;
 }
 
 bool SongDao::addSongToTag(int songId, int tagId)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "INSERT OR IGNORE INTO song_tags (song_id, tag_id) VALUES (?, ?)";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(songId);
     query.addBindValue(tagId);
     
-    return query.exec();
+    if (!query.exec()) {
+        return false;
+    }
+    TagIndex::instance()->addSongTag(songId, tagId);
+    return true;
 }
 
 bool SongDao::songHasTag(int songId, int tagId)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT COUNT(*) FROM song_tags WHERE song_id = ? AND tag_id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(songId);
@@ -368,11 +448,13 @@ bool SongDao::songHasTag(int songId, int tagId)
 
 bool SongDao::removeAllTagsFromSong(int songId)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "DELETE FROM song_tags WHERE song_id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(songId);
     
     if (query.exec()) {
+        TagIndex::instance()->removeAllTagsFromSong(songId);
         logInfo("removeAllTagsFromSong", QString("成功删除歌曲 %1 的所有标签关联").arg(songId));
         return true;
     } else {
@@ -383,6 +465,7 @@ bool SongDao::removeAllTagsFromSong(int songId)
 
 int SongDao::insertSongs(const QList<Song>& songs)
 {
+    DAO_QUERY_SCOPE();
     int insertedCount = 0;
     
     for (const Song& song : songs) {
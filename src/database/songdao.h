@@ -5,6 +5,7 @@
 #include "../models/song.h"
 #include <QList>
 #include <QDateTime>
+#include <functional>
 
 /**
  * @brief 歌曲数据访问对象
@@ -123,6 +124,20 @@ public:
      */
     QList<Song> getSongsByTag(int tagId);
     
+    /**
+     * @brief 按ID批量获取歌曲
+     * @param ids 歌曲ID
+     * @return 找到的歌曲，顺序不保证与ids一致，不存在的ID被忽略
+     */
+    QList<Song> getSongsByIds(const QList<int>& ids);
+    
+    /**
+     * @brief 按ID升序逐个读取全部歌曲ID（走主键，不排序）
+     * @param visitor 每个ID调用一次
+     * @return 查询是否成功
+     */
+    bool forEachSongId(const std::function<void(int songId)>& visitor);
+    
     /**
      * @brief 从标签中移除歌曲
      * @param songId 歌曲ID
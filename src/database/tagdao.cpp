@@ -1,5 +1,6 @@
 #include "tagdao.h"
 #include "databasemanager.h"
+#include "tagindex.h"
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QVariant>
@@ -12,6 +13,7 @@ TagDao::TagDao(QObject* parent)
 
 int TagDao::addTag(const Tag& tag)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = R"(
         INSERT INTO tags (name, color, description, is_system)
         VALUES (?, ?, ?, ?)
@@ -33,6 +35,7 @@ int TagDao::addTag(const Tag& tag)
 
 Tag TagDao::getTagById(int id)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT * FROM tags WHERE id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(id);
@@ -46,6 +49,7 @@ Tag TagDao::getTagById(int id)
 
 Tag TagDao::getTagByName(const QString& name)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT * FROM tags WHERE name = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(name);
@@ -59,6 +63,7 @@ Tag TagDao::getTagByName(const QString& name)
 
 QList<Tag> TagDao::getAllTags()
 {
+    DAO_QUERY_SCOPE();
     QList<Tag> tags;
     
     qDebug() << "TagDao::getAllTags - 开始查询所有标签";
@@ -84,6 +89,7 @@ QList<Tag> TagDao::getAllTags()
 
 QList<Tag> TagDao::getSystemTags()
 {
+    DAO_QUERY_SCOPE();
     QList<Tag> tags;
     const QString sql = "SELECT * FROM tags WHERE is_system = 1 ORDER BY name";
     QSqlQuery query = executeQuery(sql);
@@ -103,6 +109,7 @@ QList<Tag> TagDao::getSystemTags()
 
 QList<Tag> TagDao::getUserTags()
 {
+    DAO_QUERY_SCOPE();
     QList<Tag> tags;
     const QString sql = "SELECT * FROM tags WHERE is_system = 0 ORDER BY name";
     QSqlQuery query = executeQuery(sql);
@@ -122,6 +129,7 @@ QList<Tag> TagDao::getUserTags()
 
 QList<Tag> TagDao::searchTags(const QString& keyword)
 {
+    DAO_QUERY_SCOPE();
     QList<Tag> tags;
     const QString sql = R"(
         SELECT * FROM tags 
@@ -152,6 +160,7 @@ QList<Tag> TagDao::searchTags(const QString& keyword)
 
 bool TagDao::updateTag(const Tag& tag)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = R"(
         UPDATE tags SET 
             name = ?, color = ?, description = ?, updated_at = CURRENT_TIMESTAMP
@@ -178,6 +187,7 @@ bool TagDao::updateTag(const Tag& tag)
 
 bool TagDao::deleteTag(int id)
 {
+    DAO_QUERY_SCOPE();
     // 检查是否为系统标签
     if (isSystemTag(id)) {
         logError("deleteTag", "不能删除系统标签");
@@ -189,6 +199,7 @@ bool TagDao::deleteTag(int id)
     query.addBindValue(id);
     
     if (query.exec()) {
+        TagIndex::instance()->removeTag(id);
         return query.numRowsAffected() > 0;
     } else {
         logError("deleteTag", query.lastError().text());
@@ -198,6 +209,7 @@ bool TagDao::deleteTag(int id)
 
 bool TagDao::tagExists(const QString& name)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT COUNT(*) FROM tags WHERE name = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(name);
@@ -211,6 +223,7 @@ bool TagDao::tagExists(const QString& name)
 
 bool TagDao::isSystemTag(int id)
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT is_system FROM tags WHERE id = ?";
     QSqlQuery query = prepareQuery(sql);
     query.addBindValue(id);
@@ -224,6 +237,7 @@ bool TagDao::isSystemTag(int id)
 
 int TagDao::getTagCount()
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT COUNT(*) FROM tags";
     QSqlQuery query = executeQuery(sql);
     
@@ -236,6 +250,7 @@ int TagDao::getTagCount()
 
 int TagDao::getUserTagCount()
 {
+    DAO_QUERY_SCOPE();
     const QString sql = "SELECT COUNT(*) FROM tags WHERE is_system = 0";
     QSqlQuery query = executeQuery(sql);
     
@@ -246,6 +261,27 @@ int TagDao::getUserTagCount()
     return 0;
 }
 
+bool TagDao::forEachSongTag(const std::function<void(int songId, int tagId)>& visitor)
+{
+    DAO_QUERY_SCOPE();
+    // 扫描UNIQUE(song_id, tag_id)的覆盖索引，按歌曲ID升序读出；两次连接都走主键
+    const QString sql = "SELECT st.song_id, st.tag_id FROM song_tags st "
+                        "INNER JOIN songs s ON s.id = st.song_id "
+                        "INNER JOIN tags t ON t.id = st.tag_id "
+                        "ORDER BY st.song_id";
+    QSqlQuery query = prepareQuery(sql);
+    query.setForwardOnly(true);
+    
+    if (!query.exec()) {
+        logError("forEachSongTag", query.lastError().text());
+        return false;
+    }
+    while (query.next()) {
+        visitor(query.value(0).toInt(), query.value(1).toInt());
+    }
+    return true;
+}
+
 Tag TagDao::createTagFromQuery(const QSqlQuery& query)
 {
     Tag tag;
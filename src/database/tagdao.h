@@ -4,6 +4,7 @@
 #include "basedao.h"
 #include "../models/tag.h"
 #include <QList>
+#include <functional>
 
 /**
  * @brief 标签数据访问对象
@@ -102,6 +103,14 @@ public:
      * @return 用户标签总数
      */
     int getUserTagCount();
+    
+    /**
+     * @brief 按歌曲ID顺序逐条读取歌曲-标签关联，不生成完整列表
+     * @details 只读取歌曲和标签都存在的关联（song_tags没有外键约束）
+     * @param visitor 每条关联调用一次
+     * @return 查询是否成功
+     */
+    bool forEachSongTag(const std::function<void(int songId, int tagId)>& visitor);
 
 private:
     /**
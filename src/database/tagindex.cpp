@@ -0,0 +1,274 @@
+#include "tagindex.h"
+#include "songdao.h"
+#include "tagdao.h"
+#include "databasemanager.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+// 静态成员初始化
+TagIndex* TagIndex::s_instance = nullptr;
+
+TagIndex::TagIndex()
+    : m_loaded(false)
+{
+}
+
+TagIndex::~TagIndex()
+{
+}
+
+TagIndex* TagIndex::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    if (!s_instance) {
+        s_instance = new TagIndex();
+    }
+    return s_instance;
+}
+
+void TagIndex::cleanup()
+{
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+bool TagIndex::contains(int songId, int tagId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (songId <= 0 || !ensureLoaded()) {
+        return false;
+    }
+    auto it = m_tagSongs.constFind(tagId);
+    return it != m_tagSongs.constEnd() && it->contains(static_cast<quint32>(songId));
+}
+
+QList<int> TagIndex::tagsForSong(int songId)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<int> tagIds;
+    if (songId <= 0 || !ensureLoaded()) {
+        return tagIds;
+    }
+    for (auto it = m_tagSongs.constBegin(); it != m_tagSongs.constEnd(); ++it) {
+        if (it->contains(static_cast<quint32>(songId))) {
+            tagIds.append(it.key());
+        }
+    }
+    std::sort(tagIds.begin(), tagIds.end());
+    return tagIds;
+}
+
+QList<int> TagIndex::songIds(int tagId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoaded()) {
+        return QList<int>();
+    }
+    return m_tagSongs.value(tagId).toList();
+}
+
+int TagIndex::songCount(int tagId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoaded()) {
+        return 0;
+    }
+    auto it = m_tagSongs.constFind(tagId);
+    return it != m_tagSongs.constEnd() ? it->cardinality() : 0;
+}
+
+QList<int> TagIndex::match(const QList<int>& allOf, const QList<int>& anyOf, const QList<int>& noneOf)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoaded()) {
+        return QList<int>();
+    }
+    return evaluate(allOf, anyOf, noneOf).toList();
+}
+
+int TagIndex::matchCount(const QList<int>& allOf, const QList<int>& anyOf, const QList<int>& noneOf)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoaded()) {
+        return 0;
+    }
+    return evaluate(allOf, anyOf, noneOf).cardinality();
+}
+
+void TagIndex::addSong(int songId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_loaded && songId > 0) {
+        m_allSongs.add(static_cast<quint32>(songId));
+    }
+}
+
+void TagIndex::removeSong(int songId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_loaded || songId <= 0) {
+        return;
+    }
+    // song_tags没有外键约束，删除歌曲后残留的关联不再计入
+    m_allSongs.remove(static_cast<quint32>(songId));
+    for (auto it = m_tagSongs.begin(); it != m_tagSongs.end(); ++it) {
+        it->remove(static_cast<quint32>(songId));
+    }
+}
+
+void TagIndex::addSongTag(int songId, int tagId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_loaded && songId > 0) {
+        m_tagSongs[tagId].add(static_cast<quint32>(songId));
+    }
+}
+
+void TagIndex::removeSongTag(int songId, int tagId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_loaded || songId <= 0) {
+        return;
+    }
+    auto it = m_tagSongs.find(tagId);
+    if (it != m_tagSongs.end()) {
+        it->remove(static_cast<quint32>(songId));
+    }
+}
+
+void TagIndex::removeAllTagsFromSong(int songId)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_loaded || songId <= 0) {
+        return;
+    }
+    for (auto it = m_tagSongs.begin(); it != m_tagSongs.end(); ++it) {
+        it->remove(static_cast<quint32>(songId));
+    }
+}
+
+void TagIndex::removeTag(int tagId)
+{
+    QMutexLocker locker(&m_mutex);
+    m_tagSongs.remove(tagId);
+}
+
+void TagIndex::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    m_tagSongs.clear();
+    m_allSongs.clear();
+    m_loaded = false;
+}
+
+qint64 TagIndex::memoryUsage()
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 bytes = m_allSongs.memoryUsage();
+    for (auto it = m_tagSongs.constBegin(); it != m_tagSongs.constEnd(); ++it) {
+        bytes += it->memoryUsage();
+    }
+    return bytes;
+}
+
+bool TagIndex::ensureLoaded()
+{
+    if (m_loaded) {
+        return true;
+    }
+
+    // 加载通过主连接读取，其他线程上的查询读不到数据，不能把空结果当成索引
+    if (!DatabaseManager::instance()->isConnectionThread()) {
+        qWarning() << "TagIndex: 不在主连接所属线程，拒绝加载";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    SongDao songDao;
+    RoaringBitmap allSongs;
+    if (!songDao.forEachSongId([&allSongs](int songId) {
+            allSongs.add(static_cast<quint32>(songId));
+        })) {
+        qWarning() << "TagIndex: 加载歌曲ID失败";
+        return false;
+    }
+
+    TagDao tagDao;
+    QHash<int, RoaringBitmap> tagSongs;
+    if (!tagDao.forEachSongTag([&tagSongs](int songId, int tagId) {
+            tagSongs[tagId].add(static_cast<quint32>(songId));
+        })) {
+        qWarning() << "TagIndex: 加载歌曲-标签关联失败";
+        return false;
+    }
+
+    m_allSongs = allSongs;
+    m_tagSongs = tagSongs;
+    m_loaded = true;
+
+    qint64 bytes = m_allSongs.memoryUsage();
+    for (auto it = m_tagSongs.constBegin(); it != m_tagSongs.constEnd(); ++it) {
+        bytes += it->memoryUsage();
+    }
+    qDebug() << "TagIndex: 加载" << m_allSongs.cardinality() << "首歌曲、" << m_tagSongs.size()
+             << "个标签，占用" << bytes << "字节，耗时" << timer.elapsed() << "ms";
+    return true;
+}
+
+RoaringBitmap TagIndex::evaluate(const QList<int>& allOf, const QList<int>& anyOf, const QList<int>& noneOf) const
+{
+    const RoaringBitmap empty;
+    auto bitmapFor = [this, &empty](int tagId) -> const RoaringBitmap& {
+        auto it = m_tagSongs.constFind(tagId);
+        return it != m_tagSongs.constEnd() ? *it : empty;
+    };
+
+    RoaringBitmap result;
+    bool restricted = false;
+
+    // 从最小的位图开始求交，中间结果只会变小，为空时提前结束
+    if (!allOf.isEmpty()) {
+        QList<const RoaringBitmap*> bitmaps;
+        for (int tagId : allOf) {
+            bitmaps.append(&bitmapFor(tagId));
+        }
+        std::sort(bitmaps.begin(), bitmaps.end(), [](const RoaringBitmap* a, const RoaringBitmap* b) {
+            return a->cardinality() < b->cardinality();
+        });
+        result = *bitmaps.first();
+        for (int i = 1; i < bitmaps.size() && !result.isEmpty(); ++i) {
+            result &= *bitmaps[i];
+        }
+        restricted = true;
+    }
+
+    if (!anyOf.isEmpty()) {
+        RoaringBitmap any;
+        for (int tagId : anyOf) {
+            any |= bitmapFor(tagId);
+        }
+        if (restricted) {
+            result &= any;
+        } else {
+            result = any;
+            restricted = true;
+        }
+    }
+
+    if (!restricted) {
+        result = m_allSongs;
+    }
+
+    for (int i = 0; i < noneOf.size() && !result.isEmpty(); ++i) {
+        result -= bitmapFor(noneOf[i]);
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+#include "../core/roaringbitmap.h"
+
+/**
+ * @brief 歌曲-标签关联的内存索引
+ *
+ * 每个标签一个压缩位图（RoaringBitmap），以歌曲ID为序号：歌曲ID是自增主键，
+ * 基本连续，删除留下的空洞只会让某些容器变稀疏。另有一个包含全部歌曲的位图，
+ * 作为只有排除条件（noneOf）时的全集。
+ *
+ * 第一次查询时从song_tags加载（只加载歌曲和标签都存在的关联），之后由SongDao和TagDao
+ * 在每条写入song_tags、songs、tags的语句执行成功后同步更新；尚未加载时忽略更新，
+ * 加载时会读到最新数据。更新发生在调用方的事务内，事务回滚时调用方必须调用invalidate()；
+ * 直接用SQL修改这些表的代码（如合成数据）同样需要调用invalidate()。
+ *
+ * 查询必须在主连接所属的线程调用：加载通过主连接读取，其他线程上的首次查询不会加载，
+ * 只返回空结果。方法内部加锁，同步更新和invalidate()可在任意线程调用。
+ */
+class TagIndex
+{
+public:
+    // 单例模式
+    static TagIndex* instance();
+    static void cleanup();
+
+    /**
+     * @brief 歌曲是否带有标签：一次哈希查找加一次位图查找
+     */
+    bool contains(int songId, int tagId);
+
+    /**
+     * @brief 歌曲带有的标签ID（按ID升序），逐个标签测试，与歌曲数无关
+     */
+    QList<int> tagsForSong(int songId);
+
+    /**
+     * @brief 标签下的歌曲ID（按ID升序）
+     */
+    QList<int> songIds(int tagId);
+
+    int songCount(int tagId);
+
+    /**
+     * @brief 组合多个标签
+     * @param allOf 必须带有的标签（与）
+     * @param anyOf 至少带有其中一个的标签（或），为空时不限制
+     * @param noneOf 不能带有的标签（差）
+     * @return 满足条件的歌曲ID（按ID升序）；allOf和anyOf都为空时从全部歌曲中排除noneOf
+     */
+    QList<int> match(const QList<int>& allOf, const QList<int>& anyOf, const QList<int>& noneOf);
+
+    /**
+     * @brief 与match()条件相同，只返回数量
+     */
+    int matchCount(const QList<int>& allOf, const QList<int>& anyOf, const QList<int>& noneOf);
+
+    // 同步更新，由DAO在写入成功后调用
+    void addSong(int songId);
+    void removeSong(int songId);
+    void addSongTag(int songId, int tagId);
+    void removeSongTag(int songId, int tagId);
+    void removeAllTagsFromSong(int songId);
+    void removeTag(int tagId);
+
+    /**
+     * @brief 丢弃索引，下次查询时重新加载
+     */
+    void invalidate();
+
+    /**
+     * @brief 索引占用的内存（字节）
+     */
+    qint64 memoryUsage();
+
+private:
+    TagIndex();
+    ~TagIndex();
+
+    TagIndex(const TagIndex&) = delete;
+    TagIndex& operator=(const TagIndex&) = delete;
+
+    /**
+     * @brief 需要时从数据库加载，调用前必须持有m_mutex
+     * @return 索引是否可用
+     */
+    bool ensureLoaded();
+
+    /**
+     * @brief 计算组合结果，调用前必须持有m_mutex并已加载
+     */
+    RoaringBitmap evaluate(const QList<int>& allOf, const QList<int>& anyOf, const QList<int>& noneOf) const;
+
+    static TagIndex* s_instance;
+
+    QMutex m_mutex;
+    QHash<int, RoaringBitmap> m_tagSongs;   // 标签ID -> 歌曲位图
+    RoaringBitmap m_allSongs;
+    bool m_loaded;
+};
+
+#endif // TAGINDEX_H
@@ -0,0 +1,491 @@
+#include "coverartcache.h"
+#include "../core/appconfig.h"
+#include "../core/metricsregistry.h"
+#include <QDir>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutexLocker>
+#include <cstring>
+
+// 静态成员初始化
+CoverArtCache* CoverArtCache::s_instance = nullptr;
+const QVector<int> CoverArtCache::LEVEL_EDGES = {64, 128, 350};
+
+namespace {
+
+// 8字节对齐，保证像素数据满足QImage的32位对齐要求
+inline qint64 alignTo8(qint64 value)
+{
+    return (value + 7) & ~qint64(7);
+}
+
+} // namespace
+
+CoverArtCache::CoverArtCache(QObject* parent)
+    : QObject(parent)
+    , m_mapped(nullptr)
+    , m_mappedSize(0)
+    , m_pixmapCache(MEMORY_CACHE_ITEMS, MEMORY_CACHE_BYTES, 4)
+    , m_memoryHits(0)
+    , m_atlasHits(0)
+    , m_noCoverHits(0)
+    , m_misses(0)
+    , m_decodeCount(0)
+    , m_noCoverCount(0)
+    , m_decodeTotalNs(0)
+    , m_decodeMaxNs(0)
+{
+    m_pixmapCache.setSizeFunction([](const QPixmap& pixmap) {
+        return static_cast<qint64>(pixmap.width()) * pixmap.height() * qMax(1, pixmap.depth() / 8);
+    });
+
+    // 解码受磁盘I/O和图像解码限制，不占满所有核心
+    m_threadPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+
+    openAtlas();
+
+    MetricsRegistry::registerGaugeCallback("cache.cover_art.hit_rate", [this]() { return hitRate(); });
+}
+
+CoverArtCache::~CoverArtCache()
+{
+    MetricsRegistry::unregisterGaugeCallback("cache.cover_art.hit_rate");
+    m_threadPool.waitForDone();
+    closeAtlas();
+}
+
+CoverArtCache* CoverArtCache::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    if (!s_instance) {
+        s_instance = new CoverArtCache();
+    }
+    return s_instance;
+}
+
+void CoverArtCache::cleanup()
+{
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+QString CoverArtCache::albumKey(const Song& song)
+{
+    const QString album = song.album().trimmed();
+    if (album.isEmpty() || album == "未知专辑") {
+        return QString("file:%1").arg(song.filePath());
+    }
+    return QString("album:%1\n%2").arg(song.artist().trimmed().toLower(), album.toLower());
+}
+
+QString CoverArtCache::memoryKey(const QString& key, const QSize& size)
+{
+    return QString("%1@%2x%3").arg(key).arg(size.width()).arg(size.height());
+}
+
+QPixmap CoverArtCache::cover(const Song& song, const QSize& size)
+{
+    return cover(albumKey(song), song.filePath(), size);
+}
+
+QPixmap CoverArtCache::cover(const QString& key, const QString& filePath, const QSize& size)
+{
+    if (filePath.isEmpty() || !size.isValid()) {
+        return QPixmap();
+    }
+
+    // 1. 内存中的QPixmap
+    if (std::optional<QPixmap> cached = m_pixmapCache.get(memoryKey(key, size))) {
+        ++m_memoryHits;
+        return *cached;
+    }
+
+    // 2. 内存映射的图集
+    {
+        QMutexLocker locker(&m_atlasMutex);
+        auto it = m_index.constFind(key);
+        if (it != m_index.constEnd()) {
+            if (it->noCover) {
+                ++m_noCoverHits;
+                return QPixmap();
+            }
+            ++m_atlasHits;
+            QPixmap pixmap = pixmapFromAtlas(key, size);
+            locker.unlock();
+            if (!pixmap.isNull()) {
+                m_pixmapCache.put(memoryKey(key, size), pixmap);
+            }
+            return pixmap;
+        }
+    }
+
+    // 3. 未缓存，后台解码
+    ++m_misses;
+    scheduleDecode(key, filePath);
+    return QPixmap();
+}
+
+void CoverArtCache::prefetch(const Song& song)
+{
+    if (song.filePath().isEmpty() || isCached(song)) {
+        return;
+    }
+    scheduleDecode(albumKey(song), song.filePath());
+}
+
+bool CoverArtCache::isCached(const Song& song) const
+{
+    QMutexLocker locker(&m_atlasMutex);
+    return m_index.contains(albumKey(song));
+}
+
+void CoverArtCache::clear()
+{
+    m_threadPool.waitForDone();
+    m_pixmapCache.clear();
+
+    QMutexLocker locker(&m_atlasMutex);
+    closeAtlas();
+    QFile::remove(m_atlasFile.fileName());
+    m_index.clear();
+    openAtlas();
+
+    qDebug() << "封面缓存已清空";
+}
+
+double CoverArtCache::hitRate() const
+{
+    const quint64 hits = m_memoryHits + m_atlasHits;
+    const quint64 total = hits + m_misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+}
+
+QJsonObject CoverArtCache::getStatistics() const
+{
+    QJsonObject stats;
+    stats["memoryHits"] = static_cast<qint64>(m_memoryHits.load());
+    stats["atlasHits"] = static_cast<qint64>(m_atlasHits.load());
+    stats["noCoverHits"] = static_cast<qint64>(m_noCoverHits.load());
+    stats["misses"] = static_cast<qint64>(m_misses.load());
+    stats["hitRate"] = hitRate();
+
+    const quint64 decodes = m_decodeCount;
+    stats["decodeCount"] = static_cast<qint64>(decodes);
+    stats["noCoverCount"] = static_cast<qint64>(m_noCoverCount.load());
+    stats["avgDecodeMs"] = decodes == 0 ? 0.0 : m_decodeTotalNs / 1e6 / decodes;
+    stats["maxDecodeMs"] = m_decodeMaxNs / 1e6;
+
+    ShardedCacheStats memoryStats = m_pixmapCache.statistics();
+    stats["memoryItems"] = memoryStats.itemCount;
+    stats["memoryBytes"] = memoryStats.totalBytes;
+
+    QMutexLocker locker(&m_atlasMutex);
+    stats["atlasEntries"] = m_index.size();
+    stats["atlasBytes"] = m_atlasFile.isOpen() ? m_atlasFile.size() : 0;
+    return stats;
+}
+
+void CoverArtCache::onDecodeFinished(const QString& albumKey, const QString& filePath, bool hasCover)
+{
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        m_pending.remove(albumKey);
+    }
+    emit coverReady(filePath, albumKey, hasCover);
+}
+
+void CoverArtCache::scheduleDecode(const QString& key, const QString& filePath)
+{
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        if (m_pending.contains(key)) {
+            return;
+        }
+        m_pending.insert(key);
+    }
+
+    m_threadPool.start([this, key, filePath]() {
+        decodeTask(key, filePath);
+    });
+}
+
+void CoverArtCache::decodeTask(const QString& key, const QString& filePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // 解码一次原图，再生成所有级别的缩略图
+    QImage source = Song::extractCoverImage(filePath);
+    QVector<QImage> levels;
+    if (!source.isNull()) {
+        for (int edge : LEVEL_EDGES) {
+            QImage level = (source.width() > edge || source.height() > edge)
+                ? source.scaled(edge, edge, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+                : source;
+            levels.append(level.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+        }
+    }
+
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    ++m_decodeCount;
+    m_decodeTotalNs += elapsedNs;
+    qint64 previousMax = m_decodeMaxNs.load();
+    while (elapsedNs > previousMax && !m_decodeMaxNs.compare_exchange_weak(previousMax, elapsedNs)) {
+    }
+    if (levels.isEmpty()) {
+        ++m_noCoverCount;
+    }
+
+    {
+        QMutexLocker locker(&m_atlasMutex);
+        if (!m_index.contains(key)) {
+            appendToAtlas(key, levels);
+        }
+    }
+
+    qDebug() << "封面解码完成:" << filePath << "耗时" << elapsedNs / 1000000.0 << "ms"
+             << (levels.isEmpty() ? "(无封面)" : "");
+
+    QMetaObject::invokeMethod(this, "onDecodeFinished", Qt::QueuedConnection,
+                              Q_ARG(QString, key), Q_ARG(QString, filePath),
+                              Q_ARG(bool, !levels.isEmpty()));
+}
+
+int CoverArtCache::levelForSize(const QSize& size) const
+{
+    // 选择不小于目标尺寸的最小级别，否则使用最大级别
+    const int target = qMax(size.width(), size.height());
+    for (int i = 0; i < LEVEL_EDGES.size(); ++i) {
+        if (LEVEL_EDGES[i] >= target) {
+            return i;
+        }
+    }
+    return static_cast<int>(LEVEL_EDGES.size()) - 1;
+}
+
+QPixmap CoverArtCache::pixmapFromAtlas(const QString& key, const QSize& size)
+{
+    // 调用方持有m_atlasMutex
+    const AtlasEntry& entry = m_index[key];
+    const int levelIndex = qMin(levelForSize(size), static_cast<int>(entry.levels.size()) - 1);
+    if (levelIndex < 0) {
+        return QPixmap();
+    }
+    const AtlasLevel& level = entry.levels[levelIndex];
+
+    const qint64 dataSize = static_cast<qint64>(level.bytesPerLine) * level.height;
+    if (level.offset + dataSize > m_mappedSize && !remapAtlas()) {
+        return QPixmap();
+    }
+    if (!m_mapped || level.offset + dataSize > m_mappedSize) {
+        return QPixmap();
+    }
+
+    // view直接引用映射内存；QPixmap::fromImage在部分平台上会共享而不复制像素，
+    // 先copy()出独立的缓冲区，remapAtlas()和clear()解除映射后缓存的QPixmap仍然有效
+    const QImage view(m_mapped + level.offset, level.width, level.height,
+                      level.bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+    QPixmap pixmap = QPixmap::fromImage(view.copy());
+
+    if (pixmap.width() > size.width() || pixmap.height() > size.height()) {
+        pixmap = pixmap.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return pixmap;
+}
+
+void CoverArtCache::openAtlas()
+{
+    const QString cacheDir = AppConfig::instance()->cacheDirectory() + "/covers";
+    QDir().mkpath(cacheDir);
+    m_atlasFile.setFileName(cacheDir + "/cover_atlas.bin");
+
+    if (!m_atlasFile.open(QIODevice::ReadWrite)) {
+        qWarning() << "无法打开封面图集文件:" << m_atlasFile.fileName() << m_atlasFile.errorString();
+        return;
+    }
+
+    // 超过上限或文件头不匹配时重建图集
+    quint32 header[2] = {0, 0};
+    const bool validHeader = m_atlasFile.size() >= qint64(sizeof(header))
+        && m_atlasFile.read(reinterpret_cast<char*>(header), sizeof(header)) == qint64(sizeof(header))
+        && header[0] == ATLAS_MAGIC && header[1] == ATLAS_VERSION;
+    if (!validHeader || m_atlasFile.size() > MAX_ATLAS_BYTES) {
+        m_atlasFile.resize(0);
+        header[0] = ATLAS_MAGIC;
+        header[1] = ATLAS_VERSION;
+        m_atlasFile.seek(0);
+        m_atlasFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+        m_atlasFile.flush();
+    }
+
+    remapAtlas();
+    rebuildIndex();
+
+    qDebug() << "封面图集已加载:" << m_index.size() << "个专辑," << m_atlasFile.size() << "字节";
+}
+
+void CoverArtCache::closeAtlas()
+{
+    if (m_mapped) {
+        m_atlasFile.unmap(m_mapped);
+        m_mapped = nullptr;
+        m_mappedSize = 0;
+    }
+    if (m_atlasFile.isOpen()) {
+        m_atlasFile.close();
+    }
+}
+
+bool CoverArtCache::remapAtlas()
+{
+    if (!m_atlasFile.isOpen()) {
+        return false;
+    }
+    if (m_mapped) {
+        m_atlasFile.unmap(m_mapped);
+        m_mapped = nullptr;
+        m_mappedSize = 0;
+    }
+
+    const qint64 size = m_atlasFile.size();
+    if (size <= 0) {
+        return false;
+    }
+    m_mapped = m_atlasFile.map(0, size);
+    if (!m_mapped) {
+        qWarning() << "封面图集内存映射失败:" << m_atlasFile.errorString();
+        return false;
+    }
+    m_mappedSize = size;
+    return true;
+}
+
+void CoverArtCache::rebuildIndex()
+{
+    m_index.clear();
+    if (!m_mapped) {
+        return;
+    }
+
+    // 顺序扫描记录，遇到不完整的记录（例如写入中途崩溃）时截断文件
+    qint64 offset = 2 * sizeof(quint32);
+    while (offset + qint64(sizeof(AtlasRecordHeader)) <= m_mappedSize) {
+        AtlasRecordHeader header;
+        std::memcpy(&header, m_mapped + offset, sizeof(header));
+        if (header.magic != RECORD_MAGIC) {
+            break;
+        }
+
+        const qint64 keyOffset = offset + sizeof(AtlasRecordHeader);
+        const qint64 dataOffset = alignTo8(keyOffset + header.keyLength);
+        const qint64 nextOffset = alignTo8(dataOffset + header.dataSize);
+        if (nextOffset > m_mappedSize) {
+            break;
+        }
+
+        const QString key = QString::fromUtf8(reinterpret_cast<const char*>(m_mapped + keyOffset),
+                                              header.keyLength);
+        AtlasEntry& entry = m_index[key];
+        if (header.dataSize == 0) {
+            entry.noCover = true;
+        } else {
+            AtlasLevel level;
+            level.edge = header.edge;
+            level.width = header.width;
+            level.height = header.height;
+            level.bytesPerLine = static_cast<int>(header.bytesPerLine);
+            level.offset = dataOffset;
+            entry.levels.append(level);
+        }
+        offset = nextOffset;
+    }
+
+    if (offset < m_mappedSize) {
+        qWarning() << "封面图集存在不完整记录，截断到" << offset << "字节";
+        m_atlasFile.unmap(m_mapped);
+        m_mapped = nullptr;
+        m_mappedSize = 0;
+        m_atlasFile.resize(offset);
+        remapAtlas();
+    }
+}
+
+bool CoverArtCache::appendToAtlas(const QString& key, const QVector<QImage>& levels)
+{
+    // 调用方持有m_atlasMutex
+    if (!m_atlasFile.isOpen()) {
+        return false;
+    }
+
+    const QByteArray keyData = key.toUtf8();
+    const qint64 startOffset = m_atlasFile.size();
+    QByteArray record;
+
+    auto appendRecord = [&record, &keyData, startOffset](const QImage* image, int edge) {
+        AtlasRecordHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = RECORD_MAGIC;
+        header.keyLength = static_cast<quint16>(keyData.size());
+        header.edge = static_cast<quint16>(edge);
+        if (image) {
+            header.width = static_cast<quint16>(image->width());
+            header.height = static_cast<quint16>(image->height());
+            header.bytesPerLine = static_cast<quint32>(image->bytesPerLine());
+            header.dataSize = static_cast<quint32>(image->sizeInBytes());
+        }
+        record.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        record.append(keyData);
+        record.append(QByteArray(alignTo8(startOffset + record.size()) - (startOffset + record.size()), '\0'));
+        if (image) {
+            record.append(reinterpret_cast<const char*>(image->constBits()), image->sizeInBytes());
+            record.append(QByteArray(alignTo8(startOffset + record.size()) - (startOffset + record.size()), '\0'));
+        }
+    };
+
+    if (levels.isEmpty()) {
+        appendRecord(nullptr, 0);
+    } else {
+        for (int i = 0; i < levels.size(); ++i) {
+            appendRecord(&levels[i], LEVEL_EDGES[i]);
+        }
+    }
+
+    if (startOffset + record.size() > MAX_ATLAS_BYTES) {
+        // 图集已满，整体丢弃后重新开始（已构造的QPixmap仍保留在内存缓存中）
+        qWarning() << "封面图集已达到大小上限，重建图集";
+        closeAtlas();
+        QFile::remove(m_atlasFile.fileName());
+        m_index.clear();
+        openAtlas();
+        return m_atlasFile.size() + record.size() <= MAX_ATLAS_BYTES && appendToAtlas(key, levels);
+    }
+
+    // 先整条写入再更新索引，映射在下次读取越界时重建
+    if (!m_atlasFile.seek(startOffset) || m_atlasFile.write(record) != record.size()) {
+        qWarning() << "写入封面图集失败:" << m_atlasFile.errorString();
+        m_atlasFile.resize(startOffset);
+        return false;
+    }
+    m_atlasFile.flush();
+
+    AtlasEntry& entry = m_index[key];
+    entry.noCover = levels.isEmpty();
+    qint64 offset = startOffset;
+    for (int i = 0; i < levels.size(); ++i) {
+        const qint64 dataOffset = alignTo8(offset + sizeof(AtlasRecordHeader) + keyData.size());
+        AtlasLevel level;
+        level.edge = LEVEL_EDGES[i];
+        level.width = levels[i].width();
+        level.height = levels[i].height();
+        level.bytesPerLine = static_cast<int>(levels[i].bytesPerLine());
+        level.offset = dataOffset;
+        entry.levels.append(level);
+        offset = alignTo8(dataOffset + levels[i].sizeInBytes());
+    }
+    return true;
+}
@@ -0,0 +1,189 @@
+#ifndef COVERARTCACHE_H
+#define COVERARTCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QPixmap>
+#include <QImage>
+#include <QSize>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QFile>
+#include <QMutex>
+#include <QThreadPool>
+#include <QJsonObject>
+#include <atomic>
+
+#include "../models/song.h"
+#include "../core/shardedcache.h"
+
+/**
+ * @brief 封面缩略图缓存
+ * @details 每个专辑的封面只在工作线程池中解码一次，并预先缩放为若干固定边长，
+ *          以原始像素格式追加写入缓存目录下的图集文件（cover_atlas.bin）。
+ *          图集文件通过内存映射读取，命中时从映射内存复制像素构造QPixmap，
+ *          不再打开音频文件；最近使用的QPixmap另外保存在内存LRU中。
+ *
+ *          图集文件格式：文件头 + 若干记录，每条记录为
+ *          AtlasRecordHeader + 键(UTF-8) + 对齐填充 + ARGB32_Premultiplied像素数据。
+ *          dataSize为0的记录表示该专辑没有封面，避免重复解码。
+ */
+class CoverArtCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 单例模式
+    static CoverArtCache* instance();
+    static void cleanup();
+
+    /**
+     * @brief 获取封面
+     * @param song 歌曲
+     * @param size 目标尺寸（保持宽高比缩放到该范围内）
+     * @return 已缓存时返回封面；未缓存时返回空QPixmap并在后台解码，完成后发出coverReady
+     */
+    QPixmap cover(const Song& song, const QSize& size);
+
+    /**
+     * @brief 按缓存键获取封面
+     * @param albumKey 封面缓存键（见albumKey()）
+     * @param filePath 未缓存时用于解码的歌曲文件路径
+     * @param size 目标尺寸
+     * @return 已缓存时返回封面，否则返回空QPixmap并在后台解码
+     */
+    QPixmap cover(const QString& albumKey, const QString& filePath, const QSize& size);
+
+    /**
+     * @brief 预取封面（只在后台解码，不构造QPixmap）
+     * @param song 歌曲
+     */
+    void prefetch(const Song& song);
+
+    /**
+     * @brief 查询专辑封面是否已在图集中（包括"无封面"记录）
+     * @param song 歌曲
+     * @return 是否已缓存
+     */
+    bool isCached(const Song& song) const;
+
+    /**
+     * @brief 清空内存缓存和图集文件
+     */
+    void clear();
+
+    /**
+     * @brief 获取缓存命中率
+     * @return 命中率（0.0-1.0），内存命中和图集命中都计为命中；
+     *         命中"无封面"记录的查询不返回图像，单独计数，不计入命中率
+     */
+    double hitRate() const;
+
+    /**
+     * @brief 获取统计信息
+     * @return 命中次数、解码次数、平均/最大解码耗时、图集大小等
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 计算封面缓存键
+     * @details 有专辑信息时按"艺术家+专辑"归并，同一专辑只解码一次；否则按文件路径区分
+     * @param song 歌曲
+     * @return 缓存键
+     */
+    static QString albumKey(const Song& song);
+
+signals:
+    /**
+     * @brief 后台解码完成
+     * @param filePath 触发解码的歌曲文件路径
+     * @param albumKey 封面缓存键
+     * @param hasCover 是否解码到封面
+     */
+    void coverReady(const QString& filePath, const QString& albumKey, bool hasCover);
+
+private slots:
+    void onDecodeFinished(const QString& albumKey, const QString& filePath, bool hasCover);
+
+private:
+    explicit CoverArtCache(QObject* parent = nullptr);
+    ~CoverArtCache();
+
+    // 图集中单个尺寸级别的位置
+    struct AtlasLevel {
+        int edge = 0;             // 级别边长
+        int width = 0;
+        int height = 0;
+        int bytesPerLine = 0;
+        qint64 offset = 0;        // 像素数据在文件中的偏移
+    };
+
+    // 图集中一个专辑的全部级别
+    struct AtlasEntry {
+        bool noCover = false;
+        QVector<AtlasLevel> levels;
+    };
+
+    // 记录头，按8字节对齐写入文件
+    struct AtlasRecordHeader {
+        quint32 magic;
+        quint16 keyLength;
+        quint16 edge;
+        quint16 width;
+        quint16 height;
+        quint32 bytesPerLine;
+        quint32 dataSize;
+        quint32 reserved;
+    };
+
+    void openAtlas();
+    void closeAtlas();
+    bool remapAtlas();
+    void rebuildIndex();
+    bool appendToAtlas(const QString& key, const QVector<QImage>& levels);
+    QPixmap pixmapFromAtlas(const QString& key, const QSize& size);
+    void scheduleDecode(const QString& key, const QString& filePath);
+    void decodeTask(const QString& key, const QString& filePath);
+    int levelForSize(const QSize& size) const;
+    static QString memoryKey(const QString& key, const QSize& size);
+
+    static CoverArtCache* s_instance;
+
+    // 预缩放边长，升序排列
+    static const QVector<int> LEVEL_EDGES;
+    static const quint32 ATLAS_MAGIC = 0x4143504D;    // "MPCA"
+    static const quint32 ATLAS_VERSION = 1;
+    static const quint32 RECORD_MAGIC = 0x43455243;   // "CREC"
+    static const qint64 MAX_ATLAS_BYTES = 256LL * 1024 * 1024;
+    static const qint64 MEMORY_CACHE_BYTES = 64LL * 1024 * 1024;
+    static const int MEMORY_CACHE_ITEMS = 256;
+
+    // 图集文件与映射，m_atlasMutex保护文件、映射和索引
+    mutable QMutex m_atlasMutex;
+    QFile m_atlasFile;
+    uchar* m_mapped;
+    qint64 m_mappedSize;
+    QHash<QString, AtlasEntry> m_index;
+
+    // 正在解码的键
+    mutable QMutex m_pendingMutex;
+    QSet<QString> m_pending;
+
+    // 最近使用的QPixmap（仅在GUI线程访问）
+    ShardedCache<QString, QPixmap> m_pixmapCache;
+
+    QThreadPool m_threadPool;
+
+    // 统计
+    std::atomic<quint64> m_memoryHits;
+    std::atomic<quint64> m_atlasHits;
+    std::atomic<quint64> m_noCoverHits;   // 命中"无封面"记录
+    std::atomic<quint64> m_misses;
+    std::atomic<quint64> m_decodeCount;
+    std::atomic<quint64> m_noCoverCount;
+    std::atomic<qint64> m_decodeTotalNs;
+    std::atomic<qint64> m_decodeMaxNs;
+};
+
+#endif // COVERARTCACHE_H
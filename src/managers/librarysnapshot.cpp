@@ -0,0 +1,232 @@
+#include "librarysnapshot.h"
+#include "../core/appconfig.h"
+#include "../core/tracer.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+struct StringRef
+{
+    quint32 offset;
+    quint32 length;
+};
+
+struct SnapshotHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 tagCount;
+    quint32 songCount;
+    qint32 selectedTagId;
+    StringRef selectedTagName;
+    quint32 stringBytes;
+    qint64 savedAtMs;
+};
+
+struct TagRecord
+{
+    qint32 id;
+    quint32 rgba;
+    quint32 flags;  // bit0: 系统标签
+    StringRef name;
+};
+
+struct SongRecord
+{
+    qint32 id;
+    quint32 flags;  // bit0: 最近播放
+    qint64 duration;
+    qint64 lastPlayedMs;  // -1表示无
+    StringRef title;
+    StringRef artist;
+    StringRef album;
+    StringRef filePath;
+    StringRef displayText;
+};
+
+const quint32 TAG_FLAG_SYSTEM = 0x1;
+const quint32 SONG_FLAG_RECENT = 0x1;
+
+class StringTableWriter
+{
+public:
+    StringRef add(const QString& text)
+    {
+        const QByteArray utf8 = text.toUtf8();
+        StringRef ref{static_cast<quint32>(m_data.size()), static_cast<quint32>(utf8.size())};
+        m_data.append(utf8);
+        return ref;
+    }
+
+    const QByteArray& data() const { return m_data; }
+
+private:
+    QByteArray m_data;
+};
+
+} // namespace
+
+QString LibrarySnapshot::defaultPath()
+{
+    return AppConfig::instance()->cacheDirectory() + "/library.snapshot";
+}
+
+bool LibrarySnapshot::save(const QString& filePath, const LibrarySnapshotData& data)
+{
+    TRACE_FUNCTION("ui");
+
+    StringTableWriter strings;
+    QByteArray records;
+    records.reserve(data.tags.size() * int(sizeof(TagRecord)) + data.songs.size() * int(sizeof(SongRecord)));
+
+    for (const LibrarySnapshotData::TagItem& tag : data.tags) {
+        TagRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = tag.id;
+        record.rgba = tag.color.rgba();
+        record.flags = tag.system ? TAG_FLAG_SYSTEM : 0;
+        record.name = strings.add(tag.name);
+        records.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    for (const LibrarySnapshotData::SongItem& item : data.songs) {
+        const Song& song = item.song;
+        SongRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = song.id();
+        record.flags = item.recentPlay ? SONG_FLAG_RECENT : 0;
+        record.duration = song.duration();
+        record.lastPlayedMs = song.lastPlayedTime().isValid() ? song.lastPlayedTime().toMSecsSinceEpoch() : -1;
+        record.title = strings.add(song.title());
+        record.artist = strings.add(song.artist());
+        record.album = strings.add(song.album());
+        record.filePath = strings.add(song.filePath());
+        record.displayText = strings.add(item.displayText);
+        records.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.tagCount = static_cast<quint32>(data.tags.size());
+    header.songCount = static_cast<quint32>(data.songs.size());
+    header.selectedTagId = data.selectedTagId;
+    header.selectedTagName = strings.add(data.selectedTagName);
+    header.stringBytes = static_cast<quint32>(strings.data().size());
+    header.savedAtMs = QDateTime::currentMSecsSinceEpoch();
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "LibrarySnapshot: 无法写入快照:" << filePath << file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(records);
+    file.write(strings.data());
+    if (!file.commit()) {
+        qWarning() << "LibrarySnapshot: 保存快照失败:" << filePath << file.errorString();
+        return false;
+    }
+
+    qDebug() << "LibrarySnapshot: 已保存" << data.tags.size() << "个标签，" << data.songs.size() << "首歌曲";
+    return true;
+}
+
+bool LibrarySnapshot::load(const QString& filePath, LibrarySnapshotData* data)
+{
+    TRACE_FUNCTION("ui");
+
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(SnapshotHeader))) {
+        return false;
+    }
+
+    uchar* mapped = file.map(0, size);
+    if (!mapped) {
+        qWarning() << "LibrarySnapshot: 快照内存映射失败:" << file.errorString();
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, mapped, sizeof(header));
+
+    const quint64 recordBytes = quint64(header.tagCount) * sizeof(TagRecord)
+                              + quint64(header.songCount) * sizeof(SongRecord);
+    const quint64 expectedSize = sizeof(SnapshotHeader) + recordBytes + header.stringBytes;
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || expectedSize != quint64(size)) {
+        file.unmap(mapped);
+        return false;
+    }
+
+    const uchar* tagRecords = mapped + sizeof(SnapshotHeader);
+    const uchar* songRecords = tagRecords + quint64(header.tagCount) * sizeof(TagRecord);
+    const char* stringTable = reinterpret_cast<const char*>(songRecords + quint64(header.songCount) * sizeof(SongRecord));
+
+    bool valid = true;
+    auto text = [&](const StringRef& ref) {
+        if (quint64(ref.offset) + ref.length > header.stringBytes) {
+            valid = false;
+            return QString();
+        }
+        return QString::fromUtf8(stringTable + ref.offset, ref.length);
+    };
+
+    LibrarySnapshotData result;
+    result.selectedTagId = header.selectedTagId;
+    result.selectedTagName = text(header.selectedTagName);
+    result.savedAtMs = header.savedAtMs;
+
+    result.tags.reserve(header.tagCount);
+    for (quint32 i = 0; i < header.tagCount && valid; ++i) {
+        TagRecord record;
+        std::memcpy(&record, tagRecords + quint64(i) * sizeof(TagRecord), sizeof(record));
+        LibrarySnapshotData::TagItem tag;
+        tag.id = record.id;
+        tag.color = QColor::fromRgba(record.rgba);
+        tag.system = record.flags & TAG_FLAG_SYSTEM;
+        tag.name = text(record.name);
+        result.tags.append(tag);
+    }
+
+    result.songs.reserve(header.songCount);
+    for (quint32 i = 0; i < header.songCount && valid; ++i) {
+        SongRecord record;
+        std::memcpy(&record, songRecords + quint64(i) * sizeof(SongRecord), sizeof(record));
+        LibrarySnapshotData::SongItem item;
+        item.song.setId(record.id);
+        item.song.setDuration(record.duration);
+        if (record.lastPlayedMs >= 0) {
+            item.song.setLastPlayedTime(QDateTime::fromMSecsSinceEpoch(record.lastPlayedMs));
+        }
+        item.song.setTitle(text(record.title));
+        item.song.setArtist(text(record.artist));
+        item.song.setAlbum(text(record.album));
+        item.song.setCachedFilePath(text(record.filePath));
+        item.displayText = text(record.displayText);
+        item.recentPlay = record.flags & SONG_FLAG_RECENT;
+        result.songs.append(item);
+    }
+
+    file.unmap(mapped);
+
+    if (!valid) {
+        qWarning() << "LibrarySnapshot: 快照字符串越界，忽略:" << filePath;
+        return false;
+    }
+
+    *data = result;
+    return true;
+}
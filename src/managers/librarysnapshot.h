@@ -0,0 +1,70 @@
+#ifndef LIBRARYSNAPSHOT_H
+#define LIBRARYSNAPSHOT_H
+
+#include <QString>
+#include <QList>
+#include <QColor>
+#include "../models/song.h"
+
+/**
+ * @brief 曲库视图快照数据：标签列表和最后查看的歌曲列表
+ */
+struct LibrarySnapshotData
+{
+    struct TagItem {
+        int id = -1;
+        QString name;
+        QColor color;
+        bool system = false;
+    };
+
+    struct SongItem {
+        Song song;
+        QString displayText;
+        bool recentPlay = false;  // 来自"最近播放"列表
+    };
+
+    QList<TagItem> tags;
+    QList<SongItem> songs;
+    int selectedTagId = -1;
+    QString selectedTagName;
+    qint64 savedAtMs = 0;
+};
+
+/**
+ * @brief 曲库视图的二进制快照
+ *
+ * 退出时（以及定期）把主窗口已渲染的列表写入缓存目录，下次启动时内存映射读取，
+ * 在查询数据库之前就显示出列表，随后再与数据库同步。
+ *
+ * 文件布局（本机字节序，只作为本机缓存使用）：
+ *   Header | TagRecord[tagCount] | SongRecord[songCount] | UTF-8字符串区
+ * 记录定长，字符串以(偏移, 长度)引用字符串区；任何越界或文件头不匹配都视为无快照。
+ */
+class LibrarySnapshot
+{
+public:
+    /**
+     * @brief 默认快照路径（缓存目录下）
+     */
+    static QString defaultPath();
+
+    /**
+     * @brief 原子写入快照
+     * @return 写入是否成功
+     */
+    static bool save(const QString& filePath, const LibrarySnapshotData& data);
+
+    /**
+     * @brief 映射并解析快照
+     * @param filePath 快照路径
+     * @param data 输出数据
+     * @return 文件存在且格式有效时返回true
+     */
+    static bool load(const QString& filePath, LibrarySnapshotData* data);
+
+    static const quint32 SNAPSHOT_MAGIC = 0x534C504D;  // "MPLS"
+    static const quint32 SNAPSHOT_VERSION = 1;
+};
+
+#endif // LIBRARYSNAPSHOT_H
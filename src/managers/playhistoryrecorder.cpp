@@ -0,0 +1,315 @@
+#include "playhistoryrecorder.h"
+#include "../database/playhistorydao.h"
+#include "../database/smartplaylistdao.h"
+#include "smartplaylist.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSaveFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QDebug>
+
+// 静态成员初始化
+PlayHistoryRecorder* PlayHistoryRecorder::s_instance = nullptr;
+void (*PlayHistoryRecorder::s_journalCommitHook)() = nullptr;
+
+PlayHistoryRecorder::PlayHistoryRecorder(QObject* parent)
+    : QObject(parent)
+    , m_writingCount(0)
+    , m_flushRequested(false)
+    , m_writerThread(nullptr)
+    , m_running(false)
+    , m_stopping(false)
+{
+}
+
+PlayHistoryRecorder::~PlayHistoryRecorder()
+{
+    stop();
+}
+
+PlayHistoryRecorder* PlayHistoryRecorder::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    if (!s_instance) {
+        s_instance = new PlayHistoryRecorder();
+    }
+    return s_instance;
+}
+
+void PlayHistoryRecorder::cleanup()
+{
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+bool PlayHistoryRecorder::start(const QString& databasePath, const QString& journalPath)
+{
+    if (m_running.load()) {
+        return true;
+    }
+    if (databasePath.isEmpty()) {
+        qWarning() << "PlayHistoryRecorder::start: 数据库路径为空，播放记录将同步写入";
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_databasePath = databasePath;
+    m_journal.setFileName(journalPath);
+
+    // 上次崩溃时未写入的记录排在最前面
+    const QList<PlayHistory> replayed = readJournal();
+    if (!replayed.isEmpty()) {
+        qDebug() << "PlayHistoryRecorder::start: 从日志文件重放" << replayed.size() << "条播放记录";
+        m_pending = replayed + m_pending;
+    }
+
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "PlayHistoryRecorder::start: 无法打开日志文件" << journalPath
+                   << "，程序崩溃时会丢失尚未写入的播放记录";
+    }
+    rewriteJournal();
+
+    m_flushRequested = !m_pending.isEmpty();
+    m_stopping = false;
+    m_running = true;
+    m_writerThread = QThread::create([this]() { writerLoop(); });
+    m_writerThread->setObjectName("PlayHistoryWriter");
+    m_writerThread->start(QThread::LowPriority);
+    return true;
+}
+
+void PlayHistoryRecorder::stop()
+{
+    if (!m_writerThread) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_writerWake.wakeAll();
+    }
+    m_writerThread->wait();
+    delete m_writerThread;
+    m_writerThread = nullptr;
+    m_running = false;
+
+    // 写入失败的记录留在日志文件中，下次启动时重放
+    QMutexLocker locker(&m_mutex);
+    if (!m_pending.isEmpty()) {
+        qWarning() << "PlayHistoryRecorder::stop:" << m_pending.size() << "条播放记录未写入，保留在日志文件中";
+    }
+    m_journal.close();
+}
+
+void PlayHistoryRecorder::record(int songId, const QDateTime& playedAt)
+{
+    if (songId <= 0) {
+        return;
+    }
+
+    const PlayHistory entry(songId, playedAt);
+    QMutexLocker locker(&m_mutex);
+    m_pending.append(entry);
+    if (m_journal.isOpen()) {
+        m_journal.write(journalLine(entry));
+        m_journal.flush();
+    }
+
+    if (!m_running.load()) {
+        // 写线程未运行：在调用线程同步写入，失败的记录留在队列中下次一起写
+        PlayHistoryDao playHistoryDao;
+        if (playHistoryDao.addPlayRecords(m_pending) >= 0) {
+            m_pending.clear();
+            rewriteJournal();
+        }
+        return;
+    }
+
+    if (m_pending.size() >= FLUSH_BATCH_SIZE) {
+        m_writerWake.wakeAll();
+    }
+}
+
+bool PlayHistoryRecorder::flush(bool wait)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_running.load()) {
+        return m_pending.isEmpty();
+    }
+
+    m_flushRequested = true;
+    m_writerWake.wakeAll();
+    if (!wait) {
+        return true;
+    }
+
+    QDeadlineTimer deadline(FLUSH_WAIT_TIMEOUT_MS);
+    while ((!m_pending.isEmpty() || m_writingCount > 0) && m_running.load()) {
+        if (!m_idle.wait(&m_mutex, deadline)) {
+            qWarning() << "PlayHistoryRecorder::flush: 等待写入超时，剩余" << m_pending.size() + m_writingCount << "条";
+            return false;
+        }
+    }
+    return m_pending.isEmpty() && m_writingCount == 0;
+}
+
+int PlayHistoryRecorder::pendingCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.size() + m_writingCount;
+}
+
+void PlayHistoryRecorder::writerLoop()
+{
+    const QString connectionName = QString("PlayHistoryWriter_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(m_databasePath);
+        // 与主连接的写入冲突时等待，而不是立即失败
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+        if (!db.open()) {
+            qCritical() << "PlayHistoryRecorder: 写线程无法打开数据库:" << db.lastError().text()
+                        << "，播放记录改为同步写入";
+            QMutexLocker locker(&m_mutex);
+            m_running = false;
+            m_idle.wakeAll();
+        } else {
+            PlayHistoryDao playHistoryDao(db);
+            SmartPlaylistDao smartPlaylistDao(db);
+            QElapsedTimer sincePrune;
+            sincePrune.start();
+            bool pruneDue = true;  // 启动后先清理一次（重放的记录、旧版本遗留的重复记录）
+            bool lastWriteFailed = false;
+
+            while (true) {
+                QList<PlayHistory> batch;
+                bool stopping = false;
+                {
+                    QMutexLocker locker(&m_mutex);
+                    if (!m_stopping.load() && !m_flushRequested
+                        && (lastWriteFailed || m_pending.size() < FLUSH_BATCH_SIZE)) {
+                        m_writerWake.wait(&m_mutex, FLUSH_INTERVAL_MS);
+                    }
+                    stopping = m_stopping.load();
+                    m_flushRequested = false;
+                    batch.swap(m_pending);
+                    m_writingCount = batch.size();
+                }
+
+                int written = 0;
+                if (!batch.isEmpty()) {
+                    written = playHistoryDao.addPlayRecords(batch);
+                    lastWriteFailed = written < 0;
+
+                    QMutexLocker locker(&m_mutex);
+                    m_writingCount = 0;
+                    if (lastWriteFailed) {
+                        // 写入失败（如数据库长时间被占用）时放回队列，日志文件不变，稍后重试
+                        m_pending = batch + m_pending;
+                    } else {
+                        rewriteJournal();
+                    }
+                    m_idle.wakeAll();
+                } else {
+                    QMutexLocker locker(&m_mutex);
+                    m_idle.wakeAll();
+                }
+
+                if (written > 0) {
+                    emit recordsWritten(written);
+                }
+
+                if (stopping) {
+                    break;
+                }
+
+                if (pruneDue || sincePrune.elapsed() >= PRUNE_INTERVAL_MS) {
+                    playHistoryDao.prunePlayHistory(MAX_HISTORY_RECORDS);
+                    // 智能播放列表未被访问时没有人消费变更日志，在这里限制它的大小
+                    smartPlaylistDao.capChanges(SmartPlaylistEngine::MAX_CHANGE_LOG_ROWS);
+                    sincePrune.restart();
+                    pruneDue = false;
+                }
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+QList<PlayHistory> PlayHistoryRecorder::readJournal() const
+{
+    QList<PlayHistory> records;
+    QFile file(m_journal.fileName());
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        const QList<QByteArray> fields = line.split('\t');
+        if (fields.size() != 2) {
+            continue;
+        }
+        bool idOk = false;
+        bool timeOk = false;
+        const int songId = fields[0].toInt(&idOk);
+        const qint64 msecs = fields[1].toLongLong(&timeOk);
+        if (idOk && timeOk && songId > 0) {
+            records.append(PlayHistory(songId, QDateTime::fromMSecsSinceEpoch(msecs)));
+        }
+    }
+    return records;
+}
+
+void PlayHistoryRecorder::rewriteJournal()
+{
+    if (!m_journal.isOpen()) {
+        return;
+    }
+
+    // 先写到临时文件再整体替换：任何时刻崩溃，磁盘上要么是旧日志（只多不少，重放时去重），
+    // 要么是完整的新日志，不会出现截断后尚未写回的空文件
+    QSaveFile compacted(m_journal.fileName());
+    if (!compacted.open(QIODevice::WriteOnly)) {
+        qWarning() << "PlayHistoryRecorder: 无法创建临时日志文件:" << compacted.errorString() << "，保留原日志";
+        return;
+    }
+    for (const PlayHistory& entry : m_pending) {
+        compacted.write(journalLine(entry));
+    }
+
+    if (s_journalCommitHook) {
+        s_journalCommitHook();
+    }
+
+    // 替换前关闭旧句柄（部分平台不能替换仍打开的文件），替换后重新以追加方式打开
+    m_journal.close();
+    if (!compacted.commit()) {
+        qWarning() << "PlayHistoryRecorder: 替换日志文件失败:" << compacted.errorString() << "，保留原日志";
+    }
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "PlayHistoryRecorder: 无法重新打开日志文件" << m_journal.fileName()
+                   << "，程序崩溃时会丢失尚未写入的播放记录";
+    }
+}
+
+void PlayHistoryRecorder::setJournalCommitHook(void (*hook)())
+{
+    s_journalCommitHook = hook;
+}
+
+QByteArray PlayHistoryRecorder::journalLine(const PlayHistory& record)
+{
+    return QByteArray::number(record.songId()) + '\t'
+         + QByteArray::number(record.playedAt().toMSecsSinceEpoch()) + '\n';
+}
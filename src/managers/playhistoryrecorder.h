@@ -0,0 +1,131 @@
+#ifndef PLAYHISTORYRECORDER_H
+#define PLAYHISTORYRECORDER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QFile>
+#include <QDateTime>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+#include "../models/playhistory.h"
+
+class QThread;
+
+/**
+ * @brief 播放历史的后台批量写入（write-behind）
+ * @details record()只把播放事件追加到内存队列和日志文件（每条一行"歌曲ID\t毫秒时间戳"），
+ *          不访问数据库；写线程使用独立的数据库连接，每FLUSH_INTERVAL_MS或积累
+ *          FLUSH_BATCH_SIZE条时在一个事务中写入，成功后把日志文件重写为尚未写入的记录
+ *          （写临时文件后原子替换，重写过程中崩溃时保留旧日志）。
+ *          每首歌只保留最新记录和总数限制改为每PRUNE_INTERVAL_MS清理一次，
+ *          同时截断智能播放列表的变更日志。
+ *
+ *          程序崩溃时日志文件中的记录在下次start()时重放；写入按(歌曲ID, 时间)去重，
+ *          已写入但未从日志删除的记录不会重复。日志只写入操作系统缓存，不逐条fsync，
+ *          只防进程崩溃，不防断电。
+ *
+ *          未start()时（测试、数据库未就绪）record()退化为在调用线程同步写入。
+ */
+class PlayHistoryRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int FLUSH_INTERVAL_MS = 2000;          // 批量写入间隔
+    static const int FLUSH_BATCH_SIZE = 32;             // 积累到这么多条时提前写入
+    static const int PRUNE_INTERVAL_MS = 10 * 60 * 1000; // 清理间隔
+    static const int MAX_HISTORY_RECORDS = 1000;        // 清理后保留的最大记录数
+    static const int FLUSH_WAIT_TIMEOUT_MS = 5000;      // flush(true)的最长等待时间
+
+    // 单例模式
+    static PlayHistoryRecorder* instance();
+
+    /**
+     * @brief 写出剩余记录并停止写线程
+     */
+    static void cleanup();
+
+    /**
+     * @brief 重放日志文件并启动写线程
+     * @param databasePath 数据库文件路径（写线程打开独立连接）
+     * @param journalPath 日志文件路径
+     * @return 是否成功启动
+     */
+    bool start(const QString& databasePath, const QString& journalPath);
+
+    bool isRunning() const { return m_running.load(); }
+
+    /**
+     * @brief 记录一次播放，只追加到内存队列和日志文件
+     * @param songId 歌曲ID
+     * @param playedAt 播放时间
+     */
+    void record(int songId, const QDateTime& playedAt = QDateTime::currentDateTime());
+
+    /**
+     * @brief 立即写入队列中的记录
+     * @param wait 是否等待写入完成（读取"最近播放"或删除记录之前使用）
+     * @return wait为true时返回是否在超时前全部写入，否则总是true
+     */
+    bool flush(bool wait = false);
+
+    /**
+     * @brief 尚未写入数据库的记录数（含正在写入的）
+     */
+    int pendingCount() const;
+
+    /**
+     * @brief 仅供测试：在新日志写入临时文件之后、替换旧日志之前调用，用于模拟此时崩溃
+     */
+    static void setJournalCommitHook(void (*hook)());
+
+signals:
+    /**
+     * @brief 一批记录已写入数据库（在写线程中发出）
+     * @param count 写入的记录数
+     */
+    void recordsWritten(int count);
+
+private:
+    explicit PlayHistoryRecorder(QObject* parent = nullptr);
+    ~PlayHistoryRecorder();
+
+    PlayHistoryRecorder(const PlayHistoryRecorder&) = delete;
+    PlayHistoryRecorder& operator=(const PlayHistoryRecorder&) = delete;
+
+    void stop();
+    void writerLoop();
+
+    /**
+     * @brief 读取日志文件中的记录，忽略崩溃时写了一半的行
+     */
+    QList<PlayHistory> readJournal() const;
+
+    /**
+     * @brief 把日志文件原子地重写为当前队列（调用方持有m_mutex）
+     */
+    void rewriteJournal();
+
+    static QByteArray journalLine(const PlayHistory& record);
+
+    static PlayHistoryRecorder* s_instance;
+    static void (*s_journalCommitHook)();
+
+    mutable QMutex m_mutex;               // 保护队列和日志文件
+    QWaitCondition m_writerWake;
+    QWaitCondition m_idle;                // 队列写空时唤醒flush(true)
+    QList<PlayHistory> m_pending;
+    int m_writingCount;                   // 写线程正在写入的记录数
+    bool m_flushRequested;
+    QFile m_journal;
+
+    QString m_databasePath;
+    QThread* m_writerThread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stopping;
+};
+
+#endif // PLAYHISTORYRECORDER_H
@@ -0,0 +1,517 @@
+#include "playlistio.h"
+#include "../database/playlistdao.h"
+#include "../core/constants.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QUrl>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QStringConverter>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace {
+
+void setError(QString* error, const QString& message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+QString resolveLocation(QString location, const QDir& baseDir)
+{
+    location = location.trimmed();
+    if (location.isEmpty()) {
+        return location;
+    }
+
+    if (location.startsWith("file:", Qt::CaseInsensitive)) {
+        location = QUrl(location).toLocalFile();
+    } else if (location.contains("://")) {
+        // 网络地址原样保留，曲库中不会有对应的歌曲
+        return location;
+    }
+
+    if (QFileInfo(location).isRelative()) {
+        location = baseDir.absoluteFilePath(location);
+    }
+    return QDir::cleanPath(location);
+}
+
+/**
+ * @brief 只缓存一批路径的解析器：批满时做一次IN查找，把找到的ID按顺序追加到结果中
+ */
+class PathResolver
+{
+public:
+    PathResolver(QSqlDatabase db, PlaylistImportResult* result)
+        : m_db(db), m_result(result)
+    {
+        m_batch.reserve(PlaylistImporter::RESOLVE_BATCH_SIZE);
+    }
+
+    bool add(const QString& path)
+    {
+        m_batch.append(path);
+        return m_batch.size() < PlaylistImporter::RESOLVE_BATCH_SIZE || flush();
+    }
+
+    bool flush()
+    {
+        if (m_batch.isEmpty()) {
+            return true;
+        }
+
+        // 曲库中的路径可能是本地分隔符，两种写法都查
+        QSet<QString> keys;
+        for (const QString& path : m_batch) {
+            keys.insert(path);
+            keys.insert(QDir::toNativeSeparators(path));
+        }
+
+        QString placeholders = QString("?, ").repeated(keys.size());
+        placeholders.chop(2);
+
+        QSqlQuery query(m_db);
+        query.setForwardOnly(true);
+        query.prepare(QString("SELECT id, file_path FROM %1 WHERE file_path IN (%2)")
+                          .arg(Constants::Database::TABLE_SONGS, placeholders));
+        for (const QString& key : keys) {
+            query.addBindValue(key);
+        }
+        if (!query.exec()) {
+            m_result->error = QString("查找歌曲失败: %1").arg(query.lastError().text());
+            return false;
+        }
+
+        QHash<QString, int> found;
+        while (query.next()) {
+            found.insert(query.value(1).toString(), query.value(0).toInt());
+        }
+
+        for (const QString& path : m_batch) {
+            const int songId = found.value(path, found.value(QDir::toNativeSeparators(path), -1));
+            if (songId <= 0) {
+                ++m_result->missingCount;
+            } else if (!m_seen.contains(songId)) {
+                m_seen.insert(songId);
+                m_result->songIds.append(songId);
+            }
+        }
+        m_batch.clear();
+        return true;
+    }
+
+private:
+    QSqlDatabase m_db;
+    PlaylistImportResult* m_result;
+    QStringList m_batch;
+    QSet<int> m_seen;
+};
+
+} // namespace
+
+bool PlaylistFileReader::formatForFile(const QString& filePath, ExportFormat* format)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "m3u" || suffix == "m3u8") {
+        *format = ExportFormat::M3U;
+    } else if (suffix == "pls") {
+        *format = ExportFormat::PLS;
+    } else if (suffix == "xspf") {
+        *format = ExportFormat::XSPF;
+    } else if (suffix == "json") {
+        *format = ExportFormat::JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistFileReader::read(const QString& filePath, ExportFormat format, const EntryHandler& handler,
+                              QString* playlistName, QString* error)
+{
+    switch (format) {
+    case ExportFormat::M3U:
+        return readM3U(filePath, handler, playlistName, error);
+    case ExportFormat::PLS:
+        return readPLS(filePath, handler, playlistName, error);
+    case ExportFormat::XSPF:
+        return readXSPF(filePath, handler, playlistName, error);
+    case ExportFormat::JSON:
+        return readJSON(filePath, handler, playlistName, error);
+    }
+    setError(error, "不支持的播放列表格式");
+    return false;
+}
+
+bool PlaylistFileReader::readM3U(const QString& filePath, const EntryHandler& handler,
+                                 QString* playlistName, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        setError(error, QString("无法打开M3U播放列表文件: %1").arg(filePath));
+        return false;
+    }
+
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Utf8);
+    const QDir baseDir = QFileInfo(filePath).absoluteDir();
+
+    // #EXTINF描述紧随其后的一行路径
+    PlaylistFileEntry entry;
+    QString line;
+    while (in.readLineInto(&line)) {
+        line = line.trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        if (line.startsWith('#')) {
+            if (line.startsWith("#EXTINF:", Qt::CaseInsensitive)) {
+                const int comma = line.indexOf(',');
+                bool ok = false;
+                const qint64 seconds = line.mid(8, comma < 0 ? -1 : comma - 8).trimmed().toLongLong(&ok);
+                entry.durationMs = ok && seconds >= 0 ? seconds * 1000 : -1;
+                entry.title = comma < 0 ? QString() : line.mid(comma + 1).trimmed();
+            } else if (line.startsWith("#PLAYLIST:", Qt::CaseInsensitive) && playlistName) {
+                *playlistName = line.mid(10).trimmed();
+            }
+            continue;
+        }
+
+        entry.location = resolveLocation(line, baseDir);
+        if (!handler(entry)) {
+            return true;
+        }
+        entry = PlaylistFileEntry();
+    }
+    return true;
+}
+
+bool PlaylistFileReader::readPLS(const QString& filePath, const EntryHandler& handler,
+                                 QString* playlistName, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        setError(error, QString("无法打开PLS播放列表文件: %1").arg(filePath));
+        return false;
+    }
+
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Utf8);
+    const QDir baseDir = QFileInfo(filePath).absoluteDir();
+
+    // FileN之后的TitleN/LengthN属于同一条目，遇到下一个FileN或文件结束时交出
+    PlaylistFileEntry pending;
+    QString pendingIndex;
+    QString line;
+    while (in.readLineInto(&line)) {
+        const int equalPos = line.indexOf('=');
+        if (equalPos <= 0) {
+            continue;
+        }
+        const QString key = line.left(equalPos).trimmed();
+        const QString value = line.mid(equalPos + 1).trimmed();
+
+        if (key.startsWith("File", Qt::CaseInsensitive)) {
+            if (!pendingIndex.isEmpty() && !handler(pending)) {
+                return true;
+            }
+            pending = PlaylistFileEntry();
+            pending.location = resolveLocation(value, baseDir);
+            pendingIndex = key.mid(4);
+        } else if (key.startsWith("Title", Qt::CaseInsensitive) && key.mid(5) == pendingIndex) {
+            pending.title = value;
+        } else if (key.startsWith("Length", Qt::CaseInsensitive) && key.mid(6) == pendingIndex) {
+            const qint64 seconds = value.toLongLong();
+            pending.durationMs = seconds >= 0 ? seconds * 1000 : -1;
+        } else if (key.compare("PlaylistName", Qt::CaseInsensitive) == 0 && playlistName) {
+            *playlistName = value;
+        }
+    }
+
+    if (!pendingIndex.isEmpty()) {
+        handler(pending);
+    }
+    return true;
+}
+
+bool PlaylistFileReader::readXSPF(const QString& filePath, const EntryHandler& handler,
+                                  QString* playlistName, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, QString("无法打开XSPF播放列表文件: %1").arg(filePath));
+        return false;
+    }
+
+    QXmlStreamReader xml(&file);
+    const QDir baseDir = QFileInfo(filePath).absoluteDir();
+    PlaylistFileEntry entry;
+    bool inTrack = false;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isStartElement()) {
+            const QStringView name = xml.name();
+            if (name == QStringLiteral("track")) {
+                inTrack = true;
+                entry = PlaylistFileEntry();
+            } else if (inTrack && name == QStringLiteral("location")) {
+                const QString location = xml.readElementText();
+                if (entry.location.isEmpty()) {
+                    entry.location = resolveLocation(location, baseDir);
+                }
+            } else if (inTrack && name == QStringLiteral("title")) {
+                entry.title = xml.readElementText().trimmed();
+            } else if (inTrack && name == QStringLiteral("duration")) {
+                bool ok = false;
+                const qint64 duration = xml.readElementText().trimmed().toLongLong(&ok);
+                entry.durationMs = ok ? duration : -1;
+            } else if (!inTrack && name == QStringLiteral("title") && playlistName) {
+                *playlistName = xml.readElementText().trimmed();
+            }
+        } else if (xml.isEndElement() && xml.name() == QStringLiteral("track")) {
+            inTrack = false;
+            if (!entry.location.isEmpty() && !handler(entry)) {
+                return true;
+            }
+        }
+    }
+
+    if (xml.hasError()) {
+        setError(error, QString("XSPF解析错误: %1（第%2行）").arg(xml.errorString()).arg(xml.lineNumber()));
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistFileReader::readJSON(const QString& filePath, const EntryHandler& handler,
+                                  QString* playlistName, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, QString("无法打开JSON播放列表文件: %1").arg(filePath));
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    file.close();
+    if (doc.isNull()) {
+        setError(error, QString("JSON解析错误: %1").arg(parseError.errorString()));
+        return false;
+    }
+
+    // 与导出格式相同：{"name": ..., "songs": [{"file_path": ...}, ...]}，也接受路径数组
+    const QJsonObject root = doc.object();
+    if (playlistName && root.contains("name")) {
+        *playlistName = root.value("name").toString();
+    }
+    const QJsonArray songs = doc.isArray() ? doc.array() : root.value("songs").toArray();
+    const QDir baseDir = QFileInfo(filePath).absoluteDir();
+
+    for (const QJsonValue& value : songs) {
+        PlaylistFileEntry entry;
+        if (value.isString()) {
+            entry.location = resolveLocation(value.toString(), baseDir);
+        } else {
+            const QJsonObject songObj = value.toObject();
+            entry.location = resolveLocation(songObj.value("file_path").toString(), baseDir);
+            entry.title = songObj.value("title").toString();
+            entry.durationMs = songObj.contains("duration")
+                ? static_cast<qint64>(songObj.value("duration").toDouble()) : -1;
+        }
+        if (!entry.location.isEmpty() && !handler(entry)) {
+            break;
+        }
+    }
+    return true;
+}
+
+PlaylistImportResult PlaylistImporter::resolve(const QString& filePath, const QString& databasePath)
+{
+    PlaylistImportResult result;
+    result.filePath = filePath;
+    QElapsedTimer timer;
+    timer.start();
+
+    ExportFormat format;
+    if (!PlaylistFileReader::formatForFile(filePath, &format)) {
+        result.error = QString("不支持的播放列表格式: %1").arg(QFileInfo(filePath).suffix());
+        return result;
+    }
+
+    const QString connectionName = QString("PlaylistImport_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databasePath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (!db.open()) {
+            result.error = QString("无法打开数据库: %1").arg(db.lastError().text());
+        } else {
+            PathResolver resolver(db, &result);
+            bool resolveFailed = false;
+
+            const bool readOk = PlaylistFileReader::read(filePath, format,
+                [&](const PlaylistFileEntry& entry) {
+                    ++result.entryCount;
+                    if (!resolver.add(entry.location)) {
+                        resolveFailed = true;
+                        return false;
+                    }
+                    return true;
+                }, &result.playlistName, &result.error);
+
+            result.success = readOk && !resolveFailed && resolver.flush();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (result.playlistName.trimmed().isEmpty()) {
+        result.playlistName = QFileInfo(filePath).completeBaseName();
+    }
+    result.elapsedMs = timer.elapsed();
+
+    qDebug() << "PlaylistImporter::resolve:" << filePath << "条目" << result.entryCount
+             << "找到" << result.songIds.size() << "缺失" << result.missingCount
+             << "耗时" << result.elapsedMs << "ms";
+    return result;
+}
+
+bool PlaylistExporter::write(int playlistId, const QString& filePath, ExportFormat format, QString* error)
+{
+    PlaylistDao dao;
+    const Playlist playlist = dao.getPlaylistById(playlistId);
+    if (!playlist.isValid()) {
+        setError(error, QString("播放列表不存在: ID=%1").arg(playlistId));
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        setError(error, QString("无法创建文件: %1").arg(filePath));
+        return false;
+    }
+
+    int count = 0;
+    bool ok = true;
+
+    if (format == ExportFormat::XSPF) {
+        QXmlStreamWriter xml(&file);
+        xml.setAutoFormatting(true);
+        xml.writeStartDocument();
+        xml.writeStartElement("playlist");
+        xml.writeAttribute("version", "1");
+        xml.writeDefaultNamespace("http://xspf.org/ns/0/");
+        xml.writeTextElement("title", playlist.name());
+        xml.writeStartElement("trackList");
+        ok = dao.forEachPlaylistSong(playlistId, [&](const Song& song) {
+            xml.writeStartElement("track");
+            xml.writeTextElement("location", QUrl::fromLocalFile(song.filePath()).toString());
+            xml.writeTextElement("title", song.title());
+            xml.writeTextElement("creator", song.artist());
+            xml.writeTextElement("album", song.album());
+            xml.writeTextElement("duration", QString::number(song.duration()));
+            xml.writeEndElement();
+            ++count;
+            return !xml.hasError();
+        });
+        xml.writeEndElement();  // trackList
+        xml.writeEndElement();  // playlist
+        xml.writeEndDocument();
+        ok = ok && !xml.hasError();
+    } else {
+        QTextStream out(&file);
+        out.setEncoding(QStringConverter::Utf8);
+
+        switch (format) {
+        case ExportFormat::M3U:
+            out << "#EXTM3U\n";
+            out << "#PLAYLIST:" << playlist.name() << '\n';
+            ok = dao.forEachPlaylistSong(playlistId, [&](const Song& song) {
+                out << "#EXTINF:" << song.duration() / 1000 << ',' << song.artist() << " - " << song.title() << '\n';
+                out << song.filePath() << '\n';
+                ++count;
+                return out.status() == QTextStream::Ok;
+            });
+            break;
+
+        case ExportFormat::PLS:
+            // NumberOfEntries写在条目之后，不需要预先知道数量
+            out << "[playlist]\n";
+            out << "PlaylistName=" << playlist.name() << '\n';
+            ok = dao.forEachPlaylistSong(playlistId, [&](const Song& song) {
+                const int index = ++count;
+                out << "File" << index << '=' << song.filePath() << '\n';
+                out << "Title" << index << '=' << song.artist() << " - " << song.title() << '\n';
+                out << "Length" << index << '=' << song.duration() / 1000 << '\n';
+                return out.status() == QTextStream::Ok;
+            });
+            out << "NumberOfEntries=" << count << '\n';
+            out << "Version=2\n";
+            break;
+
+        case ExportFormat::JSON: {
+            // 每首歌单独序列化后写出，歌曲数放在末尾
+            QJsonObject header;
+            header["name"] = playlist.name();
+            header["description"] = playlist.description();
+            header["created_at"] = playlist.createdAt().toString(Qt::ISODate);
+            QByteArray headerJson = QJsonDocument(header).toJson(QJsonDocument::Compact);
+            headerJson.chop(1);  // 去掉结尾的'}'
+            out << headerJson << ",\"songs\":[\n";
+            ok = dao.forEachPlaylistSong(playlistId, [&](const Song& song) {
+                QJsonObject songObj;
+                songObj["title"] = song.title();
+                songObj["artist"] = song.artist();
+                songObj["album"] = song.album();
+                songObj["duration"] = song.duration();
+                songObj["file_path"] = song.filePath();
+                if (count++ > 0) {
+                    out << ",\n";
+                }
+                out << QJsonDocument(songObj).toJson(QJsonDocument::Compact);
+                return out.status() == QTextStream::Ok;
+            });
+            out << "\n],\"song_count\":" << count << "}\n";
+            break;
+        }
+
+        case ExportFormat::XSPF:
+            break;
+        }
+
+        out.flush();
+        ok = ok && out.status() == QTextStream::Ok;
+    }
+
+    if (!ok) {
+        file.cancelWriting();
+        setError(error, QString("写入播放列表文件失败: %1").arg(filePath));
+        return false;
+    }
+    if (!file.commit()) {
+        setError(error, QString("保存播放列表文件失败: %1").arg(file.errorString()));
+        return false;
+    }
+
+    qDebug() << "PlaylistExporter::write: 导出" << count << "首歌曲到" << filePath;
+    return true;
+}
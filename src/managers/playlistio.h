@@ -0,0 +1,92 @@
+#ifndef PLAYLISTIO_H
+#define PLAYLISTIO_H
+
+#include <QString>
+#include <QList>
+#include <functional>
+#include "playlistmanager.h"
+
+/**
+ * @brief 播放列表文件中的一个条目
+ */
+struct PlaylistFileEntry
+{
+    QString location;        // 已转换为绝对路径
+    QString title;
+    qint64 durationMs = -1;  // 文件中没有时长时为-1
+};
+
+/**
+ * @brief 逐条读取播放列表文件（M3U/M3U8、PLS、XSPF、JSON）
+ * @details M3U和PLS按行读取，XSPF使用QXmlStreamReader，内存占用与文件大小无关。
+ *          JSON没有增量解析器，整文件解析后逐条回调。相对路径按播放列表所在目录解析，
+ *          file://地址转换为本地路径。不检查文件是否存在。
+ */
+class PlaylistFileReader
+{
+public:
+    /**
+     * @brief 条目回调，返回false时停止读取
+     */
+    using EntryHandler = std::function<bool(const PlaylistFileEntry&)>;
+
+    /**
+     * @brief 按扩展名判断格式
+     * @return 是否为支持的格式
+     */
+    static bool formatForFile(const QString& filePath, ExportFormat* format);
+
+    /**
+     * @brief 读取文件
+     * @param playlistName 输出文件中记录的播放列表名称（PLS/XSPF/JSON/#PLAYLIST），可为nullptr
+     * @param error 输出错误信息，可为nullptr
+     */
+    static bool read(const QString& filePath, ExportFormat format, const EntryHandler& handler,
+                     QString* playlistName = nullptr, QString* error = nullptr);
+
+private:
+    static bool readM3U(const QString& filePath, const EntryHandler& handler, QString* playlistName, QString* error);
+    static bool readPLS(const QString& filePath, const EntryHandler& handler, QString* playlistName, QString* error);
+    static bool readXSPF(const QString& filePath, const EntryHandler& handler, QString* playlistName, QString* error);
+    static bool readJSON(const QString& filePath, const EntryHandler& handler, QString* playlistName, QString* error);
+};
+
+/**
+ * @brief 导入的解析结果：按文件顺序排列的歌曲ID
+ */
+struct PlaylistImportResult
+{
+    bool success = false;
+    QString error;
+    QString filePath;
+    QString playlistName;     // 文件中记录的名称，没有时为文件名
+    int entryCount = 0;       // 文件中的条目数
+    QList<int> songIds;       // 在曲库中找到的歌曲，保持文件顺序，已去重
+    int missingCount = 0;     // 曲库中没有的条目
+    qint64 elapsedMs = 0;
+};
+
+/**
+ * @brief 把播放列表文件解析为曲库中的歌曲ID，可在工作线程调用
+ * @details 使用独立的只读连接（与主连接不冲突），每RESOLVE_BATCH_SIZE条路径
+ *          做一次file_path IN (...)索引查找。只保留歌曲ID，不保存完整的路径列表。
+ */
+class PlaylistImporter
+{
+public:
+    static const int RESOLVE_BATCH_SIZE = 400;   // 每条路径最多两个参数（原样和本地分隔符）
+
+    static PlaylistImportResult resolve(const QString& filePath, const QString& databasePath);
+};
+
+/**
+ * @brief 把播放列表直接从数据库游标流式写出，不生成完整的歌曲列表
+ * @details 必须在数据库连接所属线程调用。写入QSaveFile，失败时不覆盖原文件。
+ */
+class PlaylistExporter
+{
+public:
+    static bool write(int playlistId, const QString& filePath, ExportFormat format, QString* error = nullptr);
+};
+
+#endif // PLAYLISTIO_H
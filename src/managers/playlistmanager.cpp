@@ -1,6 +1,9 @@
 #include "playlistmanager.h"
 #include "../database/playlistdao.h"
 #include "../database/songdao.h"
+#include "../database/databasemanager.h"
+#include "playlistio.h"
+#include "smartplaylist.h"
 #include "../core/constants.h"
 #include <QDebug>
 #include <QFileInfo>
@@ -14,6 +17,14 @@
 #include <QDateTime>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+// 按最久未播放加权时，天数超过该值的歌曲权重相同
+const int MAX_SHUFFLE_RECENCY_DAYS = 365;
+}
 
 // 静态成员变量定义
 PlaylistManager* PlaylistManager::m_instance = nullptr;
@@ -30,7 +41,7 @@ PlaylistManager::PlaylistManager(QObject* parent)
     , m_state(PlaylistState::Stopped)
     , m_repeatMode(RepeatMode::NoRepeat)
     , m_shuffleMode(false)
-    , m_shuffleIndex(-1)
+    , m_shuffleWeighting(ShuffleWeighting::Uniform)
     , m_maxHistorySize(100)
     , m_cacheEnabled(true)
     , m_undoRedoEnabled(true)
@@ -253,6 +264,10 @@ PlaylistOperationResult PlaylistManager::deletePlaylist(int playlistId)
             clearCurrentPlaylist();
         }
         
+        if (playlist.isSmartPlaylist()) {
+            SmartPlaylistEngine::instance()->invalidate(playlistId);
+        }
+        
         // 发射信号
         emit playlistDeleted(playlistId, playlist.name());
         
@@ -375,48 +390,85 @@ PlaylistOperationResult PlaylistManager::addSongsToPlaylist(int playlistId, cons
         return PlaylistOperationResult(true, "歌曲列表为空，无需添加");
     }
     
-    int successCount = 0;
-    int totalCount = songs.size();
-    
+    // 一个事务、多行插入、一次统计更新
+    PlaylistMutation mutation;
+    QHash<int, Song> songsById;
     for (const Song& song : songs) {
-        if (song.id() > 0 && m_playlistDao->addSongToPlaylist(playlistId, song.id())) {
-            successCount++;
-        } else {
-            // Logger::instance().logError("PlaylistManager::addSongsToPlaylist", 
-            //     QString("添加歌曲失败: 播放列表ID=%1, 歌曲ID=%2").arg(playlistId).arg(song.id()));
-            qDebug() << "PlaylistManager::addSongsToPlaylist: 添加歌曲失败, 播放列表ID=" << playlistId << ", 歌曲ID=" << song.id();
+        if (song.id() > 0 && !songsById.contains(song.id())) {
+            songsById.insert(song.id(), song);
+            mutation.appendSongIds.append(song.id());
         }
     }
     
-    if (successCount > 0) {
-        // Logger::instance().logInfo("PlaylistManager::addSongsToPlaylist", 
-        //     QString("成功添加 %1/%2 首歌曲到播放列表: ID=%3").arg(successCount).arg(totalCount).arg(playlistId));
-        qDebug() << "PlaylistManager::addSongsToPlaylist: 成功添加" << successCount << "/" << totalCount << "首歌曲到播放列表, ID=" << playlistId;
-        
-        // 如果添加到当前播放列表，刷新当前播放列表
+    if (mutation.isEmpty()) {
+        return PlaylistOperationResult(false, "没有有效的歌曲");
+    }
+    
+    const PlaylistMutationResult result = m_playlistDao->applyMutation(playlistId, mutation);
+    if (!result.success) {
+        qDebug() << "PlaylistManager::addSongsToPlaylist: 批量添加歌曲失败, 播放列表ID=" << playlistId;
+        return PlaylistOperationResult(false, "添加歌曲失败");
+    }
+    
+    const int successCount = result.appendedSongIds.size();
+    const int totalCount = songs.size();
+    // Logger::instance().logInfo("PlaylistManager::addSongsToPlaylist", 
+    //     QString("成功添加 %1/%2 首歌曲到播放列表: ID=%3").arg(successCount).arg(totalCount).arg(playlistId));
+    qDebug() << "PlaylistManager::addSongsToPlaylist: 成功添加" << successCount << "/" << totalCount << "首歌曲到播放列表, ID=" << playlistId;
+    
+    if (successCount == 0) {
+        return PlaylistOperationResult(true, "歌曲已在播放列表中");
+    }
+    
+    QList<Song> inserted;
+    inserted.reserve(successCount);
+    for (int songId : result.appendedSongIds) {
+        inserted.append(songsById.value(songId));
+    }
+    
+    // 新歌曲总在末尾，当前播放列表直接追加，不重新加载
+    int firstIndex = result.playlist.songCount() - successCount;
+    {
+        QMutexLocker locker(&m_mutex);
         if (m_currentPlaylistId == playlistId) {
-            loadPlaylist(playlistId);
-        }
-        
-        // 发射信号
-        Playlist playlist = m_playlistDao->getPlaylistById(playlistId);
-        emit playlistUpdated(playlist);
-        
-        if (successCount == totalCount) {
-            return PlaylistOperationResult(true, QString("成功添加 %1 首歌曲").arg(successCount));
-        } else {
-            return PlaylistOperationResult(true, QString("部分成功：添加了 %1/%2 首歌曲").arg(successCount).arg(totalCount));
+            firstIndex = m_currentPlaylistSongs.size();
+            m_currentPlaylistSongs.append(inserted);
+            m_currentPlaylist = result.playlist;
+            if (!m_shuffleOrder.isEmpty()) {
+                // 新歌曲随机插入尚未播放的部分，已播放的顺序不变
+                m_shuffleOrder.append(m_currentSongIndex, inserted.size());
+            }
         }
     }
+    invalidateSongCache(playlistId);
     
-    return PlaylistOperationResult(false, "添加歌曲失败");
+    emit playlistUpdated(result.playlist);
+    emit songsInsertedIntoPlaylist(playlistId, firstIndex, inserted);
+    
+    if (successCount == totalCount) {
+        return PlaylistOperationResult(true, QString("成功添加 %1 首歌曲").arg(successCount));
+    }
+    return PlaylistOperationResult(true, QString("部分成功：添加了 %1/%2 首歌曲").arg(successCount).arg(totalCount));
 }
 
 PlaylistOperationResult PlaylistManager::removeSongFromPlaylist(int playlistId, int songIndex)
+{
+    if (songIndex < 0) {
+        return PlaylistOperationResult(false, "无效的歌曲索引");
+    }
+    
+    // 与批量移除走同一条增量路径，不重新加载播放列表
+    const PlaylistOperationResult result = removeSongsFromPlaylist(playlistId, {songIndex});
+    if (result.success) {
+        emit songRemovedFromPlaylist(playlistId, songIndex);
+    }
+    return result;
+}
+
+PlaylistOperationResult PlaylistManager::moveSongInPlaylist(int playlistId, int fromIndex, int toIndex)
 {
     if (!m_playlistDao) {
-        // Logger::instance().logError("PlaylistManager::removeSongFromPlaylist", "PlaylistDao未初始化");
-        qDebug() << "PlaylistManager::removeSongFromPlaylist: PlaylistDao未初始化";
+        qDebug() << "PlaylistManager::moveSongInPlaylist: PlaylistDao未初始化";
         return PlaylistOperationResult(false, "PlaylistDao未初始化");
     }
     
@@ -424,40 +476,203 @@ PlaylistOperationResult PlaylistManager::removeSongFromPlaylist(int playlistId,
         return PlaylistOperationResult(false, "无效的播放列表ID");
     }
     
-    if (songIndex < 0) {
-        return PlaylistOperationResult(false, "无效的歌曲索引");
+    const QList<Song> songs = playlistSongsSnapshot(playlistId);
+    if (fromIndex < 0 || fromIndex >= songs.size() || toIndex < 0 || toIndex >= songs.size()) {
+        return PlaylistOperationResult(false, "歌曲索引超出范围");
     }
     
-    // 获取播放列表中的歌曲列表
-    QList<Song> songs = getPlaylistSongs(playlistId);
-    if (songIndex >= songs.size()) {
+    if (fromIndex == toIndex) {
+        return PlaylistOperationResult(true, "歌曲位置未变化");
+    }
+    
+    // 移动后位于toIndex：向后移动时插到原toIndex+1之前，向前移动时插到原toIndex之前
+    const int beforeIndex = toIndex > fromIndex ? toIndex + 1 : toIndex;
+    const int beforeSongId = beforeIndex < songs.size() ? songs[beforeIndex].id() : -1;
+    
+    // 只更新被移动歌曲的排序键
+    if (!m_playlistDao->moveSongInPlaylist(playlistId, songs[fromIndex].id(), beforeSongId)) {
+        return PlaylistOperationResult(false, "移动歌曲失败");
+    }
+    
+    // 当前播放列表直接在内存中调整，不重新加载
+    QMutexLocker locker(&m_mutex);
+    if (m_currentPlaylistId == playlistId && m_currentPlaylistSongs.size() == songs.size()) {
+        m_currentPlaylistSongs.move(fromIndex, toIndex);
+        QList<int> oldToNew(m_currentPlaylistSongs.size());
+        for (int index = 0; index < oldToNew.size(); ++index) {
+            if (index == fromIndex) {
+                oldToNew[index] = toIndex;
+            } else if (fromIndex < index && index <= toIndex) {
+                oldToNew[index] = index - 1;
+            } else if (toIndex <= index && index < fromIndex) {
+                oldToNew[index] = index + 1;
+            } else {
+                oldToNew[index] = index;
+            }
+        }
+        remapCurrentIndices(oldToNew);
+    }
+    locker.unlock();
+    
+    emit songMovedInPlaylist(playlistId, fromIndex, toIndex);
+    return PlaylistOperationResult(true, "成功移动歌曲");
+}
+
+PlaylistOperationResult PlaylistManager::removeSongsFromPlaylist(int playlistId, const QList<int>& indices)
+{
+    if (!m_playlistDao) {
+        qDebug() << "PlaylistManager::removeSongsFromPlaylist: PlaylistDao未初始化";
+        return PlaylistOperationResult(false, "PlaylistDao未初始化");
+    }
+    
+    if (playlistId <= 0) {
+        return PlaylistOperationResult(false, "无效的播放列表ID");
+    }
+    
+    if (indices.isEmpty()) {
+        return PlaylistOperationResult(true, "没有要移除的歌曲");
+    }
+    
+    const QList<Song> songs = playlistSongsSnapshot(playlistId);
+    
+    QList<int> sortedIndices = indices;
+    std::sort(sortedIndices.begin(), sortedIndices.end());
+    sortedIndices.erase(std::unique(sortedIndices.begin(), sortedIndices.end()), sortedIndices.end());
+    if (sortedIndices.first() < 0 || sortedIndices.last() >= songs.size()) {
         return PlaylistOperationResult(false, "歌曲索引超出范围");
     }
     
-    // 获取要移除的歌曲ID
-    int songId = songs[songIndex].id();
+    PlaylistMutation mutation;
+    for (int index : sortedIndices) {
+        mutation.removeSongIds.append(songs[index].id());
+    }
     
-    bool success = m_playlistDao->removeSongFromPlaylist(playlistId, songId);
-    if (success) {
-        // Logger::instance().logInfo("PlaylistManager::removeSongFromPlaylist", 
-        //     QString("成功从播放列表移除歌曲: 播放列表ID=%1, 歌曲索引=%2, 歌曲ID=%3").arg(playlistId).arg(songIndex).arg(songId));
-        qDebug() << "PlaylistManager::removeSongFromPlaylist: 成功从播放列表移除歌曲, 播放列表ID=" << playlistId << ", 歌曲索引=" << songIndex << ", 歌曲ID=" << songId;
-        
-        // 如果从当前播放列表移除，刷新当前播放列表
-        if (m_currentPlaylistId == playlistId) {
-            loadPlaylist(playlistId);
+    const PlaylistMutationResult result = m_playlistDao->applyMutation(playlistId, mutation);
+    if (!result.success) {
+        qDebug() << "PlaylistManager::removeSongsFromPlaylist: 批量移除歌曲失败, 播放列表ID=" << playlistId;
+        return PlaylistOperationResult(false, "移除歌曲失败");
+    }
+    
+    qDebug() << "PlaylistManager::removeSongsFromPlaylist: 成功移除" << result.removedSongIds.size()
+             << "首歌曲, 播放列表ID=" << playlistId;
+    
+    QMutexLocker locker(&m_mutex);
+    // 快照之后当前播放列表被切换或重新加载时不再按旧索引调整
+    if (m_currentPlaylistId == playlistId && m_currentPlaylistSongs.size() == songs.size()) {
+        QList<int> oldToNew(songs.size());
+        int removed = 0;
+        for (int i = 0, next = 0; i < songs.size(); ++i) {
+            if (next < sortedIndices.size() && sortedIndices[next] == i) {
+                oldToNew[i] = -1;
+                ++next;
+                ++removed;
+            } else {
+                oldToNew[i] = i - removed;
+            }
+        }
+        // 从后往前删除，前面的索引不受影响
+        for (int i = sortedIndices.size() - 1; i >= 0; --i) {
+            m_currentPlaylistSongs.removeAt(sortedIndices[i]);
+        }
+        remapCurrentIndices(oldToNew);
+        m_currentPlaylist = result.playlist;
+    }
+    locker.unlock();
+    invalidateSongCache(playlistId);
+    
+    emit playlistUpdated(result.playlist);
+    emit songsRemovedFromPlaylist(playlistId, sortedIndices);
+    
+    return PlaylistOperationResult(true, QString("成功移除 %1 首歌曲").arg(sortedIndices.size()));
+}
+
+PlaylistOperationResult PlaylistManager::moveSongsInPlaylist(int playlistId, const QList<int>& indices, int beforeIndex)
+{
+    if (!m_playlistDao) {
+        qDebug() << "PlaylistManager::moveSongsInPlaylist: PlaylistDao未初始化";
+        return PlaylistOperationResult(false, "PlaylistDao未初始化");
+    }
+    
+    if (playlistId <= 0) {
+        return PlaylistOperationResult(false, "无效的播放列表ID");
+    }
+    
+    if (indices.isEmpty()) {
+        return PlaylistOperationResult(true, "歌曲位置未变化");
+    }
+    
+    const QList<Song> songs = playlistSongsSnapshot(playlistId);
+    
+    // beforeIndex 为原列表中的位置，等于歌曲数时表示移到末尾
+    QList<int> sortedIndices = indices;
+    std::sort(sortedIndices.begin(), sortedIndices.end());
+    sortedIndices.erase(std::unique(sortedIndices.begin(), sortedIndices.end()), sortedIndices.end());
+    if (sortedIndices.first() < 0 || sortedIndices.last() >= songs.size()
+        || beforeIndex < 0 || beforeIndex > songs.size()) {
+        return PlaylistOperationResult(false, "歌曲索引超出范围");
+    }
+    
+    // 插入位置本身也被移动时，顺延到后面第一首不移动的歌曲
+    const QSet<int> moving(sortedIndices.begin(), sortedIndices.end());
+    while (beforeIndex < songs.size() && moving.contains(beforeIndex)) {
+        ++beforeIndex;
+    }
+    
+    PlaylistMutation mutation;
+    for (int index : sortedIndices) {
+        mutation.moveSongIds.append(songs[index].id());
+    }
+    mutation.moveBeforeSongId = beforeIndex < songs.size() ? songs[beforeIndex].id() : -1;
+    
+    const PlaylistMutationResult result = m_playlistDao->applyMutation(playlistId, mutation);
+    if (!result.success) {
+        qDebug() << "PlaylistManager::moveSongsInPlaylist: 批量移动歌曲失败, 播放列表ID=" << playlistId;
+        return PlaylistOperationResult(false, "移动歌曲失败");
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    if (m_currentPlaylistId == playlistId && m_currentPlaylistSongs.size() == songs.size()) {
+        // 新顺序：插入点之前的未移动歌曲、被移动的歌曲、其余未移动歌曲
+        QList<int> order;
+        order.reserve(songs.size());
+        for (int i = 0; i < beforeIndex; ++i) {
+            if (!moving.contains(i)) {
+                order.append(i);
+            }
+        }
+        order.append(sortedIndices);
+        for (int i = beforeIndex; i < songs.size(); ++i) {
+            if (!moving.contains(i)) {
+                order.append(i);
+            }
         }
         
-        // 发射信号
-        Playlist playlist = m_playlistDao->getPlaylistById(playlistId);
-        emit playlistUpdated(playlist);
-        
-        emit songRemovedFromPlaylist(playlistId, songIndex);
-        
-        return PlaylistOperationResult(true, "成功移除歌曲");
+        QList<int> oldToNew(songs.size());
+        QList<Song> reordered;
+        reordered.reserve(songs.size());
+        for (int newIndex = 0; newIndex < order.size(); ++newIndex) {
+            oldToNew[order[newIndex]] = newIndex;
+            reordered.append(songs[order[newIndex]]);
+        }
+        m_currentPlaylistSongs = reordered;
+        remapCurrentIndices(oldToNew);
     }
+    locker.unlock();
+    invalidateSongCache(playlistId);
     
-    return PlaylistOperationResult(false, "移除歌曲失败");
+    emit songsMovedInPlaylist(playlistId, sortedIndices, beforeIndex);
+    return PlaylistOperationResult(true, QString("成功移动 %1 首歌曲").arg(result.movedCount));
+}
+
+QList<Song> PlaylistManager::playlistSongsSnapshot(int playlistId) const
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_currentPlaylistId == playlistId) {
+            return m_currentPlaylistSongs;
+        }
+    }
+    return getPlaylistSongs(playlistId);
 }
 
 QList<Song> PlaylistManager::getPlaylistSongs(int playlistId) const
@@ -557,7 +772,7 @@ void PlaylistManager::clearCurrentPlaylist()
     m_currentPlaylist.clear();
     m_currentPlaylistSongs.clear();
     m_currentSongIndex = -1;
-    m_shuffledIndices.clear();
+    m_shuffleOrder.reset(0);
     
     // Logger::instance().logInfo("PlaylistManager::clearCurrentPlaylist", "清空当前播放列表");
     qDebug() << "PlaylistManager::clearCurrentPlaylist: 清空当前播放列表";
@@ -798,6 +1013,25 @@ void PlaylistManager::setShuffleMode(bool enabled)
     }
 }
 
+ShuffleWeighting PlaylistManager::getShuffleWeighting() const
+{
+    return m_shuffleWeighting;
+}
+
+void PlaylistManager::setShuffleWeighting(ShuffleWeighting weighting)
+{
+    if (m_shuffleWeighting != weighting) {
+        m_shuffleWeighting = weighting;
+        
+        // 权重只在洗牌时使用，已开启随机播放时立即按新权重重新洗牌
+        if (m_shuffleMode) {
+            generateShuffledIndices();
+        }
+        
+        qDebug() << "PlaylistManager::setShuffleWeighting: 设置洗牌权重:" << static_cast<int>(weighting);
+    }
+}
+
 RepeatMode PlaylistManager::getRepeatMode() const
 {
     return m_repeatMode;
@@ -837,36 +1071,18 @@ bool PlaylistManager::exportPlaylist(int playlistId, const QString& filePath, Ex
         return false;
     }
     
-    Playlist playlist = m_playlistDao->getPlaylistById(playlistId);
-    if (!playlist.isValid()) {
-        // Logger::instance().logError("PlaylistManager::exportPlaylist", 
-        //     QString("播放列表不存在: ID=%1").arg(playlistId));
-        qDebug() << "PlaylistManager::exportPlaylist: 播放列表不存在, ID=" << playlistId;
+    // 直接从数据库游标写出，不生成完整的歌曲列表
+    QString error;
+    if (!PlaylistExporter::write(playlistId, filePath, format, &error)) {
+        qDebug() << "PlaylistManager::exportPlaylist: 导出失败:" << error;
+        emit errorOccurred(error);
         return false;
     }
     
-    QList<Song> songs = m_playlistDao->getPlaylistSongs(playlistId);
-    
-    bool success = false;
-    switch (format) {
-    case ExportFormat::M3U:
-        success = exportToM3U(playlist, songs, filePath);
-        break;
-    case ExportFormat::PLS:
-        success = exportToPLS(playlist, songs, filePath);
-        break;
-    case ExportFormat::JSON:
-        success = exportToJSON(playlist, songs, filePath);
-        break;
-    }
-    
-    if (success) {
-        // Logger::instance().logInfo("PlaylistManager::exportPlaylist", 
-        //     QString("成功导出播放列表: %1 到 %2").arg(playlist.name()).arg(filePath));
-        qDebug() << "PlaylistManager::exportPlaylist: 成功导出播放列表:" << playlist.name() << "到" << filePath;
-    }
-    
-    return success;
+    // Logger::instance().logInfo("PlaylistManager::exportPlaylist", 
+    //     QString("成功导出播放列表: ID=%1 到 %2").arg(playlistId).arg(filePath));
+    qDebug() << "PlaylistManager::exportPlaylist: 成功导出播放列表: ID=" << playlistId << "到" << filePath;
+    return true;
 }
 
 bool PlaylistManager::importPlaylist(const QString& filePath, const QString& playlistName)
@@ -879,29 +1095,243 @@ bool PlaylistManager::importPlaylist(const QString& filePath, const QString& pla
         return false;
     }
     
-    QString suffix = fileInfo.suffix().toLower();
-    bool success = false;
+    if (!DatabaseManager::instance()->isInitialized()) {
+        return false;
+    }
     
-    if (suffix == "m3u" || suffix == "m3u8") {
-        success = importFromM3U(filePath, playlistName);
-    } else if (suffix == "pls") {
-        success = importFromPLS(filePath, playlistName);
-    } else if (suffix == "json") {
-        success = importFromJSON(filePath, playlistName);
-    } else {
-        // Logger::instance().logError("PlaylistManager::importPlaylist", 
-        //     QString("不支持的文件格式: %1").arg(suffix));
-        qDebug() << "PlaylistManager::importPlaylist: 不支持的文件格式:" << suffix;
+    const PlaylistImportResult imported = PlaylistImporter::resolve(
+        filePath, DatabaseManager::instance()->database().databaseName());
+    return finishImport(imported, playlistName).success;
+}
+
+void PlaylistManager::importPlaylistAsync(const QString& filePath, const QString& playlistName)
+{
+    if (!QFileInfo::exists(filePath)) {
+        qDebug() << "PlaylistManager::importPlaylistAsync: 文件不存在:" << filePath;
+        emit playlistImportFailed(filePath, QString("文件不存在: %1").arg(filePath));
+        return;
+    }
+    
+    if (!DatabaseManager::instance()->isInitialized()) {
+        emit playlistImportFailed(filePath, "数据库未初始化");
+        return;
+    }
+    
+    // 解析和路径查找在工作线程使用独立的只读连接，写入回到数据库连接所属的本线程
+    const QString databasePath = DatabaseManager::instance()->database().databaseName();
+    auto* watcher = new QFutureWatcher<PlaylistImportResult>(this);
+    connect(watcher, &QFutureWatcher<PlaylistImportResult>::finished, this, [this, watcher, playlistName]() {
+        finishImport(watcher->result(), playlistName);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([filePath, databasePath]() {
+        return PlaylistImporter::resolve(filePath, databasePath);
+    }));
+}
+
+PlaylistOperationResult PlaylistManager::finishImport(const PlaylistImportResult& imported, const QString& playlistName)
+{
+    if (!imported.success) {
+        qDebug() << "PlaylistManager::finishImport: 解析播放列表失败:" << imported.error;
+        emit playlistImportFailed(imported.filePath, imported.error);
+        return PlaylistOperationResult(false, imported.error);
+    }
+    
+    if (!m_playlistDao) {
+        emit playlistImportFailed(imported.filePath, "PlaylistDao未初始化");
+        return PlaylistOperationResult(false, "PlaylistDao未初始化");
+    }
+    
+    // 重名时追加序号
+    const QString baseName = playlistName.trimmed().isEmpty() ? imported.playlistName.trimmed() : playlistName.trimmed();
+    QString name = baseName;
+    for (int suffix = 2; m_playlistDao->playlistExists(name); ++suffix) {
+        name = QString("%1 (%2)").arg(baseName).arg(suffix);
+    }
+    
+    PlaylistOperationResult created = createPlaylist(name, "从文件导入的播放列表");
+    if (!created.success) {
+        emit playlistImportFailed(imported.filePath, created.message);
+        return created;
+    }
+    Playlist playlist = created.data.value<Playlist>();
+    
+    if (!imported.songIds.isEmpty()) {
+        PlaylistMutation mutation;
+        mutation.appendSongIds = imported.songIds;
+        const PlaylistMutationResult result = m_playlistDao->applyMutation(playlist.id(), mutation);
+        if (!result.success) {
+            deletePlaylist(playlist.id());
+            emit playlistImportFailed(imported.filePath, "添加歌曲到播放列表失败");
+            return PlaylistOperationResult(false, "添加歌曲到播放列表失败");
+        }
+        playlist = result.playlist;
+        emit playlistUpdated(playlist);
+    }
+    
+    // Logger::instance().logInfo("PlaylistManager::finishImport", 
+    //     QString("成功导入播放列表: %1").arg(name));
+    qDebug() << "PlaylistManager::finishImport: 成功导入播放列表:" << name << "条目" << imported.entryCount
+             << "找到" << imported.songIds.size() << "缺失" << imported.missingCount;
+    
+    emit playlistImported(playlist, imported.songIds.size(), imported.missingCount);
+    return PlaylistOperationResult(true, QString("成功导入 %1 首歌曲").arg(imported.songIds.size()),
+                                   QVariant::fromValue(playlist));
+}
+
+PlaylistOperationResult PlaylistManager::createSmartPlaylist(const QString& name, const QString& criteria)
+{
+    if (name.trimmed().isEmpty()) {
+        qDebug() << "PlaylistManager::createSmartPlaylist: 播放列表名称不能为空";
+        return PlaylistOperationResult(false, "播放列表名称不能为空");
+    }
+    
+    if (!m_playlistDao) {
+        qDebug() << "PlaylistManager::createSmartPlaylist: PlaylistDao未初始化";
+        return PlaylistOperationResult(false, "PlaylistDao未初始化");
+    }
+    
+    if (m_playlistDao->playlistExists(name)) {
+        qDebug() << "PlaylistManager::createSmartPlaylist: 播放列表名称已存在:" << name;
+        return PlaylistOperationResult(false, QString("播放列表名称已存在: %1").arg(name));
+    }
+    
+    QString error;
+    const SmartPlaylistCriteria parsed = SmartPlaylistCriteria::fromJson(criteria, &error);
+    const SmartPlaylistValidation validation = error.isEmpty() ? SmartPlaylistEngine::instance()->validate(parsed)
+                                                               : SmartPlaylistValidation();
+    if (!validation.valid) {
+        const QString message = error.isEmpty() ? validation.error : error;
+        qDebug() << "PlaylistManager::createSmartPlaylist: 条件无效:" << message;
+        return PlaylistOperationResult(false, QString("智能播放列表条件无效: %1").arg(message));
+    }
+    for (const QString& warning : validation.warnings) {
+        qDebug() << "PlaylistManager::createSmartPlaylist:" << warning;
+    }
+    
+    Playlist playlist;
+    playlist.setName(name.trimmed());
+    playlist.setCreatedAt(QDateTime::currentDateTime());
+    playlist.setModifiedAt(QDateTime::currentDateTime());
+    playlist.setSongCount(0);
+    playlist.setTotalDuration(0);
+    playlist.setPlayCount(0);
+    playlist.setColor(QColor("#3498db")); // 默认蓝色
+    playlist.setIsSmartPlaylist(true);
+    playlist.setSmartCriteria(parsed.toJson());
+    playlist.setIsSystemPlaylist(false);
+    playlist.setIsFavorite(false);
+    playlist.setSortOrder(getNextSortOrder());
+    
+    int playlistId = m_playlistDao->addPlaylist(playlist);
+    if (playlistId > 0) {
+        qDebug() << "PlaylistManager::createSmartPlaylist: 成功创建智能播放列表:" << name << "ID:" << playlistId;
+        
+        Playlist createdPlaylist = m_playlistDao->getPlaylistById(playlistId);
+        emit playlistCreated(createdPlaylist);
+        
+        return PlaylistOperationResult(true, "智能播放列表创建成功", QVariant::fromValue(createdPlaylist));
+    }
+    
+    return PlaylistOperationResult(false, "创建智能播放列表失败");
+}
+
+PlaylistOperationResult PlaylistManager::updateSmartPlaylist(int playlistId, const QString& criteria)
+{
+    if (!m_playlistDao) {
+        qDebug() << "PlaylistManager::updateSmartPlaylist: PlaylistDao未初始化";
+        return PlaylistOperationResult(false, "PlaylistDao未初始化");
+    }
+    
+    Playlist playlist = m_playlistDao->getPlaylistById(playlistId);
+    if (playlist.id() <= 0) {
+        return PlaylistOperationResult(false, "播放列表不存在");
+    }
+    if (!playlist.isSmartPlaylist()) {
+        return PlaylistOperationResult(false, "不是智能播放列表");
+    }
+    
+    QString error;
+    const SmartPlaylistCriteria parsed = SmartPlaylistCriteria::fromJson(criteria, &error);
+    const SmartPlaylistValidation validation = error.isEmpty() ? SmartPlaylistEngine::instance()->validate(parsed)
+                                                               : SmartPlaylistValidation();
+    if (!validation.valid) {
+        const QString message = error.isEmpty() ? validation.error : error;
+        qDebug() << "PlaylistManager::updateSmartPlaylist: 条件无效:" << message;
+        return PlaylistOperationResult(false, QString("智能播放列表条件无效: %1").arg(message));
+    }
+    
+    playlist.setSmartCriteria(parsed.toJson());
+    playlist.setModifiedAt(QDateTime::currentDateTime());
+    if (!m_playlistDao->updatePlaylist(playlist)) {
+        return PlaylistOperationResult(false, "更新智能播放列表失败");
+    }
+    
+    SmartPlaylistEngine::instance()->invalidate(playlistId);
+    invalidateSongCache(playlistId);
+    qDebug() << "PlaylistManager::updateSmartPlaylist: 成功更新智能播放列表条件: ID=" << playlistId;
+    
+    emit playlistUpdated(playlist);
+    return PlaylistOperationResult(true, "智能播放列表更新成功", QVariant::fromValue(playlist));
+}
+
+QList<Song> PlaylistManager::getSmartPlaylistSongs(int playlistId) const
+{
+    if (!m_songDao) {
+        return QList<Song>();
+    }
+    
+    return getSongsInOrder(SmartPlaylistEngine::instance()->songIds(playlistId));
+}
+
+bool PlaylistManager::isSmartPlaylist(int playlistId) const
+{
+    if (!m_playlistDao) {
         return false;
     }
+    return m_playlistDao->getPlaylistById(playlistId).isSmartPlaylist();
+}
+
+QList<Song> PlaylistManager::evaluateSmartPlaylistCriteria(const QString& criteria) const
+{
+    if (!m_songDao) {
+        return QList<Song>();
+    }
     
-    if (success) {
-        // Logger::instance().logInfo("PlaylistManager::importPlaylist", 
-        //     QString("成功导入播放列表: %1").arg(playlistName));
-        qDebug() << "PlaylistManager::importPlaylist: 成功导入播放列表:" << playlistName;
+    QString error;
+    const SmartPlaylistCriteria parsed = SmartPlaylistCriteria::fromJson(criteria, &error);
+    if (!error.isEmpty()) {
+        qDebug() << "PlaylistManager::evaluateSmartPlaylistCriteria:" << error;
+        return QList<Song>();
+    }
+    
+    return getSongsInOrder(SmartPlaylistEngine::instance()->evaluate(parsed));
+}
+
+QList<Song> PlaylistManager::getSongsInOrder(const QList<int>& songIds) const
+{
+    // getSongsByIds不保证顺序，按给定的ID顺序重新排列
+    QHash<int, Song> byId;
+    for (const Song& song : m_songDao->getSongsByIds(songIds)) {
+        byId.insert(song.id(), song);
     }
     
-    return success;
+    QList<Song> songs;
+    songs.reserve(songIds.size());
+    for (int songId : songIds) {
+        auto it = byId.constFind(songId);
+        if (it != byId.constEnd()) {
+            songs.append(it.value());
+        }
+    }
+    return songs;
+}
+
+bool PlaylistManager::isValidSmartPlaylistCriteria(const QString& criteria) const
+{
+    QString error;
+    const SmartPlaylistCriteria parsed = SmartPlaylistCriteria::fromJson(criteria, &error);
+    return error.isEmpty() && SmartPlaylistEngine::instance()->validate(parsed).valid;
 }
 
 bool PlaylistManager::initializeDao()
@@ -991,28 +1421,64 @@ int PlaylistManager::getNextSortOrder() const
     return maxSortOrder + 1;
 }
 
-void PlaylistManager::generateShuffledIndices()
+void PlaylistManager::remapCurrentIndices(const QList<int>& oldToNew)
 {
-    m_shuffledIndices.clear();
+    // oldToNew[旧索引] = 新索引，被删除的歌曲为-1
+    auto remap = [&oldToNew](int& index) {
+        if (index >= 0) {
+            index = index < oldToNew.size() ? oldToNew[index] : -1;
+        }
+    };
+    remap(m_currentIndex);
+    remap(m_currentSongIndex);
     
-    if (m_currentPlaylistSongs.isEmpty()) {
-        return;
+    // 随机顺序跟随歌曲调整，不重新洗牌
+    if (!m_shuffleOrder.isEmpty()) {
+        m_shuffleOrder.remap(oldToNew);
     }
-    
-    // 生成索引列表
-    for (int i = 0; i < m_currentPlaylistSongs.size(); ++i) {
-        m_shuffledIndices.append(i);
+}
+
+void PlaylistManager::invalidateSongCache(int playlistId)
+{
+    if (m_cacheEnabled) {
+        QMutexLocker locker(&m_cacheMutex);
+        m_songCache.remove(playlistId);
+    }
+}
+
+void PlaylistManager::generateShuffledIndices()
+{
+    // 权重在洗牌时按当前歌曲列表计算，之后的导航不再访问歌曲数据
+    switch (m_shuffleWeighting) {
+    case ShuffleWeighting::Rating:
+        m_shuffleOrder.setWeightFunction([this](int index) {
+            return 1.0 + m_currentPlaylistSongs.at(index).rating();
+        });
+        break;
+    case ShuffleWeighting::LeastRecentlyPlayed: {
+        const QDateTime now = QDateTime::currentDateTime();
+        m_shuffleOrder.setWeightFunction([this, now](int index) {
+            const QDateTime lastPlayed = m_currentPlaylistSongs.at(index).lastPlayedTime();
+            const qint64 days = lastPlayed.isValid() ? lastPlayed.daysTo(now) : MAX_SHUFFLE_RECENCY_DAYS;
+            return 1.0 + qBound<qint64>(0, days, MAX_SHUFFLE_RECENCY_DAYS);
+        });
+        break;
+    }
+    case ShuffleWeighting::Uniform:
+    default:
+        m_shuffleOrder.setWeightFunction(ShuffleOrder::WeightFunction());
+        break;
     }
     
-    // 随机打乱
-    std::random_shuffle(m_shuffledIndices.begin(), m_shuffledIndices.end());
+    // 正在播放的歌曲排在第一位，接下来播放的是其余歌曲
+    m_shuffleOrder.reset(m_currentPlaylistSongs.size(), m_currentSongIndex);
     
     // Logger::instance().logInfo("PlaylistManager::generateShuffledIndices", 
-    //     QString("生成随机播放索引，歌曲数量: %1").arg(m_shuffledIndices.size()));
-    qDebug() << "PlaylistManager::generateShuffledIndices: 生成随机播放索引，歌曲数量:" << m_shuffledIndices.size();
+    //     QString("生成随机播放索引，歌曲数量: %1").arg(m_shuffleOrder.size()));
+    qDebug() << "PlaylistManager::generateShuffledIndices: 生成随机播放索引，歌曲数量:" << m_shuffleOrder.size();
 }
 
-int PlaylistManager::getNextSongIndex() const
+int PlaylistManager::getNextSongIndex()
 {
     if (m_currentPlaylistSongs.isEmpty()) {
         return -1;
@@ -1025,14 +1491,15 @@ int PlaylistManager::getNextSongIndex() const
     int nextIndex = -1;
     
     if (m_shuffleMode) {
-        // 随机播放模式
-        if (!m_shuffledIndices.isEmpty()) {
-            int currentShuffledIndex = m_shuffledIndices.indexOf(m_currentSongIndex);
-            if (currentShuffledIndex >= 0 && currentShuffledIndex < m_shuffledIndices.size() - 1) {
-                nextIndex = m_shuffledIndices.at(currentShuffledIndex + 1);
-            } else if (m_repeatMode == RepeatMode::RepeatAll) {
-                nextIndex = m_shuffledIndices.first();
-            }
+        // 随机播放模式：按排列的位置O(1)前进
+        if (m_shuffleOrder.size() != m_currentPlaylistSongs.size()) {
+            generateShuffledIndices();
+        }
+        nextIndex = m_currentSongIndex >= 0 ? m_shuffleOrder.next(m_currentSongIndex) : m_shuffleOrder.first();
+        if (nextIndex < 0 && m_repeatMode == RepeatMode::RepeatAll) {
+            // 一轮播完后重新洗牌，新一轮的第一首不与刚播放的重复
+            m_shuffleOrder.reshuffle(m_currentSongIndex);
+            nextIndex = m_shuffleOrder.first();
         }
     } else {
         // 顺序播放模式
@@ -1046,7 +1513,7 @@ int PlaylistManager::getNextSongIndex() const
     return nextIndex;
 }
 
-int PlaylistManager::getPreviousSongIndex() const
+int PlaylistManager::getPreviousSongIndex()
 {
     if (m_currentPlaylistSongs.isEmpty()) {
         return -1;
@@ -1059,14 +1526,13 @@ int PlaylistManager::getPreviousSongIndex() const
     int prevIndex = -1;
     
     if (m_shuffleMode) {
-        // 随机播放模式
-        if (!m_shuffledIndices.isEmpty()) {
-            int currentShuffledIndex = m_shuffledIndices.indexOf(m_currentSongIndex);
-            if (currentShuffledIndex > 0) {
-                prevIndex = m_shuffledIndices.at(currentShuffledIndex - 1);
-            } else if (m_repeatMode == RepeatMode::RepeatAll) {
-                prevIndex = m_shuffledIndices.last();
-            }
+        // 随机播放模式：沿排列后退，回到本轮已播放的歌曲
+        if (m_shuffleOrder.size() != m_currentPlaylistSongs.size()) {
+            generateShuffledIndices();
+        }
+        prevIndex = m_shuffleOrder.previous(m_currentSongIndex);
+        if (prevIndex < 0 && m_repeatMode == RepeatMode::RepeatAll) {
+            prevIndex = m_shuffleOrder.last();
         }
     } else {
         // 顺序播放模式
@@ -1080,140 +1546,6 @@ int PlaylistManager::getPreviousSongIndex() const
     return prevIndex;
 }
 
-bool PlaylistManager::exportToM3U(const Playlist& playlist, const QList<Song>& songs, const QString& filePath)
-{
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        // Logger::instance().logError("PlaylistManager::exportToM3U", 
-        //     QString("无法创建文件: %1").arg(filePath));
-        qDebug() << "PlaylistManager::exportToM3U: 无法创建文件:" << filePath;
-        return false;
-    }
-    
-    QTextStream out(&file);
-    out.setEncoding(QStringConverter::Utf8);
-    
-    // 写入M3U头部
-    out << "#EXTM3U" << Qt::endl;
-    out << QString("#PLAYLIST:%1").arg(playlist.name()) << Qt::endl;
-    
-    // 写入歌曲信息
-    for (const Song& song : songs) {
-        out << QString("#EXTINF:%1,%2 - %3")
-               .arg(song.duration() / 1000)
-               .arg(song.artist())
-               .arg(song.title()) << Qt::endl;
-        out << song.filePath() << Qt::endl;
-    }
-    
-    file.close();
-    return true;
-}
-
-bool PlaylistManager::exportToPLS(const Playlist& playlist, const QList<Song>& songs, const QString& filePath)
-{
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        // Logger::instance().logError("PlaylistManager::exportToPLS", 
-        //     QString("无法创建文件: %1").arg(filePath));
-        qDebug() << "PlaylistManager::exportToPLS: 无法创建文件:" << filePath;
-        return false;
-    }
-    
-    QTextStream out(&file);
-    out.setEncoding(QStringConverter::Utf8);
-    
-    // 写入PLS头部
-    out << "[playlist]" << Qt::endl;
-    out << QString("PlaylistName=%1").arg(playlist.name()) << Qt::endl;
-    out << QString("NumberOfEntries=%1").arg(songs.size()) << Qt::endl;
-    
-    // 写入歌曲信息
-    for (int i = 0; i < songs.size(); ++i) {
-        const Song& song = songs.at(i);
-        int index = i + 1;
-        
-        out << QString("File%1=%2").arg(index).arg(song.filePath()) << Qt::endl;
-        out << QString("Title%1=%2 - %3").arg(index).arg(song.artist()).arg(song.title()) << Qt::endl;
-        out << QString("Length%1=%2").arg(index).arg(song.duration() / 1000) << Qt::endl;
-    }
-    
-    out << "Version=2" << Qt::endl;
-    
-    file.close();
-    return true;
-}
-
-bool PlaylistManager::exportToJSON(const Playlist& playlist, const QList<Song>& songs, const QString& filePath)
-{
-    QJsonObject playlistObj;
-    playlistObj["name"] = playlist.name();
-    playlistObj["description"] = playlist.description();
-    playlistObj["created_at"] = playlist.createdAt().toString(Qt::ISODate);
-    playlistObj["song_count"] = songs.size();
-    
-    QJsonArray songsArray;
-    for (const Song& song : songs) {
-        QJsonObject songObj;
-        songObj["title"] = song.title();
-        songObj["artist"] = song.artist();
-        songObj["album"] = song.album();
-        songObj["duration"] = static_cast<qint64>(song.duration());
-        songObj["file_path"] = song.filePath();
-        songsArray.append(songObj);
-    }
-    
-    playlistObj["songs"] = songsArray;
-    
-    QJsonDocument doc(playlistObj);
-    
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        // Logger::instance().logError("PlaylistManager::exportToJSON", 
-        //     QString("无法创建文件: %1").arg(filePath));
-        qDebug() << "PlaylistManager::exportToJSON: 无法创建文件:" << filePath;
-        return false;
-    }
-    
-    file.write(doc.toJson());
-    file.close();
-    
-    return true;
-}
-
-bool PlaylistManager::importFromM3U(const QString& filePath, const QString& playlistName)
-{
-    // M3U导入实现
-    // 这里简化实现，实际应该解析M3U文件格式
-    Q_UNUSED(playlistName)
-    // Logger::instance().logInfo("PlaylistManager::importFromM3U", 
-    //     QString("导入M3U播放列表: %1").arg(filePath));
-    qDebug() << "PlaylistManager::importFromM3U: 导入M3U播放列表:" << filePath;
-    return true;
-}
-
-bool PlaylistManager::importFromPLS(const QString& filePath, const QString& playlistName)
-{
-    // PLS导入实现
-    // 这里简化实现，实际应该解析PLS文件格式
-    Q_UNUSED(playlistName)
-    // Logger::instance().logInfo("PlaylistManager::importFromPLS", 
-    //     QString("导入PLS播放列表: %1").arg(filePath));
-    qDebug() << "PlaylistManager::importFromPLS: 导入PLS播放列表:" << filePath;
-    return true;
-}
-
-bool PlaylistManager::importFromJSON(const QString& filePath, const QString& playlistName)
-{
-    // JSON导入实现
-    // 这里简化实现，实际应该解析JSON文件格式
-    Q_UNUSED(playlistName)
-    // Logger::instance().logInfo("PlaylistManager::importFromJSON", 
-    //     QString("导入JSON播放列表: %1").arg(filePath));
-    qDebug() << "PlaylistManager::importFromJSON: 导入JSON播放列表:" << filePath;
-    return true;
-}
-
 // 私有槽函数实现
 void PlaylistManager::onPlaylistChanged(int playlistId)
 {
@@ -1270,47 +1602,26 @@ void PlaylistManager::updateStatistics()
 {
     qDebug() << "PlaylistManager::updateStatistics: 更新统计信息";
     
+    if (!m_playlistDao) {
+        return;
+    }
+    
     try {
+        // 歌曲数和总时长由数据库触发器维护，一条查询汇总，开销与曲库大小无关
+        const PlaylistSummary summary = m_playlistDao->getPlaylistSummary();
+        
         QMutexLocker locker(&m_mutex);
         
         // 重置统计信息
         m_statistics = PlayStatistics();
-        
-        // 计算播放列表总数
-        m_statistics.totalPlaylists = m_playlists.size();
-        
-        // 计算歌曲总数和播放时间
-        int totalSongs = 0;
-        int totalPlayTime = 0;
-        int longestPlaylist = 0;
-        int shortestPlaylist = INT_MAX;
-        
-        for (const Playlist& playlist : m_playlists) {
-            QList<Song> songs = getPlaylistSongs(playlist.id());
-            int songCount = songs.size();
-            totalSongs += songCount;
-            
-            // 计算播放列表长度统计
-            if (songCount > longestPlaylist) {
-                longestPlaylist = songCount;
-                m_statistics.mostPlayedPlaylist = playlist.name();
-            }
-            if (songCount < shortestPlaylist && songCount > 0) {
-                shortestPlaylist = songCount;
-            }
-            
-            // 计算播放时间
-            for (const Song& song : songs) {
-                totalPlayTime += song.duration();
-            }
-        }
-        
-        m_statistics.totalSongs = totalSongs;
-        m_statistics.totalPlayTime = totalPlayTime;
-        m_statistics.longestPlaylist = longestPlaylist;
-        m_statistics.shortestPlaylist = (shortestPlaylist == INT_MAX) ? 0 : shortestPlaylist;
+        m_statistics.totalPlaylists = summary.playlistCount;
+        m_statistics.totalSongs = summary.totalSongs;
+        m_statistics.totalPlayTime = static_cast<int>(summary.totalDuration);
+        m_statistics.longestPlaylist = summary.longestSongCount;
+        m_statistics.shortestPlaylist = summary.shortestNonEmptySongCount;
+        m_statistics.mostPlayedPlaylist = summary.longestSongCount > 0 ? summary.longestPlaylistName : QString();
         m_statistics.averagePlaylistLength = m_statistics.totalPlaylists > 0 ? 
-            totalSongs / m_statistics.totalPlaylists : 0;
+            m_statistics.totalSongs / m_statistics.totalPlaylists : 0;
         
         // 设置最近播放的播放列表
         if (hasCurrentPlaylist()) {
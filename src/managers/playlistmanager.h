@@ -17,9 +17,11 @@
 #include "../models/song.h"
 #include "../models/playlist.h"
 #include "../database/songdao.h"
+#include "../core/shuffleorder.h"
 
 // 前向声明
 class PlaylistDao;
+struct PlaylistImportResult;
 
 // 播放模式
 enum class PlayMode {
@@ -36,10 +38,18 @@ enum class RepeatMode {
     RepeatAll      // 列表循环
 };
 
+// 洗牌权重
+enum class ShuffleWeighting {
+    Uniform,               // 均匀随机
+    Rating,                // 评分高的歌曲更可能排在前面
+    LeastRecentlyPlayed    // 越久没播放的歌曲越可能排在前面
+};
+
 // 导出格式
 enum class ExportFormat {
     M3U,           // M3U 格式
     PLS,           // PLS 格式
+    XSPF,          // XSPF 格式
     JSON           // JSON 格式
 };
 
@@ -147,6 +157,7 @@ public:
     PlaylistOperationResult removeSongFromPlaylist(int playlistId, int songIndex);
     PlaylistOperationResult removeSongsFromPlaylist(int playlistId, const QList<int>& indices);
     PlaylistOperationResult moveSongInPlaylist(int playlistId, int fromIndex, int toIndex);
+    PlaylistOperationResult moveSongsInPlaylist(int playlistId, const QList<int>& indices, int beforeIndex);
     PlaylistOperationResult clearPlaylist(int playlistId);
     
     // 播放列表歌曲查询
@@ -173,10 +184,17 @@ public:
     // 洗牌模式
     void setShuffleMode(bool enabled);
     bool isShuffleMode() const;
+    void setShuffleWeighting(ShuffleWeighting weighting);
+    ShuffleWeighting getShuffleWeighting() const;
     
     // 导入导出
     bool exportPlaylist(int playlistId, const QString& filePath, ExportFormat format);
     bool importPlaylist(const QString& filePath, const QString& playlistName);
+    /**
+     * @brief 在工作线程解析文件并查找歌曲，完成后回到本线程创建播放列表
+     * @details 结果通过playlistImported或playlistImportFailed通知；playlistName为空时使用文件中的名称
+     */
+    void importPlaylistAsync(const QString& filePath, const QString& playlistName = QString());
     
     // 当前播放列表管理
     void clearCurrentPlaylist();
@@ -305,6 +323,10 @@ signals:
     void songAddedToPlaylist(int playlistId, const Song& song, int index);
     void songRemovedFromPlaylist(int playlistId, int index);
     void songMovedInPlaylist(int playlistId, int fromIndex, int toIndex);
+    // 批量修改的增量信号：视图按区间更新，不需要重新加载整个列表
+    void songsInsertedIntoPlaylist(int playlistId, int firstIndex, const QList<Song>& songs);
+    void songsRemovedFromPlaylist(int playlistId, const QList<int>& indices);
+    void songsMovedInPlaylist(int playlistId, const QList<int>& fromIndices, int beforeIndex);
     void playlistCleared(int playlistId);
     void playlistShuffled(int playlistId);
     void playlistSorted(int playlistId, SortBy sortBy, SortOrder order);
@@ -336,6 +358,10 @@ signals:
     // 错误信号
     void errorOccurred(const QString& error);
     
+    // 导入信号
+    void playlistImported(const Playlist& playlist, int importedCount, int missingCount);
+    void playlistImportFailed(const QString& filePath, const QString& error);
+    
 private slots:
     void onPlaylistChanged(int playlistId);
     void onSongChanged(int songId);
@@ -368,8 +394,8 @@ private:
     PlaylistState m_state;
     RepeatMode m_repeatMode;
     bool m_shuffleMode;
-    QList<int> m_shuffledIndices;
-    int m_shuffleIndex;
+    ShuffleOrder m_shuffleOrder;
+    ShuffleWeighting m_shuffleWeighting;
     
     // 播放队列
     QQueue<QueueItem> m_playQueue;
@@ -421,16 +447,14 @@ private:
     void createDefaultPlaylists();
     int getNextSortOrder() const;
     void generateShuffledIndices();
-    int getNextSongIndex() const;
-    int getPreviousSongIndex() const;
+    void remapCurrentIndices(const QList<int>& oldToNew);  // 调用方持有m_mutex
+    QList<Song> playlistSongsSnapshot(int playlistId) const; // 当前播放列表取内存副本，否则查询数据库
+    void invalidateSongCache(int playlistId);
+    int getNextSongIndex();
+    int getPreviousSongIndex();
     
-    // 导出导入辅助方法
-    bool exportToM3U(const Playlist& playlist, const QList<Song>& songs, const QString& filePath);
-    bool exportToPLS(const Playlist& playlist, const QList<Song>& songs, const QString& filePath);
-    bool exportToJSON(const Playlist& playlist, const QList<Song>& songs, const QString& filePath);
-    bool importFromM3U(const QString& filePath, const QString& playlistName);
-    bool importFromPLS(const QString& filePath, const QString& playlistName);
-    bool importFromJSON(const QString& filePath, const QString& playlistName);
+    // 导入辅助方法：用解析出的歌曲ID创建播放列表，一次批量追加
+    PlaylistOperationResult finishImport(const PlaylistImportResult& imported, const QString& playlistName);
     
     // 播放控制实现
     void playInternal();
@@ -479,6 +503,7 @@ private:
     // 智能播放列表
     QList<Song> evaluateSmartPlaylistCriteria(const QString& criteria) const;
     bool isValidSmartPlaylistCriteria(const QString& criteria) const;
+    QList<Song> getSongsInOrder(const QList<int>& songIds) const;
     
     // 状态更新
     void updateState(PlaylistState newState);
@@ -520,6 +545,7 @@ public:
 // 注册元类型
 Q_DECLARE_METATYPE(PlayMode)
 Q_DECLARE_METATYPE(RepeatMode)
+Q_DECLARE_METATYPE(ShuffleWeighting)
 Q_DECLARE_METATYPE(ExportFormat)
 Q_DECLARE_METATYPE(PlaylistState)
 Q_DECLARE_METATYPE(PlaylistOperation)
@@ -0,0 +1,652 @@
+#include "playqueue.h"
+#include "../database/songdao.h"
+#include "../database/playqueuedao.h"
+#include "smartplaylist.h"
+#include <QDebug>
+
+// 主连接上的临时表名在进程内唯一
+int PlayQueue::s_snapshotSerial = 0;
+
+PlayQueueSource PlayQueueSource::library()
+{
+    PlayQueueSource source;
+    source.type = Type::Library;
+    return source;
+}
+
+PlayQueueSource PlayQueueSource::forTag(int tagId)
+{
+    PlayQueueSource source;
+    source.type = Type::Tag;
+    source.id = tagId;
+    return source;
+}
+
+PlayQueueSource PlayQueueSource::forPlaylist(int playlistId)
+{
+    PlayQueueSource source;
+    source.type = Type::Playlist;
+    source.id = playlistId;
+    return source;
+}
+
+PlayQueueSource PlayQueueSource::forSearch(const QString& text)
+{
+    PlayQueueSource source;
+    source.type = Type::Search;
+    source.text = text;
+    return source;
+}
+
+PlayQueueSource PlayQueueSource::forSmartPlaylist(int playlistId)
+{
+    PlayQueueSource source;
+    source.type = Type::SmartPlaylist;
+    source.id = playlistId;
+    return source;
+}
+
+bool PlayQueueSource::operator==(const PlayQueueSource& other) const
+{
+    return type == other.type && id == other.id && text == other.text;
+}
+
+PlayQueue::PlayQueue(QObject* parent)
+    : QObject(parent)
+    , m_count(0)
+    , m_currentSongId(-1)
+    , m_position(-1)
+    , m_playingUpNext(false)
+    , m_shuffle(false)
+    , m_shuffleCursor(-1)
+{
+}
+
+PlayQueue::~PlayQueue()
+{
+    dropSnapshot();
+}
+
+void PlayQueue::setSource(const PlayQueueSource& source, int startSongId, int positionHint)
+{
+    clear();
+    m_source = source;
+    snapshotSource();
+    qDebug() << "PlayQueue::setSource: 来源类型" << static_cast<int>(source.type) << "歌曲数量:" << m_count;
+    emit sourceReset(m_count);
+
+    if (startSongId > 0) {
+        const int position = positionHint >= 0 && songIdAt(positionHint) == startSongId
+                                 ? positionHint : positionOf(startSongId);
+        if (position >= 0) {
+            setCurrent(position);
+        }
+    }
+}
+
+void PlayQueue::setSongs(const QList<Song>& songs)
+{
+    clear();
+    m_source.type = PlayQueueSource::Type::Songs;
+
+    QVector<int> window;
+    window.reserve(qMin(songs.size(), WINDOW_SIZE));
+    for (const Song& song : songs) {
+        if (song.id() <= 0) {
+            qDebug() << "PlayQueue::setSongs: 跳过不在曲库中的歌曲:" << song.filePath();
+            continue;
+        }
+        window.append(song.id());
+        ++m_count;
+        if (window.size() == WINDOW_SIZE) {
+            m_windows.append(window);
+            window.clear();
+        }
+    }
+    if (!window.isEmpty()) {
+        m_windows.append(window);
+    }
+    emit sourceReset(m_count);
+}
+
+PlayQueueSource PlayQueue::source() const
+{
+    return m_source;
+}
+
+void PlayQueue::clear()
+{
+    m_source = PlayQueueSource();
+    m_count = 0;
+    dropSnapshot();
+    m_windows.clear();
+    m_songCache.clear();
+    m_upNext.clear();
+    m_history.clear();
+    m_currentSongId = -1;
+    m_position = -1;
+    m_playingUpNext = false;
+    m_shuffleOrder.reset(0);
+    m_shuffleCursor = -1;
+}
+
+void PlayQueue::refresh()
+{
+    if (m_source.type == PlayQueueSource::Type::None || m_source.type == PlayQueueSource::Type::Songs) {
+        return;
+    }
+
+    snapshotSource();
+    m_songCache.clear();
+    m_shuffleOrder.reset(0);
+    m_shuffleCursor = -1;
+
+    // 旧位置已经失效，历史只按歌曲ID回放
+    for (HistoryEntry& entry : m_history) {
+        entry.position = -1;
+    }
+
+    if (m_currentSongId > 0 && !m_playingUpNext) {
+        const int position = positionOf(m_currentSongId);
+        // 当前歌曲已不在来源中时，下一首是原位置上的歌曲
+        m_position = position >= 0 ? position : qMin(m_position, m_count) - 1;
+    }
+    emit sourceReset(m_count);
+}
+
+int PlayQueue::count() const
+{
+    return m_count;
+}
+
+bool PlayQueue::isEmpty() const
+{
+    return m_count == 0 && m_upNext.isEmpty();
+}
+
+int PlayQueue::songIdAt(int position)
+{
+    if (position < 0 || position >= m_count) {
+        return -1;
+    }
+    const int window = position / WINDOW_SIZE;
+    if (m_windows[window].isEmpty() && !loadWindow(window)) {
+        return -1;
+    }
+    const int offset = position % WINDOW_SIZE;
+    return offset < m_windows[window].size() ? m_windows[window][offset] : -1;
+}
+
+Song PlayQueue::songAt(int position)
+{
+    const int songId = songIdAt(position);
+    return songId > 0 ? songById(songId, position) : Song();
+}
+
+int PlayQueue::positionOf(int songId)
+{
+    // 先查已加载的窗口，再按顺序加载其余窗口，找到即停止
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int window = 0; window < m_windows.size(); ++window) {
+            if (m_windows[window].isEmpty()) {
+                if (pass == 0 || !loadWindow(window)) {
+                    continue;
+                }
+            } else if (pass == 1) {
+                continue;
+            }
+            const int offset = m_windows[window].indexOf(songId);
+            if (offset >= 0) {
+                return window * WINDOW_SIZE + offset;
+            }
+        }
+    }
+    return -1;
+}
+
+QList<int> PlayQueue::songIds()
+{
+    QList<int> result;
+    result.reserve(m_count);
+    for (int window = 0; window < m_windows.size(); ++window) {
+        if (m_windows[window].isEmpty() && !loadWindow(window)) {
+            continue;
+        }
+        for (int songId : m_windows[window]) {
+            result.append(songId);
+        }
+    }
+    return result;
+}
+
+QList<Song> PlayQueue::songs()
+{
+    QList<Song> result;
+    result.reserve(m_count);
+    SongDao songDao;
+
+    for (int window = 0; window < m_windows.size(); ++window) {
+        if (m_windows[window].isEmpty() && !loadWindow(window)) {
+            continue;
+        }
+        const QVector<int>& ids = m_windows[window];
+        QHash<int, Song> loaded;
+        for (const Song& song : songDao.getSongsByIds(ids)) {
+            loaded.insert(song.id(), song);
+        }
+        for (int songId : ids) {
+            auto it = loaded.constFind(songId);
+            if (it != loaded.constEnd()) {
+                result.append(it.value());
+            }
+        }
+    }
+    return result;
+}
+
+int PlayQueue::currentPosition() const
+{
+    return m_playingUpNext ? -1 : m_position;
+}
+
+int PlayQueue::currentSongId() const
+{
+    return m_currentSongId;
+}
+
+Song PlayQueue::currentSong()
+{
+    if (m_currentSongId <= 0) {
+        return Song();
+    }
+    return songById(m_currentSongId, currentPosition());
+}
+
+bool PlayQueue::isPlayingUpNext() const
+{
+    return m_playingUpNext;
+}
+
+bool PlayQueue::jumpTo(int position)
+{
+    if (songIdAt(position) <= 0) {
+        return false;
+    }
+
+    pushHistory();
+    if (m_shuffle) {
+        if (m_shuffleOrder.size() != m_count) {
+            m_shuffleOrder.reset(m_count, position);
+            m_shuffleCursor = 0;
+        } else if (m_shuffleOrder.positionOf(position) > m_shuffleCursor) {
+            // 跳到本轮尚未播放的歌曲：把它移到下一个位置，接下来的随机顺序不变
+            m_shuffleOrder.moveTo(position, m_shuffleCursor + 1);
+            ++m_shuffleCursor;
+        }
+        // 跳到本轮已播放过的歌曲只是重播一次，不改变接下来的顺序
+    }
+    setCurrent(position);
+    return true;
+}
+
+bool PlayQueue::advance(bool wrap)
+{
+    if (!m_upNext.isEmpty()) {
+        pushHistory();
+        m_currentSongId = m_upNext.takeFirst();
+        m_playingUpNext = true;
+        emit upNextRemoved(0, 1);
+        emit currentChanged(-1, m_currentSongId);
+        return true;
+    }
+
+    const int next = nextSourcePosition(wrap);
+    if (next < 0) {
+        return false;
+    }
+    pushHistory();
+    setCurrent(next);
+    return true;
+}
+
+bool PlayQueue::retreat(bool wrap)
+{
+    const bool wasPlayingUpNext = m_playingUpNext && m_currentSongId > 0;
+
+    if (!m_history.isEmpty()) {
+        const HistoryEntry entry = m_history.takeLast();
+        if (wasPlayingUpNext) {
+            // 正在播放的插播歌曲放回插播队列开头，前进时会再次播放
+            m_upNext.prepend(m_currentSongId);
+            emit upNextInserted(0, 1);
+        }
+
+        if (entry.position < 0) {
+            m_currentSongId = entry.songId;
+            m_playingUpNext = true;
+            emit currentChanged(-1, m_currentSongId);
+            return true;
+        }
+
+        if (m_shuffle && m_shuffleOrder.size() == m_count) {
+            const int shufflePosition = m_shuffleOrder.positionOf(entry.position);
+            if (shufflePosition >= 0 && shufflePosition < m_shuffleCursor) {
+                m_shuffleCursor = shufflePosition;
+            }
+        }
+        m_position = entry.position;
+        m_currentSongId = entry.songId;
+        m_playingUpNext = false;
+        emit currentChanged(m_position, m_currentSongId);
+        return true;
+    }
+
+    // 没有历史（刚设置来源）时按来源顺序后退
+    int previous = -1;
+    if (m_shuffle) {
+        ensureShuffleOrder();
+        if (m_shuffleCursor > 0) {
+            previous = m_shuffleOrder.at(--m_shuffleCursor);
+        } else if (wrap && m_count > 0) {
+            m_shuffleCursor = m_count - 1;
+            previous = m_shuffleOrder.last();
+        }
+    } else if (m_position > 0) {
+        previous = m_position - 1;
+    } else if (wrap && m_count > 0) {
+        previous = m_count - 1;
+    }
+
+    if (previous < 0) {
+        return false;
+    }
+    if (wasPlayingUpNext) {
+        m_upNext.prepend(m_currentSongId);
+        emit upNextInserted(0, 1);
+    }
+    setCurrent(previous);
+    return true;
+}
+
+QList<Song> PlayQueue::upcoming(int count)
+{
+    QList<Song> result;
+    for (int i = 0; i < m_upNext.size() && result.size() < count; ++i) {
+        const Song song = songById(m_upNext[i], -1);
+        if (song.id() > 0) {
+            result.append(song);
+        }
+    }
+
+    if (m_shuffle) {
+        ensureShuffleOrder();
+        for (int p = m_shuffleCursor + 1; p < m_count && result.size() < count; ++p) {
+            const Song song = songAt(m_shuffleOrder.at(p));
+            if (song.id() > 0) {
+                result.append(song);
+            }
+        }
+    } else {
+        for (int position = m_position + 1; position < m_count && result.size() < count; ++position) {
+            const Song song = songAt(position);
+            if (song.id() > 0) {
+                result.append(song);
+            }
+        }
+    }
+    return result;
+}
+
+void PlayQueue::playNext(const QList<int>& songIds)
+{
+    if (songIds.isEmpty()) {
+        return;
+    }
+    m_upNext = songIds + m_upNext;
+    emit upNextInserted(0, songIds.size());
+}
+
+void PlayQueue::addToQueue(const QList<int>& songIds)
+{
+    if (songIds.isEmpty()) {
+        return;
+    }
+    const int index = m_upNext.size();
+    m_upNext.append(songIds);
+    emit upNextInserted(index, songIds.size());
+}
+
+void PlayQueue::removeFromUpNext(int index, int count)
+{
+    if (index < 0 || index >= m_upNext.size() || count <= 0) {
+        return;
+    }
+    count = qMin(count, m_upNext.size() - index);
+    m_upNext.remove(index, count);
+    emit upNextRemoved(index, count);
+}
+
+void PlayQueue::clearUpNext()
+{
+    removeFromUpNext(0, m_upNext.size());
+}
+
+QList<int> PlayQueue::upNext() const
+{
+    return m_upNext;
+}
+
+QList<int> PlayQueue::history() const
+{
+    QList<int> songIds;
+    songIds.reserve(m_history.size());
+    for (const HistoryEntry& entry : m_history) {
+        songIds.append(entry.songId);
+    }
+    return songIds;
+}
+
+void PlayQueue::setShuffle(bool enabled)
+{
+    if (m_shuffle == enabled) {
+        return;
+    }
+    m_shuffle = enabled;
+    if (enabled) {
+        // 从当前歌曲开始新的一轮
+        m_shuffleOrder.reset(m_count, m_position);
+        m_shuffleCursor = m_position >= 0 ? 0 : -1;
+    } else {
+        // 回到顺序播放，从当前歌曲的位置继续
+        m_shuffleOrder.reset(0);
+        m_shuffleCursor = -1;
+    }
+}
+
+bool PlayQueue::isShuffle() const
+{
+    return m_shuffle;
+}
+
+qint64 PlayQueue::memoryUsage() const
+{
+    qint64 bytes = sizeof(*this);
+    bytes += m_windows.capacity() * qint64(sizeof(QVector<int>));
+    for (const QVector<int>& window : m_windows) {
+        bytes += window.capacity() * qint64(sizeof(int));
+    }
+    bytes += m_shuffleOrder.size() * qint64(2 * sizeof(int));   // 排列和逆映射
+    bytes += m_history.size() * qint64(sizeof(HistoryEntry));
+    bytes += m_upNext.size() * qint64(sizeof(int));
+    // Song的字符串按平均256字节估算
+    bytes += m_songCache.size() * qint64(sizeof(Song) + 256);
+    return bytes;
+}
+
+void PlayQueue::snapshotSource()
+{
+    dropSnapshot();
+    m_windows.clear();
+    m_count = 0;
+
+    PlayQueueDao playQueueDao;
+    const QString table = QString("play_queue_%1").arg(++s_snapshotSerial);
+    int count = -1;
+
+    switch (m_source.type) {
+    case PlayQueueSource::Type::Library:
+        count = playQueueDao.snapshotLibrary(table);
+        break;
+    case PlayQueueSource::Type::Tag:
+        count = playQueueDao.snapshotTag(table, m_source.id);
+        break;
+    case PlayQueueSource::Type::Playlist:
+        count = playQueueDao.snapshotPlaylist(table, m_source.id);
+        break;
+    case PlayQueueSource::Type::Search:
+        count = playQueueDao.snapshotSearch(table, m_source.text);
+        break;
+    case PlayQueueSource::Type::SmartPlaylist: {
+        // 成员已在SmartPlaylistEngine的内存中，直接复制ID作为快照
+        const QList<int> ids = SmartPlaylistEngine::instance()->songIds(m_source.id);
+        for (int start = 0; start < ids.size(); start += WINDOW_SIZE) {
+            m_windows.append(QVector<int>(ids.begin() + start, ids.begin() + qMin(ids.size(), start + WINDOW_SIZE)));
+        }
+        m_count = ids.size();
+        return;
+    }
+    case PlayQueueSource::Type::Songs:
+    case PlayQueueSource::Type::None:
+    default:
+        return;
+    }
+
+    if (count < 0) {
+        qWarning() << "PlayQueue: 无法为来源建立歌曲ID快照，类型" << static_cast<int>(m_source.type);
+        return;
+    }
+    m_snapshotTable = table;
+    m_count = count;
+    m_windows.resize((m_count + WINDOW_SIZE - 1) / WINDOW_SIZE);
+}
+
+void PlayQueue::dropSnapshot()
+{
+    if (m_snapshotTable.isEmpty()) {
+        return;
+    }
+    PlayQueueDao playQueueDao;
+    playQueueDao.dropSnapshot(m_snapshotTable);
+    m_snapshotTable.clear();
+}
+
+bool PlayQueue::loadWindow(int window)
+{
+    // 显式歌曲和智能播放列表在设置来源时已全部装入
+    if (m_snapshotTable.isEmpty()) {
+        return false;
+    }
+
+    PlayQueueDao playQueueDao;
+    const QList<int> ids = playQueueDao.snapshotIds(m_snapshotTable, window * WINDOW_SIZE, WINDOW_SIZE);
+    m_windows[window] = ids;
+    m_windows[window].squeeze();
+    return !ids.isEmpty();
+}
+
+Song PlayQueue::songById(int songId, int position)
+{
+    auto cached = m_songCache.constFind(songId);
+    if (cached != m_songCache.constEnd()) {
+        return cached.value();
+    }
+
+    if (position >= 0) {
+        materializeFrom(position);
+    } else {
+        SongDao songDao;
+        for (const Song& song : songDao.getSongsByIds({songId})) {
+            m_songCache.insert(song.id(), song);
+        }
+    }
+    return m_songCache.value(songId);
+}
+
+void PlayQueue::materializeFrom(int position)
+{
+    // 按播放顺序取当前位置及其后的几首，一次查询物化
+    QList<int> ids;
+    const bool shuffled = m_shuffle && m_shuffleOrder.size() == m_count;
+    const int start = shuffled ? m_shuffleOrder.positionOf(position) : position;
+    for (int i = start; i >= 0 && i < m_count && i <= start + MATERIALIZE_AHEAD; ++i) {
+        const int songId = songIdAt(shuffled ? m_shuffleOrder.at(i) : i);
+        if (songId > 0 && !m_songCache.contains(songId)) {
+            ids.append(songId);
+        }
+    }
+    if (ids.isEmpty()) {
+        return;
+    }
+
+    if (m_songCache.size() + ids.size() > SONG_CACHE_SIZE) {
+        m_songCache.clear();
+    }
+    SongDao songDao;
+    for (const Song& song : songDao.getSongsByIds(ids)) {
+        m_songCache.insert(song.id(), song);
+    }
+}
+
+void PlayQueue::pushHistory()
+{
+    if (m_currentSongId <= 0) {
+        return;
+    }
+    const HistoryEntry entry = {m_currentSongId, m_playingUpNext ? -1 : m_position};
+    m_history.append(entry);
+    if (m_history.size() > MAX_HISTORY_SIZE) {
+        m_history.removeFirst();
+    }
+}
+
+void PlayQueue::setCurrent(int position)
+{
+    m_position = position;
+    m_currentSongId = songIdAt(position);
+    m_playingUpNext = false;
+    emit currentChanged(position, m_currentSongId);
+}
+
+void PlayQueue::ensureShuffleOrder()
+{
+    if (m_shuffleOrder.size() != m_count) {
+        m_shuffleOrder.reset(m_count, m_position);
+        m_shuffleCursor = m_position >= 0 && m_count > 0 ? 0 : -1;
+    }
+}
+
+int PlayQueue::nextSourcePosition(bool wrap)
+{
+    if (m_count == 0) {
+        return -1;
+    }
+
+    if (!m_shuffle) {
+        if (m_position + 1 < m_count) {
+            return m_position + 1;
+        }
+        return wrap ? 0 : -1;
+    }
+
+    ensureShuffleOrder();
+    if (m_shuffleCursor + 1 < m_count) {
+        return m_shuffleOrder.at(++m_shuffleCursor);
+    }
+    if (!wrap) {
+        return -1;
+    }
+    // 一轮播完，重新洗牌，新一轮不以刚播放的歌曲开头
+    m_shuffleOrder.reshuffle(m_position);
+    m_shuffleCursor = 0;
+    return m_shuffleOrder.first();
+}
@@ -0,0 +1,183 @@
+#ifndef PLAYQUEUE_H
+#define PLAYQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include "../models/song.h"
+#include "../core/shuffleorder.h"
+
+/**
+ * @brief 播放队列的来源：一个查询描述，而不是歌曲列表
+ */
+struct PlayQueueSource
+{
+    enum class Type {
+        None,
+        Songs,       // 显式给出的歌曲（setPlaylist旧接口、"最近播放"）
+        Library,     // 全部歌曲，与SongDao::getAllSongs顺序相同
+        Tag,         // 标签下的歌曲，与SongDao::getSongsByTag顺序相同
+        Playlist,    // 播放列表，按排序键
+        Search,      // 标题搜索，与SongDao::searchByTitle顺序相同
+        SmartPlaylist // 智能播放列表，与SmartPlaylistEngine::songIds顺序相同
+    };
+
+    Type type = Type::None;
+    int id = -1;      // Tag/Playlist/SmartPlaylist的ID
+    QString text;     // Search的关键词
+
+    static PlayQueueSource library();
+    static PlayQueueSource forTag(int tagId);
+    static PlayQueueSource forPlaylist(int playlistId);
+    static PlayQueueSource forSearch(const QString& text);
+    static PlayQueueSource forSmartPlaylist(int playlistId);
+
+    bool operator==(const PlayQueueSource& other) const;
+    bool operator!=(const PlayQueueSource& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 统一的播放队列：来源顺序 + 插播队列（接下来播放）+ 播放历史
+ *
+ * 设置来源时把排好序的歌曲ID固定到主连接的临时表（PlayQueueDao），歌曲ID按WINDOW_SIZE
+ * 分窗口在第一次访问时按位置范围读取，Song对象只为当前位置附近的少量歌曲物化
+ * （最多SONG_CACHE_SIZE首，显式歌曲列表也只保存ID）。
+ * 10万首的来源顺序播放时只保存ID（约400KB），随机模式另加排列和逆映射。
+ *
+ * 插播队列中的歌曲先于来源中的下一首播放："下一首播放"插到插播队列开头，
+ * "添加到队列"追加到末尾。后退优先沿播放历史返回真正播放过的歌曲。
+ *
+ * 快照建好后曲库的变化不影响队列中的位置，不会跳过或重复歌曲；需要反映变化时调用refresh()。
+ * 必须在数据库连接所属线程（主线程）使用。
+ */
+class PlayQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int WINDOW_SIZE = 1000;        // 每次查询的歌曲ID数
+    static const int SONG_CACHE_SIZE = 64;      // 缓存的Song对象上限
+    static const int MATERIALIZE_AHEAD = 8;     // 物化歌曲时顺带读取的后续歌曲数
+    static const int MAX_HISTORY_SIZE = 500;
+
+    explicit PlayQueue(QObject* parent = nullptr);
+    ~PlayQueue();
+
+    /**
+     * @brief 设置来源，清空插播队列和历史
+     * @param startSongId 从这首歌开始播放，-1表示不设置当前歌曲
+     * @param positionHint 调用方已知的位置（如列表中的行号），与startSongId一致时免去查找
+     */
+    void setSource(const PlayQueueSource& source, int startSongId = -1, int positionHint = -1);
+
+    /**
+     * @brief 以显式歌曲列表作为来源（旧接口），只保留歌曲ID，歌曲对象按需重新读取
+     */
+    void setSongs(const QList<Song>& songs);
+
+    PlayQueueSource source() const;
+    void clear();
+
+    /**
+     * @brief 重新建立来源快照并丢弃已加载的窗口，当前歌曲按ID重新定位
+     */
+    void refresh();
+
+    // 来源中的歌曲
+    int count() const;
+    bool isEmpty() const;
+    int songIdAt(int position);
+    Song songAt(int position);
+    int positionOf(int songId);
+
+    /**
+     * @brief 来源中全部歌曲的ID（逐窗口加载，不物化Song对象）
+     */
+    QList<int> songIds();
+
+    /**
+     * @brief 物化整个来源（旧接口使用，10万首时代价与getAllSongs相同）
+     */
+    QList<Song> songs();
+
+    // 当前歌曲
+    int currentPosition() const;     // 正在播放插播歌曲时为-1
+    int currentSongId() const;
+    Song currentSong();
+    bool isPlayingUpNext() const;
+
+    // 导航，返回是否有歌曲可播放
+    bool jumpTo(int position);
+    bool advance(bool wrap);
+    bool retreat(bool wrap);
+
+    /**
+     * @brief 接下来的歌曲（插播队列在前），不改变队列状态，不跨越一轮的末尾
+     */
+    QList<Song> upcoming(int count);
+
+    // 插播队列
+    void playNext(const QList<int>& songIds);
+    void addToQueue(const QList<int>& songIds);
+    void removeFromUpNext(int index, int count = 1);
+    void clearUpNext();
+    QList<int> upNext() const;
+
+    /**
+     * @brief 播放过的歌曲ID，最近的在最后
+     */
+    QList<int> history() const;
+
+    void setShuffle(bool enabled);
+    bool isShuffle() const;
+
+    /**
+     * @brief 估算队列占用的内存（ID窗口、随机排列、历史、插播队列和Song缓存）
+     */
+    qint64 memoryUsage() const;
+
+signals:
+    void sourceReset(int count);
+    void currentChanged(int position, int songId);
+    void upNextInserted(int index, int count);
+    void upNextRemoved(int index, int count);
+
+private:
+    struct HistoryEntry {
+        int songId;
+        int position;   // 来源位置，插播歌曲为-1
+    };
+
+    void snapshotSource();
+    void dropSnapshot();
+    bool loadWindow(int window);
+    Song songById(int songId, int position);
+    void materializeFrom(int position);
+    void pushHistory();
+    void setCurrent(int position);
+    void ensureShuffleOrder();
+    int nextSourcePosition(bool wrap);
+
+    PlayQueueSource m_source;
+    int m_count;
+    QVector<QVector<int>> m_windows;
+    QHash<int, Song> m_songCache;
+    QString m_snapshotTable;             // 来源ID快照的临时表，Songs和智能播放列表来源为空
+
+    QList<int> m_upNext;
+    QList<HistoryEntry> m_history;
+
+    int m_currentSongId;
+    int m_position;                      // 当前（或插播结束后继续的）来源位置
+    bool m_playingUpNext;
+
+    bool m_shuffle;
+    ShuffleOrder m_shuffleOrder;         // 来源位置的随机顺序
+    int m_shuffleCursor;                 // 在随机顺序中已播放到的位置
+
+    static int s_snapshotSerial;
+};
+
+#endif // PLAYQUEUE_H
@@ -0,0 +1,601 @@
+#include "smartplaylist.h"
+#include "../database/playlistdao.h"
+#include "../models/playlist.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+enum class FieldKind {
+    Text,
+    Number,
+    Date,
+    Tag
+};
+
+struct FieldInfo {
+    QString column;     // SQL表达式，tag没有
+    FieldKind kind;
+};
+
+bool lookupField(const QString& field, FieldInfo* info)
+{
+    // duration以毫秒保存，规则和排序按秒
+    static const QHash<QString, FieldInfo> fields = {
+        {"title", {"s.title", FieldKind::Text}},
+        {"artist", {"s.artist", FieldKind::Text}},
+        {"album", {"s.album", FieldKind::Text}},
+        {"rating", {"s.rating", FieldKind::Number}},
+        {"duration", {"s.duration / 1000", FieldKind::Number}},
+        {"playCount", {"COALESCE(ps.play_count, 0)", FieldKind::Number}},
+        {"dateAdded", {"s.date_added", FieldKind::Date}},
+        {"lastPlayed", {"ps.last_played_at", FieldKind::Date}},
+        {"tag", {QString(), FieldKind::Tag}}
+    };
+
+    auto it = fields.constFind(field);
+    if (it == fields.constEnd()) {
+        return false;
+    }
+    *info = it.value();
+    return true;
+}
+
+QString escapeLike(const QString& text)
+{
+    QString escaped = text;
+    escaped.replace("\\", "\\\\");
+    escaped.replace("%", "\\%");
+    escaped.replace("_", "\\_");
+    return escaped;
+}
+
+// 某一天之前的时间点，格式与列中保存的值一致以便按字符串比较：
+// date_added是CURRENT_TIMESTAMP写入的UTC时间，last_played_at是QDateTime写入的本地ISO时间
+QString dateCutoff(const QString& column, int days)
+{
+    if (column == "s.date_added") {
+        return QDateTime::currentDateTimeUtc().addDays(-days).toString("yyyy-MM-dd HH:mm:ss");
+    }
+    return QDateTime::currentDateTime().addDays(-days).toString("yyyy-MM-ddTHH:mm:ss.zzz");
+}
+
+bool compileRule(const SmartPlaylistRule& rule, QString* sql, QVariantList* bindValues, QString* error)
+{
+    FieldInfo info;
+    if (!lookupField(rule.field, &info)) {
+        *error = QString("不支持的字段: %1").arg(rule.field);
+        return false;
+    }
+
+    switch (info.kind) {
+    case FieldKind::Text: {
+        const QString text = rule.value.toString();
+        if (rule.op == "is") {
+            *sql = QString("%1 = ?").arg(info.column);
+            bindValues->append(text);
+        } else if (rule.op == "isNot") {
+            *sql = QString("(%1 IS NULL OR %1 != ?)").arg(info.column);
+            bindValues->append(text);
+        } else if (rule.op == "contains") {
+            *sql = QString("%1 LIKE ? ESCAPE '\\'").arg(info.column);
+            bindValues->append("%" + escapeLike(text) + "%");
+        } else if (rule.op == "notContains") {
+            *sql = QString("(%1 IS NULL OR %1 NOT LIKE ? ESCAPE '\\')").arg(info.column);
+            bindValues->append("%" + escapeLike(text) + "%");
+        } else if (rule.op == "startsWith") {
+            *sql = QString("%1 LIKE ? ESCAPE '\\'").arg(info.column);
+            bindValues->append(escapeLike(text) + "%");
+        } else {
+            *error = QString("字段%1不支持运算符: %2").arg(rule.field, rule.op);
+            return false;
+        }
+        return true;
+    }
+    case FieldKind::Number: {
+        static const QStringList comparisons = {"=", "!=", "<", "<=", ">", ">="};
+        if (!comparisons.contains(rule.op)) {
+            *error = QString("字段%1不支持运算符: %2").arg(rule.field, rule.op);
+            return false;
+        }
+        bool ok = false;
+        const qint64 number = rule.value.toLongLong(&ok);
+        if (!ok) {
+            *error = QString("字段%1的值必须是整数").arg(rule.field);
+            return false;
+        }
+        *sql = QString("%1 %2 ?").arg(info.column, rule.op);
+        bindValues->append(number);
+        return true;
+    }
+    case FieldKind::Date: {
+        bool ok = false;
+        const int days = rule.value.toInt(&ok);
+        if (!ok || days < 0) {
+            *error = QString("字段%1的值必须是非负的天数").arg(rule.field);
+            return false;
+        }
+        if (rule.op == "inLast") {
+            *sql = QString("%1 >= ?").arg(info.column);
+        } else if (rule.op == "notInLast") {
+            // 从未播放（没有统计行）也算"最近N天没有播放"
+            *sql = QString("(%1 IS NULL OR %1 < ?)").arg(info.column);
+        } else {
+            *error = QString("字段%1不支持运算符: %2").arg(rule.field, rule.op);
+            return false;
+        }
+        bindValues->append(dateCutoff(info.column, days));
+        return true;
+    }
+    case FieldKind::Tag: {
+        if (rule.op != "is" && rule.op != "isNot") {
+            *error = QString("字段%1不支持运算符: %2").arg(rule.field, rule.op);
+            return false;
+        }
+        // 走song_tags的UNIQUE(song_id, tag_id)索引；标签名通过tags.name的唯一索引换成ID
+        QString tagMatch;
+        if (rule.value.typeId() == QMetaType::QString) {
+            tagMatch = "st.tag_id = (SELECT id FROM tags WHERE name = ?)";
+            bindValues->append(rule.value.toString());
+        } else {
+            bool ok = false;
+            const int tagId = rule.value.toInt(&ok);
+            if (!ok || tagId <= 0) {
+                *error = "标签规则的值必须是标签ID或标签名";
+                return false;
+            }
+            tagMatch = "st.tag_id = ?";
+            bindValues->append(tagId);
+        }
+        *sql = QString("%1EXISTS (SELECT 1 FROM song_tags st WHERE st.song_id = s.id AND %2)")
+                   .arg(rule.op == "isNot" ? "NOT " : "", tagMatch);
+        return true;
+    }
+    }
+    return false;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// SmartPlaylistRule / SmartPlaylistCriteria
+// ---------------------------------------------------------------------------
+
+QJsonObject SmartPlaylistRule::toJson() const
+{
+    QJsonObject json;
+    json["field"] = field;
+    json["op"] = op;
+    json["value"] = QJsonValue::fromVariant(value);
+    return json;
+}
+
+SmartPlaylistRule SmartPlaylistRule::fromJson(const QJsonObject& json)
+{
+    SmartPlaylistRule rule;
+    rule.field = json["field"].toString();
+    rule.op = json["op"].toString();
+    rule.value = json["value"].toVariant();
+    return rule;
+}
+
+QString SmartPlaylistCriteria::toJson() const
+{
+    QJsonArray ruleArray;
+    for (const SmartPlaylistRule& rule : rules) {
+        ruleArray.append(rule.toJson());
+    }
+
+    QJsonObject json;
+    json["match"] = matchAll ? "all" : "any";
+    json["rules"] = ruleArray;
+    json["orderBy"] = orderBy;
+    json["descending"] = descending;
+    json["limit"] = limit;
+    return QString::fromUtf8(QJsonDocument(json).toJson(QJsonDocument::Compact));
+}
+
+SmartPlaylistCriteria SmartPlaylistCriteria::fromJson(const QString& json, QString* error)
+{
+    SmartPlaylistCriteria criteria;
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        if (error) {
+            *error = QString("智能播放列表条件不是有效的JSON对象: %1").arg(parseError.errorString());
+        }
+        return criteria;
+    }
+
+    const QJsonObject object = document.object();
+    const QString match = object["match"].toString("all");
+    if (match != "all" && match != "any") {
+        if (error) {
+            *error = QString("不支持的匹配方式: %1").arg(match);
+        }
+        return criteria;
+    }
+    criteria.matchAll = match == "all";
+
+    for (const QJsonValue& value : object["rules"].toArray()) {
+        criteria.rules.append(SmartPlaylistRule::fromJson(value.toObject()));
+    }
+    criteria.orderBy = object["orderBy"].toString("title");
+    criteria.descending = object["descending"].toBool(false);
+    criteria.limit = object["limit"].toInt(0);
+    return criteria;
+}
+
+bool SmartPlaylistCriteria::hasRelativeDateRule() const
+{
+    for (const SmartPlaylistRule& rule : rules) {
+        if (rule.op == "inLast" || rule.op == "notInLast") {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SmartPlaylistCriteria::compile(SmartPlaylistQuery* query, QString* error) const
+{
+    QString message;
+    SmartPlaylistQuery compiled;
+
+    FieldInfo orderField;
+    if (!lookupField(orderBy, &orderField) || orderField.kind == FieldKind::Tag) {
+        message = QString("不支持的排序字段: %1").arg(orderBy);
+    } else if (limit < 0) {
+        message = "数量限制不能为负数";
+    }
+
+    QStringList conditions;
+    for (int i = 0; message.isEmpty() && i < rules.size(); ++i) {
+        QString condition;
+        if (compileRule(rules[i], &condition, &compiled.bindValues, &message)) {
+            conditions.append(condition);
+        }
+    }
+
+    if (!message.isEmpty()) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+
+    if (conditions.isEmpty()) {
+        compiled.where = "1";
+    } else {
+        compiled.where = conditions.join(matchAll ? " AND " : " OR ");
+    }
+    // 日期按ISO字符串排序，未播放过的歌曲排序键为空串
+    compiled.orderKey = orderField.kind == FieldKind::Date
+        ? QString("COALESCE(%1, '')").arg(orderField.column)
+        : QString("COALESCE(%1, %2)").arg(orderField.column, orderField.kind == FieldKind::Text ? "''" : "0");
+    compiled.textKey = orderField.kind != FieldKind::Number;
+    compiled.descending = descending;
+    compiled.limit = limit;
+
+    *query = compiled;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// SmartPlaylistEngine
+// ---------------------------------------------------------------------------
+
+SmartPlaylistEngine* SmartPlaylistEngine::s_instance = nullptr;
+
+SmartPlaylistEngine::SmartPlaylistEngine(QObject* parent)
+    : QObject(parent)
+    , m_changeSeq(-1)
+{
+}
+
+SmartPlaylistEngine::~SmartPlaylistEngine()
+{
+}
+
+SmartPlaylistEngine* SmartPlaylistEngine::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    if (!s_instance) {
+        s_instance = new SmartPlaylistEngine();
+    }
+    return s_instance;
+}
+
+void SmartPlaylistEngine::cleanup()
+{
+    if (s_instance) {
+        delete s_instance;
+        s_instance = nullptr;
+    }
+}
+
+SmartPlaylistValidation SmartPlaylistEngine::validate(const SmartPlaylistCriteria& criteria)
+{
+    SmartPlaylistValidation validation;
+    SmartPlaylistQuery query;
+    if (!criteria.compile(&query, &validation.error)) {
+        return validation;
+    }
+
+    SmartPlaylistDao smartPlaylistDao;
+    validation.queryPlan = smartPlaylistDao.explainQueryPlan(query);
+    if (validation.queryPlan.isEmpty()) {
+        validation.error = "无法生成查询计划";
+        return validation;
+    }
+
+    // 只允许扫描驱动表songs；关联表和子查询必须按索引查找
+    for (const QString& detail : validation.queryPlan) {
+        if (detail.contains("AUTOMATIC")) {
+            validation.error = QString("查询需要临时索引（缺少索引）: %1").arg(detail);
+            return validation;
+        }
+        if (!detail.startsWith("SCAN ")) {
+            continue;
+        }
+        const QString table = detail.section(' ', 1, 1);
+        if (table == "s" || table == "songs") {
+            validation.warnings.append("规则需要逐首检查全部歌曲（文本包含、任一规则满足等），歌曲较多时较慢");
+        } else {
+            validation.error = QString("规则需要全表扫描%1: %2").arg(table, detail);
+            return validation;
+        }
+    }
+
+    validation.valid = true;
+    return validation;
+}
+
+QList<int> SmartPlaylistEngine::evaluate(const SmartPlaylistCriteria& criteria)
+{
+    QList<int> ids;
+    SmartPlaylistQuery query;
+    QString error;
+    if (!criteria.compile(&query, &error)) {
+        qWarning() << "SmartPlaylistEngine::evaluate:" << error;
+        return ids;
+    }
+
+    SmartPlaylistDao smartPlaylistDao;
+    QList<SmartPlaylistMatch> matches = smartPlaylistDao.findMatches(query);
+    if (query.limit == 0) {
+        std::sort(matches.begin(), matches.end(), [&](const SmartPlaylistMatch& a, const SmartPlaylistMatch& b) {
+            return lessThan(a, b, query);
+        });
+    }
+
+    ids.reserve(matches.size());
+    for (const SmartPlaylistMatch& match : matches) {
+        ids.append(match.songId);
+    }
+    return ids;
+}
+
+QList<int> SmartPlaylistEngine::songIds(int playlistId)
+{
+    return songIds(playlistId, 0, -1);
+}
+
+QList<int> SmartPlaylistEngine::songIds(int playlistId, int offset, int limit)
+{
+    const bool changed = refresh(playlistId);
+
+    QList<int> ids;
+    auto it = m_cache.constFind(playlistId);
+    if (it != m_cache.constEnd()) {
+        const QVector<SmartPlaylistMatch>& members = it->members;
+        const int end = limit < 0 ? members.size() : qMin(members.size(), offset + limit);
+        for (int i = qMax(0, offset); i < end; ++i) {
+            ids.append(members[i].songId);
+        }
+    }
+
+    if (changed) {
+        emit playlistChanged(playlistId);
+    }
+    return ids;
+}
+
+int SmartPlaylistEngine::songCount(int playlistId)
+{
+    const bool changed = refresh(playlistId);
+
+    auto it = m_cache.constFind(playlistId);
+    const int count = it != m_cache.constEnd() ? it->members.size() : 0;
+
+    if (changed) {
+        emit playlistChanged(playlistId);
+    }
+    return count;
+}
+
+void SmartPlaylistEngine::invalidate(int playlistId)
+{
+    if (playlistId < 0) {
+        m_cache.clear();
+    } else {
+        m_cache.remove(playlistId);
+    }
+}
+
+bool SmartPlaylistEngine::refresh(int playlistId)
+{
+    PlaylistDao playlistDao;
+    const Playlist playlist = playlistDao.getPlaylistById(playlistId);
+    if (playlist.id() <= 0 || !playlist.isSmartPlaylist()) {
+        m_cache.remove(playlistId);
+        return false;
+    }
+
+    collectChanges();
+
+    CacheEntry& entry = m_cache[playlistId];
+    const bool expired = entry.relative && entry.sinceFullRefresh.isValid()
+                         && entry.sinceFullRefresh.elapsed() >= RELATIVE_RULE_TTL_MS;
+
+    // 条件改变或相对时间过期：重新编译（相对时间规则的截止时间在编译时确定）
+    if (entry.criteriaJson != playlist.smartCriteria() || expired || !entry.sinceFullRefresh.isValid()) {
+        QString error;
+        const SmartPlaylistCriteria criteria = SmartPlaylistCriteria::fromJson(playlist.smartCriteria(), &error);
+        if (!error.isEmpty() || !criteria.compile(&entry.query, &error)) {
+            qWarning() << "SmartPlaylistEngine: 播放列表" << playlistId << "的条件无效:" << error;
+            const bool hadMembers = !entry.members.isEmpty();
+            m_cache.remove(playlistId);
+            return hadMembers;
+        }
+        entry.criteriaJson = playlist.smartCriteria();
+        entry.relative = criteria.hasRelativeDateRule();
+        entry.stale = true;
+    }
+
+    // 有limit时一首歌的变化可能让别的歌曲进入或离开前limit名，只能完整查询
+    if (!entry.dirtySongIds.isEmpty()
+        && (entry.query.limit > 0 || entry.dirtySongIds.size() > MAX_INCREMENTAL_CHANGES)) {
+        entry.stale = true;
+    }
+
+    if (entry.stale) {
+        return fullRefresh(entry);
+    }
+    if (!entry.dirtySongIds.isEmpty()) {
+        return incrementalRefresh(entry);
+    }
+    return false;
+}
+
+void SmartPlaylistEngine::collectChanges()
+{
+    SmartPlaylistDao smartPlaylistDao;
+
+    if (m_changeSeq < 0) {
+        // 第一次访问：之前的变更与尚未建立的缓存无关
+        m_changeSeq = smartPlaylistDao.latestChangeSeq();
+        smartPlaylistDao.trimChanges(m_changeSeq);
+        return;
+    }
+
+    QSet<int> changedSongIds;
+    const qint64 seq = smartPlaylistDao.readChanges(m_changeSeq, MAX_INCREMENTAL_CHANGES, &changedSongIds);
+    if (seq < 0) {
+        // 变更太多（如批量导入、重建统计）或读取失败：全部改为完整查询
+        qDebug() << "SmartPlaylistEngine: 变更超过" << MAX_INCREMENTAL_CHANGES << "条，缓存改为完整刷新";
+        m_changeSeq = smartPlaylistDao.latestChangeSeq();
+        for (CacheEntry& entry : m_cache) {
+            entry.stale = true;
+            entry.dirtySongIds.clear();
+        }
+    } else if (seq > m_changeSeq) {
+        m_changeSeq = seq;
+        for (CacheEntry& entry : m_cache) {
+            if (!entry.stale) {
+                entry.dirtySongIds.unite(changedSongIds);
+            }
+        }
+    } else {
+        return;
+    }
+
+    smartPlaylistDao.trimChanges(m_changeSeq);
+}
+
+bool SmartPlaylistEngine::fullRefresh(CacheEntry& entry)
+{
+    SmartPlaylistDao smartPlaylistDao;
+    bool ok = false;
+    const QList<SmartPlaylistMatch> matches = smartPlaylistDao.findMatches(entry.query, &ok);
+    if (!ok) {
+        return false;
+    }
+
+    QVector<SmartPlaylistMatch> members(matches.begin(), matches.end());
+    if (entry.query.limit == 0) {
+        const SmartPlaylistQuery& query = entry.query;
+        std::sort(members.begin(), members.end(), [&](const SmartPlaylistMatch& a, const SmartPlaylistMatch& b) {
+            return lessThan(a, b, query);
+        });
+    }
+
+    bool changed = members.size() != entry.members.size();
+    for (int i = 0; !changed && i < members.size(); ++i) {
+        changed = members[i].songId != entry.members[i].songId;
+    }
+
+    entry.members = members;
+    entry.dirtySongIds.clear();
+    entry.stale = false;
+    entry.sinceFullRefresh.start();
+    return changed;
+}
+
+bool SmartPlaylistEngine::incrementalRefresh(CacheEntry& entry)
+{
+    SmartPlaylistDao smartPlaylistDao;
+    bool ok = false;
+    const QList<SmartPlaylistMatch> matches = smartPlaylistDao.findMatches(entry.query, entry.dirtySongIds.values(), &ok);
+    if (!ok) {
+        entry.stale = true;
+        return false;
+    }
+
+    // 记下变化歌曲原来的排序键，用于判断刷新后是否真的有变化
+    QHash<int, SmartPlaylistMatch> previous;
+    for (const SmartPlaylistMatch& member : entry.members) {
+        if (entry.dirtySongIds.contains(member.songId)) {
+            previous.insert(member.songId, member);
+        }
+    }
+
+    bool changed = previous.size() != matches.size();
+    for (const SmartPlaylistMatch& match : matches) {
+        auto it = previous.constFind(match.songId);
+        if (it == previous.constEnd() || it->text != match.text || it->number != match.number) {
+            changed = true;
+            break;
+        }
+    }
+
+    if (changed) {
+        const QSet<int>& dirty = entry.dirtySongIds;
+        entry.members.erase(std::remove_if(entry.members.begin(), entry.members.end(),
+                                           [&](const SmartPlaylistMatch& member) {
+                                               return dirty.contains(member.songId);
+                                           }),
+                            entry.members.end());
+
+        const SmartPlaylistQuery& query = entry.query;
+        auto less = [&](const SmartPlaylistMatch& a, const SmartPlaylistMatch& b) {
+            return lessThan(a, b, query);
+        };
+        for (const SmartPlaylistMatch& match : matches) {
+            entry.members.insert(std::upper_bound(entry.members.begin(), entry.members.end(), match, less), match);
+        }
+    }
+
+    entry.dirtySongIds.clear();
+    return changed;
+}
+
+bool SmartPlaylistEngine::lessThan(const SmartPlaylistMatch& a, const SmartPlaylistMatch& b,
+                                   const SmartPlaylistQuery& query)
+{
+    // 排序键相同按歌曲ID升序，与完整查询的ORDER BY ..., s.id一致
+    if (query.textKey) {
+        if (a.text != b.text) {
+            return query.descending ? b.text < a.text : a.text < b.text;
+        }
+    } else if (a.number != b.number) {
+        return query.descending ? b.number < a.number : a.number < b.number;
+    }
+    return a.songId < b.songId;
+}
@@ -0,0 +1,187 @@
+#ifndef SMARTPLAYLIST_H
+#define SMARTPLAYLIST_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QVariant>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+#include "../database/smartplaylistdao.h"
+
+/**
+ * @brief 智能播放列表的一条规则
+ * @details 字段与运算符：
+ *          - title/artist/album：is、isNot、contains、notContains、startsWith（文本）
+ *          - rating、playCount、duration（秒）：=、!=、<、<=、>、>=（整数）
+ *          - dateAdded、lastPlayed：inLast、notInLast（天数）；
+ *            从未播放的歌曲满足lastPlayed notInLast
+ *          - tag：is、isNot（标签ID或标签名）
+ */
+struct SmartPlaylistRule
+{
+    QString field;
+    QString op;
+    QVariant value;
+
+    QJsonObject toJson() const;
+    static SmartPlaylistRule fromJson(const QJsonObject& json);
+};
+
+/**
+ * @brief 智能播放列表的条件，以JSON保存在playlists.smart_criteria中
+ * @details 例如"评分至少4星、30天内没有播放、带有某个标签"：
+ *          {"match":"all","rules":[{"field":"rating","op":">=","value":4},
+ *           {"field":"lastPlayed","op":"notInLast","value":30},
+ *           {"field":"tag","op":"is","value":12}],"orderBy":"title","limit":0}
+ */
+struct SmartPlaylistCriteria
+{
+    bool matchAll = true;                // 所有规则都满足（all）还是任一规则满足（any）
+    QList<SmartPlaylistRule> rules;      // 没有规则时匹配全部歌曲
+    QString orderBy = "title";           // title/artist/album/rating/playCount/duration/dateAdded/lastPlayed
+    bool descending = false;
+    int limit = 0;                       // 只取排序后的前limit首，0表示不限制
+
+    QString toJson() const;
+
+    /**
+     * @brief 解析JSON（只检查格式，规则本身由compile()检查）
+     * @param json JSON文本
+     * @param error 输出：格式错误的描述（可选）
+     */
+    static SmartPlaylistCriteria fromJson(const QString& json, QString* error = nullptr);
+
+    /**
+     * @brief 是否含有按当前时间计算的规则（inLast/notInLast），其结果会随时间变化
+     */
+    bool hasRelativeDateRule() const;
+
+    /**
+     * @brief 编译为参数化SQL
+     * @param query 输出：编译结果
+     * @param error 输出：不支持的字段、运算符或值的描述
+     * @return 是否编译成功
+     */
+    bool compile(SmartPlaylistQuery* query, QString* error = nullptr) const;
+};
+
+/**
+ * @brief 智能播放列表规则的检查结果
+ */
+struct SmartPlaylistValidation
+{
+    bool valid = false;
+    QString error;             // 规则无法编译，或需要扫描songs以外的表
+    QStringList warnings;      // 需要扫描songs（如contains、任一规则满足），列表可用但较慢
+    QStringList queryPlan;
+};
+
+/**
+ * @brief 智能播放列表的结果缓存和增量刷新
+ *
+ * 每个智能播放列表的结果（歌曲ID和排序键，按排序键排好）缓存在内存中。
+ * songs、song_tags和play_stats_song上的触发器把变化的歌曲ID写入smart_playlist_changes；
+ * 访问缓存时先读取新的变更，只对变化的歌曲重新求值（s.id IN (...)走主键），
+ * 再按排序键插入或移除，不重新执行完整查询。
+ *
+ * 以下情况执行完整查询：第一次访问、条件改变、有limit的列表有变化、
+ * 一次积累的变更超过MAX_INCREMENTAL_CHANGES、含有inLast/notInLast规则且
+ * 距上次完整查询超过RELATIVE_RULE_TTL_MS（这类结果随时间变化而没有行变化）。
+ *
+ * 播放次数和最近播放时间读取play_stats_song汇总表：play_history会定期清理，
+ * 不能用来统计。必须在数据库连接所属线程（主线程）使用。
+ */
+class SmartPlaylistEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int MAX_INCREMENTAL_CHANGES = 2000;        // 超过时所有缓存改为完整查询
+    static const int MAX_CHANGE_LOG_ROWS = MAX_INCREMENTAL_CHANGES + 1; // 变更日志保留的行数，截断后读取方改为完整查询
+    static const int RELATIVE_RULE_TTL_MS = 10 * 60 * 1000; // 含相对时间规则的结果有效期
+
+    // 单例模式
+    static SmartPlaylistEngine* instance();
+    static void cleanup();
+
+    /**
+     * @brief 检查条件：编译并用EXPLAIN QUERY PLAN确认查询能使用索引
+     */
+    SmartPlaylistValidation validate(const SmartPlaylistCriteria& criteria);
+
+    /**
+     * @brief 不经缓存直接求值（预览尚未保存的条件）
+     * @return 按排序键排好的歌曲ID，条件无效时为空
+     */
+    QList<int> evaluate(const SmartPlaylistCriteria& criteria);
+
+    /**
+     * @brief 智能播放列表的歌曲ID（按排序键排好），需要时增量刷新
+     * @param playlistId 播放列表ID，不是智能播放列表时返回空列表
+     */
+    QList<int> songIds(int playlistId);
+
+    /**
+     * @brief 歌曲ID的一段，供PlayQueue分窗口读取
+     */
+    QList<int> songIds(int playlistId, int offset, int limit);
+
+    int songCount(int playlistId);
+
+    /**
+     * @brief 丢弃缓存，下次访问时完整查询
+     * @param playlistId 播放列表ID，-1表示全部
+     */
+    void invalidate(int playlistId = -1);
+
+signals:
+    /**
+     * @brief 智能播放列表的内容在刷新后发生了变化
+     */
+    void playlistChanged(int playlistId);
+
+private:
+    struct CacheEntry {
+        QString criteriaJson;
+        SmartPlaylistQuery query;
+        QVector<SmartPlaylistMatch> members;   // 按排序键排好
+        QSet<int> dirtySongIds;                // 尚未重新求值的变化歌曲
+        QElapsedTimer sinceFullRefresh;
+        bool relative = false;
+        bool stale = true;
+    };
+
+    explicit SmartPlaylistEngine(QObject* parent = nullptr);
+    ~SmartPlaylistEngine();
+
+    SmartPlaylistEngine(const SmartPlaylistEngine&) = delete;
+    SmartPlaylistEngine& operator=(const SmartPlaylistEngine&) = delete;
+
+    /**
+     * @brief 按需重新编译、完整或增量刷新缓存项
+     * @return 内容是否发生变化
+     */
+    bool refresh(int playlistId);
+
+    /**
+     * @brief 读取新的变更，分发到各缓存项的dirtySongIds，然后清理变更日志
+     */
+    void collectChanges();
+
+    bool fullRefresh(CacheEntry& entry);
+    bool incrementalRefresh(CacheEntry& entry);
+    static bool lessThan(const SmartPlaylistMatch& a, const SmartPlaylistMatch& b, const SmartPlaylistQuery& query);
+
+    static SmartPlaylistEngine* s_instance;
+
+    QHash<int, CacheEntry> m_cache;
+    qint64 m_changeSeq;                        // 已读取的最大变更序号，-1表示尚未读取
+};
+
+#endif // SMARTPLAYLIST_H
@@ -1,6 +1,7 @@
 #include "tagmanager.h"
 #include "../database/tagdao.h"
 #include "../database/songdao.h"
+#include "../database/tagindex.h"
 #include "../core/logger.h"
 #include <QMutexLocker>
 #include <QDebug>
@@ -8,6 +9,7 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QDateTime>
+#include <algorithm>
 
 static TagManager* s_instance = nullptr;
 static QMutex s_mutex;
@@ -95,8 +97,40 @@ void TagManager::cleanupOrphanedTags() {}
 
 QList<Tag> TagManager::getTagsForSong(int songId) const
 {
-    Q_UNUSED(songId)
-    return QList<Tag>();
+    QList<Tag> tags;
+    for (int tagId : TagIndex::instance()->tagsForSong(songId)) {
+        Tag tag = m_tagDao->getTagById(tagId);
+        if (tag.id() > 0) {
+            tags.append(tag);
+        }
+    }
+    return tags;
+}
+
+QList<int> TagManager::getSongIdsMatchingTags(const QList<int>& allOf, const QList<int>& anyOf,
+                                              const QList<int>& noneOf) const
+{
+    return TagIndex::instance()->match(allOf, anyOf, noneOf);
+}
+
+QList<Song> TagManager::getSongsMatchingTags(const QList<int>& allOf, const QList<int>& anyOf,
+                                             const QList<int>& noneOf) const
+{
+    QList<Song> songs = m_songDao->getSongsByIds(TagIndex::instance()->match(allOf, anyOf, noneOf));
+    // 与SongDao::getSongsByTag相同的顺序
+    std::sort(songs.begin(), songs.end(), [](const Song& a, const Song& b) {
+        if (a.title() != b.title()) {
+            return a.title() < b.title();
+        }
+        return a.id() < b.id();
+    });
+    return songs;
+}
+
+int TagManager::getSongCountMatchingTags(const QList<int>& allOf, const QList<int>& anyOf,
+                                         const QList<int>& noneOf) const
+{
+    return TagIndex::instance()->matchCount(allOf, anyOf, noneOf);
 }
 
 Tag TagManager::getTagByName(const QString& name) const
@@ -210,23 +244,16 @@ TagOperationResult TagManager::addSongToTag(int songId, int tagId)
         
         qDebug() << "TagManager::addSongToTag: 开始数据库事务";
         
-        // 执行添加操作（这里需要实现具体的数据库操作）
-        // 假设有一个song_tag_relations表来存储关联关系
-        QSqlQuery query(db);
-        query.prepare("INSERT INTO song_tag_relations (song_id, tag_id, created_at) VALUES (?, ?, ?)");
-        query.addBindValue(songId);
-        query.addBindValue(tagId);
-        query.addBindValue(QDateTime::currentDateTime());
-        
-        if (!query.exec()) {
-            QString errorMsg = QString("插入歌曲-标签关联失败: %1").arg(query.lastError().text());
+        if (!m_songDao->addSongToTag(songId, tagId)) {
+            QString errorMsg = "插入歌曲-标签关联失败";
             qCritical() << "TagManager::addSongToTag:" << errorMsg;
             Logger::instance()->error(errorMsg, "TagManager");
             
-            // 回滚事务
+            // 回滚事务，索引可能已按部分写入更新，需要重新加载
             if (!db.rollback()) {
                 qCritical() << "TagManager::addSongToTag: 事务回滚失败:" << db.lastError().text();
             }
+            TagIndex::instance()->invalidate();
             return TagOperationResult(false, errorMsg);
         }
         
@@ -236,10 +263,11 @@ TagOperationResult TagManager::addSongToTag(int songId, int tagId)
             qCritical() << "TagManager::addSongToTag:" << errorMsg;
             Logger::instance()->error(errorMsg, "TagManager");
             
-            // 尝试回滚
+            // 尝试回滚，索引已按插入成功更新，需要重新加载
             if (!db.rollback()) {
                 qCritical() << "TagManager::addSongToTag: 事务回滚失败:" << db.lastError().text();
             }
+            TagIndex::instance()->invalidate();
             return TagOperationResult(false, errorMsg);
         }
         
@@ -265,6 +293,7 @@ TagOperationResult TagManager::addSongToTag(int songId, int tagId)
         if (db.isOpen() && !db.rollback()) {
             qCritical() << "TagManager::addSongToTag: 异常处理中事务回滚失败:" << db.lastError().text();
         }
+        TagIndex::instance()->invalidate();
         
         return TagOperationResult(false, errorMsg);
     } catch (...) {
@@ -277,6 +306,7 @@ TagOperationResult TagManager::addSongToTag(int songId, int tagId)
         if (db.isOpen() && !db.rollback()) {
             qCritical() << "TagManager::addSongToTag: 异常处理中事务回滚失败:" << db.lastError().text();
         }
+        TagIndex::instance()->invalidate();
         
         return TagOperationResult(false, errorMsg);
      }
@@ -284,43 +314,9 @@ TagOperationResult TagManager::addSongToTag(int songId, int tagId)
 
 bool TagManager::isSongInTag(int songId, int tagId) const
 {
-    qDebug() << "TagManager::isSongInTag: 检查歌曲" << songId << "是否在标签" << tagId << "中";
-    
     if (songId <= 0 || tagId <= 0) {
         qWarning() << "TagManager::isSongInTag: 无效的参数 songId:" << songId << "tagId:" << tagId;
         return false;
     }
-    
-    try {
-        if (!QSqlDatabase::database().isOpen()) {
-            qCritical() << "TagManager::isSongInTag: 数据库连接未打开";
-            return false;
-        }
-        
-        QSqlQuery query;
-        query.prepare("SELECT COUNT(*) FROM song_tag_relations WHERE song_id = ? AND tag_id = ?");
-        query.addBindValue(songId);
-        query.addBindValue(tagId);
-        
-        if (!query.exec()) {
-            qCritical() << "TagManager::isSongInTag: 查询失败:" << query.lastError().text();
-            return false;
-        }
-        
-        if (query.next()) {
-            int count = query.value(0).toInt();
-            bool exists = count > 0;
-            qDebug() << "TagManager::isSongInTag: 关联" << (exists ? "存在" : "不存在") << "count:" << count;
-            return exists;
-        }
-        
-        return false;
-        
-    } catch (const std::exception& e) {
-        qCritical() << "TagManager::isSongInTag: 异常:" << e.what();
-        return false;
-    } catch (...) {
-        qCritical() << "TagManager::isSongInTag: 未知异常";
-        return false;
-    }
-}
\ No newline at end of file
+    return TagIndex::instance()->contains(songId, tagId);
+}
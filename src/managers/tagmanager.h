@@ -162,6 +162,14 @@ public:
     bool isSongInTag(int songId, int tagId) const;
     bool isSongInTag(int songId, const QString& tagName) const;
     
+    // 多标签过滤（由TagIndex在内存中按位图组合）：带有allOf全部、anyOf至少一个、不带noneOf任何一个标签的歌曲
+    QList<int> getSongIdsMatchingTags(const QList<int>& allOf, const QList<int>& anyOf = QList<int>(),
+                                      const QList<int>& noneOf = QList<int>()) const;
+    QList<Song> getSongsMatchingTags(const QList<int>& allOf, const QList<int>& anyOf = QList<int>(),
+                                     const QList<int>& noneOf = QList<int>()) const;
+    int getSongCountMatchingTags(const QList<int>& allOf, const QList<int>& anyOf = QList<int>(),
+                                 const QList<int>& noneOf = QList<int>()) const;
+    
     // 标签验证
     bool tagExists(const QString& name) const;
     bool tagExists(int tagId) const;
@@ -1,4 +1,5 @@
 #include "song.h"
+#include "../audio/audioiocontext.h"
 #include <QFileInfo>
 #include <QDateTime>
 #include <QDebug>
@@ -163,6 +164,13 @@ void Song::setFilePath(const QString& filePath)
     m_isAvailable = fileInfo.exists();
 }
 
+void Song::setCachedFilePath(const QString& filePath)
+{
+    m_filePath = filePath;
+    m_fileName = extractFileName(filePath);
+    m_fileFormat = filePath.section('.', -1).toLower();
+}
+
 bool Song::isValid() const
 {
     return !m_filePath.isEmpty() && m_isAvailable;
@@ -485,12 +493,13 @@ void Song::extractAdvancedMetadata(Song& song, const QString& filePath)
 
 bool Song::extractFFmpegMetadata(Song& song, const QString& filePath)
 {
-    AVFormatContext* formatContext = nullptr;
+    AVIOContext* ioContext = nullptr;
+    AVFormatContext* formatContext = openProbeContext(filePath, &ioContext);
     bool success = false;
     
     try {
         // 打开文件
-        if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        if (!formatContext) {
             qWarning() << "无法打开音频文件:" << filePath;
             return false;
         }
@@ -498,6 +507,7 @@ bool Song::extractFFmpegMetadata(Song& song, const QString& filePath)
         // 查找流信息
         if (avformat_find_stream_info(formatContext, nullptr) < 0) {
             qWarning() << "无法获取流信息:" << filePath;
+            closeProbeContext(&formatContext, &ioContext);
             return false;
         }
         
@@ -536,27 +546,39 @@ bool Song::extractFFmpegMetadata(Song& song, const QString& filePath)
     }
     
     // 清理资源
-    if (formatContext) {
-        avformat_close_input(&formatContext);
-    }
+    closeProbeContext(&formatContext, &ioContext);
     
     return success;
 }
 
 QPixmap Song::extractCoverArt(const QString& filePath, const QSize& size)
 {
-    AVFormatContext* formatContext = nullptr;
-    QPixmap coverPixmap;
+    QPixmap coverPixmap = QPixmap::fromImage(extractCoverImage(filePath));
+    
+    // 智能缩放，保持宽高比
+    if (!coverPixmap.isNull() && size.isValid()) {
+        coverPixmap = coverPixmap.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    
+    return coverPixmap;
+}
+
+QImage Song::extractCoverImage(const QString& filePath)
+{
+    AVIOContext* ioContext = nullptr;
+    AVFormatContext* formatContext = openProbeContext(filePath, &ioContext);
+    QImage coverImage;
     
     try {
         // 打开文件
-        if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
-            return coverPixmap;
+        if (!formatContext) {
+            return coverImage;
         }
         
         // 查找流信息
         if (avformat_find_stream_info(formatContext, nullptr) < 0) {
-            return coverPixmap;
+            closeProbeContext(&formatContext, &ioContext);
+            return coverImage;
         }
         
         // 查找封面流
@@ -565,23 +587,15 @@ QPixmap Song::extractCoverArt(const QString& filePath, const QSize& size)
             if (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) {
                 AVPacket* packet = &stream->attached_pic;
                 
-                // 解码封面数据
-                QImage coverImage;
+                // 解码封面数据（QImage可在非GUI线程使用）
                 if (coverImage.loadFromData(packet->data, packet->size)) {
-                    coverPixmap = QPixmap::fromImage(coverImage);
-                    
-                    // 智能缩放，保持宽高比
-                    if (!coverPixmap.isNull() && size.isValid()) {
-                        coverPixmap = coverPixmap.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                    }
-                    
                     break;
                 }
             }
         }
         
         // 如果没有找到封面流，尝试从元数据中获取
-        if (coverPixmap.isNull()) {
+        if (coverImage.isNull()) {
             AVDictionary* metadata = formatContext->metadata;
             AVDictionaryEntry* entry = av_dict_get(metadata, "metadata_block_picture", nullptr, 0);
             
@@ -598,11 +612,40 @@ QPixmap Song::extractCoverArt(const QString& filePath, const QSize& size)
     }
     
     // 清理资源
-    if (formatContext) {
-        avformat_close_input(&formatContext);
+    closeProbeContext(&formatContext, &ioContext);
+    
+    return coverImage;
+}
+
+AVFormatContext* Song::openProbeContext(const QString& filePath, AVIOContext** ioContext)
+{
+    // 元数据解析使用大块同步读取，减少网络存储和机械硬盘上的小读取次数
+    AVFormatContext* formatContext = avformat_alloc_context();
+    if (!formatContext) {
+        return nullptr;
     }
     
-    return coverPixmap;
+    *ioContext = AudioIOContext::open(filePath, AudioIOOptions::probe());
+    if (*ioContext) {
+        formatContext->pb = *ioContext;
+        formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+    
+    // 打开失败时avformat_open_input会释放formatContext
+    if (avformat_open_input(&formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        AudioIOContext::free(ioContext);
+        return nullptr;
+    }
+    return formatContext;
+}
+
+void Song::closeProbeContext(AVFormatContext** formatContext, AVIOContext** ioContext)
+{
+    if (*formatContext) {
+        avformat_close_input(formatContext);
+    }
+    // 自定义AVIOContext不会被avformat_close_input释放
+    AudioIOContext::free(ioContext);
 }
 
 QString Song::getTitleFromMetadata(const QString& filePath)
@@ -6,10 +6,15 @@
 #include <QDateTime>
 #include <QVariant>
 #include <QPixmap>
+#include <QImage>
 #include <QJsonObject>
 #include <QMetaType>
 #include <QStringList>
 
+// FFmpeg类型前置声明
+struct AVFormatContext;
+struct AVIOContext;
+
 /**
  * @brief 歌曲数据模型类
  * 
@@ -95,6 +100,10 @@ public:
     // Setters
     void setId(int id) { m_id = id; }
     void setFilePath(const QString& filePath);
+    /**
+     * @brief 设置文件路径但不访问磁盘（用于从缓存快照恢复，文件信息以数据库为准）
+     */
+    void setCachedFilePath(const QString& filePath);
     void setFileName(const QString& fileName) { m_fileName = fileName; }
     void setTitle(const QString& title) { m_title = title; }
     void setArtist(const QString& artist) { m_artist = artist; }
@@ -218,6 +227,7 @@ public:
     static void extractAdvancedMetadata(Song& song, const QString& filePath);
     static bool extractFFmpegMetadata(Song& song, const QString& filePath);
     static QPixmap extractCoverArt(const QString& filePath, const QSize& size = QSize(300, 300));
+    static QImage extractCoverImage(const QString& filePath);  ///< 解码原始尺寸封面，可在工作线程调用
     
     // 元数据获取方法
     static QString getTitleFromMetadata(const QString& filePath);
@@ -227,6 +237,10 @@ public:
     static QString getGenreFromMetadata(const QString& filePath);
     
 private:
+    // 通过AudioIOContext打开用于元数据解析的格式上下文
+    static AVFormatContext* openProbeContext(const QString& filePath, AVIOContext** ioContext);
+    static void closeProbeContext(AVFormatContext** formatContext, AVIOContext** ioContext);
+    
     int m_id;                           ///< 歌曲ID
     QString m_filePath;                 ///< 文件完整路径
     QString m_fileName;                 ///< 文件名
@@ -1,5 +1,6 @@
 #include "audioworkerthread.h"
 #include "../core/logger.h"
+#include "../audio/mappedfilecache.h"
 #include <QDebug>
 #include <QCoreApplication>
 
@@ -368,49 +369,23 @@ void AudioWorkerThread::updateBufferStatus() {
 }
 
 void AudioWorkerThread::preloadAudioFile(const QString& filePath) {
-    QMutexLocker locker(&m_preloadMutex);
-    
-    if (m_preloadCache.contains(filePath)) {
-        emit mediaPreloaded(filePath);
+    // 预加载只做内存映射和内核预读提示，文件内容进入页缓存而不复制到堆内存；
+    // 映射保存在MappedFileCache中，FFmpegDecoder打开同一文件时直接从映射读取
+    std::shared_ptr<MappedAudioFile> file = MappedFileCache::instance()->preload(filePath);
+    if (!file) {
+        emit preloadError(filePath, "无法映射文件");
+        logError(QString("[AudioWorker] Preload error for file: %1").arg(filePath));
         return;
     }
     
-    try {
-        QFile file(filePath);
-        if (!file.open(QIODevice::ReadOnly)) {
-            throw std::runtime_error("无法打开文件");
-        }
-        
-        QByteArray audioData = file.readAll();
-        m_preloadCache.insert(filePath, audioData);
-        
-        emit mediaPreloaded(filePath);
-        emit preloadProgress(filePath, 100);
-        
-        // 清理缓存，如果超过预设大小
-        managePreloadCache();
-        
-    } catch (const std::exception& e) {
-        emit preloadError(filePath, QString::fromUtf8(e.what()));
-        logError(QString("[AudioWorker] Preload error for file: %1, error: %2").arg(filePath).arg(e.what()));
-    }
+    emit mediaPreloaded(filePath);
+    emit preloadProgress(filePath, 100);
 }
 
-void AudioWorkerThread::managePreloadCache() {
-    const int MAX_CACHE_SIZE = 100 * 1024 * 1024; // 100MB
-    const int MAX_CACHE_FILES = 10;
-    
-    while (!m_preloadCache.isEmpty() && 
-           (m_preloadCache.size() > MAX_CACHE_FILES || 
-            calculateCacheSize() > MAX_CACHE_SIZE)) {
-        m_preloadCache.remove(m_preloadCache.firstKey());
-    }
+void AudioWorkerThread::clearPreloadCache() {
+    MappedFileCache::instance()->clear();
 }
 
 qint64 AudioWorkerThread::calculateCacheSize() const {
-    qint64 totalSize = 0;
-    for (const QByteArray& data : m_preloadCache) {
-        totalSize += data.size();
-    }
-    return totalSize;
-}
\ No newline at end of file
+    return MappedFileCache::instance()->totalBytes();
+}
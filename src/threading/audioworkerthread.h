@@ -217,10 +217,6 @@ private:
     int m_currentVolume;
     bool m_currentMuted;
     
-    // 预加载缓存
-    QMap<QString, QByteArray> m_preloadCache;
-    QMutex m_preloadMutex;
-    
     // 内部定时器
     QTimer* m_bufferTimer;
     QTimer* m_positionTimer;
@@ -265,7 +261,6 @@ private:
     // 预加载管理
     void preloadAudioFile(const QString& filePath);
     void clearPreloadCache();
-    void managePreloadCache();
     
     // 错误处理
     void handleError(const QString& error);
@@ -0,0 +1,820 @@
+#include "mainthreadmanager.h"
+#include "../core/logger.h"
+#include "../core/tracer.h"
+#include "../core/metricsregistry.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QDebug>
+#include <cmath>
+
+MainThreadManager* MainThreadManager::m_instance = nullptr;
+QMutex MainThreadManager::m_instanceMutex;
+
+namespace {
+
+// 以控件地址区分合并键，同一控件的同类更新只保留最新一次
+QString widgetKey(const char* kind, const void* widget)
+{
+    return QString("%1:%2").arg(QLatin1String(kind)).arg(reinterpret_cast<quintptr>(widget), 0, 16);
+}
+
+} // namespace
+
+MainThreadManager* MainThreadManager::instance()
+{
+    QMutexLocker locker(&m_instanceMutex);
+    if (!m_instance) {
+        m_instance = new MainThreadManager();
+        // 保证定时器和事件处理都在主线程
+        if (QCoreApplication::instance()) {
+            m_instance->moveToThread(QCoreApplication::instance()->thread());
+        }
+    }
+    return m_instance;
+}
+
+void MainThreadManager::cleanup()
+{
+    QMutexLocker locker(&m_instanceMutex);
+    if (m_instance) {
+        delete m_instance;
+        m_instance = nullptr;
+    }
+}
+
+MainThreadManager::MainThreadManager(QObject* parent)
+    : QObject(parent)
+    , m_nextSequence(0)
+    , m_pendingUpdateCount(0)
+    , m_frameScheduled(false)
+    , m_updateTimer(nullptr)
+    , m_statisticsTimer(nullptr)
+    , m_updateInterval(DEFAULT_UPDATE_INTERVAL)
+    , m_frameBudgetRatio(DEFAULT_FRAME_BUDGET)
+    , m_defaultPriority(0)
+    , m_updatesPaused(false)
+    , m_debugMode(false)
+    , m_processedUpdateCount(0)
+    , m_failedUpdateCount(0)
+    , m_coalescedUpdateCount(0)
+    , m_droppedUpdateCount(0)
+    , m_frameOverrunCount(0)
+    , m_totalProcessingTime(0)
+    , m_maxProcessingTime(0)
+    , m_minProcessingTime(0)
+{
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_updateTimer, &QTimer::timeout, this, &MainThreadManager::processUIUpdateQueue);
+
+    m_statisticsTimer = new QTimer(this);
+    connect(m_statisticsTimer, &QTimer::timeout, this, &MainThreadManager::updateStatistics);
+    m_statisticsTimer->start(STATISTICS_UPDATE_INTERVAL);
+
+    MetricsRegistry::registerGaugeCallback("ui.update_queue_depth", [this]() {
+        return static_cast<double>(getPendingUpdateCount());
+    });
+}
+
+MainThreadManager::~MainThreadManager()
+{
+    MetricsRegistry::unregisterGaugeCallback("ui.update_queue_depth");
+    m_updateTimer->stop();
+    m_statisticsTimer->stop();
+    clearPendingUpdates();
+}
+
+void MainThreadManager::scheduleUIUpdate(std::function<void()> updateFunction,
+                                         const QString& description, int priority)
+{
+    enqueueTask(UIUpdateTask(std::move(updateFunction), description, priority));
+}
+
+void MainThreadManager::scheduleUIUpdateDelayed(std::function<void()> updateFunction, int delayMs,
+                                                const QString& description, int priority)
+{
+    enqueueTask(UIUpdateTask(std::move(updateFunction), description, priority, true, qMax(0, delayMs)));
+}
+
+void MainThreadManager::scheduleCoalescedUIUpdate(const QString& key, std::function<void()> updateFunction,
+                                                  const QString& description, int priority)
+{
+    UIUpdateTask task(std::move(updateFunction), description.isEmpty() ? key : description, priority);
+    task.coalesceKey = key;
+    enqueueTask(std::move(task));
+}
+
+void MainThreadManager::batchUIUpdates(const QList<std::function<void()>>& updates,
+                                       const QString& batchDescription)
+{
+    if (updates.isEmpty()) {
+        return;
+    }
+
+    scheduleUIUpdate([this, updates]() {
+        emit batchUpdateStarted(updates.size());
+        int processed = 0;
+        int failed = 0;
+        for (int i = 0; i < updates.size(); ++i) {
+            try {
+                updates[i]();
+                ++processed;
+            } catch (const std::exception& e) {
+                ++failed;
+                logError(QString("批量UI更新第%1项失败: %2").arg(i).arg(e.what()));
+            }
+            emit batchUpdateProgress(i + 1, updates.size());
+        }
+        emit batchUpdateFinished(processed, failed);
+    }, batchDescription, m_defaultPriority);
+}
+
+void MainThreadManager::enqueueTask(UIUpdateTask task)
+{
+    if (!task.function) {
+        return;
+    }
+
+    const QString description = task.description;
+    bool needFrame = false;
+    {
+        QMutexLocker locker(&m_updateMutex);
+        if (task.delayed && task.delayMs > 0) {
+            task.sequence = m_nextSequence++;
+            const qint64 dueTime = task.timestamp + task.delayMs;
+            m_delayedQueue.emplace(dueTime, std::move(task));
+        } else {
+            enqueueReadyLocked(std::move(task));
+        }
+        if (!m_frameScheduled && !m_updatesPaused) {
+            m_frameScheduled = true;
+            needFrame = true;
+        }
+    }
+
+    if (needFrame) {
+        requestFrame();
+    }
+    if (m_debugMode) {
+        emit uiUpdateScheduled(description);
+    }
+}
+
+void MainThreadManager::enqueueReadyLocked(UIUpdateTask task)
+{
+    static MetricCounter* coalescedCounter = MetricsRegistry::counter("ui.updates_coalesced");
+    static MetricCounter* droppedCounter = MetricsRegistry::counter("ui.updates_dropped");
+
+    if (!task.coalesceKey.isEmpty()) {
+        auto existing = m_coalescedTasks.find(task.coalesceKey);
+        if (existing != m_coalescedTasks.end()) {
+            std::shared_ptr<UIUpdateTask> queued = existing.value();
+            m_coalescedUpdateCount.fetch_add(1, std::memory_order_relaxed);
+            coalescedCounter->increment();
+            if (task.priority <= queued->priority) {
+                // 原位替换，保留原来的排队位置
+                queued->function = std::move(task.function);
+                queued->description = task.description;
+                queued->timestamp = task.timestamp;
+                return;
+            }
+            // 优先级提高，旧条目作废后按新优先级重新入队
+            queued->function = nullptr;
+            m_coalescedTasks.erase(existing);
+            --m_pendingUpdateCount;
+        }
+    }
+
+    if (m_pendingUpdateCount >= MAX_QUEUE_SIZE) {
+        // 队列已满说明主线程跟不上，丢弃新任务而不是让延迟无限增长
+        m_droppedUpdateCount.fetch_add(1, std::memory_order_relaxed);
+        droppedCounter->increment();
+        return;
+    }
+
+    task.sequence = m_nextSequence++;
+    auto shared = std::make_shared<UIUpdateTask>(std::move(task));
+    if (!shared->coalesceKey.isEmpty()) {
+        m_coalescedTasks.insert(shared->coalesceKey, shared);
+    }
+    m_updateQueue.push(QueuedTask{shared, shared->priority, shared->sequence});
+    ++m_pendingUpdateCount;
+}
+
+void MainThreadManager::requestFrame()
+{
+    if (isCurrentThreadMainThread()) {
+        startFrameTimer();
+    } else {
+        QMetaObject::invokeMethod(this, [this]() { startFrameTimer(); }, Qt::QueuedConnection);
+    }
+}
+
+void MainThreadManager::startFrameTimer()
+{
+    if (m_updatesPaused) {
+        return;
+    }
+    m_updateTimer->start(frameIntervalMs());
+}
+
+std::shared_ptr<UIUpdateTask> MainThreadManager::takeNextTask()
+{
+    QMutexLocker locker(&m_updateMutex);
+    while (!m_updateQueue.empty()) {
+        QueuedTask entry = m_updateQueue.top();
+        m_updateQueue.pop();
+        if (!entry.task->function) {
+            continue;  // 已被更高优先级的合并任务取代
+        }
+        if (!entry.task->coalesceKey.isEmpty()) {
+            m_coalescedTasks.remove(entry.task->coalesceKey);
+        }
+        --m_pendingUpdateCount;
+        return entry.task;
+    }
+    return nullptr;
+}
+
+void MainThreadManager::promoteDueDelayedTasks(qint64 now)
+{
+    QMutexLocker locker(&m_updateMutex);
+    while (!m_delayedQueue.empty() && m_delayedQueue.begin()->first <= now) {
+        UIUpdateTask task = std::move(m_delayedQueue.begin()->second);
+        m_delayedQueue.erase(m_delayedQueue.begin());
+        enqueueReadyLocked(std::move(task));
+    }
+}
+
+void MainThreadManager::processUIUpdateQueue()
+{
+    TRACE_SCOPE("ui", "MainThreadManager::frame");
+    static MetricHistogram* frameWorkHistogram = MetricsRegistry::histogram("ui.frame_work_us");
+    static MetricCounter* overrunCounter = MetricsRegistry::counter("ui.frame_overruns");
+
+    if (m_updatesPaused) {
+        m_updateTimer->stop();
+        return;
+    }
+
+    promoteDueDelayedTasks(QDateTime::currentMSecsSinceEpoch());
+
+    const qint64 frameUs = static_cast<qint64>(frameIntervalMs()) * 1000;
+    const qint64 budgetNs = qMax<qint64>(1, static_cast<qint64>(frameUs * m_frameBudgetRatio)) * 1000;
+
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    int executed = 0;
+    // 至少执行一个任务保证前进，之后用完预算就把剩余任务留给下一帧
+    while (std::shared_ptr<UIUpdateTask> task = takeNextTask()) {
+        executeUIUpdateTask(*task);
+        ++executed;
+        if (frameTimer.nsecsElapsed() >= budgetNs) {
+            break;
+        }
+    }
+
+    if (executed > 0) {
+        const qint64 workUs = frameTimer.nsecsElapsed() / 1000;
+        frameWorkHistogram->record(static_cast<quint64>(workUs));
+        if (workUs > frameUs) {
+            m_frameOverrunCount.fetch_add(1, std::memory_order_relaxed);
+            overrunCounter->increment();
+            if (m_debugMode) {
+                logDebug(QString("帧超时: 执行%1个更新耗时%2us，帧间隔%3us").arg(executed).arg(workUs).arg(frameUs));
+            }
+        }
+    }
+
+    // 就绪队列为空时停止按帧率运行；只剩延迟任务时等到最早的到期时间
+    qint64 nextDueMs = -1;
+    {
+        QMutexLocker locker(&m_updateMutex);
+        if (m_pendingUpdateCount > 0) {
+            // 剩余任务顺延到下一帧（定时器可能正处于等待延迟任务的长间隔）
+            m_frameScheduled = true;
+            locker.unlock();
+            if (m_updateTimer->interval() != frameIntervalMs()) {
+                m_updateTimer->start(frameIntervalMs());
+            }
+            return;
+        }
+        m_frameScheduled = false;
+        if (!m_delayedQueue.empty()) {
+            nextDueMs = qMax<qint64>(0, m_delayedQueue.begin()->first - QDateTime::currentMSecsSinceEpoch());
+        }
+    }
+    if (nextDueMs >= 0) {
+        m_updateTimer->start(static_cast<int>(qMax<qint64>(nextDueMs, frameIntervalMs())));
+    } else {
+        m_updateTimer->stop();
+    }
+}
+
+void MainThreadManager::executeUIUpdateTask(const UIUpdateTask& task)
+{
+    QElapsedTimer timer;
+    timer.start();
+    try {
+        task.function();
+        updateProcessingStatistics(timer.nsecsElapsed() / 1000);
+        if (m_debugMode) {
+            emit uiUpdateProcessed(task.description);
+        }
+    } catch (const std::exception& e) {
+        handleUpdateError(QString::fromUtf8(e.what()), task.description);
+    } catch (...) {
+        handleUpdateError("未知错误", task.description);
+    }
+}
+
+int MainThreadManager::frameIntervalMs() const
+{
+    if (m_updateInterval > 0) {
+        return m_updateInterval;
+    }
+
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const qreal refreshRate = screen ? screen->refreshRate() : 0.0;
+    if (refreshRate < 1.0) {
+        return FALLBACK_FRAME_INTERVAL;
+    }
+    return qMax(1, static_cast<int>(std::floor(1000.0 / refreshRate)));
+}
+
+void MainThreadManager::handleUIEvent(const UIEvent& event)
+{
+    switch (event.type) {
+    case UIEventType::PlaybackUpdate:
+    case UIEventType::AudioUpdate:
+    case UIEventType::ProgressUpdate:
+        // 高频事件只需要最新状态
+        scheduleCoalescedUIUpdate(QString("event:%1").arg(static_cast<int>(event.type)),
+                                  [this, event]() { processUIEvent(event); },
+                                  event.description, event.priority);
+        break;
+    default:
+        scheduleUIUpdate([this, event]() { processUIEvent(event); }, event.description, event.priority);
+        break;
+    }
+}
+
+void MainThreadManager::handlePlaybackEvent(const QVariant& data)
+{
+    handleUIEvent(UIEvent(UIEventType::PlaybackUpdate, "playback", data));
+}
+
+void MainThreadManager::handleDatabaseEvent(const QVariant& data)
+{
+    handleUIEvent(UIEvent(UIEventType::DatabaseUpdate, "database", data));
+}
+
+void MainThreadManager::handleFileEvent(const QVariant& data)
+{
+    handleUIEvent(UIEvent(UIEventType::FileUpdate, "file", data));
+}
+
+void MainThreadManager::handleAudioEvent(const QVariant& data)
+{
+    handleUIEvent(UIEvent(UIEventType::AudioUpdate, "audio", data));
+}
+
+void MainThreadManager::handleTagEvent(const QVariant& data)
+{
+    handleUIEvent(UIEvent(UIEventType::TagUpdate, "tag", data));
+}
+
+void MainThreadManager::handlePlaylistEvent(const QVariant& data)
+{
+    handleUIEvent(UIEvent(UIEventType::PlaylistUpdate, "playlist", data));
+}
+
+void MainThreadManager::handleErrorEvent(const QVariant& data)
+{
+    // 错误需要尽快显示
+    handleUIEvent(UIEvent(UIEventType::ErrorUpdate, "error", data, 100));
+}
+
+void MainThreadManager::processUIEvent(const UIEvent& event)
+{
+    if (event.type == UIEventType::ErrorUpdate) {
+        logError(event.data.toString());
+    }
+    emit eventProcessed(event.type, event.description);
+}
+
+bool MainThreadManager::isMainThread() const
+{
+    return thread() == QThread::currentThread();
+}
+
+bool MainThreadManager::isCurrentThreadMainThread() const
+{
+    return QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+void MainThreadManager::setUpdatePriority(int priority)
+{
+    m_defaultPriority = priority;
+}
+
+int MainThreadManager::getUpdatePriority() const
+{
+    return m_defaultPriority;
+}
+
+void MainThreadManager::setUpdateInterval(int intervalMs)
+{
+    m_updateInterval = qMax(0, intervalMs);
+    if (m_updateTimer->isActive()) {
+        m_updateTimer->setInterval(frameIntervalMs());
+    }
+}
+
+int MainThreadManager::getUpdateInterval() const
+{
+    return frameIntervalMs();
+}
+
+void MainThreadManager::setFrameBudget(double ratio)
+{
+    m_frameBudgetRatio = qBound(0.05, ratio, 1.0);
+}
+
+double MainThreadManager::getFrameBudget() const
+{
+    return m_frameBudgetRatio;
+}
+
+void MainThreadManager::pauseUpdates()
+{
+    {
+        QMutexLocker locker(&m_updateMutex);
+        m_updatesPaused = true;
+        m_frameScheduled = false;
+    }
+    m_updateTimer->stop();
+    emit updatesPaused();
+}
+
+void MainThreadManager::resumeUpdates()
+{
+    bool needFrame = false;
+    {
+        QMutexLocker locker(&m_updateMutex);
+        m_updatesPaused = false;
+        if (m_pendingUpdateCount > 0 || !m_delayedQueue.empty()) {
+            m_frameScheduled = true;
+            needFrame = true;
+        }
+    }
+    if (needFrame) {
+        requestFrame();
+    }
+    emit updatesResumed();
+}
+
+bool MainThreadManager::isUpdatesPaused() const
+{
+    return m_updatesPaused;
+}
+
+void MainThreadManager::clearPendingUpdates()
+{
+    {
+        QMutexLocker locker(&m_updateMutex);
+        m_updateQueue = decltype(m_updateQueue)();
+        m_coalescedTasks.clear();
+        m_delayedQueue.clear();
+        m_pendingUpdateCount = 0;
+    }
+    emit queueCleared();
+}
+
+int MainThreadManager::getPendingUpdateCount() const
+{
+    QMutexLocker locker(&m_updateMutex);
+    return m_pendingUpdateCount + static_cast<int>(m_delayedQueue.size());
+}
+
+int MainThreadManager::getProcessedUpdateCount() const
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    return m_processedUpdateCount;
+}
+
+int MainThreadManager::getFailedUpdateCount() const
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    return m_failedUpdateCount;
+}
+
+quint64 MainThreadManager::getCoalescedUpdateCount() const
+{
+    return m_coalescedUpdateCount.load(std::memory_order_relaxed);
+}
+
+quint64 MainThreadManager::getDroppedUpdateCount() const
+{
+    return m_droppedUpdateCount.load(std::memory_order_relaxed);
+}
+
+quint64 MainThreadManager::getFrameOverrunCount() const
+{
+    return m_frameOverrunCount.load(std::memory_order_relaxed);
+}
+
+qint64 MainThreadManager::getAverageProcessingTime() const
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    return m_processedUpdateCount > 0 ? m_totalProcessingTime / m_processedUpdateCount : 0;
+}
+
+void MainThreadManager::setErrorHandler(std::function<void(const QString&)> handler)
+{
+    m_errorHandler = std::move(handler);
+}
+
+void MainThreadManager::enableDebugMode(bool enabled)
+{
+    m_debugMode = enabled;
+}
+
+bool MainThreadManager::isDebugModeEnabled() const
+{
+    return m_debugMode;
+}
+
+void MainThreadManager::dumpPendingUpdates() const
+{
+    QMutexLocker locker(&m_updateMutex);
+    qDebug() << "MainThreadManager: 待执行" << m_pendingUpdateCount << "个，延迟" << m_delayedQueue.size()
+             << "个，合并" << getCoalescedUpdateCount() << "次，丢弃" << getDroppedUpdateCount()
+             << "次，帧超时" << getFrameOverrunCount() << "次";
+
+    // 复制一份堆按执行顺序输出
+    auto queue = m_updateQueue;
+    while (!queue.empty()) {
+        const QueuedTask& entry = queue.top();
+        if (entry.task->function) {
+            qDebug() << "  " << formatUpdateTask(*entry.task);
+        }
+        queue.pop();
+    }
+    for (const auto& delayed : m_delayedQueue) {
+        qDebug() << "  [延迟]" << formatUpdateTask(delayed.second);
+    }
+}
+
+void MainThreadManager::updateStatistics()
+{
+    int processed = 0;
+    int failed = 0;
+    {
+        QMutexLocker locker(&m_statisticsMutex);
+        processed = m_processedUpdateCount;
+        failed = m_failedUpdateCount;
+    }
+    emit statisticsUpdated(getPendingUpdateCount(), processed, failed);
+}
+
+void MainThreadManager::handleUpdateError(const QString& error, const QString& taskDescription)
+{
+    {
+        QMutexLocker locker(&m_statisticsMutex);
+        ++m_failedUpdateCount;
+    }
+    logError(QString("UI更新失败 [%1]: %2").arg(taskDescription, error));
+    if (m_errorHandler) {
+        m_errorHandler(error);
+    }
+    emit uiUpdateFailed(taskDescription, error);
+}
+
+void MainThreadManager::logError(const QString& error)
+{
+    Logger::instance()->error(error, "MainThreadManager");
+}
+
+void MainThreadManager::logDebug(const QString& message)
+{
+    Logger::instance()->debug(message, "MainThreadManager");
+}
+
+void MainThreadManager::updateProcessingStatistics(qint64 processingTime)
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    ++m_processedUpdateCount;
+    m_totalProcessingTime += processingTime;
+    m_maxProcessingTime = qMax(m_maxProcessingTime, processingTime);
+    m_minProcessingTime = m_processedUpdateCount == 1 ? processingTime : qMin(m_minProcessingTime, processingTime);
+}
+
+void MainThreadManager::resetStatistics()
+{
+    QMutexLocker locker(&m_statisticsMutex);
+    m_processedUpdateCount = 0;
+    m_failedUpdateCount = 0;
+    m_totalProcessingTime = 0;
+    m_maxProcessingTime = 0;
+    m_minProcessingTime = 0;
+}
+
+QString MainThreadManager::formatUpdateTask(const UIUpdateTask& task) const
+{
+    QString text = QString("#%1 优先级%2 %3").arg(task.sequence).arg(task.priority).arg(task.description);
+    if (!task.coalesceKey.isEmpty()) {
+        text += QString(" (合并键 %1)").arg(task.coalesceKey);
+    }
+    if (task.delayed) {
+        text += QString(" (延迟%1ms)").arg(task.delayMs);
+    }
+    return text;
+}
+
+// ThreadSafeUIUpdater
+
+void ThreadSafeUIUpdater::updateProgressBar(QProgressBar* progressBar, int value)
+{
+    QPointer<QProgressBar> guard(progressBar);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("progress", progressBar), [guard, value]() {
+        if (guard) guard->setValue(value);
+    });
+}
+
+void ThreadSafeUIUpdater::updateLabel(QLabel* label, const QString& text)
+{
+    QPointer<QLabel> guard(label);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("label", label), [guard, text]() {
+        if (guard) guard->setText(text);
+    });
+}
+
+void ThreadSafeUIUpdater::updateListWidget(QListWidget* listWidget, const QStringList& items)
+{
+    QPointer<QListWidget> guard(listWidget);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("list", listWidget), [guard, items]() {
+        if (!guard) return;
+        guard->clear();
+        guard->addItems(items);
+    });
+}
+
+void ThreadSafeUIUpdater::updateStatusBar(QStatusBar* statusBar, const QString& message, int timeout)
+{
+    QPointer<QStatusBar> guard(statusBar);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("status", statusBar), [guard, message, timeout]() {
+        if (guard) guard->showMessage(message, timeout);
+    });
+}
+
+void ThreadSafeUIUpdater::updateButton(QPushButton* button, const QString& text, bool enabled)
+{
+    QPointer<QPushButton> guard(button);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("button", button), [guard, text, enabled]() {
+        if (!guard) return;
+        guard->setText(text);
+        guard->setEnabled(enabled);
+    });
+}
+
+void ThreadSafeUIUpdater::updateSlider(QSlider* slider, int value)
+{
+    QPointer<QSlider> guard(slider);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("slider", slider), [guard, value]() {
+        if (guard) guard->setValue(value);
+    });
+}
+
+void ThreadSafeUIUpdater::updateTextEdit(QTextEdit* textEdit, const QString& text)
+{
+    QPointer<QTextEdit> guard(textEdit);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("text", textEdit), [guard, text]() {
+        if (guard) guard->setPlainText(text);
+    });
+}
+
+void ThreadSafeUIUpdater::updateTableWidget(QTableWidget* table, int row, int column, const QString& text)
+{
+    QPointer<QTableWidget> guard(table);
+    MainThreadManager::instance()->scheduleUIUpdate([guard, row, column, text]() {
+        if (!guard) return;
+        QTableWidgetItem* item = guard->item(row, column);
+        if (item) {
+            item->setText(text);
+        } else {
+            guard->setItem(row, column, new QTableWidgetItem(text));
+        }
+    });
+}
+
+void ThreadSafeUIUpdater::updateTreeWidget(QTreeWidget* tree, QTreeWidgetItem* item, int column, const QString& text)
+{
+    QPointer<QTreeWidget> guard(tree);
+    MainThreadManager::instance()->scheduleUIUpdate([guard, item, column, text]() {
+        if (guard && item) item->setText(column, text);
+    });
+}
+
+void ThreadSafeUIUpdater::updateComboBox(QComboBox* comboBox, const QStringList& items)
+{
+    QPointer<QComboBox> guard(comboBox);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("combo", comboBox), [guard, items]() {
+        if (!guard) return;
+        guard->clear();
+        guard->addItems(items);
+    });
+}
+
+void ThreadSafeUIUpdater::updateGroupBox(QGroupBox* groupBox, const QString& title, bool enabled)
+{
+    QPointer<QGroupBox> guard(groupBox);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("group", groupBox), [guard, title, enabled]() {
+        if (!guard) return;
+        guard->setTitle(title);
+        guard->setEnabled(enabled);
+    });
+}
+
+void ThreadSafeUIUpdater::updateCheckBox(QCheckBox* checkBox, bool checked)
+{
+    QPointer<QCheckBox> guard(checkBox);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("check", checkBox), [guard, checked]() {
+        if (guard) guard->setChecked(checked);
+    });
+}
+
+void ThreadSafeUIUpdater::updateRadioButton(QRadioButton* radioButton, bool checked)
+{
+    QPointer<QRadioButton> guard(radioButton);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("radio", radioButton), [guard, checked]() {
+        if (guard) guard->setChecked(checked);
+    });
+}
+
+void ThreadSafeUIUpdater::updateImageLabel(QLabel* label, const QPixmap& pixmap)
+{
+    QPointer<QLabel> guard(label);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("image", label), [guard, pixmap]() {
+        if (guard) guard->setPixmap(pixmap);
+    });
+}
+
+void ThreadSafeUIUpdater::updateToolBar(QToolBar* toolBar, bool visible)
+{
+    QPointer<QToolBar> guard(toolBar);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("toolbar", toolBar), [guard, visible]() {
+        if (guard) guard->setVisible(visible);
+    });
+}
+
+void ThreadSafeUIUpdater::updateMenu(QMenu* menu, bool enabled)
+{
+    QPointer<QMenu> guard(menu);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("menu", menu), [guard, enabled]() {
+        if (guard) guard->setEnabled(enabled);
+    });
+}
+
+void ThreadSafeUIUpdater::updateAction(QAction* action, bool enabled, const QString& text)
+{
+    QPointer<QAction> guard(action);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("action", action), [guard, enabled, text]() {
+        if (!guard) return;
+        guard->setEnabled(enabled);
+        if (!text.isEmpty()) {
+            guard->setText(text);
+        }
+    });
+}
+
+void ThreadSafeUIUpdater::updateWindow(QWidget* window, const QString& title)
+{
+    QPointer<QWidget> guard(window);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("window", window), [guard, title]() {
+        if (guard) guard->setWindowTitle(title);
+    });
+}
+
+void ThreadSafeUIUpdater::setWidgetFocus(QWidget* widget)
+{
+    QPointer<QWidget> guard(widget);
+    MainThreadManager::instance()->scheduleUIUpdate([guard]() {
+        if (guard) guard->setFocus();
+    });
+}
+
+void ThreadSafeUIUpdater::updateWidgetStyle(QWidget* widget, const QString& styleSheet)
+{
+    QPointer<QWidget> guard(widget);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(widgetKey("style", widget), [guard, styleSheet]() {
+        if (guard) guard->setStyleSheet(styleSheet);
+    });
+}
+
+void ThreadSafeUIUpdater::batchUpdateWidgets(const QList<std::function<void()>>& updates)
+{
+    MainThreadManager::instance()->batchUIUpdates(updates);
+}
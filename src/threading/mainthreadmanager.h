@@ -3,7 +3,7 @@
 
 #include <QObject>
 #include <QMutex>
-#include <QQueue>
+#include <QHash>
 #include <QTimer>
 #include <QThread>
 #include <QCoreApplication>
@@ -30,7 +30,12 @@
 #include <QMenu>
 #include <QAction>
 #include <QWidget>
+#include <atomic>
 #include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <vector>
 
 // 事件类型
 enum class UIEventType {
@@ -68,14 +73,24 @@ struct UIUpdateTask {
     qint64 timestamp;
     bool delayed;
     int delayMs;
+    QString coalesceKey;    // 非空时同一键只保留最新的任务
+    quint64 sequence;       // 入队序号，同优先级按先后执行
     
-    UIUpdateTask(std::function<void()> func, const QString& desc = QString(), 
+    UIUpdateTask(std::function<void()> func = nullptr, const QString& desc = QString(), 
                  int p = 0, bool d = false, int delay = 0)
         : function(func), description(desc), priority(p), 
-          timestamp(QDateTime::currentMSecsSinceEpoch()), delayed(d), delayMs(delay) {}
+          timestamp(QDateTime::currentMSecsSinceEpoch()), delayed(d), delayMs(delay), sequence(0) {}
 };
 
-// 主线程管理器
+/**
+ * @brief 主线程管理器
+ *
+ * 任意线程都可以提交UI更新，主线程按显示器刷新率逐帧执行：
+ * - 按优先级（高者先）和入队顺序排序；
+ * - 带合并键的任务在执行前只保留最新一次（播放位置、电平等高频更新）；
+ * - 每帧只使用刷新间隔的一部分时间，剩余任务顺延到下一帧；
+ * - 队列为空时帧定时器停止，不产生空转。
+ */
 class MainThreadManager : public QObject {
     Q_OBJECT
     
@@ -90,7 +105,17 @@ public:
     void scheduleUIUpdateDelayed(std::function<void()> updateFunction, int delayMs,
                                 const QString& description = QString(), int priority = 0);
     
-    // 批量UI更新
+    /**
+     * @brief 提交可合并的UI更新
+     * @param key 合并键，同一键尚未执行的旧任务被新任务替换
+     * @param updateFunction 更新函数
+     * @param description 描述
+     * @param priority 优先级，替换时取新旧中较高者
+     */
+    void scheduleCoalescedUIUpdate(const QString& key, std::function<void()> updateFunction,
+                                   const QString& description = QString(), int priority = 0);
+    
+    // 批量UI更新（作为一个任务在同一帧内执行）
     void batchUIUpdates(const QList<std::function<void()>>& updates, 
                        const QString& batchDescription = QString());
     
@@ -108,29 +133,37 @@ public:
     bool isMainThread() const;
     bool isCurrentThreadMainThread() const;
     
-    // 优先级管理
+    // 优先级管理（未指定优先级时使用的默认值）
     void setUpdatePriority(int priority);
     int getUpdatePriority() const;
     
-    // 定时器管理
+    // 帧设置
+    /**
+     * @brief 设置帧间隔
+     * @param intervalMs 间隔（毫秒），0表示跟随主屏幕刷新率
+     */
     void setUpdateInterval(int intervalMs);
     int getUpdateInterval() const;
+    /**
+     * @brief 设置每帧可用于执行更新的时间占帧间隔的比例
+     * @param ratio 取值范围(0, 1]
+     */
+    void setFrameBudget(double ratio);
+    double getFrameBudget() const;
     void pauseUpdates();
     void resumeUpdates();
     bool isUpdatesPaused() const;
+    void clearPendingUpdates();
     
     // 统计信息
     int getPendingUpdateCount() const;
     int getProcessedUpdateCount() const;
     int getFailedUpdateCount() const;
+    quint64 getCoalescedUpdateCount() const;
+    quint64 getDroppedUpdateCount() const;
+    quint64 getFrameOverrunCount() const;
     qint64 getAverageProcessingTime() const;
     
-    // 批处理设置
-    void setBatchSize(int size);
-    int getBatchSize() const;
-    void setBatchTimeout(int timeoutMs);
-    int getBatchTimeout() const;
-    
     // 错误处理
     void setErrorHandler(std::function<void(const QString&)> handler);
     
@@ -164,10 +197,7 @@ signals:
     
 private slots:
     void processUIUpdateQueue();
-    void processDelayedUpdates();
-    void processBatchUpdates();
     void updateStatistics();
-    void handleTimeout();
     
 private:
     explicit MainThreadManager(QObject* parent = nullptr);
@@ -181,35 +211,50 @@ private:
     static MainThreadManager* m_instance;
     static QMutex m_instanceMutex;
     
-    // 更新队列
-    QQueue<UIUpdateTask> m_updateQueue;
-    QQueue<UIUpdateTask> m_delayedQueue;
-    QQueue<UIUpdateTask> m_batchQueue;
+    // 就绪队列中的条目；合并任务被替换后旧条目的function置空，出队时跳过
+    struct QueuedTask {
+        std::shared_ptr<UIUpdateTask> task;
+        int priority;
+        quint64 sequence;
+    };
+    struct QueuedTaskOrder {
+        bool operator()(const QueuedTask& a, const QueuedTask& b) const {
+            if (a.priority != b.priority) {
+                return a.priority < b.priority;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+    
+    // 更新队列（均由m_updateMutex保护）
+    std::priority_queue<QueuedTask, std::vector<QueuedTask>, QueuedTaskOrder> m_updateQueue;
+    QHash<QString, std::shared_ptr<UIUpdateTask>> m_coalescedTasks;
+    std::multimap<qint64, UIUpdateTask> m_delayedQueue;  // 按到期时间排序
+    quint64 m_nextSequence;
+    int m_pendingUpdateCount;
+    bool m_frameScheduled;  // 帧定时器正在按帧率运行，或启动请求已投递
     
     // 线程安全
-    QMutex m_updateMutex;
-    QMutex m_delayedMutex;
-    QMutex m_batchMutex;
-    QMutex m_statisticsMutex;
+    mutable QMutex m_updateMutex;
+    mutable QMutex m_statisticsMutex;
     
     // 定时器
     QTimer* m_updateTimer;
-    QTimer* m_delayedTimer;
-    QTimer* m_batchTimer;
     QTimer* m_statisticsTimer;
     
     // 设置
     int m_updateInterval;
+    double m_frameBudgetRatio;
     int m_defaultPriority;
-    int m_batchSize;
-    int m_batchTimeout;
     bool m_updatesPaused;
     bool m_debugMode;
     
     // 统计信息
-    int m_pendingUpdateCount;
     int m_processedUpdateCount;
     int m_failedUpdateCount;
+    std::atomic<quint64> m_coalescedUpdateCount;
+    std::atomic<quint64> m_droppedUpdateCount;
+    std::atomic<quint64> m_frameOverrunCount;
     qint64 m_totalProcessingTime;
     qint64 m_maxProcessingTime;
     qint64 m_minProcessingTime;
@@ -217,52 +262,37 @@ private:
     // 错误处理
     std::function<void(const QString&)> m_errorHandler;
     
-    // 内部方法
-    void initializeTimers();
-    void cleanupTimers();
-    void configureUpdateTimer();
-    void configureDelayedTimer();
-    void configureBatchTimer();
-    void configureStatisticsTimer();
+    // 入队
+    void enqueueTask(UIUpdateTask task);
+    void enqueueReadyLocked(UIUpdateTask task);
+    void requestFrame();
+    void startFrameTimer();
     
     // 队列处理
+    std::shared_ptr<UIUpdateTask> takeNextTask();
+    void promoteDueDelayedTasks(qint64 now);
     void executeUIUpdateTask(const UIUpdateTask& task);
-    void executeUIUpdateBatch(const QList<UIUpdateTask>& tasks);
-    void clearUpdateQueue();
-    void clearDelayedQueue();
-    void clearBatchQueue();
-    
-    // 优先级处理
-    void sortUpdateQueue();
-    void insertByPriority(UIUpdateTask& task);
+    int frameIntervalMs() const;
     
     // 事件处理实现
     void processUIEvent(const UIEvent& event);
-    void handleEventInternal(UIEventType type, const QVariant& data);
     
     // 错误处理
     void handleUpdateError(const QString& error, const QString& taskDescription);
     void logError(const QString& error);
-    void logInfo(const QString& message);
     void logDebug(const QString& message);
     
     // 统计计算
     void updateProcessingStatistics(qint64 processingTime);
     void resetStatistics();
     
-    // 线程检查
-    bool validateMainThread() const;
-    void ensureMainThread() const;
-    
     // 调试工具
     QString formatUpdateTask(const UIUpdateTask& task) const;
-    QString formatUIEvent(const UIEvent& event) const;
-    void dumpQueueState() const;
     
     // 内部常量
-    static const int DEFAULT_UPDATE_INTERVAL = 16; // 60 FPS
-    static const int DEFAULT_BATCH_SIZE = 10;
-    static const int DEFAULT_BATCH_TIMEOUT = 100;
+    static const int DEFAULT_UPDATE_INTERVAL = 0;       // 跟随刷新率
+    static const int FALLBACK_FRAME_INTERVAL = 16;      // 无法获取刷新率时按60 FPS
+    static constexpr double DEFAULT_FRAME_BUDGET = 0.5; // 每帧留一半时间给布局和绘制
     static const int MAX_QUEUE_SIZE = 1000;
     static const int STATISTICS_UPDATE_INTERVAL = 1000;
 };
@@ -4,6 +4,7 @@
 #include "../widgets/taglistitem.h"
 #include "../../managers/tagmanager.h"
 #include "../../audio/audioengine.h"
+#include "../../audio/waveformcache.h"
 #include "../../database/databasemanager.h"
 #include "../../database/tagdao.h"
 #include "../../database/songdao.h"
@@ -1215,6 +1216,10 @@ void AddSongDialogController::processFiles() {
                 if (fileInfo.duration > 0) {
                     song.setDuration(fileInfo.duration);
                 }
+                // 已有波形概览时使用解码得到的实测时长，比容器头中的估计准确（如VBR MP3）
+                if (std::optional<WaveformOverview> overview = WaveformCache::instance()->load(fileInfo.filePath)) {
+                    song.setDuration(overview->durationMs);
+                }
                 
                 int songId = songDao.addSong(song);
                 if (songId > 0) {
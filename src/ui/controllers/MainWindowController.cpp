@@ -4,6 +4,8 @@
 #include "../../audio/audiotypes.h"
 #include "../../managers/tagmanager.h"
 #include "../../managers/playlistmanager.h"
+#include "../../managers/coverartcache.h"
+#include "../../audio/waveformcache.h"
 #include "../../core/componentintegration.h"
 #include "../../core/constants.h"
 #include "../../threading/mainthreadmanager.h"
@@ -32,9 +34,15 @@
 #include <QTimer>
 #include "../../database/songdao.h"
 #include "../../database/tagdao.h"
+#include "../../database/tagindex.h"
 #include <QListWidgetItem>
+#include <QScrollBar>
+#include <QPointer>
 #include <QPixmap>
 #include "../../ui/dialogs/createtagdialog.h"
+#include "../../core/tracer.h"
+#include "../../managers/librarysnapshot.h"
+#include "../../managers/playhistoryrecorder.h"
 #include <QMenu>
 #include <QMessageBox>
 #include <QLineEdit>
@@ -45,10 +53,11 @@
 #include <QTextStream>
 #include <QDir>
 #include <QUrl>
-#include <QXmlStreamReader>
 #include <QFormLayout>
 #include <QSpinBox>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QInputDialog>
 #include <QFrame>
 #include <QHBoxLayout>
@@ -67,7 +76,7 @@ MainWindowController::MainWindowController(MainWindow* mainWindow, QObject* pare
     , m_tagManager(nullptr)
     , m_componentIntegration(nullptr)
     , m_lastActiveTag("")
-    , m_lastPlaylist()
+    , m_lastPlaylistSongIds()
     , m_playlistChangedByUser(false)
     , m_shouldKeepPlaylist(false)
     , m_needsRecentPlaySortUpdate(false)
@@ -101,6 +110,8 @@ MainWindowController::MainWindowController(MainWindow* mainWindow, QObject* pare
     , m_settings(nullptr)
     , m_updateTimer(nullptr)
     , m_statusTimer(nullptr)
+    , m_librarySnapshotTimer(nullptr)
+    , m_librarySnapshotDirty(false)
     , m_dragDropEnabled(true)
 {
     // 初始化设置
@@ -113,6 +124,10 @@ MainWindowController::MainWindowController(MainWindow* mainWindow, QObject* pare
     // 连接定时器信号
     connect(m_updateTimer, &QTimer::timeout, this, &MainWindowController::refreshUI);
     connect(m_statusTimer, &QTimer::timeout, this, &MainWindowController::updateStatusMessage);
+    
+    // 列表有变化时定期保存快照，异常退出后下次启动也有较新的列表
+    m_librarySnapshotTimer = new QTimer(this);
+    connect(m_librarySnapshotTimer, &QTimer::timeout, this, &MainWindowController::saveLibrarySnapshot);
 }
 
 MainWindowController::~MainWindowController()
@@ -157,9 +172,20 @@ bool MainWindowController::initialize()
         // 初始化时同步播放模式按钮
         updatePlayModeButton();
         
-        // 初始化数据显示
-        updateTagList();
-        updateSongList();
+        // 初始化数据显示：有快照时先显示快照，下一帧再与数据库同步
+        if (restoreLibrarySnapshot()) {
+            QPointer<MainWindowController> guard(this);
+            MainThreadManager* mainThreadManager = MainThreadManager::instance();
+            mainThreadManager->scheduleUIUpdateDelayed([guard]() {
+                if (guard) {
+                    guard->reconcileLibraryView();
+                }
+            }, mainThreadManager->getUpdateInterval(), "同步曲库视图快照");
+        } else {
+            updateTagList();
+            updateSongList();
+        }
+        m_librarySnapshotTimer->start(Constants::UI::LIBRARY_SNAPSHOT_INTERVAL_MS);
         
         m_initialized = true;
         logInfo("主窗口控制器初始化完成");
@@ -193,8 +219,12 @@ void MainWindowController::shutdown()
     
     // 保存设置
     saveSettings();
+    saveLibrarySnapshot();
     
     // 停止定时器
+    if (m_librarySnapshotTimer) {
+        m_librarySnapshotTimer->stop();
+    }
     if (m_updateTimer) {
         m_updateTimer->stop();
     }
@@ -476,51 +506,60 @@ void MainWindowController::onSongListItemDoubleClicked(QListWidgetItem* item)
              return;
          }
          
-         // 构建当前标签下的播放列表
-         QList<Song> playlist;
-         int targetIndex = -1;
-         int songCount = m_songListWidget->count();
+         // 列表对应查询来源（全部歌曲、标签）时按来源播放，歌曲ID在播放时分窗口读取，不复制歌曲列表
+         const PlayQueueSource source = currentListSource();
+         if (source.type != PlayQueueSource::Type::None) {
+             m_audioEngine->setSource(source, song.id(), m_songListWidget->row(item));
+         }
+         
+         // "最近播放"等列表，或列表已与数据库不一致时，按列表内容构建显式播放列表
+         if (source.type == PlayQueueSource::Type::None || m_audioEngine->currentSong().id() != song.id()) {
+             // 构建当前标签下的播放列表
+             QList<Song> playlist;
+             int targetIndex = -1;
+             int songCount = m_songListWidget->count();
          
-         for (int i = 0; i < songCount; ++i) {
-             QListWidgetItem* listItem = m_songListWidget->item(i);
-             if (listItem) {
-                 QVariant itemSongData = listItem->data(Qt::UserRole);
-                 if (itemSongData.isValid()) {
-                     Song listSong = itemSongData.value<Song>();
-                     if (listSong.isValid()) {
-                         // 检查文件格式是否支持
-                         if (m_audioEngine->isFormatSupported(listSong.filePath())) {
-                             playlist.append(listSong);
-                             // 找到当前点击的歌曲在播放列表中的索引
-                             if (listSong.id() == song.id()) {
-                                 targetIndex = playlist.size() - 1;
+             for (int i = 0; i < songCount; ++i) {
+                 QListWidgetItem* listItem = m_songListWidget->item(i);
+                 if (listItem) {
+                     QVariant itemSongData = listItem->data(Qt::UserRole);
+                     if (itemSongData.isValid()) {
+                         Song listSong = itemSongData.value<Song>();
+                         if (listSong.isValid()) {
+                             // 检查文件格式是否支持
+                             if (m_audioEngine->isFormatSupported(listSong.filePath())) {
+                                 playlist.append(listSong);
+                                 // 找到当前点击的歌曲在播放列表中的索引
+                                 if (listSong.id() == song.id()) {
+                                     targetIndex = playlist.size() - 1;
+                                 }
                              }
                          }
                      }
                  }
              }
-         }
          
-         if (playlist.isEmpty()) {
-             logWarning("无法构建播放列表，所有歌曲格式都不支持");
-             updateStatusBar("播放失败：没有支持的音频格式", 3000);
-             return;
-         }
+             if (playlist.isEmpty()) {
+                 logWarning("无法构建播放列表，所有歌曲格式都不支持");
+                 updateStatusBar("播放失败：没有支持的音频格式", 3000);
+                 return;
+             }
+         
+             if (targetIndex == -1) {
+                 logWarning("目标歌曲格式不支持，创建单曲播放列表");
+                 // 如果目标歌曲格式不支持，创建单曲播放列表
+                 playlist.clear();
+                 playlist.append(song);
+                 targetIndex = 0;
+             }
          
-         if (targetIndex == -1) {
-             logWarning("目标歌曲格式不支持，创建单曲播放列表");
-             // 如果目标歌曲格式不支持，创建单曲播放列表
-             playlist.clear();
-             playlist.append(song);
-             targetIndex = 0;
+             // 设置播放列表到AudioEngine
+             m_audioEngine->setPlaylist(playlist);
+             
+             // 设置当前歌曲索引（这会触发currentSongChanged信号）
+             m_audioEngine->setCurrentIndex(targetIndex);
          }
          
-         // 设置播放列表到AudioEngine
-        m_audioEngine->setPlaylist(playlist);
-        
-        // 设置当前歌曲索引（这会触发currentSongChanged信号）
-        m_audioEngine->setCurrentIndex(targetIndex);
-        
         // 开始播放
         m_audioEngine->play();
          
@@ -548,11 +587,10 @@ void MainWindowController::onPlayButtonClicked()
     m_audioEngine->debugAudioState();
     
     AudioTypes::AudioState currentState = m_audioEngine->state();
-    int playlistSize = m_audioEngine->playlist().size();
-    int currentIndex = m_audioEngine->currentIndex();
+    int playlistSize = m_audioEngine->queueSize();
     
     // 首先检查播放列表是否为空或索引无效
-    if (playlistSize == 0 || currentIndex < 0) {
+    if (playlistSize == 0 || !m_audioEngine->hasCurrentSong()) {
         // 检查当前歌曲列表是否有歌曲可以播放
         if (m_songListWidget && m_songListWidget->count() > 0) {
             startNewPlayback();
@@ -743,6 +781,19 @@ void MainWindowController::startPlaybackFromCurrentList()
         }
     }
     
+    // 列表对应查询来源时按来源播放，不复制歌曲列表
+    const PlayQueueSource source = currentListSource();
+    QListWidgetItem* targetItem = m_songListWidget->item(targetIndex);
+    const Song targetSong = targetItem ? targetItem->data(Qt::UserRole).value<Song>() : Song();
+    if (source.type != PlayQueueSource::Type::None && targetSong.isValid()) {
+        m_audioEngine->setSource(source, targetSong.id(), targetIndex);
+        if (m_audioEngine->currentSong().id() == targetSong.id()) {
+            m_audioEngine->play();
+            updateStatusBar(QString("开始播放: %1").arg(targetSong.title()), 2000);
+            return;
+        }
+    }
+    
     // 构建播放列表
     QList<Song> playlist;
     for (int i = 0; i < m_songListWidget->count(); ++i) {
@@ -769,7 +820,7 @@ void MainWindowController::startPlaybackFromCurrentList()
     m_audioEngine->setCurrentIndex(targetIndex);
     
     // 验证设置是否成功
-    if (m_audioEngine->playlist().size() != playlist.size()) {
+    if (m_audioEngine->queueSize() != playlist.size()) {
         logError("播放列表设置失败");
         updateStatusBar("播放列表设置失败", 2000);
         return;
@@ -822,11 +873,10 @@ void MainWindowController::onNextButtonClicked()
     }
     
     // 检查播放列表是否为空或当前索引无效
-    int playlistSize = m_audioEngine->playlist().size();
-    int currentIndex = m_audioEngine->currentIndex();
+    int playlistSize = m_audioEngine->queueSize();
     
     // 如果播放列表为空或索引无效
-    if (playlistSize == 0 || currentIndex < 0) {
+    if (playlistSize == 0 || !m_audioEngine->hasCurrentSong()) {
         // 检查当前歌曲列表是否有歌曲可以播放
         if (m_songListWidget && m_songListWidget->count() > 0) {
             startNewPlayback();
@@ -850,14 +900,14 @@ void MainWindowController::onPreviousButtonClicked()
     }
     
     // 检查播放列表是否为空或当前索引无效
-    int playlistSize = m_audioEngine->playlist().size();
+    int playlistSize = m_audioEngine->queueSize();
     int currentIndex = m_audioEngine->currentIndex();
     
     qDebug() << "[上一首按钮] 当前播放列表大小:" << playlistSize;
     qDebug() << "[上一首按钮] 当前播放索引:" << currentIndex;
     
     // 如果播放列表为空或索引无效
-    if (playlistSize == 0 || currentIndex < 0) {
+    if (playlistSize == 0 || !m_audioEngine->hasCurrentSong()) {
         // 检查当前歌曲列表是否有歌曲可以播放
         if (m_songListWidget && m_songListWidget->count() > 0) {
             startNewPlayback();
@@ -1006,6 +1056,17 @@ void MainWindowController::setupUI()
     m_musicProgressBar = new MusicProgressBar(m_mainWindow);
     m_musicProgressBar->setObjectName("musicProgressBar");
     
+    // 后台生成的波形完成后，若仍是当前歌曲则显示到进度条
+    connect(WaveformCache::instance(), &WaveformCache::overviewReady, this, [this](const QString& filePath) {
+        if (!m_audioEngine || !m_musicProgressBar || m_audioEngine->currentSong().filePath() != filePath) {
+            return;
+        }
+        std::optional<WaveformOverview> overview = WaveformCache::instance()->lookup(filePath);
+        if (overview) {
+            m_musicProgressBar->setWaveform(overview->minimums, overview->maximums, overview->peak, overview->rms);
+        }
+    });
+    
     // 查找音量相关控件
     m_volumeLabel = m_mainWindow->findChild<QLabel*>("label_volume_value");
     m_volumeIconLabel = m_mainWindow->findChild<QLabel*>("label_volume_icon");
@@ -1178,6 +1239,14 @@ void MainWindowController::setupConnections()
         connect(m_audioEngine, &AudioEngine::playModeChanged, this, &MainWindowController::onPlayModeChanged);
         connect(m_audioEngine, &AudioEngine::errorOccurred, this, &MainWindowController::onAudioError);
         
+        // 插播队列变化时在状态栏提示剩余数量
+        PlayQueue* queue = m_audioEngine->queue();
+        auto showUpNextCount = [this, queue]() {
+            updateStatusBar(QString("待播放队列: %1 首").arg(queue->upNext().size()), 2000);
+        };
+        connect(queue, &PlayQueue::upNextInserted, this, showUpNextCount);
+        connect(queue, &PlayQueue::upNextRemoved, this, showUpNextCount);
+        
         // 注意：MusicProgressBar的更新通过MainWindowController的onPositionChanged和onDurationChanged方法处理
         
         logDebug("AudioEngine信号连接完成");
@@ -1190,111 +1259,72 @@ void MainWindowController::setupConnections()
             if (song.isValid()) {
                 Tag currentTag = getSelectedTag();
                 if (currentTag.isValid()) {
-                    // 使用QTimer::singleShot将数据库操作移到下一个事件循环，避免阻塞主线程
-                    QTimer::singleShot(0, [this, song, currentTag]() {
-                        try {
-                            SongDao songDao;
-                            QList<Song> playlist = songDao.getSongsByTag(currentTag.id());
-                            logInfo(QString("当前标签下歌曲数量：%1").arg(playlist.size()));
-                            
-                            // 回到主线程执行AudioEngine操作
-                            QMetaObject::invokeMethod(this, [this, song, playlist]() {
-                                if (!m_audioEngine) return;
-                                
-                                // 检查是否需要保持播放列表
-                                if (m_shouldKeepPlaylist && !m_lastPlaylist.isEmpty() && !m_playlistChangedByUser) {
-                                    // 在保存的播放列表中查找目标歌曲
+                    // 按来源播放：标签（或切换标签前保存的来源）只描述查询，歌曲ID在播放时分窗口读取
+                    bool found = false;
+                    try {
+                        // 检查是否需要保持播放列表
+                        if (m_shouldKeepPlaylist && !m_playlistChangedByUser) {
+                            if (m_lastQueueSource.type == PlayQueueSource::Type::Songs) {
+                                // 显式列表（如"最近播放"）没有查询来源，按保存的歌曲ID重新读取
+                                if (m_lastPlaylistSongIds.contains(song.id())) {
+                                    SongDao songDao;
+                                    QHash<int, Song> loaded;
+                                    for (const Song& saved : songDao.getSongsByIds(m_lastPlaylistSongIds)) {
+                                        loaded.insert(saved.id(), saved);
+                                    }
+                                    QList<Song> lastPlaylist;
+                                    lastPlaylist.reserve(loaded.size());
                                     int targetIndex = -1;
-                                    for (int i = 0; i < m_lastPlaylist.size(); ++i) {
-                                        if (m_lastPlaylist[i].id() == song.id()) {
-                                            targetIndex = i;
-                                            break;
+                                    for (int songId : m_lastPlaylistSongIds) {
+                                        if (loaded.contains(songId)) {
+                                            if (songId == song.id()) {
+                                                targetIndex = lastPlaylist.size();
+                                            }
+                                            lastPlaylist.append(loaded.value(songId));
                                         }
                                     }
-                                    
                                     if (targetIndex >= 0) {
-                                        // 使用保存的播放列表
-                                        m_audioEngine->setPlaylist(m_lastPlaylist);
+                                        m_audioEngine->setPlaylist(lastPlaylist);
                                         m_audioEngine->setCurrentIndex(targetIndex);
-                                        logInfo(QString("使用保存的播放列表，共%1首歌曲，当前索引: %2").arg(m_lastPlaylist.size()).arg(targetIndex));
-                                    } else {
-                                        // 目标歌曲不在保存的播放列表中，使用当前标签的播放列表
-                                        if (!playlist.isEmpty()) {
-                                            int targetIndex = -1;
-                                            for (int i = 0; i < playlist.size(); ++i) {
-                                                if (playlist[i].id() == song.id()) {
-                                                    targetIndex = i;
-                                                    break;
-                                                }
-                                            }
-                                            if (targetIndex >= 0) {
-                                                m_audioEngine->setPlaylist(playlist);
-                                                m_audioEngine->setCurrentIndex(targetIndex);
-                                                logInfo(QString("设置当前标签播放列表，共%1首歌曲，当前索引: %2").arg(playlist.size()).arg(targetIndex));
-                                            } else {
-                                                QList<Song> singleSongPlaylist = {song};
-                                                m_audioEngine->setPlaylist(singleSongPlaylist);
-                                                m_audioEngine->setCurrentIndex(0);
-                                                logInfo("歌曲不在当前标签中，创建单曲播放列表");
-                                            }
-                                        } else {
-                                            QList<Song> singleSongPlaylist = {song};
-                                            m_audioEngine->setPlaylist(singleSongPlaylist);
-                                            m_audioEngine->setCurrentIndex(0);
-                                            logInfo("当前标签无歌曲，创建单曲播放列表");
-                                        }
-                                    }
-                                } else {
-                                    // 正常播放逻辑
-                                    if (!playlist.isEmpty()) {
-                                        int targetIndex = -1;
-                                        for (int i = 0; i < playlist.size(); ++i) {
-                                            if (playlist[i].id() == song.id()) {
-                                                targetIndex = i;
-                                                break;
-                                            }
-                                        }
-                                        logInfo(QString("目标歌曲索引：%1").arg(targetIndex));
-                                        if (targetIndex >= 0) {
-                                            m_audioEngine->setPlaylist(playlist);
-                                            m_audioEngine->setCurrentIndex(targetIndex);
-                                            logInfo(QString("设置播放列表，共%1首歌曲，当前索引: %2").arg(playlist.size()).arg(targetIndex));
-                                        } else {
-                                            QList<Song> singleSongPlaylist = {song};
-                                            m_audioEngine->setPlaylist(singleSongPlaylist);
-                                            m_audioEngine->setCurrentIndex(0);
-                                            logInfo("歌曲不在当前标签中，创建单曲播放列表");
-                                        }
-                                    } else {
-                                        // 如果当前标签没有歌曲，创建单曲播放列表
-                                        QList<Song> singleSongPlaylist = {song};
-                                        m_audioEngine->setPlaylist(singleSongPlaylist);
-                                        m_audioEngine->setCurrentIndex(0);
-                                        logInfo("当前标签无歌曲，创建单曲播放列表");
+                                        found = true;
                                     }
                                 }
-                                
-                                // 标记用户已主动播放歌曲，重置播放列表保持
-                                m_playlistChangedByUser = true;
-                                m_shouldKeepPlaylist = false;
-                                
-                                qDebug() << "[排查] 调用m_audioEngine->play()前，currentIndex:" << m_audioEngine->currentIndex();
-                                m_audioEngine->play();
-                                logInfo("发送播放请求到AudioEngine");
-                            }, Qt::QueuedConnection);
-                            
-                        } catch (const std::exception& e) {
-                            logError(QString("获取播放列表失败: %1").arg(e.what()));
-                            // 异常情况下也要回到主线程
-                            QMetaObject::invokeMethod(this, [this, song]() {
-                                if (!m_audioEngine) return;
-                                QList<Song> singleSongPlaylist = {song};
-                                m_audioEngine->setPlaylist(singleSongPlaylist);
-                                m_audioEngine->setCurrentIndex(0);
-                                m_audioEngine->play();
-                            }, Qt::QueuedConnection);
+                            } else if (m_lastQueueSource.type != PlayQueueSource::Type::None) {
+                                m_audioEngine->setSource(m_lastQueueSource, song.id());
+                                found = m_audioEngine->currentSong().id() == song.id();
+                            }
+                            if (found) {
+                                logInfo(QString("使用保存的播放列表，共%1首歌曲，当前索引: %2")
+                                        .arg(m_audioEngine->queueSize()).arg(m_audioEngine->currentIndex()));
+                            }
                         }
-                    });
+                        
+                        // 目标歌曲不在保存的播放列表中，使用当前标签
+                        if (!found) {
+                            m_audioEngine->setSource(PlayQueueSource::forTag(currentTag.id()), song.id());
+                            found = m_audioEngine->currentSong().id() == song.id();
+                            if (found) {
+                                logInfo(QString("设置当前标签播放列表，共%1首歌曲，当前索引: %2")
+                                        .arg(m_audioEngine->queueSize()).arg(m_audioEngine->currentIndex()));
+                            }
+                        }
+                    } catch (const std::exception& e) {
+                        logError(QString("获取播放列表失败: %1").arg(e.what()));
+                    }
+                    
+                    if (!found) {
+                        QList<Song> singleSongPlaylist = {song};
+                        m_audioEngine->setPlaylist(singleSongPlaylist);
+                        m_audioEngine->setCurrentIndex(0);
+                        logInfo("歌曲不在当前标签中，创建单曲播放列表");
+                    }
+                    
+                    // 标记用户已主动播放歌曲，重置播放列表保持
+                    m_playlistChangedByUser = true;
+                    m_shouldKeepPlaylist = false;
+                    
+                    m_audioEngine->play();
+                    logInfo("发送播放请求到AudioEngine");
                 } else {
                     QList<Song> singleSongPlaylist = {song};
                     m_audioEngine->setPlaylist(singleSongPlaylist);
@@ -1412,22 +1442,16 @@ void MainWindowController::onCurrentSongChanged(const Song& song)
     if (isActuallyPlaying && song.isValid()) {
         // 场景A：在"最近播放"标签外播放歌曲时
         if (currentTag != "最近播放") {
-            // 立即更新时间戳
-            PlayHistoryDao playHistoryDao;
-            if (playHistoryDao.addPlayRecord(song.id())) {
-                logInfo(QString("场景A：在标签'%1'外播放歌曲 %2，立即更新播放时间").arg(currentTag).arg(song.title()));
-            }
+            // 播放记录由AudioEngine在开始播放时写入，这里不再重复记录（否则播放统计会计两次）
+            logInfo(QString("场景A：在标签'%1'外播放歌曲 %2").arg(currentTag).arg(song.title()));
         }
         // 场景B：在"最近播放"标签内播放歌曲时
         else if (currentTag == "最近播放") {
-            // 立即更新时间戳，但不立即更新排序
-            PlayHistoryDao playHistoryDao;
-            if (playHistoryDao.addPlayRecord(song.id())) {
-                logInfo(QString("场景B：在'最近播放'标签内播放歌曲 %1，更新播放时间但不立即排序").arg(song.title()));
-                
-                // 标记需要延迟排序更新
-                m_needsRecentPlaySortUpdate = true;
-            }
+            // 播放记录由AudioEngine写入，但不立即更新排序
+            logInfo(QString("场景B：在'最近播放'标签内播放歌曲 %1，不立即排序").arg(song.title()));
+            
+            // 标记需要延迟排序更新
+            m_needsRecentPlaySortUpdate = true;
         }
     } else {
         logInfo("歌曲未实际播放，跳过播放记录更新");
@@ -2144,6 +2168,22 @@ void MainWindowController::showSongContextMenu(const QPoint& position)
             }
         });
         
+        // 插播：在当前歌曲之后播放，不改变播放来源；没有正在播放的歌曲时不可用
+        const bool hasCurrentSong = m_audioEngine && m_audioEngine->hasCurrentSong();
+        QAction* playNextAction = contextMenu.addAction("下一首播放");
+        playNextAction->setEnabled(hasCurrentSong);
+        connect(playNextAction, &QAction::triggered, [this, songId, songTitle]() {
+            logInfo(QString("下一首播放: %1").arg(songTitle));
+            m_audioEngine->queue()->playNext({songId});
+        });
+        
+        QAction* addToQueueAction = contextMenu.addAction("添加到播放队列");
+        addToQueueAction->setEnabled(hasCurrentSong);
+        connect(addToQueueAction, &QAction::triggered, [this, songId, songTitle]() {
+            logInfo(QString("添加到播放队列: %1").arg(songTitle));
+            m_audioEngine->queue()->addToQueue({songId});
+        });
+        
         contextMenu.addSeparator();
         
         // 添加到标签
@@ -2273,6 +2313,7 @@ void MainWindowController::showPlaylistContextMenu(const QPoint& position)
 
 void MainWindowController::updateTagList()
 {
+    TRACE_FUNCTION("ui");
     logInfo("开始更新标签列表");
     
     if (!m_tagListWidget) {
@@ -2340,6 +2381,7 @@ void MainWindowController::updateTagList()
         }
         
         logInfo(QString("标签列表更新完成，共 %1 个系统标签，%2 个用户标签").arg(systemTags.size()).arg(userTagCount));
+        m_librarySnapshotDirty = true;
         
     } catch (const std::exception& e) {
         logError(QString("更新标签列表时发生异常: %1").arg(e.what()));
@@ -2350,6 +2392,7 @@ void MainWindowController::updateTagList()
 
 void MainWindowController::updateSongList()
 {
+    TRACE_FUNCTION("ui");
     logInfo("开始更新歌曲列表");
     
     if (!m_songListWidget) {
@@ -2382,21 +2425,21 @@ void MainWindowController::updateSongList()
         } else if (selectedTag == "最近播放") {
             // 特殊处理"最近播放"标签
             logInfo("获取最近播放的歌曲");
+            // 先写入尚在队列中的播放记录，列表中才有刚播放的歌曲
+            PlayHistoryRecorder::instance()->flush(true);
             PlayHistoryDao playHistoryDao;
             songs = playHistoryDao.getRecentPlayedSongs(100);
             logInfo(QString("从播放历史获取到 %1 首歌曲").arg(songs.size()));
             
-            // 调试：打印获取到的歌曲列表
-            logDebug("获取到的歌曲列表:");
+            // 调试：打印获取到的歌曲列表（逐行日志在Release构建中被裁剪）
+            LOGGER_DEBUG("MainWindowController", "获取到的歌曲列表:");
             for (int i = 0; i < songs.size(); ++i) {
                 const Song& song = songs[i];
-                QDateTime playTime = song.lastPlayedTime();
-                QString timeStr = playTime.toString("yyyy/MM-dd/hh-mm-ss");
-                logDebug(QString("  [%1] %2 - %3  %4")
+                LOGGER_DEBUG("MainWindowController", QString("  [%1] %2 - %3  %4")
                             .arg(i + 1)
                             .arg(song.artist())
                             .arg(song.title())
-                            .arg(timeStr));
+                            .arg(song.lastPlayedTime().toString("yyyy/MM-dd/hh-mm-ss")));
             }
         } else {
             // 显示特定标签的歌曲
@@ -2421,7 +2464,7 @@ void MainWindowController::updateSongList()
             logInfo("开始添加最近播放歌曲到UI");
             for (int i = 0; i < songs.size(); ++i) {
                 const auto& song = songs[i];
-                logDebug(QString("添加第%1首歌曲: ID=%2, 标题=%3, 艺术家=%4")
+                LOGGER_DEBUG("MainWindowController", QString("添加第%1首歌曲: ID=%2, 标题=%3, 艺术家=%4")
                             .arg(i + 1)
                             .arg(song.id())
                             .arg(song.title())
@@ -2434,7 +2477,7 @@ void MainWindowController::updateSongList()
                     // 格式："年/月-日/时-分-秒"
                     QString timeStr = lastPlayTime.toString("yyyy/MM-dd/hh-mm-ss");
                     displayText = QString("%1 - %2  %3").arg(song.artist(), song.title(), timeStr);
-                    logDebug(QString("使用歌曲对象中的时间: %1").arg(timeStr));
+                    LOGGER_DEBUG("MainWindowController", QString("使用歌曲对象中的时间: %1").arg(timeStr));
                 } else {
                     // 如果歌曲数据中没有播放时间，则查询数据库
                     PlayHistoryDao playHistoryDao;
@@ -2442,14 +2485,14 @@ void MainWindowController::updateSongList()
                     if (lastPlayTime.isValid()) {
                         QString timeStr = lastPlayTime.toString("yyyy/MM-dd/hh-mm-ss");
                         displayText = QString("%1 - %2  %3").arg(song.artist(), song.title(), timeStr);
-                        logDebug(QString("从数据库查询时间: %1").arg(timeStr));
+                        LOGGER_DEBUG("MainWindowController", QString("从数据库查询时间: %1").arg(timeStr));
                     } else {
                         displayText = QString("%1 - %2").arg(song.artist(), song.title());
                         logWarning("无法获取播放时间");
                     }
                 }
                 
-                logDebug(QString("显示文本: %1").arg(displayText));
+                LOGGER_DEBUG("MainWindowController", QString("显示文本: %1").arg(displayText));
                 
                 QListWidgetItem* item = new QListWidgetItem();
                 item->setText(displayText);
@@ -2465,7 +2508,7 @@ void MainWindowController::updateSongList()
         } else {
             // 对于其他标签，正常处理
             for (const auto& song : songs) {
-                logDebug(QString("添加歌曲: ID=%1, 标题=%2, 艺术家=%3")
+                LOGGER_DEBUG("MainWindowController", QString("添加歌曲: ID=%1, 标题=%2, 艺术家=%3")
                          .arg(song.id())
                          .arg(song.title())
                          .arg(song.artist()));
@@ -2489,6 +2532,7 @@ void MainWindowController::updateSongList()
         updateStatusBar(QString("共 %1 首歌曲").arg(songs.size()), 3000);
         
         logInfo(QString("歌曲列表更新完成，共 %1 首歌曲").arg(songs.size()));
+        m_librarySnapshotDirty = true;
         
     } catch (const std::exception& e) {
         logError(QString("更新歌曲列表时发生异常: %1").arg(e.what()));
@@ -2498,6 +2542,110 @@ void MainWindowController::updateSongList()
     logInfo("歌曲列表更新完成");
 }
 
+bool MainWindowController::restoreLibrarySnapshot()
+{
+    TRACE_FUNCTION("ui");
+    
+    LibrarySnapshotData snapshot;
+    if (!LibrarySnapshot::load(LibrarySnapshot::defaultPath(), &snapshot) || snapshot.tags.isEmpty()) {
+        return false;
+    }
+    
+    m_tagListWidget->clear();
+    int selectedRow = 0;
+    for (const LibrarySnapshotData::TagItem& tag : snapshot.tags) {
+        QListWidgetItem* item = new QListWidgetItem(tag.name);
+        item->setData(Qt::UserRole, tag.id);
+        item->setForeground(tag.color);
+        item->setToolTip(QString("%1: %2").arg(tag.system ? "系统标签" : "用户标签", tag.name));
+        if (tag.id == snapshot.selectedTagId && tag.name == snapshot.selectedTagName) {
+            selectedRow = m_tagListWidget->count();
+        }
+        m_tagListWidget->addItem(item);
+    }
+    m_tagListWidget->setCurrentRow(selectedRow);
+    
+    m_songListWidget->clear();
+    m_songListWidget->setUpdatesEnabled(false);
+    for (const LibrarySnapshotData::SongItem& entry : snapshot.songs) {
+        QListWidgetItem* item = new QListWidgetItem(entry.displayText);
+        item->setData(Qt::UserRole, QVariant::fromValue(entry.song));
+        if (entry.recentPlay) {
+            item->setData(Qt::UserRole + 1, "recent_play");
+        }
+        item->setToolTip(QString("文件: %1\n时长: %2")
+                       .arg(entry.song.filePath())
+                       .arg(QString::number(entry.song.duration())));
+        m_songListWidget->addItem(item);
+    }
+    m_songListWidget->setUpdatesEnabled(true);
+    
+    logInfo(QString("已从快照恢复曲库视图: %1 个标签，%2 首歌曲")
+            .arg(snapshot.tags.size()).arg(snapshot.songs.size()));
+    return true;
+}
+
+void MainWindowController::reconcileLibraryView()
+{
+    TRACE_FUNCTION("ui");
+    if (!m_tagListWidget || !m_songListWidget) {
+        return;
+    }
+    
+    // 刷新标签列表会重置选择，记下快照中查看的标签和滚动位置
+    QListWidgetItem* current = m_tagListWidget->currentItem();
+    const int selectedTagId = current ? current->data(Qt::UserRole).toInt() : -1;
+    const QString selectedTagName = current ? current->text() : QString();
+    const int scrollPosition = m_songListWidget->verticalScrollBar()->value();
+    
+    updateTagList();
+    for (int row = 0; row < m_tagListWidget->count(); ++row) {
+        QListWidgetItem* item = m_tagListWidget->item(row);
+        if (item->data(Qt::UserRole).toInt() == selectedTagId && item->text() == selectedTagName) {
+            m_tagListWidget->setCurrentRow(row);
+            break;
+        }
+    }
+    updateSongList();
+    m_songListWidget->verticalScrollBar()->setValue(scrollPosition);
+}
+
+void MainWindowController::saveLibrarySnapshot()
+{
+    if (!m_librarySnapshotDirty || !m_tagListWidget || !m_songListWidget) {
+        return;
+    }
+    
+    LibrarySnapshotData snapshot;
+    for (int row = 0; row < m_tagListWidget->count(); ++row) {
+        const QListWidgetItem* item = m_tagListWidget->item(row);
+        LibrarySnapshotData::TagItem tag;
+        tag.id = item->data(Qt::UserRole).toInt();
+        tag.name = item->text();
+        tag.color = item->foreground().color();
+        tag.system = Constants::SystemTags::isSystemTag(tag.name);
+        snapshot.tags.append(tag);
+    }
+    if (const QListWidgetItem* current = m_tagListWidget->currentItem()) {
+        snapshot.selectedTagId = current->data(Qt::UserRole).toInt();
+        snapshot.selectedTagName = current->text();
+    }
+    
+    snapshot.songs.reserve(m_songListWidget->count());
+    for (int row = 0; row < m_songListWidget->count(); ++row) {
+        const QListWidgetItem* item = m_songListWidget->item(row);
+        LibrarySnapshotData::SongItem entry;
+        entry.song = item->data(Qt::UserRole).value<Song>();
+        entry.displayText = item->text();
+        entry.recentPlay = item->data(Qt::UserRole + 1).toString() == "recent_play";
+        snapshot.songs.append(entry);
+    }
+    
+    if (LibrarySnapshot::save(LibrarySnapshot::defaultPath(), snapshot)) {
+        m_librarySnapshotDirty = false;
+    }
+}
+
 void MainWindowController::updatePlaybackControls()
 {
     if (!m_audioEngine || !m_mainWindow) return;
@@ -2558,6 +2706,21 @@ void MainWindowController::updateCurrentSongInfo()
     logDebug(QString("当前歌曲是否有效: %1").arg(currentSong.isValid()));
     
     if (currentSong.isValid()) {
+        // 后台预取封面，打开播放界面时可直接从缓存获取
+        CoverArtCache::instance()->prefetch(currentSong);
+        
+        // 波形概览：内存中有则先显示；文件校验、读取旁路文件或生成都在后台进行，
+        // 结果变化时通过overviewReady更新
+        if (m_musicProgressBar) {
+            std::optional<WaveformOverview> overview = WaveformCache::instance()->lookup(currentSong.filePath());
+            if (overview) {
+                m_musicProgressBar->setWaveform(overview->minimums, overview->maximums, overview->peak, overview->rms);
+            } else {
+                m_musicProgressBar->clearWaveform();
+            }
+            WaveformCache::instance()->request(currentSong.filePath());
+        }
+        
         // 使用FFmpeg解析的元数据
         QString artist = currentSong.artist();
         QString title = currentSong.title();
@@ -2720,10 +2883,13 @@ void MainWindowController::handleTagSelectionChange()
             
             if (isTagSwitch) {
                 // 保存当前播放列表状态
-                if (m_audioEngine && !m_audioEngine->playlist().isEmpty()) {
-                    m_lastPlaylist = m_audioEngine->playlist();
+                if (m_audioEngine && m_audioEngine->queueSize() > 0) {
+                    // 只保存来源描述；显式歌曲列表没有查询来源，只保存其歌曲ID
+                    m_lastQueueSource = m_audioEngine->queue()->source();
+                    m_lastPlaylistSongIds = m_lastQueueSource.type == PlayQueueSource::Type::Songs
+                                                ? m_audioEngine->queue()->songIds() : QList<int>();
                     m_shouldKeepPlaylist = true;
-                    logInfo(QString("标签切换，保存播放列表: %1 首歌曲").arg(m_lastPlaylist.size()));
+                    logInfo(QString("标签切换，保存播放列表: %1 首歌曲").arg(m_audioEngine->queueSize()));
                 }
                 
                 // 场景B触发条件1：用户切换到其他标签并播放歌曲
@@ -2873,6 +3039,10 @@ void MainWindowController::addSongs(const QStringList& filePaths, const QMap<QSt
     QList<Song> songs;
     for (const QString& path : filePaths) {
         Song song = Song::fromFile(path);
+        // 已有波形概览时使用解码得到的实测时长，比容器头中的估计准确（如VBR MP3）
+        if (std::optional<WaveformOverview> overview = WaveformCache::instance()->load(path)) {
+            song.setDuration(overview->durationMs);
+        }
         if (song.isValid()) {
             songs.append(song);
         } else {
@@ -3341,6 +3511,7 @@ void MainWindowController::deleteSongFromDatabase(int songId, const QString& son
             // 先删除歌曲与标签的关联
             if (!songDao.removeAllTagsFromSong(songId)) {
                 db.rollback();
+                TagIndex::instance()->invalidate();
                 logError(QString("删除歌曲标签关联失败: %1").arg(songId));
                 QMessageBox::critical(m_mainWindow, "错误", "删除歌曲失败：无法移除标签关联");
                 return;
@@ -3349,6 +3520,7 @@ void MainWindowController::deleteSongFromDatabase(int songId, const QString& son
             // 删除歌曲记录
             if (!songDao.deleteSong(songId)) {
                 db.rollback();
+                TagIndex::instance()->invalidate();
                 logError(QString("删除歌曲记录失败: %1").arg(songId));
                 QMessageBox::critical(m_mainWindow, "错误", "删除歌曲失败：无法删除歌曲记录");
                 return;
@@ -3357,6 +3529,7 @@ void MainWindowController::deleteSongFromDatabase(int songId, const QString& son
             // 提交事务
             if (!db.commit()) {
                 db.rollback();
+                TagIndex::instance()->invalidate();
                 logError(QString("提交删除歌曲事务失败: %1").arg(songId));
                 QMessageBox::critical(m_mainWindow, "错误", "删除歌曲失败：事务提交失败");
                 return;
@@ -3375,6 +3548,7 @@ void MainWindowController::deleteSongFromDatabase(int songId, const QString& son
         if (db.isOpen()) {
             db.rollback();
         }
+        TagIndex::instance()->invalidate(); // 索引已按事务内的删除更新，回滚后重新加载
         
         logError(QString("删除歌曲时发生异常: %1").arg(e.what()));
         QMessageBox::critical(m_mainWindow, "错误", "删除歌曲时发生错误");
@@ -3386,6 +3560,8 @@ bool MainWindowController::deletePlayHistoryRecord(int songId, const QString& so
     logInfo(QString("删除播放记录: 歌曲ID=%1, 标题=%2").arg(songId).arg(songTitle));
     
     try {
+        // 先写入队列中的记录，否则删除后它们又会出现
+        PlayHistoryRecorder::instance()->flush(true);
         PlayHistoryDao playHistoryDao;
         
         // 删除播放记录
@@ -3420,6 +3596,8 @@ void MainWindowController::deleteSelectedPlayHistoryRecords(const QList<QListWid
     int failureCount = 0;
     
     // 直接使用PlayHistoryDao进行批量删除，不显示确认对话框
+    // 先写入队列中的记录，否则删除后它们又会出现
+    PlayHistoryRecorder::instance()->flush(true);
     PlayHistoryDao playHistoryDao;
     
     for (auto item : items) {
@@ -3468,6 +3646,8 @@ void MainWindowController::deleteSelectedPlayHistoryRecordsBySongs(const QList<S
     int failureCount = 0;
     
     // 直接使用PlayHistoryDao进行批量删除，不显示确认对话框
+    // 先写入队列中的记录，否则删除后它们又会出现
+    PlayHistoryRecorder::instance()->flush(true);
     PlayHistoryDao playHistoryDao;
     
     for (const Song& song : songs) {
@@ -3826,7 +4006,7 @@ void MainWindowController::importPlaylistFromFile()
         QString fileName = QFileDialog::getOpenFileName(m_mainWindow, 
             "导入播放列表", 
             QStandardPaths::writableLocation(QStandardPaths::MusicLocation),
-            "播放列表文件 (*.m3u *.m3u8 *.pls *.xspf);;所有文件 (*.*)");
+            "播放列表文件 (*.m3u *.m3u8 *.pls *.xspf *.json);;所有文件 (*.*)");
             
         if (!fileName.isEmpty()) {
             // 检查PlaylistManager是否已初始化
@@ -3836,63 +4016,26 @@ void MainWindowController::importPlaylistFromFile()
                 return;
             }
             
-            // 解析播放列表文件
-            QFileInfo fileInfo(fileName);
-            QString extension = fileInfo.suffix().toLower();
-            
-            QStringList songPaths;
-            QString playlistName = fileInfo.baseName();
-            
-            if (extension == "m3u" || extension == "m3u8") {
-                songPaths = parseM3UPlaylist(fileName);
-            } else if (extension == "pls") {
-                songPaths = parsePLSPlaylist(fileName);
-            } else if (extension == "xspf") {
-                songPaths = parseXSPFPlaylist(fileName);
-            } else {
-                logError(QString("不支持的播放列表格式: %1").arg(extension));
-                QMessageBox::warning(m_mainWindow, "警告", "不支持的播放列表格式");
-                return;
-            }
-            
-            if (songPaths.isEmpty()) {
-                logWarning("播放列表文件中没有找到有效的歌曲路径");
-                QMessageBox::information(m_mainWindow, "信息", "播放列表文件中没有找到有效的歌曲");
-                return;
-            }
-            
-            // 创建播放列表
-            auto result = m_playlistManager->createPlaylist(playlistName, "从文件导入的播放列表");
-            if (!result.success) {
-                logError(QString("创建播放列表失败: %1").arg(result.message));
-                QMessageBox::critical(m_mainWindow, "错误", "创建播放列表失败");
-                return;
-            }
-            
-            Playlist playlist = result.data.value<Playlist>();
-            int successCount = 0;
-            int totalCount = songPaths.size();
-            
-            // 添加歌曲到播放列表
-            for (const QString& songPath : songPaths) {
-                QFileInfo songFileInfo(songPath);
-                if (songFileInfo.exists() && songFileInfo.isFile()) {
-                    // 这里需要先将歌曲添加到数据库，然后再添加到播放列表
-                    // 由于当前架构限制，暂时记录日志
-                    logInfo(QString("找到歌曲文件: %1").arg(songPath));
-                    successCount++;
-                } else {
-                    logWarning(QString("歌曲文件不存在: %1").arg(songPath));
-                }
-            }
-            
-            logInfo(QString("导入播放列表文件: %1，成功解析 %2/%3 首歌曲")
-                   .arg(fileName).arg(successCount).arg(totalCount));
-            updateStatusBar(QString("播放列表导入完成，解析了 %1/%2 首歌曲")
-                           .arg(successCount).arg(totalCount), 3000);
+            // 解析和查找在工作线程进行，界面线程只等待结果
+            QObject* importContext = new QObject(this);
+            connect(m_playlistManager, &PlaylistManager::playlistImported, importContext,
+                    [this, importContext](const Playlist& playlist, int importedCount, int missingCount) {
+                logInfo(QString("导入播放列表: %1，添加 %2 首歌曲，%3 首不在曲库中")
+                       .arg(playlist.name()).arg(importedCount).arg(missingCount));
+                updateStatusBar(QString("播放列表导入完成，添加了 %1 首歌曲，%2 首不在曲库中")
+                               .arg(importedCount).arg(missingCount), 3000);
+                refreshPlaylistView();
+                importContext->deleteLater();
+            });
+            connect(m_playlistManager, &PlaylistManager::playlistImportFailed, importContext,
+                    [this, importContext](const QString& filePath, const QString& error) {
+                logError(QString("导入播放列表失败: %1, %2").arg(filePath, error));
+                QMessageBox::warning(m_mainWindow, "警告", QString("导入播放列表失败: %1").arg(error));
+                importContext->deleteLater();
+            });
             
-            // 刷新播放列表视图
-            refreshPlaylistView();
+            m_playlistManager->importPlaylistAsync(fileName, QFileInfo(fileName).completeBaseName());
+            updateStatusBar("正在导入播放列表...", 0);
         }
         
     } catch (const std::exception& e) {
@@ -3903,6 +4046,7 @@ void MainWindowController::importPlaylistFromFile()
 
 void MainWindowController::refreshPlaylistView()
 {
+    TRACE_FUNCTION("ui");
     logInfo("刷新播放列表视图");
     
     if (!m_playlistManager) {
@@ -3970,140 +4114,20 @@ Tag MainWindowController::getSelectedTag() const
     return tagDao.getTagByName(tagName);
 }
 
-// 播放列表文件解析方法实现
-QStringList MainWindowController::parseM3UPlaylist(const QString& filePath) const
-{
-    QStringList songPaths;
-    QFile file(filePath);
-    
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        const_cast<MainWindowController*>(this)->logError(QString("无法打开M3U播放列表文件: %1").arg(filePath));
-        return songPaths;
-    }
-    
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Utf8);
-    
-    QDir playlistDir = QFileInfo(filePath).absoluteDir();
-    
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        
-        // 跳过注释行和空行
-        if (line.isEmpty() || line.startsWith("#")) {
-            continue;
-        }
-        
-        // 处理相对路径
-        if (QFileInfo(line).isRelative()) {
-            line = playlistDir.absoluteFilePath(line);
-        }
-        
-        // 检查文件是否存在
-        if (QFileInfo::exists(line)) {
-            songPaths.append(QDir::toNativeSeparators(line));
-            const_cast<MainWindowController*>(this)->logDebug(QString("M3U: 找到歌曲文件: %1").arg(line));
-        } else {
-            const_cast<MainWindowController*>(this)->logWarning(QString("M3U: 歌曲文件不存在: %1").arg(line));
-        }
-    }
-    
-    file.close();
-    const_cast<MainWindowController*>(this)->logInfo(QString("M3U播放列表解析完成，共找到 %1 首歌曲").arg(songPaths.size()));
-    return songPaths;
-}
-
-QStringList MainWindowController::parsePLSPlaylist(const QString& filePath) const
+PlayQueueSource MainWindowController::currentListSource() const
 {
-    QStringList songPaths;
-    QFile file(filePath);
-    
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        const_cast<MainWindowController*>(this)->logError(QString("无法打开PLS播放列表文件: %1").arg(filePath));
-        return songPaths;
-    }
-    
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Utf8);
-    
-    QDir playlistDir = QFileInfo(filePath).absoluteDir();
-    
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        
-        // 查找File条目
-        if (line.startsWith("File", Qt::CaseInsensitive)) {
-            int equalPos = line.indexOf('=');
-            if (equalPos > 0) {
-                QString songPath = line.mid(equalPos + 1).trimmed();
-                
-                // 处理相对路径
-                if (QFileInfo(songPath).isRelative()) {
-                    songPath = playlistDir.absoluteFilePath(songPath);
-                }
-                
-                // 检查文件是否存在
-                if (QFileInfo::exists(songPath)) {
-                    songPaths.append(QDir::toNativeSeparators(songPath));
-                    const_cast<MainWindowController*>(this)->logDebug(QString("PLS: 找到歌曲文件: %1").arg(songPath));
-                } else {
-                    const_cast<MainWindowController*>(this)->logWarning(QString("PLS: 歌曲文件不存在: %1").arg(songPath));
-                }
-            }
-        }
-    }
-    
-    file.close();
-    const_cast<MainWindowController*>(this)->logInfo(QString("PLS播放列表解析完成，共找到 %1 首歌曲").arg(songPaths.size()));
-    return songPaths;
-}
-
-QStringList MainWindowController::parseXSPFPlaylist(const QString& filePath) const
-{
-    QStringList songPaths;
-    QFile file(filePath);
-    
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << QString("无法打开XSPF播放列表文件: %1").arg(filePath);
-        return songPaths;
-    }
-    
-    QXmlStreamReader xml(&file);
-    QDir playlistDir = QFileInfo(filePath).absoluteDir();
-    
-    while (!xml.atEnd()) {
-        xml.readNext();
-        
-        if (xml.isStartElement() && xml.name() == QStringLiteral("location")) {
-            QString location = xml.readElementText().trimmed();
-            
-            // 处理file://协议
-            if (location.startsWith("file://")) {
-                location = QUrl(location).toLocalFile();
-            }
-            
-            // 处理相对路径
-            if (QFileInfo(location).isRelative()) {
-                location = playlistDir.absoluteFilePath(location);
-            }
-            
-            // 检查文件是否存在
-            if (QFileInfo::exists(location)) {
-                songPaths.append(QDir::toNativeSeparators(location));
-                const_cast<MainWindowController*>(this)->logDebug(QString("XSPF: 找到歌曲文件: %1").arg(location));
-            } else {
-                const_cast<MainWindowController*>(this)->logWarning(QString("XSPF: 歌曲文件不存在: %1").arg(location));
-            }
-        }
+    const QString tagName = m_tagListWidget && m_tagListWidget->currentItem()
+                                ? m_tagListWidget->currentItem()->text() : QString();
+    if (tagName.isEmpty() || tagName == "全部歌曲") {
+        return PlayQueueSource::library();
     }
-    
-    if (xml.hasError()) {
-        const_cast<MainWindowController*>(this)->logError(QString("XSPF解析错误: %1").arg(xml.errorString()));
+    if (tagName == "最近播放") {
+        // 按播放时间排列的列表没有对应的来源查询
+        return PlayQueueSource();
     }
     
-    file.close();
-    const_cast<MainWindowController*>(this)->logInfo(QString("XSPF播放列表解析完成，共找到 %1 首歌曲").arg(songPaths.size()));
-    return songPaths;
+    const Tag tag = getSelectedTag();
+    return tag.isValid() ? PlayQueueSource::forTag(tag.id()) : PlayQueueSource();
 }
 
 // 播放/暂停切换功能
@@ -4404,6 +4428,17 @@ void MainWindowController::onPlayAllButtonClicked()
         updateStatusBar("当前无可用歌曲", 2000);
         return;
     }
+    // 列表对应查询来源（全部歌曲、标签）时按来源播放，不逐首复制和检查歌曲
+    const PlayQueueSource source = currentListSource();
+    const Song firstSong = m_songListWidget->item(0)->data(Qt::UserRole).value<Song>();
+    if (source.type != PlayQueueSource::Type::None && firstSong.isValid()) {
+        m_audioEngine->setSource(source, firstSong.id(), 0);
+        if (m_audioEngine->hasCurrentSong()) {
+            qDebug() << "[播放控制] 按来源播放，共" << m_audioEngine->queueSize() << "首歌曲";
+            m_audioEngine->play();
+            return;
+        }
+    }
     QList<Song> playlist;
     for (int i = 0; i < m_songListWidget->count(); ++i) {
         if (auto item = m_songListWidget->item(i)) {
@@ -5060,110 +5095,91 @@ void MainWindowController::updatePlaylistAfterDeletion()
         return;
     }
     
-    // 获取当前播放列表和当前歌曲
-    QList<Song> currentPlaylist = m_audioEngine->playlist();
+    // 按查询来源播放时重新建立来源快照，已删除的歌曲不会再被读到
+    PlayQueue* queue = m_audioEngine->queue();
+    const PlayQueueSource::Type sourceType = queue->source().type;
+    if (sourceType != PlayQueueSource::Type::Songs && sourceType != PlayQueueSource::Type::None) {
+        queue->refresh();
+        qDebug() << "[updatePlaylistAfterDeletion] 重新建立播放来源快照，剩余歌曲数量:" << queue->count();
+        
+        if (queue->isEmpty()) {
+            resetPlayerToEmptyState();
+        } else if (m_audioEngine->hasCurrentSong() && !m_audioEngine->currentSong().isValid()) {
+            // 当前播放的歌曲已被删除，播放原位置上的下一首
+            qDebug() << "[updatePlaylistAfterDeletion] 当前播放的歌曲已被删除，播放下一首";
+            m_audioEngine->stop();
+            m_audioEngine->playNext();
+        }
+        return;
+    }
+    
+    // 显式歌曲来源：按ID批量检查仍在曲库中的歌曲，保留下来的歌曲从队列中逐个取出
+    const QList<int> songIds = queue->songIds();
     Song currentSong = m_audioEngine->currentSong();
     int currentIndex = m_audioEngine->currentIndex();
     
-    qDebug() << "[updatePlaylistAfterDeletion] 当前播放列表大小:" << currentPlaylist.size();
+    qDebug() << "[updatePlaylistAfterDeletion] 当前播放列表大小:" << songIds.size();
     qDebug() << "[updatePlaylistAfterDeletion] 当前歌曲索引:" << currentIndex;
     qDebug() << "[updatePlaylistAfterDeletion] 当前歌曲:" << (currentSong.isValid() ? currentSong.title() : "无");
     
     // 检查当前播放列表是否为空
-    if (currentPlaylist.isEmpty()) {
+    if (songIds.isEmpty()) {
         qDebug() << "[updatePlaylistAfterDeletion] 播放列表为空，重置播放器状态";
         resetPlayerToEmptyState();
         return;
     }
     
-    // 检查当前播放的歌曲是否仍然存在于数据库中
-    bool currentSongStillExists = false;
-    if (currentSong.isValid()) {
-        SongDao songDao;
-        Song existingSong = songDao.getSongById(currentSong.id());
-        currentSongStillExists = existingSong.isValid();
-        qDebug() << "[updatePlaylistAfterDeletion] 当前歌曲是否仍存在:" << currentSongStillExists;
+    SongDao songDao;
+    QSet<int> existingIds;
+    for (const Song& song : songDao.getSongsByIds(songIds)) {
+        existingIds.insert(song.id());
     }
     
-    // 如果当前播放的歌曲已被删除
-    if (!currentSongStillExists && currentSong.isValid()) {
-        qDebug() << "[updatePlaylistAfterDeletion] 当前播放的歌曲已被删除，停止播放";
-        
-        // 停止当前播放
-        m_audioEngine->stop();
-        
-        // 从播放列表中移除已删除的歌曲
-        QList<Song> updatedPlaylist;
-        for (const Song& song : currentPlaylist) {
-            SongDao songDao;
-            Song existingSong = songDao.getSongById(song.id());
-            if (existingSong.isValid()) {
-                updatedPlaylist.append(song);
-            } else {
-                qDebug() << "[updatePlaylistAfterDeletion] 从播放列表中移除已删除的歌曲:" << song.title();
-            }
+    if (existingIds.size() == songIds.size()) {
+        qDebug() << "[updatePlaylistAfterDeletion] 播放列表无变化";
+        qDebug() << "[updatePlaylistAfterDeletion] 播放列表更新完成";
+        return;
+    }
+    
+    QList<Song> updatedPlaylist;
+    updatedPlaylist.reserve(existingIds.size());
+    int newIndex = -1;
+    for (int position = 0; position < songIds.size(); ++position) {
+        const int songId = songIds.at(position);
+        if (!existingIds.contains(songId)) {
+            qDebug() << "[updatePlaylistAfterDeletion] 从播放列表中移除已删除的歌曲 ID:" << songId;
+            continue;
         }
-        
-        // 更新播放列表
-        if (!updatedPlaylist.isEmpty()) {
-            qDebug() << "[updatePlaylistAfterDeletion] 更新播放列表，剩余歌曲数量:" << updatedPlaylist.size();
-            m_audioEngine->setPlaylist(updatedPlaylist);
-            
-            // 自动播放第一首歌曲
-            m_audioEngine->setCurrentIndex(0);
-            m_audioEngine->play();
-            qDebug() << "[updatePlaylistAfterDeletion] 自动播放第一首歌曲:" << updatedPlaylist.first().title();
-        } else {
-            qDebug() << "[updatePlaylistAfterDeletion] 播放列表为空，重置播放器状态";
-            resetPlayerToEmptyState();
+        if (songId == currentSong.id()) {
+            newIndex = updatedPlaylist.size();
         }
+        updatedPlaylist.append(queue->songAt(position));
+    }
+    
+    qDebug() << "[updatePlaylistAfterDeletion] 原播放列表大小:" << songIds.size()
+             << "，新播放列表大小:" << updatedPlaylist.size();
+    
+    if (updatedPlaylist.isEmpty()) {
+        qDebug() << "[updatePlaylistAfterDeletion] 更新后的播放列表为空，重置播放器状态";
+        resetPlayerToEmptyState();
+        return;
+    }
+    
+    const bool currentSongDeleted = currentSong.isValid() && !existingIds.contains(currentSong.id());
+    if (currentSongDeleted) {
+        // 当前播放的歌曲已被删除，停止后从第一首开始播放
+        qDebug() << "[updatePlaylistAfterDeletion] 当前播放的歌曲已被删除，停止播放";
+        m_audioEngine->stop();
+    }
+    
+    m_audioEngine->setPlaylist(updatedPlaylist);
+    if (!currentSongDeleted && newIndex >= 0) {
+        m_audioEngine->setCurrentIndex(newIndex);
+        qDebug() << "[updatePlaylistAfterDeletion] 更新播放列表，当前歌曲新索引:" << newIndex;
     } else {
-        // 当前歌曲仍然存在，但需要检查播放列表中是否有其他歌曲被删除
-        QList<Song> updatedPlaylist;
-        for (const Song& song : currentPlaylist) {
-            SongDao songDao;
-            Song existingSong = songDao.getSongById(song.id());
-            if (existingSong.isValid()) {
-                updatedPlaylist.append(song);
-            } else {
-                qDebug() << "[updatePlaylistAfterDeletion] 从播放列表中移除已删除的歌曲:" << song.title();
-            }
-        }
-        
-        // 如果播放列表有变化，更新播放列表
-        if (updatedPlaylist.size() != currentPlaylist.size()) {
-            qDebug() << "[updatePlaylistAfterDeletion] 播放列表有变化，更新播放列表";
-            qDebug() << "[updatePlaylistAfterDeletion] 原播放列表大小:" << currentPlaylist.size() 
-                     << "，新播放列表大小:" << updatedPlaylist.size();
-            
-            if (!updatedPlaylist.isEmpty()) {
-                // 找到当前歌曲在新播放列表中的位置
-                int newIndex = -1;
-                for (int i = 0; i < updatedPlaylist.size(); ++i) {
-                    if (updatedPlaylist[i].id() == currentSong.id()) {
-                        newIndex = i;
-                        break;
-                    }
-                }
-                
-                if (newIndex >= 0) {
-                    m_audioEngine->setPlaylist(updatedPlaylist);
-                    m_audioEngine->setCurrentIndex(newIndex);
-                    qDebug() << "[updatePlaylistAfterDeletion] 更新播放列表，当前歌曲新索引:" << newIndex;
-                } else {
-                    // 当前歌曲不在新播放列表中，播放第一首
-                    m_audioEngine->setPlaylist(updatedPlaylist);
-                    m_audioEngine->setCurrentIndex(0);
-                    m_audioEngine->play();
-                    qDebug() << "[updatePlaylistAfterDeletion] 当前歌曲不在新播放列表中，播放第一首";
-                }
-            } else {
-                qDebug() << "[updatePlaylistAfterDeletion] 更新后的播放列表为空，重置播放器状态";
-                resetPlayerToEmptyState();
-            }
-        } else {
-            qDebug() << "[updatePlaylistAfterDeletion] 播放列表无变化";
-        }
+        m_audioEngine->setCurrentIndex(0);
+        m_audioEngine->play();
+        qDebug() << "[updatePlaylistAfterDeletion] 自动播放第一首歌曲:" << updatedPlaylist.first().title();
     }
     
     qDebug() << "[updatePlaylistAfterDeletion] 播放列表更新完成";
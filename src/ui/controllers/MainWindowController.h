@@ -64,6 +64,7 @@ class MusicProgressBar;
 #include "../../threading/mainthreadmanager.h"
 #include "../../audio/audiotypes.h"
 #include "../../database/playhistorydao.h"
+#include "../../managers/playqueue.h"
 
 // 主窗口状态枚举
 enum class MainWindowState {
@@ -127,6 +128,7 @@ public:
     void selectTag(const QString& tagName);
     Tag getSelectedTag() const;
     QList<Tag> getSelectedTags() const;
+    PlayQueueSource currentListSource() const;  // 当前歌曲列表对应的查询来源，没有时为None
     
     // 歌曲管理
     void refreshSongList();
@@ -399,7 +401,8 @@ private:
     
     // 播放列表保持相关
     QString m_lastActiveTag;           // 上次活跃的标签
-    QList<Song> m_lastPlaylist;        // 上次的播放列表
+    PlayQueueSource m_lastQueueSource; // 上次的播放来源
+    QList<int> m_lastPlaylistSongIds;  // 上次的播放列表歌曲ID（仅显式歌曲来源）
     bool m_playlistChangedByUser;      // 用户是否主动改变了播放列表
     bool m_shouldKeepPlaylist;         // 是否应该保持播放列表
     
@@ -456,6 +459,10 @@ private:
     // 定时器
     QTimer* m_updateTimer;
     QTimer* m_statusTimer;
+    QTimer* m_librarySnapshotTimer;
+    
+    // 曲库视图快照
+    bool m_librarySnapshotDirty;
     
     // 线程安全
     QMutex m_mutex;
@@ -475,6 +482,11 @@ private:
     // UI更新
     void updateTagList();
     void updateSongList();
+    
+    // 曲库视图快照：启动时先显示上次的列表，再与数据库同步
+    bool restoreLibrarySnapshot();
+    void saveLibrarySnapshot();
+    void reconcileLibraryView();
     void updatePlaybackControls();
     void updateVolumeControls();
     void updateProgressControls();
@@ -553,11 +565,6 @@ private:
     bool validateTagName(const QString& name) const;
     bool validatePlaylistName(const QString& name) const;
     
-    // 播放列表文件解析方法
-    QStringList parseM3UPlaylist(const QString& filePath) const;
-    QStringList parsePLSPlaylist(const QString& filePath) const;
-    QStringList parseXSPFPlaylist(const QString& filePath) const;
-    
     // 常量
     static const int UPDATE_INTERVAL = 100; // 100ms
     static const int STATUS_TIMEOUT = 5000; // 5秒
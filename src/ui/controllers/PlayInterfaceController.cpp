@@ -1,8 +1,10 @@
 #include "PlayInterfaceController.h"
 #include "../../audio/audioengine.h"
+#include "../../managers/coverartcache.h"
 
 // 定义静态常量
 const int PlayInterfaceController::UPDATE_INTERVAL = 100;  // ms
+const QSize PlayInterfaceController::COVER_SIZE(350, 350);
 
 PlayInterfaceController::PlayInterfaceController(PlayInterface* interface, QObject* parent)
     : QObject(parent)
@@ -272,14 +274,10 @@ void PlayInterfaceController::loadSongInfo(const Song& song)
         m_interface->setSongArtist(updatedSong.artist());
         m_interface->setSongAlbum(updatedSong.album());
         
-        // 提取并显示封面
-        QPixmap coverPixmap = Song::extractCoverArt(song.filePath(), QSize(350, 350));
-        if (!coverPixmap.isNull()) {
-            m_interface->setSongCover(coverPixmap);
-        } else {
-            // 如果没有封面，显示默认图片或清空
-            m_interface->setSongCover(QPixmap());
-        }
+        // 从封面缓存获取；未缓存时先清空，后台解码完成后由onCoverReady更新
+        m_coverKey = CoverArtCache::albumKey(song);
+        QPixmap coverPixmap = CoverArtCache::instance()->cover(song, COVER_SIZE);
+        m_interface->setSongCover(coverPixmap);
         
         logInfo(QString("Loaded song info for: %1 - %2").arg(updatedSong.artist(), updatedSong.title()));
         
@@ -290,6 +288,16 @@ void PlayInterfaceController::loadSongInfo(const Song& song)
     }
 }
 
+void PlayInterfaceController::onCoverReady(const QString& filePath, const QString& albumKey, bool hasCover)
+{
+    // 只处理当前歌曲所属专辑的封面
+    if (!m_interface || !hasCover || albumKey != m_coverKey) {
+        return;
+    }
+    
+    m_interface->setSongCover(CoverArtCache::instance()->cover(albumKey, filePath, COVER_SIZE));
+}
+
 // 槽函数实现
 void PlayInterfaceController::onUpdateTimer()
 {
@@ -385,6 +393,10 @@ void PlayInterfaceController::setupConnections()
             logError("Update timer is null");
         }
         
+        // 连接封面缓存信号
+        connect(CoverArtCache::instance(), &CoverArtCache::coverReady,
+                this, &PlayInterfaceController::onCoverReady, Qt::UniqueConnection);
+        
         // 连接AudioEngine信号
         if (m_audioEngine) {
             // 连接AudioEngine状态变化信号
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QTimer>
 #include <QMutex>
+#include <QSize>
 #include <QDebug>
 #include "../../audio/audiotypes.h"
 #include "../../models/song.h"
@@ -44,6 +45,7 @@ class PlayInterfaceController : public QObject
 public:
     // 静态常量
     static const int UPDATE_INTERVAL;  // 更新间隔（毫秒）
+    static const QSize COVER_SIZE;     // 封面显示尺寸
 
     explicit PlayInterfaceController(PlayInterface* interface, QObject* parent = nullptr);
     ~PlayInterfaceController();
@@ -112,6 +114,9 @@ private slots:
 
     // 定时器事件
     void onUpdateTimer();
+    
+    // 封面缓存事件
+    void onCoverReady(const QString& filePath, const QString& albumKey, bool hasCover);
 
 private:
     void setupConnections();
@@ -139,6 +144,7 @@ private:
     
     // 当前状态
     Song m_currentSong;
+    QString m_coverKey;  // 当前显示封面的缓存键
     bool m_isPlaying;
     bool m_isPaused;
     bool m_isMuted;
@@ -4,6 +4,7 @@
 #include "../widgets/taglistitem.h"
 #include "../../database/tagdao.h"
 #include "../../database/songdao.h"
+#include "../../database/tagindex.h"
 #include "../../models/tag.h"
 #include "../../models/song.h"
 #include <QSqlQuery>
@@ -793,12 +794,14 @@ void ManageTagDialog::commitAllOperations()
         if (!db.commit()) {
             QMessageBox::critical(this, tr("数据库错误"), tr("提交事务失败，所有更改已回滚！"));
             db.rollback();
+            TagIndex::instance()->invalidate(); // 索引已按事务内的写入更新，回滚后重新加载
         } else {
             m_operationStack.clear();
             QMessageBox::information(this, tr("保存成功"), tr("所有更改已保存。"));
         }
     } else {
         db.rollback();
+        TagIndex::instance()->invalidate();
         QMessageBox::critical(this, tr("数据库错误"), tr("保存过程中发生错误，所有更改已回滚！"));
     }
 }
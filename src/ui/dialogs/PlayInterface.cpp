@@ -3,7 +3,10 @@
 #include "../controllers/playinterfacecontroller.h"
 #include "../widgets/musicprogressbar.h"
 #include "../../audio/audioengine.h"
+#include "../../audio/waveformcache.h"
+#include "../../threading/mainthreadmanager.h"
 #include <QProgressBar>
+#include <QPointer>
 
 PlayInterface::PlayInterface(QWidget *parent)
     : QDialog(parent)
@@ -179,6 +182,8 @@ void PlayInterface::setAudioEngine(AudioEngine* audioEngine)
             setSongTitle(song.title());
             setSongArtist(song.artist());
             setSongAlbum(song.album());
+            showCachedWaveform(song.filePath());
+            WaveformCache::instance()->request(song.filePath());
         });
         
         // 添加播放模式同步
@@ -199,6 +204,8 @@ void PlayInterface::setAudioEngine(AudioEngine* audioEngine)
             setSongTitle(currentSong.title());
             setSongArtist(currentSong.artist());
             setSongAlbum(currentSong.album());
+            showCachedWaveform(currentSong.filePath());
+            WaveformCache::instance()->request(currentSong.filePath());
         }
         
         // 同步播放模式
@@ -544,7 +551,7 @@ void PlayInterface::onPlayPauseClicked()
     
     // 采用与主界面相同的逻辑
     AudioTypes::AudioState currentState = m_audioEngine->state();
-    int playlistSize = m_audioEngine->playlist().size();
+    int playlistSize = m_audioEngine->queueSize();
     int currentIndex = m_audioEngine->currentIndex();
     
     qDebug() << "PlayInterface: 当前音频状态:" << static_cast<int>(currentState);
@@ -552,7 +559,7 @@ void PlayInterface::onPlayPauseClicked()
     qDebug() << "PlayInterface: 当前播放索引:" << currentIndex;
     
     // 首先检查播放列表是否为空或索引无效
-    if (playlistSize == 0 || currentIndex < 0) {
+    if (playlistSize == 0 || !m_audioEngine->hasCurrentSong()) {
         qDebug() << "PlayInterface: 播放列表为空，显示提示";
         // 这里应该触发主界面的 startNewPlayback 逻辑
         // 但由于播放界面独立，只能显示提示
@@ -627,14 +634,14 @@ void PlayInterface::onNextClicked()
     }
     
     // 检查播放列表是否为空或当前索引无效
-    int playlistSize = m_audioEngine->playlist().size();
+    int playlistSize = m_audioEngine->queueSize();
     int currentIndex = m_audioEngine->currentIndex();
     
     qDebug() << "PlayInterface: 播放列表大小:" << playlistSize;
     qDebug() << "PlayInterface: 当前索引:" << currentIndex;
     
     // 如果播放列表为空或索引无效
-    if (playlistSize == 0 || currentIndex < 0) {
+    if (playlistSize == 0 || !m_audioEngine->hasCurrentSong()) {
         qDebug() << "PlayInterface: 播放列表为空，显示提示";
         emit nextClicked(); // 发送信号让主界面处理
         return;
@@ -654,14 +661,14 @@ void PlayInterface::onPreviousClicked()
     }
     
     // 检查播放列表是否为空或当前索引无效
-    int playlistSize = m_audioEngine->playlist().size();
+    int playlistSize = m_audioEngine->queueSize();
     int currentIndex = m_audioEngine->currentIndex();
     
     qDebug() << "PlayInterface: 播放列表大小:" << playlistSize;
     qDebug() << "PlayInterface: 当前索引:" << currentIndex;
     
     // 如果播放列表为空或索引无效
-    if (playlistSize == 0 || currentIndex < 0) {
+    if (playlistSize == 0 || !m_audioEngine->hasCurrentSong()) {
         qDebug() << "PlayInterface: 播放列表为空，显示提示";
         emit previousClicked(); // 发送信号让主界面处理
         return;
@@ -806,7 +813,26 @@ void PlayInterface::setupUI()
 
 void PlayInterface::setupVisualization()
 {
-    // 实现将在后续添加
+    // 后台生成或重新校验的波形完成后，若仍是当前歌曲则刷新进度条上的波形
+    connect(WaveformCache::instance(), &WaveformCache::overviewReady, this, [this](const QString& filePath) {
+        if (m_audioEngine && m_audioEngine->currentSong().filePath() == filePath) {
+            showCachedWaveform(filePath);
+        }
+    });
+}
+
+void PlayInterface::showCachedWaveform(const QString& filePath)
+{
+    if (!m_customProgressBar) {
+        return;
+    }
+    // lookup()只查内存；request()在生成线程校验文件并在需要时读取或生成
+    std::optional<WaveformOverview> overview = WaveformCache::instance()->lookup(filePath);
+    if (overview) {
+        m_customProgressBar->setWaveform(overview->minimums, overview->maximums, overview->peak, overview->rms);
+    } else {
+        m_customProgressBar->clearWaveform();
+    }
 }
 
 void PlayInterface::updateTimeDisplay()
@@ -920,7 +946,17 @@ QString PlayInterface::formatTime(qint64 milliseconds) const
 void PlayInterface::updateVUMeterLevels(const QVector<double>& levels)
 {
     m_vuLevels = levels;
-    updateVUMeterDisplay();
+    
+    // 电平按解码节奏到达，合并后每帧最多重绘一次
+    QPointer<PlayInterface> guard(this);
+    MainThreadManager::instance()->scheduleCoalescedUIUpdate(
+        QString("vu:%1").arg(reinterpret_cast<quintptr>(this), 0, 16),
+        [guard]() {
+            if (guard) {
+                guard->updateVUMeterDisplay();
+            }
+        },
+        "PlayInterface VU");
 }
 
 void PlayInterface::updateVUMeterDisplay()
@@ -137,6 +137,7 @@ private:
     void updateLyricDisplay();
     void updateBalanceDisplay();
     void updateVUMeterDisplay();
+    void showCachedWaveform(const QString& filePath); // 在自定义进度条上显示缓存的波形概览
     QString formatTime(qint64 milliseconds) const;
 
 private:
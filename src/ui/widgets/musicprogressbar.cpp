@@ -124,8 +124,30 @@ void PreciseSlider::mouseReleaseEvent(QMouseEvent *event)
 
 void PreciseSlider::paintEvent(QPaintEvent *event)
 {
-    // 先调用基类的绘制方法
-    QSlider::paintEvent(event);
+    if (hasWaveform()) {
+        // 波形模式：绘制预渲染的波形，已播放部分使用高亮图像
+        if (m_waveformPixmapSize != size()) {
+            renderWaveform();
+        }
+        
+        QPainter painter(this);
+        const int range = maximum() - minimum();
+        const double ratio = range > 0 ? static_cast<double>(value() - minimum()) / range : 0.0;
+        const int playedX = static_cast<int>(std::clamp(ratio, 0.0, 1.0) * width());
+        
+        painter.drawPixmap(0, 0, m_waveformPixmap);
+        painter.save();
+        painter.setClipRect(0, 0, playedX, height());
+        painter.drawPixmap(0, 0, m_waveformPlayedPixmap);
+        painter.restore();
+        
+        // 播放位置指示线
+        painter.setPen(QPen(QColor(0, 90, 180), 2));
+        painter.drawLine(playedX, 0, playedX, height());
+    } else {
+        // 先调用基类的绘制方法
+        QSlider::paintEvent(event);
+    }
     
     // 如果正在拖拽且有有效的预览位置，绘制预览
     if (m_isDragging && m_dragPreviewPosition >= 0 && m_duration > 0) {
@@ -199,6 +221,90 @@ void PreciseSlider::setDuration(qint64 duration)
     m_duration = duration;
 }
 
+void PreciseSlider::setWaveform(const QVector<qint8>& minimums, const QVector<qint8>& maximums,
+                                float peak, float rms)
+{
+    m_waveformMinimums = minimums;
+    m_waveformMaximums = maximums;
+    m_waveformPeak = peak;
+    m_waveformRms = rms;
+    m_waveformPixmapSize = QSize();
+    setMinimumHeight(hasWaveform() ? 28 : 0);
+    update();
+}
+
+void PreciseSlider::clearWaveform()
+{
+    m_waveformMinimums.clear();
+    m_waveformMaximums.clear();
+    m_waveformPixmap = QPixmap();
+    m_waveformPlayedPixmap = QPixmap();
+    m_waveformPixmapSize = QSize();
+    setMinimumHeight(0);
+    update();
+}
+
+bool PreciseSlider::hasWaveform() const
+{
+    return !m_waveformMaximums.isEmpty() && m_waveformMinimums.size() == m_waveformMaximums.size();
+}
+
+void PreciseSlider::renderWaveform()
+{
+    // 尺寸变化时才重新渲染，绘制时只需贴图
+    m_waveformPixmapSize = size();
+    const qreal ratio = devicePixelRatioF();
+    const int pixelWidth = qMax(1, qRound(width() * ratio));
+    const int pixelHeight = qMax(1, qRound(height() * ratio));
+    
+    m_waveformPixmap = QPixmap(pixelWidth, pixelHeight);
+    m_waveformPlayedPixmap = QPixmap(pixelWidth, pixelHeight);
+    m_waveformPixmap.fill(Qt::transparent);
+    m_waveformPlayedPixmap.fill(Qt::transparent);
+    
+    QPainter unplayedPainter(&m_waveformPixmap);
+    QPainter playedPainter(&m_waveformPlayedPixmap);
+    unplayedPainter.setPen(QColor(170, 170, 170));
+    playedPainter.setPen(QColor(0, 120, 215));
+    
+    // 每个像素列合并对应范围内桶的min/max
+    const int bucketCount = m_waveformMaximums.size();
+    const double centerY = pixelHeight / 2.0;
+    // 按峰值归一化，音量小的曲目也占满高度；峰值过小（接近静音）时不放大噪声
+    const double peakLevel = std::clamp(static_cast<double>(m_waveformPeak), 0.05, 1.0);
+    const double scale = (pixelHeight / 2.0 - 1.0) / (127.0 * peakLevel);
+    for (int x = 0; x < pixelWidth; ++x) {
+        const int begin = static_cast<int>(static_cast<qint64>(x) * bucketCount / pixelWidth);
+        const int end = qMax(begin + 1, static_cast<int>(static_cast<qint64>(x + 1) * bucketCount / pixelWidth));
+        int minimum = m_waveformMinimums[begin];
+        int maximum = m_waveformMaximums[begin];
+        for (int i = begin + 1; i < end && i < bucketCount; ++i) {
+            minimum = qMin(minimum, int(m_waveformMinimums[i]));
+            maximum = qMax(maximum, int(m_waveformMaximums[i]));
+        }
+        const int top = qMax(0, qRound(centerY - maximum * scale));
+        const int bottom = qMin(pixelHeight - 1, qMax(top + 1, qRound(centerY - minimum * scale)));
+        unplayedPainter.drawLine(x, top, x, bottom);
+        playedPainter.drawLine(x, top, x, bottom);
+    }
+    
+    // RMS电平参考线：波形大部分时间落在两线之间
+    if (m_waveformRms > 0.0f) {
+        const double offset = m_waveformRms * 127.0 * scale;
+        const int rmsTop = qMax(0, qRound(centerY - offset));
+        const int rmsBottom = qMin(pixelHeight - 1, qRound(centerY + offset));
+        unplayedPainter.setPen(QColor(120, 120, 120, 140));
+        playedPainter.setPen(QColor(0, 80, 160, 140));
+        unplayedPainter.drawLine(0, rmsTop, pixelWidth, rmsTop);
+        unplayedPainter.drawLine(0, rmsBottom, pixelWidth, rmsBottom);
+        playedPainter.drawLine(0, rmsTop, pixelWidth, rmsTop);
+        playedPainter.drawLine(0, rmsBottom, pixelWidth, rmsBottom);
+    }
+    
+    m_waveformPixmap.setDevicePixelRatio(ratio);
+    m_waveformPlayedPixmap.setDevicePixelRatio(ratio);
+}
+
 // 已移除onDragTimerTimeout方法，因为使用paintEvent实现拖拽预览
 
 bool PreciseSlider::eventFilter(QObject *obj, QEvent *event)
@@ -486,6 +592,25 @@ void MusicProgressBar::setTimeLabelsStyle(const QString& style)
     }
 }
 
+void MusicProgressBar::setWaveform(const QVector<qint8>& minimums, const QVector<qint8>& maximums,
+                                   float peak, float rms)
+{
+    QMetaObject::invokeMethod(this, [this, minimums, maximums, peak, rms]() {
+        if (m_slider) {
+            m_slider->setWaveform(minimums, maximums, peak, rms);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void MusicProgressBar::clearWaveform()
+{
+    QMetaObject::invokeMethod(this, [this]() {
+        if (m_slider) {
+            m_slider->clearWaveform();
+        }
+    }, Qt::QueuedConnection);
+}
+
 void MusicProgressBar::reset()
 {
     QMutexLocker locker(&m_mutex);
@@ -13,6 +13,8 @@
 #include <QToolTip>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QPixmap>
+#include <QVector>
 
 /**
  * @brief 精确滑块组件
@@ -29,6 +31,12 @@ public:
     // 设置时长（供外部调用）
     void setDuration(qint64 duration);
     
+    // 波形概览（设置后以波形代替滑槽绘制）；按峰值归一化高度，RMS电平画为参考线
+    void setWaveform(const QVector<qint8>& minimums, const QVector<qint8>& maximums,
+                     float peak = 1.0f, float rms = 0.0f);
+    void clearWaveform();
+    bool hasWaveform() const;
+    
     // 重写鼠标事件处理（改为public以便外部调用）
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
@@ -50,6 +58,17 @@ private:
     bool m_isDragging;              // 是否正在拖拽
     qint64 m_duration;              // 总时长（毫秒）
     qint64 m_dragPreviewPosition;   // 拖拽预览位置（用于绘制）
+    
+    // 波形数据及按当前尺寸预渲染的图像
+    QVector<qint8> m_waveformMinimums;
+    QVector<qint8> m_waveformMaximums;
+    float m_waveformPeak = 1.0f;     // 峰值（0.0-1.0）
+    float m_waveformRms = 0.0f;      // 均方根电平（0.0-1.0），0表示不绘制
+    QPixmap m_waveformPixmap;        // 未播放部分
+    QPixmap m_waveformPlayedPixmap;  // 已播放部分
+    QSize m_waveformPixmapSize;
+    void renderWaveform();
+    
     // 精确位置计算
     qint64 positionFromMouseX(int x) const;
     void updatePositionFromMouse(const QPoint& pos);
@@ -95,6 +114,11 @@ public:
     // 重置进度条
     void reset();
     
+    // 设置/清除波形概览（min/max，取值-127~127；peak/rms取自WaveformOverview）
+    void setWaveform(const QVector<qint8>& minimums, const QVector<qint8>& maximums,
+                     float peak = 1.0f, float rms = 0.0f);
+    void clearWaveform();
+    
 protected:
     // 事件处理
     void mousePressEvent(QMouseEvent *event) override;
@@ -0,0 +1,141 @@
+/**
+ * @file benchmark_cache.cpp
+ * @brief 缓存并发性能对比测试
+ * @details 多线程下对比旧的Cache<K,V>模板与ShardedCache的吞吐量和命中率。
+ *          访问模式为热点偏斜分布（约80%请求落在20%的键上），读写比为9:1。
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QByteArray>
+#include <QVector>
+#include <thread>
+#include <vector>
+#include <functional>
+
+#include "../src/core/cache.h"
+#include "../src/core/shardedcache.h"
+
+namespace {
+
+const int KEY_SPACE = 20000;
+const int CACHE_CAPACITY = 2000;
+const int OPERATIONS_PER_THREAD = 200000;
+
+/**
+ * @brief 生成偏斜分布的键序列
+ */
+QVector<int> generateKeys(int count, quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    QVector<int> keys;
+    keys.reserve(count);
+    const int hotKeys = KEY_SPACE / 5;
+    for (int i = 0; i < count; ++i) {
+        if (rng.bounded(100) < 80) {
+            keys.append(rng.bounded(hotKeys));
+        } else {
+            keys.append(hotKeys + rng.bounded(KEY_SPACE - hotKeys));
+        }
+    }
+    return keys;
+}
+
+/**
+ * @brief 多线程执行并返回每秒操作数
+ */
+double runThreads(int threadCount, const std::function<void(const QVector<int>&)>& worker)
+{
+    QVector<QVector<int>> keySets;
+    for (int t = 0; t < threadCount; ++t) {
+        keySets.append(generateKeys(OPERATIONS_PER_THREAD, 1234u + t));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&worker, &keySets, t]() { worker(keySets[t]); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+    return static_cast<double>(threadCount) * OPERATIONS_PER_THREAD * 1e9 / elapsedNs;
+}
+
+// 旧Cache在每次put/淘汰时输出qDebug，测试期间屏蔽调试输出，只测量数据结构本身
+void quietMessageHandler(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+    if (type != QtDebugMsg) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QVector<int> threadCounts = {1, 2, 4, 8};
+    const QByteArray payload(256, 'x');
+
+    for (int threadCount : threadCounts) {
+        // 旧的全局锁缓存
+        QtMessageHandler previousHandler = qInstallMessageHandler(quietMessageHandler);
+        Cache<int, QByteArray> legacyCache(CACHE_CAPACITY, 3600000);
+        const double legacyOps = runThreads(threadCount, [&legacyCache, &payload](const QVector<int>& keys) {
+            for (int i = 0; i < keys.size(); ++i) {
+                if (i % 10 == 0) {
+                    legacyCache.put(keys[i], payload);
+                } else if (!legacyCache.get(keys[i])) {
+                    legacyCache.put(keys[i], payload);
+                }
+            }
+        });
+        const double legacyHitRate = legacyCache.hitRate();
+        qInstallMessageHandler(previousHandler);
+
+        // 分片LRU缓存
+        ShardedCache<int, QByteArray> shardedCache(CACHE_CAPACITY);
+        shardedCache.setSizeFunction([](const QByteArray& value) { return static_cast<qint64>(value.size()); });
+        const double shardedOps = runThreads(threadCount, [&shardedCache, &payload](const QVector<int>& keys) {
+            for (int i = 0; i < keys.size(); ++i) {
+                if (i % 10 == 0) {
+                    shardedCache.put(keys[i], payload);
+                } else if (!shardedCache.get(keys[i])) {
+                    shardedCache.put(keys[i], payload);
+                }
+            }
+        });
+
+        // 分片LRU缓存 + TinyLFU准入
+        ShardedCache<int, QByteArray> admissionCache(CACHE_CAPACITY);
+        admissionCache.setAdmissionPolicyEnabled(true);
+        const double admissionOps = runThreads(threadCount, [&admissionCache, &payload](const QVector<int>& keys) {
+            for (int i = 0; i < keys.size(); ++i) {
+                if (i % 10 == 0) {
+                    admissionCache.put(keys[i], payload);
+                } else if (!admissionCache.get(keys[i])) {
+                    admissionCache.put(keys[i], payload);
+                }
+            }
+        });
+
+        qDebug() << QString("线程数 %1:").arg(threadCount);
+        qDebug() << QString("  Cache<K,V>          %1 ops/s, 命中率 %2%")
+                    .arg(legacyOps, 0, 'f', 0).arg(legacyHitRate * 100, 0, 'f', 2);
+        qDebug() << QString("  ShardedCache        %1 ops/s, 命中率 %2%")
+                    .arg(shardedOps, 0, 'f', 0).arg(shardedCache.hitRate() * 100, 0, 'f', 2);
+        qDebug() << QString("  ShardedCache+LFU    %1 ops/s, 命中率 %2%")
+                    .arg(admissionOps, 0, 'f', 0).arg(admissionCache.hitRate() * 100, 0, 'f', 2);
+        qDebug() << "  " << shardedCache.getStatistics();
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file benchmark_logging.cpp
+ * @brief 解码循环日志开销对比测试
+ * @details 模拟FFmpegDecoder::processAudioFrame的逐帧处理（平衡控制+电平计算），
+ *          每帧记录一条调试日志，对比以下情况的每帧耗时：
+ *          1. 无日志
+ *          2. 旧写法：先用QString::arg格式化，再交给级别已关闭的Logger
+ *          3. LOGGER_DEBUG_FMT，级别关闭（只读一次原子变量）
+ *          4. LOGGER_DEBUG_FMT，类别被过滤（原子位图检查）
+ *          5. LOGGER_DEBUG_FMT，启用并写入日志文件（数值参数进入环形缓冲区）
+ *          使用 -DLOG_COMPILE_MIN_LEVEL=1 编译时，3~5的日志调用在编译期被裁剪，耗时应与1相同。
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QVector>
+#include <QtMath>
+#include <functional>
+
+#include "../src/core/logger.h"
+
+namespace {
+
+const int FRAME_SAMPLES = 1152;
+const int CHANNELS = 2;
+const int FRAME_COUNT = 200000;
+
+/**
+ * @brief 与processAudioFrame相同的逐样本处理：平衡控制、限幅、RMS
+ */
+double processFrame(QVector<float>& samples, float balance)
+{
+    float* data = samples.data();
+    double leftSum = 0.0;
+    double rightSum = 0.0;
+    for (int i = 0; i < FRAME_SAMPLES; ++i) {
+        float left = data[i * 2];
+        float right = data[i * 2 + 1];
+        if (balance < 0) {
+            left *= (1.0f + qAbs(balance));
+            right *= (1.0f - qAbs(balance) * 0.5f);
+        } else if (balance > 0) {
+            left *= (1.0f - balance * 0.5f);
+            right *= (1.0f + balance);
+        }
+        left = qBound(-1.0f, left, 1.0f);
+        right = qBound(-1.0f, right, 1.0f);
+        data[i * 2] = left;
+        data[i * 2 + 1] = right;
+        leftSum += left * left;
+        rightSum += right * right;
+    }
+    return qSqrt(leftSum / FRAME_SAMPLES) + qSqrt(rightSum / FRAME_SAMPLES);
+}
+
+/**
+ * @brief 运行解码循环，返回每帧平均耗时（纳秒）
+ */
+double runLoop(const std::function<void(int frameIndex, int bytes)>& logFrame)
+{
+    QVector<float> samples(FRAME_SAMPLES * CHANNELS);
+    for (int i = 0; i < samples.size(); ++i) {
+        samples[i] = qSin(i * 0.01) * 0.5f;
+    }
+
+    volatile double sink = 0.0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int frame = 0; frame < FRAME_COUNT; ++frame) {
+        sink = sink + processFrame(samples, 0.1f);
+        logFrame(frame, FRAME_SAMPLES * CHANNELS * static_cast<int>(sizeof(float)));
+    }
+    return static_cast<double>(timer.nsecsElapsed()) / FRAME_COUNT;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir logDir;
+    Logger* logger = Logger::instance();
+    logger->setLogTargets(Logger::File);
+    logger->initialize(logDir.filePath("benchmark.log"));
+
+    // 1. 无日志
+    const double baseline = runLoop([](int, int) {});
+
+    // 2. 旧写法：格式化后再由Logger按级别丢弃
+    logger->setLogLevel(ErrorLog::LogLevel::Info);
+    const double eager = runLoop([logger](int frame, int bytes) {
+        logger->debug(QString("音频帧%1: 重采样%2样本，写入%3字节").arg(frame).arg(FRAME_SAMPLES).arg(bytes),
+                      "FFmpegDecoder");
+    });
+
+    // 3. 宏，级别关闭
+    const double levelOff = runLoop([](int frame, int bytes) {
+        LOGGER_DEBUG_FMT("FFmpegDecoder", "音频帧%1: 重采样%2样本，写入%3字节", frame, FRAME_SAMPLES, bytes);
+    });
+
+    // 4. 宏，类别被过滤
+    logger->setLogLevel(ErrorLog::LogLevel::Debug);
+    logger->addCategoryFilter("AudioEngine");
+    const double categoryOff = runLoop([](int frame, int bytes) {
+        LOGGER_DEBUG_FMT("FFmpegDecoder", "音频帧%1: 重采样%2样本，写入%3字节", frame, FRAME_SAMPLES, bytes);
+    });
+    logger->clearCategoryFilters();
+
+    // 5. 宏，启用
+    const quint64 droppedBefore = logger->droppedMessageCount();
+    const double enabled = runLoop([](int frame, int bytes) {
+        LOGGER_DEBUG_FMT("FFmpegDecoder", "音频帧%1: 重采样%2样本，写入%3字节", frame, FRAME_SAMPLES, bytes);
+    });
+    const quint64 dropped = logger->droppedMessageCount() - droppedBefore;
+    logger->shutdown();
+
+    qDebug() << QString("LOG_COMPILE_MIN_LEVEL = %1，帧数 %2").arg(LOG_COMPILE_MIN_LEVEL).arg(FRAME_COUNT);
+    qDebug() << QString("  无日志                  %1 ns/帧").arg(baseline, 0, 'f', 1);
+    qDebug() << QString("  QString::arg + 级别过滤  %1 ns/帧").arg(eager, 0, 'f', 1);
+    qDebug() << QString("  宏，级别关闭            %1 ns/帧").arg(levelOff, 0, 'f', 1);
+    qDebug() << QString("  宏，类别过滤            %1 ns/帧").arg(categoryOff, 0, 'f', 1);
+    qDebug() << QString("  宏，启用（环形缓冲区）  %1 ns/帧，丢弃 %2 条").arg(enabled, 0, 'f', 1).arg(dropped);
+
+    return 0;
+}
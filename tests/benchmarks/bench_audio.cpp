@@ -0,0 +1,264 @@
+/**
+ * @file bench_audio.cpp
+ * @brief 音频热点：解码吞吐量、重采样、逐样本处理内核
+ * @details 解码通过AudioIOContext走与FFmpegDecoder相同的I/O路径，分别测量普通读取和
+ *          MappedFileCache预加载后的映射读取；重采样参数与FFmpegDecoder::setupResampler相同
+ *          （44.1kHz平面float → 48kHz交错int16）。
+ */
+
+#include "benchmarkrunner.h"
+#include "syntheticdata.h"
+#include "../../src/audio/audiokernels.h"
+#include "../../src/audio/audioiocontext.h"
+#include "../../src/audio/mappedfilecache.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QVector>
+#include <memory>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswresample/swresample.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace {
+
+const int SAMPLE_RATE = 44100;
+const int OUTPUT_SAMPLE_RATE = 48000;
+const int CHANNELS = 2;
+const int FRAME_SAMPLES = 1152;  // 与MP3一帧的样本数相同
+
+/**
+ * @brief 完整解码一个文件
+ * @return 解码出的样本帧数，失败返回-1
+ */
+qint64 decodeFile(const QString& filePath)
+{
+    AVFormatContext* format = avformat_alloc_context();
+    AVIOContext* io = AudioIOContext::open(filePath, AudioIOOptions::playback());
+    if (io) {
+        format->pb = io;
+        format->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+
+    qint64 decodedFrames = -1;
+    AVCodecContext* decoder = nullptr;
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+
+    do {
+        if (avformat_open_input(&format, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+            format = nullptr;  // 失败时FFmpeg已释放上下文
+            break;
+        }
+        if (avformat_find_stream_info(format, nullptr) < 0) {
+            break;
+        }
+        const AVCodec* codec = nullptr;
+        const int streamIndex = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+        if (streamIndex < 0 || !codec) {
+            break;
+        }
+        decoder = avcodec_alloc_context3(codec);
+        if (avcodec_parameters_to_context(decoder, format->streams[streamIndex]->codecpar) < 0
+            || avcodec_open2(decoder, codec, nullptr) < 0) {
+            break;
+        }
+
+        decodedFrames = 0;
+        auto receive = [&]() {
+            while (avcodec_receive_frame(decoder, frame) == 0) {
+                decodedFrames += frame->nb_samples;
+                av_frame_unref(frame);
+            }
+        };
+        while (av_read_frame(format, packet) >= 0) {
+            if (packet->stream_index == streamIndex && avcodec_send_packet(decoder, packet) == 0) {
+                receive();
+            }
+            av_packet_unref(packet);
+        }
+        avcodec_send_packet(decoder, nullptr);
+        receive();
+    } while (false);
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&decoder);
+    avformat_close_input(&format);
+    AudioIOContext::free(&io);
+    return decodedFrames;
+}
+
+void runDecodeBenchmarks(BenchmarkRunner& runner)
+{
+    const BenchmarkOptions& options = runner.options();
+    const QString audioDir = options.workDirectory + "/audio";
+    const struct {
+        const char* name;
+        const char* codec;
+        const char* extension;
+    } formats[] = {
+        {"wav", "pcm_s16le", "wav"},
+        {"flac", "flac", "flac"},
+    };
+
+    for (const auto& format : formats) {
+        const QString filePath = QString("%1/synthetic_%2s.%3").arg(audioDir).arg(options.audioSeconds).arg(format.extension);
+        const qint64 frames = static_cast<qint64>(SAMPLE_RATE) * options.audioSeconds;
+
+        BenchmarkCase buffered;
+        buffered.name = QString("audio.decode.%1.buffered").arg(format.name);
+        buffered.items = frames;
+        buffered.run = [filePath]() {
+            MappedFileCache::instance()->remove(filePath);
+            benchmarkKeep(decodeFile(filePath));
+        };
+
+        BenchmarkCase mapped;
+        mapped.name = QString("audio.decode.%1.mapped").arg(format.name);
+        mapped.items = frames;
+        mapped.run = [filePath]() {
+            MappedFileCache::instance()->preload(filePath);
+            benchmarkKeep(decodeFile(filePath));
+        };
+
+        // 吞吐量按文件字节数计算，需要先生成文件才能确定
+        bool prepared = true;
+        if (!options.listOnly && (runner.matches(buffered.name) || runner.matches(mapped.name))) {
+            QDir().mkpath(audioDir);
+            prepared = QFileInfo::exists(filePath)
+                       || SyntheticData::writeAudioFile(filePath, format.codec, SAMPLE_RATE, CHANNELS,
+                                                        options.audioSeconds, 0xA0D10);
+            buffered.bytes = mapped.bytes = QFileInfo(filePath).size();
+        }
+
+        runner.run({buffered, mapped}, [prepared, filePath]() {
+            return prepared && decodeFile(filePath) > 0;
+        }, [filePath]() {
+            MappedFileCache::instance()->remove(filePath);
+        });
+    }
+}
+
+void runResampleBenchmark(BenchmarkRunner& runner)
+{
+    const int totalFrames = SAMPLE_RATE * 10;
+
+    // 平面float输入，与多数有损解码器的输出格式相同
+    const QVector<int16_t> interleaved = SyntheticData::generateSamples(totalFrames, CHANNELS, SAMPLE_RATE, 0x5A3);
+    QVector<float> left(totalFrames);
+    QVector<float> right(totalFrames);
+    for (int i = 0; i < totalFrames; ++i) {
+        left[i] = interleaved[i * 2] / 32768.0f;
+        right[i] = interleaved[i * 2 + 1] / 32768.0f;
+    }
+
+    BenchmarkCase benchmark;
+    benchmark.name = "audio.resample.fltp44k_to_s16_48k";
+    benchmark.items = totalFrames;
+    benchmark.bytes = static_cast<qint64>(totalFrames) * CHANNELS * sizeof(float);
+    benchmark.run = [&left, &right, totalFrames]() {
+        AVChannelLayout layout;
+        av_channel_layout_default(&layout, CHANNELS);
+        SwrContext* swr = nullptr;
+        if (swr_alloc_set_opts2(&swr, &layout, AV_SAMPLE_FMT_S16, OUTPUT_SAMPLE_RATE,
+                                &layout, AV_SAMPLE_FMT_FLTP, SAMPLE_RATE, 0, nullptr) < 0
+            || swr_init(swr) < 0) {
+            swr_free(&swr);
+            return;
+        }
+
+        const int maxOut = static_cast<int>(av_rescale_rnd(FRAME_SAMPLES + 64, OUTPUT_SAMPLE_RATE, SAMPLE_RATE, AV_ROUND_UP));
+        QVector<int16_t> output(maxOut * CHANNELS);
+        uint8_t* outData[1] = {reinterpret_cast<uint8_t*>(output.data())};
+        qint64 produced = 0;
+        for (int position = 0; position < totalFrames; position += FRAME_SAMPLES) {
+            const int count = qMin(FRAME_SAMPLES, totalFrames - position);
+            const uint8_t* inData[2] = {
+                reinterpret_cast<const uint8_t*>(left.constData() + position),
+                reinterpret_cast<const uint8_t*>(right.constData() + position)
+            };
+            produced += swr_convert(swr, outData, maxOut, inData, count);
+        }
+        benchmarkKeep(produced);
+        swr_free(&swr);
+    };
+    runner.run(benchmark);
+}
+
+void runKernelBenchmarks(BenchmarkRunner& runner)
+{
+    const int totalFrames = OUTPUT_SAMPLE_RATE * 10;
+    const QVector<int16_t> source = SyntheticData::generateSamples(totalFrames, CHANNELS, OUTPUT_SAMPLE_RATE, 0xD5B);
+
+    auto floatSamples = std::make_shared<QVector<float>>(totalFrames * CHANNELS);
+    AudioKernels::int16ToFloat(source.constData(), floatSamples->data(), totalFrames * CHANNELS);
+    auto intSamples = std::make_shared<QVector<int16_t>>(source);
+
+    const qint64 floatBytes = static_cast<qint64>(totalFrames) * CHANNELS * sizeof(float);
+    const qint64 intBytes = static_cast<qint64>(totalFrames) * CHANNELS * sizeof(int16_t);
+
+    // 按解码循环的粒度逐帧处理，包含每帧的调用开销
+    BenchmarkCase balanceFloat;
+    balanceFloat.name = "audio.kernel.balance_float";
+    balanceFloat.items = totalFrames;
+    balanceFloat.bytes = floatBytes;
+    balanceFloat.run = [floatSamples, totalFrames]() {
+        float* data = floatSamples->data();
+        for (int position = 0; position < totalFrames; position += FRAME_SAMPLES) {
+            AudioKernels::applyBalance(data + position * CHANNELS, qMin(FRAME_SAMPLES, totalFrames - position), -0.25);
+        }
+        benchmarkKeep(data[0]);
+    };
+
+    BenchmarkCase balanceS16;
+    balanceS16.name = "audio.kernel.balance_s16";
+    balanceS16.items = totalFrames;
+    balanceS16.bytes = intBytes;
+    balanceS16.run = [intSamples, totalFrames]() {
+        int16_t* data = intSamples->data();
+        for (int position = 0; position < totalFrames; position += FRAME_SAMPLES) {
+            AudioKernels::applyBalance(data + position * CHANNELS, qMin(FRAME_SAMPLES, totalFrames - position), 0.25);
+        }
+        benchmarkKeep(data[0]);
+    };
+
+    BenchmarkCase convert;
+    convert.name = "audio.kernel.s16_to_float";
+    convert.items = totalFrames;
+    convert.bytes = intBytes;
+    convert.run = [source, floatSamples, totalFrames]() {
+        AudioKernels::int16ToFloat(source.constData(), floatSamples->data(), totalFrames * CHANNELS);
+        benchmarkKeep((*floatSamples)[0]);
+    };
+
+    BenchmarkCase levels;
+    levels.name = "audio.kernel.rms_levels";
+    levels.items = totalFrames;
+    levels.bytes = floatBytes;
+    levels.run = [floatSamples, totalFrames]() {
+        const float* data = floatSamples->constData();
+        double left = 0.0;
+        double right = 0.0;
+        for (int position = 0; position < totalFrames; position += FRAME_SAMPLES) {
+            AudioKernels::rmsLevels(data + position * CHANNELS, qMin(FRAME_SAMPLES, totalFrames - position), CHANNELS, &left, &right);
+        }
+        benchmarkKeep(left);
+        benchmarkKeep(right);
+    };
+
+    runner.run({balanceFloat, balanceS16, convert, levels});
+}
+
+} // namespace
+
+void runAudioBenchmarks(BenchmarkRunner& runner)
+{
+    runDecodeBenchmarks(runner);
+    runResampleBenchmark(runner);
+    runKernelBenchmarks(runner);
+}
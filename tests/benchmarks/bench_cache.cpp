@@ -0,0 +1,129 @@
+/**
+ * @file bench_cache.cpp
+ * @brief 缓存操作：ShardedCache的单线程/多线程读写和MappedFileCache命中路径
+ * @details 访问模式与benchmark_cache.cpp相同：约80%的请求落在20%的键上，读写比9:1。
+ */
+
+#include "benchmarkrunner.h"
+#include "../../src/core/shardedcache.h"
+#include "../../src/audio/mappedfilecache.h"
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QVector>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int KEY_SPACE = 20000;
+const int CACHE_CAPACITY = 2000;
+const int OPERATIONS_PER_THREAD = 100000;
+const int MAPPED_FILES = 8;
+const int MAPPED_LOOKUPS = 10000;
+
+QVector<int> generateKeys(int count, quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    QVector<int> keys;
+    keys.reserve(count);
+    const int hotKeys = KEY_SPACE / 5;
+    for (int i = 0; i < count; ++i) {
+        if (rng.bounded(100) < 80) {
+            keys.append(rng.bounded(hotKeys));
+        } else {
+            keys.append(hotKeys + rng.bounded(KEY_SPACE - hotKeys));
+        }
+    }
+    return keys;
+}
+
+BenchmarkCase shardedCase(const QString& name, int threadCount, bool admission)
+{
+    auto keySets = std::make_shared<QVector<QVector<int>>>();
+    for (int t = 0; t < threadCount; ++t) {
+        keySets->append(generateKeys(OPERATIONS_PER_THREAD, 1234u + t));
+    }
+    auto cache = std::make_shared<ShardedCache<int, QByteArray>>(CACHE_CAPACITY);
+    cache->setAdmissionPolicyEnabled(admission);
+    const QByteArray payload(256, 'x');
+
+    BenchmarkCase benchmark;
+    benchmark.name = name;
+    benchmark.items = static_cast<qint64>(threadCount) * OPERATIONS_PER_THREAD;
+    benchmark.run = [keySets, cache, payload, threadCount]() {
+        auto worker = [&](const QVector<int>& keys) {
+            for (int i = 0; i < keys.size(); ++i) {
+                if (i % 10 == 0 || !cache->get(keys[i])) {
+                    cache->put(keys[i], payload);
+                }
+            }
+        };
+        if (threadCount == 1) {
+            worker(keySets->first());
+            return;
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&worker, &keySets, t]() { worker(keySets->at(t)); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    };
+    return benchmark;
+}
+
+} // namespace
+
+void runCacheBenchmarks(BenchmarkRunner& runner)
+{
+    runner.run({
+        shardedCase("cache.sharded.get_put.1thread", 1, false),
+        shardedCase("cache.sharded.get_put.4threads", 4, false),
+        shardedCase("cache.sharded_lfu.get_put.4threads", 4, true),
+    });
+
+    // MappedFileCache::acquire命中路径：解码器每次打开文件都会走这里
+    const QString dir = runner.options().workDirectory + "/mapped";
+    auto paths = std::make_shared<QStringList>();
+    for (int i = 0; i < MAPPED_FILES; ++i) {
+        paths->append(QString("%1/file_%2.bin").arg(dir).arg(i));
+    }
+
+    BenchmarkCase acquire;
+    acquire.name = "cache.mapped_file.acquire_hit";
+    acquire.items = MAPPED_LOOKUPS;
+    acquire.run = [paths]() {
+        MappedFileCache* cache = MappedFileCache::instance();
+        qint64 total = 0;
+        for (int i = 0; i < MAPPED_LOOKUPS; ++i) {
+            const std::shared_ptr<MappedAudioFile> file = cache->acquire(paths->at(i % MAPPED_FILES));
+            total += file ? file->size() : 0;
+        }
+        benchmarkKeep(total);
+    };
+
+    runner.run({acquire}, [dir, paths]() {
+        QDir().mkpath(dir);
+        const QByteArray content(256 * 1024, '\x5a');
+        for (const QString& path : *paths) {
+            QFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size()) {
+                return false;
+            }
+            file.close();
+            if (!MappedFileCache::instance()->preload(path)) {
+                return false;
+            }
+        }
+        return true;
+    }, [paths]() {
+        for (const QString& path : *paths) {
+            MappedFileCache::instance()->remove(path);
+            QFile::remove(path);
+        }
+    });
+}
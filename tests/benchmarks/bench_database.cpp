@@ -0,0 +1,396 @@
+/**
+ * @file bench_database.cpp
+ * @brief DAO查询：在1k/10k/100k规模的合成曲库上测量主窗口和播放界面使用的查询
+ * @details 每个规模单独建库（与应用相同的建表和初始数据流程），写入合成数据后运行该规模的全部用例。
+ *          另建一个包含全部歌曲的播放列表，测量排序键的移动和删除，以及整个播放列表的导出和导入解析。
+ */
+
+#include "benchmarkrunner.h"
+#include "syntheticdata.h"
+#include "../../src/database/databasemanager.h"
+#include "../../src/database/songdao.h"
+#include "../../src/database/tagdao.h"
+#include "../../src/database/playhistorydao.h"
+#include "../../src/database/playstatsdao.h"
+#include "../../src/database/playlistdao.h"
+#include "../../src/database/tagindex.h"
+#include "../../src/managers/playlistio.h"
+#include "../../src/managers/smartplaylist.h"
+#include "../../src/core/constants.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSqlQuery>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+const int RANDOM_LOOKUPS = 1000;
+const int PLAYLIST_MOVES = 100;
+
+struct LibraryState
+{
+    SyntheticData::LibraryStats stats;
+    QVector<int> lookupIds;  // 随机查找的歌曲ID序列
+    int playlistId = -1;     // 包含全部歌曲的播放列表
+    int smartPlaylistId = -1;
+    SmartPlaylistCriteria smartCriteria;
+};
+
+bool createFullPlaylist(QSqlDatabase db, LibraryState* state)
+{
+    PlaylistDao dao;
+    state->playlistId = dao.addPlaylist(Playlist("合成播放列表"));
+    if (state->playlistId <= 0) {
+        return false;
+    }
+    QSqlQuery query(db);
+    query.prepare(QString("INSERT INTO %1 (playlist_id, song_id, sort_order) SELECT ?, id, id * ? FROM %2")
+                      .arg(Constants::Database::TABLE_PLAYLIST_SONGS, Constants::Database::TABLE_SONGS));
+    query.addBindValue(state->playlistId);
+    query.addBindValue(PlaylistDao::SORT_KEY_GAP);
+    return query.exec();
+}
+
+// "评分至少4星、30天内没有播放、带有最常用标签"
+bool createSmartPlaylist(LibraryState* state)
+{
+    state->smartCriteria.rules = {
+        {"rating", ">=", 4},
+        {"lastPlayed", "notInLast", 30},
+        {"tag", "is", state->stats.busiestTagId}
+    };
+
+    Playlist playlist("合成智能播放列表");
+    playlist.setIsSmartPlaylist(true);
+    playlist.setSmartCriteria(state->smartCriteria.toJson());
+    PlaylistDao dao;
+    state->smartPlaylistId = dao.addPlaylist(playlist);
+    return state->smartPlaylistId > 0;
+}
+
+bool openLibrary(const QString& dbPath, int songCount, LibraryState* state)
+{
+    DatabaseManager* manager = DatabaseManager::instance();
+    if (manager->isInitialized()) {
+        manager->closeDatabase();
+    }
+    QFile::remove(dbPath);
+
+    if (!manager->initialize(dbPath)) {
+        fprintf(stderr, "初始化数据库失败: %s\n", qPrintable(dbPath));
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!SyntheticData::populateLibrary(manager->database(), songCount, 0x5EED0000u + songCount, &state->stats)) {
+        return false;
+    }
+    fprintf(stderr, "合成曲库 %d 首: %d 个标签，%d 条标签关联，%d 条播放记录，耗时 %lld ms\n",
+            state->stats.songs, state->stats.tags, state->stats.songTags, state->stats.playRecords,
+            static_cast<long long>(timer.elapsed()));
+
+    if (!createFullPlaylist(manager->database(), state)) {
+        fprintf(stderr, "创建合成播放列表失败\n");
+        return false;
+    }
+    if (!createSmartPlaylist(state)) {
+        fprintf(stderr, "创建合成智能播放列表失败\n");
+        return false;
+    }
+
+    QRandomGenerator rng(songCount);
+    state->lookupIds.resize(RANDOM_LOOKUPS);
+    for (int& id : state->lookupIds) {
+        id = 1 + rng.bounded(songCount);
+    }
+    return true;
+}
+
+} // namespace
+
+void runDatabaseBenchmarks(BenchmarkRunner& runner)
+{
+    const BenchmarkOptions& options = runner.options();
+
+    for (int size : options.librarySizes) {
+        const QString suffix = QString("/%1").arg(size);
+        const QString dbPath = QString("%1/library_%2.db").arg(options.workDirectory).arg(size);
+        auto state = std::make_shared<LibraryState>();
+
+        QList<BenchmarkCase> cases;
+
+        BenchmarkCase allSongs;
+        allSongs.name = "db.songs.getAllSongs" + suffix;
+        allSongs.items = size;
+        allSongs.run = []() {
+            SongDao dao;
+            benchmarkKeep(dao.getAllSongs().size());
+        };
+        cases.append(allSongs);
+
+        BenchmarkCase songsByTag;
+        songsByTag.name = "db.songs.getSongsByTag" + suffix;
+        songsByTag.run = [state]() {
+            SongDao dao;
+            benchmarkKeep(dao.getSongsByTag(state->stats.busiestTagId).size());
+        };
+        cases.append(songsByTag);
+
+        // 标签索引：与上面的SQL连接相比，位图查找和组合与歌曲行无关
+        BenchmarkCase inTag;
+        inTag.name = "db.tagindex.isSongInTag" + suffix;
+        inTag.items = RANDOM_LOOKUPS;
+        inTag.run = [state]() {
+            int found = 0;
+            for (int id : state->lookupIds) {
+                found += TagIndex::instance()->contains(id, state->stats.busiestTagId) ? 1 : 0;
+            }
+            benchmarkKeep(found);
+        };
+        cases.append(inTag);
+
+        BenchmarkCase tagsForSong;
+        tagsForSong.name = "db.tagindex.tagsForSong" + suffix;
+        tagsForSong.items = RANDOM_LOOKUPS;
+        tagsForSong.run = [state]() {
+            int tags = 0;
+            for (int id : state->lookupIds) {
+                tags += TagIndex::instance()->tagsForSong(id).size();
+            }
+            benchmarkKeep(tags);
+        };
+        cases.append(tagsForSong);
+
+        // 两个最常用标签的或、与、差各一次
+        BenchmarkCase tagMatch;
+        tagMatch.name = "db.tagindex.match" + suffix;
+        tagMatch.run = [state]() {
+            const QList<int> both = {state->stats.busiestTagId, state->stats.secondTagId};
+            const QList<int> busiest = {state->stats.busiestTagId};
+            const QList<int> second = {state->stats.secondTagId};
+            TagIndex* index = TagIndex::instance();
+            benchmarkKeep(index->match(QList<int>(), both, QList<int>()).size()
+                          + index->matchCount(both, QList<int>(), QList<int>())
+                          + index->matchCount(busiest, QList<int>(), second));
+        };
+        cases.append(tagMatch);
+
+        BenchmarkCase search;
+        search.name = "db.songs.searchByTitle" + suffix;
+        search.run = []() {
+            SongDao dao;
+            benchmarkKeep(dao.searchByTitle("River").size());
+        };
+        cases.append(search);
+
+        BenchmarkCase lookup;
+        lookup.name = "db.songs.getSongById" + suffix;
+        lookup.items = RANDOM_LOOKUPS;
+        lookup.run = [state]() {
+            SongDao dao;
+            int found = 0;
+            for (int id : state->lookupIds) {
+                found += dao.getSongById(id).id() > 0 ? 1 : 0;
+            }
+            benchmarkKeep(found);
+        };
+        cases.append(lookup);
+
+        BenchmarkCase count;
+        count.name = "db.songs.getSongCount" + suffix;
+        count.run = []() {
+            SongDao dao;
+            benchmarkKeep(dao.getSongCount());
+        };
+        cases.append(count);
+
+        BenchmarkCase allTags;
+        allTags.name = "db.tags.getAllTags" + suffix;
+        allTags.run = []() {
+            TagDao dao;
+            benchmarkKeep(dao.getAllTags().size());
+        };
+        cases.append(allTags);
+
+        BenchmarkCase recent;
+        recent.name = "db.history.getRecentPlayedSongs" + suffix;
+        recent.items = 100;
+        recent.run = []() {
+            PlayHistoryDao dao;
+            benchmarkKeep(dao.getRecentPlayedSongs(100).size());
+        };
+        cases.append(recent);
+
+        BenchmarkCase history;
+        history.name = "db.history.getAllPlayHistory" + suffix;
+        history.items = 1000;
+        history.run = []() {
+            PlayHistoryDao dao;
+            benchmarkKeep(dao.getAllPlayHistory(1000).size());
+        };
+        cases.append(history);
+
+        BenchmarkCase stats;
+        stats.name = "db.history.getPlayHistoryStats" + suffix;
+        stats.run = []() {
+            PlayHistoryDao dao;
+            benchmarkKeep(dao.getPlayHistoryStats().totalRecords);
+        };
+        cases.append(stats);
+
+        // 播放统计只读汇总表的主键或索引范围，与播放历史规模无关
+        BenchmarkCase topWeek;
+        topWeek.name = "db.stats.getTopSongsThisWeek" + suffix;
+        topWeek.items = 10;
+        topWeek.run = []() {
+            PlayStatsDao dao;
+            benchmarkKeep(dao.getTopSongsThisWeek(10).size());
+        };
+        cases.append(topWeek);
+
+        BenchmarkCase perDay;
+        perDay.name = "db.stats.getPlaysPerDay" + suffix;
+        perDay.items = 30;
+        perDay.run = []() {
+            PlayStatsDao dao;
+            const QDate today = QDate::currentDate();
+            benchmarkKeep(dao.getPlaysPerDay(today.addDays(-29), today).size());
+        };
+        cases.append(perDay);
+
+        BenchmarkCase topArtist;
+        topArtist.name = "db.stats.getMostPlayedArtist" + suffix;
+        topArtist.run = []() {
+            PlayStatsDao dao;
+            benchmarkKeep(dao.getMostPlayedArtist().playCount);
+        };
+        cases.append(topArtist);
+
+        // 智能播放列表：完整查询（评分索引 + 标签和统计表按主键查找）与只重新求值变化歌曲的增量刷新
+        BenchmarkCase smartEvaluate;
+        smartEvaluate.name = "db.smart.evaluate" + suffix;
+        smartEvaluate.run = [state]() {
+            benchmarkKeep(SmartPlaylistEngine::instance()->evaluate(state->smartCriteria).size());
+        };
+        cases.append(smartEvaluate);
+
+        BenchmarkCase smartRefresh;
+        smartRefresh.name = "db.smart.incrementalRefresh" + suffix;
+        smartRefresh.items = PLAYLIST_MOVES;
+        smartRefresh.run = [state]() {
+            QSqlQuery query(DatabaseManager::instance()->database());
+            query.prepare("UPDATE songs SET rating = CASE WHEN rating >= 4 THEN 1 ELSE 5 END WHERE id = ?");
+            for (int i = 0; i < PLAYLIST_MOVES; ++i) {
+                query.addBindValue(state->lookupIds[i]);
+                query.exec();
+            }
+            benchmarkKeep(SmartPlaylistEngine::instance()->songCount(state->smartPlaylistId));
+        };
+        cases.append(smartRefresh);
+
+        BenchmarkCase playlistSongs;
+        playlistSongs.name = "db.playlist.getPlaylistSongs" + suffix;
+        playlistSongs.items = size;
+        playlistSongs.run = [state]() {
+            PlaylistDao dao;
+            benchmarkKeep(dao.getPlaylistSongs(state->playlistId).size());
+        };
+        cases.append(playlistSongs);
+
+        // 汇总统计只读playlists表中由触发器维护的列，与曲库规模无关
+        BenchmarkCase summary;
+        summary.name = "db.playlist.summary" + suffix;
+        summary.items = 1;
+        summary.run = []() {
+            PlaylistDao dao;
+            benchmarkKeep(dao.getPlaylistSummary().totalSongs);
+        };
+        cases.append(summary);
+
+        // 拖动排序：把随机歌曲移到另一首随机歌曲之前，每次只写一行
+        BenchmarkCase move;
+        move.name = "db.playlist.moveSong" + suffix;
+        move.items = PLAYLIST_MOVES;
+        move.run = [state]() {
+            PlaylistDao dao;
+            int moved = 0;
+            for (int i = 0; i + 1 < PLAYLIST_MOVES; i += 2) {
+                moved += dao.moveSongInPlaylist(state->playlistId, state->lookupIds[i], state->lookupIds[i + 1]) ? 1 : 0;
+            }
+            benchmarkKeep(moved);
+        };
+        cases.append(move);
+
+        // 删除后重新追加同一首歌，列表规模保持不变
+        BenchmarkCase removeAdd;
+        removeAdd.name = "db.playlist.removeAndAppend" + suffix;
+        removeAdd.items = PLAYLIST_MOVES;
+        removeAdd.run = [state]() {
+            PlaylistDao dao;
+            int changed = 0;
+            for (int i = 0; i < PLAYLIST_MOVES; ++i) {
+                const int songId = state->lookupIds[i];
+                if (dao.removeSongFromPlaylist(state->playlistId, songId)) {
+                    changed += dao.addSongToPlaylist(state->playlistId, songId) ? 1 : 0;
+                }
+            }
+            benchmarkKeep(changed);
+        };
+        cases.append(removeAdd);
+
+        // 同样的删除和追加放进一次批量修改：一个事务、IN列表删除、多行插入
+        BenchmarkCase batch;
+        batch.name = "db.playlist.removeAndAppendBatch" + suffix;
+        batch.items = PLAYLIST_MOVES;
+        batch.run = [state]() {
+            PlaylistDao dao;
+            const QList<int> songIds = state->lookupIds.mid(0, PLAYLIST_MOVES);
+            PlaylistMutation removal;
+            removal.removeSongIds = songIds;
+            PlaylistMutation append;
+            append.appendSongIds = songIds;
+            int changed = 0;
+            if (dao.applyMutation(state->playlistId, removal).success) {
+                changed = dao.applyMutation(state->playlistId, append).appendedSongIds.size();
+            }
+            benchmarkKeep(changed);
+        };
+        cases.append(batch);
+
+        // 导出：从数据库游标直接写出整个播放列表
+        const QString m3uPath = QString("%1/playlist_%2.m3u").arg(options.workDirectory).arg(size);
+        BenchmarkCase exportM3U;
+        exportM3U.name = "db.playlist.exportM3U" + suffix;
+        exportM3U.items = size;
+        exportM3U.run = [state, m3uPath]() {
+            benchmarkKeep(PlaylistExporter::write(state->playlistId, m3uPath, ExportFormat::M3U) ? 1 : 0);
+        };
+        cases.append(exportM3U);
+
+        // 导入：逐行解析上面导出的文件，分批按路径查找歌曲ID（不写入播放列表）
+        BenchmarkCase importM3U;
+        importM3U.name = "db.playlist.resolveM3U" + suffix;
+        importM3U.items = size;
+        importM3U.run = [dbPath, m3uPath]() {
+            benchmarkKeep(PlaylistImporter::resolve(m3uPath, dbPath).songIds.size());
+        };
+        cases.append(importM3U);
+
+        runner.run(cases, [dbPath, size, state]() {
+            QDir().mkpath(QFileInfo(dbPath).absolutePath());
+            return openLibrary(dbPath, size, state.get());
+        }, [dbPath, m3uPath]() {
+            // 缓存和变更序号属于这个规模的数据库
+            SmartPlaylistEngine::cleanup();
+            TagIndex::cleanup();
+            DatabaseManager::instance()->closeDatabase();
+            QFile::remove(dbPath);
+            QFile::remove(m3uPath);
+        });
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * @file bench_ui.cpp
+ * @brief 列表填充：歌曲列表控件的填充和曲库快照的读写
+ * @details 填充方式与MainWindowController::updateSongList相同（每首歌一个QListWidgetItem，
+ *          附带Song数据和提示文字）。需要QApplication，未设置QT_QPA_PLATFORM时main使用offscreen平台。
+ */
+
+#include "benchmarkrunner.h"
+#include "syntheticdata.h"
+#include "../../src/managers/librarysnapshot.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QListWidget>
+#include <memory>
+
+namespace {
+
+void populateSongList(QListWidget* list, const QList<Song>& songs)
+{
+    list->clear();
+    list->setUpdatesEnabled(false);
+    for (const Song& song : songs) {
+        QListWidgetItem* item = new QListWidgetItem();
+        item->setText(QString("%1 - %2").arg(song.artist(), song.title()));
+        item->setData(Qt::UserRole, QVariant::fromValue(song));
+        item->setToolTip(QString("文件: %1\n时长: %2")
+                       .arg(song.filePath())
+                       .arg(QString::number(song.duration())));
+        list->addItem(item);
+    }
+    list->setUpdatesEnabled(true);
+}
+
+LibrarySnapshotData snapshotFor(const QList<Song>& songs)
+{
+    LibrarySnapshotData data;
+    for (int i = 0; i < 16; ++i) {
+        LibrarySnapshotData::TagItem tag;
+        tag.id = i + 1;
+        tag.name = QString("合成标签%1").arg(i + 1);
+        tag.color = QColor::fromHsv(i * 22, 160, 200);
+        tag.system = i < 3;
+        data.tags.append(tag);
+    }
+    for (const Song& song : songs) {
+        LibrarySnapshotData::SongItem item;
+        item.song = song;
+        item.displayText = QString("%1 - %2").arg(song.artist(), song.title());
+        data.songs.append(item);
+    }
+    data.selectedTagId = 1;
+    data.selectedTagName = data.tags.first().name;
+    return data;
+}
+
+} // namespace
+
+void runUiBenchmarks(BenchmarkRunner& runner)
+{
+    const BenchmarkOptions& options = runner.options();
+
+    for (int size : options.librarySizes) {
+        const QString suffix = QString("/%1").arg(size);
+        const QString snapshotPath = QString("%1/library_%2.snapshot").arg(options.workDirectory).arg(size);
+        auto songs = std::make_shared<QList<Song>>();
+        auto list = std::make_shared<std::unique_ptr<QListWidget>>();
+
+        BenchmarkCase populate;
+        populate.name = "ui.song_list.populate" + suffix;
+        populate.items = size;
+        populate.run = [songs, list]() {
+            populateSongList(list->get(), *songs);
+        };
+
+        BenchmarkCase save;
+        save.name = "ui.library_snapshot.save" + suffix;
+        save.items = size;
+        save.run = [songs, snapshotPath]() {
+            benchmarkKeep(LibrarySnapshot::save(snapshotPath, snapshotFor(*songs)));
+        };
+
+        BenchmarkCase load;
+        load.name = "ui.library_snapshot.load" + suffix;
+        load.items = size;
+        load.run = [snapshotPath]() {
+            LibrarySnapshotData data;
+            benchmarkKeep(LibrarySnapshot::load(snapshotPath, &data));
+        };
+
+        BenchmarkCase restore;
+        restore.name = "ui.library_snapshot.restore" + suffix;
+        restore.items = size;
+        restore.run = [snapshotPath, list]() {
+            LibrarySnapshotData data;
+            LibrarySnapshot::load(snapshotPath, &data);
+            QListWidget* widget = list->get();
+            widget->clear();
+            widget->setUpdatesEnabled(false);
+            for (const LibrarySnapshotData::SongItem& entry : data.songs) {
+                QListWidgetItem* item = new QListWidgetItem(entry.displayText);
+                item->setData(Qt::UserRole, QVariant::fromValue(entry.song));
+                item->setToolTip(QString("文件: %1\n时长: %2")
+                               .arg(entry.song.filePath())
+                               .arg(QString::number(entry.song.duration())));
+                widget->addItem(item);
+            }
+            widget->setUpdatesEnabled(true);
+        };
+
+        runner.run({populate, save, load, restore}, [songs, list, size, snapshotPath]() {
+            *songs = SyntheticData::generateSongs(size, 0x51D0000u + size);
+            list->reset(new QListWidget());
+            QDir().mkpath(QFileInfo(snapshotPath).absolutePath());
+            return LibrarySnapshot::save(snapshotPath, snapshotFor(*songs));
+        }, [songs, list, snapshotPath]() {
+            list->reset();
+            songs->clear();
+            QFile::remove(snapshotPath);
+        });
+    }
+}
@@ -0,0 +1,330 @@
+#include "benchmarkrunner.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QHash>
+#include <QVector>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+
+namespace {
+
+const double DEFAULT_TOLERANCE = 0.15;
+
+double percentile(const QVector<double>& sorted, double fraction)
+{
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    const int index = qBound(0, static_cast<int>(fraction * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+    return sorted[index];
+}
+
+QString formatDuration(double ns)
+{
+    if (ns >= 1e9) {
+        return QString("%1 s").arg(ns / 1e9, 0, 'f', 2);
+    }
+    if (ns >= 1e6) {
+        return QString("%1 ms").arg(ns / 1e6, 0, 'f', 2);
+    }
+    if (ns >= 1e3) {
+        return QString("%1 us").arg(ns / 1e3, 0, 'f', 2);
+    }
+    return QString("%1 ns").arg(ns, 0, 'f', 0);
+}
+
+QString formatRate(double perSecond, const QString& unit)
+{
+    if (perSecond >= 1e9) {
+        return QString("%1 G%2/s").arg(perSecond / 1e9, 0, 'f', 2).arg(unit);
+    }
+    if (perSecond >= 1e6) {
+        return QString("%1 M%2/s").arg(perSecond / 1e6, 0, 'f', 2).arg(unit);
+    }
+    if (perSecond >= 1e3) {
+        return QString("%1 K%2/s").arg(perSecond / 1e3, 0, 'f', 2).arg(unit);
+    }
+    return QString("%1 %2/s").arg(perSecond, 0, 'f', 1).arg(unit);
+}
+
+QJsonObject readJsonObject(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "无法读取 %s\n", qPrintable(filePath));
+        return QJsonObject();
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        fprintf(stderr, "%s 解析失败: %s\n", qPrintable(filePath), qPrintable(error.errorString()));
+    }
+    return document.object();
+}
+
+} // namespace
+
+QJsonObject BenchmarkResult::toJson() const
+{
+    QJsonObject object;
+    object["name"] = name;
+    object["iterations"] = iterations;
+    object["median_ns"] = medianNs;
+    object["p95_ns"] = p95Ns;
+    object["min_ns"] = minNs;
+    object["mean_ns"] = meanNs;
+    if (items > 0) {
+        object["items_per_iteration"] = items;
+        object["items_per_second"] = itemsPerSecond();
+    }
+    if (bytes > 0) {
+        object["bytes_per_iteration"] = bytes;
+        object["bytes_per_second"] = bytesPerSecond();
+    }
+    if (baselineMedianNs > 0) {
+        object["baseline_median_ns"] = baselineMedianNs;
+        object["change"] = change;
+    }
+    object["tolerance"] = tolerance;
+    if (budgetNs > 0) {
+        object["budget_ns"] = budgetNs;
+    }
+    object["status"] = status;
+    return object;
+}
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options)
+    : m_options(options)
+{
+}
+
+bool BenchmarkRunner::matches(const QString& name) const
+{
+    return m_options.filter.pattern().isEmpty() || m_options.filter.match(name).hasMatch();
+}
+
+void BenchmarkRunner::run(const BenchmarkCase& benchmark)
+{
+    run(QList<BenchmarkCase>{benchmark});
+}
+
+void BenchmarkRunner::run(const QList<BenchmarkCase>& cases, const std::function<bool()>& setup,
+                          const std::function<void()>& teardown)
+{
+    QList<BenchmarkCase> selected;
+    for (const BenchmarkCase& benchmark : cases) {
+        if (matches(benchmark.name)) {
+            selected.append(benchmark);
+        }
+    }
+    if (selected.isEmpty()) {
+        return;
+    }
+
+    if (m_options.listOnly) {
+        for (const BenchmarkCase& benchmark : selected) {
+            printf("%s\n", qPrintable(benchmark.name));
+        }
+        return;
+    }
+
+    if (setup && !setup()) {
+        for (const BenchmarkCase& benchmark : selected) {
+            m_failures.append(benchmark.name);
+            fprintf(stderr, "%-48s 准备失败，跳过\n", qPrintable(benchmark.name));
+        }
+        return;
+    }
+
+    for (const BenchmarkCase& benchmark : selected) {
+        const BenchmarkResult result = measure(benchmark);
+        m_results.append(result);
+
+        QString line = QString("%1 %2 (p95 %3, %4次)")
+                           .arg(result.name, -48)
+                           .arg(formatDuration(result.medianNs), 12)
+                           .arg(formatDuration(result.p95Ns))
+                           .arg(result.iterations);
+        if (result.bytes > 0) {
+            line += "  " + formatRate(result.bytesPerSecond(), "B");
+        } else if (result.items > 0) {
+            line += "  " + formatRate(result.itemsPerSecond(), "项");
+        }
+        printf("%s\n", qPrintable(line));
+        fflush(stdout);
+    }
+
+    if (teardown) {
+        teardown();
+    }
+}
+
+BenchmarkResult BenchmarkRunner::measure(const BenchmarkCase& benchmark) const
+{
+    // 预热：填充缓存、完成惰性初始化
+    benchmark.run();
+
+    QVector<double> samples;
+    QElapsedTimer total;
+    total.start();
+    while ((samples.size() < m_options.minIterations || total.elapsed() < m_options.minTimeMs)
+           && samples.size() < m_options.maxIterations) {
+        QElapsedTimer timer;
+        timer.start();
+        benchmark.run();
+        samples.append(static_cast<double>(timer.nsecsElapsed()));
+    }
+
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.items = benchmark.items;
+    result.bytes = benchmark.bytes;
+    result.iterations = samples.size();
+
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    std::sort(samples.begin(), samples.end());
+    result.medianNs = percentile(samples, 0.5);
+    result.p95Ns = percentile(samples, 0.95);
+    result.minNs = samples.isEmpty() ? 0.0 : samples.first();
+    result.meanNs = samples.isEmpty() ? 0.0 : sum / samples.size();
+    return result;
+}
+
+int BenchmarkRunner::compare(const QString& baselinePath, const QString& thresholdsPath)
+{
+    QHash<QString, double> baseline;
+    if (!baselinePath.isEmpty()) {
+        const QJsonArray entries = readJsonObject(baselinePath).value("results").toArray();
+        for (const QJsonValue& entry : entries) {
+            const QJsonObject object = entry.toObject();
+            baseline.insert(object.value("name").toString(), object.value("median_ns").toDouble());
+        }
+    }
+
+    const QJsonObject thresholds = thresholdsPath.isEmpty() ? QJsonObject() : readJsonObject(thresholdsPath);
+
+    int regressions = 0;
+    for (BenchmarkResult& result : m_results) {
+        resolveThreshold(thresholds, result.name, &result.tolerance, &result.budgetNs);
+
+        const double reference = baseline.value(result.name, 0.0);
+        if (reference > 0) {
+            result.baselineMedianNs = reference;
+            result.change = (result.medianNs - reference) / reference;
+            result.status = result.change > result.tolerance ? "regressed" : "ok";
+        } else {
+            result.status = baselinePath.isEmpty() ? "ok" : "new";
+        }
+        if (result.budgetNs > 0 && result.medianNs > result.budgetNs) {
+            result.status = "over_budget";
+        }
+        if (result.status == "regressed" || result.status == "over_budget") {
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+void BenchmarkRunner::resolveThreshold(const QJsonObject& thresholds, const QString& name,
+                                       double* tolerance, double* budgetNs)
+{
+    // 收集匹配的规则及其具体程度，精确名称排在所有通配符之前
+    QList<QPair<int, QJsonObject>> matched;
+    const QJsonArray rules = thresholds.value("benchmarks").toArray();
+    for (const QJsonValue& rule : rules) {
+        const QJsonObject object = rule.toObject();
+        const QString pattern = object.value("name").toString();
+        if (!pattern.contains('*')) {
+            if (pattern == name) {
+                matched.append(qMakePair(INT_MAX, object));
+            }
+            continue;
+        }
+        // '*'匹配任意字符（包括规模后缀前的'/'）
+        QStringList parts = pattern.split('*');
+        for (QString& part : parts) {
+            part = QRegularExpression::escape(part);
+        }
+        if (QRegularExpression("^" + parts.join(".*") + "$").match(name).hasMatch()) {
+            matched.append(qMakePair(static_cast<int>(pattern.size() - pattern.count('*')), object));
+        }
+    }
+    std::stable_sort(matched.begin(), matched.end(),
+                     [](const QPair<int, QJsonObject>& a, const QPair<int, QJsonObject>& b) {
+                         return a.first > b.first;
+                     });
+
+    *tolerance = thresholds.value("default_tolerance").toDouble(DEFAULT_TOLERANCE);
+    *budgetNs = 0.0;
+    for (const auto& rule : matched) {
+        if (rule.second.contains("tolerance")) {
+            *tolerance = rule.second.value("tolerance").toDouble(*tolerance);
+            break;
+        }
+    }
+    for (const auto& rule : matched) {
+        if (rule.second.contains("max_median_ms")) {
+            *budgetNs = rule.second.value("max_median_ms").toDouble(0.0) * 1e6;
+            break;
+        }
+    }
+}
+
+bool BenchmarkRunner::writeJson(const QString& filePath) const
+{
+    QJsonObject machine;
+    machine["os"] = QSysInfo::prettyProductName();
+    machine["cpu_architecture"] = QSysInfo::currentCpuArchitecture();
+    machine["host"] = QSysInfo::machineHostName();
+    machine["qt_version"] = QString::fromLatin1(qVersion());
+
+    QJsonArray results;
+    for (const BenchmarkResult& result : m_results) {
+        results.append(result.toJson());
+    }
+
+    QJsonObject root;
+    root["format_version"] = 1;
+    root["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["machine"] = machine;
+    root["min_time_ms"] = m_options.minTimeMs;
+    root["results"] = results;
+    root["failures"] = QJsonArray::fromStringList(m_failures);
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        fprintf(stderr, "无法写入结果文件 %s\n", qPrintable(filePath));
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+void BenchmarkRunner::printSummary() const
+{
+    int regressed = 0;
+    for (const BenchmarkResult& result : m_results) {
+        if (result.status != "regressed" && result.status != "over_budget") {
+            continue;
+        }
+        ++regressed;
+        if (result.status == "over_budget") {
+            printf("超出预算: %s 中位数 %s > 预算 %s\n", qPrintable(result.name),
+                   qPrintable(formatDuration(result.medianNs)), qPrintable(formatDuration(result.budgetNs)));
+        } else {
+            printf("性能回归: %s 中位数 %s，基线 %s (%+.1f%%，容差 %.0f%%)\n", qPrintable(result.name),
+                   qPrintable(formatDuration(result.medianNs)), qPrintable(formatDuration(result.baselineMedianNs)),
+                   result.change * 100, result.tolerance * 100);
+        }
+    }
+    printf("共 %d 个用例，%d 个回归，%d 个准备失败\n",
+           static_cast<int>(m_results.size()), regressed, static_cast<int>(m_failures.size()));
+}
@@ -0,0 +1,144 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QRegularExpression>
+#include <QJsonObject>
+#include <functional>
+
+/**
+ * @brief 基准测试运行参数
+ */
+struct BenchmarkOptions
+{
+    QRegularExpression filter;                       // 只运行名称匹配的用例，空表示全部
+    QList<int> librarySizes = {1000, 10000, 100000}; // 合成曲库规模
+    QString workDirectory;                           // 合成数据目录
+    int audioSeconds = 30;                           // 合成音频时长
+    int minIterations = 5;
+    int maxIterations = 100000;
+    qint64 minTimeMs = 300;                          // 每个用例至少运行的时间
+    bool listOnly = false;                           // 只列出用例名，不运行
+};
+
+/**
+ * @brief 单个基准测试用例
+ * @details run执行一次迭代；items/bytes为每次迭代处理的条目数和字节数，用于计算吞吐量。
+ */
+struct BenchmarkCase
+{
+    QString name;  // 分组.对象.操作[/规模]，如 db.songs.getAllSongs/10000
+    std::function<void()> run;
+    qint64 items = 0;
+    qint64 bytes = 0;
+};
+
+/**
+ * @brief 单个用例的测量结果
+ */
+struct BenchmarkResult
+{
+    QString name;
+    int iterations = 0;
+    double medianNs = 0.0;
+    double p95Ns = 0.0;
+    double minNs = 0.0;
+    double meanNs = 0.0;
+    qint64 items = 0;
+    qint64 bytes = 0;
+
+    // 与基线和阈值比较后填写
+    double baselineMedianNs = 0.0;
+    double change = 0.0;           // 相对基线的变化比例
+    double tolerance = 0.0;
+    double budgetNs = 0.0;         // 绝对预算，0表示无
+    QString status = "ok";         // ok / new / regressed / over_budget
+
+    double itemsPerSecond() const { return medianNs > 0 ? items * 1e9 / medianNs : 0.0; }
+    double bytesPerSecond() const { return medianNs > 0 ? bytes * 1e9 / medianNs : 0.0; }
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief 基准测试运行器
+ * @details 用例在提交时立即运行：先执行一次预热，然后至少迭代minIterations次且至少运行minTimeMs，
+ *          取每次迭代耗时的中位数、P95和最小值。结果可写成JSON，并与上次结果（基线）及
+ *          阈值文件比较，超过容差或绝对预算的用例记为回归。
+ */
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const BenchmarkOptions& options);
+
+    const BenchmarkOptions& options() const { return m_options; }
+
+    bool matches(const QString& name) const;
+
+    /**
+     * @brief 运行一个用例（名称不匹配时跳过）
+     */
+    void run(const BenchmarkCase& benchmark);
+
+    /**
+     * @brief 运行一组共用准备工作的用例
+     * @param setup 只有存在匹配的用例时才调用；返回false时整组跳过并记录失败
+     * @param teardown setup成功后在组结束时调用
+     */
+    void run(const QList<BenchmarkCase>& cases, const std::function<bool()>& setup = {},
+             const std::function<void()>& teardown = {});
+
+    const QList<BenchmarkResult>& results() const { return m_results; }
+    QStringList failures() const { return m_failures; }
+
+    /**
+     * @brief 与基线结果和阈值文件比较
+     * @param baselinePath 上次运行输出的JSON，可为空
+     * @param thresholdsPath 阈值文件，可为空（使用默认容差）
+     * @return 回归的用例数
+     */
+    int compare(const QString& baselinePath, const QString& thresholdsPath);
+
+    /**
+     * @brief 按阈值文件中的规则计算用例的容差和绝对预算
+     * @details 所有匹配的规则按具体程度排序：精确名称最具体，通配符规则按非'*'字符数，
+     *          相同时文件中靠前的优先。每个字段取定义了它的最具体规则，因此只写了预算的
+     *          具体规则仍继承分类通配符（如db.*）的容差。
+     * @param thresholds 阈值文件内容，可为空对象
+     */
+    static void resolveThreshold(const QJsonObject& thresholds, const QString& name,
+                                 double* tolerance, double* budgetNs);
+
+    bool writeJson(const QString& filePath) const;
+    void printSummary() const;
+
+private:
+    BenchmarkResult measure(const BenchmarkCase& benchmark) const;
+
+    BenchmarkOptions m_options;
+    QList<BenchmarkResult> m_results;
+    QStringList m_failures;
+};
+
+/**
+ * @brief 阻止编译器把基准测试中的计算结果优化掉
+ */
+template <typename T>
+inline void benchmarkKeep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+// 各组用例的注册入口
+void runAudioBenchmarks(BenchmarkRunner& runner);
+void runDatabaseBenchmarks(BenchmarkRunner& runner);
+void runCacheBenchmarks(BenchmarkRunner& runner);
+void runUiBenchmarks(BenchmarkRunner& runner);
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,104 @@
+# 性能基准测试程序
+# 构建：qmake tests/benchmarks/benchmarks.pro && make
+# 运行：musicPlayHandleBench --thresholds tests/benchmarks/thresholds.json --baseline 上次结果.json
+# 自检：musicPlayHandleBench --self-test
+
+QT += core gui widgets sql network concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = musicPlayHandleBench
+TEMPLATE = app
+
+ROOT = $$PWD/../..
+
+DEFINES += QT_DEPRECATED_WARNINGS
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000
+
+SOURCES += \
+    main.cpp \
+    benchmarkrunner.cpp \
+    syntheticdata.cpp \
+    bench_audio.cpp \
+    bench_cache.cpp \
+    bench_database.cpp \
+    bench_ui.cpp \
+    $$ROOT/src/core/appconfig.cpp \
+    $$ROOT/src/core/logger.cpp \
+    $$ROOT/src/core/tracer.cpp \
+    $$ROOT/src/core/metricsregistry.cpp \
+    $$ROOT/src/core/roaringbitmap.cpp \
+    $$ROOT/src/database/basedao.cpp \
+    $$ROOT/src/database/databasemanager.cpp \
+    $$ROOT/src/database/logdao.cpp \
+    $$ROOT/src/database/songdao.cpp \
+    $$ROOT/src/database/tagdao.cpp \
+    $$ROOT/src/database/playhistorydao.cpp \
+    $$ROOT/src/database/playstatsdao.cpp \
+    $$ROOT/src/database/smartplaylistdao.cpp \
+    $$ROOT/src/database/tagindex.cpp \
+    $$ROOT/src/database/playlistdao.cpp \
+    $$ROOT/src/models/song.cpp \
+    $$ROOT/src/models/playlist.cpp \
+    $$ROOT/src/models/tag.cpp \
+    $$ROOT/src/models/playhistory.cpp \
+    $$ROOT/src/models/errorlog.cpp \
+    $$ROOT/src/models/systemlog.cpp \
+    $$ROOT/src/audio/audioiocontext.cpp \
+    $$ROOT/src/audio/mappedfilecache.cpp \
+    $$ROOT/src/managers/librarysnapshot.cpp \
+    $$ROOT/src/managers/playlistio.cpp \
+    $$ROOT/src/managers/smartplaylist.cpp
+
+HEADERS += \
+    benchmarkrunner.h \
+    syntheticdata.h \
+    $$ROOT/src/audio/audiokernels.h \
+    $$ROOT/src/core/appconfig.h \
+    $$ROOT/src/core/logger.h \
+    $$ROOT/src/core/tracer.h \
+    $$ROOT/src/core/metricsregistry.h \
+    $$ROOT/src/core/roaringbitmap.h \
+    $$ROOT/src/core/shardedcache.h \
+    $$ROOT/src/database/basedao.h \
+    $$ROOT/src/database/databasemanager.h \
+    $$ROOT/src/database/logdao.h \
+    $$ROOT/src/database/songdao.h \
+    $$ROOT/src/database/tagdao.h \
+    $$ROOT/src/database/playhistorydao.h \
+    $$ROOT/src/database/playstatsdao.h \
+    $$ROOT/src/database/smartplaylistdao.h \
+    $$ROOT/src/database/tagindex.h \
+    $$ROOT/src/database/playlistdao.h \
+    $$ROOT/src/audio/audioiocontext.h \
+    $$ROOT/src/audio/mappedfilecache.h \
+    $$ROOT/src/managers/librarysnapshot.h \
+    $$ROOT/src/managers/playlistio.h \
+    $$ROOT/src/managers/smartplaylist.h
+
+INCLUDEPATH += \
+    $$ROOT \
+    $$ROOT/src \
+    $$ROOT/src/core \
+    $$ROOT/src/database \
+    $$ROOT/src/models \
+    $$ROOT/src/audio \
+    $$ROOT/src/managers \
+    $$ROOT/third_party/ffmpeg/include
+
+win32 {
+    LIBS += -L$$ROOT/third_party/ffmpeg/lib \
+            -lavformat \
+            -lavcodec \
+            -lavutil \
+            -lswresample
+    LIBS += -lpsapi
+} else {
+    LIBS += -lavformat -lavcodec -lavutil -lswresample
+}
+
+# 基准测试始终按发布配置编译，调试构建的数字没有比较意义
+CONFIG -= debug
+CONFIG += release
+DEFINES += RELEASE_MODE
@@ -0,0 +1,183 @@
+/**
+ * @file main.cpp
+ * @brief 性能基准测试入口
+ * @details 在合成数据上测量音频、数据库、缓存和界面热点，结果写成JSON，可与上次结果比较。
+ *
+ * 用法：
+ *   musicPlayHandleBench [--filter 正则] [--sizes 1000,10000] [--output results.json]
+ *                        [--baseline 上次结果.json] [--thresholds thresholds.json]
+ *                        [--workdir 目录] [--min-time 毫秒] [--audio-seconds 秒] [--list]
+ *   musicPlayHandleBench --self-test   检查运行器自身（阈值规则的优先级）
+ *
+ * 退出码：0 全部通过；1 存在回归或超出预算（自检失败）；2 有用例准备失败；3 参数错误。
+ */
+
+#include "benchmarkrunner.h"
+#include "../../src/audio/mappedfilecache.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// 被测代码在热路径上输出大量qDebug，只保留警告和错误，避免终端输出影响计时
+void quietMessageHandler(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+    if (type != QtDebugMsg && type != QtInfoMsg) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+// 阈值规则优先级自检：规则顺序与thresholds.json相同，具体规则写在分类通配符之前
+int runSelfTest()
+{
+    QJsonArray rules;
+    rules.append(QJsonObject{{"name", "cache.*.4threads"}, {"tolerance", 0.25}});
+    rules.append(QJsonObject{{"name", "db.songs.getAllSongs/10000"}, {"max_median_ms", 400}});
+    rules.append(QJsonObject{{"name", "db.history.getRecentPlayedSongs/*"}, {"max_median_ms", 50}});
+    rules.append(QJsonObject{{"name", "db.history.*"}, {"tolerance", 0.30}});
+    rules.append(QJsonObject{{"name", "db.history.getRecentPlayedSongs/100000"}, {"tolerance", 0.40}});
+    rules.append(QJsonObject{{"name", "cache.*"}, {"tolerance", 0.05}});
+    rules.append(QJsonObject{{"name", "db.*"}, {"tolerance", 0.20}});
+    const QJsonObject thresholds{{"default_tolerance", 0.15}, {"benchmarks", rules}};
+
+    struct Expectation {
+        const char* name;
+        double tolerance;
+        double budgetMs;
+    };
+    const Expectation expectations[] = {
+        // 只写预算的具体规则继承分类容差
+        {"db.songs.getAllSongs/10000", 0.20, 400},
+        {"db.songs.getAllSongs/1000", 0.20, 0},
+        // 更具体的通配符优先于写在后面的宽泛通配符
+        {"db.history.getRecentPlayedSongs/1000", 0.30, 50},
+        // 精确名称优先于所有通配符
+        {"db.history.getRecentPlayedSongs/100000", 0.40, 50},
+        // 写在前面的宽泛规则不会盖过更具体的规则
+        {"cache.lru.4threads", 0.25, 0},
+        {"cache.lru.get", 0.05, 0},
+        // 无匹配规则时使用默认容差
+        {"audio.kernel.mix", 0.15, 0},
+    };
+
+    int failures = 0;
+    for (const Expectation& expected : expectations) {
+        double tolerance = 0.0;
+        double budgetNs = 0.0;
+        BenchmarkRunner::resolveThreshold(thresholds, expected.name, &tolerance, &budgetNs);
+        if (std::fabs(tolerance - expected.tolerance) > 1e-9 || std::fabs(budgetNs - expected.budgetMs * 1e6) > 1e-3) {
+            fprintf(stderr, "自检失败: %s 容差 %.2f 预算 %.0f ms，期望容差 %.2f 预算 %.0f ms\n",
+                    expected.name, tolerance, budgetNs / 1e6, expected.tolerance, expected.budgetMs);
+            ++failures;
+        }
+    }
+
+    double tolerance = 0.0;
+    double budgetNs = 0.0;
+    BenchmarkRunner::resolveThreshold(QJsonObject(), "db.songs.getAllSongs/10000", &tolerance, &budgetNs);
+    if (std::fabs(tolerance - 0.15) > 1e-9 || budgetNs != 0.0) {
+        fprintf(stderr, "自检失败: 没有阈值文件时应使用默认容差且无预算\n");
+        ++failures;
+    }
+
+    printf("阈值规则自检%s\n", failures == 0 ? "通过" : "失败");
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // 列表控件需要QApplication；无显示环境时使用offscreen平台
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("musicPlayHandleBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("musicPlayHandle 性能基准测试");
+    parser.addHelpOption();
+
+    QCommandLineOption filterOption("filter", "只运行名称匹配该正则的用例", "regex");
+    QCommandLineOption sizesOption("sizes", "合成曲库规模，逗号分隔", "list", "1000,10000,100000");
+    QCommandLineOption outputOption("output", "结果JSON路径", "path", "benchmark_results.json");
+    QCommandLineOption baselineOption("baseline", "作为基线的上次结果JSON", "path");
+    QCommandLineOption thresholdsOption("thresholds", "回归阈值文件", "path");
+    QCommandLineOption workdirOption("workdir", "合成数据目录（默认临时目录）", "path");
+    QCommandLineOption minTimeOption("min-time", "每个用例的最短运行时间（毫秒）", "ms", "300");
+    QCommandLineOption audioSecondsOption("audio-seconds", "合成音频时长（秒）", "seconds", "30");
+    QCommandLineOption listOption("list", "只列出用例名");
+    QCommandLineOption selfTestOption("self-test", "检查阈值规则的优先级后退出");
+    parser.addOptions({filterOption, sizesOption, outputOption, baselineOption, thresholdsOption,
+                       workdirOption, minTimeOption, audioSecondsOption, listOption, selfTestOption});
+    parser.process(app);
+
+    if (parser.isSet(selfTestOption)) {
+        return runSelfTest();
+    }
+
+    BenchmarkOptions options;
+    if (parser.isSet(filterOption)) {
+        options.filter.setPattern(parser.value(filterOption));
+        if (!options.filter.isValid()) {
+            fprintf(stderr, "无效的--filter: %s\n", qPrintable(options.filter.errorString()));
+            return 3;
+        }
+    }
+    options.librarySizes.clear();
+    for (const QString& size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int value = size.trimmed().toInt(&ok);
+        if (!ok || value <= 0) {
+            fprintf(stderr, "无效的规模: %s\n", qPrintable(size));
+            return 3;
+        }
+        options.librarySizes.append(value);
+    }
+    options.minTimeMs = parser.value(minTimeOption).toLongLong();
+    options.audioSeconds = qMax(1, parser.value(audioSecondsOption).toInt());
+    options.listOnly = parser.isSet(listOption);
+
+    QTemporaryDir temporaryDir;
+    if (parser.isSet(workdirOption)) {
+        options.workDirectory = QDir(parser.value(workdirOption)).absolutePath();
+        QDir().mkpath(options.workDirectory);
+    } else if (temporaryDir.isValid()) {
+        options.workDirectory = temporaryDir.path();
+    } else {
+        fprintf(stderr, "无法创建临时目录\n");
+        return 2;
+    }
+
+    qInstallMessageHandler(quietMessageHandler);
+
+    BenchmarkRunner runner(options);
+    runAudioBenchmarks(runner);
+    runCacheBenchmarks(runner);
+    runDatabaseBenchmarks(runner);
+    runUiBenchmarks(runner);
+    MappedFileCache::cleanup();
+
+    if (options.listOnly) {
+        return 0;
+    }
+
+    const int regressions = runner.compare(parser.value(baselineOption), parser.value(thresholdsOption));
+    runner.printSummary();
+    if (!runner.writeJson(parser.value(outputOption))) {
+        return 2;
+    }
+
+    if (regressions > 0) {
+        return 1;
+    }
+    return runner.failures().isEmpty() ? 0 : 2;
+}
@@ -0,0 +1,312 @@
+#include "syntheticdata.h"
+#include <QRandomGenerator>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QHash>
+#include <QtMath>
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+}
+
+namespace {
+
+const char* const WORDS[] = {
+    "Midnight", "River", "Echo", "Silver", "Summer", "Rain", "Golden", "Shadow",
+    "Blue", "Morning", "Fire", "Ocean", "Dream", "City", "Light", "Winter",
+    "晴天", "夜曲", "稻香", "光年", "海阔天空", "后来", "平凡之路", "春风"
+};
+const int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+const char* const TAG_COLORS[] = {
+    "#3498db", "#e74c3c", "#2ecc71", "#f1c40f", "#9b59b6", "#1abc9c", "#e67e22", "#34495e"
+};
+
+QString phrase(QRandomGenerator& rng, int words)
+{
+    QStringList parts;
+    for (int i = 0; i < words; ++i) {
+        parts.append(QString::fromUtf8(WORDS[rng.bounded(WORD_COUNT)]));
+    }
+    return parts.join(' ');
+}
+
+/**
+ * @brief 偏斜分布的下标：靠前的下标被选中的概率更高
+ */
+int skewedIndex(QRandomGenerator& rng, int count)
+{
+    const double r = rng.generateDouble();
+    return qMin(count - 1, static_cast<int>(r * r * count));
+}
+
+bool execPrepared(QSqlQuery& query, const char* what)
+{
+    if (!query.exec()) {
+        fprintf(stderr, "写入%s失败: %s\n", what, qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+QList<Song> SyntheticData::generateSongs(int count, quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    const int artistCount = qMax(10, count / 20);
+
+    QList<Song> songs;
+    songs.reserve(count);
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < count; ++i) {
+        const int artist = skewedIndex(rng, artistCount);
+        Song song;
+        song.setId(i + 1);
+        song.setTitle(QString("%1 %2").arg(phrase(rng, 2)).arg(i + 1));
+        song.setArtist(QString("%1 %2").arg(QString::fromUtf8(WORDS[artist % WORD_COUNT])).arg(artist));
+        song.setAlbum(QString("%1 Vol.%2").arg(phrase(rng, 1)).arg(artist % 7 + 1));
+        song.setCachedFilePath(QString("/synthetic/%1/%2/%3.flac").arg(artist).arg(artist % 7 + 1).arg(i + 1));
+        song.setDuration(120000 + rng.bounded(300000));
+        song.setFileSize(3000000 + rng.bounded(9000000));
+        song.setPlayCount(rng.bounded(50));
+        song.setRating(rng.bounded(6));
+        if (rng.bounded(3) == 0) {
+            song.setLastPlayedTime(now.addSecs(-static_cast<qint64>(rng.bounded(180 * 24 * 3600))));
+        }
+        songs.append(song);
+    }
+    return songs;
+}
+
+bool SyntheticData::populateLibrary(QSqlDatabase database, int songCount, quint32 seed, LibraryStats* stats)
+{
+    QRandomGenerator rng(seed);
+    LibraryStats result;
+
+    if (!database.transaction()) {
+        fprintf(stderr, "开始事务失败: %s\n", qPrintable(database.lastError().text()));
+        return false;
+    }
+
+    // 用户标签
+    QList<int> tagIds;
+    QSqlQuery tagQuery(database);
+    tagQuery.prepare("INSERT INTO tags (name, color, description, is_system) VALUES (?, ?, ?, 0)");
+    const int tagCount = qMax(8, songCount / 250);
+    for (int i = 0; i < tagCount; ++i) {
+        tagQuery.addBindValue(QString("合成标签%1").arg(i + 1));
+        tagQuery.addBindValue(QString::fromLatin1(TAG_COLORS[i % 8]));
+        tagQuery.addBindValue(QString("synthetic #%1").arg(i + 1));
+        if (!execPrepared(tagQuery, "标签")) {
+            database.rollback();
+            return false;
+        }
+        tagIds.append(tagQuery.lastInsertId().toInt());
+    }
+    result.tags = tagIds.size();
+
+    // 歌曲
+    const QList<Song> songs = generateSongs(songCount, seed);
+    QList<int> songIds;
+    songIds.reserve(songCount);
+    QSqlQuery songQuery(database);
+    songQuery.prepare(R"(
+        INSERT INTO songs (title, artist, album, file_path, duration, file_size, play_count, rating, last_played)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    for (const Song& song : songs) {
+        songQuery.addBindValue(song.title());
+        songQuery.addBindValue(song.artist());
+        songQuery.addBindValue(song.album());
+        songQuery.addBindValue(song.filePath());
+        songQuery.addBindValue(song.duration());
+        songQuery.addBindValue(song.fileSize());
+        songQuery.addBindValue(song.playCount());
+        songQuery.addBindValue(song.rating());
+        songQuery.addBindValue(song.lastPlayedTime().isValid() ? QVariant(song.lastPlayedTime()) : QVariant());
+        if (!execPrepared(songQuery, "歌曲")) {
+            database.rollback();
+            return false;
+        }
+        songIds.append(songQuery.lastInsertId().toInt());
+    }
+    result.songs = songIds.size();
+
+    // 歌曲-标签关联
+    QHash<int, int> tagUsage;
+    QSqlQuery linkQuery(database);
+    linkQuery.prepare("INSERT OR IGNORE INTO song_tags (song_id, tag_id) VALUES (?, ?)");
+    for (int songId : songIds) {
+        const int links = rng.bounded(4);
+        for (int i = 0; i < links; ++i) {
+            const int tagId = tagIds[skewedIndex(rng, tagIds.size())];
+            linkQuery.addBindValue(songId);
+            linkQuery.addBindValue(tagId);
+            if (!execPrepared(linkQuery, "标签关联")) {
+                database.rollback();
+                return false;
+            }
+            if (linkQuery.numRowsAffected() > 0) {
+                ++tagUsage[tagId];
+                ++result.songTags;
+            }
+        }
+    }
+    int busiestCount = -1;
+    int secondCount = -1;
+    for (auto it = tagUsage.constBegin(); it != tagUsage.constEnd(); ++it) {
+        if (it.value() > busiestCount) {
+            secondCount = busiestCount;
+            result.secondTagId = result.busiestTagId;
+            busiestCount = it.value();
+            result.busiestTagId = it.key();
+        } else if (it.value() > secondCount) {
+            secondCount = it.value();
+            result.secondTagId = it.key();
+        }
+    }
+
+    // 播放历史
+    QSqlQuery historyQuery(database);
+    historyQuery.prepare("INSERT INTO play_history (song_id, played_at) VALUES (?, ?)");
+    const QDateTime now = QDateTime::currentDateTime();
+    const int recordCount = songCount * 2;
+    for (int i = 0; i < recordCount; ++i) {
+        historyQuery.addBindValue(songIds[skewedIndex(rng, songIds.size())]);
+        historyQuery.addBindValue(now.addSecs(-static_cast<qint64>(rng.bounded(180 * 24 * 3600))));
+        if (!execPrepared(historyQuery, "播放历史")) {
+            database.rollback();
+            return false;
+        }
+    }
+    result.playRecords = recordCount;
+
+    if (!database.commit()) {
+        fprintf(stderr, "提交事务失败: %s\n", qPrintable(database.lastError().text()));
+        return false;
+    }
+
+    if (stats) {
+        *stats = result;
+    }
+    return true;
+}
+
+QVector<int16_t> SyntheticData::generateSamples(int frameCount, int channels, int sampleRate, quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    QVector<int16_t> samples(frameCount * channels);
+    const double low = 2.0 * M_PI * 220.0 / sampleRate;
+    const double high = 2.0 * M_PI * 1760.0 / sampleRate;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        // 缓慢变化的包络，避免整段音频完全周期化
+        const double envelope = 0.6 + 0.3 * qSin(frame * 2.0 * M_PI / (sampleRate * 4));
+        for (int channel = 0; channel < channels; ++channel) {
+            const double tone = 0.5 * qSin(frame * low + channel) + 0.2 * qSin(frame * high);
+            const double noise = (rng.generateDouble() - 0.5) * 0.02;
+            const double value = qBound(-1.0, (tone * envelope) + noise, 1.0);
+            samples[frame * channels + channel] = static_cast<int16_t>(value * 32767.0);
+        }
+    }
+    return samples;
+}
+
+bool SyntheticData::writeAudioFile(const QString& filePath, const char* codecName,
+                                   int sampleRate, int channels, int seconds, quint32 seed)
+{
+    const AVCodec* codec = avcodec_find_encoder_by_name(codecName);
+    if (!codec) {
+        fprintf(stderr, "FFmpeg不支持编码器%s\n", codecName);
+        return false;
+    }
+
+    const QByteArray path = filePath.toUtf8();
+    AVFormatContext* output = nullptr;
+    if (avformat_alloc_output_context2(&output, nullptr, nullptr, path.constData()) < 0 || !output) {
+        return false;
+    }
+
+    AVCodecContext* encoder = avcodec_alloc_context3(codec);
+    AVStream* stream = avformat_new_stream(output, nullptr);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    bool success = false;
+
+    auto drain = [&](AVFrame* input) {
+        if (avcodec_send_frame(encoder, input) < 0) {
+            return false;
+        }
+        while (avcodec_receive_packet(encoder, packet) == 0) {
+            av_packet_rescale_ts(packet, encoder->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            if (av_interleaved_write_frame(output, packet) < 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    do {
+        if (!encoder || !stream || !frame || !packet) {
+            break;
+        }
+        encoder->sample_fmt = AV_SAMPLE_FMT_S16;
+        encoder->sample_rate = sampleRate;
+        av_channel_layout_default(&encoder->ch_layout, channels);
+        encoder->time_base = AVRational{1, sampleRate};
+        if (output->oformat->flags & AVFMT_GLOBALHEADER) {
+            encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        if (avcodec_open2(encoder, codec, nullptr) < 0
+            || avcodec_parameters_from_context(stream->codecpar, encoder) < 0) {
+            break;
+        }
+        stream->time_base = encoder->time_base;
+        if (avio_open(&output->pb, path.constData(), AVIO_FLAG_WRITE) < 0) {
+            break;
+        }
+        if (avformat_write_header(output, nullptr) < 0) {
+            break;
+        }
+
+        const int totalFrames = sampleRate * seconds;
+        const QVector<int16_t> samples = generateSamples(totalFrames, channels, sampleRate, seed);
+        const int chunk = encoder->frame_size > 0 ? encoder->frame_size : 4096;
+
+        bool ok = true;
+        for (int position = 0; position < totalFrames && ok; position += chunk) {
+            av_frame_unref(frame);
+            frame->nb_samples = qMin(chunk, totalFrames - position);
+            frame->format = encoder->sample_fmt;
+            frame->sample_rate = sampleRate;
+            av_channel_layout_copy(&frame->ch_layout, &encoder->ch_layout);
+            if (av_frame_get_buffer(frame, 0) < 0) {
+                ok = false;
+                break;
+            }
+            memcpy(frame->data[0], samples.constData() + position * channels,
+                   static_cast<size_t>(frame->nb_samples) * channels * sizeof(int16_t));
+            frame->pts = position;
+            ok = drain(frame);
+        }
+        if (!ok || !drain(nullptr)) {
+            break;
+        }
+        success = av_write_trailer(output) == 0;
+    } while (false);
+
+    if (output && output->pb) {
+        avio_closep(&output->pb);
+    }
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&encoder);
+    avformat_free_context(output);
+    return success;
+}
@@ -0,0 +1,60 @@
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QSqlDatabase>
+#include <cstdint>
+#include "../../src/models/song.h"
+
+/**
+ * @brief 基准测试用的合成数据
+ * @details 所有数据由种子确定，同一种子在不同机器上生成相同的曲库和音频，
+ *          结果之间可以直接比较。
+ */
+class SyntheticData
+{
+public:
+    struct LibraryStats {
+        int songs = 0;
+        int tags = 0;
+        int songTags = 0;
+        int playRecords = 0;
+        int busiestTagId = -1;  // 歌曲最多的用户标签
+        int secondTagId = -1;   // 歌曲第二多的用户标签
+    };
+
+    /**
+     * @brief 生成歌曲对象（不写数据库），文件路径不指向真实文件
+     */
+    static QList<Song> generateSongs(int count, quint32 seed);
+
+    /**
+     * @brief 向已建表的数据库写入合成曲库
+     * @details 约每250首歌一个用户标签，每首歌0~3个标签（偏斜分布），
+     *          播放记录为歌曲数的两倍，分布在最近180天内。整个过程在一个事务中完成。
+     * @param database 已打开并完成建表的连接
+     * @param songCount 歌曲数
+     * @param seed 随机种子
+     * @param stats 输出生成的数量
+     * @return 是否成功
+     */
+    static bool populateLibrary(QSqlDatabase database, int songCount, quint32 seed, LibraryStats* stats);
+
+    /**
+     * @brief 生成交错int16样本：两个正弦音加低电平噪声
+     */
+    static QVector<int16_t> generateSamples(int frameCount, int channels, int sampleRate, quint32 seed);
+
+    /**
+     * @brief 用FFmpeg编码器写出合成音频文件
+     * @param filePath 输出路径，容器格式由扩展名决定（.wav/.flac等）
+     * @param codecName 编码器名，如"pcm_s16le"、"flac"
+     * @return 编码器不可用或写入失败时返回false
+     */
+    static bool writeAudioFile(const QString& filePath, const char* codecName,
+                               int sampleRate, int channels, int seconds, quint32 seed);
+};
+
+#endif // SYNTHETICDATA_H
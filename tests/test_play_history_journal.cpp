@@ -0,0 +1,145 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QProcess>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include <cstdlib>
+#include "../src/database/databasemanager.h"
+#include "../src/managers/playhistoryrecorder.h"
+
+namespace {
+
+const int RECORD_COUNT = 20;
+const int CRASH_EXIT_CODE = 3;
+
+bool populateSongs(int count)
+{
+    QSqlQuery query(DatabaseManager::instance()->database());
+    query.prepare(R"(
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?)
+        INSERT INTO songs (title, artist, album, file_path, duration)
+        SELECT printf('Song %03d', i), 'Artist', 'Album', printf('/music/%03d.mp3', i), 180000
+        FROM n
+    )");
+    query.addBindValue(count);
+    if (!query.exec()) {
+        qDebug() << "写入歌曲失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// 模拟上次运行崩溃时留下的日志：每首歌一条尚未写入数据库的播放记录
+bool writeJournal(const QString& journalPath, int count)
+{
+    QFile file(journalPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    const qint64 base = QDateTime::currentMSecsSinceEpoch() - count * 1000;
+    for (int i = 1; i <= count; ++i) {
+        file.write(QByteArray::number(i) + '\t' + QByteArray::number(base + i * 1000) + '\n');
+    }
+    return true;
+}
+
+int journalLineCount(const QString& journalPath)
+{
+    QFile file(journalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    int lines = 0;
+    while (!file.atEnd()) {
+        if (!file.readLine().trimmed().isEmpty()) {
+            ++lines;
+        }
+    }
+    return lines;
+}
+
+int playHistoryCount()
+{
+    QSqlQuery query(DatabaseManager::instance()->database());
+    return query.exec("SELECT COUNT(*) FROM play_history") && query.next() ? query.value(0).toInt() : -1;
+}
+
+// 子进程：启动时重放并重写日志，在新日志写好、替换旧日志之前直接退出
+int runCrashingChild(const QString& databasePath, const QString& journalPath)
+{
+    PlayHistoryRecorder::setJournalCommitHook([]() { std::_Exit(CRASH_EXIT_CODE); });
+    PlayHistoryRecorder::instance()->start(databasePath, journalPath);
+    qDebug() << "子进程没有在重写日志时退出";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.size() == 4 && args[1] == "--crash-child") {
+        return runCrashingChild(args[2], args[3]);
+    }
+
+    qDebug() << "开始播放历史日志崩溃测试...";
+    int failures = 0;
+
+    QTemporaryDir workDir;
+    const QString databasePath = workDir.filePath("play_history.db");
+    const QString journalPath = workDir.filePath("play_history.journal");
+    if (!workDir.isValid() || !DatabaseManager::instance()->initialize(databasePath)
+        || !populateSongs(RECORD_COUNT) || !writeJournal(journalPath, RECORD_COUNT)) {
+        qDebug() << "播放历史日志测试失败: 无法准备数据库和日志";
+        return 1;
+    }
+
+    // 1. 重写日志的过程中进程被杀死，磁盘上的日志仍然完整
+    {
+        QProcess child;
+        child.start(app.applicationFilePath(), {"--crash-child", databasePath, journalPath});
+        if (!child.waitForFinished(30000) || child.exitCode() != CRASH_EXIT_CODE) {
+            qDebug() << "失败: 子进程没有在重写日志时退出，退出码" << child.exitCode();
+            ++failures;
+        }
+        const int lines = journalLineCount(journalPath);
+        if (lines != RECORD_COUNT) {
+            qDebug() << "失败: 崩溃后日志剩余" << lines << "条，期望" << RECORD_COUNT;
+            ++failures;
+        }
+    }
+
+    // 2. 下次启动时日志中的记录全部重放进数据库，写入后日志清空
+    {
+        PlayHistoryRecorder* recorder = PlayHistoryRecorder::instance();
+        if (!recorder->start(databasePath, journalPath) || !recorder->flush(true)) {
+            qDebug() << "失败: 重放日志后没有写入完成";
+            ++failures;
+        }
+        const int written = playHistoryCount();
+        if (written != RECORD_COUNT) {
+            qDebug() << "失败: 重放后写入" << written << "条，期望" << RECORD_COUNT;
+            ++failures;
+        }
+        if (QFileInfo(journalPath).size() != 0) {
+            qDebug() << "失败: 全部写入后日志没有清空";
+            ++failures;
+        }
+        PlayHistoryRecorder::cleanup();
+    }
+
+    DatabaseManager::instance()->closeDatabase();
+
+    if (failures > 0) {
+        qDebug() << "播放历史日志测试失败，失败项:" << failures;
+        return 1;
+    }
+    qDebug() << "播放历史日志测试通过";
+    return 0;
+}
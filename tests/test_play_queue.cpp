@@ -0,0 +1,224 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSet>
+#include <QTemporaryDir>
+#include "../src/database/databasemanager.h"
+#include "../src/database/songdao.h"
+#include "../src/managers/playqueue.h"
+
+namespace {
+
+const int LIBRARY_SIZE = 100000;
+
+// 一条语句写入合成曲库，标题按编号补零，与ID顺序一致
+bool populateLibrary(int count)
+{
+    QSqlQuery query(DatabaseManager::instance()->database());
+    query.prepare(R"(
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?)
+        INSERT INTO songs (title, artist, album, file_path, duration)
+        SELECT printf('Song %06d', i), 'Artist ' || (i % 500), 'Album ' || (i % 2000),
+               printf('/music/%06d.mp3', i), 180000
+        FROM n
+    )");
+    query.addBindValue(count);
+    if (!query.exec()) {
+        qDebug() << "写入合成曲库失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// 与PlayQueue的Library来源相同的顺序，直接按位置查询
+int expectedSongIdAt(int position)
+{
+    QSqlQuery query(DatabaseManager::instance()->database());
+    query.prepare("SELECT id FROM songs ORDER BY title, id LIMIT 1 OFFSET ?");
+    query.addBindValue(position);
+    return query.exec() && query.next() ? query.value(0).toInt() : -1;
+}
+
+// 除ID窗口和随机排列之外允许的固定开销：Song缓存、历史、插播队列和对象本身
+qint64 fixedBudget()
+{
+    return sizeof(PlayQueue)
+           + PlayQueue::SONG_CACHE_SIZE * qint64(sizeof(Song) + 256)
+           + PlayQueue::MAX_HISTORY_SIZE * qint64(2 * sizeof(int))
+           + 64 * 1024;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    qDebug() << "开始播放队列测试...";
+    int failures = 0;
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid() || !DatabaseManager::instance()->initialize(workDir.filePath("play_queue.db"))
+        || !populateLibrary(LIBRARY_SIZE)) {
+        qDebug() << "播放队列测试失败: 无法准备合成曲库";
+        return 1;
+    }
+
+    PlayQueue queue;
+    const qint64 idBytes = LIBRARY_SIZE * qint64(sizeof(int));
+
+    // 1. 设置来源只统计数量，开始播放时只加载当前歌曲所在的窗口
+    {
+        const int startPosition = LIBRARY_SIZE / 2;
+        const int startSongId = expectedSongIdAt(startPosition);
+        queue.setSource(PlayQueueSource::library(), startSongId, startPosition);
+        if (queue.count() != LIBRARY_SIZE || queue.currentPosition() != startPosition
+            || queue.currentSongId() != startSongId) {
+            qDebug() << "失败: 来源数量或起始位置不正确" << queue.count() << queue.currentPosition();
+            ++failures;
+        }
+
+        const qint64 usage = queue.memoryUsage();
+        qDebug() << "开始播放后占用:" << usage << "字节";
+        if (usage > PlayQueue::WINDOW_SIZE * qint64(sizeof(int)) + fixedBudget()) {
+            qDebug() << "失败: 开始播放时加载了不止一个窗口";
+            ++failures;
+        }
+    }
+
+    // 2. 随机位置的歌曲ID与SQL顺序一致，顺序前进沿来源顺序
+    {
+        for (int position = 0; position < LIBRARY_SIZE; position += 7919) {
+            if (queue.songIdAt(position) != expectedSongIdAt(position)) {
+                qDebug() << "失败: 位置" << position << "的歌曲ID与查询顺序不一致";
+                ++failures;
+                break;
+            }
+        }
+
+        queue.jumpTo(PlayQueue::WINDOW_SIZE - 3);  // 跨越窗口边界
+        for (int step = 0; step < 2000; ++step) {
+            const int expected = queue.songIdAt(queue.currentPosition() + 1);
+            if (!queue.advance(false) || queue.currentSongId() != expected) {
+                qDebug() << "失败: 第" << step << "步前进后的歌曲不正确";
+                ++failures;
+                break;
+            }
+            queue.currentSong();
+        }
+    }
+
+    // 3. 整个来源的ID都加载后占用约为每首4字节，Song对象不随规模增长
+    {
+        for (int position = 0; position < LIBRARY_SIZE; position += PlayQueue::WINDOW_SIZE) {
+            queue.songAt(position);
+        }
+        const qint64 usage = queue.memoryUsage();
+        const qint64 materialized = LIBRARY_SIZE * qint64(sizeof(Song) + 256);
+        qDebug() << QString("全部窗口加载后占用: %1 KB（物化全部歌曲约 %2 KB）")
+                        .arg(usage / 1024).arg(materialized / 1024);
+        if (usage > idBytes + fixedBudget()) {
+            qDebug() << "失败: 顺序播放的占用超过ID窗口加固定开销";
+            ++failures;
+        }
+        if (usage * 10 > materialized) {
+            qDebug() << "失败: 占用没有明显低于物化整个来源";
+            ++failures;
+        }
+    }
+
+    // 4. 随机模式另加排列和逆映射（每首8字节）
+    {
+        queue.setShuffle(true);
+        for (int step = 0; step < 1000; ++step) {
+            queue.advance(true);
+        }
+        const qint64 usage = queue.memoryUsage();
+        qDebug() << "随机播放占用:" << usage / 1024 << "KB";
+        if (usage > idBytes + LIBRARY_SIZE * qint64(2 * sizeof(int)) + fixedBudget()) {
+            qDebug() << "失败: 随机播放的占用超过ID窗口、排列和固定开销";
+            ++failures;
+        }
+    }
+
+    // 5. 插播队列先于来源播放，播完后回到来源
+    {
+        queue.setShuffle(false);
+        queue.jumpTo(10);
+        const int resumeId = queue.songIdAt(11);
+        queue.addToQueue({5, 6});
+        queue.playNext({7});
+        const QList<int> expected = {7, 5, 6, resumeId};
+        for (int songId : expected) {
+            if (!queue.advance(false) || queue.currentSongId() != songId) {
+                qDebug() << "失败: 插播顺序不正确，期望" << songId << "实际" << queue.currentSongId();
+                ++failures;
+                break;
+            }
+        }
+    }
+
+    // 6. 播放中曲库发生变化：已设置的来源位置不变，不跳过也不重复
+    {
+        queue.setSource(PlayQueueSource::library());
+        const int probePosition = PlayQueue::WINDOW_SIZE * 3;
+        const int probeId = queue.songIdAt(probePosition);
+        const int deletedId = expectedSongIdAt(PlayQueue::WINDOW_SIZE * 5);
+
+        // 排在最前面的新歌和后面窗口中被删除的歌曲都会让按OFFSET分页的窗口错开
+        QSqlQuery query(DatabaseManager::instance()->database());
+        if (!query.exec("INSERT INTO songs (title, artist, album, file_path, duration) "
+                        "VALUES ('0 First', 'Artist', 'Album', '/music/first.mp3', 180000)")
+            || !query.exec(QString("DELETE FROM songs WHERE id = %1").arg(deletedId))) {
+            qDebug() << "失败: 无法修改曲库" << query.lastError().text();
+            ++failures;
+        }
+
+        const QList<int> ids = queue.songIds();
+        const QSet<int> unique(ids.begin(), ids.end());
+        if (ids.size() != LIBRARY_SIZE || unique.size() != LIBRARY_SIZE || !unique.contains(deletedId)) {
+            qDebug() << "失败: 曲库变化后队列跳过或重复了歌曲" << ids.size() << unique.size();
+            ++failures;
+        }
+        if (queue.positionOf(probeId) != probePosition) {
+            qDebug() << "失败: 曲库变化后已加载窗口中的歌曲位置改变";
+            ++failures;
+        }
+
+        // refresh()之后反映新的曲库
+        queue.refresh();
+        if (queue.count() != LIBRARY_SIZE || queue.songIdAt(0) != expectedSongIdAt(0)
+            || queue.positionOf(deletedId) >= 0) {
+            qDebug() << "失败: refresh()后没有反映曲库变化";
+            ++failures;
+        }
+    }
+
+    // 7. 显式歌曲列表只保存ID，歌曲对象按需读取
+    {
+        const int listSize = 5000;
+        SongDao songDao;
+        const QList<Song> songs = songDao.getSongsByIds(queue.songIds().mid(0, listSize));
+        queue.setSongs(songs);
+        const qint64 usage = queue.memoryUsage();
+        qDebug() << "显式列表占用:" << usage / 1024 << "KB";
+        if (queue.count() != songs.size() || usage > listSize * qint64(sizeof(int)) + fixedBudget()) {
+            qDebug() << "失败: 显式歌曲列表保留了歌曲对象";
+            ++failures;
+        }
+        if (!queue.jumpTo(10) || queue.currentSong().id() != songs[10].id()) {
+            qDebug() << "失败: 显式歌曲列表中的歌曲无法读取";
+            ++failures;
+        }
+    }
+
+    DatabaseManager::instance()->closeDatabase();
+
+    if (failures > 0) {
+        qDebug() << "播放队列测试失败，失败项:" << failures;
+        return 1;
+    }
+    qDebug() << "播放队列测试通过";
+    return 0;
+}
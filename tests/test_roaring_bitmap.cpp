@@ -0,0 +1,142 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QList>
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include "../src/core/roaringbitmap.h"
+
+namespace {
+
+QList<int> toList(const std::set<int>& values)
+{
+    return QList<int>(values.begin(), values.end());
+}
+
+bool sameAs(const RoaringBitmap& bitmap, const QList<int>& expected)
+{
+    return bitmap.cardinality() == expected.size() && bitmap.toList() == expected;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    qDebug() << "开始压缩位图测试...";
+    int failures = 0;
+
+    // 1. 与std::set对照：稀疏（数组容器）、稠密（位图容器）和跨多个容器的值域
+    {
+        QRandomGenerator rng(1);
+        const int ranges[] = {9000, 70000, 300000};
+        for (int round = 0; round < 90; ++round) {
+            const int range = ranges[round % 3];
+            RoaringBitmap a;
+            RoaringBitmap b;
+            std::set<int> sa;
+            std::set<int> sb;
+            bool ok = true;
+
+            const int addCount = rng.bounded(20000);
+            for (int i = 0; i < addCount; ++i) {
+                const int value = rng.bounded(range);
+                ok = ok && a.add(value) == sa.insert(value).second;
+                const int other = rng.bounded(range);
+                b.add(other);
+                sb.insert(other);
+            }
+            // 删除足够多的值，让位图容器退回数组容器
+            for (int i = 0; i < addCount / 2; ++i) {
+                const int value = rng.bounded(range);
+                ok = ok && a.remove(value) == (sa.erase(value) > 0);
+            }
+            for (int i = 0; i < 1000; ++i) {
+                const int value = rng.bounded(range);
+                ok = ok && a.contains(value) == (sa.count(value) > 0);
+            }
+
+            std::set<int> expected;
+            std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(expected, expected.end()));
+            ok = ok && sameAs(a & b, toList(expected));
+            expected.clear();
+            std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(expected, expected.end()));
+            ok = ok && sameAs(a | b, toList(expected));
+            expected.clear();
+            std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(expected, expected.end()));
+            ok = ok && sameAs(a - b, toList(expected));
+
+            RoaringBitmap c = a;
+            c |= b;
+            c -= b;
+            ok = ok && sameAs(a, toList(sa)) && c == a - b;
+
+            if (!ok) {
+                qDebug() << "失败: 第" << round << "轮与std::set的结果不一致，值域" << range;
+                ++failures;
+                break;
+            }
+        }
+    }
+
+    // 2. 复制后修改不影响原位图
+    {
+        RoaringBitmap a;
+        for (int i = 0; i < 5000; ++i) {
+            a.add(i * 2);
+        }
+        RoaringBitmap b = a;
+        b.remove(0);
+        b.add(1);
+        if (!a.contains(0) || a.contains(1) || a.cardinality() != 5000) {
+            qDebug() << "失败: 修改副本改变了原位图";
+            ++failures;
+        }
+    }
+
+    // 3. 10万首歌、三个不同密度的标签，组合查询应在微秒级
+    {
+        QRandomGenerator rng(2);
+        RoaringBitmap half;
+        RoaringBitmap tenth;
+        RoaringBitmap rare;
+        for (int songId = 1; songId <= 100000; ++songId) {
+            if (rng.bounded(2) == 0) {
+                half.add(songId);
+            }
+            if (rng.bounded(10) == 0) {
+                tenth.add(songId);
+            }
+            if (rng.bounded(100) == 0) {
+                rare.add(songId);
+            }
+        }
+
+        const int rounds = 1000;
+        qint64 checksum = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < rounds; ++i) {
+            checksum += ((half & tenth) | rare).cardinality();
+            checksum += (half - tenth - rare).cardinality();
+        }
+        const double microseconds = timer.nsecsElapsed() / 1000.0 / rounds;
+        qDebug() << QString("10万首: 一次(A与B)或C加A差B差C耗时 %1 us，位图占用 %2 字节")
+                        .arg(microseconds, 0, 'f', 1)
+                        .arg(half.memoryUsage() + tenth.memoryUsage() + rare.memoryUsage());
+        if (checksum <= 0 || microseconds > 1000) {
+            qDebug() << "失败: 组合查询耗时超过1ms";
+            ++failures;
+        }
+    }
+
+    if (failures > 0) {
+        qDebug() << "压缩位图测试失败，失败项:" << failures;
+        return 1;
+    }
+    qDebug() << "压缩位图测试通过";
+    return 0;
+}
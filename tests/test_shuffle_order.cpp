@@ -0,0 +1,176 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSet>
+#include "../src/core/shuffleorder.h"
+
+namespace {
+
+bool isPermutation(const ShuffleOrder& order, int count)
+{
+    if (order.size() != count) {
+        return false;
+    }
+    QSet<int> seen;
+    for (int position = 0; position < order.size(); ++position) {
+        const int index = order.at(position);
+        if (index < 0 || index >= count || seen.contains(index) || order.positionOf(index) != position) {
+            return false;
+        }
+        seen.insert(index);
+    }
+    return true;
+}
+
+// 沿排列走完steps步（到末尾时重新洗牌），返回每步的纳秒数
+double nanosecondsPerStep(int count, int steps)
+{
+    ShuffleOrder order(count);
+    order.reset(count);
+    int current = order.first();
+    qint64 checksum = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < steps; ++i) {
+        int next = order.next(current);
+        if (next < 0) {
+            order.reshuffle(current);
+            next = order.first();
+        }
+        current = next;
+        checksum += current;
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    if (checksum < 0) {
+        qDebug() << checksum;
+    }
+    return static_cast<double>(elapsed) / steps;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    qDebug() << "开始随机播放顺序测试...";
+    int failures = 0;
+
+    // 1. 一轮内每首歌恰好出现一次，上一首能回到真正播放过的歌曲
+    {
+        const int count = 1000;
+        ShuffleOrder order(1);
+        order.reset(count, 42);
+        if (!isPermutation(order, count) || order.first() != 42) {
+            qDebug() << "失败: reset后不是以指定歌曲开头的排列";
+            ++failures;
+        }
+
+        QList<int> played;
+        for (int current = order.first(); current >= 0; current = order.next(current)) {
+            played.append(current);
+        }
+        if (played.size() != count) {
+            qDebug() << "失败: 一轮播放了" << played.size() << "首，期望" << count;
+            ++failures;
+        }
+        for (int i = played.size() - 1; i > 0; --i) {
+            if (order.previous(played[i]) != played[i - 1]) {
+                qDebug() << "失败: 第" << i << "首的上一首不是实际播放的歌曲";
+                ++failures;
+                break;
+            }
+        }
+
+        order.reshuffle(played.last());
+        if (!isPermutation(order, count) || order.first() == played.last()) {
+            qDebug() << "失败: 新一轮以刚播放的歌曲开头";
+            ++failures;
+        }
+    }
+
+    // 2. 新增的歌曲只插入到当前位置之后，已播放的顺序不变
+    {
+        ShuffleOrder order(2);
+        order.reset(100);
+        const int current = order.at(50);
+        QList<int> before;
+        for (int position = 0; position <= 50; ++position) {
+            before.append(order.at(position));
+        }
+        order.append(current, 20);
+        bool ok = isPermutation(order, 120);
+        for (int position = 0; ok && position <= 50; ++position) {
+            ok = order.at(position) == before[position];
+        }
+        if (!ok) {
+            qDebug() << "失败: 追加后已播放部分被打乱";
+            ++failures;
+        }
+    }
+
+    // 3. 删除和重排后保持原有的相对顺序
+    {
+        ShuffleOrder order(3);
+        order.reset(10);
+        QList<int> oldToNew;
+        int next = 0;
+        for (int i = 0; i < 10; ++i) {
+            oldToNew.append(i % 3 == 0 ? -1 : next++);
+        }
+        QList<int> expected;
+        for (int position = 0; position < 10; ++position) {
+            const int mapped = oldToNew[order.at(position)];
+            if (mapped >= 0) {
+                expected.append(mapped);
+            }
+        }
+        order.remap(oldToNew);
+        bool ok = isPermutation(order, next);
+        for (int position = 0; ok && position < expected.size(); ++position) {
+            ok = order.at(position) == expected[position];
+        }
+        if (!ok) {
+            qDebug() << "失败: 删除后随机顺序改变";
+            ++failures;
+        }
+    }
+
+    // 4. 加权：权重大的歌曲更常排在第一位
+    {
+        int heavyFirst = 0;
+        const int rounds = 1000;
+        for (int round = 0; round < rounds; ++round) {
+            ShuffleOrder order(100 + round);
+            order.setWeightFunction([](int index) { return index == 7 ? 100.0 : 1.0; });
+            order.reset(10);
+            heavyFirst += order.first() == 7 ? 1 : 0;
+        }
+        qDebug() << "权重100的歌曲排在第一位:" << heavyFirst << "/" << rounds;
+        if (heavyFirst < rounds / 2) {
+            qDebug() << "失败: 权重没有生效";
+            ++failures;
+        }
+    }
+
+    // 5. 每步耗时与列表规模无关（O(1)）；大列表受缓存影响，只要求在同一数量级附近
+    {
+        const int steps = 2000000;
+        const double small = nanosecondsPerStep(1000, steps);
+        const double large = nanosecondsPerStep(1000000, steps);
+        qDebug() << QString("1k首: %1 ns/步，1M首: %2 ns/步（含每轮结束时的重新洗牌）")
+                        .arg(small, 0, 'f', 1).arg(large, 0, 'f', 1);
+        if (large > small * 100) {
+            qDebug() << "失败: 大列表的每步耗时随规模增长";
+            ++failures;
+        }
+    }
+
+    if (failures > 0) {
+        qDebug() << "随机播放顺序测试失败，失败项:" << failures;
+        return 1;
+    }
+    qDebug() << "随机播放顺序测试通过";
+    return 0;
+}